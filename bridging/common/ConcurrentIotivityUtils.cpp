@@ -23,6 +23,7 @@
 #include "octypes.h"
 #include "ConcurrentIotivityUtils.h"
 #include "ocpayload.h"
+#include "ocevent.h"
 #include "experimental/logger.h"
 
 #define TAG "CONCURRENT_IOTIVITY_UTILS"
@@ -31,6 +32,31 @@ using namespace OC::Bridging;
 
 // Static member initializations.
 std::unique_ptr<WorkQueue<std::unique_ptr<IotivityWorkItem>>> ConcurrentIotivityUtils::m_queue;
+std::recursive_mutex ConcurrentIotivityUtils::m_iotivityApiCallMutex;
+
+ConcurrentIotivityUtils::ConcurrentIotivityUtils(
+    std::unique_ptr<WorkQueue<std::unique_ptr<IotivityWorkItem>>> queueToMonitor)
+    : m_processEvent(NULL)
+    , m_threadStarted(false)
+    , m_shutDownOCProcessThread(false)
+{
+    if (m_queue)
+    {
+        throw "ConcurrentIotivityUtils already exists";
+    }
+    m_queue = std::move(queueToMonitor);
+    m_processEvent = oc_event_new();
+}
+
+ConcurrentIotivityUtils::~ConcurrentIotivityUtils()
+{
+    if (m_threadStarted)
+    {
+        stopWorkerThreads();
+    }
+    oc_event_free(m_processEvent);
+    m_queue.reset();
+}
 
 void ConcurrentIotivityUtils::startWorkerThreads()
 {
@@ -38,6 +64,13 @@ void ConcurrentIotivityUtils::startWorkerThreads()
     {
         throw "Work Queue Processor already started";
     }
+
+    if (m_processEvent && OCRegisterProcessEvent(m_processEvent) != OC_STACK_OK)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to register process event, polling OCProcess()");
+    }
+
+    m_shutDownOCProcessThread = false;
     m_processWorkQueueThread = std::thread(&ConcurrentIotivityUtils::processWorkQueue, this);
     m_ocProcessThread = std::thread(&ConcurrentIotivityUtils::callOCProcess, this);
     m_threadStarted = true;
@@ -46,12 +79,45 @@ void ConcurrentIotivityUtils::startWorkerThreads()
 void ConcurrentIotivityUtils::stopWorkerThreads()
 {
     m_shutDownOCProcessThread = true;
+    if (m_processEvent)
+    {
+        oc_event_signal(m_processEvent);
+    }
+
     m_queue->shutdown();
     m_processWorkQueueThread.join();
     m_ocProcessThread.join();
+
+    if (m_processEvent)
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_iotivityApiCallMutex);
+        OCUnregisterProcessEvent(m_processEvent);
+    }
     m_threadStarted = false;
 }
 
+void ConcurrentIotivityUtils::callOCProcess()
+{
+    while (!m_shutDownOCProcessThread)
+    {
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_iotivityApiCallMutex);
+            OCProcess();
+        }
+
+        // Wake as soon as the stack has received something to deliver. The timeout keeps
+        // the stack's own timers running while the network is idle.
+        if (m_processEvent)
+        {
+            oc_event_wait_for(m_processEvent, OCPROCESS_MAX_WAIT_MILLISECONDS);
+        }
+        else
+        {
+            usleep(OCPROCESS_MAX_WAIT_MILLISECONDS * 1000);
+        }
+    }
+}
+
 OCStackResult ConcurrentIotivityUtils::queueCreateResource(const std::string &uri,
         const std::string &resourceType,
         const std::string &interface, OCEntityHandler entityHandler,
@@ -72,6 +138,7 @@ OCStackResult ConcurrentIotivityUtils::respondToRequest(OCEntityHandlerRequest *
     std::unique_ptr<OCEntityHandlerResponse> response = make_unique<OCEntityHandlerResponse>();
 
     response->requestHandle = request->requestHandle;
+    response->resourceHandle = request->resource;
     response->ehResult = responseCode;
 
     // Clone a copy since this allocation is going across thread boundaries.
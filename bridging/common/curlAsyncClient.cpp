@@ -0,0 +1,495 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+
+#include "curlAsyncClient.h"
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <system_error>
+#include "iotivity_config.h"
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include "experimental/logger.h"
+
+using namespace OC::Bridging;
+
+#define TAG "CURL_ASYNC_CLIENT"
+
+#define DEFAULT_CURL_TIMEOUT_SECONDS     60L
+
+// Upper bound on the time the worker sleeps when curl has nothing to wait for.
+#define CURL_WAIT_TIMEOUT_MS             1000
+
+// Connections kept open across all origins, and opened in parallel to one origin.
+// Hubs such as the Hue bridge cope badly with many concurrent connections, so requests
+// beyond the per origin limit queue inside curl until a connection is free.
+#define CURL_MAX_CONNECTIONS             32L
+#define CURL_MAX_HOST_CONNECTIONS        4L
+
+// Easy handles kept for reuse once their transfer has completed.
+#define CURL_MAX_IDLE_HANDLES            8
+
+struct CurlAsyncClient::Transfer
+{
+    Transfer(CurlRequest req, CurlCallback cb) :
+        request(std::move(req)), callback(std::move(cb)), headerList(NULL), handle(NULL) { }
+
+    CurlRequest request;
+    CurlCallback callback;
+    CurlResponse response;
+    struct curl_slist *headerList;
+    CURL *handle;
+};
+
+CurlAsyncClient &CurlAsyncClient::getInstance()
+{
+    static CurlAsyncClient instance;
+    return instance;
+}
+
+CurlAsyncClient::CurlAsyncClient() :
+    m_started(false), m_shutdown(false), m_multi(NULL)
+{
+    m_wakeFds[0] = m_wakeFds[1] = -1;
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+}
+
+CurlAsyncClient::~CurlAsyncClient()
+{
+    shutdown();
+
+    for (CURL *handle : m_idleHandles)
+    {
+        curl_easy_cleanup(handle);
+    }
+
+    if (NULL != m_multi)
+    {
+        curl_multi_cleanup(m_multi);
+    }
+
+    for (int fd : m_wakeFds)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+int CurlAsyncClient::start()
+{
+    if (0 != pipe(m_wakeFds))
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to create wake pipe - [%s]", strerror(errno));
+        m_wakeFds[0] = m_wakeFds[1] = -1;
+        return MPM_RESULT_INTERNAL_ERROR;
+    }
+
+    for (int fd : m_wakeFds)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    m_multi = curl_multi_init();
+    if (NULL == m_multi)
+    {
+        OIC_LOG(ERROR, TAG, "curl_multi_init failed");
+        goto CLEANUP;
+    }
+
+    curl_multi_setopt(m_multi, CURLMOPT_MAXCONNECTS, CURL_MAX_CONNECTIONS);
+#if LIBCURL_VERSION_NUM >= 0x071E00
+    curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS, CURL_MAX_HOST_CONNECTIONS);
+#endif
+#ifdef CURLPIPE_MULTIPLEX
+    curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+
+    try
+    {
+        m_thread = std::thread(&CurlAsyncClient::run, this);
+    }
+    catch (const std::system_error &e)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to start worker thread - [%s]", e.what());
+        goto CLEANUP;
+    }
+
+    m_started = true;
+    return MPM_RESULT_OK;
+
+CLEANUP:
+    if (NULL != m_multi)
+    {
+        curl_multi_cleanup(m_multi);
+        m_multi = NULL;
+    }
+    close(m_wakeFds[0]);
+    close(m_wakeFds[1]);
+    m_wakeFds[0] = m_wakeFds[1] = -1;
+    return MPM_RESULT_INTERNAL_ERROR;
+}
+
+void CurlAsyncClient::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_shutdown)
+        {
+            return;
+        }
+        m_shutdown = true;
+    }
+
+    if (m_thread.joinable())
+    {
+        wake();
+        m_thread.join();
+    }
+}
+
+void CurlAsyncClient::wake()
+{
+    char c = 0;
+    // A full pipe already guarantees a wake up, so the result does not matter.
+    ssize_t ret = write(m_wakeFds[1], &c, 1);
+    (void) ret;
+}
+
+int CurlAsyncClient::send(CurlRequest request, CurlCallback callback)
+{
+    if (request.url.empty() || !callback)
+    {
+        OIC_LOG(ERROR, TAG, "Request url or callback is empty");
+        return MPM_RESULT_INVALID_PARAMETER;
+    }
+
+    std::unique_ptr<Transfer> transfer(new Transfer(std::move(request), std::move(callback)));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_shutdown)
+        {
+            OIC_LOG(ERROR, TAG, "Client is shut down");
+            return MPM_RESULT_INTERNAL_ERROR;
+        }
+
+        if (!m_started)
+        {
+            int result = start();
+            if (MPM_RESULT_OK != result)
+            {
+                return result;
+            }
+        }
+
+        m_pending.push_back(std::move(transfer));
+    }
+
+    wake();
+    return MPM_RESULT_OK;
+}
+
+std::future<CurlResponse> CurlAsyncClient::send(CurlRequest request)
+{
+    std::shared_ptr<std::promise<CurlResponse>> promise =
+        std::make_shared<std::promise<CurlResponse>>();
+    std::future<CurlResponse> future = promise->get_future();
+
+    bool onWorkerThread = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        onWorkerThread = (std::this_thread::get_id() == m_thread.get_id());
+    }
+
+    int result = MPM_RESULT_OK;
+    if (onWorkerThread)
+    {
+        OIC_LOG(ERROR, TAG, "Waiting for a response in a completion callback would deadlock");
+        result = MPM_RESULT_INTERNAL_ERROR;
+    }
+    else
+    {
+        result = send(std::move(request), [promise](CurlResponse & response)
+        {
+            promise->set_value(std::move(response));
+        });
+    }
+
+    if (MPM_RESULT_OK != result)
+    {
+        CurlResponse response;
+        response.result = result;
+        promise->set_value(std::move(response));
+    }
+    return future;
+}
+
+size_t CurlAsyncClient::writeCallback(void *contents, size_t size, size_t nmemb, void *userp)
+{
+    size_t realsize = size * nmemb;
+    Transfer *transfer = static_cast<Transfer *>(userp);
+    transfer->response.body.append(static_cast<const char *>(contents), realsize);
+    return realsize;
+}
+
+size_t CurlAsyncClient::headerCallback(void *contents, size_t size, size_t nmemb, void *userp)
+{
+    // curl hands over one complete header line per call.
+    size_t realsize = size * nmemb;
+    Transfer *transfer = static_cast<Transfer *>(userp);
+    const char *line = static_cast<const char *>(contents);
+    size_t length = realsize;
+
+    if (length >= 2 && '\r' == line[length - 2] && '\n' == line[length - 1])
+    {
+        length -= 2;
+    }
+    transfer->response.headers.push_back(std::string(line, length));
+    return realsize;
+}
+
+void CurlAsyncClient::startTransfer(std::unique_ptr<Transfer> transfer)
+{
+    const CurlRequest &request = transfer->request;
+
+    for (const std::string &header : request.headers)
+    {
+        struct curl_slist *headers = curl_slist_append(transfer->headerList, header.c_str());
+        if (NULL == headers)
+        {
+            OIC_LOG(ERROR, TAG, "curl_slist_append failed");
+            completeTransfer(std::move(transfer), MPM_RESULT_OUT_OF_MEMORY);
+            return;
+        }
+        transfer->headerList = headers;
+    }
+
+    CURL *curl = NULL;
+    if (!m_idleHandles.empty())
+    {
+        curl = m_idleHandles.back();
+        m_idleHandles.pop_back();
+    }
+    else
+    {
+        curl = curl_easy_init();
+        if (NULL == curl)
+        {
+            OIC_LOG(ERROR, TAG, "curl_easy_init failed");
+            completeTransfer(std::move(transfer), MPM_RESULT_INTERNAL_ERROR);
+            return;
+        }
+    }
+
+    // Expect the transfer to complete within DEFAULT_CURL_TIMEOUT seconds
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, DEFAULT_CURL_TIMEOUT_SECONDS);
+
+    // Set CURLOPT_VERBOSE to 1L below to see detailed debugging
+    // information on curl operations.
+    curl_easy_setopt(curl, CURLOPT_VERBOSE, 0L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headerList);
+    curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.body.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long) request.body.size());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, transfer.get());
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, transfer.get());
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer.get());
+#if LIBCURL_VERSION_NUM >= 0x072F00
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long) CURL_HTTP_VERSION_2TLS);
+#endif
+#ifdef CURLPIPE_MULTIPLEX
+    // Prefer waiting for a multiplexed connection over opening a new one.
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+#endif
+    if (CURLUSESSL_NONE != request.useSsl)
+    {
+        curl_easy_setopt(curl, CURLOPT_USE_SSL, (long) request.useSsl);
+    }
+
+    if (!request.username.empty())
+    {
+        curl_easy_setopt(curl, CURLOPT_USERNAME, request.username.c_str());
+    }
+
+    if (!request.method.empty())
+    {
+        /// only required for GET, PUT, DELETE
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+        if ("HEAD" == request.method)
+        {
+            curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        }
+    }
+
+    transfer->handle = curl;
+    CURLMcode mres = curl_multi_add_handle(m_multi, curl);
+    if (CURLM_OK != mres)
+    {
+        OIC_LOG_V(ERROR, TAG, "curl_multi_add_handle failed with %d", (int) mres);
+        completeTransfer(std::move(transfer), MPM_RESULT_INTERNAL_ERROR);
+        return;
+    }
+
+    m_active[curl] = std::move(transfer);
+}
+
+void CurlAsyncClient::releaseHandle(CURL *handle)
+{
+    if (m_idleHandles.size() < CURL_MAX_IDLE_HANDLES)
+    {
+        // Connections belong to the multi handle, so resetting the easy handle keeps them.
+        curl_easy_reset(handle);
+        m_idleHandles.push_back(handle);
+    }
+    else
+    {
+        curl_easy_cleanup(handle);
+    }
+}
+
+void CurlAsyncClient::completeTransfer(std::unique_ptr<Transfer> transfer, int result)
+{
+    if (NULL != transfer->handle)
+    {
+        curl_multi_remove_handle(m_multi, transfer->handle);
+        releaseHandle(transfer->handle);
+        transfer->handle = NULL;
+    }
+
+    if (NULL != transfer->headerList)
+    {
+        curl_slist_free_all(transfer->headerList);
+        transfer->headerList = NULL;
+    }
+
+    transfer->response.result = result;
+    transfer->callback(transfer->response);
+}
+
+void CurlAsyncClient::completeTransfers()
+{
+    int msgsInQueue = 0;
+    CURLMsg *msg = NULL;
+    while (NULL != (msg = curl_multi_info_read(m_multi, &msgsInQueue)))
+    {
+        if (CURLMSG_DONE != msg->msg)
+        {
+            continue;
+        }
+
+        auto it = m_active.find(msg->easy_handle);
+        if (m_active.end() == it)
+        {
+            continue;
+        }
+
+        std::unique_ptr<Transfer> transfer = std::move(it->second);
+        m_active.erase(it);
+
+        int result = MPM_RESULT_OK;
+        if (CURLE_OK != msg->data.result)
+        {
+            OIC_LOG_V(ERROR, TAG, "curl transfer failed with %lu",
+                      (unsigned long) msg->data.result);
+            result = MPM_RESULT_NETWORK_ERROR;
+        }
+        else if (CURLE_OK != curl_easy_getinfo(transfer->handle, CURLINFO_RESPONSE_CODE,
+                                               &transfer->response.responseCode))
+        {
+            OIC_LOG(WARNING, TAG, "curl_easy_getinfo(CURLINFO_RESPONSE_CODE) failed.");
+            transfer->response.responseCode = INVALID_RESPONSE_CODE;
+        }
+
+        // msg belongs to the multi handle and is invalid once the easy handle is removed.
+        completeTransfer(std::move(transfer), result);
+    }
+}
+
+void CurlAsyncClient::run()
+{
+    OIC_LOG(INFO, TAG, "Worker thread started");
+
+    while (true)
+    {
+        std::deque<std::unique_ptr<Transfer>> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_shutdown)
+            {
+                break;
+            }
+            pending.swap(m_pending);
+        }
+
+        for (std::unique_ptr<Transfer> &transfer : pending)
+        {
+            startTransfer(std::move(transfer));
+        }
+
+        int running = 0;
+        curl_multi_perform(m_multi, &running);
+        completeTransfers();
+
+        struct curl_waitfd wakeFd;
+        wakeFd.fd = m_wakeFds[0];
+        wakeFd.events = CURL_WAIT_POLLIN;
+        wakeFd.revents = 0;
+        curl_multi_wait(m_multi, &wakeFd, 1, CURL_WAIT_TIMEOUT_MS, NULL);
+
+        if (wakeFd.revents)
+        {
+            char buf[64];
+            while (read(m_wakeFds[0], buf, sizeof(buf)) > 0)
+            {
+            }
+        }
+    }
+
+    // Nothing will service the remaining requests, so fail them rather than leave
+    // callers waiting.
+    std::deque<std::unique_ptr<Transfer>> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pending.swap(m_pending);
+    }
+    for (std::unique_ptr<Transfer> &transfer : pending)
+    {
+        completeTransfer(std::move(transfer), MPM_RESULT_INTERNAL_ERROR);
+    }
+
+    while (!m_active.empty())
+    {
+        std::unique_ptr<Transfer> transfer = std::move(m_active.begin()->second);
+        m_active.erase(m_active.begin());
+        completeTransfer(std::move(transfer), MPM_RESULT_INTERNAL_ERROR);
+    }
+
+    OIC_LOG(INFO, TAG, "Worker thread stopped");
+}
@@ -29,6 +29,9 @@
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#include <string.h>
+#include <mutex>
+#include <vector>
 #include "oic_malloc.h"
 #include "pluginIf.h"
 #include "pluginServer.h"
@@ -82,6 +85,43 @@ void MPMRequestHandler(MPMPipeMessage *pipe_message, MPMPluginCtx *ctx)
     }
 }
 
+/* Responses collected between MPMBeginResponseBatch and MPMFlushResponses. */
+static std::mutex g_responseBatchLock;
+static bool g_responseBatchOpen = false;
+static std::vector<MPMPipeMessage> g_responseBatch;
+
+static MPMResult writeResponseBatch()
+{
+    MPMResult result = MPM_RESULT_OK;
+
+    if (!g_responseBatch.empty())
+    {
+        result = MPMWritePipeMessages(g_com_ctx->parent_reads_fds.write_fd,
+                                      g_responseBatch.data(), g_responseBatch.size());
+    }
+
+    for (size_t i = 0; i < g_responseBatch.size(); i++)
+    {
+        OICFree((void *)g_responseBatch[i].payload);
+    }
+    g_responseBatch.clear();
+    return result;
+}
+
+void MPMBeginResponseBatch()
+{
+    std::lock_guard<std::mutex> lock(g_responseBatchLock);
+    g_responseBatch.reserve(MPM_MAX_MESSAGES_PER_FRAME);
+    g_responseBatchOpen = true;
+}
+
+MPMResult MPMFlushResponses()
+{
+    std::lock_guard<std::mutex> lock(g_responseBatchLock);
+    g_responseBatchOpen = false;
+    return writeResponseBatch();
+}
+
 MPMResult MPMSendResponse(const void *response, size_t size, MPMMessageType type)
 {
     MPMResult result = MPM_RESULT_INTERNAL_ERROR;
@@ -94,8 +134,30 @@ MPMResult MPMSendResponse(const void *response, size_t size, MPMMessageType type
     pipe_message.msgType = type;
     pipe_message.payload = (uint8_t *)response;
 
-    result = MPMWritePipeMessage(g_com_ctx->parent_reads_fds.write_fd, &pipe_message);
+    std::lock_guard<std::mutex> lock(g_responseBatchLock);
+    if (!g_responseBatchOpen)
+    {
+        return MPMWritePipeMessage(g_com_ctx->parent_reads_fds.write_fd, &pipe_message);
+    }
 
+    if (size > 0)
+    {
+        uint8_t *payload = (uint8_t *)OICMalloc(size);
+        if (!payload)
+        {
+            OIC_LOG(ERROR, TAG, "failed to allocate memory");
+            return result;
+        }
+        memcpy(payload, response, size);
+        pipe_message.payload = payload;
+    }
+    g_responseBatch.push_back(pipe_message);
+
+    result = MPM_RESULT_OK;
+    if (g_responseBatch.size() == MPM_MAX_MESSAGES_PER_FRAME)
+    {
+        result = writeResponseBatch();
+    }
     return result;
 }
 
@@ -27,6 +27,8 @@
 
 #include <string.h>
 #include <errno.h>
+#include <pthread.h>
+#include <sys/uio.h>
 #include "messageHandler.h"
 #include "iotivity_config.h"
 #ifdef HAVE_UNISTD_H
@@ -38,40 +40,108 @@
 
 #define TAG "PIPE_HANDLER"
 
-MPMResult MPMWritePipeMessage(int fd, const MPMPipeMessage *pipe_message)
+/* Each message is framed as its payload size, its type and then the payload. */
+#define MPM_PIPE_HEADER_SIZE (sizeof(size_t) + sizeof(MPMMessageType))
+#define MPM_IOVECS_PER_MESSAGE 3
+
+/* Initial size of a reader's buffer, it grows to hold the largest frame. */
+#define MPM_PIPE_READER_SIZE 4096
+
+/* Serializes writers so that frames from different threads do not interleave. */
+static pthread_mutex_t g_pipeWriteLock = PTHREAD_MUTEX_INITIALIZER;
+
+static MPMResult writeFully(int fd, struct iovec *iov, int iovcnt)
 {
-    ssize_t ret = 0;
-    OIC_LOG(DEBUG, TAG, "writing message over pipe");
+    while (iovcnt > 0)
+    {
+        ssize_t ret = writev(fd, iov, iovcnt);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            OIC_LOG_V(ERROR, TAG, "Error writing message over the pipe - [%s]", strerror(errno));
+            return MPM_RESULT_INTERNAL_ERROR;
+        }
 
-    OIC_LOG_V(DEBUG, TAG, "Message type = %d, payload size = %" PRIuPTR, pipe_message->msgType,
-              pipe_message->payloadSize);
+        size_t written = (size_t)ret;
+        while (iovcnt > 0 && written >= iov->iov_len)
+        {
+            written -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = (uint8_t *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+    return MPM_RESULT_OK;
+}
 
-    ret = write(fd, &pipe_message->payloadSize, sizeof(size_t));
-    if (ret < 0)
+static ssize_t readFully(int fd, void *buffer, size_t size)
+{
+    size_t bytesRead = 0;
+    while (bytesRead < size)
     {
-        OIC_LOG_V(ERROR, TAG, "Error writing message over the pipe - [%s]", strerror(errno));
-        return MPM_RESULT_INTERNAL_ERROR;
+        ssize_t ret = read(fd, (uint8_t *)buffer + bytesRead, size - bytesRead);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            OIC_LOG_V(ERROR, TAG, "Error Reading message from the pipe - [%s]", strerror(errno));
+            return ret;
+        }
+        if (ret == 0)
+        {
+            break;
+        }
+        bytesRead += ret;
     }
+    return bytesRead;
+}
 
-    ret = write(fd, &pipe_message->msgType, sizeof(MPMMessageType));
-    if (ret < 0)
+MPMResult MPMWritePipeMessages(int fd, const MPMPipeMessage *messages, size_t count)
+{
+    struct iovec iov[MPM_MAX_MESSAGES_PER_FRAME * MPM_IOVECS_PER_MESSAGE];
+    int iovcnt = 0;
+
+    if (count > MPM_MAX_MESSAGES_PER_FRAME)
     {
-        OIC_LOG_V(ERROR, TAG, "Error writing message over the pipe - [%s]", strerror(errno));
+        OIC_LOG_V(ERROR, TAG, "Too many messages for one frame: %" PRIuPTR, count);
         return MPM_RESULT_INTERNAL_ERROR;
     }
 
-    if (pipe_message->payloadSize > 0)
+    for (size_t i = 0; i < count; i++)
     {
-        ret = write(fd, pipe_message->payload, pipe_message->payloadSize);
+        OIC_LOG_V(DEBUG, TAG, "Message type = %d, payload size = %" PRIuPTR, messages[i].msgType,
+                  messages[i].payloadSize);
 
-        if (ret < 0)
+        iov[iovcnt].iov_base = (void *)&messages[i].payloadSize;
+        iov[iovcnt++].iov_len = sizeof(size_t);
+        iov[iovcnt].iov_base = (void *)&messages[i].msgType;
+        iov[iovcnt++].iov_len = sizeof(MPMMessageType);
+        if (messages[i].payloadSize > 0)
         {
-            OIC_LOG_V(ERROR, TAG, "Error writing message over the pipe - [%s]", strerror(errno));
-            return MPM_RESULT_INTERNAL_ERROR;
+            iov[iovcnt].iov_base = (void *)messages[i].payload;
+            iov[iovcnt++].iov_len = messages[i].payloadSize;
         }
     }
 
-    return MPM_RESULT_OK;
+    pthread_mutex_lock(&g_pipeWriteLock);
+    MPMResult result = writeFully(fd, iov, iovcnt);
+    pthread_mutex_unlock(&g_pipeWriteLock);
+    return result;
+}
+
+MPMResult MPMWritePipeMessage(int fd, const MPMPipeMessage *pipe_message)
+{
+    OIC_LOG(DEBUG, TAG, "writing message over pipe");
+    return MPMWritePipeMessages(fd, pipe_message, 1);
 }
 
 
@@ -82,22 +152,19 @@ ssize_t MPMReadPipeMessage(int fd, MPMPipeMessage *pipe_message)
     OIC_LOG_V(DEBUG, TAG, "Message type = %d, payload size = %" PRIuPTR , pipe_message->msgType,
                   pipe_message->payloadSize);
 
-    ret = read(fd, &pipe_message->payloadSize, sizeof(size_t));
+    uint8_t header[MPM_PIPE_HEADER_SIZE];
+    ret = readFully(fd, header, sizeof(header));
     if (ret < 0)
     {
-        OIC_LOG_V(ERROR, TAG, "Error Reading message from the pipe - [%s]", strerror(errno));
         return ret;
     }
-    bytesRead = ret;
-
-    ret = read(fd, &pipe_message->msgType, sizeof(MPMMessageType));
-    if (ret < 0)
+    if (ret < (ssize_t)sizeof(header))
     {
-        OIC_LOG_V(ERROR, TAG, "Error Reading message from the pipe - [%s]", strerror(errno));
-        return ret;
+        return 0;
     }
-    bytesRead += ret;
-
+    memcpy(&pipe_message->payloadSize, header, sizeof(size_t));
+    memcpy(&pipe_message->msgType, header + sizeof(size_t), sizeof(MPMMessageType));
+    bytesRead = ret;
 
     if (pipe_message->msgType == MPM_NOMSG)
     {
@@ -113,10 +180,9 @@ ssize_t MPMReadPipeMessage(int fd, MPMPipeMessage *pipe_message)
         }
         else
         {
-            ret = read(fd, (void*)pipe_message->payload, pipe_message->payloadSize);
+            ret = readFully(fd, (void*)pipe_message->payload, pipe_message->payloadSize);
             if (ret < 0)
             {
-                OIC_LOG_V(ERROR, TAG, "Error Reading message from the pipe - [%s]", strerror(errno));
                 return ret;
             }
             bytesRead += ret;
@@ -129,3 +195,100 @@ ssize_t MPMReadPipeMessage(int fd, MPMPipeMessage *pipe_message)
     }
     return bytesRead;
 }
+
+ssize_t MPMPipeReaderFill(MPMPipeReader *reader, int fd)
+{
+    if (reader->start == reader->end)
+    {
+        reader->start = reader->end = 0;
+    }
+
+    if (reader->capacity - reader->end < MPM_PIPE_READER_SIZE / 2)
+    {
+        if (reader->start > 0)
+        {
+            memmove(reader->buffer, reader->buffer + reader->start, reader->end - reader->start);
+            reader->end -= reader->start;
+            reader->start = 0;
+        }
+        if (reader->capacity - reader->end < MPM_PIPE_READER_SIZE / 2)
+        {
+            size_t capacity = reader->capacity ? reader->capacity * 2 : MPM_PIPE_READER_SIZE;
+            uint8_t *buffer = (uint8_t *) OICRealloc(reader->buffer, capacity);
+            if (!buffer)
+            {
+                OIC_LOG(ERROR, TAG, "failed to allocate memory");
+                return -1;
+            }
+            reader->buffer = buffer;
+            reader->capacity = capacity;
+        }
+    }
+
+    ssize_t ret;
+    do
+    {
+        ret = read(fd, reader->buffer + reader->end, reader->capacity - reader->end);
+    }
+    while (ret < 0 && errno == EINTR);
+
+    if (ret < 0)
+    {
+        OIC_LOG_V(ERROR, TAG, "Error Reading message from the pipe - [%s]", strerror(errno));
+        return ret;
+    }
+    reader->end += ret;
+    return ret;
+}
+
+MPMResult MPMPipeReaderNext(MPMPipeReader *reader, MPMPipeMessage *pipe_message)
+{
+    while (reader->end - reader->start >= MPM_PIPE_HEADER_SIZE)
+    {
+        const uint8_t *frame = reader->buffer + reader->start;
+        size_t payloadSize;
+        MPMMessageType msgType;
+
+        memcpy(&payloadSize, frame, sizeof(size_t));
+        memcpy(&msgType, frame + sizeof(size_t), sizeof(MPMMessageType));
+
+        if (payloadSize > reader->end - reader->start - MPM_PIPE_HEADER_SIZE)
+        {
+            // Incomplete frame, MPMPipeReaderFill grows the buffer until it fits.
+            return MPM_RESULT_NOT_PRESENT;
+        }
+
+        if (msgType == MPM_NOMSG)
+        {
+            reader->start += MPM_PIPE_HEADER_SIZE + payloadSize;
+            continue;
+        }
+
+        uint8_t *payload = NULL;
+        if (payloadSize > 0)
+        {
+            payload = (uint8_t *) OICMalloc(payloadSize);
+            if (!payload)
+            {
+                // Drop the frame so that the frames behind it are not held up.
+                OIC_LOG_V(ERROR, TAG, "failed to allocate memory, dropping message %d", msgType);
+                reader->start += MPM_PIPE_HEADER_SIZE + payloadSize;
+                return MPM_RESULT_OUT_OF_MEMORY;
+            }
+            memcpy(payload, frame + MPM_PIPE_HEADER_SIZE, payloadSize);
+        }
+        reader->start += MPM_PIPE_HEADER_SIZE + payloadSize;
+
+        pipe_message->msgType = msgType;
+        pipe_message->payloadSize = payloadSize;
+        pipe_message->payload = payload;
+        return MPM_RESULT_OK;
+    }
+    return MPM_RESULT_NOT_PRESENT;
+}
+
+void MPMPipeReaderFree(MPMPipeReader *reader)
+{
+    OICFree(reader->buffer);
+    memset(reader, 0, sizeof(*reader));
+}
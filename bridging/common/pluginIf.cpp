@@ -137,6 +137,7 @@ static int start(MPMCommonPluginCtx *ctx)
                 /* Start the OCF server. This is a blocking call and will
                    return only when the plugin stops*/
                 MPMPluginService(ctx);
+                MPMPipeReaderFree(&ctx->child_reader);
 
                 OIC_LOG(INFO, TAG, "Child process complete.");
 
@@ -265,6 +266,10 @@ static void destroy(MPMCommonPluginCtx *ctx)
     {
         stop(ctx);
     }
+    if (ctx)
+    {
+        MPMPipeReaderFree(&ctx->parent_reader);
+    }
     OICFree(ctx);
 }
 
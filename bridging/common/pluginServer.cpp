@@ -144,14 +144,26 @@ bool processMessagesFromMPM(int fd, MPMCommonPluginCtx *com_ctx, MPMPluginCtx *c
     {
         if (FD_ISSET(fd, &(fdset)))
         {
-            nbytes = MPMReadPipeMessage(fd, &pipe_message);
+            nbytes = MPMPipeReaderFill(&com_ctx->child_reader, fd);
             if (nbytes == 0)
             {
                 OIC_LOG(DEBUG, TAG, "EOF was read and file descriptor was found to be closed");
                 shutdown = true;
             }
-            if (nbytes > 0)
+
+            /* Every message already in the pipe came in with this read. Responses the
+             * plugin sends while handling them go back to the MPM together.
+             */
+            MPMBeginResponseBatch();
+            MPMResult next = MPM_RESULT_OK;
+            while (!shutdown && (next = MPMPipeReaderNext(&com_ctx->child_reader,
+                                                          &pipe_message)) != MPM_RESULT_NOT_PRESENT)
             {
+                if (next != MPM_RESULT_OK)
+                {
+                    // The message was dropped, carry on with the ones behind it.
+                    continue;
+                }
                 if (pipe_message.msgType == MPM_STOP)
                 {
                     shutdown =  true;
@@ -160,10 +172,11 @@ bool processMessagesFromMPM(int fd, MPMCommonPluginCtx *com_ctx, MPMPluginCtx *c
                 {
                     MPMRequestHandler(&pipe_message, ctx);
                 }
-            }
-
-            OICFree((void*)pipe_message.payload);
 
+                OICFree((void*)pipe_message.payload);
+                pipe_message.payload = NULL;
+            }
+            MPMFlushResponses();
         }
     }
     return (shutdown);
@@ -28,6 +28,8 @@
 #include <memory>
 #include <condition_variable>
 #include <thread>
+#include <atomic>
+#include <vector>
 #include <unistd.h>
 #include <iostream>
 #include <string>
@@ -52,64 +54,63 @@ namespace OC
          * Provides a synchronized C++ wrapper over the Iotivity CSDK.
          * Accepts workItems from the plugins for common operations.
          * A consumer thread processes these worker items and makes calls into Iotivity.
-         * Another thread calls OCProcess() to check for network requests.
+         * Another thread calls OCProcess() whenever the stack has received data to deliver.
+         * Only one instance may exist at a time because the queue is shared by the static
+         * queue functions.
          */
         class ConcurrentIotivityUtils
         {
             private:
 
                 static std::unique_ptr<WorkQueue<std::unique_ptr<IotivityWorkItem>>> m_queue;
-                std::mutex m_iotivityApiCallMutex;
+
+                // Serializes all calls into Iotivity. Recursive because entity handlers run
+                // with it held by the OCProcess() thread and may respond to the request.
+                static std::recursive_mutex m_iotivityApiCallMutex;
 
                 std::thread m_processWorkQueueThread, m_ocProcessThread;
+                struct oc_event_t *m_processEvent;
                 bool m_threadStarted;
-                bool m_shutDownOCProcessThread;
-                static const int OCPROCESS_SLEEP_MICROSECONDS = 200000;
+                std::atomic<bool> m_shutDownOCProcessThread;
 
-                // Fetches work item from queue and processes it.
-                void processWorkQueue()
-                {
-                    while (true)
-                    {
-                        std::unique_ptr<IotivityWorkItem> workItem;
-                        bool fetchedWorkItem = m_queue->get(&workItem);
+                // Upper bound on the time between OCProcess() calls, which also runs the
+                // stack's presence, keep alive and batch request timers.
+                static const uint32_t OCPROCESS_MAX_WAIT_MILLISECONDS = 100;
 
-                        if (fetchedWorkItem)
-                        {
-                            std::lock_guard<std::mutex> lock(m_iotivityApiCallMutex);
-                            workItem->process();
-                        }
-                        else
-                        {
-                            break;
-                        }
-                    }
-                }
+                // Work items processed per acquisition of the Iotivity API mutex.
+                static const size_t MAX_WORK_ITEMS_PER_BATCH = 16;
 
-                void callOCProcess()
+                // Fetches work items from queue and processes them.
+                void processWorkQueue()
                 {
-                    while (!m_shutDownOCProcessThread)
+                    std::vector<std::unique_ptr<IotivityWorkItem>> workItems;
+
+                    while (m_queue->get(&workItems, MAX_WORK_ITEMS_PER_BATCH))
                     {
                         {
-                            std::lock_guard<std::mutex> lock(m_iotivityApiCallMutex);
-                            OCProcess();
+                            std::lock_guard<std::recursive_mutex> lock(m_iotivityApiCallMutex);
+                            for (auto &workItem : workItems)
+                            {
+                                workItem->process();
+                            }
                         }
-                        // Hopefully it's enough for other threads to be scheduled
-                        // instead of the spin here. OCProcess is very lightweight though.
-                        usleep(OCPROCESS_SLEEP_MICROSECONDS);
+                        workItems.clear();
                     }
                 }
 
-            public:
+                void callOCProcess();
 
+            public:
 
+                /**
+                 * @param[in] queueToMonitor  Queue for work items from the plugin.
+                 *
+                 * @throws const char * if another instance exists.
+                 */
                 ConcurrentIotivityUtils(std::unique_ptr<WorkQueue<std::unique_ptr<IotivityWorkItem>>>
-                                        queueToMonitor)
-                {
-                    m_queue = std::move(queueToMonitor);
-                    m_threadStarted = false;
-                    m_shutDownOCProcessThread = false;
-                }
+                                        queueToMonitor);
+
+                ~ConcurrentIotivityUtils();
 
                 /**
                  * Starts 2 worker threads. One to service the concurrent work queue to call
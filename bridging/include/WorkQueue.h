@@ -23,6 +23,7 @@
 #define _WORKQUEUE_H_
 
 #include <queue>
+#include <vector>
 #include <mutex>
 #include <memory>
 #include <condition_variable>
@@ -57,17 +58,18 @@ namespace OC
                 }
 
                 /**
-                 * Puts the arg in the queue and notifies all threads waiting
+                 * Puts the arg in the queue and wakes one thread waiting
                  * to fetch things from the queue.
                  *
                  * @para[in] m item The item to insert into the queue.
                  */
                 void put(T item)
                 {
-                    std::unique_lock<std::mutex> lock(m_workQueueMutex);
-
-                    m_workQueue.push(std::move(item));
-                    m_cv.notify_all();
+                    {
+                        std::lock_guard<std::mutex> lock(m_workQueueMutex);
+                        m_workQueue.push(std::move(item));
+                    }
+                    m_cv.notify_one();
                 }
 
                 /**
@@ -96,6 +98,36 @@ namespace OC
                     return true;
                 }
 
+                /**
+                 * Blocking function to fetch all queued items, up to maxItems, in one go.
+                 *
+                 * @param[out] items    The fetched items are appended here.
+                 * @param[in] maxItems  Maximum number of items to fetch.
+                 * @return true if at least one item is fetched from the queue.
+                           false if the queue is shutdown.
+                 */
+                bool get(std::vector<T> *items, size_t maxItems)
+                {
+                    std::unique_lock<std::mutex> lock(m_workQueueMutex);
+
+                    m_cv.wait(lock, [this]()
+                    {
+                        return m_workQueue.size() > 0 || m_signalToShutDown;
+                    });
+
+                    if (m_signalToShutDown)
+                    {
+                        return false;
+                    }
+
+                    for (size_t i = 0; i < maxItems && !m_workQueue.empty(); ++i)
+                    {
+                        items->push_back(std::move(m_workQueue.front()));
+                        m_workQueue.pop();
+                    }
+                    return true;
+                }
+
                 /**
                  * Notifies all waiting threads that the queue is being shut down.
                  */
@@ -0,0 +1,160 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+
+#ifndef _CURLASYNCCLIENT_H_
+#define _CURLASYNCCLIENT_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <functional>
+#include <curl/curl.h>
+#include "mpmErrorCode.h"
+
+namespace OC
+{
+    namespace Bridging
+    {
+        const long INVALID_RESPONSE_CODE = 0;
+
+        /**
+         * An HTTP request for CurlAsyncClient.
+         */
+        struct CurlRequest
+        {
+            CurlRequest() : useSsl(CURLUSESSL_TRY) { }
+
+            std::string url;
+            std::string method;
+            std::vector<std::string> headers;
+            std::string body;
+            std::string username;
+
+            /// Sets CURLOPT_USE_SSL unless CURLUSESSL_NONE.
+            curl_usessl useSsl;
+        };
+
+        /**
+         * The outcome of a CurlRequest.
+         */
+        struct CurlResponse
+        {
+            CurlResponse() : result(MPM_RESULT_INTERNAL_ERROR), responseCode(INVALID_RESPONSE_CODE) { }
+
+            /// MPM_RESULT_OK if the transfer completed, whatever the HTTP status.
+            int result;
+            long responseCode;
+            std::string body;
+            std::vector<std::string> headers;
+        };
+
+        typedef std::function<void(CurlResponse &response)> CurlCallback;
+
+        /**
+         * Process wide HTTP client shared by all CurlClient instances.
+         * Requests run concurrently on a single curl multi handle serviced by one worker
+         * thread. The multi handle keeps connections to each origin open between requests,
+         * so repeated calls to the same cloud API or bridge skip the TCP and TLS handshakes.
+         * Where libcurl supports it, HTTPS requests negotiate HTTP/2 and share one
+         * multiplexed connection per origin.
+         *
+         * The worker thread is started by the first request, so a plugin process that forks
+         * before using the client gets its own thread.
+         */
+        class CurlAsyncClient
+        {
+            public:
+                static CurlAsyncClient &getInstance();
+
+                ~CurlAsyncClient();
+
+                /**
+                 * Queues a request.
+                 *
+                 * @param[in] request   The request to send.
+                 * @param[in] callback  Called once with the response on the client's worker
+                 *                      thread. It must not block, and must not wait for another
+                 *                      request to this client.
+                 *
+                 * @return MPM_RESULT_OK if the request was queued, in which case the callback
+                 *         will be called. Otherwise the callback is not called.
+                 */
+                int send(CurlRequest request, CurlCallback callback);
+
+                /**
+                 * Queues a request and returns a future for its response.
+                 * Waiting on the future from a completion callback is reported as an error
+                 * response instead of deadlocking the worker thread.
+                 *
+                 * @param[in] request   The request to send.
+                 *
+                 * @return future that becomes ready when the request completes or fails.
+                 */
+                std::future<CurlResponse> send(CurlRequest request);
+
+                /**
+                 * Stops the worker thread. Requests still queued or in flight complete with
+                 * MPM_RESULT_INTERNAL_ERROR and further requests are refused.
+                 */
+                void shutdown();
+
+            private:
+                struct Transfer;
+
+                // Unit tests run their own instances, since shutdown() is final.
+                friend class CurlAsyncClientTest;
+
+                CurlAsyncClient();
+                CurlAsyncClient(const CurlAsyncClient &) = delete;
+                CurlAsyncClient &operator=(const CurlAsyncClient &) = delete;
+
+                int start();
+                void wake();
+                void run();
+                void startTransfer(std::unique_ptr<Transfer> transfer);
+                void completeTransfers();
+                void completeTransfer(std::unique_ptr<Transfer> transfer, int result);
+                void releaseHandle(CURL *handle);
+
+                static size_t writeCallback(void *contents, size_t size, size_t nmemb, void *userp);
+                static size_t headerCallback(void *contents, size_t size, size_t nmemb,
+                                             void *userp);
+
+                std::mutex m_mutex;
+                std::deque<std::unique_ptr<Transfer>> m_pending;
+                bool m_started;
+                bool m_shutdown;
+                std::thread m_thread;
+                int m_wakeFds[2];
+
+                // Only touched by the worker thread once it is running.
+                CURLM *m_multi;
+                std::map<CURL *, std::unique_ptr<Transfer>> m_active;
+                std::vector<CURL *> m_idleHandles;
+        };
+    } // namespace Bridging
+}  // namespace OC
+#endif // _CURLASYNCCLIENT_H_
@@ -31,6 +31,7 @@
 #include <curl/curl.h>
 #include <stdexcept>
 #include "mpmErrorCode.h"
+#include "curlAsyncClient.h"
 #include "StringConstants.h"
 
 namespace OC
@@ -41,8 +42,6 @@ namespace OC
         const char CURL_CONTENT_TYPE_URL_ENCODED[] = "content-type: application/x-www-form-urlencoded";
         const char CURL_HEADER_ACCEPT_JSON[] = "accept: application/json";
 
-        const long INVALID_RESPONSE_CODE = 0;
-
         class CurlClient
         {
 
@@ -66,45 +65,74 @@ namespace OC
                         throw "Curl method or url is empty";
                     }
 
-                    m_method = getCurlMethodString(method);
-                    m_url = url;
-                    m_useSsl = CURLUSESSL_TRY;
+                    m_request.method = getCurlMethodString(method);
+                    m_request.url = url;
+                    m_request.useSsl = CURLUSESSL_TRY;
+                    m_lastResponseCode = INVALID_RESPONSE_CODE;
                 }
 
                 CurlClient &setRequestHeaders(std::vector<std::string> &requestHeaders)
                 {
-                    m_requestHeaders = requestHeaders;
+                    m_request.headers = requestHeaders;
                     return *this;
                 }
 
                 CurlClient &addRequestHeader(const std::string &header)
                 {
-                    m_requestHeaders.push_back(header);
+                    m_request.headers.push_back(header);
                     return *this;
                 }
 
                 CurlClient &setUserName(const std::string &userName)
                 {
-                    m_username = userName;
+                    m_request.username = userName;
                     return *this;
                 }
 
                 CurlClient &setRequestBody(std::string &requestBody)
                 {
-                    m_requestBody = requestBody;
+                    m_request.body = requestBody;
                     return *this;
                 }
 
                 CurlClient &setUseSSLOption(curl_usessl sslOption)
                 {
-                    m_useSsl = sslOption;
+                    m_request.useSsl = sslOption;
                     return *this;
                 }
 
-                int send()
+                /**
+                 * Sends the request and waits for the response.
+                 * The request goes through the shared CurlAsyncClient, so connections to the
+                 * same origin are reused across CurlClient instances.
+                 *
+                 * @return MPM_RESULT_OK if the transfer completed, otherwise an error code.
+                 */
+                int send();
+
+                /**
+                 * Sends the request without waiting for the response.
+                 * getResponseBody() and friends are not updated; the response is only
+                 * delivered through the returned future.
+                 *
+                 * @return future that becomes ready when the request completes or fails.
+                 */
+                std::future<CurlResponse> sendAsync()
+                {
+                    return CurlAsyncClient::getInstance().send(m_request);
+                }
+
+                /**
+                 * Sends the request without waiting for the response.
+                 *
+                 * @param[in] callback  Called with the response on the shared client's worker
+                 *                      thread. @see CurlAsyncClient::send
+                 *
+                 * @return MPM_RESULT_OK if the request was queued, otherwise an error code.
+                 */
+                int sendAsync(CurlCallback callback)
                 {
-                    return doInternalRequest(m_url, m_method, m_requestHeaders, m_requestBody, m_username, m_outHeaders,
-                                             m_response);
+                    return CurlAsyncClient::getInstance().send(m_request, std::move(callback));
                 }
 
                 std::string getResponseBody()
@@ -131,45 +159,10 @@ namespace OC
                     else throw std::runtime_error("Invalid CurlMethod");
                 }
 
-                std::string m_url;
-                std::string m_method;
-                std::vector<std::string> m_requestHeaders;
-                std::string m_requestBody;
-                std::string m_username;
+                CurlRequest m_request;
                 std::string m_response;
                 std::vector<std::string> m_outHeaders;
 
-                /// Indicates whether to use CURLOPT_USE_SSL option in doInternalRequest.
-                /// Curl default is no SSL (CURLUSESSL_NONE). Specify one of the other CURL SSL options
-                /// (for example, CURLUSESSL_TRY) if you need to perform SSL transactions.
-                curl_usessl m_useSsl;
-
-                static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp);
-
-                // Represents contiguous memory to hold a HTTP response.
-                typedef struct _MemoryChunk
-                {
-                    _MemoryChunk() : size(0)
-                    {
-                        memory = static_cast<char *>(malloc(1));
-                    }
-
-                    char *memory;
-                    size_t size;
-
-                } MemoryChunk;
-
-                int decomposeHeader(const char *header, std::vector<std::string> &headers);
-
-
-                int doInternalRequest(const std::string &url,
-                                      const std::string &method,
-                                      const std::vector<std::string> &inHeaders,
-                                      const std::string &request,
-                                      const std::string &username,
-                                      std::vector<std::string> &outHeaders,
-                                      std::string &response);
-
                 long m_lastResponseCode;
         };
     } // namespace Bridging
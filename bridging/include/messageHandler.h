@@ -29,6 +29,8 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stdbool.h>
+#include <sys/types.h>
 #include "mpmErrorCode.h"
 
 #ifdef __cplusplus
@@ -44,6 +46,9 @@ extern "C" {
 #define MPM_MAX_UNIQUE_ID_LEN 128
 #define MPM_MAX_METADATA_LEN  3000
 
+/** Maximum number of messages written to the pipe by one system call */
+#define MPM_MAX_MESSAGES_PER_FRAME 64
+
 /* Enum to specify the action type*/
 typedef enum
 {
@@ -74,6 +79,20 @@ typedef struct
     const uint8_t *payload;
 } MPMPipeMessage;
 
+/**
+ * This structure buffers the read end of a pipe, so that all the messages
+ * already written to the pipe are fetched with a single read.
+ * A zero initialized reader is empty and ready for use.
+ */
+typedef struct
+{
+    /** bytes read from the pipe but not yet returned as messages */
+    uint8_t *buffer;
+    size_t capacity;
+    size_t start;
+    size_t end;
+} MPMPipeReader;
+
 /**
  * This structure represents the add response message coming from
  * the plugins to mpm library
@@ -127,6 +146,45 @@ MPMResult MPMWritePipeMessage(int fd, const MPMPipeMessage *pipe_message);
 */
 ssize_t MPMReadPipeMessage(int fd, MPMPipeMessage *pipe_message);
 
+/**
+ * This function writes several messages to the pipe with a single system call
+ * @param[in] fd            file descriptor
+ * @param[in] messages      messages to be written
+ * @param[in] count         number of messages, at most MPM_MAX_MESSAGES_PER_FRAME
+ *
+ * @return MPM_RESULT_OK on success, MPM_RESULT_INTERNAL_ERROR on failure
+*/
+MPMResult MPMWritePipeMessages(int fd, const MPMPipeMessage *messages, size_t count);
+
+/**
+ * This function reads whatever is available on the pipe into the reader's buffer.
+ * Call it once the pipe is readable and then take the messages with
+ * MPMPipeReaderNext.
+ * @param[in,out] reader    reader for the pipe
+ * @param[in] fd            file descriptor
+ *
+ * @return number of bytes read, 0 on end of file and negative on error
+*/
+ssize_t MPMPipeReaderFill(MPMPipeReader *reader, int fd);
+
+/**
+ * This function takes the next complete message from the reader's buffer
+ * @param[in,out] reader        reader filled by MPMPipeReaderFill
+ * @param[out] pipe_message     the message. Its payload is allocated and must be
+ *                              freed with OICFree.
+ *
+ * @return MPM_RESULT_OK if a message was returned, MPM_RESULT_NOT_PRESENT if no complete
+ *         message is buffered and MPM_RESULT_OUT_OF_MEMORY if the payload could not be
+ *         allocated, in which case the message is dropped and the next one can be taken
+*/
+MPMResult MPMPipeReaderNext(MPMPipeReader *reader, MPMPipeMessage *pipe_message);
+
+/**
+ * This function frees the reader's buffer and empties the reader
+ * @param[in,out] reader    reader to be emptied
+*/
+void MPMPipeReaderFree(MPMPipeReader *reader);
+
 
 /**
  * This function encodes the metadata received from the plugin
@@ -161,6 +219,20 @@ void MPMParseMetaData(const uint8_t *buffer, size_t size, MPMResourceList **list
  */
 MPMResult MPMSendResponse(const void *response, size_t size, MPMMessageType type);
 
+/**
+ * This function starts collecting the responses sent with MPMSendResponse, so that
+ * they are written to the mpm library together by MPMFlushResponses. The plugin
+ * server calls it around each request handed to the plugin.
+ */
+void MPMBeginResponseBatch();
+
+/**
+ * This function writes the responses collected since MPMBeginResponseBatch and
+ * sends later responses straight away again
+ * @return MPM_RESULT_OK on success else MPM_RESULT_INTERNAL_ERROR
+ */
+MPMResult MPMFlushResponses();
+
 #ifdef __cplusplus
 }
 #endif // #ifdef __cplusplus
@@ -67,6 +67,13 @@ struct MPMCommonPluginCtx
     MPMPipe parent_reads_fds;
     MPMPipe child_reads_fds;
 
+    /**
+     * Buffers for the read ends of the pipes. The parent reads messages from the
+     * plugin through parent_reader and the child reads requests through child_reader.
+     */
+    MPMPipeReader parent_reader;
+    MPMPipeReader child_reader;
+
     /**
      * The "started" variable is used by the parent process to not permit
      * more than one fork to happen per instance of the plugin.
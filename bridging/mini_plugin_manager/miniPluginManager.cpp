@@ -115,9 +115,6 @@ static void *readResponse(void *)
 
     std::vector<MPMPluginContext> *loadedPlugins = &g_LoadedPlugins;
 
-    tv.tv_sec = 5;
-    tv.tv_usec = 0;
-
     while (true)
     {
         if (exitResponseThread == true)
@@ -127,6 +124,12 @@ static void *readResponse(void *)
         }
         int maxFd = -1;
 
+        /* select may modify the timeout, so set it on every pass. Waiting in select
+         * rather than sleeping hands messages to the client as soon as they arrive.
+         */
+        tv.tv_sec = 1;
+        tv.tv_usec = 0;
+
         FD_ZERO(&(readfds));
 
         loadedPluginsItr = loadedPlugins->begin();
@@ -168,44 +171,40 @@ static void *readResponse(void *)
                     MPMPipeMessage pipe_message;
                     ssize_t readbytes = 0;
 
-                    pipe_message.payloadSize = 0;
-                    pipe_message.msgType = MPM_NOMSG;
-                    pipe_message.payload = NULL;
-                    readbytes = MPMReadPipeMessage(ctx->parent_reads_fds.read_fd, &pipe_message);
+                    readbytes = MPMPipeReaderFill(&ctx->parent_reader,
+                                                  ctx->parent_reads_fds.read_fd);
                     if ((childStat != 0) || (readbytes <= 0))
                     {
                         OIC_LOG_V(DEBUG, TAG, "Plugin %s is exited",
                                   (*loadedPluginsItr).shared_object_name);
-                        if (pipe_message.payloadSize > 0)
-                        {
-                            OICFree((void*)pipe_message.payload);
-                            pipe_message.payload = NULL;
-                            pipe_message.payloadSize = 0;
-                        }
+                        MPMPipeReaderFree(&ctx->parent_reader);
                         ctx->started = false;
                     }
                     else
                     {
-                        (*loadedPluginsItr).callbackClient((uint32_t)pipe_message.msgType,
-                                                           (MPMMessage)pipe_message.payload,
-                                                           pipe_message.payloadSize,
-                                                           (*loadedPluginsItr).shared_object_name);
-
-                        pipe_message.msgType = MPM_NOMSG;
-                        if (pipe_message.payloadSize > 0)
+                        /* One read returns every message the plugin has written so far */
+                        MPMResult next = MPM_RESULT_OK;
+                        while ((next = MPMPipeReaderNext(&ctx->parent_reader, &pipe_message))
+                               != MPM_RESULT_NOT_PRESENT)
                         {
+                            if (next != MPM_RESULT_OK)
+                            {
+                                // The message was dropped, carry on with the ones behind it.
+                                continue;
+                            }
+                            (*loadedPluginsItr).callbackClient((uint32_t)pipe_message.msgType,
+                                                               (MPMMessage)pipe_message.payload,
+                                                               pipe_message.payloadSize,
+                                                               (*loadedPluginsItr).shared_object_name);
+
                             OICFree((void*)pipe_message.payload);
                             pipe_message.payload = NULL;
-                            pipe_message.payloadSize = 0;
                         }
-
                     }
                 }
             }
             loadedPluginsItr++;
         }
-
-        sleep(1);
     }
 
     return (void *)loadedPlugins;
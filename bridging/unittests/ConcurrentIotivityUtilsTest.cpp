@@ -0,0 +1,241 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "ConcurrentIotivityUtils.h"
+#include "ocpayload.h"
+
+using namespace OC::Bridging;
+
+namespace
+{
+    const char TEST_URI[] = "/bridging/test";
+    const char TEST_REQUEST_URI[] = "127.0.0.1:5683/bridging/test";
+
+    /**
+     * Records the order in which work items are processed.
+     */
+    class ProcessedItems
+    {
+        public:
+            void add(int sequence)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_sequences.push_back(sequence);
+                m_cv.notify_all();
+            }
+
+            bool waitFor(size_t count)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                return m_cv.wait_for(lock, std::chrono::seconds(5), [this, count]()
+                {
+                    return m_sequences.size() >= count;
+                });
+            }
+
+            std::vector<int> sequences()
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_sequences;
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            std::vector<int> m_sequences;
+    };
+
+    class RecordingWorkItem : public IotivityWorkItem
+    {
+        public:
+            RecordingWorkItem(ProcessedItems &items, int sequence)
+            : m_items(items)
+            , m_sequence(sequence)
+            {
+            }
+
+            virtual void process()
+            {
+                m_items.add(m_sequence);
+            }
+
+        private:
+            ProcessedItems &m_items;
+            int m_sequence;
+    };
+
+    /**
+     * Sends a GET request to the test resource. Queued so the request is made with the
+     * Iotivity API mutex held, like every other call into the stack.
+     */
+    class GetRequestItem : public IotivityWorkItem
+    {
+        public:
+            GetRequestItem(OCClientResponseHandler handler, void *context)
+            {
+                m_uri = TEST_URI;
+                m_callback.cb = handler;
+                m_callback.context = context;
+                m_callback.cd = NULL;
+            }
+
+            virtual void process()
+            {
+                EXPECT_EQ(OC_STACK_OK, OCDoResource(NULL, OC_REST_GET, TEST_REQUEST_URI, NULL,
+                                                    NULL, CT_DEFAULT, OC_LOW_QOS, &m_callback,
+                                                    NULL, 0));
+            }
+
+        private:
+            OCCallbackData m_callback;
+    };
+
+    struct ResponseWaiter
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        int received = 0;
+    };
+
+    OCEntityHandlerResult RespondingEntityHandler(OCEntityHandlerFlag flag,
+            OCEntityHandlerRequest *request, void *context)
+    {
+        (void) flag;
+        (void) context;
+
+        OCRepPayload *payload = OCRepPayloadCreate();
+        OCRepPayloadSetPropBool(payload, "value", true);
+        // Called on the OCProcess() thread, which holds the Iotivity API mutex.
+        EXPECT_EQ(OC_STACK_OK, ConcurrentIotivityUtils::respondToRequest(request, payload,
+                  OC_EH_OK));
+        OCRepPayloadDestroy(payload);
+        return OC_EH_OK;
+    }
+
+    OCStackApplicationResult ResponseHandler(void *context, OCDoHandle handle,
+            OCClientResponse *response)
+    {
+        (void) handle;
+        ResponseWaiter *waiter = static_cast<ResponseWaiter *>(context);
+
+        EXPECT_EQ(OC_STACK_OK, response->result);
+        {
+            std::lock_guard<std::mutex> lock(waiter->mutex);
+            waiter->received++;
+        }
+        waiter->cv.notify_all();
+        return OC_STACK_DELETE_TRANSACTION;
+    }
+}
+
+class ConcurrentIotivityUtilsTest : public testing::Test
+{
+    protected:
+        virtual void SetUp()
+        {
+            ASSERT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_CLIENT_SERVER));
+            auto queue = make_unique<WorkQueue<std::unique_ptr<IotivityWorkItem>>>();
+            m_queue = queue.get();
+            m_utils = make_unique<ConcurrentIotivityUtils>(std::move(queue));
+        }
+
+        virtual void TearDown()
+        {
+            m_utils.reset();
+            OCStop();
+        }
+
+        WorkQueue<std::unique_ptr<IotivityWorkItem>> *m_queue;
+        std::unique_ptr<ConcurrentIotivityUtils> m_utils;
+};
+
+TEST_F(ConcurrentIotivityUtilsTest, ItemsAreProcessedInQueueOrder)
+{
+    const int itemCount = 300;
+    ProcessedItems items;
+
+    m_utils->startWorkerThreads();
+    for (int i = 0; i < itemCount; i++)
+    {
+        m_queue->put(make_unique<RecordingWorkItem>(items, i));
+    }
+    ASSERT_TRUE(items.waitFor(itemCount));
+    m_utils->stopWorkerThreads();
+
+    std::vector<int> sequences = items.sequences();
+    ASSERT_EQ((size_t) itemCount, sequences.size());
+    for (int i = 0; i < itemCount; i++)
+    {
+        EXPECT_EQ(i, sequences[i]);
+    }
+}
+
+TEST_F(ConcurrentIotivityUtilsTest, SecondInstanceDoesNotReplaceTheQueue)
+{
+    ProcessedItems items;
+    auto queue = make_unique<WorkQueue<std::unique_ptr<IotivityWorkItem>>>();
+
+    EXPECT_ANY_THROW(ConcurrentIotivityUtils second(std::move(queue)));
+
+    // The queue of the first instance is still the one being serviced.
+    m_utils->startWorkerThreads();
+    m_queue->put(make_unique<RecordingWorkItem>(items, 1));
+    EXPECT_TRUE(items.waitFor(1));
+    m_utils->stopWorkerThreads();
+}
+
+TEST_F(ConcurrentIotivityUtilsTest, OCProcessRunsWhenDataIsReceived)
+{
+    const int requestCount = 10;
+    ResponseWaiter waiter;
+
+    OCResourceHandle handle;
+    ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle, "x.org.iotivity.test",
+                                            OC_RSRVD_INTERFACE_DEFAULT, TEST_URI,
+                                            RespondingEntityHandler, NULL, OC_DISCOVERABLE));
+    m_utils->startWorkerThreads();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < requestCount; i++)
+    {
+        m_queue->put(make_unique<GetRequestItem>(ResponseHandler, &waiter));
+
+        std::unique_lock<std::mutex> lock(waiter.mutex);
+        ASSERT_TRUE(waiter.cv.wait_for(lock, std::chrono::seconds(5), [&waiter, i]()
+        {
+            return waiter.received > i;
+        }));
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start);
+
+    m_utils->stopWorkerThreads();
+
+    // Each round trip waits twice for OCProcess(): for the request and for the response.
+    // Polling every 100 ms would take about a second; waking on receive takes far less.
+    EXPECT_GT(500, elapsed.count());
+}
@@ -0,0 +1,420 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "curlAsyncClient.h"
+
+using namespace OC::Bridging;
+
+namespace
+{
+    /**
+     * HTTP/1.1 server on the loopback interface. It answers each request with the request
+     * path as the body, and keeps the connection open. Requests for HOLD_PATH are answered
+     * only once release() is called.
+     */
+    class LoopbackHttpServer
+    {
+        public:
+            static const char *const HOLD_PATH;
+
+            LoopbackHttpServer() : m_listenFd(-1), m_port(0), m_acceptCount(0),
+                m_heldCount(0), m_released(false), m_stopped(false)
+            {
+                m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+                struct sockaddr_in addr = {};
+                addr.sin_family = AF_INET;
+                addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                socklen_t addrLen = sizeof(addr);
+                if (m_listenFd < 0 ||
+                    0 != bind(m_listenFd, (struct sockaddr *) &addr, sizeof(addr)) ||
+                    0 != listen(m_listenFd, 16) ||
+                    0 != getsockname(m_listenFd, (struct sockaddr *) &addr, &addrLen))
+                {
+                    return;
+                }
+                m_port = ntohs(addr.sin_port);
+                m_acceptThread = std::thread(&LoopbackHttpServer::acceptConnections, this);
+            }
+
+            ~LoopbackHttpServer()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopped = true;
+                    m_released = true;
+                    for (int fd : m_connectionFds)
+                    {
+                        ::shutdown(fd, SHUT_RDWR);
+                    }
+                }
+                m_cv.notify_all();
+
+                if (m_listenFd >= 0)
+                {
+                    ::shutdown(m_listenFd, SHUT_RDWR);
+                    close(m_listenFd);
+                }
+                if (m_acceptThread.joinable())
+                {
+                    m_acceptThread.join();
+                }
+                for (std::thread &thread : m_connectionThreads)
+                {
+                    thread.join();
+                }
+            }
+
+            std::string url(const std::string &path) const
+            {
+                return "http://127.0.0.1:" + std::to_string(m_port) + path;
+            }
+
+            bool isRunning() const
+            {
+                return 0 != m_port;
+            }
+
+            size_t acceptCount()
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_acceptCount;
+            }
+
+            bool waitForHeld(size_t count)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                return m_cv.wait_for(lock, std::chrono::seconds(5), [this, count]()
+                {
+                    return m_heldCount >= count;
+                });
+            }
+
+            void release()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_released = true;
+                }
+                m_cv.notify_all();
+            }
+
+        private:
+            void acceptConnections()
+            {
+                while (true)
+                {
+                    int fd = accept(m_listenFd, NULL, NULL);
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (fd < 0 || m_stopped)
+                    {
+                        if (fd >= 0)
+                        {
+                            close(fd);
+                        }
+                        return;
+                    }
+                    m_acceptCount++;
+                    m_connectionFds.insert(fd);
+                    m_connectionThreads.push_back(
+                        std::thread(&LoopbackHttpServer::serveConnection, this, fd));
+                }
+            }
+
+            void serveConnection(int fd)
+            {
+                std::string buffer;
+                char chunk[1024];
+                while (true)
+                {
+                    size_t headerEnd = buffer.find("\r\n\r\n");
+                    if (std::string::npos == headerEnd)
+                    {
+                        ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+                        if (received <= 0)
+                        {
+                            break;
+                        }
+                        buffer.append(chunk, received);
+                        continue;
+                    }
+
+                    // The client posts its (empty) body, skip it.
+                    size_t bodyLength = 0;
+                    size_t lengthPos = buffer.find("Content-Length:");
+                    if (std::string::npos != lengthPos && lengthPos < headerEnd)
+                    {
+                        bodyLength = std::strtoul(buffer.c_str() + lengthPos + 15, NULL, 10);
+                    }
+                    if (buffer.size() < headerEnd + 4 + bodyLength)
+                    {
+                        ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+                        if (received <= 0)
+                        {
+                            break;
+                        }
+                        buffer.append(chunk, received);
+                        continue;
+                    }
+
+                    size_t pathStart = buffer.find(' ') + 1;
+                    std::string path = buffer.substr(pathStart, buffer.find(' ', pathStart) -
+                                                     pathStart);
+                    buffer.erase(0, headerEnd + 4 + bodyLength);
+
+                    if (path == HOLD_PATH)
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_heldCount++;
+                        m_cv.notify_all();
+                        m_cv.wait(lock, [this]() { return m_released; });
+                        if (m_stopped)
+                        {
+                            break;
+                        }
+                    }
+
+                    std::string response = "HTTP/1.1 200 OK\r\nContent-Length: " +
+                                           std::to_string(path.size()) +
+                                           "\r\nX-Test: yes\r\n\r\n" + path;
+                    if (send(fd, response.c_str(), response.size(), MSG_NOSIGNAL) < 0)
+                    {
+                        break;
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_connectionFds.erase(fd);
+                close(fd);
+            }
+
+            int m_listenFd;
+            uint16_t m_port;
+            std::thread m_acceptThread;
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            std::set<int> m_connectionFds;
+            std::vector<std::thread> m_connectionThreads;
+            size_t m_acceptCount;
+            size_t m_heldCount;
+            bool m_released;
+            bool m_stopped;
+    };
+
+    const char *const LoopbackHttpServer::HOLD_PATH = "/hold";
+
+    /**
+     * Records the responses passed to completion callbacks.
+     */
+    class Responses
+    {
+        public:
+            CurlCallback callback()
+            {
+                return [this](CurlResponse & response)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_responses.push_back(response);
+                    m_threadIds.insert(std::this_thread::get_id());
+                    m_cv.notify_all();
+                };
+            }
+
+            bool waitFor(size_t count)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                return m_cv.wait_for(lock, std::chrono::seconds(10), [this, count]()
+                {
+                    return m_responses.size() >= count;
+                });
+            }
+
+            std::vector<CurlResponse> responses()
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_responses;
+            }
+
+            std::set<std::thread::id> threadIds()
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_threadIds;
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            std::vector<CurlResponse> m_responses;
+            std::set<std::thread::id> m_threadIds;
+    };
+
+    CurlRequest makeRequest(const std::string &url)
+    {
+        CurlRequest request;
+        request.url = url;
+        request.method = "GET";
+        return request;
+    }
+}
+
+namespace OC
+{
+namespace Bridging
+{
+
+/**
+ * Runs a CurlAsyncClient of its own, rather than the process wide instance.
+ */
+class CurlAsyncClientTest : public testing::Test
+{
+    protected:
+        virtual void SetUp()
+        {
+            // The loopback server must be reached directly.
+            unsetenv("http_proxy");
+            unsetenv("HTTP_PROXY");
+            unsetenv("all_proxy");
+            unsetenv("ALL_PROXY");
+
+            m_client.reset(new CurlAsyncClient());
+            ASSERT_TRUE(m_server.isRunning());
+        }
+
+        virtual void TearDown()
+        {
+            m_client.reset();
+        }
+
+        // Only valid once the worker thread has stopped.
+        size_t idleHandleCount()
+        {
+            return m_client->m_idleHandles.size();
+        }
+
+        LoopbackHttpServer m_server;
+        std::unique_ptr<CurlAsyncClient> m_client;
+};
+
+TEST_F(CurlAsyncClientTest, HandleAndConnectionAreReused)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        std::string path = "/reuse/" + std::to_string(i);
+        std::future<CurlResponse> future = m_client->send(makeRequest(m_server.url(path)));
+        ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(10)));
+
+        CurlResponse response = future.get();
+        EXPECT_EQ(MPM_RESULT_OK, response.result);
+        EXPECT_EQ(200, response.responseCode);
+        EXPECT_EQ(path, response.body);
+    }
+
+    // One request at a time needs a single easy handle and a single connection.
+    EXPECT_EQ(1u, m_server.acceptCount());
+    m_client->shutdown();
+    EXPECT_EQ(1u, idleHandleCount());
+}
+
+TEST_F(CurlAsyncClientTest, CompletionCallbacksAreDispatched)
+{
+    const size_t requestCount = 6;
+    Responses responses;
+    for (size_t i = 0; i < requestCount; i++)
+    {
+        std::string path = "/dispatch/" + std::to_string(i);
+        ASSERT_EQ(MPM_RESULT_OK, m_client->send(makeRequest(m_server.url(path)),
+                                                responses.callback()));
+    }
+
+    ASSERT_TRUE(responses.waitFor(requestCount));
+
+    // Each callback is called once, with its own response, on the worker thread.
+    std::set<std::string> bodies;
+    for (const CurlResponse &response : responses.responses())
+    {
+        EXPECT_EQ(MPM_RESULT_OK, response.result);
+        EXPECT_EQ(200, response.responseCode);
+        EXPECT_NE(response.headers.end(),
+                  std::find(response.headers.begin(), response.headers.end(), "X-Test: yes"));
+        bodies.insert(response.body);
+    }
+    EXPECT_EQ(requestCount, bodies.size());
+    EXPECT_EQ(requestCount, responses.responses().size());
+
+    std::set<std::thread::id> threadIds = responses.threadIds();
+    ASSERT_EQ(1u, threadIds.size());
+    EXPECT_NE(std::this_thread::get_id(), *threadIds.begin());
+
+    // A request to no server completes with an error instead of a response.
+    CurlResponse response = m_client->send(makeRequest("http://127.0.0.1:1/")).get();
+    EXPECT_EQ(MPM_RESULT_NETWORK_ERROR, response.result);
+
+    EXPECT_EQ(MPM_RESULT_INVALID_PARAMETER, m_client->send(makeRequest(""),
+                                                           responses.callback()));
+}
+
+TEST_F(CurlAsyncClientTest, ShutdownCompletesRequestsInFlight)
+{
+    const size_t requestCount = 3;
+    Responses responses;
+    for (size_t i = 0; i < requestCount; i++)
+    {
+        ASSERT_EQ(MPM_RESULT_OK, m_client->send(
+                      makeRequest(m_server.url(LoopbackHttpServer::HOLD_PATH)),
+                      responses.callback()));
+    }
+    // The others wait in the multi handle for the held connection.
+    ASSERT_TRUE(m_server.waitForHeld(1));
+
+    m_client->shutdown();
+
+    // Every request in flight completes with an error, without waiting for the server.
+    ASSERT_EQ(requestCount, responses.responses().size());
+    for (const CurlResponse &response : responses.responses())
+    {
+        EXPECT_EQ(MPM_RESULT_INTERNAL_ERROR, response.result);
+    }
+
+    // Later requests are refused.
+    EXPECT_EQ(MPM_RESULT_INTERNAL_ERROR, m_client->send(makeRequest(m_server.url("/late")),
+                                                        responses.callback()));
+    EXPECT_EQ(MPM_RESULT_INTERNAL_ERROR,
+              m_client->send(makeRequest(m_server.url("/late"))).get().result);
+    EXPECT_EQ(requestCount, responses.responses().size());
+}
+
+}
+}
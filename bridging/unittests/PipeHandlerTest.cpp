@@ -0,0 +1,205 @@
+//******************************************************************
+//
+// Copyright 2017 Intel Mobile Communications GmbH All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "messageHandler.h"
+#include "oic_malloc.h"
+
+namespace
+{
+    /**
+     * Encodes a frame the way MPMWritePipeMessages does, so that tests can write it in pieces.
+     */
+    std::vector<uint8_t> encodeFrame(MPMMessageType msgType, const std::string &payload,
+                                     size_t payloadSize)
+    {
+        std::vector<uint8_t> frame(sizeof(size_t) + sizeof(MPMMessageType));
+        memcpy(&frame[0], &payloadSize, sizeof(size_t));
+        memcpy(&frame[sizeof(size_t)], &msgType, sizeof(MPMMessageType));
+        frame.insert(frame.end(), payload.begin(), payload.end());
+        return frame;
+    }
+
+    std::vector<uint8_t> encodeFrame(MPMMessageType msgType, const std::string &payload)
+    {
+        return encodeFrame(msgType, payload, payload.size());
+    }
+
+    MPMPipeMessage makeMessage(MPMMessageType msgType, const std::string &payload)
+    {
+        MPMPipeMessage message;
+        message.msgType = msgType;
+        message.payloadSize = payload.size();
+        message.payload = (const uint8_t *) payload.data();
+        return message;
+    }
+}
+
+class PipeHandlerTest : public testing::Test
+{
+    protected:
+        virtual void SetUp()
+        {
+            memset(&m_reader, 0, sizeof(m_reader));
+            ASSERT_EQ(0, pipe(m_fds));
+        }
+
+        virtual void TearDown()
+        {
+            MPMPipeReaderFree(&m_reader);
+            close(m_fds[0]);
+            if (m_fds[1] >= 0)
+            {
+                close(m_fds[1]);
+            }
+        }
+
+        void writeBytes(const std::vector<uint8_t> &bytes, size_t offset, size_t length)
+        {
+            ASSERT_EQ((ssize_t) length, write(m_fds[1], &bytes[offset], length));
+        }
+
+        // Takes the next message, and returns its payload or "<none>" when there is none.
+        std::string next(MPMMessageType *msgType)
+        {
+            MPMPipeMessage message = {};
+            if (MPM_RESULT_OK != MPMPipeReaderNext(&m_reader, &message))
+            {
+                return "<none>";
+            }
+            std::string payload((const char *) message.payload, message.payloadSize);
+            OICFree((void *) message.payload);
+            *msgType = message.msgType;
+            return payload;
+        }
+
+        int m_fds[2];
+        MPMPipeReader m_reader;
+};
+
+TEST_F(PipeHandlerTest, SeveralFramesAreDecodedFromOneRead)
+{
+    std::string scan = "scan payload";
+    std::string add = "{\"uri\":\"/light/1\"}";
+    MPMPipeMessage messages[] =
+    {
+        makeMessage(MPM_SCAN, scan),
+        makeMessage(MPM_NOMSG, ""),
+        makeMessage(MPM_STOP, ""),
+        makeMessage(MPM_ADD, add),
+    };
+    ASSERT_EQ(MPM_RESULT_OK, MPMWritePipeMessages(m_fds[1], messages,
+                                                  sizeof(messages) / sizeof(messages[0])));
+
+    size_t frameBytes = 4 * (sizeof(size_t) + sizeof(MPMMessageType)) + scan.size() + add.size();
+    ASSERT_EQ((ssize_t) frameBytes, MPMPipeReaderFill(&m_reader, m_fds[0]));
+
+    // MPM_NOMSG frames are skipped.
+    MPMMessageType msgType = MPM_NOMSG;
+    EXPECT_EQ(scan, next(&msgType));
+    EXPECT_EQ(MPM_SCAN, msgType);
+    EXPECT_EQ("", next(&msgType));
+    EXPECT_EQ(MPM_STOP, msgType);
+    EXPECT_EQ(add, next(&msgType));
+    EXPECT_EQ(MPM_ADD, msgType);
+    EXPECT_EQ("<none>", next(&msgType));
+}
+
+TEST_F(PipeHandlerTest, PartialFrameIsHeldBackUntilComplete)
+{
+    std::string payload = "partial frame payload";
+    std::vector<uint8_t> frame = encodeFrame(MPM_ADD, payload);
+    size_t headerSize = frame.size() - payload.size();
+    MPMMessageType msgType = MPM_NOMSG;
+
+    // Short header.
+    writeBytes(frame, 0, 3);
+    ASSERT_EQ(3, MPMPipeReaderFill(&m_reader, m_fds[0]));
+    EXPECT_EQ("<none>", next(&msgType));
+
+    // Complete header, but only part of the payload.
+    writeBytes(frame, 3, headerSize + 4 - 3);
+    ASSERT_LT(0, MPMPipeReaderFill(&m_reader, m_fds[0]));
+    EXPECT_EQ("<none>", next(&msgType));
+
+    // The rest of the frame followed by the start of the next one.
+    std::vector<uint8_t> nextFrame = encodeFrame(MPM_DELETE, "next");
+    frame.insert(frame.end(), nextFrame.begin(), nextFrame.begin() + 5);
+    writeBytes(frame, headerSize + 4, frame.size() - headerSize - 4);
+    ASSERT_LT(0, MPMPipeReaderFill(&m_reader, m_fds[0]));
+    EXPECT_EQ(payload, next(&msgType));
+    EXPECT_EQ(MPM_ADD, msgType);
+    EXPECT_EQ("<none>", next(&msgType));
+
+    writeBytes(nextFrame, 5, nextFrame.size() - 5);
+    ASSERT_LT(0, MPMPipeReaderFill(&m_reader, m_fds[0]));
+    EXPECT_EQ("next", next(&msgType));
+    EXPECT_EQ(MPM_DELETE, msgType);
+}
+
+TEST_F(PipeHandlerTest, FrameLargerThanTheBufferIsDecoded)
+{
+    std::string payload(20000, '\0');
+    for (size_t i = 0; i < payload.size(); i++)
+    {
+        payload[i] = (char) ('a' + i % 26);
+    }
+    std::vector<uint8_t> frame = encodeFrame(MPM_RECONNECT, payload);
+    writeBytes(frame, 0, frame.size());
+
+    // The buffer grows with each fill until the whole frame fits.
+    std::string decoded = "<none>";
+    MPMMessageType msgType = MPM_NOMSG;
+    for (int fills = 0; fills < 16 && decoded == "<none>"; fills++)
+    {
+        ASSERT_LT(0, MPMPipeReaderFill(&m_reader, m_fds[0]));
+        decoded = next(&msgType);
+    }
+    EXPECT_EQ(MPM_RECONNECT, msgType);
+    EXPECT_EQ(payload, decoded);
+    EXPECT_EQ("<none>", next(&msgType));
+}
+
+TEST_F(PipeHandlerTest, OversizeHeaderReturnsNoMessage)
+{
+    // A header claiming more payload than will ever arrive.
+    std::vector<uint8_t> frame = encodeFrame(MPM_ADD, "truncated", SIZE_MAX);
+    writeBytes(frame, 0, frame.size());
+    ASSERT_EQ((ssize_t) frame.size(), MPMPipeReaderFill(&m_reader, m_fds[0]));
+
+    MPMMessageType msgType = MPM_NOMSG;
+    EXPECT_EQ("<none>", next(&msgType));
+    EXPECT_EQ(0u, m_reader.start);
+    EXPECT_EQ(frame.size(), m_reader.end);
+
+    // The writer going away is seen as end of file.
+    close(m_fds[1]);
+    m_fds[1] = -1;
+    EXPECT_EQ(0, MPMPipeReaderFill(&m_reader, m_fds[0]));
+    EXPECT_EQ("<none>", next(&msgType));
+}
@@ -26,6 +26,9 @@
 #include <vector>
 #include <atomic>
 #include <map>
+#include <deque>
+#include <queue>
+#include <thread>
 #include <memory>
 #include <condition_variable>
 
@@ -85,6 +85,33 @@ typedef struct DeviceDetails
     std::vector<std::string> discoveredResourceInterfaces;
 } DeviceDetails;
 
+// Work the worker thread does for a device once a deadline has passed.
+typedef enum
+{
+    // Forget the device if the app has not opened it for a while.
+    DeviceDeadline_ExpireUnopened,
+
+    // Tell apps the device stopped responding to discovery.
+    DeviceDeadline_NotResponding,
+
+    // Retry requests for device info, platform info and maintenance resource.
+    DeviceDeadline_GetCommonResources
+} DeviceDeadlineType;
+
+typedef struct DeviceDeadline
+{
+    // Value is compared to OICGetCurrentTime(TIME_IN_MS).
+    uint64_t deadline;
+    DeviceDeadlineType type;
+    std::string deviceId;
+
+    // Orders the earliest deadline first in a std::priority_queue.
+    bool operator<(const DeviceDeadline& other) const
+    {
+        return deadline > other.deadline;
+    }
+} DeviceDeadline;
+
 typedef struct RequestAccessContext
 {
     std::string deviceId;
@@ -176,6 +203,12 @@ class OCFFramework
                         CallbackInfo::Ptr callbackInfo,
                         CallbackInfo::Ptr passwordInputCallbackInfo);
 
+        // Unit tests shorten the time before unopened devices are forgotten and before devices
+        // are indicated as not responding.  0 restores the default.  Applies to devices
+        // discovered after the call.
+        void SetDeviceTimeouts(uint64_t unopenedDeviceTimeoutMs,
+                        uint64_t discoveryResponseTimeoutMs);
+
     private:
         // Callback from OCF for OCResource->get()
         void OnObserve(const HeaderOptions headerOptions,
@@ -230,7 +263,19 @@ class OCFFramework
         // See m_workerThread variable below.
         static void WorkerThread(OCFFramework* ocfFramework);
 
-        // Entry point for the thread that will request access to a device.
+        // Queue work for the worker thread, waking it up if this is the earliest deadline.
+        void ScheduleDeviceDeadline(const std::string& deviceId,
+                    DeviceDeadlineType type,
+                    uint64_t deadline);
+
+        // Called by the worker thread for deadlines that have passed.
+        void ProcessDeviceDeadlines(const std::vector<DeviceDeadline>& dueDeadlines,
+                    uint64_t currentTime);
+
+        // Entry point for the threads of the RequestAccess pool.
+        static void RequestAccessPoolThread(OCFFramework* ocfFramework);
+
+        // Requests access to a device.  Runs on a RequestAccess pool thread.
         static void RequestAccessWorkerThread(RequestAccessContext* requestContext);
 
         // Get DeviceDetails for deviceId.
@@ -276,9 +321,29 @@ class OCFFramework
 
         // One Callback per App. One App per IPCAOpen().
         std::vector<Callback::Ptr> m_callbacks;
+
+        // Worker thread sleeps until the earliest deadline in m_deviceDeadlines.
+        // The deadlines are checked against the device state when they pass, so they are not
+        // removed when the state changes.  m_workerThreadMutex protects m_deviceDeadlines and
+        // is never held while taking m_OCFFrameworkMutex.
         std::thread m_workerThread;
         std::condition_variable m_workerThreadCV;
         std::mutex m_workerThreadMutex;
+        std::priority_queue<DeviceDeadline> m_deviceDeadlines;
+
+        // Timeouts of the DeviceDeadline_ExpireUnopened and DeviceDeadline_NotResponding
+        // deadlines.  Protected by m_OCFFrameworkMutex.
+        uint64_t m_unopenedDeviceTimeoutMs;
+        uint64_t m_discoveryResponseTimeoutMs;
+
+        // Threads that run RequestAccess() calls, created as needed up to a fixed count.
+        // m_requestAccessMutex protects the members below.
+        std::vector<std::thread> m_requestAccessThreads;
+        std::deque<RequestAccessContext*> m_requestAccessQueue;
+        std::condition_variable m_requestAccessCV;
+        std::mutex m_requestAccessMutex;
+        size_t m_idleRequestAccessThreadCount;
+        bool m_isRequestAccessStopping;
 
         // Synchronize Start()/Stop()
         std::mutex m_startStopMutex;
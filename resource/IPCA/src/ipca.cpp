@@ -535,3 +535,12 @@ void IPCA_CALL IPCASetUnitTestMode()
 {
     g_unitTestMode = true;
 }
+
+// Defined in app.cpp.
+extern OCFFramework ocfFramework;
+
+void IPCA_CALL IPCASetUnitTestDeviceTimeouts(uint64_t unopenedDeviceTimeoutMs,
+                                             uint64_t discoveryResponseTimeoutMs)
+{
+    ocfFramework.SetDeviceTimeouts(unopenedDeviceTimeoutMs, discoveryResponseTimeoutMs);
+}
@@ -40,6 +40,12 @@ using namespace std::placeholders;
 const unsigned short c_discoveryTimeout = 5;  // Max number of seconds to discover
                                               // security information for a device
 
+const uint64_t c_unopenedDeviceTimeoutMs = 300000;    // Forget devices not opened by app
+const uint64_t c_discoveryResponseTimeoutMs = 60000;  // Device is not responding after this
+const uint64_t c_commonResourcesRetryMs = 2000;       // Retry interval for device & platform info
+const size_t c_maxCommonResourcesRequestCount = 3;    // Requests sent for each common resource
+const size_t c_maxRequestAccessThreadCount = 4;       // Threads running RequestAccess() calls
+
 // Path for Persistent Storage (Ends with backslash (\) or forward slash (/))
 std::string  g_psPath;
 
@@ -59,6 +65,10 @@ FILE* server_fopen(const char *path, const char *mode)
 OCPersistentStorage ps = {server_fopen, fread, fwrite, fclose, unlink};
 
 OCFFramework::OCFFramework() :
+    m_unopenedDeviceTimeoutMs(c_unopenedDeviceTimeoutMs),
+    m_discoveryResponseTimeoutMs(c_discoveryResponseTimeoutMs),
+    m_idleRequestAccessThreadCount(0),
+    m_isRequestAccessStopping(false),
     m_isStarted(false),
     m_isStopping(false)
 {
@@ -378,7 +388,10 @@ IPCAStatus OCFFramework::Stop(InputPinCallbackHandle passwordInputCallbackHandle
     OCSecure::deregisterDisplayPinCallback(passwordDisplayCallbackHandle);
     OCSecure::provisionClose();
 
-    m_isStopping = true;
+    {
+        std::lock_guard<std::mutex> workerThreadLock(m_workerThreadMutex);
+        m_isStopping = true;
+    }
 
     m_workerThreadCV.notify_all();
     if (m_workerThread.joinable())
@@ -386,6 +399,11 @@ IPCAStatus OCFFramework::Stop(InputPinCallbackHandle passwordInputCallbackHandle
         m_workerThread.join();
     }
 
+    {
+        std::lock_guard<std::mutex> workerThreadLock(m_workerThreadMutex);
+        m_deviceDeadlines = std::priority_queue<DeviceDeadline>();
+    }
+
     if (OCPlatform::stop() != OC_STACK_OK)
     {
         assert(false);
@@ -407,104 +425,207 @@ void OCFFramework::WorkerThread(OCFFramework* ocfFramework)
 {
     std::unique_lock<std::mutex> workerThreadLock(ocfFramework->m_workerThreadMutex);
 
-    const size_t WorkerThreadSleepTimeSeconds = 2;
-    std::chrono::seconds workerThreadSleepTime(WorkerThreadSleepTimeSeconds);
-
     while (false == ocfFramework->m_isStopping)
     {
         uint64_t currentTime = OICGetCurrentTime(TIME_IN_MS);
-        std::vector<DeviceDetails::Ptr> devicesThatAreNotResponding;
-        std::vector<DeviceDetails::Ptr> devicesThatAreNotOpened;
-        std::vector<DeviceDetails::Ptr> devicesToGetCommonResources;
+        std::vector<DeviceDeadline> dueDeadlines;
 
-        // Collect devices that are not used, i.e. discovered a while back and those that are not
-        // used by app for a while.
+        while (!ocfFramework->m_deviceDeadlines.empty() &&
+               (ocfFramework->m_deviceDeadlines.top().deadline <= currentTime))
         {
-            std::lock_guard<std::recursive_mutex> lock(ocfFramework->m_OCFFrameworkMutex);
-            const unsigned int AllowedTimeSincLastCloseMs = 300000;
-            const unsigned int AllowedTimeSinceLastDiscoveryResponseMs = 60000;
+            dueDeadlines.push_back(ocfFramework->m_deviceDeadlines.top());
+            ocfFramework->m_deviceDeadlines.pop();
+        }
 
-            // Walk through each device.
-            for (auto const& device : ocfFramework->m_OCFDevices)
+        if (!dueDeadlines.empty())
+        {
+            // Deadlines may be scheduled while they are processed.
+            workerThreadLock.unlock();
+            ocfFramework->ProcessDeviceDeadlines(dueDeadlines, currentTime);
+            workerThreadLock.lock();
+            continue;
+        }
+
+        if (ocfFramework->m_deviceDeadlines.empty())
+        {
+            ocfFramework->m_workerThreadCV.wait(
+                                workerThreadLock,
+                                [ocfFramework]()
+                                {
+                                    return ocfFramework->m_isStopping ||
+                                           !ocfFramework->m_deviceDeadlines.empty();
+                                });
+            continue;
+        }
+
+        // Sleep until the earliest deadline, or until an earlier one is scheduled.
+        uint64_t nextDeadline = ocfFramework->m_deviceDeadlines.top().deadline;
+        ocfFramework->m_workerThreadCV.wait_for(
+                            workerThreadLock,
+                            std::chrono::milliseconds(nextDeadline - currentTime),
+                            [ocfFramework, nextDeadline]()
+                            {
+                                return ocfFramework->m_isStopping ||
+                                       (ocfFramework->m_deviceDeadlines.top().deadline <
+                                        nextDeadline);
+                            });
+    }
+}
+
+void OCFFramework::ScheduleDeviceDeadline(const std::string& deviceId,
+                                          DeviceDeadlineType type,
+                                          uint64_t deadline)
+{
+    std::lock_guard<std::mutex> workerThreadLock(m_workerThreadMutex);
+
+    bool isEarliest = m_deviceDeadlines.empty() || (deadline < m_deviceDeadlines.top().deadline);
+
+    DeviceDeadline deviceDeadline;
+    deviceDeadline.deadline = deadline;
+    deviceDeadline.type = type;
+    deviceDeadline.deviceId = deviceId;
+    m_deviceDeadlines.push(deviceDeadline);
+
+    if (isEarliest)
+    {
+        m_workerThreadCV.notify_all();
+    }
+}
+
+void OCFFramework::ProcessDeviceDeadlines(const std::vector<DeviceDeadline>& dueDeadlines,
+                                          uint64_t currentTime)
+{
+    std::vector<DeviceDetails::Ptr> devicesThatAreNotResponding;
+    std::vector<DeviceDetails::Ptr> devicesToGetCommonResources;
+
+    // Check each deadline against the current state of its device, which may have changed since
+    // the deadline was scheduled.
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_OCFFrameworkMutex);
+
+        for (const auto& dueDeadline : dueDeadlines)
+        {
+            auto deviceIterator = m_OCFDevices.find(dueDeadline.deviceId);
+            if (deviceIterator == m_OCFDevices.end())
             {
-                // Is device opened by app?
-                if ((device.second->deviceOpenCount == 0) &&
-                    (currentTime - device.second->lastCloseDeviceTime > AllowedTimeSincLastCloseMs))
-                {
-                    devicesThatAreNotOpened.push_back(device.second);
-                    continue;  // device details is about to be deleted.
-                }
+                continue;   // device was deleted.
+            }
 
-                // Has device responded to Discovery?
-                if ((device.second->deviceNotRespondingIndicated == false) &&
-                    (currentTime - device.second->lastResponseTimeToDiscovery > AllowedTimeSinceLastDiscoveryResponseMs))
+            DeviceDetails::Ptr device = deviceIterator->second;
+            switch (dueDeadline.type)
+            {
+                case DeviceDeadline_ExpireUnopened:
                 {
-                    device.second->deviceNotRespondingIndicated = true;
-                    devicesThatAreNotResponding.push_back(device.second);
+                    // Is device opened by app?  Closing it schedules a new deadline.
+                    if (device->deviceOpenCount != 0)
+                    {
+                        break;
+                    }
+
+                    uint64_t expiryTime = device->lastCloseDeviceTime + m_unopenedDeviceTimeoutMs;
+                    if (currentTime < expiryTime)
+                    {
+                        ScheduleDeviceDeadline(device->deviceId, dueDeadline.type, expiryTime);
+                        break;
+                    }
+
+                    // Erase unopened device from the m_OCFDevices.
+                    for (auto const& deviceUri : device->deviceUris)
+                    {
+                        m_OCFDevicesIndexedByDeviceURI.erase(deviceUri);
+                    }
+
+                    m_OCFDevices.erase(deviceIterator);
+                    OIC_LOG_V(INFO, TAG, "Device deleted from m_OCFDevices: %s",
+                        device->deviceId.c_str());
+                    break;
                 }
 
-                // Are there common resources that are not yet obtained.
-                if (!device.second->deviceInfoAvailable ||
-                    !device.second->platformInfoAvailable ||
-                    !device.second->maintenanceResourceAvailable)
+                case DeviceDeadline_NotResponding:
                 {
-                     devicesToGetCommonResources.push_back(device.second);
+                    // Has device responded to Discovery?  OnResourceFound() schedules a new
+                    // deadline once an indicated device responds again.
+                    if (device->deviceNotRespondingIndicated)
+                    {
+                        break;
+                    }
+
+                    uint64_t expiryTime = device->lastResponseTimeToDiscovery +
+                                          m_discoveryResponseTimeoutMs;
+                    if (currentTime < expiryTime)
+                    {
+                        ScheduleDeviceDeadline(device->deviceId, dueDeadline.type, expiryTime);
+                        break;
+                    }
+
+                    device->deviceNotRespondingIndicated = true;
+                    devicesThatAreNotResponding.push_back(device);
+                    break;
                 }
-            }
 
-            // Erase unopened devices from the m_OCFDevices.
-            for (auto& device : devicesThatAreNotOpened)
-            {
-                for (auto const& deviceUri : ocfFramework->m_OCFDevices[device->deviceId]->deviceUris)
+                case DeviceDeadline_GetCommonResources:
                 {
-                    ocfFramework->m_OCFDevicesIndexedByDeviceURI.erase(deviceUri);
+                    // Are there common resources that are not yet obtained, and can they still
+                    // be requested?
+                    if ((!device->deviceInfoAvailable &&
+                         (device->deviceInfoRequestCount < c_maxCommonResourcesRequestCount)) ||
+                        (!device->platformInfoAvailable &&
+                         (device->platformInfoRequestCount < c_maxCommonResourcesRequestCount)) ||
+                        (!device->maintenanceResourceAvailable &&
+                         (device->maintenanceResourceRequestCount <
+                          c_maxCommonResourcesRequestCount)))
+                    {
+                        devicesToGetCommonResources.push_back(device);
+                        ScheduleDeviceDeadline(device->deviceId, dueDeadline.type,
+                                               currentTime + c_commonResourcesRetryMs);
+                    }
+                    break;
                 }
 
-                ocfFramework->m_OCFDevices.erase(device->deviceId);
-                OIC_LOG_V(INFO, TAG, "Device deleted from m_OCFDevices: %s",
-                    device->deviceId.c_str());
+                default:
+                    assert(false);
+                    break;
             }
         }
+    }
 
-        // Get common resources.
-        for (const auto& device : devicesToGetCommonResources)
-        {
-            ocfFramework->GetCommonResources(device);
-        }
+    // Get common resources.
+    for (const auto& device : devicesToGetCommonResources)
+    {
+        GetCommonResources(device);
+    }
 
-        // Take a snapshot of callbacks for thread safe iteration.
-        std::vector<Callback::Ptr> callbackSnapshot;
-        ocfFramework->ThreadSafeCopy(ocfFramework->m_callbacks, callbackSnapshot);
+    if (devicesThatAreNotResponding.empty())
+    {
+        return;
+    }
 
-        // Callback to apps.
-        for (const auto& device : devicesThatAreNotResponding)
-        {
-            // Take a snapshot of device->discoveredResourceTypes and deviceInfo
-            // for thread safe use by the callee.
-            std::vector<std::string> resourceTypesSnapshot;
-            ocfFramework->ThreadSafeCopy(device->discoveredResourceTypes, resourceTypesSnapshot);
+    // Take a snapshot of callbacks for thread safe iteration.
+    std::vector<Callback::Ptr> callbackSnapshot;
+    ThreadSafeCopy(m_callbacks, callbackSnapshot);
 
-            InternalDeviceInfo deviceInfoSnapshot;
-            ocfFramework->ThreadSafeCopy(device->deviceInfo, deviceInfoSnapshot);
+    // Callback to apps.
+    for (const auto& device : devicesThatAreNotResponding)
+    {
+        // Take a snapshot of device->discoveredResourceTypes and deviceInfo
+        // for thread safe use by the callee.
+        std::vector<std::string> resourceTypesSnapshot;
+        ThreadSafeCopy(device->discoveredResourceTypes, resourceTypesSnapshot);
 
-            for (const auto& callback : callbackSnapshot)
-            {
-                callback->DeviceDiscoveryCallback(
-                                        false, /* device is no longer responding to discovery */
-                                        false,
-                                        deviceInfoSnapshot,
-                                        resourceTypesSnapshot);
-            }
-        }
+        InternalDeviceInfo deviceInfoSnapshot;
+        ThreadSafeCopy(device->deviceInfo, deviceInfoSnapshot);
 
-        ocfFramework->m_workerThreadCV.wait_for(
-                            workerThreadLock,
-                            workerThreadSleepTime,
-                            [ocfFramework]() { return ocfFramework->m_isStopping; });
+        for (const auto& callback : callbackSnapshot)
+        {
+            callback->DeviceDiscoveryCallback(
+                                    false, /* device is no longer responding to discovery */
+                                    false,
+                                    deviceInfoSnapshot,
+                                    resourceTypesSnapshot);
+        }
     }
 }
 
-
 IPCAStatus OCFFramework::IPCADeviceOpenCalled(std::string& deviceId)
 {
     std::lock_guard<std::recursive_mutex> lock(m_OCFFrameworkMutex);
@@ -536,6 +657,8 @@ IPCAStatus OCFFramework::IPCADeviceCloseCalled(std::string& deviceId)
         if (--deviceDetails->deviceOpenCount == 0)
         {
             deviceDetails->lastCloseDeviceTime = OICGetCurrentTime(TIME_IN_MS);
+            ScheduleDeviceDeadline(deviceId, DeviceDeadline_ExpireUnopened,
+                deviceDetails->lastCloseDeviceTime + m_unopenedDeviceTimeoutMs);
         }
     }
 
@@ -614,14 +737,24 @@ void OCFFramework::OnResourceFound(std::shared_ptr<OCResource> resource)
 
             OIC_LOG_V(INFO, TAG, "Added device ID: [%s]", resource->sid().c_str());
             OIC_LOG_V(INFO, TAG, "m_OCFDevices count = [%" PRIuPTR "]", m_OCFDevices.size());
+
+            ScheduleDeviceDeadline(deviceDetails->deviceId, DeviceDeadline_ExpireUnopened,
+                deviceDetails->lastCloseDeviceTime + m_unopenedDeviceTimeoutMs);
+            ScheduleDeviceDeadline(deviceDetails->deviceId, DeviceDeadline_GetCommonResources,
+                OICGetCurrentTime(TIME_IN_MS) + c_commonResourcesRetryMs);
         }
 
         // Populate the details about the device.
         deviceDetails = m_OCFDevices[resource->sid()];
 
         // Device is discovered.
-        deviceDetails->deviceNotRespondingIndicated = false;
         deviceDetails->lastResponseTimeToDiscovery = OICGetCurrentTime(TIME_IN_MS);
+        if (newDevice || deviceDetails->deviceNotRespondingIndicated)
+        {
+            deviceDetails->deviceNotRespondingIndicated = false;
+            ScheduleDeviceDeadline(deviceDetails->deviceId, DeviceDeadline_NotResponding,
+                deviceDetails->lastResponseTimeToDiscovery + m_discoveryResponseTimeoutMs);
+        }
 
         if (deviceDetails->resourceMap.find(resourcePath) == deviceDetails->resourceMap.end())
         {
@@ -889,13 +1022,11 @@ void OCFFramework::OnPlatformInfoCallback(const OCRepresentation& rep)
 
 IPCAStatus OCFFramework::GetCommonResources(DeviceDetails::Ptr deviceDetails)
 {
-    const size_t MAX_REQUEST_COUNT = 3;
-
     OCStackResult result;
 
     // Get platform info if device hasn't responded to earlier request.
     if ((deviceDetails->platformInfoAvailable == false) &&
-        (deviceDetails->platformInfoRequestCount < MAX_REQUEST_COUNT))
+        (deviceDetails->platformInfoRequestCount < c_maxCommonResourcesRequestCount))
     {
         // Use host address of oic/p if the resource is returned by oic/res.
         std::string platformResourcePath(OC_RSRVD_PLATFORM_URI);
@@ -920,7 +1051,7 @@ IPCAStatus OCFFramework::GetCommonResources(DeviceDetails::Ptr deviceDetails)
 
     // Get device info.
     if ((deviceDetails->deviceInfoAvailable == false) &&
-        (deviceDetails->deviceInfoRequestCount < MAX_REQUEST_COUNT))
+        (deviceDetails->deviceInfoRequestCount < c_maxCommonResourcesRequestCount))
     {
         // Use host address of oic/d if the resource is returned by oic/res.
         std::string deviceResourcePath(OC_RSRVD_DEVICE_URI);
@@ -947,7 +1078,7 @@ IPCAStatus OCFFramework::GetCommonResources(DeviceDetails::Ptr deviceDetails)
 
     // Get maintenance resource.
     if ((deviceDetails->maintenanceResourceAvailable == false) &&
-        (deviceDetails->maintenanceResourceRequestCount < MAX_REQUEST_COUNT))
+        (deviceDetails->maintenanceResourceRequestCount < c_maxCommonResourcesRequestCount))
     {
         std::ostringstream deviceUri;
         OCConnectivityType connectivityType = CT_DEFAULT;
@@ -1677,8 +1808,7 @@ IPCAStatus OCFFramework::RequestAccess(std::string& deviceId,
     }
 
     // Construct context for the worker thread
-    requestAccessContext = static_cast<RequestAccessContext*>
-                                (OICCalloc(1, sizeof(RequestAccessContext)));
+    requestAccessContext = new (std::nothrow) RequestAccessContext();
     if (nullptr != requestAccessContext)
     {
         requestAccessContext->deviceId = deviceId;
@@ -1688,6 +1818,7 @@ IPCAStatus OCFFramework::RequestAccess(std::string& deviceId,
     }
     else
     {
+        deviceDetails->securityInfo.isStarted = false;
         return IPCA_OUT_OF_MEMORY;
     }
 
@@ -1697,13 +1828,73 @@ IPCAStatus OCFFramework::RequestAccess(std::string& deviceId,
         m_OCFRequestAccessContexts[deviceId] = requestAccessContext;
     }
 
-    // Create a new thread to handle the RequestAccess request
-    deviceDetails->securityInfo.requestAccessThread =
-                std::thread(&OCFFramework::RequestAccessWorkerThread, requestAccessContext);
+    // Queue the request for the RequestAccess pool, adding a thread if they are all busy.
+    {
+        std::lock_guard<std::mutex> lock(m_requestAccessMutex);
+        if (m_isRequestAccessStopping)
+        {
+            std::lock_guard<std::recursive_mutex> ocfFrameworkLock(m_OCFFrameworkMutex);
+            m_OCFRequestAccessContexts.erase(deviceId);
+            delete requestAccessContext;
+            deviceDetails->securityInfo.isStarted = false;
+            return IPCA_FAIL;
+        }
+
+        m_requestAccessQueue.push_back(requestAccessContext);
+
+        if ((m_idleRequestAccessThreadCount < m_requestAccessQueue.size()) &&
+            (m_requestAccessThreads.size() < c_maxRequestAccessThreadCount))
+        {
+            m_requestAccessThreads.push_back(
+                std::thread(&OCFFramework::RequestAccessPoolThread, this));
+        }
+    }
+    m_requestAccessCV.notify_one();
 
     return status;
 }
 
+void OCFFramework::SetDeviceTimeouts(uint64_t unopenedDeviceTimeoutMs,
+                                     uint64_t discoveryResponseTimeoutMs)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_OCFFrameworkMutex);
+    m_unopenedDeviceTimeoutMs =
+        (unopenedDeviceTimeoutMs != 0) ? unopenedDeviceTimeoutMs : c_unopenedDeviceTimeoutMs;
+    m_discoveryResponseTimeoutMs =
+        (discoveryResponseTimeoutMs != 0) ? discoveryResponseTimeoutMs :
+                                            c_discoveryResponseTimeoutMs;
+}
+
+void OCFFramework::RequestAccessPoolThread(OCFFramework* ocfFramework)
+{
+    std::unique_lock<std::mutex> lock(ocfFramework->m_requestAccessMutex);
+
+    while (true)
+    {
+        ocfFramework->m_idleRequestAccessThreadCount++;
+        ocfFramework->m_requestAccessCV.wait(
+                            lock,
+                            [ocfFramework]()
+                            {
+                                return ocfFramework->m_isRequestAccessStopping ||
+                                       !ocfFramework->m_requestAccessQueue.empty();
+                            });
+        ocfFramework->m_idleRequestAccessThreadCount--;
+
+        if (ocfFramework->m_isRequestAccessStopping)
+        {
+            break;
+        }
+
+        RequestAccessContext* requestContext = ocfFramework->m_requestAccessQueue.front();
+        ocfFramework->m_requestAccessQueue.pop_front();
+
+        lock.unlock();
+        RequestAccessWorkerThread(requestContext);
+        lock.lock();
+    }
+}
+
 void OCFFramework::RequestAccessWorkerThread(RequestAccessContext* requestContext)
 {
 #ifndef MULTIPLE_OWNER
@@ -2014,6 +2205,33 @@ void OCFFramework::OnPasswordDisplayCallback(char* passwordBuffer,
 void OCFFramework::CleanupRequestAccessDevices()
 {
     std::vector<DeviceDetails::Ptr> requestAccessDevices;
+    std::deque<RequestAccessContext*> queuedRequests;
+    std::vector<std::thread> requestAccessThreads;
+
+    // Stop the RequestAccess pool.  Requests that have not started yet are failed.
+    {
+        std::lock_guard<std::mutex> lock(m_requestAccessMutex);
+        m_isRequestAccessStopping = true;
+        queuedRequests.swap(m_requestAccessQueue);
+        requestAccessThreads.swap(m_requestAccessThreads);
+    }
+    m_requestAccessCV.notify_all();
+
+    if (!queuedRequests.empty())
+    {
+        // Take a snapshot of callbacks for thread safe iteration.
+        std::vector<Callback::Ptr> callbackSnapshot;
+        ThreadSafeCopy(m_callbacks, callbackSnapshot);
+
+        for (const auto& requestAccessContext : queuedRequests)
+        {
+            for (const auto& callback : callbackSnapshot)
+            {
+                callback->RequestAccessCompletionCallback(IPCA_SECURITY_UPDATE_REQUEST_FAILED,
+                                requestAccessContext->callbackInfo);
+            }
+        }
+    }
 
     // Discover all of the devices that performed security operations
     {
@@ -2029,29 +2247,33 @@ void OCFFramework::CleanupRequestAccessDevices()
     }
 
     // If a RequestAccess operation is still in progress for a device wait for it to finish.
-    // Once the operation is complete cleanup the RequestAccess context for the operation.
     for (auto const& device : requestAccessDevices)
     {
         device->securityInfo.requestAccessThreadCV.notify_all();
+    }
 
-        if (device->securityInfo.requestAccessThread.joinable())
+    for (auto& requestAccessThread : requestAccessThreads)
+    {
+        if (requestAccessThread.joinable())
         {
-            device->securityInfo.requestAccessThread.join();
+            requestAccessThread.join();
         }
+    }
 
-        auto context = m_OCFRequestAccessContexts.find(device->deviceId);
-        if (context != m_OCFRequestAccessContexts.end())
+    // Once the operations are complete cleanup the RequestAccess contexts.
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_OCFFrameworkMutex);
+        for (auto& context : m_OCFRequestAccessContexts)
         {
-            RequestAccessContext* requestAccessContext = context->second;
-            if (nullptr != requestAccessContext)
-            {
-                requestAccessContext->callbackInfo = nullptr;
-                requestAccessContext->passwordInputCallbackInfo = nullptr;
-                requestAccessContext->ocfFramework = nullptr;
-                OICFree(static_cast<void*>(requestAccessContext));
-            }
-            m_OCFRequestAccessContexts.erase(device->deviceId);
+            delete context.second;
         }
+        m_OCFRequestAccessContexts.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_requestAccessMutex);
+        m_isRequestAccessStopping = false;
+        m_idleRequestAccessThreadCount = 0;
     }
 }
 
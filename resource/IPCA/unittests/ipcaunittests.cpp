@@ -23,8 +23,11 @@
 #include <chrono>
 #include <mutex>
 #include <condition_variable>
+#include <map>
+#include <vector>
 
 #include <gtest/gtest.h>
+#include "OCPlatform.h"
 #include "experimental/ocrandom.h"
 #include "ipca.h"
 #include "testelevatorserver.h"
@@ -37,6 +40,8 @@ using namespace std::placeholders;
 
 // Implemented in ipca.dll.
 void IPCA_CALL IPCASetUnitTestMode();
+void IPCA_CALL IPCASetUnitTestDeviceTimeouts(uint64_t unopenedDeviceTimeoutMs,
+                                             uint64_t discoveryResponseTimeoutMs);
 
 // IPCA test app info.
 IPCAUuid IPCATestAppUuid = {
@@ -662,6 +667,363 @@ TEST_F(IPCAElevatorClient, TestMultipleCallsToCloseHandle)
     EXPECT_EQ(IPCA_OK, TestMultipleCallsToCloseSameHandle());
 }
 
+/*
+ * Device deadlines of the IPCA worker thread, with the timeouts shortened for the test.
+ */
+class IPCADeviceDeadlineTest : public testing::Test
+{
+    public:
+        IPCAAppHandle m_ipcaAppHandle;
+        IPCAHandle m_deviceDiscoveryHandle;
+        std::string m_elevator1DeviceId;
+        std::vector<IPCADeviceStatus> m_elevator1Statuses;  // Discovered and stopped responding.
+        std::mutex m_discoveryMutex;
+        std::condition_variable m_discoveryCV;
+
+        void DiscoveryCallback(IPCADeviceStatus deviceStatus,
+                    const IPCADiscoveredDeviceInfo* discoveredDeviceInfo)
+        {
+            std::lock_guard<std::mutex> lock(m_discoveryMutex);
+            if ((deviceStatus != IPCA_DEVICE_UPDATED_INFO) &&
+                (g_elevator1Name.compare(discoveredDeviceInfo->deviceName) == 0))
+            {
+                m_elevator1DeviceId = discoveredDeviceInfo->deviceId;
+                m_elevator1Statuses.push_back(deviceStatus);
+                m_discoveryCV.notify_all();
+            }
+        }
+
+        static void IPCA_CALL C_DiscoveryCallback(void* context,
+                    IPCADeviceStatus deviceStatus,
+                    const IPCADiscoveredDeviceInfo* discoveredDeviceInfo)
+        {
+            IPCADeviceDeadlineTest* test = (IPCADeviceDeadlineTest*)context;
+            test->DiscoveryCallback(deviceStatus, discoveredDeviceInfo);
+        }
+
+        // Wait until the elevator has been indicated with statusCount statuses.
+        bool WaitForElevator1Statuses(size_t statusCount)
+        {
+            std::unique_lock<std::mutex> lock(m_discoveryMutex);
+            return m_discoveryCV.wait_for(
+                        lock,
+                        std::chrono::seconds(10),
+                        [this, statusCount] { return m_elevator1Statuses.size() >= statusCount; });
+        }
+
+        void DiscoverElevator1()
+        {
+            const char* resourceTypes[] = { ELEVATOR_RESOURCE_TYPE };
+            ASSERT_EQ(IPCA_OK, IPCADiscoverDevices(m_ipcaAppHandle,
+                                        &C_DiscoveryCallback,
+                                        (void*)this,
+                                        resourceTypes,
+                                        1,
+                                        &m_deviceDiscoveryHandle));
+            ASSERT_TRUE(WaitForElevator1Statuses(1));
+            ASSERT_EQ(IPCA_DEVICE_DISCOVERED, m_elevator1Statuses[0]);
+        }
+
+    protected:
+        virtual void SetUp()
+        {
+            m_ipcaAppHandle = nullptr;
+            m_deviceDiscoveryHandle = nullptr;
+        }
+
+        virtual void TearDown()
+        {
+            if (m_deviceDiscoveryHandle != nullptr)
+            {
+                IPCACloseHandle(m_deviceDiscoveryHandle, nullptr, 0);
+                m_deviceDiscoveryHandle = nullptr;
+            }
+
+            if (m_ipcaAppHandle != nullptr)
+            {
+                IPCAClose(m_ipcaAppHandle);
+                m_ipcaAppHandle = nullptr;
+            }
+
+            IPCASetUnitTestDeviceTimeouts(0, 0);
+        }
+
+        void OpenApp()
+        {
+            IPCAAppInfo ipcaAppInfo = { IPCATestAppUuid, IPCATestAppName, "1.0.0", "Microsoft" };
+            ASSERT_EQ(IPCA_OK, IPCAOpen(&ipcaAppInfo, IPCA_VERSION_1, &m_ipcaAppHandle));
+        }
+};
+
+TEST_F(IPCADeviceDeadlineTest, UnopenedDeviceIsForgotten)
+{
+    const uint64_t UnopenedDeviceTimeoutMs = 1000;
+    IPCASetUnitTestDeviceTimeouts(UnopenedDeviceTimeoutMs, 0);
+    OpenApp();
+    DiscoverElevator1();
+
+    IPCADeviceHandle deviceHandle;
+    ASSERT_EQ(IPCA_OK, IPCAOpenDevice(m_ipcaAppHandle, m_elevator1DeviceId.c_str(),
+                                &deviceHandle));
+
+    // Stop the periodic discovery, which would add the device again.
+    IPCACloseHandle(m_deviceDiscoveryHandle, nullptr, 0);
+    m_deviceDiscoveryHandle = nullptr;
+
+    // An opened device is kept past the timeout.
+    std::this_thread::sleep_for(std::chrono::milliseconds(3 * UnopenedDeviceTimeoutMs));
+    IPCADeviceHandle anotherDeviceHandle;
+    ASSERT_EQ(IPCA_OK, IPCAOpenDevice(m_ipcaAppHandle, m_elevator1DeviceId.c_str(),
+                                &anotherDeviceHandle));
+    IPCACloseDevice(anotherDeviceHandle);
+    IPCACloseDevice(deviceHandle);
+
+    // Once closed, it is forgotten after the timeout.
+    std::this_thread::sleep_for(std::chrono::milliseconds(3 * UnopenedDeviceTimeoutMs));
+    EXPECT_EQ(IPCA_DEVICE_NOT_DISCOVERED, IPCAOpenDevice(m_ipcaAppHandle,
+                                                m_elevator1DeviceId.c_str(),
+                                                &deviceHandle));
+}
+
+TEST_F(IPCADeviceDeadlineTest, NotRespondingDeviceIsIndicated)
+{
+    // The first periodic discoveries are 2 seconds apart, so the elevator is indicated as not
+    // responding in between, and as discovered again by the next discovery.
+    IPCASetUnitTestDeviceTimeouts(0, 1000);
+    OpenApp();
+    DiscoverElevator1();
+
+    ASSERT_TRUE(WaitForElevator1Statuses(2));
+    EXPECT_EQ(IPCA_DEVICE_STOPPED_RESPONDING, m_elevator1Statuses[1]);
+
+    ASSERT_TRUE(WaitForElevator1Statuses(3));
+    EXPECT_EQ(IPCA_DEVICE_DISCOVERED, m_elevator1Statuses[2]);
+}
+
+#if defined(IPCA_MOCK_OC) && defined(MULTIPLE_OWNER)
+// Implemented in mockOCPlatform_impl.cpp and mockOCProvision.cpp.
+extern std::string g_mockServerId;
+extern std::mutex g_motDiscoveryMutex;
+extern std::condition_variable g_motDiscoveryCV;
+extern bool g_holdMotDiscovery;
+extern size_t g_motDiscoveryInProgressCount;
+
+/*
+ * RequestAccess() calls are run by a pool of 4 threads, the others wait in a queue.
+ */
+const size_t RequestAccessDeviceCount = 6;
+
+class IPCARequestAccessTest : public testing::Test
+{
+    public:
+        IPCAAppHandle m_ipcaAppHandle;
+        IPCAHandle m_deviceDiscoveryHandle;
+        OCResourceHandle m_resourceHandles[RequestAccessDeviceCount];
+        IPCADeviceHandle m_deviceHandles[RequestAccessDeviceCount];
+        std::vector<IPCAStatus> m_completionStatuses;
+        std::mutex m_completionMutex;
+        std::condition_variable m_completionCV;
+
+        // RequestAccess() converts the device ID to a UUID.
+        static std::string DeviceId(size_t index)
+        {
+            char deviceId[UUID_STRING_SIZE];
+            snprintf(deviceId, sizeof(deviceId), "ce3a5c58-6b80-4a5b-9d1c-0000000000%02x",
+                     static_cast<unsigned int>(index));
+            return deviceId;
+        }
+
+        static void IPCA_CALL C_DiscoveryCallback(void* context,
+                    IPCADeviceStatus deviceStatus,
+                    const IPCADiscoveredDeviceInfo* discoveredDeviceInfo)
+        {
+            OC_UNUSED(context);
+            OC_UNUSED(deviceStatus);
+            OC_UNUSED(discoveredDeviceInfo);
+        }
+
+        static IPCAStatus IPCA_CALL C_ProvidePasswordCallback(void* context,
+                    const IPCADeviceInfo* deviceInformation,
+                    const IPCAPlatformInfo* platformInformation,
+                    IPCAOwnershipTransferType type,
+                    char* passwordBuffer,
+                    size_t passwordBufferSize)
+        {
+            OC_UNUSED(context);
+            OC_UNUSED(deviceInformation);
+            OC_UNUSED(platformInformation);
+            OC_UNUSED(type);
+            OC_UNUSED(passwordBuffer);
+            OC_UNUSED(passwordBufferSize);
+            return IPCA_OK;
+        }
+
+        static IPCAStatus IPCA_CALL C_DisplayPasswordCallback(void* context,
+                    const IPCADeviceInfo* deviceInformation,
+                    const IPCAPlatformInfo* platformInformation,
+                    IPCAOwnershipTransferType type,
+                    const char* password)
+        {
+            OC_UNUSED(context);
+            OC_UNUSED(deviceInformation);
+            OC_UNUSED(platformInformation);
+            OC_UNUSED(type);
+            OC_UNUSED(password);
+            return IPCA_OK;
+        }
+
+        static void IPCA_CALL C_RequestAccessCompletionCallback(IPCAStatus completionStatus,
+                    void* context)
+        {
+            IPCARequestAccessTest* test = (IPCARequestAccessTest*)context;
+            std::lock_guard<std::mutex> lock(test->m_completionMutex);
+            test->m_completionStatuses.push_back(completionStatus);
+            test->m_completionCV.notify_all();
+        }
+
+        static void HoldMotDiscovery(bool hold)
+        {
+            std::lock_guard<std::mutex> lock(g_motDiscoveryMutex);
+            g_holdMotDiscovery = hold;
+            g_motDiscoveryCV.notify_all();
+        }
+
+    protected:
+        virtual void SetUp()
+        {
+            m_ipcaAppHandle = nullptr;
+            m_deviceDiscoveryHandle = nullptr;
+
+            // Each resource is a device of its own.
+            for (size_t i = 0; i < RequestAccessDeviceCount; i++)
+            {
+                std::string uri = std::string("/ipca/test/device/") + std::to_string(i);
+                m_resourceHandles[i] = nullptr;
+                m_deviceHandles[i] = nullptr;
+                g_mockServerId = DeviceId(i);
+                ASSERT_EQ(OC_STACK_OK, OC::OCPlatform::registerResource(
+                            m_resourceHandles[i],
+                            uri,
+                            "ipca.test.device",
+                            OC::DEFAULT_INTERFACE,
+                            [](std::shared_ptr<OC::OCResourceRequest>) { return OC_EH_OK; },
+                            OC_DISCOVERABLE));
+            }
+            g_mockServerId.clear();
+
+            IPCAAppInfo ipcaAppInfo = { IPCATestAppUuid, IPCATestAppName, "1.0.0", "Microsoft" };
+            ASSERT_EQ(IPCA_OK, IPCAOpen(&ipcaAppInfo, IPCA_VERSION_1, &m_ipcaAppHandle));
+            ASSERT_EQ(IPCA_OK, IPCASetPasswordCallbacks(m_ipcaAppHandle,
+                                        &C_ProvidePasswordCallback,
+                                        &C_DisplayPasswordCallback,
+                                        nullptr));
+
+            const char* resourceTypes[] = { "ipca.test.device" };
+            ASSERT_EQ(IPCA_OK, IPCADiscoverDevices(m_ipcaAppHandle,
+                                        &C_DiscoveryCallback,
+                                        nullptr,
+                                        resourceTypes,
+                                        1,
+                                        &m_deviceDiscoveryHandle));
+
+            for (size_t i = 0; i < RequestAccessDeviceCount; i++)
+            {
+                IPCAStatus status = IPCA_DEVICE_NOT_DISCOVERED;
+                for (int loopCount = 0;
+                     (loopCount < 100) && (status == IPCA_DEVICE_NOT_DISCOVERED);
+                     loopCount++)
+                {
+                    status = IPCAOpenDevice(m_ipcaAppHandle, DeviceId(i).c_str(),
+                                    &m_deviceHandles[i]);
+                    if (status == IPCA_DEVICE_NOT_DISCOVERED)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    }
+                }
+                ASSERT_EQ(IPCA_OK, status);
+            }
+        }
+
+        virtual void TearDown()
+        {
+            HoldMotDiscovery(false);
+
+            for (size_t i = 0; i < RequestAccessDeviceCount; i++)
+            {
+                if (m_deviceHandles[i] != nullptr)
+                {
+                    IPCACloseDevice(m_deviceHandles[i]);
+                }
+            }
+
+            if (m_deviceDiscoveryHandle != nullptr)
+            {
+                IPCACloseHandle(m_deviceDiscoveryHandle, nullptr, 0);
+            }
+
+            if (m_ipcaAppHandle != nullptr)
+            {
+                IPCAClose(m_ipcaAppHandle);
+            }
+
+            for (size_t i = 0; i < RequestAccessDeviceCount; i++)
+            {
+                if (m_resourceHandles[i] != nullptr)
+                {
+                    OC::OCPlatform::unregisterResource(m_resourceHandles[i]);
+                }
+            }
+        }
+};
+
+TEST_F(IPCARequestAccessTest, MoreRequestsThanThreadsAllComplete)
+{
+    HoldMotDiscovery(true);
+
+    for (size_t i = 0; i < RequestAccessDeviceCount; i++)
+    {
+        ASSERT_EQ(IPCA_OK, IPCARequestAccess(m_deviceHandles[i], nullptr,
+                                    &C_RequestAccessCompletionCallback, this, nullptr));
+    }
+
+    // A request already in progress for a device is refused.
+    EXPECT_EQ(IPCA_FAIL, IPCARequestAccess(m_deviceHandles[0], nullptr,
+                                &C_RequestAccessCompletionCallback, this, nullptr));
+
+    // Only the 4 threads of the pool run requests, the others are queued.
+    {
+        std::unique_lock<std::mutex> lock(g_motDiscoveryMutex);
+        EXPECT_TRUE(g_motDiscoveryCV.wait_for(lock, std::chrono::seconds(10),
+                        [] { return g_motDiscoveryInProgressCount >= 4; }));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    {
+        std::lock_guard<std::mutex> lock(g_motDiscoveryMutex);
+        EXPECT_EQ(static_cast<size_t>(4), g_motDiscoveryInProgressCount);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_completionMutex);
+        EXPECT_TRUE(m_completionStatuses.empty());
+    }
+
+    // Once released, the queued requests run too.  The mock finds no MOT device, so each
+    // request fails.
+    HoldMotDiscovery(false);
+
+    std::unique_lock<std::mutex> lock(m_completionMutex);
+    EXPECT_TRUE(m_completionCV.wait_for(
+                    lock,
+                    std::chrono::seconds(10),
+                    [this] { return m_completionStatuses.size() >= RequestAccessDeviceCount; }));
+    ASSERT_EQ(RequestAccessDeviceCount, m_completionStatuses.size());
+    for (const auto& status : m_completionStatuses)
+    {
+        EXPECT_EQ(IPCA_SECURITY_UPDATE_REQUEST_FAILED, status);
+    }
+}
+#endif // IPCA_MOCK_OC && MULTIPLE_OWNER
+
 TEST(ElevatorServerStop, Stop)
 {
     StopElevator1();
@@ -30,6 +30,10 @@ using namespace OC;
 
     IClientWrapper::Ptr g_mockClientWrapper = std::shared_ptr<IClientWrapper>();
     extern PlatformConfig g_platformConfig;
+
+    // Device ID of resources registered from now on.  Tests set it to simulate more devices.
+    std::string g_mockServerId;
+
     OCResource::Ptr OCPlatform_impl::constructResourceObject(
                                                  const std::string& host,
                                                  const std::string& uri,
@@ -49,7 +53,7 @@ using namespace OC;
                                                  g_mockClientWrapper,
                                                  host,
                                                  uri,
-                                                 "",
+                                                 g_mockServerId,
                                                  connectivityType,
                                                  resourceProperty,
                                                  resourceTypes,
@@ -17,6 +17,9 @@
  *
  ******************************************************************/
 
+#include <mutex>
+#include <condition_variable>
+
 #include "OCPlatform.h"
 #include "OCApi.h"
 #include "OCProvisioningManager.hpp"
@@ -78,6 +81,13 @@ OicSecOxm_t OCSecureResource::getSelectedOwnershipTransferMethod()
 }
 
 #ifdef MULTIPLE_OWNER
+// Tests set g_holdMotDiscovery to keep RequestAccess() calls waiting in
+// discoverMultipleOwnerEnabledDevice(), and count how many are waiting.
+std::mutex g_motDiscoveryMutex;
+std::condition_variable g_motDiscoveryCV;
+bool g_holdMotDiscovery = false;
+size_t g_motDiscoveryInProgressCount = 0;
+
 OCStackResult OCSecureResource::addPreconfigPIN(const char* preconfPIN, size_t preconfPINLength)
 {
     OC_UNUSED(preconfPIN);
@@ -106,6 +116,12 @@ OCStackResult OCSecure::discoverMultipleOwnerEnabledDevice(unsigned short timeou
     OC_UNUSED(timeout);
     OC_UNUSED(deviceID);
     OC_UNUSED(foundDevice);
+
+    std::unique_lock<std::mutex> lock(g_motDiscoveryMutex);
+    g_motDiscoveryInProgressCount++;
+    g_motDiscoveryCV.notify_all();
+    g_motDiscoveryCV.wait(lock, [] { return !g_holdMotDiscovery; });
+    g_motDiscoveryInProgressCount--;
     return OC_STACK_OK;
 }
 
@@ -0,0 +1,185 @@
+/* *****************************************************************
+ *
+ * Copyright 2017 Microsoft
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file defines the process wide metrics registry used by the stack to count
+ * messages, track queue and list sizes and record latency distributions.
+ *
+ * Updates are cheap enough for hot paths: on platforms with pthreads each thread
+ * updates its own block of metrics without locking, and the blocks are only summed
+ * when a snapshot is taken.
+ */
+
+#ifndef OC_METRICS_H_
+#define OC_METRICS_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/** Monotonic event counters. */
+typedef enum
+{
+    OC_METRIC_MESSAGES_SENT_IP = 0,
+    OC_METRIC_MESSAGES_SENT_TCP,
+    OC_METRIC_MESSAGES_SENT_GATT,
+    OC_METRIC_MESSAGES_SENT_RFCOMM,
+    OC_METRIC_MESSAGES_SENT_NFC,
+    OC_METRIC_MESSAGES_RECEIVED_IP,
+    OC_METRIC_MESSAGES_RECEIVED_TCP,
+    OC_METRIC_MESSAGES_RECEIVED_GATT,
+    OC_METRIC_MESSAGES_RECEIVED_RFCOMM,
+    OC_METRIC_MESSAGES_RECEIVED_NFC,
+    OC_METRIC_RETRANSMISSIONS,
+    OC_METRIC_DUPLICATES_DROPPED,
+    OC_METRIC_HANDSHAKES_STARTED,
+    OC_METRIC_HANDSHAKES_COMPLETED,
+    OC_METRIC_COUNTER_COUNT
+} oc_metric_counter;
+
+/** Values that go up and down, such as queue depths and list sizes. */
+typedef enum
+{
+    OC_METRIC_SEND_QUEUE_DEPTH = 0,
+    OC_METRIC_RECEIVE_QUEUE_DEPTH,
+    OC_METRIC_OBSERVERS,
+    OC_METRIC_CLIENT_CALLBACKS,
+    OC_METRIC_BLOCKWISE_SESSIONS,
+    OC_METRIC_GAUGE_COUNT
+} oc_metric_gauge;
+
+/** Latency distributions, recorded in microseconds. */
+typedef enum
+{
+    OC_METRIC_ENTITY_HANDLER_LATENCY = 0,
+    OC_METRIC_HANDSHAKE_LATENCY,
+    OC_METRIC_HISTOGRAM_COUNT
+} oc_metric_histogram;
+
+/**
+ * Histogram buckets keep 3 significant bits of each value, so a bucket spans at most
+ * 1/8 of its lower bound. Values from 2^36 up are counted in the last bucket.
+ */
+#define OC_METRICS_SUB_BUCKET_BITS  (3)
+#define OC_METRICS_VALUE_BITS       (36)
+#define OC_METRICS_BUCKET_COUNT \
+    ((OC_METRICS_VALUE_BITS - OC_METRICS_SUB_BUCKET_BITS + 1) << OC_METRICS_SUB_BUCKET_BITS)
+
+/** Summed state of one histogram. */
+typedef struct
+{
+    uint64_t count;                             /**< number of recorded values */
+    uint64_t sum;                               /**< sum of recorded values */
+    uint64_t max;                               /**< largest recorded value */
+    uint64_t buckets[OC_METRICS_BUCKET_COUNT];  /**< number of values per bucket */
+} oc_metrics_histogram_snapshot;
+
+/** Point in time view of every metric. */
+typedef struct
+{
+    uint64_t counters[OC_METRIC_COUNTER_COUNT];
+    int64_t gauges[OC_METRIC_GAUGE_COUNT];
+    oc_metrics_histogram_snapshot histograms[OC_METRIC_HISTOGRAM_COUNT];
+} oc_metrics_snapshot;
+
+/**
+ * Reads the current value of a gauge on demand.
+ *
+ * @param[in]  ctx  Context passed to oc_metrics_set_gauge_reader.
+ * @return  Current value of the gauge.
+ */
+typedef int64_t (*oc_metrics_gauge_reader)(void *ctx);
+
+/**
+ * Increases a counter by one.
+ *
+ * @param[in]  counter  Counter to increase.
+ */
+void oc_metrics_increment(oc_metric_counter counter);
+
+/**
+ * Increases a counter.
+ *
+ * @param[in]  counter  Counter to increase.
+ * @param[in]  value    Amount to add.
+ */
+void oc_metrics_add(oc_metric_counter counter, uint64_t value);
+
+/**
+ * Adjusts a gauge that is kept up to date by its owner.
+ * The adjustments may come from different threads.
+ *
+ * @param[in]  gauge  Gauge to adjust.
+ * @param[in]  delta  Amount to add, negative to decrease the gauge.
+ */
+void oc_metrics_gauge_add(oc_metric_gauge gauge, int64_t delta);
+
+/**
+ * Sets a function that computes a gauge when a snapshot is taken, for values that are
+ * cheaper to read than to track, such as the length of a queue. The reader's value is
+ * added to any adjustments made with oc_metrics_gauge_add.
+ *
+ * Once this function returns with a NULL reader, the previous reader is no longer
+ * running and will not be called again, so its context can be freed.
+ *
+ * @param[in]  gauge   Gauge to compute.
+ * @param[in]  reader  Function called by oc_metrics_get_snapshot, or NULL to remove it.
+ *                     It must not update metrics.
+ * @param[in]  ctx     Context passed to the reader.
+ */
+void oc_metrics_set_gauge_reader(oc_metric_gauge gauge, oc_metrics_gauge_reader reader,
+                                 void *ctx);
+
+/**
+ * Records a value in a histogram.
+ *
+ * @param[in]  histogram  Histogram to update.
+ * @param[in]  value      Value to record, in microseconds for the latency histograms.
+ */
+void oc_metrics_record(oc_metric_histogram histogram, uint64_t value);
+
+/**
+ * Sums the metrics of every thread.
+ * Counters updated while the snapshot is taken may or may not be included.
+ *
+ * @param[out]  snapshot  Receives the metrics.
+ */
+void oc_metrics_get_snapshot(oc_metrics_snapshot *snapshot);
+
+/**
+ * Estimates a percentile of a histogram snapshot.
+ *
+ * @param[in]  histogram   Histogram to examine.
+ * @param[in]  percentile  Percentile between 0 and 100.
+ * @return  Upper bound of the bucket holding the percentile, capped at the largest
+ *          recorded value. 0 if the histogram is empty.
+ */
+uint64_t oc_metrics_histogram_percentile(const oc_metrics_histogram_snapshot *histogram,
+                                         double percentile);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* OC_METRICS_H_ */
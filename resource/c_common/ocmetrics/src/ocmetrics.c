@@ -0,0 +1,480 @@
+/* *****************************************************************
+ *
+ * Copyright 2017 Microsoft
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ * This file implements the metrics registry.
+ *
+ * With pthreads and GCC style atomics, every thread that updates a metric gets its own
+ * block of metrics. Only the owning thread writes to a block, so updates are relaxed
+ * loads and stores without locked instructions or shared cache lines. A snapshot sums
+ * the live blocks under a lock, and a block is folded into a shared block when its
+ * thread exits. Other platforms update the shared block with atomic additions.
+ */
+
+#include "iotivity_config.h"
+#include "ocmetrics.h"
+#include "oic_malloc.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#ifdef HAVE_WINDOWS_H
+#include <windows.h>
+#endif
+
+#if defined(HAVE_PTHREAD_H) && (defined(__GNUC__) || defined(__clang__)) && !defined(ARDUINO)
+#define OC_METRICS_PER_THREAD
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SHARED_ADD(p, v)    __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#define METRIC_LOAD(p)      __atomic_load_n((p), __ATOMIC_RELAXED)
+#elif defined(_WIN32)
+#define SHARED_ADD(p, v)    InterlockedExchangeAdd64((volatile LONG64 *)(p), (LONG64)(v))
+#define METRIC_LOAD(p)      InterlockedCompareExchange64((volatile LONG64 *)(p), 0, 0)
+#else
+#define SHARED_ADD(p, v)    (*(p) += (v))
+#define METRIC_LOAD(p)      (*(p))
+#endif
+
+#ifdef OC_METRICS_PER_THREAD
+/** Update of a block that only the calling thread writes to. */
+#define OWNED_ADD(p, v) \
+    __atomic_store_n((p), __atomic_load_n((p), __ATOMIC_RELAXED) + (v), __ATOMIC_RELAXED)
+#endif
+
+#define SUB_BUCKET_COUNT    (1 << OC_METRICS_SUB_BUCKET_BITS)
+
+typedef struct MetricsBlock
+{
+    uint64_t counters[OC_METRIC_COUNTER_COUNT];
+    int64_t gauges[OC_METRIC_GAUGE_COUNT];
+    oc_metrics_histogram_snapshot histograms[OC_METRIC_HISTOGRAM_COUNT];
+    struct MetricsBlock *next;
+} MetricsBlock;
+
+typedef struct
+{
+    oc_metrics_gauge_reader reader;
+    void *ctx;
+} GaugeReader;
+
+/** Updated by threads without a block of their own, and by exiting threads. */
+static MetricsBlock g_shared;
+
+static GaugeReader g_gaugeReaders[OC_METRIC_GAUGE_COUNT];
+
+#if defined(HAVE_PTHREAD_H)
+static pthread_mutex_t g_readerLock = PTHREAD_MUTEX_INITIALIZER;
+#elif defined(_WIN32)
+static SRWLOCK g_readerLock = SRWLOCK_INIT;
+#endif
+
+#ifdef OC_METRICS_PER_THREAD
+/** Blocks of running threads, protected by g_blockLock. */
+static MetricsBlock *g_liveBlocks = NULL;
+static pthread_mutex_t g_blockLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t g_blockKey;
+static pthread_once_t g_blockKeyOnce = PTHREAD_ONCE_INIT;
+static bool g_blockKeyCreated = false;
+static __thread MetricsBlock *t_block = NULL;
+#endif
+
+static void LockReaders(void)
+{
+#if defined(HAVE_PTHREAD_H)
+    pthread_mutex_lock(&g_readerLock);
+#elif defined(_WIN32)
+    AcquireSRWLockExclusive(&g_readerLock);
+#endif
+}
+
+static void UnlockReaders(void)
+{
+#if defined(HAVE_PTHREAD_H)
+    pthread_mutex_unlock(&g_readerLock);
+#elif defined(_WIN32)
+    ReleaseSRWLockExclusive(&g_readerLock);
+#endif
+}
+
+static unsigned int GetHighestBit(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - (unsigned int)__builtin_clzll(value);
+#else
+    unsigned int bit = 0;
+    while (value >>= 1)
+    {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+static size_t GetBucketIndex(uint64_t value)
+{
+    if (value < SUB_BUCKET_COUNT)
+    {
+        return (size_t)value;
+    }
+    if (value >> OC_METRICS_VALUE_BITS)
+    {
+        return OC_METRICS_BUCKET_COUNT - 1;
+    }
+
+    unsigned int shift = GetHighestBit(value) - OC_METRICS_SUB_BUCKET_BITS;
+    return ((size_t)(shift + 1) << OC_METRICS_SUB_BUCKET_BITS) +
+           (size_t)((value >> shift) & (SUB_BUCKET_COUNT - 1));
+}
+
+static uint64_t GetBucketUpperBound(size_t index)
+{
+    if (index < SUB_BUCKET_COUNT)
+    {
+        return index;
+    }
+    if (index >= OC_METRICS_BUCKET_COUNT - 1)
+    {
+        return UINT64_MAX;
+    }
+
+    unsigned int shift = (unsigned int)(index >> OC_METRICS_SUB_BUCKET_BITS) - 1;
+    uint64_t lower = (uint64_t)(SUB_BUCKET_COUNT + (index & (SUB_BUCKET_COUNT - 1))) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+static void SharedMax(uint64_t *max, uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    uint64_t current = __atomic_load_n(max, __ATOMIC_RELAXED);
+    while ((value > current) &&
+           !__atomic_compare_exchange_n(max, &current, value, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+#elif defined(_WIN32)
+    LONG64 current = METRIC_LOAD(max);
+    while (value > (uint64_t)current)
+    {
+        LONG64 previous = InterlockedCompareExchange64((volatile LONG64 *)max,
+                                                       (LONG64)value, current);
+        if (previous == current)
+        {
+            break;
+        }
+        current = previous;
+    }
+#else
+    if (value > *max)
+    {
+        *max = value;
+    }
+#endif
+}
+
+static void SharedRecord(oc_metrics_histogram_snapshot *histogram, uint64_t value)
+{
+    SHARED_ADD(&histogram->count, 1);
+    SHARED_ADD(&histogram->sum, value);
+    SHARED_ADD(&histogram->buckets[GetBucketIndex(value)], 1);
+    SharedMax(&histogram->max, value);
+}
+
+/**
+ * Adds the values of a block to a snapshot.
+ */
+static void SumBlock(uint64_t *counters, int64_t *gauges,
+                     oc_metrics_histogram_snapshot *histograms, MetricsBlock *block)
+{
+    for (size_t i = 0; i < OC_METRIC_COUNTER_COUNT; i++)
+    {
+        counters[i] += METRIC_LOAD(&block->counters[i]);
+    }
+    for (size_t i = 0; i < OC_METRIC_GAUGE_COUNT; i++)
+    {
+        gauges[i] += METRIC_LOAD(&block->gauges[i]);
+    }
+    for (size_t i = 0; i < OC_METRIC_HISTOGRAM_COUNT; i++)
+    {
+        oc_metrics_histogram_snapshot *from = &block->histograms[i];
+        oc_metrics_histogram_snapshot *to = &histograms[i];
+        uint64_t max = METRIC_LOAD(&from->max);
+
+        to->count += METRIC_LOAD(&from->count);
+        to->sum += METRIC_LOAD(&from->sum);
+        if (max > to->max)
+        {
+            to->max = max;
+        }
+        for (size_t bucket = 0; bucket < OC_METRICS_BUCKET_COUNT; bucket++)
+        {
+            to->buckets[bucket] += METRIC_LOAD(&from->buckets[bucket]);
+        }
+    }
+}
+
+#ifdef OC_METRICS_PER_THREAD
+/**
+ * Folds the block of an exiting thread into the shared block.
+ */
+static void RetireBlock(void *data)
+{
+    MetricsBlock *block = (MetricsBlock *)data;
+
+    pthread_mutex_lock(&g_blockLock);
+    for (MetricsBlock **link = &g_liveBlocks; *link; link = &(*link)->next)
+    {
+        if (*link == block)
+        {
+            *link = block->next;
+            break;
+        }
+    }
+    for (size_t i = 0; i < OC_METRIC_COUNTER_COUNT; i++)
+    {
+        SHARED_ADD(&g_shared.counters[i], block->counters[i]);
+    }
+    for (size_t i = 0; i < OC_METRIC_GAUGE_COUNT; i++)
+    {
+        SHARED_ADD(&g_shared.gauges[i], block->gauges[i]);
+    }
+    for (size_t i = 0; i < OC_METRIC_HISTOGRAM_COUNT; i++)
+    {
+        const oc_metrics_histogram_snapshot *from = &block->histograms[i];
+        oc_metrics_histogram_snapshot *to = &g_shared.histograms[i];
+
+        SHARED_ADD(&to->count, from->count);
+        SHARED_ADD(&to->sum, from->sum);
+        SharedMax(&to->max, from->max);
+        for (size_t bucket = 0; bucket < OC_METRICS_BUCKET_COUNT; bucket++)
+        {
+            if (from->buckets[bucket])
+            {
+                SHARED_ADD(&to->buckets[bucket], from->buckets[bucket]);
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_blockLock);
+
+    // Metrics updated by later thread-exit handlers start a new block.
+    t_block = NULL;
+    OICFree(block);
+}
+
+static void CreateBlockKey(void)
+{
+    g_blockKeyCreated = (0 == pthread_key_create(&g_blockKey, RetireBlock));
+}
+
+/**
+ * Gets the block of the calling thread, creating it on first use.
+ *
+ * @return  The thread's block, or NULL if it can't be created and the shared block
+ *          has to be used.
+ */
+static MetricsBlock *GetThreadBlock(void)
+{
+    MetricsBlock *block = t_block;
+    if (block)
+    {
+        return block;
+    }
+
+    pthread_once(&g_blockKeyOnce, CreateBlockKey);
+    if (!g_blockKeyCreated)
+    {
+        return NULL;
+    }
+
+    block = (MetricsBlock *)OICCalloc(1, sizeof(MetricsBlock));
+    if (!block)
+    {
+        return NULL;
+    }
+    if (0 != pthread_setspecific(g_blockKey, block))
+    {
+        OICFree(block);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_blockLock);
+    block->next = g_liveBlocks;
+    g_liveBlocks = block;
+    pthread_mutex_unlock(&g_blockLock);
+
+    t_block = block;
+    return block;
+}
+#endif // OC_METRICS_PER_THREAD
+
+void oc_metrics_increment(oc_metric_counter counter)
+{
+    oc_metrics_add(counter, 1);
+}
+
+void oc_metrics_add(oc_metric_counter counter, uint64_t value)
+{
+    if ((unsigned int)counter >= OC_METRIC_COUNTER_COUNT)
+    {
+        return;
+    }
+
+#ifdef OC_METRICS_PER_THREAD
+    MetricsBlock *block = GetThreadBlock();
+    if (block)
+    {
+        OWNED_ADD(&block->counters[counter], value);
+        return;
+    }
+#endif
+    SHARED_ADD(&g_shared.counters[counter], value);
+}
+
+void oc_metrics_gauge_add(oc_metric_gauge gauge, int64_t delta)
+{
+    if ((unsigned int)gauge >= OC_METRIC_GAUGE_COUNT)
+    {
+        return;
+    }
+
+#ifdef OC_METRICS_PER_THREAD
+    MetricsBlock *block = GetThreadBlock();
+    if (block)
+    {
+        OWNED_ADD(&block->gauges[gauge], delta);
+        return;
+    }
+#endif
+    SHARED_ADD(&g_shared.gauges[gauge], delta);
+}
+
+void oc_metrics_set_gauge_reader(oc_metric_gauge gauge, oc_metrics_gauge_reader reader,
+                                 void *ctx)
+{
+    if ((unsigned int)gauge >= OC_METRIC_GAUGE_COUNT)
+    {
+        return;
+    }
+
+    LockReaders();
+    g_gaugeReaders[gauge].reader = reader;
+    g_gaugeReaders[gauge].ctx = reader ? ctx : NULL;
+    UnlockReaders();
+}
+
+void oc_metrics_record(oc_metric_histogram histogram, uint64_t value)
+{
+    if ((unsigned int)histogram >= OC_METRIC_HISTOGRAM_COUNT)
+    {
+        return;
+    }
+
+#ifdef OC_METRICS_PER_THREAD
+    MetricsBlock *block = GetThreadBlock();
+    if (block)
+    {
+        oc_metrics_histogram_snapshot *owned = &block->histograms[histogram];
+        OWNED_ADD(&owned->count, 1);
+        OWNED_ADD(&owned->sum, value);
+        OWNED_ADD(&owned->buckets[GetBucketIndex(value)], 1);
+        if (value > owned->max)
+        {
+            __atomic_store_n(&owned->max, value, __ATOMIC_RELAXED);
+        }
+        return;
+    }
+#endif
+    SharedRecord(&g_shared.histograms[histogram], value);
+}
+
+void oc_metrics_get_snapshot(oc_metrics_snapshot *snapshot)
+{
+    if (!snapshot)
+    {
+        return;
+    }
+    memset(snapshot, 0, sizeof(*snapshot));
+
+#ifdef OC_METRICS_PER_THREAD
+    pthread_mutex_lock(&g_blockLock);
+    for (MetricsBlock *block = g_liveBlocks; block; block = block->next)
+    {
+        SumBlock(snapshot->counters, snapshot->gauges, snapshot->histograms, block);
+    }
+#endif
+    SumBlock(snapshot->counters, snapshot->gauges, snapshot->histograms, &g_shared);
+#ifdef OC_METRICS_PER_THREAD
+    pthread_mutex_unlock(&g_blockLock);
+#endif
+
+    // Readers take their owners' locks, which may be held while updating metrics,
+    // so they run outside g_blockLock.
+    LockReaders();
+    for (size_t i = 0; i < OC_METRIC_GAUGE_COUNT; i++)
+    {
+        if (g_gaugeReaders[i].reader)
+        {
+            snapshot->gauges[i] += g_gaugeReaders[i].reader(g_gaugeReaders[i].ctx);
+        }
+    }
+    UnlockReaders();
+}
+
+uint64_t oc_metrics_histogram_percentile(const oc_metrics_histogram_snapshot *histogram,
+                                         double percentile)
+{
+    if (!histogram || (0 == histogram->count))
+    {
+        return 0;
+    }
+
+    if (percentile < 0.0)
+    {
+        percentile = 0.0;
+    }
+    else if (percentile > 100.0)
+    {
+        percentile = 100.0;
+    }
+
+    double target = percentile * (double)histogram->count / 100.0;
+    uint64_t rank = (uint64_t)target;
+    if ((rank < target) || (0 == rank))
+    {
+        rank++;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < OC_METRICS_BUCKET_COUNT; i++)
+    {
+        seen += histogram->buckets[i];
+        if (seen >= rank)
+        {
+            uint64_t bound = GetBucketUpperBound(i);
+            return (bound < histogram->max) ? bound : histogram->max;
+        }
+    }
+    return histogram->max;
+}
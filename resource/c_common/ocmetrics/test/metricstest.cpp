@@ -0,0 +1,162 @@
+/* *****************************************************************
+ *
+ * Copyright 2017 Microsoft
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file implement tests for the metrics registry.
+ */
+
+#include "ocmetrics.h"
+#include "gtest/gtest.h"
+#include <memory>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// The registry is process wide, so tests compare snapshots taken before and after.
+class MetricsTester : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        m_before.reset(new oc_metrics_snapshot);
+        m_after.reset(new oc_metrics_snapshot);
+        oc_metrics_get_snapshot(m_before.get());
+    }
+    std::unique_ptr<oc_metrics_snapshot> m_before;
+    std::unique_ptr<oc_metrics_snapshot> m_after;
+};
+
+static int64_t ReadGauge(void *ctx)
+{
+    return *static_cast<int64_t *>(ctx);
+}
+
+TEST_F(MetricsTester, CountersSumAcrossThreads)
+{
+    const int threadCount = 4;
+    const int incrementCount = 1000;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        threads.push_back(std::thread([incrementCount]()
+        {
+            for (int j = 0; j < incrementCount; j++)
+            {
+                oc_metrics_increment(OC_METRIC_RETRANSMISSIONS);
+            }
+        }));
+    }
+    oc_metrics_add(OC_METRIC_RETRANSMISSIONS, 5);
+
+    // Counts of running and exited threads are both included.
+    threads[0].join();
+    oc_metrics_get_snapshot(m_after.get());
+    EXPECT_LE(m_before->counters[OC_METRIC_RETRANSMISSIONS] + incrementCount + 5,
+              m_after->counters[OC_METRIC_RETRANSMISSIONS]);
+
+    for (int i = 1; i < threadCount; i++)
+    {
+        threads[i].join();
+    }
+    oc_metrics_get_snapshot(m_after.get());
+    EXPECT_EQ(m_before->counters[OC_METRIC_RETRANSMISSIONS] + threadCount * incrementCount + 5,
+              m_after->counters[OC_METRIC_RETRANSMISSIONS]);
+}
+
+TEST_F(MetricsTester, GaugeAddsAdjustmentsAndReader)
+{
+    int64_t depth = 7;
+
+    std::thread thread([]()
+    {
+        oc_metrics_gauge_add(OC_METRIC_OBSERVERS, 3);
+    });
+    thread.join();
+    oc_metrics_gauge_add(OC_METRIC_OBSERVERS, -1);
+    oc_metrics_set_gauge_reader(OC_METRIC_OBSERVERS, ReadGauge, &depth);
+
+    oc_metrics_get_snapshot(m_after.get());
+    EXPECT_EQ(m_before->gauges[OC_METRIC_OBSERVERS] + 2 + depth,
+              m_after->gauges[OC_METRIC_OBSERVERS]);
+
+    oc_metrics_set_gauge_reader(OC_METRIC_OBSERVERS, NULL, NULL);
+    oc_metrics_gauge_add(OC_METRIC_OBSERVERS, -2);
+    oc_metrics_get_snapshot(m_after.get());
+    EXPECT_EQ(m_before->gauges[OC_METRIC_OBSERVERS], m_after->gauges[OC_METRIC_OBSERVERS]);
+}
+
+TEST(MetricsHistogram, Percentiles)
+{
+    oc_metrics_histogram_snapshot histogram;
+    memset(&histogram, 0, sizeof(histogram));
+    EXPECT_EQ(0u, oc_metrics_histogram_percentile(&histogram, 50));
+
+    // Values below 8 have a bucket each.
+    histogram.buckets[3] = 90;
+    // Bucket 16 holds 16 and 17.
+    histogram.buckets[16] = 9;
+    // The last bucket holds values from 2^36 up.
+    histogram.buckets[OC_METRICS_BUCKET_COUNT - 1] = 1;
+    histogram.count = 100;
+    histogram.max = 1ull << 40;
+
+    EXPECT_EQ(3u, oc_metrics_histogram_percentile(&histogram, 0));
+    EXPECT_EQ(3u, oc_metrics_histogram_percentile(&histogram, 90));
+    EXPECT_EQ(17u, oc_metrics_histogram_percentile(&histogram, 91));
+    EXPECT_EQ(17u, oc_metrics_histogram_percentile(&histogram, 99));
+    EXPECT_EQ(1ull << 40, oc_metrics_histogram_percentile(&histogram, 100));
+}
+
+TEST_F(MetricsTester, RecordKeepsRelativeError)
+{
+    const uint64_t values[] = { 0, 5, 8, 100, 1000, 123456, 99999999 };
+    const size_t valueCount = sizeof(values) / sizeof(values[0]);
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < valueCount; i++)
+    {
+        oc_metrics_record(OC_METRIC_HANDSHAKE_LATENCY, values[i]);
+        sum += values[i];
+    }
+    oc_metrics_get_snapshot(m_after.get());
+
+    oc_metrics_histogram_snapshot delta = m_after->histograms[OC_METRIC_HANDSHAKE_LATENCY];
+    const oc_metrics_histogram_snapshot &before = m_before->histograms[OC_METRIC_HANDSHAKE_LATENCY];
+    delta.count -= before.count;
+    delta.sum -= before.sum;
+    for (size_t i = 0; i < OC_METRICS_BUCKET_COUNT; i++)
+    {
+        delta.buckets[i] -= before.buckets[i];
+    }
+    ASSERT_EQ(valueCount, delta.count);
+    EXPECT_EQ(sum, delta.sum);
+    EXPECT_LE(values[valueCount - 1], delta.max);
+
+    // Each value is reported as the top of its bucket, at most 1/8 above it.
+    for (size_t i = 0; i < valueCount; i++)
+    {
+        uint64_t reported = oc_metrics_histogram_percentile(&delta,
+                                                            100.0 * (i + 1) / valueCount);
+        EXPECT_LE(values[i], reported);
+        EXPECT_GE(values[i] + values[i] / 8, reported);
+    }
+}
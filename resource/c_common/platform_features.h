@@ -83,6 +83,18 @@
 #  define OC_ANNOTATE_UNUSED  __attribute__((unused))
 #endif
 
+/**
+ * Storage class of variables with one instance per thread. Builds without threads
+ * (octhread noop implementation) use one instance.
+ */
+#if defined(_MSC_VER)
+#  define OC_THREAD_LOCAL __declspec(thread)
+#elif defined(WITH_ARDUINO)
+#  define OC_THREAD_LOCAL
+#else
+#  define OC_THREAD_LOCAL __thread
+#endif
+
 #ifdef _WIN32
 #  define __func__ __FUNCTION__
 #  define strncasecmp _strnicmp
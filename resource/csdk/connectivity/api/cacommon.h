@@ -128,6 +128,7 @@ extern "C"
 #define CA_OPTION_URI_QUERY 15
 #define CA_OPTION_ACCEPT 17
 #define CA_OPTION_LOCATION_QUERY 20
+#define CA_OPTION_BLOCK2 23
 
 /**
  * @def UUID_PREFIX
@@ -132,6 +132,27 @@ CAResult_t CAStartDiscoveryServer();
 void CARegisterHandler(CARequestCallback ReqHandler, CAResponseCallback RespHandler,
                        CAErrorCallback ErrorHandler);
 
+struct oc_event_t;
+
+/**
+ * Register an event to be signalled whenever a received request, response or error
+ * is waiting to be delivered by ::CAHandleRequestResponse.
+ * The event stays signalled until all waiting messages have been delivered.
+ * Several events can be registered at the same time; each of them is signalled.
+ * Has no effect in SINGLE_THREAD builds, where ::CAHandleRequestResponse reads the
+ * network itself.
+ * @param[in]   event         Event to signal.
+ * @return  ::CA_STATUS_OK or an error code if the event could not be registered.
+ */
+CAResult_t CARegisterProcessEvent(struct oc_event_t *event);
+
+/**
+ * Unregister an event registered with ::CARegisterProcessEvent.
+ * Other registered events are still signalled.
+ * @param[in]   event         Event to stop signalling.
+ */
+void CAUnregisterProcessEvent(struct oc_event_t *event);
+
 /**
  * Create an endpoint description.
  * @param[in]   flags                 how the adapter should be used.
@@ -192,6 +213,22 @@ CAResult_t CASendRequest(const CAEndpoint_t *object, const CARequestInfo_t *requ
  */
 CAResult_t CASendResponse(const CAEndpoint_t *object, const CAResponseInfo_t *responseInfo);
 
+/**
+ * Deliver a block-wise response to the request block by block.
+ * By default the blocks of a response are reassembled and the response callback is
+ * called once with the whole payload. After this call the response callback is called
+ * for every received block in order; each one carries only its block in info.payload and
+ * a ::CA_OPTION_BLOCK2 header option with its number, size and the more flag.
+ * Must be called before ::CASendRequest with the same token. Multicast requests are
+ * not supported.
+ * @param[in]   object       Endpoint where the request will be sent.
+ * @param[in]   requestInfo  Information for the request.
+ * @return ::CA_STATUS_OK or ::CA_STATUS_NOT_INITIALIZED or ::CA_STATUS_INVALID_PARAM or
+ *         ::CA_NOT_SUPPORTED if block-wise transfer is not available for the endpoint.
+ */
+CAResult_t CAEnableBlockwiseStreaming(const CAEndpoint_t *object,
+                                      const CARequestInfo_t *requestInfo);
+
 /**
  * Select network to use.
  * @param[in]   interestedNetwork    Connectivity Type enum.
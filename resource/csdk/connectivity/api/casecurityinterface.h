@@ -144,6 +144,14 @@ typedef CAResult_t (*PeerCNVerifyCallback)(const unsigned char *cn, size_t cnLen
  * @param[in] cb callback to utilize certificate Common Name field
  */
 void CAsetPeerCNVerifyCallback(PeerCNVerifyCallback cb);
+
+/**
+ * Notifies the SSL adapter that the credentials returned by the PKIX info handler
+ * have changed. The certificates, key and CRL parsed for earlier handshakes are
+ * reused until this is called, and are parsed again by the next handshake after it.
+ * Safe to call from any thread, including from the PKIX info handler.
+ */
+void CAnotifyCredentialsChanged(void);
 #endif
 
 /**
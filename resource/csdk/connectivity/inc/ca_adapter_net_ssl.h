@@ -39,6 +39,20 @@ typedef void (*CAPacketReceivedCallback)(const CASecureEndpoint_t *sep,
 typedef ssize_t (*CAPacketSendCallback)(CAEndpoint_t *endpoint,
                                         const void *data, size_t dataLength);
 
+/**
+ * (D)TLS handshake statistics. Times are in milliseconds, measured from the
+ * creation of the session until the handshake is over.
+ */
+typedef struct
+{
+    uint32_t fullHandshakes;        /**< number of completed full handshakes. */
+    uint32_t resumedHandshakes;     /**< number of completed abbreviated handshakes. */
+    uint32_t failedHandshakes;      /**< number of handshakes that failed. */
+    uint64_t fullHandshakeTime;     /**< accumulated time spent in full handshakes. */
+    uint64_t resumedHandshakeTime;  /**< accumulated time spent in abbreviated handshakes. */
+    uint64_t maxHandshakeTime;      /**< longest handshake seen. */
+} CASslHandshakeStats_t;
+
 /**
  * Select the cipher suite for dtls handshake
  *
@@ -158,6 +172,15 @@ CAResult_t CAinitiateSslHandshake(const CAEndpoint_t *endpoint);
  */
 void CAsetSslHandshakeCallback(CAHandshakeErrorCallback tlsHandshakeCallback);
 
+/**
+ * Get statistics about the (D)TLS handshakes done since initialization.
+ *
+ * @param[out] stats  handshake statistics
+ *
+ * @retval  ::CA_STATUS_OK for success, otherwise some error value
+ */
+CAResult_t CAgetSslHandshakeStats(CASslHandshakeStats_t *stats);
+
 /**
  * Generate ownerPSK using PRF
  * OwnerPSK = TLS-PRF('master key' , 'oic.sec.doxm.jw',
@@ -78,6 +78,10 @@ typedef struct
 
     /** mulitcast data list mutex for synchronization. **/
     oc_mutex multicastDataListMutex;
+
+    /** IDs of requests whose block-wise responses are delivered block by block.
+     *  protected by blockDataListMutex. **/
+    u_arraylist_t *streamIdList;
 } CABlockWiseContext_t;
 
 /**
@@ -92,7 +96,7 @@ typedef struct
 /**
  * Block Data Set.
  */
-typedef struct
+typedef struct CABlockData
 {
     coap_block_t block1;                /**< block1 option. */
     coap_block_t block2;                /**< block2 option. */
@@ -102,6 +106,9 @@ typedef struct
     CAPayload_t payload;                /**< payload buffer. */
     size_t payloadLength;               /**< the total payload length to be received. */
     size_t receivedPayloadLen;          /**< currently received payload length. */
+    size_t payloadCapacity;             /**< allocated size of the payload buffer. */
+    bool streaming;                     /**< deliver each received block to the upper layer. */
+    struct CABlockData *nextInTable;    /**< next block data in the same ID hash bucket. */
 } CABlockData_t;
 
 /**
@@ -576,6 +583,18 @@ CABlockData_t *CACreateNewBlockData(const CAData_t *sendData);
  */
 CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID);
 
+/**
+ * Deliver the blocks of the response to the given request one by one instead of
+ * reassembling them. The request is identified by the same seed info as block data.
+ * @param[in]   token         token of the request.
+ * @param[in]   tokenLength   token length of the request.
+ * @param[in]   addr          address of the remote device.
+ * @param[in]   portNumber    port of the remote device.
+ * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAAddBlockStreamId(const CAToken_t token, uint8_t tokenLength,
+                              const char* addr, uint16_t portNumber);
+
 /**
  * Remove all block data in block-wise transfer list.
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
@@ -27,6 +27,7 @@
 #define CA_MESSAGE_HANDLER_H_
 
 #include "cacommon.h"
+#include "ocevent.h"
 #include <coap/coap.h>
 
 #define CA_MEMORY_ALLOC_CHECK(arg) { if (NULL == arg) {OIC_LOG(ERROR, TAG, "Out of memory"); \
@@ -73,6 +74,20 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint,
 void CASetInterfaceCallbacks(CARequestCallback ReqHandler, CAResponseCallback RespHandler,
                              CAErrorCallback ErrorHandler);
 
+/**
+ * Adding an event signalled when received data is waiting to be handled.
+ * Several events can be added; each of them is signalled.
+ * @param[in] event           event to signal.
+ * @return  ::CA_STATUS_OK or an error code if no more events can be added.
+ */
+CAResult_t CAAddProcessEvent(oc_event event);
+
+/**
+ * Removing an event added with ::CAAddProcessEvent.
+ * @param[in] event           event to stop signalling.
+ */
+void CARemoveProcessEvent(oc_event event);
+
 /**
  * Initialize the message handler by starting thread pool and initializing the
  * send and receive queue.
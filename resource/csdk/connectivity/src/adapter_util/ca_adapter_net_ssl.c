@@ -36,7 +36,10 @@
 #include "experimental/ocrandom.h"
 #include "experimental/byte_array.h"
 #include "octhread.h"
+#include "ocatomic.h"
+#include "ocmetrics.h"
 #include "octimer.h"
+#include "oic_time.h"
 
 // headers required for mbed TLS
 #include "mbedtls/platform.h"
@@ -47,6 +50,12 @@
 #include "mbedtls/ssl_internal.h"
 #include "mbedtls/net_sockets.h"
 #include "mbedtls/oid.h"
+#if defined(MBEDTLS_SSL_CACHE_C)
+#include "mbedtls/ssl_cache.h"
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+#include "mbedtls/ssl_ticket.h"
+#endif
 #ifdef __WITH_DTLS__
 #include "mbedtls/timing.h"
 #include "mbedtls/ssl_cookie.h"
@@ -176,6 +185,24 @@
  */
 #define RETRANSMISSION_TIME 1
 
+/**
+ * @def SSL_PEER_TABLE_SIZE
+ * @brief Number of buckets in the peer lookup table. Must be a power of two.
+ */
+#define SSL_PEER_TABLE_SIZE (64)
+
+/**
+ * @def SSL_SESSION_LIFETIME
+ * @brief Lifetime (in seconds) of cached sessions and of issued session tickets.
+ */
+#define SSL_SESSION_LIFETIME (3600)
+
+/**
+ * @def SSL_SESSION_CACHE_SIZE
+ * @brief Maximum number of sessions cached for resumption, for each role.
+ */
+#define SSL_SESSION_CACHE_SIZE (32)
+
 /**@def SSL_CLOSE_NOTIFY(peer, ret)
  *
  * Notifies of existing \a peer about closing TLS connection.
@@ -353,6 +380,19 @@ typedef struct TlsCallBacks
     CAErrorHandleCallback errorCallback;    /**< Callback used to pass error to upper layer. */
 } SslCallbacks_t;
 
+/**
+ * Data structure for holding a client session kept for later resumption.
+ */
+typedef struct SslSavedSession
+{
+    bool used;                       /**< true if this slot holds a session. */
+    CAEndpoint_t endpoint;           /**< server the session was established with. */
+    mbedtls_ssl_session session;     /**< session data, including the ticket if one was issued. */
+    uint64_t savedTime;              /**< time (in ms) the session was stored. */
+} SslSavedSession_t;
+
+struct SslEndPoint;
+
 /**
  * Data structure for holding the mbedTLS interface related info.
  */
@@ -360,6 +400,7 @@ typedef struct SslContext
 {
     u_arraylist_t *peerList;         /**< peer list which holds the mapping between
                                               peer id, it's n/w address and mbedTLS context. */
+    struct SslEndPoint *peerTable[SSL_PEER_TABLE_SIZE]; /**< hashed index over peerList. */
     mbedtls_entropy_context entropy;
     mbedtls_ctr_drbg_context rnd;
     mbedtls_x509_crt ca;
@@ -377,11 +418,37 @@ typedef struct SslContext
     bool cipherFlag[2];
     int selectedCipher;
 
+    /* ca, crt, pkey and crl are parsed once per credential generation and reused by
+     * every handshake until the credentials change. */
+    bool pkixLoaded;                    /**< true once the PKIX objects have been parsed. */
+    int32_t pkixGeneration;             /**< g_credGeneration the PKIX objects were parsed at. */
+    CAgetPkixInfoHandler pkixSource;    /**< handler the PKIX objects were loaded from. */
+    bool ownCertLoaded;                 /**< crt and pkey hold a usable own certificate. */
+    bool caLoaded;                      /**< ca holds at least one trust anchor. */
+    bool crlLoaded;                     /**< crl holds a CRL. */
+    bool pkixConfigured[2];             /**< TLS and DTLS configs use the current objects. */
+    bool ownCertConfigured[2];          /**< crt and pkey were added to the TLS and DTLS configs. */
+
 #ifdef __WITH_DTLS__
     mbedtls_ssl_cookie_ctx cookieCtx;
     int timerId;
 #endif
 
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_context sessionCache;   /**< server side session ID cache. */
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_TICKET_C)
+    mbedtls_ssl_ticket_context ticketCtx;     /**< server side session ticket keys. */
+#endif
+    SslSavedSession_t savedSessions[SSL_SESSION_CACHE_SIZE]; /**< client side sessions. */
+    int32_t resumptionGeneration;   /**< g_credGeneration the cached sessions belong to. */
+    CASslHandshakeStats_t handshakeStats;
+
+    oc_mutex sharedMutex;        /**< serializes the RNG and cookie contexts, which are used
+                                      by record layer work done outside g_sslContextMutex. */
+    uint32_t recordOps;          /**< number of record layer operations in progress. */
+    oc_cond recordOpsDone;       /**< signalled when recordOps drops to zero. */
+
 } SslContext_t;
 
 /**
@@ -407,9 +474,22 @@ static CAgetCredentialTypesHandler g_getCredentialTypesCallback = NULL;
  */
 static CAgetPkixInfoHandler g_getPkixInfoCallback = NULL;
 
+/**
+ * @var g_credGeneration
+ *
+ * @brief bumped by CAnotifyCredentialsChanged to reload the cached PKIX objects
+ */
+static volatile int32_t g_credGeneration = 0;
+
 /**
  * @var g_dtlsContextMutex
  * @brief Mutex to synchronize access to g_caSslContext and g_sslCallback.
+ *
+ * It guards the peer list and table, the shared configurations and every
+ * handshake. Record layer work on an established session is done under the
+ * session's own mutex instead, with a reference taken on the session. Lock
+ * order is g_sslContextMutex, then a session mutex, then sharedMutex; never
+ * take g_sslContextMutex while holding a session mutex.
  */
 static oc_mutex g_sslContextMutex = NULL;
 
@@ -450,6 +530,11 @@ typedef struct SslEndPoint
 #ifdef __WITH_DTLS__
     mbedtls_timing_delay_context timer;
 #endif // __WITH_DTLS__
+    struct SslEndPoint *nextInTable;  /**< next peer in the same peerTable bucket. */
+    oc_mutex mutex;                   /**< serializes record layer work once the handshake is over. */
+    uint32_t refCount;                /**< references held by the peer list and record operations. */
+    uint64_t handshakeStart;          /**< time (in ms) the endpoint was created. */
+    bool resumed;                     /**< true if the handshake resumed a cached session. */
 } SslEndPoint_t;
 
 void CAsetPskCredentialsCallback(CAgetPskCredentialsHandler credCallback)
@@ -467,6 +552,13 @@ void CAsetPkixInfoCallback(CAgetPkixInfoHandler infoCallback)
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
 
+void CAnotifyCredentialsChanged(void)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    oc_atomic_increment(&g_credGeneration);
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+}
+
 void CAsetCredentialTypesCallback(CAgetCredentialTypesHandler credTypesCallback)
 {
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
@@ -557,6 +649,7 @@ static int GetAdapterIndex(CATransportAdapter_t adapter)
 }
 
 static void SendCacheMessages(SslEndPoint_t * tep, CAResult_t errorCode);
+static void RefreshSessionResumption();
 
 /**
  * Write callback.
@@ -708,11 +801,13 @@ static void DeInitPkixInfo(PkiInfo_t * inf)
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
 
-//Loads PKIX related information from SRM
-static int InitPKIX(CATransportAdapter_t adapter)
+/**
+ * Loads PKIX related information from SRM and parses it into the SSL context,
+ * replacing the objects parsed before.
+ */
+static void LoadPKIX(void)
 {
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
-    VERIFY_NON_NULL_RET(g_getPkixInfoCallback, NET_SSL_TAG, "PKIX info callback is NULL", -1);
     // load pk key, cert, trust chain and crl
     PkiInfo_t pkiInfo = {
         BYTE_ARRAY_INITIALIZER,
@@ -721,12 +816,7 @@ static int InitPKIX(CATransportAdapter_t adapter)
         BYTE_ARRAY_INITIALIZER
     };
 
-    if (g_getPkixInfoCallback)
-    {
-        g_getPkixInfoCallback(&pkiInfo);
-    }
-
-    VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", -1);
+    g_getPkixInfoCallback(&pkiInfo);
 
     mbedtls_x509_crt_free(&g_caSslContext->ca);
     mbedtls_x509_crt_free(&g_caSslContext->crt);
@@ -738,93 +828,146 @@ static int InitPKIX(CATransportAdapter_t adapter)
     mbedtls_pk_init(&g_caSslContext->pkey);
     mbedtls_x509_crl_init(&g_caSslContext->crl);
 
-    mbedtls_ssl_config * serverConf = (adapter == CA_ADAPTER_IP ||
-                                   adapter == CA_ADAPTER_GATT_BTLE ?
-                                   &g_caSslContext->serverDtlsConf : &g_caSslContext->serverTlsConf);
-    mbedtls_ssl_config * clientConf = (adapter == CA_ADAPTER_IP ||
-                                   adapter == CA_ADAPTER_GATT_BTLE ?
-                                   &g_caSslContext->clientDtlsConf : &g_caSslContext->clientTlsConf);
+    g_caSslContext->ownCertLoaded = false;
+    g_caSslContext->caLoaded = false;
+    g_caSslContext->crlLoaded = false;
+
     // optional
-    int ret;
     int errNum;
     int count = ParseChain(&g_caSslContext->crt, pkiInfo.crt.data, pkiInfo.crt.len, &errNum);
     if (0 >= count)
     {
         OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate chain parsing error");
-        goto required;
     }
-    if (0 != errNum)
+    else if (0 != errNum)
     {
         OIC_LOG_V(WARNING, NET_SSL_TAG, "Own certificate chain parsing error: %d certs failed to parse", errNum);
-        goto required;
     }
-    ret =  mbedtls_pk_parse_key(&g_caSslContext->pkey, pkiInfo.key.data, pkiInfo.key.len,
-                                                                               NULL, 0);
-    if (0 != ret)
+    else if (0 != mbedtls_pk_parse_key(&g_caSslContext->pkey, pkiInfo.key.data, pkiInfo.key.len,
+                                       NULL, 0))
     {
         OIC_LOG(WARNING, NET_SSL_TAG, "Key parsing error");
-        goto required;
-    }
-
-    ret = mbedtls_ssl_conf_own_cert(serverConf, &g_caSslContext->crt, &g_caSslContext->pkey);
-    if (0 != ret)
-    {
-        OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate parsing error");
-        goto required;
     }
-    ret = mbedtls_ssl_conf_own_cert(clientConf, &g_caSslContext->crt, &g_caSslContext->pkey);
-    if(0 != ret)
+    else
     {
-        OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate configuration error");
-        goto required;
+        g_caSslContext->ownCertLoaded = true;
     }
 
-    /* If we get here, certificates could be used, so configure OCF EKUs. */
-    ret = mbedtls_ssl_conf_ekus(serverConf, (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY),
-        (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY));
-    if (0 == ret)
+    // required
+    count = ParseChain(&g_caSslContext->ca, pkiInfo.ca.data, pkiInfo.ca.len, &errNum);
+    if (0 >= count)
     {
-        ret = mbedtls_ssl_conf_ekus(clientConf, (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY),
-            (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY));
+        OIC_LOG(ERROR, NET_SSL_TAG, "CA chain parsing error");
     }
-    if (0 != ret)
+    else
     {
-        /* Cert-based ciphersuites will fail, but if PSK ciphersuites are in
-         * the list they might work, so don't return error.
-         */
-        OIC_LOG(WARNING, NET_SSL_TAG, "EKU configuration error");
+        if (0 != errNum)
+        {
+            OIC_LOG_V(WARNING, NET_SSL_TAG, "CA chain parsing warning: %d certs failed to parse", errNum);
+        }
+        g_caSslContext->caLoaded = true;
     }
 
-    required:
-    count = ParseChain(&g_caSslContext->ca, pkiInfo.ca.data, pkiInfo.ca.len, &errNum);
-    if(0 >= count)
+    if (0 != mbedtls_x509_crl_parse_der(&g_caSslContext->crl, pkiInfo.crl.data, pkiInfo.crl.len))
     {
-        OIC_LOG(ERROR, NET_SSL_TAG, "CA chain parsing error");
-        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-        DeInitPkixInfo(&pkiInfo);
-        return -1;
+        OIC_LOG(WARNING, NET_SSL_TAG, "CRL parsing error");
     }
-    if(0 != errNum)
+    else
     {
-        OIC_LOG_V(WARNING, NET_SSL_TAG, "CA chain parsing warning: %d certs failed to parse", errNum);
+        g_caSslContext->crlLoaded = true;
     }
 
-    ret = mbedtls_x509_crl_parse_der(&g_caSslContext->crl, pkiInfo.crl.data, pkiInfo.crl.len);
-    if(0 != ret)
+    DeInitPkixInfo(&pkiInfo);
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+}
+
+/**
+ * Configures the PKIX objects for the given adapter, parsing them again only if the
+ * credentials changed since they were last loaded.
+ */
+static int InitPKIX(CATransportAdapter_t adapter)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    VERIFY_NON_NULL_RET(g_getPkixInfoCallback, NET_SSL_TAG, "PKIX info callback is NULL", -1);
+    VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", -1);
+
+    int32_t generation = oc_atomic_add(&g_credGeneration, 0);
+    if (!g_caSslContext->pkixLoaded ||
+        g_caSslContext->pkixGeneration != generation ||
+        g_caSslContext->pkixSource != g_getPkixInfoCallback)
     {
-        OIC_LOG(WARNING, NET_SSL_TAG, "CRL parsing error");
-        CONF_SSL(clientConf, serverConf, mbedtls_ssl_conf_ca_chain, &g_caSslContext->ca, NULL);
+        // Record the generation first, so a change made while loading reloads again.
+        g_caSslContext->pkixGeneration = generation;
+        g_caSslContext->pkixSource = g_getPkixInfoCallback;
+        LoadPKIX();
+        g_caSslContext->pkixLoaded = true;
+        g_caSslContext->pkixConfigured[0] = false;
+        g_caSslContext->pkixConfigured[1] = false;
     }
     else
     {
-        CONF_SSL(clientConf, serverConf, mbedtls_ssl_conf_ca_chain,
-                 &g_caSslContext->ca, &g_caSslContext->crl);
+        OIC_LOG(DEBUG, NET_SSL_TAG, "Reusing parsed PKIX info");
     }
 
-    DeInitPkixInfo(&pkiInfo);
+    bool isDtls = (adapter == CA_ADAPTER_IP || adapter == CA_ADAPTER_GATT_BTLE);
+    mbedtls_ssl_config * serverConf = (isDtls ?
+                                   &g_caSslContext->serverDtlsConf : &g_caSslContext->serverTlsConf);
+    mbedtls_ssl_config * clientConf = (isDtls ?
+                                   &g_caSslContext->clientDtlsConf : &g_caSslContext->clientTlsConf);
+
+    if (!g_caSslContext->pkixConfigured[isDtls])
+    {
+        /* The configs point at crt and pkey, which are parsed again in place when the
+         * credentials change, so they only need to be added to each config once. */
+        if (g_caSslContext->ownCertLoaded && !g_caSslContext->ownCertConfigured[isDtls])
+        {
+            int ret = mbedtls_ssl_conf_own_cert(serverConf, &g_caSslContext->crt,
+                                                &g_caSslContext->pkey);
+            if (0 != ret)
+            {
+                OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate parsing error");
+            }
+            else
+            {
+                ret = mbedtls_ssl_conf_own_cert(clientConf, &g_caSslContext->crt,
+                                                &g_caSslContext->pkey);
+                if (0 != ret)
+                {
+                    OIC_LOG(WARNING, NET_SSL_TAG, "Own certificate configuration error");
+                }
+            }
+            g_caSslContext->ownCertConfigured[isDtls] = (0 == ret);
+        }
+
+        if (g_caSslContext->ownCertLoaded && g_caSslContext->ownCertConfigured[isDtls])
+        {
+            /* If we get here, certificates could be used, so configure OCF EKUs. */
+            int ret = mbedtls_ssl_conf_ekus(serverConf, (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY),
+                (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY));
+            if (0 == ret)
+            {
+                ret = mbedtls_ssl_conf_ekus(clientConf, (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY),
+                    (const char*)EKU_IDENTITY, sizeof(EKU_IDENTITY));
+            }
+            if (0 != ret)
+            {
+                /* Cert-based ciphersuites will fail, but if PSK ciphersuites are in
+                 * the list they might work, so don't return error.
+                 */
+                OIC_LOG(WARNING, NET_SSL_TAG, "EKU configuration error");
+            }
+        }
+
+        if (g_caSslContext->caLoaded)
+        {
+            CONF_SSL(clientConf, serverConf, mbedtls_ssl_conf_ca_chain, &g_caSslContext->ca,
+                     g_caSslContext->crlLoaded ? &g_caSslContext->crl : NULL);
+        }
+        g_caSslContext->pkixConfigured[isDtls] = true;
+    }
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-    return 0;
+    return g_caSslContext->caLoaded ? 0 : -1;
 }
 
 /*
@@ -868,6 +1011,89 @@ static int GetPskCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
     OIC_LOG_V(WARNING, NET_SSL_TAG, "Out %s", __func__);
     return -1;
 }
+/**
+ * Checks whether two endpoints refer to the same remote peer.
+ *
+ * BLE peers are matched by address only, since their port is not meaningful.
+ *
+ * @param[in]  first     remote address
+ * @param[in]  second    remote address
+ *
+ * @return  true if the endpoints match
+ */
+static bool IsSamePeer(const CAEndpoint_t *first, const CAEndpoint_t *second)
+{
+    return (first->adapter == second->adapter)
+            && (0 == strncmp(first->addr, second->addr, MAX_ADDR_STR_SIZE_CA))
+            && (first->port == second->port || CA_ADAPTER_GATT_BTLE == first->adapter);
+}
+
+/**
+ * Gets the peerTable bucket for endpoint.
+ *
+ * The port is left out of the hash so that BLE peers, which are matched
+ * by address only, always fall into the same bucket.
+ *
+ * @param[in]  endpoint    remote address
+ *
+ * @return  bucket index
+ */
+static size_t GetPeerTableIndex(const CAEndpoint_t *endpoint)
+{
+    // 32-bit FNV-1a
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ (uint32_t)endpoint->adapter) * 16777619u;
+    for (size_t i = 0; i < MAX_ADDR_STR_SIZE_CA && '\0' != endpoint->addr[i]; i++)
+    {
+        hash = (hash ^ (uint8_t)endpoint->addr[i]) * 16777619u;
+    }
+    return hash & (SSL_PEER_TABLE_SIZE - 1);
+}
+
+/**
+ * Adds endpoint session to the peer list and the peer lookup table.
+ *
+ * @param[in]  tep    endpoint with session info
+ *
+ * @return  true on success, false otherwise
+ */
+static bool AddPeerToList(SslEndPoint_t *tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    if (!u_arraylist_add(g_caSslContext->peerList, (void *) tep))
+    {
+        return false;
+    }
+
+    size_t index = GetPeerTableIndex(&tep->sep.endpoint);
+    tep->nextInTable = g_caSslContext->peerTable[index];
+    g_caSslContext->peerTable[index] = tep;
+    return true;
+}
+
+/**
+ * Removes endpoint session from the peer lookup table only.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void UnlinkPeerFromTable(SslEndPoint_t *tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    SslEndPoint_t **link = &g_caSslContext->peerTable[GetPeerTableIndex(&tep->sep.endpoint)];
+    while (NULL != *link)
+    {
+        if (*link == tep)
+        {
+            *link = tep->nextInTable;
+            tep->nextInTable = NULL;
+            return;
+        }
+        link = &(*link)->nextInTable;
+    }
+}
+
 /**
  * Gets session corresponding for endpoint.
  *
@@ -877,8 +1103,6 @@ static int GetPskCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
  */
 static SslEndPoint_t *GetSslPeer(const CAEndpoint_t *peer)
 {
-    size_t listIndex = 0;
-    size_t listLength = 0;
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
 
     oc_mutex_assert_owner(g_sslContextMutex, true);
@@ -886,24 +1110,13 @@ static SslEndPoint_t *GetSslPeer(const CAEndpoint_t *peer)
     VERIFY_NON_NULL_RET(peer, NET_SSL_TAG, "TLS peer is NULL", NULL);
     VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", NULL);
 
-    SslEndPoint_t *tep = NULL;
-    listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (listIndex = 0; listIndex < listLength; listIndex++)
+    SslEndPoint_t *tep = g_caSslContext->peerTable[GetPeerTableIndex(peer)];
+    for (; NULL != tep; tep = tep->nextInTable)
     {
-        tep = (SslEndPoint_t *) u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
-
-        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Compare [%s:%d] and [%s:%d] for %d adapter",
-                  peer->addr, peer->port, tep->sep.endpoint.addr, tep->sep.endpoint.port,
-                  peer->adapter);
-
-        if((peer->adapter == tep->sep.endpoint.adapter)
-                && (0 == strncmp(peer->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA))
-                && (peer->port == tep->sep.endpoint.port || CA_ADAPTER_GATT_BTLE == peer->adapter))
+        if (IsSamePeer(peer, &tep->sep.endpoint))
         {
+            OIC_LOG_V(DEBUG, NET_SSL_TAG, "Found [%s:%d] for %d adapter",
+                      tep->sep.endpoint.addr, tep->sep.endpoint.port, peer->adapter);
             OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
             return tep;
         }
@@ -913,6 +1126,201 @@ static SslEndPoint_t *GetSslPeer(const CAEndpoint_t *peer)
     return NULL;
 }
 
+/**
+ * Checks whether a session may be cached for later resumption.
+ *
+ * Sessions negotiated with PSK or anonymous ciphersuites are never cached:
+ * the peer identity of those is only learned during a full handshake, and
+ * owner PSK derivation needs the randoms of a full handshake too.
+ *
+ * @param[in]  session    negotiated session
+ *
+ * @return  true if the session may be resumed
+ */
+static bool IsResumableSession(const mbedtls_ssl_session *session)
+{
+    return (NULL != session)
+            && (MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256 != session->ciphersuite)
+            && (MBEDTLS_TLS_ECDH_ANON_WITH_AES_128_CBC_SHA256 != session->ciphersuite);
+}
+
+/**
+ * Gets the saved client session for endpoint.
+ *
+ * @param[in]  endpoint    remote address
+ *
+ * @return  saved session or NULL
+ */
+static SslSavedSession_t *GetSavedSession(const CAEndpoint_t *endpoint)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+    VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", NULL);
+
+    for (size_t i = 0; i < SSL_SESSION_CACHE_SIZE; i++)
+    {
+        SslSavedSession_t *saved = &g_caSslContext->savedSessions[i];
+        if (saved->used && IsSamePeer(endpoint, &saved->endpoint))
+        {
+            return saved;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Drops the saved client session for endpoint, if any.
+ *
+ * @param[in]  endpoint    remote address
+ */
+static void ForgetSavedSession(const CAEndpoint_t *endpoint)
+{
+    SslSavedSession_t *saved = GetSavedSession(endpoint);
+    if (NULL != saved)
+    {
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Forget session with [%s:%d]",
+                  saved->endpoint.addr, saved->endpoint.port);
+        mbedtls_ssl_session_free(&saved->session);
+        saved->used = false;
+    }
+}
+
+/**
+ * Saves the session of a finished client handshake for later resumption.
+ * When the cache is full the oldest session is replaced.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void SaveClientSession(SslEndPoint_t *tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    if (!IsResumableSession(tep->ssl.session))
+    {
+        ForgetSavedSession(&tep->sep.endpoint);
+        return;
+    }
+
+    SslSavedSession_t *saved = GetSavedSession(&tep->sep.endpoint);
+    for (size_t i = 0; NULL == saved && i < SSL_SESSION_CACHE_SIZE; i++)
+    {
+        if (!g_caSslContext->savedSessions[i].used)
+        {
+            saved = &g_caSslContext->savedSessions[i];
+        }
+    }
+    if (NULL == saved)
+    {
+        saved = &g_caSslContext->savedSessions[0];
+        for (size_t i = 1; i < SSL_SESSION_CACHE_SIZE; i++)
+        {
+            if (g_caSslContext->savedSessions[i].savedTime < saved->savedTime)
+            {
+                saved = &g_caSslContext->savedSessions[i];
+            }
+        }
+    }
+
+    if (saved->used)
+    {
+        mbedtls_ssl_session_free(&saved->session);
+    }
+    mbedtls_ssl_session_init(&saved->session);
+    if (0 != mbedtls_ssl_get_session(&tep->ssl, &saved->session))
+    {
+        OIC_LOG(WARNING, NET_SSL_TAG, "Failed to save session");
+        mbedtls_ssl_session_free(&saved->session);
+        saved->used = false;
+        return;
+    }
+    saved->endpoint = tep->sep.endpoint;
+    saved->savedTime = OICGetCurrentTime(TIME_IN_MS);
+    saved->used = true;
+}
+
+/**
+ * Offers the saved session, if any and not expired, to the server.
+ *
+ * @param[in]  tep    client endpoint whose handshake has not started yet
+ */
+static void OfferSavedSession(SslEndPoint_t *tep)
+{
+    SslSavedSession_t *saved = GetSavedSession(&tep->sep.endpoint);
+    if (NULL == saved)
+    {
+        return;
+    }
+    if (OICGetCurrentTime(TIME_IN_MS) - saved->savedTime > SSL_SESSION_LIFETIME * 1000)
+    {
+        ForgetSavedSession(&tep->sep.endpoint);
+        return;
+    }
+    if (0 == mbedtls_ssl_set_session(&tep->ssl, &saved->session))
+    {
+        OIC_LOG(DEBUG, NET_SSL_TAG, "Offering cached session");
+    }
+}
+
+/**
+ * Updates handshake statistics with a finished handshake.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void RecordHandshakeTime(const SslEndPoint_t *tep)
+{
+    CASslHandshakeStats_t *stats = &g_caSslContext->handshakeStats;
+    uint64_t elapsed = OICGetCurrentTime(TIME_IN_MS) - tep->handshakeStart;
+
+    if (tep->resumed)
+    {
+        stats->resumedHandshakes++;
+        stats->resumedHandshakeTime += elapsed;
+    }
+    else
+    {
+        stats->fullHandshakes++;
+        stats->fullHandshakeTime += elapsed;
+    }
+    if (elapsed > stats->maxHandshakeTime)
+    {
+        stats->maxHandshakeTime = elapsed;
+    }
+    oc_metrics_increment(OC_METRIC_HANDSHAKES_COMPLETED);
+    oc_metrics_record(OC_METRIC_HANDSHAKE_LATENCY, elapsed * 1000);
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "%s handshake took %" PRIu64 " ms",
+              tep->resumed ? "Abbreviated" : "Full", elapsed);
+}
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+/**
+ * Server session cache store callback. Stores resumable sessions only.
+ */
+static int SslCacheSet(void *data, const mbedtls_ssl_session *session)
+{
+    if (!IsResumableSession(session))
+    {
+        return 1;
+    }
+    return mbedtls_ssl_cache_set(data, session);
+}
+#endif
+
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_TICKET_C)
+/**
+ * Session ticket write callback. Issues tickets for resumable sessions only;
+ * mbedTLS sends an empty ticket when this fails.
+ */
+static int SslTicketWrite(void *ticketCtx, const mbedtls_ssl_session *session,
+                          unsigned char *start, const unsigned char *end,
+                          size_t *tlen, uint32_t *lifetime)
+{
+    if (!IsResumableSession(session))
+    {
+        return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+    }
+    return mbedtls_ssl_ticket_write(ticketCtx, session, start, end, tlen, lifetime);
+}
+#endif
+
 /**
  * Gets a copy of CA secure endpoint info corresponding for endpoint.
  *
@@ -1102,9 +1510,78 @@ static void DeleteSslEndPoint(SslEndPoint_t * tep)
 
     mbedtls_ssl_free(&tep->ssl);
     DeleteCacheList(tep->cacheList);
+    oc_mutex_free(tep->mutex);
     OICFree(tep);
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
+
+/**
+ * Drops a reference to endpoint and deletes it when none are left.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void UnrefSslPeer(SslEndPoint_t * tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    if (0 == --tep->refCount)
+    {
+        DeleteSslEndPoint(tep);
+    }
+}
+
+/**
+ * Takes a reference to an established session, so that record layer work
+ * can be done on it after g_sslContextMutex is released.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void AcquireSslPeer(SslEndPoint_t * tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    tep->refCount++;
+    g_caSslContext->recordOps++;
+}
+
+/**
+ * Releases a reference taken with AcquireSslPeer().
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void ReleaseSslPeer(SslEndPoint_t * tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    if (0 == --g_caSslContext->recordOps && NULL != g_caSslContext->recordOpsDone)
+    {
+        oc_cond_broadcast(g_caSslContext->recordOpsDone);
+    }
+    UnrefSslPeer(tep);
+}
+
+/**
+ * Removes endpoint session from list, if it is still there.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void RemoveSslPeer(SslEndPoint_t * tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
+    for (size_t listIndex = 0; listIndex < listLength; listIndex++)
+    {
+        if (tep == u_arraylist_get(g_caSslContext->peerList, listIndex))
+        {
+            u_arraylist_remove(g_caSslContext->peerList, listIndex);
+            UnlinkPeerFromTable(tep);
+            UnrefSslPeer(tep);
+            return;
+        }
+    }
+}
+
 /**
  * Removes endpoint session from list.
  *
@@ -1129,7 +1606,8 @@ static void RemovePeerFromList(CAEndpoint_t * endpoint)
                 && (endpoint->port == tep->sep.endpoint.port))
         {
             u_arraylist_remove(g_caSslContext->peerList, listIndex);
-            DeleteSslEndPoint(tep);
+            UnlinkPeerFromTable(tep);
+            UnrefSslPeer(tep);
             return;
         }
     }
@@ -1184,6 +1662,16 @@ static bool checkSslOperation(SslEndPoint_t*  peer,
 
         oc_mutex_lock(g_sslContextMutex);
 
+        if (MBEDTLS_SSL_HANDSHAKE_OVER != peer->ssl.state)
+        {
+            g_caSslContext->handshakeStats.failedHandshakes++;
+            // Don't offer a session again if the handshake using it failed.
+            if (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint)
+            {
+                ForgetSavedSession(&removedEndpoint);
+            }
+        }
+
         if (MBEDTLS_ERR_SSL_BAD_HS_CLIENT_HELLO != ret)
         {
             CAResult_t result = notifySubscriber(peer, CA_DTLS_AUTHENTICATION_FAILURE);
@@ -1209,6 +1697,36 @@ static bool checkSslOperation(SslEndPoint_t*  peer,
     return true;
 }
 
+/**
+ * Checks the CN of the peer of a resumed session. An abbreviated handshake
+ * skips the certificate states, so the check done there for full handshakes
+ * is run on the certificate kept in the resumed session instead.
+ *
+ * @param[in]  peer    endpoint whose resumed handshake is over
+ *
+ * @return  true if the peer is accepted
+ */
+static bool VerifyResumedPeer(SslEndPoint_t *peer)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    if (!peer->resumed || !IsResumableSession(peer->ssl.session))
+    {
+        return true;
+    }
+
+    const mbedtls_x509_crt *peerCert = mbedtls_ssl_get_peer_cert(&peer->ssl);
+    int ret = (NULL == peerCert || CA_STATUS_OK != PeerCertExtractCN(peerCert)) ? -1 : 0;
+    if ((0 != ret) && (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint))
+    {
+        ForgetSavedSession(&peer->sep.endpoint);
+    }
+    return checkSslOperation(peer,
+                             ret,
+                             "Resumed peer verification failed",
+                             MBEDTLS_SSL_ALERT_MSG_ACCESS_DENIED);
+}
+
 /**
  * Deletes session list.
  */
@@ -1226,6 +1744,7 @@ static void DeletePeerList()
         {
             continue;
         }
+        oc_mutex_lock(tep->mutex);
         if (MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
         {
             int ret = 0;
@@ -1235,9 +1754,11 @@ static void DeletePeerList()
             }
             while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);
         }
-        DeleteSslEndPoint(tep);
+        oc_mutex_unlock(tep->mutex);
+        UnrefSslPeer(tep);
     }
     u_arraylist_free(&g_caSslContext->peerList);
+    memset(g_caSslContext->peerTable, 0, sizeof(g_caSslContext->peerTable));
 }
 
 CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint)
@@ -1261,12 +1782,17 @@ CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint)
     }
     /* No error checking, the connection might be closed already */
     int ret = 0;
+    oc_mutex_lock(tep->mutex);
     do
     {
         ret = mbedtls_ssl_close_notify(&tep->ssl);
     }
     while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);
+    oc_mutex_unlock(tep->mutex);
 
+    // An explicit close usually precedes a credential change, e.g. after
+    // ownership transfer, so the next connection must not resume this session.
+    ForgetSavedSession(&tep->sep.endpoint);
     RemovePeerFromList(&tep->sep.endpoint);
     oc_mutex_unlock(g_sslContextMutex);
 
@@ -1315,7 +1841,8 @@ void CAcloseSslConnectionAll(CATransportAdapter_t transportType)
 
         // delete from list
         u_arraylist_remove(g_caSslContext->peerList, i - 1);
-        DeleteSslEndPoint(tep);
+        UnlinkPeerFromTable(tep);
+        UnrefSslPeer(tep);
     }
     oc_mutex_unlock(g_sslContextMutex);
 
@@ -1347,10 +1874,22 @@ static SslEndPoint_t * NewSslEndPoint(const CAEndpoint_t * endpoint, mbedtls_ssl
 
     tep->sep.endpoint = *endpoint;
     tep->sep.endpoint.flags = (CATransportFlags_t)(tep->sep.endpoint.flags | CA_SECURE);
+    tep->handshakeStart = OICGetCurrentTime(TIME_IN_MS);
+    tep->refCount = 1;
+
+    tep->mutex = oc_mutex_new();
+    if (NULL == tep->mutex)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Mutex creation failed!");
+        OICFree(tep);
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        return NULL;
+    }
 
     if(0 != mbedtls_ssl_setup(&tep->ssl, config))
     {
         OIC_LOG(ERROR, NET_SSL_TAG, "Setup failed");
+        oc_mutex_free(tep->mutex);
         OICFree(tep);
         OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
         return NULL;
@@ -1368,6 +1907,7 @@ static SslEndPoint_t * NewSslEndPoint(const CAEndpoint_t * endpoint, mbedtls_ssl
             {
                 OIC_LOG(ERROR, NET_SSL_TAG, "Transport id setup failed!");
                 mbedtls_ssl_free(&tep->ssl);
+                oc_mutex_free(tep->mutex);
                 OICFree(tep);
                 OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
                 return NULL;
@@ -1379,10 +1919,12 @@ static SslEndPoint_t * NewSslEndPoint(const CAEndpoint_t * endpoint, mbedtls_ssl
     {
         OIC_LOG(ERROR, NET_SSL_TAG, "cacheList initialization failed!");
         mbedtls_ssl_free(&tep->ssl);
+        oc_mutex_free(tep->mutex);
         OICFree(tep);
         OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
         return NULL;
     }
+    oc_metrics_increment(OC_METRIC_HANDSHAKES_STARTED);
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "New [%s role] endpoint added [%s:%d]",
             (MBEDTLS_SSL_IS_SERVER==config->endpoint ? "server" : "client"),
             endpoint->addr, endpoint->port);
@@ -1555,8 +2097,7 @@ static SslEndPoint_t * InitiateTlsHandshake(const CAEndpoint_t *endpoint)
     }
 
     oc_mutex_lock(g_sslContextMutex);
-    ret = u_arraylist_add(g_caSslContext->peerList, (void *) tep);
-    if (!ret)
+    if (!AddPeerToList(tep))
     {
         oc_mutex_unlock(g_sslContextMutex);
         OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
@@ -1564,6 +2105,9 @@ static SslEndPoint_t * InitiateTlsHandshake(const CAEndpoint_t *endpoint)
         return NULL;
     }
 
+    RefreshSessionResumption();
+    OfferSavedSession(tep);
+
     while (MBEDTLS_SSL_HANDSHAKE_OVER > tep->ssl.state)
     {
         ret = mbedtls_ssl_handshake_step(&tep->ssl);
@@ -1583,9 +2127,9 @@ static SslEndPoint_t * InitiateTlsHandshake(const CAEndpoint_t *endpoint)
                                "Handshake error",
                                MBEDTLS_SSL_ALERT_MSG_HANDSHAKE_FAILURE))
         {
+            // checkSslOperation() already removed and deleted tep
             oc_mutex_unlock(g_sslContextMutex);
             OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-            DeleteSslEndPoint(tep);
             return NULL;
         }
     }
@@ -1607,6 +2151,118 @@ static void StopRetransmit()
     }
 }
 #endif
+
+/**
+ * RNG callback. mbedTLS is built without MBEDTLS_THREADING_C, so the shared
+ * DRBG is serialized here: record encryption of established sessions uses it
+ * outside g_sslContextMutex.
+ */
+static int SslRandom(void *rnd, unsigned char *output, size_t outputLen)
+{
+    oc_mutex_lock(g_caSslContext->sharedMutex);
+    int ret = mbedtls_ctr_drbg_random(rnd, output, outputLen);
+    oc_mutex_unlock(g_caSslContext->sharedMutex);
+    return ret;
+}
+
+/**
+ * Sets up the server side session ID cache and session ticket keys, and
+ * hooks them into the server configurations.
+ *
+ * @return  0 on success or -1 on error
+ */
+static int InitSessionResumption()
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", -1);
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_init(&g_caSslContext->sessionCache);
+    mbedtls_ssl_cache_set_timeout(&g_caSslContext->sessionCache, SSL_SESSION_LIFETIME);
+    mbedtls_ssl_cache_set_max_entries(&g_caSslContext->sessionCache, SSL_SESSION_CACHE_SIZE);
+#ifdef __WITH_TLS__
+    mbedtls_ssl_conf_session_cache(&g_caSslContext->serverTlsConf, &g_caSslContext->sessionCache,
+                                   mbedtls_ssl_cache_get, SslCacheSet);
+#endif
+#ifdef __WITH_DTLS__
+    mbedtls_ssl_conf_session_cache(&g_caSslContext->serverDtlsConf, &g_caSslContext->sessionCache,
+                                   mbedtls_ssl_cache_get, SslCacheSet);
+#endif
+#endif // MBEDTLS_SSL_CACHE_C
+
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_TICKET_C)
+    mbedtls_ssl_ticket_init(&g_caSslContext->ticketCtx);
+    if (0 != mbedtls_ssl_ticket_setup(&g_caSslContext->ticketCtx, SslRandom,
+                                      &g_caSslContext->rnd, MBEDTLS_CIPHER_AES_128_GCM,
+                                      SSL_SESSION_LIFETIME))
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session ticket setup failed!");
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        return -1;
+    }
+#ifdef __WITH_TLS__
+    mbedtls_ssl_conf_session_tickets_cb(&g_caSslContext->serverTlsConf, SslTicketWrite,
+                                        mbedtls_ssl_ticket_parse, &g_caSslContext->ticketCtx);
+#endif
+#ifdef __WITH_DTLS__
+    mbedtls_ssl_conf_session_tickets_cb(&g_caSslContext->serverDtlsConf, SslTicketWrite,
+                                        mbedtls_ssl_ticket_parse, &g_caSslContext->ticketCtx);
+#endif
+#endif // MBEDTLS_SSL_SESSION_TICKETS && MBEDTLS_SSL_TICKET_C
+
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+    return 0;
+}
+
+/**
+ * Frees all cached sessions and the session ticket keys.
+ */
+static void DeInitSessionResumption()
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+    VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
+
+    for (size_t i = 0; i < SSL_SESSION_CACHE_SIZE; i++)
+    {
+        if (g_caSslContext->savedSessions[i].used)
+        {
+            mbedtls_ssl_session_free(&g_caSslContext->savedSessions[i].session);
+            g_caSslContext->savedSessions[i].used = false;
+        }
+    }
+#if defined(MBEDTLS_SSL_CACHE_C)
+    mbedtls_ssl_cache_free(&g_caSslContext->sessionCache);
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_TICKET_C)
+    mbedtls_ssl_ticket_free(&g_caSslContext->ticketCtx);
+#endif
+}
+
+/**
+ * Drops all cached sessions and rotates the session ticket keys if the
+ * credentials or the CRL changed since the sessions were cached, so that a
+ * peer whose credential was deleted or revoked cannot resume.
+ */
+static void RefreshSessionResumption()
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+    VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
+
+    int32_t generation = oc_atomic_add(&g_credGeneration, 0);
+    if (g_caSslContext->resumptionGeneration == generation)
+    {
+        return;
+    }
+
+    OIC_LOG(DEBUG, NET_SSL_TAG, "Credentials changed, flushing cached sessions");
+    g_caSslContext->resumptionGeneration = generation;
+    DeInitSessionResumption();
+    if (0 != InitSessionResumption())
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session resumption re-initialization failed!");
+    }
+}
+
 void CAdeinitSslAdapter()
 {
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
@@ -1619,10 +2275,19 @@ void CAdeinitSslAdapter()
 
     // Clear all lists
     DeletePeerList();
+    DeInitSessionResumption();
+
+    // Wait for record layer operations still using removed sessions
+    while (0 < g_caSslContext->recordOps)
+    {
+        oc_cond_wait(g_caSslContext->recordOpsDone, g_sslContextMutex);
+    }
 
     // De-initialize mbedTLS
+    mbedtls_x509_crt_free(&g_caSslContext->ca);
     mbedtls_x509_crt_free(&g_caSslContext->crt);
     mbedtls_pk_free(&g_caSslContext->pkey);
+    mbedtls_x509_crl_free(&g_caSslContext->crl);
 #ifdef __WITH_TLS__
     mbedtls_ssl_config_free(&g_caSslContext->clientTlsConf);
     mbedtls_ssl_config_free(&g_caSslContext->serverTlsConf);
@@ -1637,6 +2302,8 @@ void CAdeinitSslAdapter()
 #ifdef __WITH_DTLS__
     StopRetransmit();
 #endif
+    oc_cond_free(g_caSslContext->recordOpsDone);
+    oc_mutex_free(g_caSslContext->sharedMutex);
     // De-initialize tls Context
     OICFree(g_caSslContext);
     g_caSslContext = NULL;
@@ -1649,6 +2316,33 @@ void CAdeinitSslAdapter()
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s ", __func__);
 }
 
+#ifdef __WITH_DTLS__
+/**
+ * DTLS cookie write callback, serialized for the same reason as SslRandom():
+ * a client reconnect is detected while reading an established session.
+ */
+static int SslCookieWrite(void *cookieCtx, unsigned char **p, unsigned char *end,
+                          const unsigned char *info, size_t infoLen)
+{
+    oc_mutex_lock(g_caSslContext->sharedMutex);
+    int ret = mbedtls_ssl_cookie_write(cookieCtx, p, end, info, infoLen);
+    oc_mutex_unlock(g_caSslContext->sharedMutex);
+    return ret;
+}
+
+/**
+ * DTLS cookie check callback, see SslCookieWrite().
+ */
+static int SslCookieCheck(void *cookieCtx, const unsigned char *cookie, size_t cookieLen,
+                          const unsigned char *info, size_t infoLen)
+{
+    oc_mutex_lock(g_caSslContext->sharedMutex);
+    int ret = mbedtls_ssl_cookie_check(cookieCtx, cookie, cookieLen, info, infoLen);
+    oc_mutex_unlock(g_caSslContext->sharedMutex);
+    return ret;
+}
+#endif // __WITH_DTLS__
+
 static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
 {
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
@@ -1666,7 +2360,7 @@ static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
      * time, see extlibs/mbedtls/config-iotivity.h
      */
     mbedtls_ssl_conf_psk_cb(conf, GetPskCredentialsCallback, NULL);
-    mbedtls_ssl_conf_rng(conf, mbedtls_ctr_drbg_random, &g_caSslContext->rnd);
+    mbedtls_ssl_conf_rng(conf, SslRandom, &g_caSslContext->rnd);
     mbedtls_ssl_conf_curves(conf, curve[ADAPTER_CURVE_SECP256R1]);
     mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_REQUIRED);
 
@@ -1674,7 +2368,7 @@ static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
     if (MBEDTLS_SSL_TRANSPORT_DATAGRAM == transport &&
             MBEDTLS_SSL_IS_SERVER == mode)
     {
-        mbedtls_ssl_conf_dtls_cookies(conf, mbedtls_ssl_cookie_write, mbedtls_ssl_cookie_check,
+        mbedtls_ssl_conf_dtls_cookies(conf, SslCookieWrite, SslCookieCheck,
                                       &g_caSslContext->cookieCtx);
     }
 #endif // __WITH_DTLS__
@@ -1720,8 +2414,14 @@ static void StartRetransmit(void *ctx)
         {
             tep = (SslEndPoint_t *) u_arraylist_get(g_caSslContext->peerList, listIndex);
             if (NULL == tep
-                || (tep->ssl.conf && MBEDTLS_SSL_TRANSPORT_STREAM == tep->ssl.conf->transport)
-                || MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
+                || (tep->ssl.conf && MBEDTLS_SSL_TRANSPORT_STREAM == tep->ssl.conf->transport))
+            {
+                continue;
+            }
+            oc_mutex_lock(tep->mutex);
+            bool established = (MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state);
+            oc_mutex_unlock(tep->mutex);
+            if (established)
             {
                 continue;
             }
@@ -1792,6 +2492,16 @@ CAResult_t CAinitSslAdapter()
         return CA_STATUS_FAILED;
     }
 
+    g_caSslContext->sharedMutex = oc_mutex_new();
+    g_caSslContext->recordOpsDone = oc_cond_new();
+    if (NULL == g_caSslContext->sharedMutex || NULL == g_caSslContext->recordOpsDone)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Synchronization primitives initialization failed!");
+        oc_mutex_unlock(g_sslContextMutex);
+        CAdeinitSslAdapter();
+        return CA_STATUS_FAILED;
+    }
+
     /* Initialize TLS library
      */
 #if !defined(NDEBUG) || defined(TB_LOG)
@@ -1874,6 +2584,16 @@ CAResult_t CAinitSslAdapter()
     }
 #endif // __WITH_DTLS__
 
+    g_caSslContext->resumptionGeneration = oc_atomic_add(&g_credGeneration, 0);
+    if (0 != InitSessionResumption())
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session resumption initialization failed!");
+        oc_mutex_unlock(g_sslContextMutex);
+        CAdeinitSslAdapter();
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        return CA_STATUS_FAILED;
+    }
+
     // set default cipher
     g_caSslContext->cipher = SSL_CIPHER_MAX;
 
@@ -1969,8 +2689,16 @@ CAResult_t CAencryptSsl(const CAEndpoint_t *endpoint,
         return CA_STATUS_FAILED;
     }
 
+    // The state is changed by record layer work done under the session mutex
+    // only, e.g. when mbedtls_ssl_read() resets the session on a DTLS reconnect.
+    oc_mutex_lock(tep->mutex);
     if (MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
     {
+        // Encrypt outside of the context lock, so that handshakes and traffic
+        // of other peers can proceed meanwhile.
+        AcquireSslPeer(tep);
+        oc_mutex_unlock(g_sslContextMutex);
+
         unsigned char *dataBuf = (unsigned char *)data;
         size_t written = 0;
 
@@ -1982,9 +2710,7 @@ CAResult_t CAencryptSsl(const CAEndpoint_t *endpoint,
                 if (MBEDTLS_ERR_SSL_WANT_WRITE != ret)
                 {
                     OIC_LOG_V(ERROR, NET_SSL_TAG, "mbedTLS write failed! returned 0x%x", -ret);
-                    RemovePeerFromList(&tep->sep.endpoint);
-                    oc_mutex_unlock(g_sslContextMutex);
-                    return CA_STATUS_FAILED;
+                    break;
                 }
                 continue;
             }
@@ -1993,10 +2719,26 @@ CAResult_t CAencryptSsl(const CAEndpoint_t *endpoint,
             dataBuf += ret;
             written += ret;
         } while (dataLen > written);
+        oc_mutex_unlock(tep->mutex);
+
+        oc_mutex_lock(g_sslContextMutex);
+        if (ret < 0)
+        {
+            RemoveSslPeer(tep);
+        }
+        ReleaseSslPeer(tep);
+        oc_mutex_unlock(g_sslContextMutex);
 
+        if (ret < 0)
+        {
+            return CA_STATUS_FAILED;
+        }
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        return CA_STATUS_OK;
     }
     else
     {
+        oc_mutex_unlock(tep->mutex);
         SslCacheMessage_t * msg = NewCacheMessage((uint8_t*) data, dataLen);
         if (NULL == msg || !u_arraylist_add(tep->cacheList, (void *) msg))
         {
@@ -2049,6 +2791,7 @@ static void SendCacheMessages(SslEndPoint_t * tep, CAResult_t errorCode)
                 unsigned char *dataBuf = (unsigned char *)msg->data;
                 size_t written = 0;
 
+                oc_mutex_lock(tep->mutex);
                 do
                 {
                     ret = mbedtls_ssl_write(&tep->ssl, dataBuf, msg->len - written);
@@ -2066,6 +2809,7 @@ static void SendCacheMessages(SslEndPoint_t * tep, CAResult_t errorCode)
                     dataBuf += ret;
                     written += ret;
                 } while (msg->len > written);
+                oc_mutex_unlock(tep->mutex);
             }
             else if (NULL != sendError)
             {
@@ -2105,6 +2849,25 @@ void CAsetSslHandshakeCallback(CAHandshakeErrorCallback tlsHandshakeCallback)
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s(%p)", __func__, tlsHandshakeCallback);
 }
 
+CAResult_t CAgetSslHandshakeStats(CASslHandshakeStats_t *stats)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    VERIFY_NON_NULL_RET(stats, NET_SSL_TAG, "stats is NULL", CA_STATUS_INVALID_PARAM);
+
+    oc_mutex_lock(g_sslContextMutex);
+    if (NULL == g_caSslContext)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Context is NULL");
+        oc_mutex_unlock(g_sslContextMutex);
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+    *stats = g_caSslContext->handshakeStats;
+    oc_mutex_unlock(g_sslContextMutex);
+
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+    return CA_STATUS_OK;
+}
+
 /* Read data from TLS connection
  */
 CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dataLen)
@@ -2135,6 +2898,7 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
             oc_mutex_unlock(g_sslContextMutex);
             return CA_STATUS_FAILED;
         }
+        RefreshSessionResumption();
         //Load allowed TLS suites from SVR DB
         if(!SetupCipher(config, sep->endpoint.adapter, NULL))
         {
@@ -2144,8 +2908,7 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
             return CA_STATUS_FAILED;
         }
 
-        ret = u_arraylist_add(g_caSslContext->peerList, (void *) peer);
-        if (!ret)
+        if (!AddPeerToList(peer))
         {
             OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
             DeleteSslEndPoint(peer);
@@ -2154,9 +2917,13 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
         }
     }
 
-    peer->recBuf.buff = data;
-    peer->recBuf.len = dataLen;
-    peer->recBuf.loaded = 0;
+    if (MBEDTLS_SSL_HANDSHAKE_OVER != peer->ssl.state)
+    {
+        // Established sessions get their input under the session mutex below.
+        peer->recBuf.buff = data;
+        peer->recBuf.len = dataLen;
+        peer->recBuf.loaded = 0;
+    }
 
     while (MBEDTLS_SSL_HANDSHAKE_OVER != peer->ssl.state)
     {
@@ -2175,6 +2942,10 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
                                                  sizeof(sep->endpoint.addr));
             ret = mbedtls_ssl_handshake_step(&peer->ssl);
         }
+        if (NULL != peer->ssl.handshake)
+        {
+            peer->resumed = (0 != peer->ssl.handshake->resume);
+        }
         uint32_t flags = mbedtls_ssl_get_verify_result(&peer->ssl);
         if (0 != flags)
         {
@@ -2227,10 +2998,20 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
 
         if (MBEDTLS_SSL_HANDSHAKE_OVER == peer->ssl.state)
         {
+            if (!VerifyResumedPeer(peer))
+            {
+                oc_mutex_unlock(g_sslContextMutex);
+                OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+                return CA_STATUS_FAILED;
+            }
+
+            RecordHandshakeTime(peer);
+
             CAResult_t result = notifySubscriber(peer, CA_STATUS_OK);
 
             if (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint)
             {
+                SaveClientSession(peer);
                 SendCacheMessages(peer, result);
             }
 
@@ -2367,7 +3148,28 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
 
     if (MBEDTLS_SSL_HANDSHAKE_OVER == peer->ssl.state)
     {
+        // Decrypt and deliver outside of the context lock, so that handshakes
+        // and traffic of other peers can proceed meanwhile.
+        CASecureEndpoint_t peerSep = peer->sep;
+        int adapterIndex = GetAdapterIndex(peer->sep.endpoint.adapter);
+        if (0 > adapterIndex)
+        {
+            OIC_LOG(ERROR, NET_SSL_TAG, "Unsuported adapter");
+            RemoveSslPeer(peer);
+            oc_mutex_unlock(g_sslContextMutex);
+            return CA_STATUS_FAILED;
+        }
+        SslCallbacks_t callbacks = g_caSslContext->adapterCallbacks[adapterIndex];
+        AcquireSslPeer(peer);
+        oc_mutex_unlock(g_sslContextMutex);
+
         uint8_t decryptBuffer[TLS_MSG_BUF_LEN] = {0};
+        bool closed = false;
+
+        oc_mutex_lock(peer->mutex);
+        peer->recBuf.buff = data;
+        peer->recBuf.len = dataLen;
+        peer->recBuf.loaded = 0;
         do
         {
             ret = mbedtls_ssl_read(&peer->ssl, decryptBuffer, TLS_MSG_BUF_LEN);
@@ -2379,35 +3181,36 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
              MBEDTLS_SSL_ALERT_LEVEL_FATAL == peer->ssl.in_msg[0] &&
              MBEDTLS_SSL_ALERT_MSG_CLOSE_NOTIFY == peer->ssl.in_msg[1]))
         {
-            OIC_LOG(INFO, NET_SSL_TAG, "Connection was closed gracefully");
-            RemovePeerFromList(&peer->sep.endpoint);
-            oc_mutex_unlock(g_sslContextMutex);
-            return CA_STATUS_OK;
+            closed = true;
         }
+        oc_mutex_unlock(peer->mutex);
 
-        int adapterIndex = GetAdapterIndex(peer->sep.endpoint.adapter);
-        if (adapterIndex >= 0)
+        CAResult_t result = CA_STATUS_OK;
+        if (closed)
         {
-            if (0 > ret)
-            {
-                OIC_LOG_V(ERROR, NET_SSL_TAG, "mbedtls_ssl_read returned -0x%x", -ret);
-                g_caSslContext->adapterCallbacks[adapterIndex].errorCallback(&peer->sep.endpoint, peer->recBuf.buff, peer->recBuf.len, CA_STATUS_FAILED);
-                RemovePeerFromList(&peer->sep.endpoint);
-                oc_mutex_unlock(g_sslContextMutex);
-                return CA_STATUS_FAILED;
-            }
-            else if (0 < ret)
-            {
-                g_caSslContext->adapterCallbacks[adapterIndex].recvCallback(&peer->sep, decryptBuffer, ret);
-            }
+            OIC_LOG(INFO, NET_SSL_TAG, "Connection was closed gracefully");
         }
-        else
+        else if (0 > ret)
         {
-            OIC_LOG(ERROR, NET_SSL_TAG, "Unsuported adapter");
-            RemovePeerFromList(&peer->sep.endpoint);
-            oc_mutex_unlock(g_sslContextMutex);
-            return CA_STATUS_FAILED;
+            OIC_LOG_V(ERROR, NET_SSL_TAG, "mbedtls_ssl_read returned -0x%x", -ret);
+            callbacks.errorCallback(&peerSep.endpoint, data, dataLen, CA_STATUS_FAILED);
+            result = CA_STATUS_FAILED;
+        }
+        else if (0 < ret)
+        {
+            callbacks.recvCallback(&peerSep, decryptBuffer, ret);
+        }
+
+        oc_mutex_lock(g_sslContextMutex);
+        if (closed || 0 > ret)
+        {
+            RemoveSslPeer(peer);
         }
+        ReleaseSslPeer(peer);
+        oc_mutex_unlock(g_sslContextMutex);
+
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        return result;
     }
 
     oc_mutex_unlock(g_sslContextMutex);
@@ -2559,6 +3362,9 @@ CAResult_t CAinitiateSslHandshake(const CAEndpoint_t *endpoint)
         }
     }
 
+    // Explicitly requested handshakes (e.g. ownership transfer) always run in full.
+    ForgetSavedSession(endpoint);
+
     if (NULL == InitiateTlsHandshake(endpoint))
     {
         OIC_LOG(ERROR, NET_SSL_TAG, "TLS handshake failed");
@@ -2699,6 +3505,13 @@ CAResult_t CAsslGenerateOwnerPsk(const CAEndpoint_t *endpoint,
         oc_mutex_unlock(g_sslContextMutex);
         return CA_STATUS_FAILED;
     }
+    if (tep->resumed)
+    {
+        // The randoms are only captured during a full handshake.
+        OIC_LOG(ERROR, NET_SSL_TAG, "Owner PSK cannot be derived from a resumed session");
+        oc_mutex_unlock(g_sslContextMutex);
+        return CA_STATUS_FAILED;
+    }
 
     // keyBlockLen set up according to OIC 1.1 Security Specification Section 7.3.2
     int macKeyLen = 0;
@@ -43,6 +43,7 @@
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "octhread.h"
+#include "ocmetrics.h"
 #include "experimental/logger.h"
 
 #define TAG "OIC_CA_BWT"
@@ -51,6 +52,8 @@
 #define BLOCK_NUMBER_IDX           4
 #define BLOCK_M_BIT_IDX            3
 #define PORT_LENGTH                2
+#define BLOCK_DATA_TABLE_SIZE      64
+#define BLOCK_STREAM_ID_MAX        32
 
 #define BLOCK_SIZE(arg) (1 << ((arg) + 4))
 
@@ -58,7 +61,193 @@
 static CABlockWiseContext_t g_context = { .sendThreadFunc = NULL,
                                           .receivedThreadFunc = NULL,
                                           .dataList = NULL,
-                                          .multicastDataList = NULL };
+                                          .multicastDataList = NULL,
+                                          .streamIdList = NULL };
+
+// hash index over g_context.dataList keyed by block data ID.
+// protected by g_context.blockDataListMutex.
+static CABlockData_t *g_blockDataTable[BLOCK_DATA_TABLE_SIZE];
+
+static size_t CAGetBlockDataTableIndex(const CABlockDataID_t *blockID)
+{
+    // FNV-1a over the ID bytes (token + address + port)
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < blockID->idLength; i++)
+    {
+        hash ^= blockID->id[i];
+        hash *= 16777619u;
+    }
+    return hash % BLOCK_DATA_TABLE_SIZE;
+}
+
+/**
+ * Find block data with the given ID. Caller must hold blockDataListMutex.
+ */
+static CABlockData_t *CAFindBlockData(const CABlockDataID_t *blockID)
+{
+    if (!blockID || !blockID->id)
+    {
+        return NULL;
+    }
+
+    CABlockData_t *currData = g_blockDataTable[CAGetBlockDataTableIndex(blockID)];
+    while (currData)
+    {
+        if (CABlockidMatches(currData, blockID))
+        {
+            return currData;
+        }
+        currData = currData->nextInTable;
+    }
+    return NULL;
+}
+
+static void CAAddBlockDataToTable(CABlockData_t *data)
+{
+    size_t index = CAGetBlockDataTableIndex(data->blockDataId);
+    data->nextInTable = g_blockDataTable[index];
+    g_blockDataTable[index] = data;
+}
+
+static void CARemoveBlockDataFromTable(const CABlockData_t *data)
+{
+    CABlockData_t **link = &g_blockDataTable[CAGetBlockDataTableIndex(data->blockDataId)];
+    while (*link)
+    {
+        if (*link == data)
+        {
+            *link = data->nextInTable;
+            return;
+        }
+        link = &(*link)->nextInTable;
+    }
+}
+
+/**
+ * Make sure the payload buffer of the block data can hold required bytes.
+ * The buffer grows geometrically so that reassembling a payload of unknown
+ * total size copies each byte a bounded number of times.
+ */
+static CAResult_t CAReserveBlockPayload(CABlockData_t *currData, size_t required)
+{
+    if (required <= currData->payloadCapacity)
+    {
+        return CA_STATUS_OK;
+    }
+
+    size_t capacity = 0;
+    if (currData->payloadLength >= required)
+    {
+        // total size is announced by the size option
+        capacity = currData->payloadLength;
+    }
+    else
+    {
+        capacity = currData->payloadCapacity ? currData->payloadCapacity
+                                             : (size_t) BLOCK_SIZE(CA_DEFAULT_BLOCK_SIZE);
+        while (capacity < required)
+        {
+            if (capacity > SIZE_MAX / 2)
+            {
+                capacity = required;
+                break;
+            }
+            capacity *= 2;
+        }
+    }
+
+    CAPayload_t newPayload = OICRealloc(currData->payload, capacity);
+    if (NULL == newPayload)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    currData->payload = newPayload;
+    currData->payloadCapacity = capacity;
+    return CA_STATUS_OK;
+}
+
+/**
+ * Remove the stream ID matching blockID. Caller must hold blockDataListMutex.
+ * @return true if the request asked for streamed delivery.
+ */
+static bool CATakeBlockStreamId(const CABlockDataID_t *blockID)
+{
+    size_t len = u_arraylist_length(g_context.streamIdList);
+    for (size_t i = 0; i < len; i++)
+    {
+        CABlockDataID_t *currId = (CABlockDataID_t *) u_arraylist_get(g_context.streamIdList, i);
+        if (currId && currId->idLength == blockID->idLength
+            && !memcmp(currId->id, blockID->id, currId->idLength))
+        {
+            u_arraylist_remove(g_context.streamIdList, i);
+            CADestroyBlockID(currId);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Pass a single block of a streamed response to the upper layer. The block keeps
+ * its Block2 option so that the receiver knows its position and whether it is the last.
+ */
+static CAResult_t CAReceiveStreamingBlock(const CAData_t *receivedData, coap_block_t block)
+{
+    VERIFY_NON_NULL(receivedData, TAG, "receivedData");
+
+    CAData_t *cloneData = CACloneCAData(receivedData);
+    if (!cloneData)
+    {
+        OIC_LOG(ERROR, TAG, "clone has failed");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    if (!cloneData->responseInfo || UINT8_MAX == cloneData->responseInfo->info.numOptions)
+    {
+        OIC_LOG(ERROR, TAG, "can't add block option");
+        CADestroyDataSet(cloneData);
+        return CA_STATUS_FAILED;
+    }
+
+    CAInfo_t *info = &cloneData->responseInfo->info;
+    CAHeaderOption_t *options = (CAHeaderOption_t *) OICRealloc(info->options,
+            (info->numOptions + 1) * sizeof(CAHeaderOption_t));
+    if (!options)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        CADestroyDataSet(cloneData);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    CAHeaderOption_t *blockOption = &options[info->numOptions];
+    memset(blockOption, 0, sizeof(CAHeaderOption_t));
+    blockOption->protocolID = CA_COAP_ID;
+    blockOption->optionID = COAP_OPTION_BLOCK2;
+    blockOption->optionLength = (uint16_t) coap_encode_var_bytes(
+            (unsigned char *) blockOption->optionData,
+            ((block.num << BLOCK_NUMBER_IDX) | (block.m << BLOCK_M_BIT_IDX) | block.szx));
+    info->options = options;
+    info->numOptions++;
+
+    if (block.m)
+    {
+        // intermediate blocks are acknowledged by the block-wise transfer itself
+        info->type = CA_MSG_NONCONFIRM;
+    }
+
+    if (g_context.receivedThreadFunc)
+    {
+        g_context.receivedThreadFunc(cloneData);
+    }
+    else
+    {
+        CADestroyDataSet(cloneData);
+    }
+
+    return CA_STATUS_OK;
+}
 
 static bool CACheckPayloadLength(const CAData_t *sendData)
 {
@@ -77,6 +266,19 @@ static bool CACheckPayloadLength(const CAData_t *sendData)
     return true;
 }
 
+/**
+ * Reads the number of ongoing block-wise transfers for the metrics registry.
+ */
+static int64_t CAReadBlockWiseSessions(void *ctx)
+{
+    (void)ctx;
+
+    oc_mutex_lock(g_context.blockDataListMutex);
+    size_t count = u_arraylist_length(g_context.dataList);
+    oc_mutex_unlock(g_context.blockDataListMutex);
+    return (int64_t)count;
+}
+
 CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
                                          CAReceiveThreadFunc receivedThreadFunc)
 {
@@ -103,6 +305,11 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
         g_context.multicastDataList = u_arraylist_create();
     }
 
+    if (!g_context.streamIdList)
+    {
+        g_context.streamIdList = u_arraylist_create();
+    }
+
     CAResult_t res = CAInitBlockWiseMutexVariables();
     if (CA_STATUS_OK != res)
     {
@@ -110,8 +317,14 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
         g_context.dataList = NULL;
         u_arraylist_free(&g_context.multicastDataList);
         g_context.multicastDataList = NULL;
+        u_arraylist_free(&g_context.streamIdList);
+        g_context.streamIdList = NULL;
         OIC_LOG(ERROR, TAG, "init has failed");
     }
+    else
+    {
+        oc_metrics_set_gauge_reader(OC_METRIC_BLOCKWISE_SESSIONS, CAReadBlockWiseSessions, NULL);
+    }
 
     return res;
 }
@@ -119,6 +332,7 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
 CAResult_t CATerminateBlockWiseTransfer()
 {
     OIC_LOG(DEBUG, TAG, "CATerminateBlockWiseTransfer");
+    oc_metrics_set_gauge_reader(OC_METRIC_BLOCKWISE_SESSIONS, NULL, NULL);
 
     if (g_context.dataList)
     {
@@ -126,6 +340,11 @@ CAResult_t CATerminateBlockWiseTransfer()
         u_arraylist_free(&g_context.dataList);
     }
 
+    if (g_context.streamIdList)
+    {
+        u_arraylist_free(&g_context.streamIdList);
+    }
+
     if (g_context.multicastDataList)
     {
         CARemoveAllBlockMulticastDataFromList();
@@ -823,6 +1042,7 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
         data->payload = NULL;
         data->payloadLength = 0;
         data->receivedPayloadLen = 0;
+        data->payloadCapacity = 0;
         data->block1.num = 0;
         data->block2.num = 0;
     }
@@ -835,6 +1055,13 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *re
     VERIFY_NON_NULL(blockID, TAG, "blockID");
     VERIFY_NON_NULL(receivedData, TAG, "receivedData");
 
+    CABlockData_t *blockData = CAGetBlockDataFromBlockDataList(blockID);
+    if (blockData && blockData->streaming && receivedData->responseInfo)
+    {
+        OIC_LOG(DEBUG, TAG, "last block has been delivered already");
+        return CA_STATUS_OK;
+    }
+
     // total block data have to notify to Application
     CAData_t *cloneData = CACloneCAData(receivedData);
     if (!cloneData)
@@ -1183,6 +1410,19 @@ CAResult_t CASetNextBlockOption2(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                 }
             }
 
+            if (data->streaming && CA_BLOCK_UNKNOWN == blockWiseStatus
+                && CA_REQUEST_ENTITY_INCOMPLETE != responseCode
+                && CA_REQUEST_ENTITY_TOO_LARGE != responseCode)
+            {
+                // pass the block to the application instead of reassembling it
+                res = CAReceiveStreamingBlock(receivedData, block);
+                if (CA_STATUS_OK != res)
+                {
+                    OIC_LOG(ERROR, TAG, "receive has failed");
+                    goto exit;
+                }
+            }
+
             if (0 == block.m && CA_BLOCK_UNKNOWN == blockWiseStatus) // Last block is received
             {
                 OIC_LOG(DEBUG, TAG, "M bit is 0");
@@ -2055,50 +2295,44 @@ CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *received
                 BLOCK_SIZE(currData->block2.szx) : BLOCK_SIZE(currData->block1.szx);
     }
 
+    if (currData->streaming && COAP_OPTION_BLOCK2 == blockType)
+    {
+        // streamed blocks are delivered one by one, only keep track of the length
+        currData->receivedPayloadLen += blockPayloadLen;
+        OIC_LOG(DEBUG, TAG, "OUT-UpdatePayloadData");
+        return CA_STATUS_OK;
+    }
+
     // memory allocation for the received block payload
     size_t prePayloadLen = currData->receivedPayloadLen;
     if (blockPayload)
     {
-        if (currData->payloadLength)
+        if (blockPayloadLen > SIZE_MAX - prePayloadLen)
         {
-            // in case the block message has the size option
-            // allocate the memory for the total payload
-            if (isSizeOption)
-            {
-                CAPayload_t prePayload = currData->payload;
-
-                OIC_LOG(DEBUG, TAG, "allocate memory for the total payload");
-                currData->payload = (CAPayload_t) OICCalloc(1, currData->payloadLength);
-                if (NULL == currData->payload)
-                {
-                    OIC_LOG(ERROR, TAG, "out of memory");
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy(currData->payload, prePayload, prePayloadLen);
-                OICFree(prePayload);
-            }
-
-            // update the total payload
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+            OIC_LOG(ERROR, TAG, "payload length overflow");
+            return CA_STATUS_FAILED;
         }
-        else
-        {
-            OIC_LOG(DEBUG, TAG, "allocate memory for the received block payload");
 
-            size_t totalPayloadLen = prePayloadLen + blockPayloadLen;
-            CAPayload_t newPayload = OICRealloc(currData->payload, totalPayloadLen);
-            if (NULL == newPayload)
-            {
-                OIC_LOG(ERROR, TAG, "out of memory");
-                return CA_MEMORY_ALLOC_FAILED;
-            }
+        size_t required = prePayloadLen + blockPayloadLen;
+        if (isSizeOption && currData->payloadLength > required)
+        {
+            // in case the block message has the size option
+            // allocate the memory for the total payload at once
+            OIC_LOG(DEBUG, TAG, "allocate memory for the total payload");
+            required = currData->payloadLength;
+        }
 
-            // update the total payload
-            memset(newPayload + prePayloadLen, 0, blockPayloadLen);
-            currData->payload = newPayload;
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+        // without the size option the buffer grows geometrically
+        // instead of being reallocated for every received block
+        CAResult_t res = CAReserveBlockPayload(currData, required);
+        if (CA_STATUS_OK != res)
+        {
+            return res;
         }
 
+        // update the total payload
+        memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+
         // update received payload length
         currData->receivedPayloadLen += blockPayloadLen;
 
@@ -2356,17 +2590,13 @@ CAResult_t CAUpdateBlockOptionType(const CABlockDataID_t *blockID, uint16_t bloc
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            currData->type = blockType;
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
-            return CA_STATUS_OK;
-        }
+        currData->type = blockType;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
+        return CA_STATUS_OK;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2381,16 +2611,13 @@ uint16_t CAGetBlockOptionType(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
-            return currData->type;
-        }
+        uint16_t type = currData->type;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
+        return type;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2404,15 +2631,12 @@ CAData_t *CAGetDataSetFromBlockDataList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData->sentData;
-        }
+        CAData_t *sentData = currData->sentData;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        return sentData;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2427,17 +2651,13 @@ CABlockData_t *CAUpdateDataSetFromBlockDataList(const CABlockDataID_t *blockID,
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            CADestroyDataSet(currData->sentData);
-            currData->sentData = CACloneCAData(sendData);
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
+        CADestroyDataSet(currData->sentData);
+        currData->sentData = CACloneCAData(sendData);
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        return currData;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2533,20 +2753,10 @@ CABlockData_t *CAGetBlockDataFromBlockDataList(const CABlockDataID_t *blockID)
     VERIFY_NON_NULL_RET(blockID, TAG, "blockID", NULL);
 
     oc_mutex_lock(g_context.blockDataListMutex);
-
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
-    {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
-    }
+    CABlockData_t *currData = CAFindBlockData(blockID);
     oc_mutex_unlock(g_context.blockDataListMutex);
 
-    return NULL;
+    return currData;
 }
 
 coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockType)
@@ -2556,23 +2766,20 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockTyp
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
+        if (COAP_OPTION_BLOCK2 == blockType)
         {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
-            if (COAP_OPTION_BLOCK2 == blockType)
-            {
-                return &currData->block2;
-            }
-            else if (COAP_OPTION_BLOCK1 == blockType)
-            {
-                return &currData->block1;
-            }
+            return &currData->block2;
         }
+        else if (COAP_OPTION_BLOCK1 == blockType)
+        {
+            return &currData->block1;
+        }
+        return NULL;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2589,17 +2796,14 @@ CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            *fullPayloadLen = currData->receivedPayloadLen;
-            OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
-            return currData->payload;
-        }
+        *fullPayloadLen = currData->receivedPayloadLen;
+        CAPayload_t payload = currData->payload;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
+        return payload;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2677,6 +2881,8 @@ CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
         oc_mutex_unlock(g_context.blockDataListMutex);
         return NULL;
     }
+    CAAddBlockDataToTable(data);
+    data->streaming = CATakeBlockStreamId(blockDataID);
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-CreateBlockData");
@@ -2690,34 +2896,68 @@ CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    // the request has been answered without block-wise transfer
+    CATakeBlockStreamId(blockID);
+
+    size_t index = 0;
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData && u_arraylist_get_index(g_context.dataList, currData, &index))
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, index);
+        if (!removedData)
         {
-            CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i);
-            if (!removedData)
-            {
-                OIC_LOG(ERROR, TAG, "data is NULL");
-                oc_mutex_unlock(g_context.blockDataListMutex);
-                return CA_STATUS_FAILED;
-            }
-
-            // destroy memory
-            CADestroyDataSet(removedData->sentData);
-            CADestroyBlockID(removedData->blockDataId);
-            OICFree(removedData->payload);
-            OICFree(removedData);
+            OIC_LOG(ERROR, TAG, "data is NULL");
             oc_mutex_unlock(g_context.blockDataListMutex);
-            return CA_STATUS_OK;
+            return CA_STATUS_FAILED;
         }
+        CARemoveBlockDataFromTable(removedData);
+
+        // destroy memory
+        CADestroyDataSet(removedData->sentData);
+        CADestroyBlockID(removedData->blockDataId);
+        OICFree(removedData->payload);
+        OICFree(removedData);
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     return CA_STATUS_OK;
 }
 
+CAResult_t CAAddBlockStreamId(const CAToken_t token, uint8_t tokenLength,
+                              const char* addr, uint16_t portNumber)
+{
+    OIC_LOG(DEBUG, TAG, "CAAddBlockStreamId");
+    VERIFY_NON_NULL(token, TAG, "token");
+    VERIFY_NON_NULL(addr, TAG, "addr");
+
+    CABlockDataID_t* blockDataID = CACreateBlockDatablockId(token, tokenLength, addr, portNumber);
+    if (NULL == blockDataID || blockDataID->idLength < 1)
+    {
+        OIC_LOG(ERROR, TAG, "blockId is null");
+        CADestroyBlockID(blockDataID);
+        return CA_STATUS_FAILED;
+    }
+
+    oc_mutex_lock(g_context.blockDataListMutex);
+
+    // IDs of requests which never got a response are dropped oldest first
+    if (u_arraylist_length(g_context.streamIdList) >= BLOCK_STREAM_ID_MAX)
+    {
+        CADestroyBlockID(u_arraylist_remove(g_context.streamIdList, 0));
+    }
+
+    bool res = u_arraylist_add(g_context.streamIdList, (void *) blockDataID);
+    oc_mutex_unlock(g_context.blockDataListMutex);
+
+    if (!res)
+    {
+        OIC_LOG(ERROR, TAG, "add has failed");
+        CADestroyBlockID(blockDataID);
+        return CA_STATUS_FAILED;
+    }
+    return CA_STATUS_OK;
+}
+
 CAResult_t CARemoveAllBlockDataFromList()
 {
     OIC_LOG(DEBUG, TAG, "CARemoveAllBlockDataFromList");
@@ -2740,6 +2980,13 @@ CAResult_t CARemoveAllBlockDataFromList()
             OICFree(removedData);
         }
     }
+    memset(g_blockDataTable, 0, sizeof(g_blockDataTable));
+
+    len = u_arraylist_length(g_context.streamIdList);
+    for (size_t i = len; i > 0; i--)
+    {
+        CADestroyBlockID(u_arraylist_remove(g_context.streamIdList, i - 1));
+    }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     return CA_STATUS_OK;
@@ -30,6 +30,9 @@
 #include "caprotocolmessage.h"
 #include "canetworkconfigurator.h"
 #include "cainterfacecontroller.h"
+#ifdef WITH_BWT
+#include "cablockwisetransfer.h"
+#endif
 #include "experimental/logger.h"
 
 #if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
@@ -137,6 +140,32 @@ void CARegisterHandler(CARequestCallback ReqHandler, CAResponseCallback RespHand
     CASetInterfaceCallbacks(ReqHandler, RespHandler, ErrorHandler);
 }
 
+CAResult_t CARegisterProcessEvent(oc_event event)
+{
+    OIC_LOG(DEBUG, TAG, "CARegisterProcessEvent");
+
+    if (!g_isInitialized)
+    {
+        OIC_LOG(DEBUG, TAG, "CA is not initialized");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    return CAAddProcessEvent(event);
+}
+
+void CAUnregisterProcessEvent(oc_event event)
+{
+    OIC_LOG(DEBUG, TAG, "CAUnregisterProcessEvent");
+
+    if (!g_isInitialized)
+    {
+        OIC_LOG(DEBUG, TAG, "CA is not initialized");
+        return;
+    }
+
+    CARemoveProcessEvent(event);
+}
+
 #if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
 
 CAResult_t CAGetSecureEndpointData(const CAEndpoint_t *peer, CASecureEndpoint_t *sep)
@@ -361,6 +390,31 @@ CAResult_t CASendRequest(const CAEndpoint_t *object, const CARequestInfo_t *requ
     }
 }
 
+CAResult_t CAEnableBlockwiseStreaming(const CAEndpoint_t *object,
+                                      const CARequestInfo_t *requestInfo)
+{
+    OIC_LOG(DEBUG, TAG, "CAEnableBlockwiseStreaming");
+
+    if (!g_isInitialized)
+    {
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    if (!object || !requestInfo || !requestInfo->info.token || requestInfo->isMulticast)
+    {
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+#ifdef WITH_BWT
+    if (CAIsSupportedBlockwiseTransfer(object->adapter))
+    {
+        return CAAddBlockStreamId(requestInfo->info.token, requestInfo->info.tokenLength,
+                                  object->addr, object->port);
+    }
+#endif
+    return CA_NOT_SUPPORTED;
+}
+
 CAResult_t CASendResponse(const CAEndpoint_t *object, const CAResponseInfo_t *responseInfo)
 {
     OIC_LOG(DEBUG, TAG, "CASendResponse");
@@ -36,6 +36,8 @@
 #include "cathreadpool.h"
 #include "caipadapter.h"
 #include "cainterface.h"
+#include "ocmetrics.h"
+#include "trace.h"
 #include <coap/utlist.h>
 
 #ifndef SINGLE_THREAD
@@ -296,9 +298,44 @@ CAResult_t CASetAdapterRAInfo(const CARAInfo_t *caraInfo)
 }
 #endif
 
+/**
+ * Counts a message in the metrics of its transport adapter.
+ *
+ * @param[in]   adapter     adapter that sent or received the message.
+ * @param[in]   sent        true for sent messages, false for received ones.
+ */
+static void CACountMessage(CATransportAdapter_t adapter, bool sent)
+{
+    oc_metric_counter counter;
+
+    switch (adapter)
+    {
+        case CA_ADAPTER_IP:
+            counter = sent ? OC_METRIC_MESSAGES_SENT_IP : OC_METRIC_MESSAGES_RECEIVED_IP;
+            break;
+        case CA_ADAPTER_TCP:
+            counter = sent ? OC_METRIC_MESSAGES_SENT_TCP : OC_METRIC_MESSAGES_RECEIVED_TCP;
+            break;
+        case CA_ADAPTER_GATT_BTLE:
+            counter = sent ? OC_METRIC_MESSAGES_SENT_GATT : OC_METRIC_MESSAGES_RECEIVED_GATT;
+            break;
+        case CA_ADAPTER_RFCOMM_BTEDR:
+            counter = sent ? OC_METRIC_MESSAGES_SENT_RFCOMM : OC_METRIC_MESSAGES_RECEIVED_RFCOMM;
+            break;
+        case CA_ADAPTER_NFC:
+            counter = sent ? OC_METRIC_MESSAGES_SENT_NFC : OC_METRIC_MESSAGES_RECEIVED_NFC;
+            break;
+        default:
+            return;
+    }
+    oc_metrics_increment(counter);
+}
+
 static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
                                      const void *data, size_t dataLen)
 {
+    CACountMessage(sep->endpoint.adapter, false);
+
     if (g_networkPacketReceivedCallback != NULL)
     {
         g_networkPacketReceivedCallback(sep, data, dataLen);
@@ -729,7 +766,9 @@ CAResult_t CASendUnicastData(const CAEndpoint_t *endpoint, const void *data, uin
         if (NULL != g_adapterHandler[index].sendData)
         {
             OIC_LOG(DEBUG, TAG, "unicast message to adapter");
+            OIC_TRACE_BEGIN(%s:CASendUnicastData:%d, TAG, connType);
             sentDataLen = g_adapterHandler[index].sendData(endpoint, data, length, dataType);
+            OIC_TRACE_END();
         }
 
         if ((0 > sentDataLen) || ((uint32_t)sentDataLen != length))
@@ -740,6 +779,10 @@ CAResult_t CASendUnicastData(const CAEndpoint_t *endpoint, const void *data, uin
             return CA_SEND_FAILED;
 #endif
         }
+        else
+        {
+            CACountMessage(connType, true);
+        }
 
     }
 
@@ -796,7 +839,9 @@ CAResult_t CASendMulticastData(const CAEndpoint_t *endpoint, const void *data, u
                 return CA_MEMORY_ALLOC_FAILED;
             }
             memcpy(payload, data, length);
+            OIC_TRACE_BEGIN(%s:CASendMulticastData:%d, TAG, connType);
             sentDataLen = g_adapterHandler[index].sendDataToAll(endpoint, payload, length, dataType);
+            OIC_TRACE_END();
             OICFree(payload);
         }
 
@@ -808,6 +853,10 @@ CAResult_t CASendMulticastData(const CAEndpoint_t *endpoint, const void *data, u
             return CA_SEND_FAILED;
 #endif
         }
+        else
+        {
+            CACountMessage(connType, true);
+        }
     }
 
     return CA_STATUS_OK;
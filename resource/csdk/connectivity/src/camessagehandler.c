@@ -38,6 +38,7 @@
 #include "cainterfacecontroller.h"
 #include "caretransmission.h"
 #include "oic_string.h"
+#include "ocmetrics.h"
 
 #ifdef WITH_BWT
 #include "cablockwisetransfer.h"
@@ -75,6 +76,26 @@ static CAResponseCallback g_responseHandler = NULL;
 static CAErrorCallback g_errorHandler = NULL;
 static CANetworkMonitorCallback g_nwMonitorHandler = NULL;
 
+#ifndef SINGLE_THREAD
+/** Maximum number of events registered with CAAddProcessEvent at the same time. */
+#define CA_MAX_PROCESS_EVENTS 4
+
+// signalled when received data is queued for CAHandleRequestResponseCallbacks.
+// guarded by the receive queue mutex.
+static oc_event g_processEvents[CA_MAX_PROCESS_EVENTS] = { NULL };
+
+static void CASignalProcessEvents(void)
+{
+    for (size_t i = 0; i < CA_MAX_PROCESS_EVENTS; i++)
+    {
+        if (g_processEvents[i])
+        {
+            oc_event_signal(g_processEvents[i]);
+        }
+    }
+}
+#endif
+
 static void CAErrorHandler(const CAEndpoint_t *endpoint,
                            const void *data, size_t dataLen,
                            CAResult_t result);
@@ -101,6 +122,17 @@ static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *endpoi
  */
 static void CALogPDUInfo(const CAData_t *data, const coap_pdu_t *pdu);
 
+#ifndef SINGLE_THREAD
+static void CAAddDataToReceiveQueue(CAData_t *data)
+{
+    CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+
+    oc_mutex_lock(g_receiveThread.threadMutex);
+    CASignalProcessEvents();
+    oc_mutex_unlock(g_receiveThread.threadMutex);
+}
+#endif
+
 #ifdef WITH_BWT
 void CAAddDataToSendThread(CAData_t *data)
 {
@@ -115,7 +147,7 @@ void CAAddDataToReceiveThread(CAData_t *data)
     VERIFY_NON_NULL_VOID(data, TAG, "data");
 
     // add thread
-    CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+    CAAddDataToReceiveQueue(data);
 }
 #endif
 
@@ -334,7 +366,7 @@ static void CATimeoutCallback(const CAEndpoint_t *endpoint, const void *pdu, uin
 #ifdef SINGLE_THREAD
     CAProcessReceivedData(cadata);
 #else
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAAddDataToReceiveQueue(cadata);
 #endif
 }
 
@@ -713,6 +745,7 @@ static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *ep, ui
         {
             OIC_LOG_V(INFO, TAG, "IPv%c duplicate message ignored",
                       familyFlags & CA_IPV6 ? '6' : '4');
+            oc_metrics_increment(OC_METRIC_DUPLICATES_DROPPED);
             ret = true;
             break;
         }
@@ -828,7 +861,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
         if (CA_NOT_SUPPORTED == res || CA_REQUEST_TIMEOUT == res)
         {
             OIC_LOG(DEBUG, TAG, "this message does not have block option");
-            CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+            CAAddDataToReceiveQueue(cadata);
         }
         else
         {
@@ -838,7 +871,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
     else
 #endif
     {
-        CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+        CAAddDataToReceiveQueue(cadata);
     }
 #endif // SINGLE_THREAD
 
@@ -866,6 +899,12 @@ void CAHandleRequestResponseCallbacks()
 
     u_queue_message_t *item = u_queue_get_element(g_receiveThread.dataQueue);
 
+    // Only one message is handled per call, so keep the event signalled while more wait.
+    if (u_queue_get_size(g_receiveThread.dataQueue) > 0)
+    {
+        CASignalProcessEvents();
+    }
+
     oc_mutex_unlock(g_receiveThread.threadMutex);
 
     if (NULL == item || NULL == item->msg)
@@ -1025,7 +1064,7 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
     {
         OIC_LOG(DEBUG, TAG,
                 "This is a loopback message. Transfer it to the receive queue directly");
-        CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+        CAAddDataToReceiveQueue(data);
         return CA_STATUS_OK;
     }
 #ifdef WITH_BWT
@@ -1063,11 +1102,98 @@ void CASetInterfaceCallbacks(CARequestCallback ReqHandler, CAResponseCallback Re
     g_errorHandler = errorHandler;
 }
 
+CAResult_t CAAddProcessEvent(oc_event event)
+{
+#ifndef SINGLE_THREAD
+    VERIFY_NON_NULL(event, TAG, "event");
+    if (NULL == g_receiveThread.threadMutex)
+    {
+        OIC_LOG(ERROR, TAG, "receive queue is not initialized");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    CAResult_t res = CA_MEMORY_ALLOC_FAILED;
+    oc_mutex_lock(g_receiveThread.threadMutex);
+    size_t freeSlot = CA_MAX_PROCESS_EVENTS;
+    for (size_t i = 0; i < CA_MAX_PROCESS_EVENTS; i++)
+    {
+        if (event == g_processEvents[i])
+        {
+            freeSlot = i;
+            break;
+        }
+        if ((NULL == g_processEvents[i]) && (CA_MAX_PROCESS_EVENTS == freeSlot))
+        {
+            freeSlot = i;
+        }
+    }
+    if (freeSlot < CA_MAX_PROCESS_EVENTS)
+    {
+        g_processEvents[freeSlot] = event;
+        if (u_queue_get_size(g_receiveThread.dataQueue) > 0)
+        {
+            oc_event_signal(event);
+        }
+        res = CA_STATUS_OK;
+    }
+    oc_mutex_unlock(g_receiveThread.threadMutex);
+
+    if (CA_STATUS_OK != res)
+    {
+        OIC_LOG(ERROR, TAG, "too many process events registered");
+    }
+    return res;
+#else
+    (void)event;
+    return CA_STATUS_OK;
+#endif
+}
+
+void CARemoveProcessEvent(oc_event event)
+{
+#ifndef SINGLE_THREAD
+    if ((NULL == event) || (NULL == g_receiveThread.threadMutex))
+    {
+        return;
+    }
+
+    oc_mutex_lock(g_receiveThread.threadMutex);
+    for (size_t i = 0; i < CA_MAX_PROCESS_EVENTS; i++)
+    {
+        if (event == g_processEvents[i])
+        {
+            g_processEvents[i] = NULL;
+        }
+    }
+    oc_mutex_unlock(g_receiveThread.threadMutex);
+#else
+    (void)event;
+#endif
+}
+
 void CASetNetworkMonitorCallback(CANetworkMonitorCallback nwMonitorHandler)
 {
     g_nwMonitorHandler = nwMonitorHandler;
 }
 
+#ifndef SINGLE_THREAD
+/**
+ * Reads the number of messages waiting in a queueing thread for the metrics registry.
+ *
+ * @param[in]   ctx     queueing thread.
+ * @return  number of queued messages.
+ */
+static int64_t CAReadQueueDepth(void *ctx)
+{
+    CAQueueingThread_t *thread = (CAQueueingThread_t *)ctx;
+
+    oc_mutex_lock(thread->threadMutex);
+    uint32_t size = u_queue_get_size(thread->dataQueue);
+    oc_mutex_unlock(thread->threadMutex);
+    return size;
+}
+#endif
+
 CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
 {
     CASetPacketReceivedCallback(CAReceivedPacketCallback);
@@ -1090,6 +1216,7 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
         OIC_LOG(ERROR, TAG, "Failed to Initialize send queue thread");
         return res;
     }
+    oc_metrics_set_gauge_reader(OC_METRIC_SEND_QUEUE_DEPTH, CAReadQueueDepth, &g_sendThread);
 
     // start send thread
     res = CAQueueingThreadStart(&g_sendThread);
@@ -1107,6 +1234,8 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
         OIC_LOG(ERROR, TAG, "Failed to Initialize receive queue thread");
         return res;
     }
+    oc_metrics_set_gauge_reader(OC_METRIC_RECEIVE_QUEUE_DEPTH, CAReadQueueDepth,
+                                &g_receiveThread);
 
 #ifndef SINGLE_HANDLE // This will be enabled when RI supports multi threading
     // start receive thread
@@ -1171,6 +1300,9 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
 void CATerminateMessageHandler()
 {
 #ifndef SINGLE_THREAD
+    oc_metrics_set_gauge_reader(OC_METRIC_SEND_QUEUE_DEPTH, NULL, NULL);
+    oc_metrics_set_gauge_reader(OC_METRIC_RECEIVE_QUEUE_DEPTH, NULL, NULL);
+
     // stop adapters
     CAStopAdapters();
 
@@ -1191,6 +1323,9 @@ void CATerminateMessageHandler()
     // delete thread data
     if (NULL != g_receiveThread.threadMutex)
     {
+        oc_mutex_lock(g_receiveThread.threadMutex);
+        memset(g_processEvents, 0, sizeof(g_processEvents));
+        oc_mutex_unlock(g_receiveThread.threadMutex);
 #ifndef SINGLE_HANDLE // This will be enabled when RI supports multi threading
         CAQueueingThreadStop(&g_receiveThread);
 #endif
@@ -1325,7 +1460,7 @@ void CAErrorHandler(const CAEndpoint_t *endpoint,
 
     cadata->errorInfo->result = result;
 
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAAddDataToReceiveQueue(cadata);
     coap_delete_pdu(pdu);
 #else
     (void)result;
@@ -1378,7 +1513,7 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
     cadata->errorInfo = errorInfo;
     cadata->dataType = CA_ERROR_DATA;
 
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAAddDataToReceiveQueue(cadata);
 #endif
     OIC_LOG(DEBUG, TAG, "CASendErrorInfo OUT");
 }
@@ -70,6 +70,7 @@
 #include "caprotocolmessage.h"
 #include "oic_malloc.h"
 #include "oic_time.h"
+#include "ocmetrics.h"
 #include "experimental/ocrandom.h"
 #include "experimental/logger.h"
 
@@ -206,6 +207,7 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
                           retData->messageId);
                 context->dataSendMethod(retData->endpoint, retData->pdu,
                                         retData->size, retData->dataType);
+                oc_metrics_increment(OC_METRIC_RETRANSMISSIONS);
             }
 
             // #3. increase the retransmission count and update timestamp.
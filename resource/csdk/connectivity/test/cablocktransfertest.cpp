@@ -764,3 +764,150 @@ TEST_F(CABlockTransferTests, CAUpdatePayloadToCADataWithResponse)
     CADestroyToken(tempToken);
     CADestroyEndpoint(tempRep);
 }
+
+TEST_F(CABlockTransferTests, CAUpdatePayloadDataWithoutSizeOption)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    coap_pdu_t *pdu = NULL;
+    coap_list_t *options = NULL;
+    coap_transport_t transport = COAP_UDP;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CAInfo_t requestData;
+    memset(&requestData, 0, sizeof(CAInfo_t));
+    requestData.token = tempToken;
+    requestData.tokenLength = CA_MAX_TOKEN_LEN;
+    requestData.type = CA_MSG_NONCONFIRM;
+
+    pdu = CAGeneratePDU(CA_GET, &requestData, tempRep, &options, &transport);
+
+    CAData_t *cadata = CACreateNewDataSet(pdu, tempRep);
+    EXPECT_TRUE(cadata != NULL);
+
+    CABlockData_t *currData = CACreateNewBlockData(cadata);
+    EXPECT_TRUE(currData != NULL);
+
+    if (currData)
+    {
+        uint8_t block[LARGE_PAYLOAD_LENGTH];
+        CARequestInfo_t requestInfo;
+        memset(&requestInfo, 0, sizeof(CARequestInfo_t));
+        requestInfo.method = CA_PUT;
+        requestInfo.info.payload = (CAPayload_t) block;
+        requestInfo.info.payloadSize = sizeof(block);
+
+        CAData_t blockData;
+        memset(&blockData, 0, sizeof(CAData_t));
+        blockData.type = SEND_TYPE_UNICAST;
+        blockData.remoteEndpoint = tempRep;
+        blockData.requestInfo = &requestInfo;
+        blockData.dataType = CA_REQUEST_DATA;
+
+        const size_t blockCount = 5;
+        for (size_t i = 0; i < blockCount; i++)
+        {
+            memset(block, 'a' + (int) i, sizeof(block));
+            EXPECT_EQ(CA_STATUS_OK, CAUpdatePayloadData(currData, &blockData, CA_BLOCK_UNKNOWN,
+                                                        false, COAP_OPTION_BLOCK1));
+        }
+
+        size_t fullPayloadLen = 0;
+        CAPayload_t payload = CAGetPayloadFromBlockDataList(currData->blockDataId,
+                                                            &fullPayloadLen);
+        ASSERT_TRUE(payload != NULL);
+        EXPECT_EQ(blockCount * sizeof(block), fullPayloadLen);
+        EXPECT_LE(fullPayloadLen, currData->payloadCapacity);
+        for (size_t i = 0; i < blockCount; i++)
+        {
+            EXPECT_EQ('a' + (int) i, payload[i * sizeof(block)]);
+            EXPECT_EQ('a' + (int) i, payload[(i + 1) * sizeof(block) - 1]);
+        }
+
+        EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(currData->blockDataId));
+    }
+
+    CADestroyDataSet(cadata);
+    coap_delete_list(options);
+    coap_delete_pdu(pdu);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
+TEST_F(CABlockTransferTests, CAStreamingBlockDataTest)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    coap_pdu_t *pdu = NULL;
+    coap_list_t *options = NULL;
+    coap_transport_t transport = COAP_UDP;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CAInfo_t requestData;
+    memset(&requestData, 0, sizeof(CAInfo_t));
+    requestData.token = tempToken;
+    requestData.tokenLength = CA_MAX_TOKEN_LEN;
+    requestData.type = CA_MSG_NONCONFIRM;
+
+    pdu = CAGeneratePDU(CA_GET, &requestData, tempRep, &options, &transport);
+
+    CAData_t *cadata = CACreateNewDataSet(pdu, tempRep);
+    EXPECT_TRUE(cadata != NULL);
+
+    EXPECT_EQ(CA_STATUS_OK, CAAddBlockStreamId(tempToken, CA_MAX_TOKEN_LEN,
+                                               tempRep->addr, tempRep->port));
+
+    CABlockData_t *currData = CACreateNewBlockData(cadata);
+    EXPECT_TRUE(currData != NULL);
+
+    if (currData)
+    {
+        EXPECT_TRUE(currData->streaming);
+
+        uint8_t block[LARGE_PAYLOAD_LENGTH];
+        memset(block, '1', sizeof(block));
+        CAResponseInfo_t responseInfo;
+        memset(&responseInfo, 0, sizeof(CAResponseInfo_t));
+        responseInfo.result = CA_CONTENT;
+        responseInfo.info.payload = (CAPayload_t) block;
+        responseInfo.info.payloadSize = sizeof(block);
+
+        CAData_t blockData;
+        memset(&blockData, 0, sizeof(CAData_t));
+        blockData.type = SEND_TYPE_UNICAST;
+        blockData.remoteEndpoint = tempRep;
+        blockData.responseInfo = &responseInfo;
+        blockData.dataType = CA_RESPONSE_DATA;
+
+        // streamed blocks are counted but not stored
+        EXPECT_EQ(CA_STATUS_OK, CAUpdatePayloadData(currData, &blockData, CA_BLOCK_UNKNOWN,
+                                                    false, COAP_OPTION_BLOCK2));
+        EXPECT_EQ(sizeof(block), currData->receivedPayloadLen);
+        EXPECT_TRUE(currData->payload == NULL);
+
+        EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(currData->blockDataId));
+    }
+
+    // the stream ID has been consumed by the block data
+    CABlockData_t *otherData = CACreateNewBlockData(cadata);
+    EXPECT_TRUE(otherData != NULL);
+    if (otherData)
+    {
+        EXPECT_FALSE(otherData->streaming);
+        EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(otherData->blockDataId));
+    }
+
+    CADestroyDataSet(cadata);
+    coap_delete_list(options);
+    coap_delete_pdu(pdu);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
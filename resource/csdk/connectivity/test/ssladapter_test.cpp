@@ -26,6 +26,9 @@
 #include <cinttypes>
 #include "iotivity_config.h"
 #include <gtest/gtest.h>
+#include <deque>
+#include <string>
+#include <vector>
 #include "time.h"
 #include "octypes.h"
 #ifdef HAVE_WINSOCK2_H
@@ -1858,14 +1861,14 @@ TEST(TLSAdapter, Test_2)
  * *************************/
 
 unsigned char predictedClientHello[] = {
-    0x16, 0x03, 0x03, 0x00, 0x71, 0x01, 0x00, 0x00, 0x6d, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x34,
+    0x16, 0x03, 0x03, 0x00, 0x75, 0x01, 0x00, 0x00, 0x71, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x34,
     0x1c, 0x45, 0xfa, 0xbf, 0x39, 0xe5, 0xbf, 0x52, 0x20, 0x4f, 0x8f, 0xf5, 0x6b, 0x89, 0xb0, 0xbb,
     0x3a, 0x5e, 0x13, 0xb4, 0x94, 0x73, 0xee, 0xf4, 0x98, 0x48, 0x4a, 0x00, 0x00, 0x14, 0xc0, 0xac,
     0x00, 0x3d, 0x00, 0x9c, 0xc0, 0x2b, 0xc0, 0xae, 0xc0, 0x23, 0xc0, 0x24, 0xc0, 0x2c, 0xc0, 0x27,
-    0x00, 0xff, 0x01, 0x00, 0x00, 0x30, 0x00, 0x0d, 0x00, 0x16, 0x00, 0x14, 0x06, 0x03, 0x06, 0x01,
+    0x00, 0xff, 0x01, 0x00, 0x00, 0x34, 0x00, 0x0d, 0x00, 0x16, 0x00, 0x14, 0x06, 0x03, 0x06, 0x01,
     0x05, 0x03, 0x05, 0x01, 0x04, 0x03, 0x04, 0x01, 0x03, 0x03, 0x03, 0x01, 0x02, 0x03, 0x02, 0x01,
     0x00, 0x0a, 0x00, 0x04, 0x00, 0x02, 0x00, 0x17, 0x00, 0x0b, 0x00, 0x02, 0x01, 0x00, 0x00, 0x16,
-    0x00, 0x00, 0x00, 0x17, 0x00, 0x00
+    0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00, 0x23, 0x00, 0x00
 };
 static unsigned char controlBuf[sizeof(predictedClientHello)];
 static size_t controlBufLen = 0;
@@ -3041,6 +3044,49 @@ TEST(TLSAdapter, Test_ParseChain)
     EXPECT_EQ(0, errNum);
 }
 
+static int g_pkixInfoCallCount = 0;
+
+static void countingInfoCallback(PkiInfo_t * inf)
+{
+    g_pkixInfoCallCount++;
+    infoCallback_that_loads_x509(inf);
+}
+
+TEST(TLSAdapter, Test_PkixCache)
+{
+    g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
+    ASSERT_TRUE(g_caSslContext != NULL);
+    InitConfig(&g_caSslContext->clientTlsConf, MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_IS_CLIENT);
+    InitConfig(&g_caSslContext->serverTlsConf, MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_IS_SERVER);
+    mbedtls_x509_crt_init(&g_caSslContext->ca);
+    mbedtls_x509_crt_init(&g_caSslContext->crt);
+    mbedtls_pk_init(&g_caSslContext->pkey);
+    mbedtls_x509_crl_init(&g_caSslContext->crl);
+    g_getPkixInfoCallback = countingInfoCallback;
+    g_pkixInfoCallCount = 0;
+
+    // Credentials are parsed once and reused by later handshakes.
+    EXPECT_EQ(0, InitPKIX(CA_ADAPTER_TCP));
+    EXPECT_EQ(0, InitPKIX(CA_ADAPTER_TCP));
+    EXPECT_EQ(1, g_pkixInfoCallCount);
+
+    // A credential change makes the next handshake parse them again.
+    CAnotifyCredentialsChanged();
+    EXPECT_EQ(0, InitPKIX(CA_ADAPTER_TCP));
+    EXPECT_EQ(0, InitPKIX(CA_ADAPTER_TCP));
+    EXPECT_EQ(2, g_pkixInfoCallCount);
+
+    mbedtls_x509_crt_free(&g_caSslContext->ca);
+    mbedtls_x509_crt_free(&g_caSslContext->crt);
+    mbedtls_pk_free(&g_caSslContext->pkey);
+    mbedtls_x509_crl_free(&g_caSslContext->crl);
+    mbedtls_ssl_config_free(&g_caSslContext->clientTlsConf);
+    mbedtls_ssl_config_free(&g_caSslContext->serverTlsConf);
+    OICFree(g_caSslContext);
+    g_caSslContext = NULL;
+    g_getPkixInfoCallback = NULL;
+}
+
 TEST(TLSAdapter, TestCertsValid)
 {
     mbedtls_x509_crt cert;
@@ -3055,3 +3101,291 @@ TEST(TLSAdapter, TestCertsValid)
     EXPECT_EQ(0, ret) << "Failed to parse CA cert";
     mbedtls_x509_crt_free(&cert);
 }
+
+TEST(TLSAdapter, Test_PeerTable)
+{
+    g_sslContextMutex = oc_mutex_new_recursive();
+    oc_mutex_lock(g_sslContextMutex);
+    g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
+    g_caSslContext->peerList = u_arraylist_create();
+
+    CAEndpoint_t endpoints[3];
+    memset(endpoints, 0, sizeof(endpoints));
+    for (size_t i = 0; i < 3; i++)
+    {
+        endpoints[i].adapter = CA_ADAPTER_IP;
+        endpoints[i].port = (uint16_t)(5683 + i);
+        snprintf(endpoints[i].addr, sizeof(endpoints[i].addr), "192.168.0.%u", (unsigned)(i + 1));
+
+        SslEndPoint_t *tep = (SslEndPoint_t *)OICCalloc(1, sizeof(SslEndPoint_t));
+        ASSERT_TRUE(NULL != tep);
+        tep->sep.endpoint = endpoints[i];
+        tep->refCount = 1;
+        tep->mutex = oc_mutex_new();
+        ASSERT_TRUE(NULL != tep->mutex);
+        EXPECT_TRUE(AddPeerToList(tep));
+    }
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        SslEndPoint_t *tep = GetSslPeer(&endpoints[i]);
+        ASSERT_TRUE(NULL != tep);
+        EXPECT_EQ(endpoints[i].port, tep->sep.endpoint.port);
+    }
+
+    CAEndpoint_t otherPort = endpoints[1];
+    otherPort.port = 1;
+    EXPECT_TRUE(NULL == GetSslPeer(&otherPort));
+
+    RemovePeerFromList(&endpoints[1]);
+    EXPECT_TRUE(NULL == GetSslPeer(&endpoints[1]));
+    EXPECT_TRUE(NULL != GetSslPeer(&endpoints[0]));
+    EXPECT_TRUE(NULL != GetSslPeer(&endpoints[2]));
+
+    DeletePeerList();
+    OICFree(g_caSslContext);
+    g_caSslContext = NULL;
+    oc_mutex_unlock(g_sslContextMutex);
+    oc_mutex_free(g_sslContextMutex);
+    g_sslContextMutex = NULL;
+}
+
+/* **************************
+ *
+ *
+ * Session resumption tests
+ *
+ * A client and a server session of the adapter talk to each other through
+ * in-memory queues instead of sockets.
+ *
+ * *************************/
+
+static CAEndpoint_t g_loopServerAddr;
+static CAEndpoint_t g_loopClientAddr;
+static std::deque< std::vector<uint8_t> > g_toServer;
+static std::deque< std::vector<uint8_t> > g_toClient;
+static std::string g_loopReceived;
+static bool g_rejectPeerCN = false;
+
+static ssize_t LoopbackSendCB(CAEndpoint_t *endpoint, const void *buf, size_t buflen)
+{
+    // The client session addresses the server and the server session the client
+    std::deque< std::vector<uint8_t> > &queue =
+        (endpoint->port == g_loopServerAddr.port) ? g_toServer : g_toClient;
+    queue.push_back(std::vector<uint8_t>((const uint8_t *)buf, (const uint8_t *)buf + buflen));
+    return (ssize_t)buflen;
+}
+
+static void LoopbackReceivedCB(const CASecureEndpoint_t *, const void *data, size_t dataLength)
+{
+    g_loopReceived.append((const char *)data, dataLength);
+}
+
+static void LoopbackErrorCB(const CAEndpoint_t *, const void *, size_t, CAResult_t)
+{
+}
+
+static CAResult_t LoopbackPeerCNVerify(const unsigned char *, size_t)
+{
+    return g_rejectPeerCN ? CA_STATUS_FAILED : CA_STATUS_OK;
+}
+
+static void StartLoopbackAdapter()
+{
+    memset(&g_loopServerAddr, 0, sizeof(g_loopServerAddr));
+    g_loopServerAddr.adapter = CA_ADAPTER_TCP;
+    g_loopServerAddr.flags = CA_SECURE;
+    g_loopServerAddr.port = 4434;
+    snprintf(g_loopServerAddr.addr, sizeof(g_loopServerAddr.addr), "127.0.0.1");
+    g_loopClientAddr = g_loopServerAddr;
+    g_loopClientAddr.port = 4435;
+    g_toServer.clear();
+    g_toClient.clear();
+    g_loopReceived.clear();
+    g_rejectPeerCN = false;
+
+    ASSERT_EQ(CA_STATUS_OK, CAinitSslAdapter());
+    CAsetSslAdapterCallbacks(LoopbackReceivedCB, LoopbackSendCB, LoopbackErrorCB, CA_ADAPTER_TCP);
+    CAsetPkixInfoCallback(infoCallback_that_loads_x509);
+    CAsetCredentialTypesCallback(clutch);
+    CAsetPskCredentialsCallback(GetDtlsPskCredentials);
+    CAsetPeerCNVerifyCallback(LoopbackPeerCNVerify);
+    CAsetTlsCipherSuite(MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CCM);
+}
+
+static void StopLoopbackAdapter()
+{
+    CAsetPeerCNVerifyCallback(NULL);
+    CAdeinitSslAdapter();
+    g_toServer.clear();
+    g_toClient.clear();
+}
+
+/**
+ * Passes the queued records to the other side until both are idle.
+ */
+static void PumpLoopback()
+{
+    for (int i = 0; i < 100 && !(g_toServer.empty() && g_toClient.empty()); i++)
+    {
+        bool toServer = !g_toServer.empty();
+        std::deque< std::vector<uint8_t> > &queue = toServer ? g_toServer : g_toClient;
+        std::vector<uint8_t> record = queue.front();
+        queue.pop_front();
+
+        CASecureEndpoint_t sep;
+        memset(&sep, 0, sizeof(sep));
+        sep.endpoint = toServer ? g_loopClientAddr : g_loopServerAddr;
+        CAdecryptSsl(&sep, record.data(), record.size());
+    }
+}
+
+/**
+ * Sends a message from the client to the server, connecting if needed.
+ *
+ * @return  true if the server received the message
+ */
+static bool SendThroughLoopback(const char *message)
+{
+    g_loopReceived.clear();
+    if (CA_STATUS_OK != CAencryptSsl(&g_loopServerAddr, message, strlen(message)))
+    {
+        return false;
+    }
+    PumpLoopback();
+    return g_loopReceived == message;
+}
+
+/**
+ * Drops both sessions the way a lost connection does, without the explicit
+ * close that makes the client forget its saved session.
+ */
+static void DropLoopbackConnection()
+{
+    oc_mutex_lock(g_sslContextMutex);
+    RemovePeerFromList(&g_loopServerAddr);
+    RemovePeerFromList(&g_loopClientAddr);
+    oc_mutex_unlock(g_sslContextMutex);
+}
+
+static bool HasSavedSession()
+{
+    oc_mutex_lock(g_sslContextMutex);
+    bool saved = (NULL != GetSavedSession(&g_loopServerAddr));
+    oc_mutex_unlock(g_sslContextMutex);
+    return saved;
+}
+
+#ifdef HAVE_WINSOCK2_H
+TEST(TLSAdapter, DISABLED_Test_SessionResumption)
+#else
+TEST(TLSAdapter, Test_SessionResumption)
+#endif
+{
+    StartLoopbackAdapter();
+
+    // The first connection runs a full handshake and saves the session.
+    EXPECT_TRUE(SendThroughLoopback("first"));
+    EXPECT_TRUE(HasSavedSession());
+
+    CASslHandshakeStats_t stats;
+    EXPECT_EQ(CA_STATUS_OK, CAgetSslHandshakeStats(&stats));
+    EXPECT_EQ(2u, stats.fullHandshakes);
+    EXPECT_EQ(0u, stats.resumedHandshakes);
+
+    // The next connection resumes it, on both sides.
+    DropLoopbackConnection();
+    EXPECT_TRUE(SendThroughLoopback("second"));
+    oc_mutex_lock(g_sslContextMutex);
+    SslEndPoint_t *client = GetSslPeer(&g_loopServerAddr);
+    EXPECT_TRUE(NULL != client && client->resumed);
+    oc_mutex_unlock(g_sslContextMutex);
+
+    EXPECT_EQ(CA_STATUS_OK, CAgetSslHandshakeStats(&stats));
+    EXPECT_EQ(2u, stats.fullHandshakes);
+    EXPECT_EQ(2u, stats.resumedHandshakes);
+
+    // A resumed peer goes through the CN check too, and is dropped with its
+    // saved session when that fails.
+    DropLoopbackConnection();
+    g_rejectPeerCN = true;
+    EXPECT_FALSE(SendThroughLoopback("third"));
+    EXPECT_FALSE(HasSavedSession());
+
+    StopLoopbackAdapter();
+}
+
+#ifdef HAVE_WINSOCK2_H
+TEST(TLSAdapter, DISABLED_Test_SessionFlushOnCredentialChange)
+#else
+TEST(TLSAdapter, Test_SessionFlushOnCredentialChange)
+#endif
+{
+    StartLoopbackAdapter();
+
+    EXPECT_TRUE(SendThroughLoopback("first"));
+    EXPECT_TRUE(HasSavedSession());
+
+    // The cached sessions are dropped at the next handshake after a change.
+    CAnotifyCredentialsChanged();
+    DropLoopbackConnection();
+    EXPECT_TRUE(SendThroughLoopback("second"));
+
+    CASslHandshakeStats_t stats;
+    EXPECT_EQ(CA_STATUS_OK, CAgetSslHandshakeStats(&stats));
+    EXPECT_EQ(4u, stats.fullHandshakes);
+    EXPECT_EQ(0u, stats.resumedHandshakes);
+
+    // The session of the new handshake is saved and used again.
+    EXPECT_TRUE(HasSavedSession());
+    DropLoopbackConnection();
+    EXPECT_TRUE(SendThroughLoopback("third"));
+    EXPECT_EQ(CA_STATUS_OK, CAgetSslHandshakeStats(&stats));
+    EXPECT_EQ(2u, stats.resumedHandshakes);
+
+    StopLoopbackAdapter();
+}
+
+#ifdef HAVE_WINSOCK2_H
+TEST(TLSAdapter, DISABLED_Test_HandshakeStats)
+#else
+TEST(TLSAdapter, Test_HandshakeStats)
+#endif
+{
+    CASslHandshakeStats_t stats;
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CAgetSslHandshakeStats(NULL));
+
+    StartLoopbackAdapter();
+
+    memset(&stats, 0xFF, sizeof(stats));
+    EXPECT_EQ(CA_STATUS_OK, CAgetSslHandshakeStats(&stats));
+    EXPECT_EQ(0u, stats.fullHandshakes);
+    EXPECT_EQ(0u, stats.resumedHandshakes);
+    EXPECT_EQ(0u, stats.failedHandshakes);
+    EXPECT_EQ(0u, stats.maxHandshakeTime);
+
+    EXPECT_TRUE(SendThroughLoopback("first"));
+    DropLoopbackConnection();
+    EXPECT_TRUE(SendThroughLoopback("second"));
+
+    EXPECT_EQ(CA_STATUS_OK, CAgetSslHandshakeStats(&stats));
+    EXPECT_EQ(2u, stats.fullHandshakes);
+    EXPECT_EQ(2u, stats.resumedHandshakes);
+    EXPECT_EQ(0u, stats.failedHandshakes);
+    EXPECT_LE(stats.fullHandshakeTime / stats.fullHandshakes, stats.maxHandshakeTime);
+    EXPECT_LE(stats.resumedHandshakeTime / stats.resumedHandshakes, stats.maxHandshakeTime);
+
+    // An explicitly requested handshake runs in full even with a saved session.
+    DropLoopbackConnection();
+    EXPECT_TRUE(HasSavedSession());
+    EXPECT_EQ(CA_STATUS_OK, CAinitiateSslHandshake(&g_loopServerAddr));
+    PumpLoopback();
+    EXPECT_EQ(CA_STATUS_OK, CAgetSslHandshakeStats(&stats));
+    EXPECT_EQ(4u, stats.fullHandshakes);
+    EXPECT_EQ(2u, stats.resumedHandshakes);
+
+    StopLoopbackAdapter();
+
+    // The statistics go away with the adapter.
+    EXPECT_EQ(CA_STATUS_NOT_INITIALIZED, CAgetSslHandshakeStats(&stats));
+}
@@ -77,6 +77,9 @@ extern "C" {
 /** KeepAlive URI.*/
 #define OC_RSRVD_KEEPALIVE_URI                "/oic/ping"
 
+/** Stack statistics URI.*/
+#define OC_RSRVD_STATISTICS_URI               "/iotivity/stats"
+
 /** Presence */
 
 /** Presence URI through which the OIC devices advertise their presence.*/
@@ -174,6 +177,9 @@ extern "C" {
 /** To represent content type with MQ Topic.*/
 #define OC_RSRVD_RESOURCE_TYPE_MQ_TOPIC  "oic.wk.ps.topic"
 
+/** To represent resource type with stack statistics.*/
+#define OC_RSRVD_RESOURCE_TYPE_STATISTICS "x.org.iotivity.stats"
+
 /** To represent resource type with introspection.*/
 #define OC_RSRVD_RESOURCE_TYPE_INTROSPECTION "oic.wk.introspection"
 
@@ -1797,6 +1803,16 @@ typedef OCStackApplicationResult (* OCClientResponseHandler)(void *context, OCDo
  */
 typedef void (* OCClientContextDeleter)(void *context);
 
+/**
+ * Client applications implement this callback to consume a block-wise response one block
+ * at a time (see ::OCDoStreamingRequest). The blocks are passed in order; chunk holds the
+ * raw encoded payload bytes of the block, which is not a complete payload on its own.
+ * Returning ::OC_STACK_DELETE_TRANSACTION stops delivery for this request.
+ */
+typedef OCStackApplicationResult (* OCClientResponseChunkHandler)(void *context,
+    OCDoHandle handle, OCClientResponse * clientResponse, const uint8_t *chunk,
+    size_t chunkSize, size_t offset, bool isLast);
+
 /**
  * This info is passed from application to OC Stack when initiating a request to Server.
  */
@@ -1879,6 +1895,65 @@ typedef OCEntityHandlerResult (*OCEntityHandler)
 typedef OCEntityHandlerResult (*OCDeviceEntityHandler)
 (OCEntityHandlerFlag flag, OCEntityHandlerRequest * entityHandlerRequest, char* uri, void* callbackParam);
 
+/**
+ * Transports counted separately in ::OCStackStatistics.
+ */
+typedef enum
+{
+    OC_STATISTICS_ADAPTER_IP = 0,
+    OC_STATISTICS_ADAPTER_TCP,
+    OC_STATISTICS_ADAPTER_GATT_BTLE,
+    OC_STATISTICS_ADAPTER_RFCOMM_BTEDR,
+    OC_STATISTICS_ADAPTER_NFC,
+    OC_STATISTICS_ADAPTER_COUNT
+} OCStatisticsAdapter;
+
+/**
+ * Summary of a latency distribution, in microseconds.
+ * Percentiles are accurate to within 1/8 of their value.
+ */
+typedef struct
+{
+    uint64_t count;
+    uint64_t mean;
+    uint64_t max;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+} OCLatencyStatistics;
+
+/**
+ * Counters and gauges of the stack since it was started, as returned by
+ * OCGetStackStatistics().
+ */
+typedef struct
+{
+    /** Messages handed to each transport, indexed by ::OCStatisticsAdapter. */
+    uint64_t messagesSent[OC_STATISTICS_ADAPTER_COUNT];
+    /** Messages received from each transport, indexed by ::OCStatisticsAdapter. */
+    uint64_t messagesReceived[OC_STATISTICS_ADAPTER_COUNT];
+    /** Confirmable messages sent again after a timeout. */
+    uint64_t retransmissions;
+    /** Messages dropped as duplicates received over another IP family. */
+    uint64_t duplicatesDropped;
+    /** DTLS/TLS handshakes started and completed. */
+    uint64_t handshakesStarted;
+    uint64_t handshakesCompleted;
+    /** Messages waiting in the send and receive queues. */
+    int64_t sendQueueDepth;
+    int64_t receiveQueueDepth;
+    /** Registered observers of local resources. */
+    int64_t observers;
+    /** Client callbacks waiting for responses. */
+    int64_t clientCallbacks;
+    /** Block-wise transfers in progress. */
+    int64_t blockwiseSessions;
+    /** Time spent in entity handlers. The count is the number of requests handled. */
+    OCLatencyStatistics entityHandlerLatency;
+    /** Duration of completed DTLS/TLS handshakes. */
+    OCLatencyStatistics handshakeLatency;
+} OCStackStatistics;
+
 #if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
 /**
  * Callback function definition for Change in TrustCertChain
@@ -155,6 +155,53 @@ void OCLogBuffer(int level, const char* tag, const uint8_t* buffer, size_t buffe
      */
     void OCLogShutdown();
 
+    /**
+     * Start writing log messages from a background thread. Log calls then only copy
+     * the message and its arguments into a per-thread ring buffer, which the background
+     * thread formats and writes in time order. Messages logged while a thread's ring is
+     * full are dropped and counted. Only supported where pthreads are available.
+     *
+     * @param ringSize - size in bytes of the ring of each thread that logs, rounded up to
+     *                   a power of two. 0 selects the default of 64 KB.
+     *
+     * @return true if asynchronous logging is running, false if it is not supported or the
+     *         thread could not be started.
+     */
+    bool OCLogStartAsync(size_t ringSize);
+
+    /**
+     * Stop asynchronous logging, after writing the messages already queued.
+     * Called by OCLogShutdown().
+     */
+    void OCLogStopAsync();
+
+    /**
+     * Get the number of messages dropped because a ring buffer was full.
+     *
+     * @return total number of messages dropped since the process started.
+     */
+    uint64_t OCLogGetDroppedCount();
+
+    /**
+     * Set the log level of one module, overriding the level set by OCSetLogLevel() for
+     * messages logged with that tag. Can be called at any time, from any thread.
+     * Messages below OC_LOG_LEVEL are compiled out and can't be enabled this way.
+     *
+     * @param tag   - Module name, shorter than 32 characters.
+     * @param level - DEBUG, INFO, WARNING, ERROR, FATAL
+     *
+     * @return true on success, false if the tag is too long, 32 tags already have a level,
+     *         or per-tag levels are not supported.
+     */
+    bool OCSetLogLevelForTag(const char *tag, LogLevel level);
+
+    /**
+     * Remove the log level set for a module by OCSetLogLevelForTag().
+     *
+     * @param tag   - Module name
+     */
+    void OCClearLogLevelForTag(const char *tag);
+
     /**
      * Output a variable argument list log string with the specified priority level.
      * Only defined for Linux and Android
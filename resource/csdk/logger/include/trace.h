@@ -22,6 +22,7 @@
 #define TRACE_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __ANDROID__
 #include "experimental/logger.h"
@@ -37,7 +38,13 @@ extern "C"
 {
 #endif
 
-#ifdef __ANDROID__
+#if defined(__ANDROID__) || defined(OIC_SUPPORT_LINUX_TRACE)
+/*
+ * Android, and Linux builds with OIC_SUPPORT_LINUX_TRACE, write atrace style
+ * "B|pid|name" and "E" records to the ftrace trace_marker file. They can be captured
+ * with systrace, trace-cmd or "perf record -e ftrace:print", and grouped into per-request
+ * timelines with resource/csdk/logger/tools/trace_timeline.py.
+ */
 
 void oic_trace_begin(const char *name, ...);
 void oic_trace_end();
@@ -55,6 +55,15 @@
 #include "string.h"
 #include "experimental/logger_types.h"
 
+// Asynchronous logging and per-tag log levels need pthreads and the GCC atomic builtins.
+#if !defined(ARDUINO) && !defined(__TIZEN__) && defined(HAVE_PTHREAD_H) && \
+    defined(_POSIX_TIMERS) && (_POSIX_TIMERS > 0) && (defined(__GNUC__) || defined(__clang__))
+#define LOG_ASYNC_SUPPORTED
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#endif
+
 // log level
 static int g_level = DEBUG;
 // private log messages are not logged unless they have been explicitly enabled by calling OCSetLogLevel().
@@ -118,15 +127,63 @@ static oc_log_level LEVEL_XTABLE[] = {OC_LOG_DEBUG, OC_LOG_INFO,
     {"DEBUG", "INFO", "WARNING", "ERROR", "FATAL"};
 #endif
 
+#ifdef LOG_ASYNC_SUPPORTED
+#define MAX_TAG_LEVELS  (32)
+#define MAX_TAG_LENGTH  (32)
+
+/**
+ * Log level override for one tag. Entries are only ever appended, under g_tagLevelMutex,
+ * so readers can scan the first g_tagLevelCount entries without taking the lock.
+ */
+typedef struct
+{
+    char tag[MAX_TAG_LENGTH];
+    int level;                  // NO_TAG_LEVEL once the override has been cleared
+} TagLevel;
+
+#define NO_TAG_LEVEL    (-1)
+
+static TagLevel g_tagLevels[MAX_TAG_LEVELS];
+static int g_tagLevelCount = 0;
+static pthread_mutex_t g_tagLevelMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/**
+ * Returns the minimum level logged for a tag: its override if one is set, otherwise the
+ * level set by OCSetLogLevel().
+ */
+static int GetLogLevelForTag(const char *tag)
+{
+#ifdef LOG_ASYNC_SUPPORTED
+    int count = __atomic_load_n(&g_tagLevelCount, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count; i++)
+    {
+        if (0 == strncmp(g_tagLevels[i].tag, tag, MAX_TAG_LENGTH))
+        {
+            int level = __atomic_load_n(&g_tagLevels[i].level, __ATOMIC_RELAXED);
+            if (NO_TAG_LEVEL != level)
+            {
+                return level;
+            }
+            break;
+        }
+    }
+#else
+    (void)tag;
+#endif
+    return g_level;
+}
+
 /**
  * Checks if a message should be logged, based on its priority level, and removes
  * the OC_LOG_PRIVATE_DATA bit if the message should be logged.
  *
  * @param level[in] - One of DEBUG, INFO, WARNING, ERROR, or FATAL plus possibly the OC_LOG_PRIVATE_DATA bit
+ * @param tag[in]   - Module name
  *
  * @return true if the message should be logged, false otherwise
  */
-static bool AdjustAndVerifyLogLevel(int* level)
+static bool AdjustAndVerifyLogLevel(int* level, const char* tag)
 {
     int localLevel = *level;
 
@@ -140,7 +197,7 @@ static bool AdjustAndVerifyLogLevel(int* level)
         localLevel &= ~OC_LOG_PRIVATE_DATA;
     }
 
-    if (g_level > localLevel)
+    if (GetLogLevelForTag(tag) > localLevel)
     {
         return false;
     }
@@ -150,6 +207,882 @@ static bool AdjustAndVerifyLogLevel(int* level)
 }
 
 #ifndef ARDUINO
+#ifndef __TIZEN__
+static void WriteLog(int level, const char *tag, const char *logStr, const struct timespec *when);
+#endif
+
+#ifdef LOG_ASYNC_SUPPORTED
+/*
+ * Asynchronous logging.
+ *
+ * Each thread that logs owns a single producer, single consumer ring of binary records.
+ * A record holds the level, tag, format string and a copy of the arguments, so the
+ * logging thread only copies bytes; the logger thread formats and writes the records.
+ * Records that don't fit in a full ring are dropped and counted.
+ */
+#define LOG_ASYNC_DEFAULT_RING_SIZE     (64 * 1024)
+#define LOG_ASYNC_MIN_RING_SIZE         (4 * 1024)
+#define LOG_ASYNC_MAX_RECORD_SIZE       (1024)
+#define LOG_ASYNC_IDLE_WAIT_MS          (10)
+#define LOG_RECORD_ALIGN                (8)
+#define LOG_CACHE_LINE_SIZE             (64)
+
+typedef enum
+{
+    LOG_RECORD_PADDING = 0,     // fills the end of the ring before a record that wraps
+    LOG_RECORD_STRING,          // text is the message
+    LOG_RECORD_FORMAT           // text is a format string, followed by its arguments
+} LogRecordType;
+
+typedef enum
+{
+    LOG_ARG_INT = 0,
+    LOG_ARG_UINT,
+    LOG_ARG_LONG,
+    LOG_ARG_ULONG,
+    LOG_ARG_LLONG,
+    LOG_ARG_ULLONG,
+    LOG_ARG_INTMAX,
+    LOG_ARG_UINTMAX,
+    LOG_ARG_SIZE,
+    LOG_ARG_PTRDIFF,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_LDOUBLE,
+    LOG_ARG_POINTER,
+    LOG_ARG_STRING,             // uint16_t length, then the characters and a terminating 0
+    LOG_ARG_NULL_STRING,
+    LOG_ARG_NONE,               // %% conversion
+    LOG_ARG_UNSUPPORTED
+} LogArgType;
+
+/**
+ * Record header. The first two fields are all a padding record writes.
+ * The header is followed by the tag, the text and the arguments.
+ */
+typedef struct
+{
+    uint32_t size;              // size of the whole record, a multiple of LOG_RECORD_ALIGN
+    uint8_t type;               // LogRecordType
+    uint8_t level;
+    uint16_t tagLength;         // excluding the terminating 0
+    uint16_t textLength;        // excluding the terminating 0
+    uint16_t argsLength;
+    struct timespec when;
+} LogRecord;
+
+typedef struct LogRing
+{
+    struct LogRing *next;       // registry list, only changed under g_asyncMutex
+    uint8_t *buffer;
+    size_t capacity;            // a power of two
+    bool closed;                // the owning thread has exited
+    uint64_t reportedDrops;     // drops already reported by the logger thread
+    uint64_t head __attribute__((aligned(LOG_CACHE_LINE_SIZE)));    // written by the logger thread
+    uint64_t tail __attribute__((aligned(LOG_CACHE_LINE_SIZE)));    // written by the owning thread
+    uint64_t dropped;           // written by the owning thread
+} LogRing;
+
+static bool g_asyncEnabled = false;
+static LogRing *g_rings = NULL;
+static uint64_t g_retiredDrops = 0;
+static size_t g_ringSize = LOG_ASYNC_DEFAULT_RING_SIZE;
+static bool g_logThreadRunning = false;
+static bool g_logThreadStop = false;
+static bool g_logThreadWaiting = false;
+static pthread_t g_logThread;
+static pthread_mutex_t g_asyncMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_asyncCond = PTHREAD_COND_INITIALIZER;
+static pthread_once_t g_ringKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t g_ringKey;
+static __thread LogRing *t_ring = NULL;
+
+static size_t AlignRecordSize(size_t size)
+{
+    return (size + LOG_RECORD_ALIGN - 1) & ~((size_t)LOG_RECORD_ALIGN - 1);
+}
+
+static void ReleaseRing(void *data)
+{
+    LogRing *ring = (LogRing *)data;
+    // A later TLS destructor of this thread that logs gets a new ring; this one may be freed.
+    t_ring = NULL;
+    __atomic_store_n(&ring->closed, true, __ATOMIC_RELEASE);
+}
+
+static void CreateRingKey()
+{
+    pthread_key_create(&g_ringKey, ReleaseRing);
+}
+
+/**
+ * Returns the calling thread's ring, registering a new one on first use.
+ */
+static LogRing *GetThreadRing()
+{
+    if (t_ring)
+    {
+        return t_ring;
+    }
+
+    pthread_once(&g_ringKeyOnce, CreateRingKey);
+
+    LogRing *ring = (LogRing *)calloc(1, sizeof(LogRing));
+    if (!ring)
+    {
+        return NULL;
+    }
+    pthread_mutex_lock(&g_asyncMutex);
+    ring->capacity = g_ringSize;
+    ring->buffer = (uint8_t *)malloc(ring->capacity);
+    if (!ring->buffer)
+    {
+        pthread_mutex_unlock(&g_asyncMutex);
+        free(ring);
+        return NULL;
+    }
+    ring->next = g_rings;
+    __atomic_store_n(&g_rings, ring, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_asyncMutex);
+
+    pthread_setspecific(g_ringKey, ring);
+    t_ring = ring;
+    return ring;
+}
+
+/**
+ * Copies a record into the ring. Called only by the thread owning the ring.
+ */
+static bool PushRecord(LogRing *ring, const LogRecord *record)
+{
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = ring->tail;
+    size_t offset = (size_t)(tail & (ring->capacity - 1));
+    size_t contiguous = ring->capacity - offset;
+    size_t needed = record->size;
+    if (contiguous < record->size)
+    {
+        needed += contiguous;
+    }
+
+    if (ring->capacity - (size_t)(tail - head) < needed)
+    {
+        __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    if (contiguous < record->size)
+    {
+        LogRecord padding = { .size = (uint32_t)contiguous, .type = LOG_RECORD_PADDING };
+        memcpy(ring->buffer + offset, &padding, LOG_RECORD_ALIGN);
+        tail += contiguous;
+        offset = 0;
+    }
+    memcpy(ring->buffer + offset, record, record->size);
+    __atomic_store_n(&ring->tail, tail + record->size, __ATOMIC_RELEASE);
+
+    // The logger thread polls anyway, so a lost wakeup only delays the output.
+    if ((size_t)(tail + record->size - head) > ring->capacity / 2 &&
+        __atomic_load_n(&g_logThreadWaiting, __ATOMIC_RELAXED))
+    {
+        pthread_cond_signal(&g_asyncCond);
+    }
+    return true;
+}
+
+/**
+ * Parsed conversion specification of a format string.
+ */
+typedef struct
+{
+    const char *end;            // first character after the conversion
+    LogArgType argType;
+    bool starWidth;
+    bool starPrecision;
+    int precision;              // -1 unless given in the format
+} FormatSpec;
+
+/**
+ * Parses the conversion specification following a '%'.
+ *
+ * @return false if the conversion can't be captured, e.g. positional arguments,
+ *         wide strings or %n.
+ */
+static bool ParseFormatSpec(const char *p, FormatSpec *spec)
+{
+    spec->starWidth = false;
+    spec->starPrecision = false;
+    spec->precision = -1;
+
+    while (*p && strchr("-+ #0'", *p))
+    {
+        p++;
+    }
+    if ('*' == *p)
+    {
+        spec->starWidth = true;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9')
+    {
+        p++;
+    }
+    if ('$' == *p)
+    {
+        return false;
+    }
+    if ('.' == *p)
+    {
+        p++;
+        if ('*' == *p)
+        {
+            spec->starPrecision = true;
+            p++;
+        }
+        else
+        {
+            spec->precision = 0;
+            while (*p >= '0' && *p <= '9')
+            {
+                spec->precision = spec->precision * 10 + (*p - '0');
+                p++;
+            }
+        }
+    }
+
+    // Length modifier: h, hh, l, ll, q, L, j, z or t
+    char length = 0;
+    if ('h' == *p || 'l' == *p)
+    {
+        length = *p++;
+        if (*p == length)
+        {
+            length = (char)(length - 'a' + 'A');    // 'H' for hh, 'L' for ll
+            p++;
+        }
+    }
+    else if (*p && strchr("qLjzt", *p))
+    {
+        length = ('q' == *p) ? 'L' : *p;
+        p++;
+    }
+
+    LogArgType signedType;
+    LogArgType unsignedType;
+    switch (length)
+    {
+        case 0:
+        case 'h':
+        case 'H':
+            signedType = LOG_ARG_INT;
+            unsignedType = LOG_ARG_UINT;
+            break;
+        case 'l':
+            signedType = LOG_ARG_LONG;
+            unsignedType = LOG_ARG_ULONG;
+            break;
+        case 'L':
+            signedType = LOG_ARG_LLONG;
+            unsignedType = LOG_ARG_ULLONG;
+            break;
+        case 'j':
+            signedType = LOG_ARG_INTMAX;
+            unsignedType = LOG_ARG_UINTMAX;
+            break;
+        case 'z':
+            signedType = LOG_ARG_SIZE;
+            unsignedType = LOG_ARG_SIZE;
+            break;
+        default: // 't'
+            signedType = LOG_ARG_PTRDIFF;
+            unsignedType = LOG_ARG_PTRDIFF;
+            break;
+    }
+
+    switch (*p)
+    {
+        case 'd':
+        case 'i':
+            spec->argType = signedType;
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            spec->argType = unsignedType;
+            break;
+        case 'c':
+            spec->argType = (0 == length) ? LOG_ARG_INT : LOG_ARG_UNSUPPORTED;
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            // 'L' stands for both ll and L; only L is valid with floating point conversions.
+            spec->argType = ('L' == length) ? LOG_ARG_LDOUBLE : LOG_ARG_DOUBLE;
+            break;
+        case 's':
+            spec->argType = (0 == length) ? LOG_ARG_STRING : LOG_ARG_UNSUPPORTED;
+            break;
+        case 'p':
+            spec->argType = LOG_ARG_POINTER;
+            break;
+        case '%':
+            spec->argType = LOG_ARG_NONE;
+            break;
+        default:
+            spec->argType = LOG_ARG_UNSUPPORTED;
+            break;
+    }
+    spec->end = p + 1;
+    return (LOG_ARG_UNSUPPORTED != spec->argType);
+}
+
+/**
+ * Appends one captured argument, tagged with its type, to @p out.
+ */
+static bool PutArg(uint8_t *out, size_t size, size_t *pos, LogArgType type,
+                   const void *value, size_t valueSize)
+{
+    if (*pos + 1 + valueSize > size)
+    {
+        return false;
+    }
+    out[(*pos)++] = (uint8_t)type;
+    if (valueSize)
+    {
+        memcpy(out + *pos, value, valueSize);
+        *pos += valueSize;
+    }
+    return true;
+}
+
+#define CAPTURE_ARG(argType, type) \
+    do { \
+        type value = va_arg(args, type); \
+        if (!PutArg(out, size, &pos, (argType), &value, sizeof(value))) \
+        { \
+            return -1; \
+        } \
+    } while (0)
+
+/**
+ * Copies the arguments of a format string into a buffer.
+ *
+ * @return the number of bytes written, or -1 if the arguments can't be captured or
+ *         don't fit.
+ */
+static int CaptureArgs(const char *format, va_list args, uint8_t *out, size_t size)
+{
+    size_t pos = 0;
+    for (const char *p = strchr(format, '%'); p; p = strchr(p, '%'))
+    {
+        FormatSpec spec;
+        if (!ParseFormatSpec(p + 1, &spec))
+        {
+            return -1;
+        }
+        p = spec.end;
+        if (LOG_ARG_NONE == spec.argType)
+        {
+            continue;
+        }
+
+        if (spec.starWidth)
+        {
+            CAPTURE_ARG(LOG_ARG_INT, int);
+        }
+        if (spec.starPrecision)
+        {
+            int precision = va_arg(args, int);
+            if (!PutArg(out, size, &pos, LOG_ARG_INT, &precision, sizeof(precision)))
+            {
+                return -1;
+            }
+            spec.precision = precision;
+        }
+
+        switch (spec.argType)
+        {
+            case LOG_ARG_INT:
+                CAPTURE_ARG(LOG_ARG_INT, int);
+                break;
+            case LOG_ARG_UINT:
+                CAPTURE_ARG(LOG_ARG_UINT, unsigned int);
+                break;
+            case LOG_ARG_LONG:
+                CAPTURE_ARG(LOG_ARG_LONG, long);
+                break;
+            case LOG_ARG_ULONG:
+                CAPTURE_ARG(LOG_ARG_ULONG, unsigned long);
+                break;
+            case LOG_ARG_LLONG:
+                CAPTURE_ARG(LOG_ARG_LLONG, long long);
+                break;
+            case LOG_ARG_ULLONG:
+                CAPTURE_ARG(LOG_ARG_ULLONG, unsigned long long);
+                break;
+            case LOG_ARG_INTMAX:
+                CAPTURE_ARG(LOG_ARG_INTMAX, intmax_t);
+                break;
+            case LOG_ARG_UINTMAX:
+                CAPTURE_ARG(LOG_ARG_UINTMAX, uintmax_t);
+                break;
+            case LOG_ARG_SIZE:
+                CAPTURE_ARG(LOG_ARG_SIZE, size_t);
+                break;
+            case LOG_ARG_PTRDIFF:
+                CAPTURE_ARG(LOG_ARG_PTRDIFF, ptrdiff_t);
+                break;
+            case LOG_ARG_DOUBLE:
+                CAPTURE_ARG(LOG_ARG_DOUBLE, double);
+                break;
+            case LOG_ARG_LDOUBLE:
+                CAPTURE_ARG(LOG_ARG_LDOUBLE, long double);
+                break;
+            case LOG_ARG_POINTER:
+                CAPTURE_ARG(LOG_ARG_POINTER, void *);
+                break;
+            case LOG_ARG_STRING:
+            {
+                const char *str = va_arg(args, const char *);
+                if (!str)
+                {
+                    if (!PutArg(out, size, &pos, LOG_ARG_NULL_STRING, NULL, 0))
+                    {
+                        return -1;
+                    }
+                    break;
+                }
+                // Nothing past MAX_LOG_V_BUFFER_SIZE can be printed, so don't copy it.
+                size_t maxLength = MAX_LOG_V_BUFFER_SIZE;
+                if (spec.precision >= 0 && (size_t)spec.precision < maxLength)
+                {
+                    maxLength = (size_t)spec.precision;
+                }
+                uint16_t length = (uint16_t)strnlen(str, maxLength);
+                if (!PutArg(out, size, &pos, LOG_ARG_STRING, &length, sizeof(length)) ||
+                    pos + length + 1 > size)
+                {
+                    return -1;
+                }
+                memcpy(out + pos, str, length);
+                pos += length;
+                out[pos++] = '\0';
+                break;
+            }
+            default:
+                return -1;
+        }
+    }
+    return (int)pos;
+}
+
+#undef CAPTURE_ARG
+
+/**
+ * Builds a single conversion specification for snprintf, with '*' replaced by the
+ * captured width and precision.
+ */
+static const uint8_t *BuildSpec(const char *start, const FormatSpec *spec, const uint8_t *args,
+                                char *out, size_t size)
+{
+    size_t pos = 0;
+    const char *p = start;
+    while (p < spec->end && pos + 1 < size)
+    {
+        if ('*' == *p)
+        {
+            int value;
+            memcpy(&value, args + 1, sizeof(value));
+            args += 1 + sizeof(value);
+            // A negative precision is taken as if the precision were omitted.
+            if (value < 0 && pos > 0 && '.' == out[pos - 1])
+            {
+                pos--;
+            }
+            else
+            {
+                int written = snprintf(out + pos, size - pos, "%d", value);
+                pos += (written > 0) ? (size_t)written : 0;
+                if (pos >= size)
+                {
+                    pos = size - 1;
+                }
+            }
+            p++;
+            continue;
+        }
+        out[pos++] = *p++;
+    }
+    out[pos] = '\0';
+    return args;
+}
+
+#define FORMAT_ARG(type) \
+    do { \
+        type value; \
+        memcpy(&value, args + 1, sizeof(value)); \
+        args += 1 + sizeof(value); \
+        written = snprintf(out + pos, size - pos, specStr, value); \
+    } while (0)
+
+/**
+ * Formats a captured record into @p out, which is always 0-terminated.
+ */
+static void FormatRecord(const char *format, const uint8_t *args, char *out, size_t size)
+{
+    size_t pos = 0;
+    const char *p = format;
+    while (*p && pos + 1 < size)
+    {
+        if ('%' != *p)
+        {
+            out[pos++] = *p++;
+            continue;
+        }
+
+        FormatSpec spec;
+        ParseFormatSpec(p + 1, &spec);
+        if (LOG_ARG_NONE == spec.argType)
+        {
+            out[pos++] = '%';
+            p = spec.end;
+            continue;
+        }
+
+        char specStr[32];
+        args = BuildSpec(p, &spec, args, specStr, sizeof(specStr));
+        p = spec.end;
+
+        int written = 0;
+        switch ((LogArgType)args[0])
+        {
+            case LOG_ARG_INT:
+                FORMAT_ARG(int);
+                break;
+            case LOG_ARG_UINT:
+                FORMAT_ARG(unsigned int);
+                break;
+            case LOG_ARG_LONG:
+                FORMAT_ARG(long);
+                break;
+            case LOG_ARG_ULONG:
+                FORMAT_ARG(unsigned long);
+                break;
+            case LOG_ARG_LLONG:
+                FORMAT_ARG(long long);
+                break;
+            case LOG_ARG_ULLONG:
+                FORMAT_ARG(unsigned long long);
+                break;
+            case LOG_ARG_INTMAX:
+                FORMAT_ARG(intmax_t);
+                break;
+            case LOG_ARG_UINTMAX:
+                FORMAT_ARG(uintmax_t);
+                break;
+            case LOG_ARG_SIZE:
+                FORMAT_ARG(size_t);
+                break;
+            case LOG_ARG_PTRDIFF:
+                FORMAT_ARG(ptrdiff_t);
+                break;
+            case LOG_ARG_DOUBLE:
+                FORMAT_ARG(double);
+                break;
+            case LOG_ARG_LDOUBLE:
+                FORMAT_ARG(long double);
+                break;
+            case LOG_ARG_POINTER:
+                FORMAT_ARG(void *);
+                break;
+            case LOG_ARG_STRING:
+            {
+                uint16_t length;
+                memcpy(&length, args + 1, sizeof(length));
+                written = snprintf(out + pos, size - pos, specStr,
+                                   (const char *)(args + 1 + sizeof(length)));
+                args += 1 + sizeof(length) + length + 1;
+                break;
+            }
+            case LOG_ARG_NULL_STRING:
+                written = snprintf(out + pos, size - pos, specStr, (const char *)NULL);
+                args += 1;
+                break;
+            default:
+                break;
+        }
+        if (written > 0)
+        {
+            pos += (size_t)written;
+        }
+        if (pos >= size)
+        {
+            pos = size - 1;
+        }
+    }
+    out[pos] = '\0';
+}
+
+#undef FORMAT_ARG
+
+/**
+ * Queues a log message on the calling thread's ring.
+ *
+ * @param text    the message, if @p format is NULL.
+ * @param format  printf format of the message, or NULL.
+ * @param args    arguments of @p format.
+ *
+ * @return false if asynchronous logging is off or the message is too large to queue,
+ *         in which case the caller must log it synchronously. A message dropped because
+ *         the ring is full counts as queued.
+ */
+static bool QueueLog(int level, const char *tag, const char *text, const char *format,
+                     va_list *args)
+{
+    if (!__atomic_load_n(&g_asyncEnabled, __ATOMIC_ACQUIRE))
+    {
+        return false;
+    }
+    LogRing *ring = GetThreadRing();
+    if (!ring)
+    {
+        return false;
+    }
+
+    union
+    {
+        LogRecord record;
+        uint8_t bytes[LOG_ASYNC_MAX_RECORD_SIZE];
+    } buffer;
+    LogRecord *record = &buffer.record;
+    size_t tagLength = strnlen(tag, MAX_LOG_V_BUFFER_SIZE);
+    size_t pos = sizeof(LogRecord) + tagLength + 1;
+    if (pos >= sizeof(buffer))
+    {
+        return false;
+    }
+    memcpy(buffer.bytes + sizeof(LogRecord), tag, tagLength);
+    buffer.bytes[pos - 1] = '\0';
+
+    record->type = LOG_RECORD_FORMAT;
+    record->argsLength = 0;
+    if (format)
+    {
+        bool captured = false;
+        size_t formatLength = strlen(format);
+        if (pos + formatLength + 1 < sizeof(buffer))
+        {
+            va_list argsCopy;
+            va_copy(argsCopy, *args);
+            int argsLength = CaptureArgs(format, argsCopy, buffer.bytes + pos + formatLength + 1,
+                                         sizeof(buffer) - pos - formatLength - 1);
+            va_end(argsCopy);
+            if (argsLength >= 0)
+            {
+                memcpy(buffer.bytes + pos, format, formatLength + 1);
+                record->textLength = (uint16_t)formatLength;
+                record->argsLength = (uint16_t)argsLength;
+                pos += formatLength + 1 + (size_t)argsLength;
+                captured = true;
+            }
+        }
+        if (!captured)
+        {
+            // Not capturable, so format it here, as the synchronous path would.
+            char *message = (char *)(buffer.bytes + pos);
+            size_t available = sizeof(buffer) - pos;
+            if (available > MAX_LOG_V_BUFFER_SIZE)
+            {
+                available = MAX_LOG_V_BUFFER_SIZE;
+            }
+            vsnprintf(message, available - 1, format, *args);
+            message[available - 1] = '\0';
+            record->type = LOG_RECORD_STRING;
+            record->textLength = (uint16_t)strlen(message);
+            pos += record->textLength + 1;
+        }
+    }
+    else
+    {
+        size_t textLength = strlen(text);
+        if (pos + textLength + 1 > sizeof(buffer))
+        {
+            return false;
+        }
+        memcpy(buffer.bytes + pos, text, textLength + 1);
+        record->type = LOG_RECORD_STRING;
+        record->textLength = (uint16_t)textLength;
+        pos += textLength + 1;
+    }
+
+    record->size = (uint32_t)AlignRecordSize(pos);
+    record->level = (uint8_t)level;
+    record->tagLength = (uint16_t)tagLength;
+    clockid_t clk = CLOCK_REALTIME;
+#ifdef CLOCK_REALTIME_COARSE
+    clk = CLOCK_REALTIME_COARSE;
+#endif
+    clock_gettime(clk, &record->when);
+
+    if (record->size > ring->capacity / 2)
+    {
+        return false;
+    }
+    PushRecord(ring, record);
+    return true;
+}
+
+/**
+ * Returns the oldest record at the head of @p ring, skipping padding, or NULL.
+ */
+static const LogRecord *PeekRecord(LogRing *ring)
+{
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    while (ring->head != tail)
+    {
+        const LogRecord *record =
+            (const LogRecord *)(ring->buffer + (ring->head & (ring->capacity - 1)));
+        if (LOG_RECORD_PADDING != record->type)
+        {
+            return record;
+        }
+        __atomic_store_n(&ring->head, ring->head + record->size, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+static bool IsEarlier(const struct timespec *a, const struct timespec *b)
+{
+    return (a->tv_sec < b->tv_sec) || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+/**
+ * Writes out the queued records of all threads, oldest first. Called only by the logger
+ * thread, or by OCLogStopAsync() once the logger thread has stopped.
+ *
+ * @return the number of records written.
+ */
+static size_t DrainRings()
+{
+    size_t count = 0;
+    LogRing *rings = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        LogRing *oldestRing = NULL;
+        const LogRecord *oldest = NULL;
+        for (LogRing *ring = rings; ring; ring = ring->next)
+        {
+            const LogRecord *record = PeekRecord(ring);
+            if (record && (!oldest || IsEarlier(&record->when, &oldest->when)))
+            {
+                oldest = record;
+                oldestRing = ring;
+            }
+        }
+        if (!oldest)
+        {
+            break;
+        }
+
+        const char *tag = (const char *)(oldest + 1);
+        const char *text = tag + oldest->tagLength + 1;
+        if (LOG_RECORD_FORMAT == oldest->type)
+        {
+            // Truncated like the synchronous path, which formats into sizeof buffer - 1.
+            char message[MAX_LOG_V_BUFFER_SIZE];
+            FormatRecord(text, (const uint8_t *)(text + oldest->textLength + 1),
+                         message, sizeof(message) - 1);
+            WriteLog(oldest->level, tag, message, &oldest->when);
+        }
+        else
+        {
+            WriteLog(oldest->level, tag, text, &oldest->when);
+        }
+        __atomic_store_n(&oldestRing->head, oldestRing->head + oldest->size, __ATOMIC_RELEASE);
+        count++;
+    }
+
+    for (LogRing *ring = rings; ring; ring = ring->next)
+    {
+        uint64_t dropped = __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+        if (dropped != ring->reportedDrops)
+        {
+            char message[MAX_LOG_V_BUFFER_SIZE];
+            snprintf(message, sizeof(message), "%" PRIu64 " log messages dropped",
+                     dropped - ring->reportedDrops);
+            WriteLog(WARNING, "OIC_LOG", message, NULL);
+            ring->reportedDrops = dropped;
+        }
+    }
+    return count;
+}
+
+/**
+ * Frees the rings of threads that have exited once they are empty.
+ */
+static void FreeClosedRings()
+{
+    pthread_mutex_lock(&g_asyncMutex);
+    LogRing **link = &g_rings;
+    while (*link)
+    {
+        LogRing *ring = *link;
+        if (__atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE) &&
+            ring->head == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE))
+        {
+            __atomic_store_n(link, ring->next, __ATOMIC_RELEASE);
+            g_retiredDrops += ring->dropped;
+            free(ring->buffer);
+            free(ring);
+            continue;
+        }
+        link = &ring->next;
+    }
+    pthread_mutex_unlock(&g_asyncMutex);
+}
+
+static void *LogThread(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        size_t count = DrainRings();
+
+        pthread_mutex_lock(&g_asyncMutex);
+        if (g_logThreadStop)
+        {
+            pthread_mutex_unlock(&g_asyncMutex);
+            break;
+        }
+        if (0 == count)
+        {
+            struct timespec timeout;
+            clock_gettime(CLOCK_REALTIME, &timeout);
+            timeout.tv_nsec += LOG_ASYNC_IDLE_WAIT_MS * 1000000L;
+            if (timeout.tv_nsec >= 1000000000L)
+            {
+                timeout.tv_sec++;
+                timeout.tv_nsec -= 1000000000L;
+            }
+            __atomic_store_n(&g_logThreadWaiting, true, __ATOMIC_RELAXED);
+            pthread_cond_timedwait(&g_asyncCond, &g_asyncMutex, &timeout);
+            __atomic_store_n(&g_logThreadWaiting, false, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(&g_asyncMutex);
+
+        if (0 == count)
+        {
+            FreeClosedRings();
+        }
+    }
+    return NULL;
+}
+#endif // LOG_ASYNC_SUPPORTED
 
 /**
  * Output the contents of the specified buffer (in hex) with the specified priority level.
@@ -166,7 +1099,7 @@ void OCLogBuffer(int level, const char* tag, const uint8_t* buffer, size_t buffe
         return;
     }
 
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
@@ -176,10 +1109,13 @@ void OCLogBuffer(int level, const char* tag, const uint8_t* buffer, size_t buffe
     char lineBuffer[LINE_BUFFER_SIZE];
     memset(lineBuffer, 0, sizeof lineBuffer);
     size_t lineIndex = 0;
+    static const char hexDigits[] = "0123456789ABCDEF";
     for (size_t i = 0; i < bufferSize; i++)
     {
-        // Format the buffer data into a line
-        snprintf(&lineBuffer[lineIndex * 3], sizeof(lineBuffer) - lineIndex * 3, "%02X ", buffer[i]);
+        // Format the buffer data into a line, as "%02X " would
+        lineBuffer[lineIndex * 3] = hexDigits[buffer[i] >> 4];
+        lineBuffer[lineIndex * 3 + 1] = hexDigits[buffer[i] & 0x0F];
+        lineBuffer[lineIndex * 3 + 2] = ' ';
         lineIndex++;
         // Output 16 values per line
         if (((i + 1) % 16) == 0)
@@ -215,6 +1151,7 @@ void OCLogInit()
 
 void OCLogShutdown()
 {
+    OCLogStopAsync();
 #if defined(__linux__) || defined(__APPLE__) || defined(_WIN32)
     if (logCtx && logCtx->destroy)
     {
@@ -223,6 +1160,145 @@ void OCLogShutdown()
 #endif
 }
 
+bool OCLogStartAsync(size_t ringSize)
+{
+#ifdef LOG_ASYNC_SUPPORTED
+    pthread_mutex_lock(&g_asyncMutex);
+    if (g_logThreadRunning)
+    {
+        pthread_mutex_unlock(&g_asyncMutex);
+        return true;
+    }
+
+    // Rings of threads that already logged keep their size.
+    size_t target = ringSize ? ringSize : LOG_ASYNC_DEFAULT_RING_SIZE;
+    g_ringSize = LOG_ASYNC_MIN_RING_SIZE;
+    while (g_ringSize < target)
+    {
+        g_ringSize <<= 1;
+    }
+
+    g_logThreadStop = false;
+    if (0 != pthread_create(&g_logThread, NULL, LogThread, NULL))
+    {
+        pthread_mutex_unlock(&g_asyncMutex);
+        return false;
+    }
+    g_logThreadRunning = true;
+    __atomic_store_n(&g_asyncEnabled, true, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_asyncMutex);
+    return true;
+#else
+    (void)ringSize;
+    return false;
+#endif
+}
+
+void OCLogStopAsync()
+{
+#ifdef LOG_ASYNC_SUPPORTED
+    pthread_mutex_lock(&g_asyncMutex);
+    if (!g_logThreadRunning)
+    {
+        pthread_mutex_unlock(&g_asyncMutex);
+        return;
+    }
+    __atomic_store_n(&g_asyncEnabled, false, __ATOMIC_RELEASE);
+    g_logThreadStop = true;
+    pthread_cond_signal(&g_asyncCond);
+    pthread_mutex_unlock(&g_asyncMutex);
+
+    pthread_join(g_logThread, NULL);
+
+    // The logger thread has exited, so this thread can consume what is left.
+    DrainRings();
+    FreeClosedRings();
+
+    pthread_mutex_lock(&g_asyncMutex);
+    g_logThreadRunning = false;
+    pthread_mutex_unlock(&g_asyncMutex);
+#endif
+}
+
+uint64_t OCLogGetDroppedCount()
+{
+    uint64_t dropped = 0;
+#ifdef LOG_ASYNC_SUPPORTED
+    pthread_mutex_lock(&g_asyncMutex);
+    dropped = g_retiredDrops;
+    for (LogRing *ring = g_rings; ring; ring = ring->next)
+    {
+        dropped += __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&g_asyncMutex);
+#endif
+    return dropped;
+}
+
+bool OCSetLogLevelForTag(const char *tag, LogLevel level)
+{
+#ifdef LOG_ASYNC_SUPPORTED
+    if (!tag || strlen(tag) >= MAX_TAG_LENGTH)
+    {
+        return false;
+    }
+
+    bool result = true;
+    pthread_mutex_lock(&g_tagLevelMutex);
+    int i = 0;
+    for (; i < g_tagLevelCount; i++)
+    {
+        if (0 == strcmp(g_tagLevels[i].tag, tag))
+        {
+            break;
+        }
+    }
+    if (i < g_tagLevelCount)
+    {
+        __atomic_store_n(&g_tagLevels[i].level, (int)level, __ATOMIC_RELAXED);
+    }
+    else if (i < MAX_TAG_LEVELS)
+    {
+        strcpy(g_tagLevels[i].tag, tag);
+        g_tagLevels[i].level = (int)level;
+        __atomic_store_n(&g_tagLevelCount, i + 1, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        result = false;
+    }
+    pthread_mutex_unlock(&g_tagLevelMutex);
+    return result;
+#else
+    (void)tag;
+    (void)level;
+    return false;
+#endif
+}
+
+void OCClearLogLevelForTag(const char *tag)
+{
+#ifdef LOG_ASYNC_SUPPORTED
+    if (!tag)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&g_tagLevelMutex);
+    for (int i = 0; i < g_tagLevelCount; i++)
+    {
+        if (0 == strncmp(g_tagLevels[i].tag, tag, MAX_TAG_LENGTH))
+        {
+            __atomic_store_n(&g_tagLevels[i].level, NO_TAG_LEVEL, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_tagLevelMutex);
+#else
+    (void)tag;
+#endif
+}
+
 /**
  * Output a variable argument list log string with the specified priority level.
  * Only defined for Linux and Android
@@ -237,17 +1313,24 @@ void OCLogv(int level, const char * tag, const char * format, ...)
         return;
     }
 
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
 
-    char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
     va_list args;
     va_start(args, format);
+#ifdef LOG_ASYNC_SUPPORTED
+    if (QueueLog(level, tag, NULL, format, &args))
+    {
+        va_end(args);
+        return;
+    }
+#endif
+    char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
     vsnprintf(buffer, sizeof buffer - 1, format, args);
     va_end(args);
-    OCLog(level, tag, buffer);
+    WriteLog(level, tag, buffer, NULL);
 }
 
 /**
@@ -265,11 +1348,30 @@ void OCLog(int level, const char * tag, const char * logStr)
        return;
     }
 
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
 
+#ifdef LOG_ASYNC_SUPPORTED
+    if (QueueLog(level, tag, logStr, NULL, NULL))
+    {
+        return;
+    }
+#endif
+    WriteLog(level, tag, logStr, NULL);
+}
+
+/**
+ * Write a log string that has passed the level checks.
+ *
+ * @param level  - One of DEBUG, INFO, WARNING, ERROR, FATAL, DEBUG_LITE or INFO_LITE
+ * @param tag    - Module name
+ * @param logStr - log string
+ * @param when   - time the message was logged, or NULL for the current time
+ */
+static void WriteLog(int level, const char *tag, const char *logStr, const struct timespec *when)
+{
     switch(level)
     {
         case DEBUG_LITE:
@@ -284,6 +1386,7 @@ void OCLog(int level, const char * tag, const char * logStr)
 
    #ifdef __ANDROID__
 
+   (void)when;
    #ifdef ADB_SHELL
        printf("%s: %s: %s\n", LEVEL[level], tag, logStr);
    #else
@@ -302,24 +1405,30 @@ void OCLog(int level, const char * tag, const char * logStr)
            int sec = 0;
            int ms = 0;
    #if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
-           struct timespec when = { .tv_sec = 0, .tv_nsec = 0 };
+           struct timespec now = { .tv_sec = 0, .tv_nsec = 0 };
            clockid_t clk = CLOCK_REALTIME;
    #ifdef CLOCK_REALTIME_COARSE
            clk = CLOCK_REALTIME_COARSE;
    #endif
-           if (!clock_gettime(clk, &when))
+           if (!when && !clock_gettime(clk, &now))
+           {
+               when = &now;
+           }
+           if (when)
            {
-               min = (when.tv_sec / 60) % 60;
-               sec = when.tv_sec % 60;
-               ms = when.tv_nsec / 1000000;
+               min = (when->tv_sec / 60) % 60;
+               sec = when->tv_sec % 60;
+               ms = when->tv_nsec / 1000000;
            }
    #elif defined(_WIN32)
+           (void)when;
            SYSTEMTIME systemTime = {0};
            GetLocalTime(&systemTime);
            min = (int)systemTime.wMinute;
            sec = (int)systemTime.wSecond;
            ms  = (int)systemTime.wMilliseconds;
    #else
+           (void)when;
            struct timeval now;
            if (!gettimeofday(&now, NULL))
            {
@@ -360,7 +1469,7 @@ void OCLogString(int level, PROGMEM const char * tag, const char * logStr)
       return;
     }
 
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
@@ -398,7 +1507,7 @@ void OCLogBuffer(int level, PROGMEM const char * tag,
         return;
     }
 
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
@@ -442,7 +1551,7 @@ void OCLog(int level, PROGMEM const char *tag, const int lineNum,
         return;
     }
 
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
@@ -479,7 +1588,7 @@ void OCLog(int level, PROGMEM const char *tag, const int lineNum,
 void OCLogv(int level, PROGMEM const char *tag, const int lineNum,
                 PROGMEM const char *format, ...)
 {
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
@@ -528,7 +1637,7 @@ void OCLogv(int level, PROGMEM const char *tag, const int lineNum,
  */
 void OCLogv(int level, const char *tag, const __FlashStringHelper *format, ...)
 {
-    if (!AdjustAndVerifyLogLevel(&level))
+    if (!AdjustAndVerifyLogLevel(&level, tag))
     {
         return;
     }
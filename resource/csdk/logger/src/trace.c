@@ -20,8 +20,10 @@
 
 #include "iotivity_config.h"
 #include "trace.h"
+#include <stdio.h>
 
-#if (defined(__ANDROID__)) || (defined(__TIZEN__) && defined(OIC_SUPPORT_TIZEN_TRACE))
+#if (defined(__ANDROID__)) || (defined(__TIZEN__) && defined(OIC_SUPPORT_TIZEN_TRACE)) || \
+    (defined(OIC_SUPPORT_LINUX_TRACE))
 
 #define MAX_BUFFER_SIZE 8
 #define MAX_LINE_LEN ((MAX_BUFFER_SIZE) * 2) + 1
@@ -71,6 +73,11 @@ void oic_trace_buffer(const char *name, const uint8_t * buffer, size_t bufferSiz
 #elif defined(HAVE_STRINGS_H)
 #include <strings.h>
 #endif
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#include <errno.h>
+#include <stdarg.h>
 
 #define FD_INITIAL_VALUE  -1
 #define FD_NOT_EXIST    -2
@@ -83,14 +90,21 @@ void oic_trace_buffer(const char *name, const uint8_t * buffer, size_t bufferSiz
 
 #define TAG "OIC_TRACER"
 
-#ifdef __ANDROID__
+#if defined(__ANDROID__) || defined(OIC_SUPPORT_LINUX_TRACE)
 /*
 * Currently android api level 21 is used for building iotivity project.
 * Since Atrace (aka. android trace) API has been provided by NDK above android api level 23,
-* we use ftrace directly as workaround to Atrace API until android build level is upgraded
+* we use ftrace directly as workaround to Atrace API until android build level is upgraded.
+* Linux uses the same trace_marker records, which trace-cmd and perf also understand.
 */
 int g_trace_marker_hd=FD_INITIAL_VALUE;
 
+static const char *g_trace_marker_paths[] =
+{
+    "/sys/kernel/tracing/trace_marker",
+    "/sys/kernel/debug/tracing/trace_marker"
+};
+
 int oic_trace_init()
 {
     OIC_LOG(INFO, TAG, "entering oic_trace_init");
@@ -98,9 +112,22 @@ int oic_trace_init()
     char buf[MAX_BUF_SIZE] = {0};
     ssize_t buflen = -1;
     char *line = NULL, *tmp1 = NULL, *path = NULL;
+    const char *marker = NULL;
 
     if(g_trace_marker_hd == FD_INITIAL_VALUE)
     {
+        /* Try the usual tracefs and debugfs locations before looking through the mounts. */
+        for (size_t i = 0; i < sizeof(g_trace_marker_paths) / sizeof(g_trace_marker_paths[0]); i++)
+        {
+            g_trace_marker_hd = open(g_trace_marker_paths[i], O_WRONLY);
+            if (g_trace_marker_hd >= 0)
+            {
+                OIC_LOG_V(INFO, TAG, "exit oic_trace_init with: %d", g_trace_marker_hd);
+                return g_trace_marker_hd;
+            }
+        }
+        g_trace_marker_hd = FD_NOT_EXIST;
+
         mounts = open("/proc/mounts", O_RDONLY);
         if (mounts < 0)
         {
@@ -126,9 +153,16 @@ int oic_trace_init()
             tmp_path = strtok_r(NULL, " ", &tmp2);
             fstype = strtok_r(NULL, " ", &tmp2);
 
-            if (strcmp(fstype, "debugfs") == 0)
+            if (fstype && strcmp(fstype, "tracefs") == 0)
             {
                 path = tmp_path;
+                marker = "%s/trace_marker";
+                break;
+            }
+            if (fstype && strcmp(fstype, "debugfs") == 0)
+            {
+                path = tmp_path;
+                marker = "%s/tracing/trace_marker";
                 break;
             }
             line = strtok_r(NULL, "\n", &tmp1);
@@ -136,16 +170,18 @@ int oic_trace_init()
 
         if (NULL == path)
         {
-            OIC_LOG(INFO, TAG,  "debugfs mountpoint not found");
+            OIC_LOG(INFO, TAG,  "tracefs or debugfs mountpoint not found");
             return -1;
         }
 
-        snprintf(buf, sizeof(buf) - 1, "%s/tracing/trace_marker", path);
-        g_trace_marker_hd = open(buf, O_WRONLY);
+        char markerPath[MAX_TRACE_LEN] = {0};
+        snprintf(markerPath, sizeof(markerPath), marker, path);
+        g_trace_marker_hd = open(markerPath, O_WRONLY);
         if (g_trace_marker_hd < 0)
         {
             OIC_LOG_V(INFO, TAG, "failed to open trace_marker file: %s (%d)",
                       strerror(errno), errno);
+            g_trace_marker_hd = FD_NOT_EXIST;
             return -1;
         }
     }
@@ -153,12 +189,33 @@ int oic_trace_init()
     return g_trace_marker_hd;
 }
 
-void oic_trace_begin(const char *name, ...)
+#ifdef HAVE_PTHREAD_H
+static pthread_once_t g_trace_init_once = PTHREAD_ONCE_INIT;
+
+static void oic_trace_init_once()
 {
-    if (g_trace_marker_hd == FD_INITIAL_VALUE)
+    oic_trace_init();
+}
+#endif
+
+/**
+ * Opens the trace_marker file the first time a trace is written.
+ */
+static void oic_trace_ensure_init()
+{
+#ifdef HAVE_PTHREAD_H
+    pthread_once(&g_trace_init_once, oic_trace_init_once);
+#else
+    if (FD_INITIAL_VALUE == g_trace_marker_hd)
     {
         oic_trace_init();
     }
+#endif
+}
+
+void oic_trace_begin(const char *name, ...)
+{
+    oic_trace_ensure_init();
 
     if (g_trace_marker_hd > 0)
     {
@@ -184,7 +241,7 @@ void oic_trace_begin(const char *name, ...)
                       len, ret, errno);
         }
     }
-    else
+    else if (FD_NOT_EXIST != g_trace_marker_hd)
     {
         OIC_LOG_V(INFO, TAG, "oic_trace_begin: invalid fd: %d", g_trace_marker_hd);
     }
@@ -192,10 +249,7 @@ void oic_trace_begin(const char *name, ...)
 
 void oic_trace_end()
 {
-    if (FD_INITIAL_VALUE == g_trace_marker_hd)
-    {
-        oic_trace_init();
-    }
+    oic_trace_ensure_init();
 
     if (g_trace_marker_hd > 0)
     {
@@ -209,7 +263,7 @@ void oic_trace_end()
                       len, ret, errno);
         }
     }
-    else
+    else if (FD_NOT_EXIST != g_trace_marker_hd)
     {
         OIC_LOG_V(INFO, TAG, "oic_trace_end: invalid fd: %d", g_trace_marker_hd);
     }
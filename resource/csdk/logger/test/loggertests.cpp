@@ -36,6 +36,11 @@ extern "C" {
 
 #include <iostream>
 #include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 using namespace std;
 
 
@@ -364,3 +369,167 @@ TEST(LoggerTest, LogBuffer) {
         EXPECT_STREQ(stdFileMD5, testFileMD5);
     }
 }
+
+//-----------------------------------------------------------------------------
+// Capture of the messages written through a custom log context, used to compare
+// the output of asynchronous logging with the output of synchronous logging.
+//-----------------------------------------------------------------------------
+static std::mutex g_captureMutex;
+static std::condition_variable g_captureCond;
+static std::vector<std::string> g_captured;
+static bool g_captureBlocked = false;
+
+static size_t CaptureWriteLevel(oc_log_ctx_t *, const int level, const char *logStr) {
+    std::unique_lock<std::mutex> lock(g_captureMutex);
+    g_captureCond.wait(lock, [] { return !g_captureBlocked; });
+    g_captured.push_back(std::to_string(level) + ": " + logStr);
+    g_captureCond.notify_all();
+    return strlen(logStr);
+}
+
+static void SetCaptureBlocked(bool blocked) {
+    std::lock_guard<std::mutex> lock(g_captureMutex);
+    g_captureBlocked = blocked;
+    g_captureCond.notify_all();
+}
+
+static size_t GetCapturedCount() {
+    std::lock_guard<std::mutex> lock(g_captureMutex);
+    return g_captured.size();
+}
+
+static void WaitForCapturedCount(size_t count) {
+    std::unique_lock<std::mutex> lock(g_captureMutex);
+    g_captureCond.wait_for(lock, std::chrono::seconds(5),
+                           [count] { return g_captured.size() >= count; });
+}
+
+// Runs logFunc on a new thread, so that it gets a new ring of ringSize bytes when
+// logging asynchronously, and returns the messages it wrote.
+static std::vector<std::string> CaptureLog(void (*logFunc)(), bool async, size_t ringSize = 0) {
+    oc_log_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.write_level = CaptureWriteLevel;
+    {
+        std::lock_guard<std::mutex> lock(g_captureMutex);
+        g_captured.clear();
+    }
+    OCLogConfig(&ctx);
+    if (async) {
+        EXPECT_TRUE(OCLogStartAsync(ringSize));
+    }
+    std::thread logger(logFunc);
+    logger.join();
+    if (async) {
+        OCLogStopAsync();
+    }
+    OCLogConfig(NULL);
+
+    std::lock_guard<std::mutex> lock(g_captureMutex);
+    return g_captured;
+}
+
+static void LogFormats() {
+    const char *tag = "AsyncFormats";
+    const char *nullString = NULL;
+    char stackString[] = "on the stack";
+    OCLogv(INFO, tag, "string: %s", stackString);
+    OCLogv(INFO, tag, "null string: %s", nullString);
+    OCLogv(INFO, tag, "precision: %.*s|", 3, "abcdef");
+    OCLogv(INFO, tag, "width: %*d|%-*d|", 6, 42, 4, -7);
+    OCLogv(INFO, tag, "long long: %lld %llu", -1234567890123LL, 1234567890123ULL);
+    OCLogv(INFO, tag, "size: %zu", (size_t)4096);
+    OCLogv(INFO, tag, "pointer: %p", (void *)0x1234);
+    OCLogv(INFO, tag, "percent: 100%%");
+    OCLogv(INFO, tag, "positional: %2$s %1$s", "world", "hello");
+    OCLogv(INFO, tag, "wide: %ls", L"wide");
+    OCLog(WARNING, tag, "plain string");
+}
+
+TEST(LoggerTest, AsyncFormatsMatchSync) {
+    std::vector<std::string> sync = CaptureLog(LogFormats, false);
+    std::vector<std::string> async = CaptureLog(LogFormats, true);
+    EXPECT_EQ(11u, sync.size());
+    EXPECT_EQ(sync, async);
+}
+
+static void LogWrapping() {
+    // Records of varying size, so that some of them don't fit at the end of the ring
+    // and a padding record is inserted before they wrap to its start.
+    std::string text(300, 'x');
+    for (int i = 0; i < 100; i++) {
+        size_t count = GetCapturedCount();
+        OCLogv(INFO, "AsyncWrap", "message %d %.*s", i, 37 + (i * 53) % 250, text.c_str());
+        // Wait for each message, so that none is dropped when the ring is full.
+        WaitForCapturedCount(count + 1);
+    }
+}
+
+TEST(LoggerTest, AsyncRingWrap) {
+    std::vector<std::string> sync = CaptureLog(LogWrapping, false);
+    uint64_t dropped = OCLogGetDroppedCount();
+    std::vector<std::string> async = CaptureLog(LogWrapping, true, 4096);
+    EXPECT_EQ(100u, sync.size());
+    EXPECT_EQ(sync, async);
+    EXPECT_EQ(dropped, OCLogGetDroppedCount());
+}
+
+static const int NUM_OVERFLOW_MESSAGES = 1000;
+
+static void LogOverflow() {
+    std::string text(200, 'y');
+    // The logger thread blocks while writing the first message, so the ring fills up.
+    for (int i = 0; i < NUM_OVERFLOW_MESSAGES; i++) {
+        OCLogv(INFO, "AsyncOverflow", "message %d %s", i, text.c_str());
+    }
+    SetCaptureBlocked(false);
+}
+
+TEST(LoggerTest, AsyncDropsCounted) {
+    uint64_t dropped = OCLogGetDroppedCount();
+    SetCaptureBlocked(true);
+    std::vector<std::string> async = CaptureLog(LogOverflow, true, 4096);
+    SetCaptureBlocked(false);
+    dropped = OCLogGetDroppedCount() - dropped;
+
+    size_t written = 0;
+    size_t dropReports = 0;
+    for (const std::string &message : async) {
+        if (std::string::npos != message.find("log messages dropped")) {
+            dropReports++;
+        } else {
+            written++;
+        }
+    }
+    EXPECT_LT(0u, dropped);
+    EXPECT_LT(0u, dropReports);
+    EXPECT_EQ((uint64_t)NUM_OVERFLOW_MESSAGES, written + dropped);
+}
+
+static void LogTagLevels() {
+    OCSetLogLevel(INFO, false);
+    OCLog(DEBUG, "TagA", "hidden by the global level");
+    EXPECT_TRUE(OCSetLogLevelForTag("TagA", DEBUG));
+    OCLog(DEBUG, "TagA", "shown by the tag level");
+    OCLog(DEBUG, "TagB", "hidden for another tag");
+    EXPECT_TRUE(OCSetLogLevelForTag("TagB", ERROR));
+    OCLog(WARNING, "TagB", "hidden by the tag level");
+    OCLog(ERROR, "TagB", "shown at the tag level");
+    OCClearLogLevelForTag("TagA");
+    OCLog(DEBUG, "TagA", "hidden again");
+    OCLog(INFO, "TagA", "shown by the global level");
+    OCClearLogLevelForTag("TagB");
+    OCLog(WARNING, "TagB", "shown by the global level");
+    OCSetLogLevel(DEBUG, false);
+}
+
+TEST(LoggerTest, LogLevelForTag) {
+    std::vector<std::string> expected;
+    expected.push_back(std::to_string(OC_LOG_DEBUG) + ": shown by the tag level");
+    expected.push_back(std::to_string(OC_LOG_ERROR) + ": shown at the tag level");
+    expected.push_back(std::to_string(OC_LOG_INFO) + ": shown by the global level");
+    expected.push_back(std::to_string(OC_LOG_WARNING) + ": shown by the global level");
+
+    EXPECT_EQ(expected, CaptureLog(LogTagLevels, false));
+    EXPECT_EQ(expected, CaptureLog(LogTagLevels, true));
+}
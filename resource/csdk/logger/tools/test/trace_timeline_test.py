@@ -0,0 +1,76 @@
+#!/usr/bin/env python
+#
+# Copyright 2017 Microsoft
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Checks trace_timeline.py against the trace in trace.txt.
+
+trace.txt holds a server request followed across two threads, a client request
+with a uri mark, a span without a token, and the partial spans found at both
+ends of a capture. std_timeline.txt and std_summary.txt hold the expected output.
+
+Usage: trace_timeline_test.py
+"""
+
+import os
+import subprocess
+import sys
+import unittest
+
+TEST_DIR = os.path.dirname(os.path.abspath(__file__))
+TOOL = os.path.join(TEST_DIR, os.pardir, 'trace_timeline.py')
+TRACE = os.path.join(TEST_DIR, 'trace.txt')
+
+sys.path.insert(0, os.path.join(TEST_DIR, os.pardir))
+import trace_timeline
+
+
+def run_tool(*args):
+    output = subprocess.check_output([sys.executable, TOOL] + list(args))
+    return output.decode('utf-8')
+
+
+def read_expected(name):
+    with open(os.path.join(TEST_DIR, name)) as expected:
+        return expected.read()
+
+
+class TraceTimelineTest(unittest.TestCase):
+    def test_timeline(self):
+        self.assertEqual(read_expected('std_timeline.txt'), run_tool(TRACE))
+
+    def test_timeline_from_stdin(self):
+        with open(TRACE) as trace:
+            output = subprocess.check_output([sys.executable, TOOL], stdin=trace)
+        self.assertEqual(read_expected('std_timeline.txt'), output.decode('utf-8'))
+
+    def test_token_filter(self):
+        output = run_tool('--token', 'FF', TRACE)
+        self.assertTrue(output.startswith('token ff00  0.400 ms  /oic/res\n'))
+        self.assertNotIn('0a1b', output)
+
+    def test_summary(self):
+        self.assertEqual(read_expected('std_summary.txt'), run_tool('--summary', TRACE))
+
+    def test_perf_script_record(self):
+        line = ('ocserver  1202 [001]   100.000300: ftrace:print: ip=0xffffffff81234567 '
+                'buf=B| 1200|OIC:OIC_RI_RESOURCE:ProcessRequest')
+        self.assertEqual((1202, 100.0003, 'B| 1200|OIC:OIC_RI_RESOURCE:ProcessRequest'),
+                         trace_timeline.parse_record(line))
+        self.assertEqual((1202, 100.0004, 'E'), trace_timeline.parse_record(
+            'ocserver  1202 [001]   100.000400: ftrace:print: ip=0xffffffff81234567 buf=E'))
+
+
+if __name__ == '__main__':
+    unittest.main()
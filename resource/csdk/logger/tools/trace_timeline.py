@@ -0,0 +1,215 @@
+#!/usr/bin/env python
+#
+# Copyright 2017 Microsoft
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Rebuild per request timelines from IoTivity trace_marker records.
+
+The stack writes "B|pid|OIC:<tag>:<stage>" and "E" records when it is built with
+OIC_SUPPORT_LINUX_TRACE=True (or for Android). Capture them with one of:
+
+    trace-cmd record -e ftrace:print <app>; trace-cmd report > trace.txt
+    perf record -e ftrace:print -a -- <app>; perf script > trace.txt
+    cat /sys/kernel/tracing/trace > trace.txt
+
+Spans are nested per thread. Stages that know the CoAP token of the message
+they handle write a "...:token:<hex>" mark inside their span; every other span
+takes the token of its first descendant with one, or else of its parent. The
+spans are then grouped by token, so a request is followed from the network
+thread through the receive queue, the entity handler and the send queue.
+
+Observe notifications reuse the token of the observe request, so all the
+notifications of one observation are listed under the same token.
+
+Usage: trace_timeline.py [--summary] [--token HEX] [trace.txt]
+"""
+
+from __future__ import print_function
+
+import argparse
+import re
+import sys
+
+# ftrace and trace-cmd: "<comm>-<tid> [cpu] <flags> <ts>: <event>: <record>"
+FTRACE_LINE = re.compile(r'^\s*(?P<comm>.*?)-(?P<tid>\d+)\s+(?:\(\s*[\d-]+\)\s+)?'
+                         r'\[\d+\]\s+(?:\S+\s+)?(?P<ts>\d+\.\d+):\s*(?P<rest>.*)$')
+# perf script: "<comm> <tid> [cpu] <ts>: ftrace:print: ip=... buf=<record>"
+PERF_LINE = re.compile(r'^\s*(?P<comm>\S.*?)\s+(?P<tid>\d+)\s+\[\d+\]\s+'
+                       r'(?P<ts>\d+\.\d+):\s*(?P<rest>.*)$')
+RECORD = re.compile(r'(?:tracing_mark_write|print):\s*(?:.*?buf=)?'
+                    r'(?P<record>B\|\s*\d+\|.*|E(?:\|.*)?)\s*$')
+TOKEN_MARK = re.compile(r':token::?(?P<token>[0-9a-fA-F]*)$')
+URI_MARK = re.compile(r':uri:(?P<uri>.*)$')
+
+
+class Span(object):
+    def __init__(self, name, tid, start):
+        self.name = name
+        self.tid = tid
+        self.start = start
+        self.end = None
+        self.depth = 0
+        self.token = None
+        self.uri = None
+        self.children = []
+
+    @property
+    def duration(self):
+        return self.end - self.start
+
+
+def parse_record(line):
+    """Returns (tid, timestamp in seconds, record) or None."""
+    match = FTRACE_LINE.match(line) or PERF_LINE.match(line)
+    if not match:
+        return None
+    record = RECORD.search(match.group('rest'))
+    if not record:
+        return None
+    return int(match.group('tid')), float(match.group('ts')), record.group('record')
+
+
+def read_spans(lines):
+    """Returns the outermost completed spans of every thread."""
+    stacks = {}
+    roots = []
+    for line in lines:
+        parsed = parse_record(line)
+        if not parsed:
+            continue
+        tid, ts, record = parsed
+        stack = stacks.setdefault(tid, [])
+        if record.startswith('B'):
+            name = record.split('|', 2)[2]
+            if name.startswith('OIC:'):
+                name = name[len('OIC:'):]
+            span = Span(name, tid, ts)
+            span.depth = len(stack)
+            stack.append(span)
+            continue
+        if not stack:
+            # The trace started inside this span.
+            continue
+        span = stack.pop()
+        span.end = ts
+        parent = stack[-1] if stack else None
+        token = TOKEN_MARK.search(span.name)
+        uri = URI_MARK.search(span.name)
+        if token or uri:
+            # Marks annotate the enclosing span instead of being stages.
+            if parent and token and parent.token is None:
+                parent.token = token.group('token').lower()
+            if parent and uri and parent.uri is None:
+                parent.uri = uri.group('uri')
+            continue
+        if parent:
+            parent.children.append(span)
+        else:
+            roots.append(span)
+    return roots
+
+
+def assign_tokens(span):
+    """Gives each span its own token or that of its first descendant with one."""
+    for child in span.children:
+        assign_tokens(child)
+        if span.token is None and child.token is not None:
+            span.token = child.token
+
+
+def inherit_tokens(span):
+    """Gives spans without a token the token of their parent."""
+    for child in span.children:
+        if child.token is None:
+            child.token = span.token
+        inherit_tokens(child)
+
+
+def walk(span):
+    yield span
+    for child in span.children:
+        for descendant in walk(child):
+            yield descendant
+
+
+def percentile(values, pct):
+    index = int(round((len(values) - 1) * pct / 100.0))
+    return values[index]
+
+
+def print_timelines(spans, token_filter):
+    by_token = {}
+    for span in spans:
+        if span.token:
+            by_token.setdefault(span.token, []).append(span)
+
+    requests = sorted(by_token.items(), key=lambda item: min(s.start for s in item[1]))
+    for token, group in requests:
+        if token_filter and not token.startswith(token_filter):
+            continue
+        group.sort(key=lambda s: (s.start, s.depth))
+        first = group[0].start
+        last = max(s.end for s in group)
+        uris = sorted(set(s.uri for s in group if s.uri))
+        print(('token %s  %.3f ms  %s' % (token, (last - first) * 1e3, ' '.join(uris))).rstrip())
+        for span in group:
+            print('  +%10.1f us %10.1f us  %6d  %s%s' % ((span.start - first) * 1e6,
+                                                       span.duration * 1e6, span.tid,
+                                                       '  ' * span.depth, span.name))
+        print()
+
+
+def print_summary(spans):
+    by_stage = {}
+    for span in spans:
+        by_stage.setdefault(span.name, []).append(span.duration * 1e6)
+
+    print('%-60s %8s %10s %10s %10s %10s' % ('stage', 'count', 'mean us', 'p50 us',
+                                            'p99 us', 'max us'))
+    for stage in sorted(by_stage):
+        durations = sorted(by_stage[stage])
+        print('%-60s %8d %10.1f %10.1f %10.1f %10.1f' % (
+            stage, len(durations), sum(durations) / len(durations),
+            percentile(durations, 50), percentile(durations, 99), durations[-1]))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Rebuild per request timelines from IoTivity trace_marker records.')
+    parser.add_argument('trace', nargs='?', help='trace text, read from stdin if omitted')
+    parser.add_argument('--summary', action='store_true',
+                        help='print per stage latency statistics instead of timelines')
+    parser.add_argument('--token', help='only print requests whose token starts with TOKEN')
+    args = parser.parse_args()
+
+    if args.trace:
+        with open(args.trace) as trace:
+            roots = read_spans(trace)
+    else:
+        roots = read_spans(sys.stdin)
+
+    spans = []
+    for root in roots:
+        assign_tokens(root)
+        inherit_tokens(root)
+        spans.extend(walk(root))
+
+    if args.summary:
+        print_summary(spans)
+    else:
+        print_timelines(spans, args.token.lower() if args.token else None)
+
+
+if __name__ == '__main__':
+    main()
@@ -37,6 +37,9 @@
 
 static sqlite3 *gRDDB = NULL;
 
+/* How long to wait for the discovery connection of the stack to release its lock. */
+#define RD_BUSY_TIMEOUT_MS (1000)
+
 #define CHECK_DATABASE_INIT \
     if (!gRDDB) \
     { \
@@ -88,6 +91,16 @@ static sqlite3 *gRDDB = NULL;
     "FOREIGN KEY("XSTR(LINK_ID)") REFERENCES RD_DEVICE_LINK_LIST("XSTR(OC_RSRVD_INS)") " \
     "ON DELETE CASCADE);"
 
+/*
+ * Discovery looks links up by device and types, interfaces and endpoints by link, and the
+ * ON DELETE CASCADE clauses search the same columns.
+ */
+#define RD_INDEXES \
+    "CREATE INDEX IF NOT EXISTS RD_DEVICE_LINK_LIST_DEVICE_ID ON RD_DEVICE_LINK_LIST(DEVICE_ID);" \
+    "CREATE INDEX IF NOT EXISTS RD_LINK_RT_LINK_ID ON RD_LINK_RT(LINK_ID);" \
+    "CREATE INDEX IF NOT EXISTS RD_LINK_IF_LINK_ID ON RD_LINK_IF(LINK_ID);" \
+    "CREATE INDEX IF NOT EXISTS RD_LINK_EP_LINK_ID ON RD_LINK_EP(LINK_ID);"
+
 static void errorCallback(void *arg, int errCode, const char *errMsg)
 {
     OC_UNUSED(arg);
@@ -671,19 +684,36 @@ exit:
 
 OCStackResult OC_CALL OCRDDatabaseInit()
 {
+    const char *path = OCRDDatabaseGetStorageFilename();
+    if (!path)
+    {
+        OIC_LOG(ERROR, TAG, "RD database storage filename is not available");
+        return OC_STACK_ERROR;
+    }
+
     if (SQLITE_OK == sqlite3_config(SQLITE_CONFIG_LOG, errorCallback))
     {
         OIC_LOG_V(INFO, TAG, "SQLite debugging log initialized.");
     }
 
+    if (gRDDB)
+    {
+        /*
+         * Close the previous connection first, it may refer to a database file that has since
+         * been removed, and would otherwise leak.
+         */
+        sqlite3_close(gRDDB);
+        gRDDB = NULL;
+    }
+
     sqlite3_stmt *stmt = NULL;
     int res;
-    res = sqlite3_open_v2(OCRDDatabaseGetStorageFilename(), &gRDDB, SQLITE_OPEN_READWRITE, NULL);
+    res = sqlite3_open_v2(path, &gRDDB, SQLITE_OPEN_READWRITE, NULL);
     if (SQLITE_OK != res)
     {
         OIC_LOG(DEBUG, TAG, "RD database file did not open, as no table exists.");
         OIC_LOG(DEBUG, TAG, "RD creating new table.");
-        VERIFY_SQLITE(sqlite3_open_v2(OCRDDatabaseGetStorageFilename(), &gRDDB,
+        VERIFY_SQLITE(sqlite3_open_v2(path, &gRDDB,
                         SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL));
 
         VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_TABLE, NULL, NULL, NULL));
@@ -714,6 +744,18 @@ OCStackResult OC_CALL OCRDDatabaseInit()
         }
         VERIFY_SQLITE(sqlite3_finalize(stmt));
         stmt = NULL;
+
+        /*
+         * Write-ahead logging lets the discovery connection of the stack read while resources
+         * are published.  The journal mode is persistent so this is a no-op after the first time.
+         */
+        VERIFY_SQLITE(sqlite3_busy_timeout(gRDDB, RD_BUSY_TIMEOUT_MS));
+        if (SQLITE_OK != sqlite3_exec(gRDDB, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL))
+        {
+            OIC_LOG_V(WARNING, TAG, "Could not enable write-ahead logging: %s",
+                      sqlite3_errmsg(gRDDB));
+        }
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_INDEXES, NULL, NULL, NULL));
     }
 
 exit:
@@ -407,6 +407,60 @@ TEST_F(RDDatabaseTests, AddAndUpdateResources)
     discPayload = NULL;
 }
 
+TEST_F(RDDatabaseTests, DiscoveryFiltersByTypeAndInterface)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    const char *deviceIds[2] =
+    {
+        "7a960f46-a52e-4837-bd83-460b1a6dd56b",
+        "983656a7-c7e5-49c2-a201-edbeb7606fb5",
+    };
+    Resource resources[] = {
+        { "/a/thermostat", "x.core.r.thermostat", "x.core.if.thermostat", OC_DISCOVERABLE },
+        { "/a/light", "core.light", OC_RSRVD_INTERFACE_DEFAULT, OC_DISCOVERABLE }
+    };
+    OCRepPayload *repPayload = CreateRDPublishPayload(deviceIds[0], 0, resources, 2);
+    ASSERT_TRUE(NULL != repPayload) << "CreateRDPublishPayload failed!";
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(repPayload));
+    OCPayloadDestroy((OCPayload *)repPayload);
+    repPayload = CreateRDPublishPayload(deviceIds[1], 0, &resources[1], 1);
+    ASSERT_TRUE(NULL != repPayload) << "CreateRDPublishPayload failed!";
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(repPayload));
+    OCPayloadDestroy((OCPayload *)repPayload);
+
+    OCDiscoveryPayload *discPayload = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDiscoveryPayloadCreate("x.core.if.thermostat",
+            "x.core.r.thermostat", &discPayload));
+    ASSERT_TRUE(NULL != discPayload);
+    EXPECT_STREQ(deviceIds[0], discPayload->sid);
+    ASSERT_TRUE(NULL != discPayload->resources);
+    EXPECT_STREQ("/a/thermostat", discPayload->resources->uri);
+    EXPECT_TRUE(NULL == discPayload->resources->next);
+    EXPECT_TRUE(NULL == discPayload->next);
+    OCDiscoveryPayloadDestroy(discPayload);
+    discPayload = NULL;
+
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCRDDatabaseDiscoveryPayloadCreate("x.core.if.thermostat",
+            "core.light", &discPayload));
+    EXPECT_TRUE(NULL == discPayload);
+
+    /* Each device is reported once, with only its matching links */
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDiscoveryPayloadCreate(OC_RSRVD_INTERFACE_LL, "core.light",
+            &discPayload));
+    size_t nDevices = 0;
+    for (OCDiscoveryPayload *payload = discPayload; payload; payload = payload->next)
+    {
+        ++nDevices;
+        ASSERT_TRUE(NULL != payload->resources);
+        EXPECT_STREQ("/a/light", payload->resources->uri);
+        EXPECT_TRUE(NULL == payload->resources->next);
+        EndpointsVerify(payload->resources->eps);
+    }
+    EXPECT_EQ(2u, nDevices);
+    OCDiscoveryPayloadDestroy(discPayload);
+    discPayload = NULL;
+}
+
 TEST_F(RDDatabaseTests, DeleteResourcesDevice)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -195,7 +195,7 @@ OCStackResult RMSendResponse(const OCServerRequest *request, const OCRepPayload
     OCEntityHandlerResponse response = {.ehResult = OC_EH_OK,
                                         .payload = (OCPayload *)payload,
                                         .persistentBufferFlag = 0,
-                                        .requestHandle = (OCRequestHandle) request
+                                        .requestHandle = GetServerRequestHandle(request)
                                         };
     OIC_LOG(DEBUG, TAG, "RMSendResponse OUT");
 
@@ -37,6 +37,31 @@ typedef struct OTMContextItem {
     struct OTMContextItem* next;
 }OTMContextItem_t;
 
+/**
+ * API to create the lock of the OTMContext list, called by OCInitPM.
+ *
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult InitOTMContextList(void);
+
+/**
+ * API to free the lock of the OTMContext list, called by OCClosePM.
+ */
+void DeinitOTMContextList(void);
+
+/**
+ * API to lock the OTMContext list. The list is used by the DTLS handshake callback,
+ * which runs on a thread of the CA layer. While the lock is held, a context read with
+ * GetOTMContext is not removed, so its ownership transfer cannot complete and free it.
+ * The lock is recursive.
+ */
+void LockOTMContextList(void);
+
+/**
+ * API to unlock the OTMContext list.
+ */
+void UnlockOTMContextList(void);
+
 /**
  * API to remove OTMContext from OTMContext list.
  *
@@ -47,6 +47,27 @@ typedef struct OTMContext OTMContext_t;
 OCStackResult OTMDoOwnershipTransfer(void* ctx,
                                      OCProvisionDev_t* selectedDeviceList, OCProvisionResultCB resultCB);
 
+/**
+ * Do ownership transfer for the unowned devices, several devices at a time.
+ *
+ * The secure session of each device is set up while no other device is doing so, as the OxMs
+ * change the cipher suite and credential handlers of the CA layer. The rest of the transfer
+ * overlaps with the other devices. Devices using an OxM other than Just Works are transferred
+ * while no other device is.
+ *
+ * @param[in] ctx Application context would be returned in result callback
+ * @param[in] selectedDeviceList linked list of ownership transfer candidate devices.
+ * @param[in] maxSessions maximum number of devices transferred at the same time.
+ * @param[in] progressCB Callback invoked when each device is done, may be NULL.
+ * @param[in] resultCB Result callback function to be invoked when ownership transfer finished.
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OTMDoConcurrentOwnershipTransfer(void* ctx,
+                                               OCProvisionDev_t* selectedDeviceList,
+                                               size_t maxSessions,
+                                               OCProvisionProgressCB progressCB,
+                                               OCProvisionResultCB resultCB);
+
 /**
  * API to set a allow status of OxM
  *
@@ -106,6 +127,7 @@ struct OTMContext{
     OicSecCred_t* cred;                       /**< Credential data. */
 #endif // MULTIPLE_OWNER
     int attemptCnt;
+    struct OTMBatch* batch;                   /**< Devices transferred with this one, OT only. */
 };
 
 // TODO: Remove this OTMSetOwnershipTransferCallbackData, Please see the jira ticket IOT-1484
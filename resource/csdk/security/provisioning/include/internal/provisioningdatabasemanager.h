@@ -177,6 +177,28 @@ OCStackResult PDMGetToBeUnlinkedDevices(OCPairList_t** staleDevList, size_t* num
  */
 OCStackResult PDMClose();
 
+/**
+ * This method is used by provisioning manager to group the following updates of the provisioning
+ * database into one transaction, which saves a disk sync per update when many devices or links
+ * are updated at once. Each update stays atomic on its own. Batches can be nested.
+ *
+ * @see PDMEndBatch()
+ *
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult PDMBeginBatch();
+
+/**
+ * This method is used by provisioning manager to end the batch started by the last call of
+ * PDMBeginBatch(). Changes of a nested batch are only written once the outermost batch is
+ * committed. When committing fails, the updates of the batch are undone.
+ *
+ * @param[in] commitChanges true to keep the updates of the batch, false to undo them.
+ *
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult PDMEndBatch(bool commitChanges);
+
 /**
  * This method is used by provisioning manager free memory allocated to OCUuidList_t lists.
  *
@@ -118,6 +118,26 @@ OCStackResult OC_CALL OCDoOwnershipTransfer(void* ctx,
                                     OCProvisionDev_t *targetDevices,
                                     OCProvisionResultCB resultCallback);
 
+/**
+ * Do ownership transfer for un-owned devices, up to maxSessions devices at the same time.
+ * OCDoOwnershipTransfer is the same as this API with maxSessions 1.
+ *
+ * Only one device at a time sets up its secure session; the rest of the transfer overlaps
+ * with the other devices. Devices using an OxM other than Just Works are transferred alone.
+ *
+ * @param[in] ctx Application context would be returned in result callback
+ * @param[in] targetDevices List of devices to perform ownership transfer.
+ * @param[in] maxSessions Maximum number of devices transferred at the same time.
+ * @param[in] progressCallback Callback invoked each time a device is done, may be NULL.
+ * @param[in] resultCallback Result callback function to be invoked when ownership transfer finished.
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OC_CALL OCDoConcurrentOwnershipTransfer(void* ctx,
+                                                      OCProvisionDev_t *targetDevices,
+                                                      size_t maxSessions,
+                                                      OCProvisionProgressCB progressCallback,
+                                                      OCProvisionResultCB resultCallback);
+
 /**
  * API to set a allow status of OxM
  *
@@ -162,6 +182,55 @@ OCStackResult OC_CALL OCSetOwnerTransferCallbackData(OicSecOxm_t oxm, OTMCallbac
  */
 OCStackResult OC_CALL OCDiscoverOwnedDevices(unsigned short timeout, OCProvisionDev_t **ppList);
 
+/**
+ * The function is responsible for discovery of owned/unowned devices as configured by options.
+ * It returns as soon as options->targetId is found, options->expectedCount devices are found or
+ * no device was found for options->quietPeriodMs, and at the latest when the timeout expires.
+ * It calls OCProcess() whenever the stack receives messages, so no other thread may process the
+ * stack meanwhile.
+ *
+ * @param[in] options Options of the discovery. options->timeout must not be 0.
+ * @param[out] ppList List of found devices.
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OC_CALL OCDiscoverDevices(const OCPMDiscoveryOptions_t *options,
+                                        OCProvisionDev_t **ppList);
+
+/**
+ * The function starts a discovery of owned/unowned devices that runs while the application
+ * calls OCProcess(). Use OCIsDeviceDiscoveryDone to check whether it is done, and
+ * OCFinishDeviceDiscovery to get the found devices.
+ *
+ * @param[in] options Options of the discovery, see OCDiscoverDevices.
+ * @param[out] ppDiscovery Started discovery.
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OC_CALL OCStartDeviceDiscovery(const OCPMDiscoveryOptions_t *options,
+                                             OCPMDiscovery_t **ppDiscovery);
+
+/**
+ * The function checks whether a discovery started by OCStartDeviceDiscovery is done. It must be
+ * called from the thread calling OCProcess().
+ *
+ * @param[in] pDiscovery Started discovery.
+ * @param[out] waitMs Milliseconds until the discovery is done unless more responses arrive, set
+ *                    when false is returned. Applications can wait this long, bounded by
+ *                    their OCProcess() period, on the event of OCRegisterProcessEvent. May be NULL.
+ * @return true when the discovery is done.
+ */
+bool OC_CALL OCIsDeviceDiscoveryDone(const OCPMDiscovery_t *pDiscovery, uint32_t *waitMs);
+
+/**
+ * The function stops a discovery started by OCStartDeviceDiscovery and frees it, also when
+ * it fails because *ppList is not empty; the found devices are discarded then.
+ *
+ * @param[in] pDiscovery Started discovery.
+ * @param[out] ppList List of found devices, or NULL to discard them. *ppList must be NULL.
+ * @return OC_STACK_OK in case of success and other value otherwise.
+ */
+OCStackResult OC_CALL OCFinishDeviceDiscovery(OCPMDiscovery_t *pDiscovery,
+                                              OCProvisionDev_t **ppList);
+
 #ifdef MULTIPLE_OWNER
 /**
  * The function is responsible for the discovery of an MOT-enabled device with the specified deviceID.
@@ -134,6 +134,25 @@ typedef enum OxmAllowTableIdx {
     OXM_IDX_UNKNOWN
 }OxmAllowTableIdx_t;
 
+/**
+ * Options of an asynchronous device discovery.
+ */
+typedef struct OCPMDiscoveryOptions
+{
+    unsigned short      timeout;        /**< Timeout in seconds **/
+    bool                isOwned;        /**< discover owned devices instead of unowned ones **/
+    const OicUuid_t     *targetId;      /**< only discover this device, or NULL. isOwned is ignored **/
+    const char          *hostAddress;   /**< send the discovery to this host, or NULL to multicast it **/
+    OCConnectivityType  connType;       /**< connectivity type of the discovery **/
+    size_t              expectedCount;  /**< finish once this many devices are found, or 0 **/
+    uint32_t            quietPeriodMs;  /**< finish once no device was found for this long, or 0 **/
+} OCPMDiscoveryOptions_t;
+
+/**
+ * Device discovery started by OCStartDeviceDiscovery.
+ */
+typedef struct OCPMDiscovery OCPMDiscovery_t;
+
 /**
  * Callback function definition of provisioning API
  *
@@ -145,6 +164,19 @@ typedef enum OxmAllowTableIdx {
  */
 typedef void (*OCProvisionResultCB)(void* ctx, size_t nOfRes, OCProvisionResult_t *arr, bool hasError);
 
+/**
+ * Callback function definition of the progress of a provisioning API with several target devices
+ *
+ * @param[in] ctx - If user set his/her context, it will be returned here.
+ * @param[in] res - Result of the target device that has just finished.
+ * @param[in] nOfDone - number of target devices finished so far.
+ * @param[in] nOfDevices - total number of target devices.
+ * @param[in] nOfInProgress - number of target devices in progress when this one finished,
+ *                            including this one.
+ */
+typedef void (*OCProvisionProgressCB)(void* ctx, const OCProvisionResult_t *res,
+                                      size_t nOfDone, size_t nOfDevices, size_t nOfInProgress);
+
 /**
  * Callback function definition of CSR retrieve API
  *
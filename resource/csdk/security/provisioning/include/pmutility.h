@@ -84,6 +84,60 @@ OCStackResult PMSingleDeviceDiscoveryInUnicast(unsigned short waittime, const Oi
  */
 OCStackResult PMDeviceDiscovery(unsigned short waittime, bool isOwned, OCProvisionDev_t **ppList);
 
+/**
+ * Start an owned/unowned device discovery that runs while the caller calls OCProcess().
+ * The discovery is done when options->targetId is found, when options->expectedCount devices
+ * are found, when no device was found for options->quietPeriodMs or when the timeout expires.
+ *
+ * @param[in] options       Options of the discovery.
+ * @param[out] ppDiscovery  Started discovery. It must be passed to PMFinishDeviceDiscovery.
+ *
+ * @return OC_STACK_OK on success otherwise error.
+ */
+OCStackResult PMStartDeviceDiscovery(const OCPMDiscoveryOptions_t *options,
+                                     OCPMDiscovery_t **ppDiscovery);
+
+/**
+ * Check whether a device discovery is done. It must be called from the thread calling
+ * OCProcess().
+ *
+ * @param[in] pDiscovery    Discovery started by PMStartDeviceDiscovery.
+ * @param[out] waitMs       Time in milliseconds after which the discovery is done unless new
+ *                          responses arrive. It is set when false is returned. May be NULL.
+ *
+ * @return true when the discovery is done.
+ */
+bool PMIsDeviceDiscoveryDone(const OCPMDiscovery_t *pDiscovery, uint32_t *waitMs);
+
+/**
+ * Call OCProcess() until a device discovery is done. Between calls it waits for the stack to
+ * receive messages on an event registered with OCRegisterProcessEvent(), which is
+ * unregistered before returning, so no other thread may be processing the stack.
+ *
+ * @param[in] pDiscovery    Discovery started by PMStartDeviceDiscovery.
+ *
+ * @return OC_STACK_OK on success otherwise error.
+ */
+OCStackResult PMWaitForDeviceDiscovery(OCPMDiscovery_t *pDiscovery);
+
+/**
+ * Stop a device discovery and free it.
+ *
+ * @param[in] pDiscovery    Discovery started by PMStartDeviceDiscovery.
+ * @param[out] ppList       List the found devices are appended to, or NULL to delete them.
+ */
+void PMFinishDeviceDiscovery(OCPMDiscovery_t *pDiscovery, OCProvisionDev_t **ppList);
+
+/**
+ * Discover owned/unowned devices and return when the discovery is done.
+ *
+ * @param[in] options       Options of the discovery.
+ * @param[out] ppList       List of found devices.
+ *
+ * @return OC_STACK_OK on success otherwise error.
+ */
+OCStackResult PMDiscoverDevices(const OCPMDiscoveryOptions_t *options, OCProvisionDev_t **ppList);
+
 #ifdef MULTIPLE_OWNER
 /**
  * The function is responsible for the discovery of an MOT-enabled device with the specified deviceID.
@@ -137,7 +191,8 @@ void PMDeleteDeviceList(OCProvisionDev_t *pList);
  * we should wait a certain period of time for getting response of each devices.
  *
  * @param[in]  waittime  Timeout in seconds.
- * @param[in]  waitForStackResponse if true timeout function will call OCProcess while waiting.
+ * @param[in]  waitForStackResponse if true timeout function will call OCProcess whenever the
+ *                                  stack receives messages while waiting.
  * @return OC_STACK_OK on success otherwise error.
  */
 OCStackResult PMTimeout(unsigned short waittime, bool waitForStackResponse);
@@ -0,0 +1,217 @@
+/* *****************************************************************
+ *
+ * Copyright 2017 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * *****************************************************************/
+
+/*
+ * Benchmark of the provisioning database manager on a large database. It adds the given
+ * number of devices, links each device to the next one, reads the linked devices of every
+ * device and marks all the links stale, once with every update in its own transaction and
+ * once with the updates grouped by PDMBeginBatch() and PDMEndBatch(). Build the stack
+ * with RELEASE=1, otherwise the debug logs of every operation dominate the results.
+ */
+
+#include "iotivity_config.h"
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ocstack.h"
+#include "pmtypes.h"
+#include "provisioningdatabasemanager.h"
+
+#define DEFAULT_NUM_OF_DEVICES (10000)
+#define BENCHMARK_DB_FILE "pdm_benchmark.db"
+
+static void PrintUsage()
+{
+    printf("Usage : pdm_benchmark -n <number of devices>\n");
+}
+
+static double GetElapsedMs(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static void PrintResult(const char *name, bool batched, int numOfOps,
+                        const struct timespec *start)
+{
+    double elapsed = GetElapsedMs(start);
+    printf("%-14s %-8s %10.1f ms %12.1f op/s\n", name, batched ? "batched" : "single",
+           elapsed, numOfOps * 1000.0 / elapsed);
+}
+
+static void GetDeviceId(int index, OicUuid_t *uuid)
+{
+    memset(uuid->id, 0x5a, sizeof(uuid->id));
+    memcpy(uuid->id, &index, sizeof(index));
+}
+
+static void RemoveDatabase()
+{
+    remove(BENCHMARK_DB_FILE);
+    remove(BENCHMARK_DB_FILE "-wal");
+    remove(BENCHMARK_DB_FILE "-shm");
+}
+
+static bool BeginBatch(bool batched)
+{
+    return !batched || (OC_STACK_OK == PDMBeginBatch());
+}
+
+static bool EndBatch(bool batched)
+{
+    return !batched || (OC_STACK_OK == PDMEndBatch(true));
+}
+
+static int RunBenchmark(int numOfDevices, bool batched)
+{
+    struct timespec start;
+    OicUuid_t uuid1;
+    OicUuid_t uuid2;
+
+    RemoveDatabase();
+    if (OC_STACK_OK != PDMInit(BENCHMARK_DB_FILE))
+    {
+        printf("PDMInit failed\n");
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (!BeginBatch(batched))
+    {
+        goto error;
+    }
+    for (int i = 0; i < numOfDevices; i++)
+    {
+        GetDeviceId(i, &uuid1);
+        if (OC_STACK_OK != PDMAddDevice(&uuid1) ||
+            OC_STACK_OK != PDMSetDeviceState(&uuid1, PDM_DEVICE_ACTIVE))
+        {
+            printf("Adding device %d failed\n", i);
+            goto error;
+        }
+    }
+    if (!EndBatch(batched))
+    {
+        goto error;
+    }
+    PrintResult("add device", batched, numOfDevices, &start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (!BeginBatch(batched))
+    {
+        goto error;
+    }
+    for (int i = 0; i + 1 < numOfDevices; i++)
+    {
+        GetDeviceId(i, &uuid1);
+        GetDeviceId(i + 1, &uuid2);
+        if (OC_STACK_OK != PDMLinkDevices(&uuid1, &uuid2))
+        {
+            printf("Linking device %d failed\n", i);
+            goto error;
+        }
+    }
+    if (!EndBatch(batched))
+    {
+        goto error;
+    }
+    PrintResult("link devices", batched, numOfDevices - 1, &start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < numOfDevices; i++)
+    {
+        OCUuidList_t *list = NULL;
+        size_t numOfLinked = 0;
+        GetDeviceId(i, &uuid1);
+        if (OC_STACK_OK != PDMGetLinkedDevices(&uuid1, &list, &numOfLinked))
+        {
+            printf("Getting linked devices of device %d failed\n", i);
+            goto error;
+        }
+        PDMDestoryOicUuidLinkList(list);
+    }
+    PrintResult("linked devices", batched, numOfDevices, &start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (!BeginBatch(batched))
+    {
+        goto error;
+    }
+    for (int i = 0; i + 1 < numOfDevices; i++)
+    {
+        GetDeviceId(i, &uuid1);
+        GetDeviceId(i + 1, &uuid2);
+        if (OC_STACK_OK != PDMSetLinkStale(&uuid1, &uuid2))
+        {
+            printf("Marking link %d stale failed\n", i);
+            goto error;
+        }
+    }
+    if (!EndBatch(batched))
+    {
+        goto error;
+    }
+    PrintResult("set link stale", batched, numOfDevices - 1, &start);
+
+    PDMClose();
+    RemoveDatabase();
+    return 0;
+
+error:
+    printf("Benchmark failed\n");
+    PDMClose();
+    RemoveDatabase();
+    return -1;
+}
+
+int main(int argc, char* argv[])
+{
+    int numOfDevices = DEFAULT_NUM_OF_DEVICES;
+    int opt = 0;
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                numOfDevices = atoi(optarg);
+                break;
+            default:
+                PrintUsage();
+                return -1;
+        }
+    }
+
+    if (numOfDevices <= 1)
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    int ret = 0;
+    ret |= RunBenchmark(numOfDevices, false);
+    ret |= RunBenchmark(numOfDevices, true);
+    return ret ? -1 : 0;
+}
@@ -36,6 +36,7 @@
 #include "aclresource.h" //Note: SRM internal header
 #include "psinterface.h"
 #include "ocstackinternal.h"
+#include "otmcontextlist.h"
 
 #define TAG "OIC_OCPMAPI"
 
@@ -78,6 +79,11 @@ struct ProvPreconfPINCtx
  */
 OCStackResult OC_CALL OCInitPM(const char* dbPath)
 {
+    OCStackResult res = InitOTMContextList();
+    if (OC_STACK_OK != res)
+    {
+        return res;
+    }
     return PDMInit(dbPath);
 }
 
@@ -90,6 +96,7 @@ OCStackResult OC_CALL OCInitPM(const char* dbPath)
  */
 OCStackResult OC_CALL OCClosePM()
 {
+    DeinitOTMContextList();
     return PDMClose();
 }
 
@@ -185,6 +192,52 @@ OCStackResult OC_CALL OCDiscoverOwnedDevices(unsigned short timeout, OCProvision
     return PMDeviceDiscovery(timeout, true, ppList);
 }
 
+OCStackResult OC_CALL OCDiscoverDevices(const OCPMDiscoveryOptions_t *options,
+                                        OCProvisionDev_t **ppList)
+{
+    if (NULL == options || 0 == options->timeout || NULL == ppList || NULL != *ppList)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    return PMDiscoverDevices(options, ppList);
+}
+
+OCStackResult OC_CALL OCStartDeviceDiscovery(const OCPMDiscoveryOptions_t *options,
+                                             OCPMDiscovery_t **ppDiscovery)
+{
+    if (NULL == options || 0 == options->timeout || NULL == ppDiscovery)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    return PMStartDeviceDiscovery(options, ppDiscovery);
+}
+
+bool OC_CALL OCIsDeviceDiscoveryDone(const OCPMDiscovery_t *pDiscovery, uint32_t *waitMs)
+{
+    return PMIsDeviceDiscoveryDone(pDiscovery, waitMs);
+}
+
+OCStackResult OC_CALL OCFinishDeviceDiscovery(OCPMDiscovery_t *pDiscovery,
+                                              OCProvisionDev_t **ppList)
+{
+    if (NULL == pDiscovery)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    // The discovery is finished in any case, so that its callbacks are removed.
+    if (NULL != ppList && NULL != *ppList)
+    {
+        PMFinishDeviceDiscovery(pDiscovery, NULL);
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    PMFinishDeviceDiscovery(pDiscovery, ppList);
+    return OC_STACK_OK;
+}
+
 #ifdef MULTIPLE_OWNER
 /**
  * The function is responsible for the discovery of an MOT-enabled device with the specified deviceID.
@@ -341,6 +394,25 @@ OCStackResult OC_CALL OCDoOwnershipTransfer(void* ctx,
     return OTMDoOwnershipTransfer(ctx, targetDevices, resultCallback);
 }
 
+OCStackResult OC_CALL OCDoConcurrentOwnershipTransfer(void* ctx,
+                                                      OCProvisionDev_t *targetDevices,
+                                                      size_t maxSessions,
+                                                      OCProvisionProgressCB progressCallback,
+                                                      OCProvisionResultCB resultCallback)
+{
+    if (NULL == targetDevices || 0 == maxSessions)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+    if (!resultCallback)
+    {
+        OIC_LOG(INFO, TAG, "OCDoConcurrentOwnershipTransfer : NULL Callback");
+        return OC_STACK_INVALID_CALLBACK;
+    }
+    return OTMDoConcurrentOwnershipTransfer(ctx, targetDevices, maxSessions,
+                                            progressCallback, resultCallback);
+}
+
 /**
  * This function deletes memory allocated to linked list created by OCDiscover_XXX_Devices API.
  *
@@ -1330,6 +1402,8 @@ OCStackResult OC_CALL OCGetDevInfoFromNetwork(unsigned short waittime,
 
     // Code to compare devices in unowned list and deviceid from DB
     // (In case of hard reset of the device)
+    // The devices are removed from PDM in one transaction.
+    bool pdmBatch = (OC_STACK_OK == PDMBeginBatch());
     OCProvisionDev_t* pUnownedList = unownedDevice;
     while (pUnownedList && uuidList)
     {
@@ -1358,6 +1432,10 @@ OCStackResult OC_CALL OCGetDevInfoFromNetwork(unsigned short waittime,
         }
         pUnownedList = pUnownedList->next;
     }
+    if (pdmBatch && OC_STACK_OK != PDMEndBatch(true))
+    {
+        OIC_LOG(ERROR, TAG, "OCGetDevInfoFromNetwork : Failed to remove devices in PDM.");
+    }
     // Code to compare devices in owned list and deviceid from DB.
     OCProvisionDev_t* pCurDev = ownedDevice;
     size_t deleteCnt = 0;
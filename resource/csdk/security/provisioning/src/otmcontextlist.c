@@ -24,6 +24,7 @@
 #include "octypes.h"
 #include "ownershiptransfermanager.h"
 #include "utlist.h"
+#include "octhread.h"
 #include "otmcontextlist.h"
 
 #define TAG "OIC_OTM_CTX"
@@ -33,6 +34,42 @@
  */
 static OTMContextItem_t* g_otmCtxList = NULL;
 
+/**
+ * Lock of g_otmCtxList. Recursive, since the DTLS handshake callback holds it while
+ * the ownership transfer it continues may complete and remove its context.
+ */
+static oc_mutex g_otmCtxListMutex = NULL;
+
+OCStackResult InitOTMContextList(void)
+{
+    if (NULL == g_otmCtxListMutex)
+    {
+        g_otmCtxListMutex = oc_mutex_new_recursive();
+        if (NULL == g_otmCtxListMutex)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to create the OTMContext list mutex.");
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+    return OC_STACK_OK;
+}
+
+void DeinitOTMContextList(void)
+{
+    oc_mutex_free(g_otmCtxListMutex);
+    g_otmCtxListMutex = NULL;
+}
+
+void LockOTMContextList(void)
+{
+    oc_mutex_lock(g_otmCtxListMutex);
+}
+
+void UnlockOTMContextList(void)
+{
+    oc_mutex_unlock(g_otmCtxListMutex);
+}
+
 void RemoveOTMContext(const char* addr, uint16_t port)
 {
     OIC_LOG(DEBUG, TAG, "IN RemoveOTMContext");
@@ -42,6 +79,7 @@ void RemoveOTMContext(const char* addr, uint16_t port)
         OTMContextItem_t* item = NULL;
         OTMContextItem_t* temp = NULL;
 
+        LockOTMContextList();
         LL_FOREACH_SAFE(g_otmCtxList, item, temp)
         {
             if (strncmp(addr, item->endpoint.addr, sizeof(item->endpoint.addr)) == 0 &&
@@ -54,6 +92,7 @@ void RemoveOTMContext(const char* addr, uint16_t port)
                 break;
             }
         }
+        UnlockOTMContextList();
     }
 
     OIC_LOG(DEBUG, TAG, "OUT RemoveOTMContext");
@@ -72,6 +111,7 @@ OCStackResult AddOTMContext(OTMContext_t* ctx, const char* addr, uint16_t port)
         return OC_STACK_INVALID_PARAM;
     }
 
+    LockOTMContextList();
     LL_FOREACH_SAFE(g_otmCtxList, item, temp)
     {
             if (strncmp(addr, item->endpoint.addr, sizeof(item->endpoint.addr)) == 0 &&
@@ -79,6 +119,7 @@ OCStackResult AddOTMContext(OTMContext_t* ctx, const char* addr, uint16_t port)
             {
                 //if OTM Context already exists, just return OC_STACK_OK.
                 OIC_LOG(DEBUG, TAG, "Same OTMContext already exists.");
+                UnlockOTMContextList();
                 return OC_STACK_OK;
             }
     }
@@ -87,6 +128,7 @@ OCStackResult AddOTMContext(OTMContext_t* ctx, const char* addr, uint16_t port)
     if (NULL == newItem)
     {
         OIC_LOG(ERROR, TAG, "Failed to allocate memory.");
+        UnlockOTMContextList();
         return OC_STACK_NO_MEMORY;
     }
 
@@ -96,6 +138,7 @@ OCStackResult AddOTMContext(OTMContext_t* ctx, const char* addr, uint16_t port)
     OICStrcpy(newItem->endpoint.addr, sizeof(newItem->endpoint.addr), addr);
     newItem->endpoint.port = port;
     LL_APPEND(g_otmCtxList, newItem);
+    UnlockOTMContextList();
 
     OIC_LOG(DEBUG, TAG, "OUT AddOTMContext");
 
@@ -104,6 +147,8 @@ OCStackResult AddOTMContext(OTMContext_t* ctx, const char* addr, uint16_t port)
 
 OTMContext_t* GetOTMContext(const char* addr, uint16_t port)
 {
+    OTMContext_t* otmCtx = NULL;
+
     OIC_LOG(DEBUG, TAG, "IN GetOTMContext");
 
     if (NULL != addr && 0 != port)
@@ -111,19 +156,21 @@ OTMContext_t* GetOTMContext(const char* addr, uint16_t port)
         OTMContextItem_t* item = NULL;
         OTMContextItem_t* temp = NULL;
 
+        LockOTMContextList();
         LL_FOREACH_SAFE(g_otmCtxList, item, temp)
         {
             if (strncmp(addr, item->endpoint.addr, sizeof(item->endpoint.addr)) == 0 &&
                port == item->endpoint.port)
             {
                 OIC_LOG_V(DEBUG, TAG, "Found the OTMContext for [%s:%d]", addr, port);
-                return item->otmCtx;
+                otmCtx = item->otmCtx;
+                break;
             }
         }
+        UnlockOTMContextList();
     }
 
     OIC_LOG(DEBUG, TAG, "OUT GetOTMContext");
 
-    return NULL;
+    return otmCtx;
 }
-
@@ -76,6 +76,7 @@
 #include "psinterface.h"
 #include "ocstackinternal.h"
 #include "deviceonboardingstate.h"
+#include "octhread.h"
 
 #define TAG "OIC_OTM"
 
@@ -96,6 +97,30 @@ static uint8_t g_OxmAllowStatus[OXM_IDX_COUNT] = {ALLOWED_OXM, ALLOWED_OXM, ALLO
                                                   ALLOWED_OXM, ALLOWED_OXM, NOT_ALLOWED_OXM};
 #endif
 
+/**
+ * Devices of one ownership transfer request.
+ * Each device has its own OTMContext_t, up to maxSessions of them are in progress at once.
+ * Only the device holding setupOwner may set up a secure session, since the OxMs change
+ * the cipher suite and credential handlers of the CA layer for all sessions.
+ */
+typedef struct OTMBatch
+{
+    void* userCtx;                            /**< Context for user. */
+    OCProvisionResultCB resultCallback;       /**< Invoked when all devices are done. */
+    OCProvisionProgressCB progressCallback;   /**< Invoked when each device is done. */
+    OCProvisionResult_t* resultArray;         /**< Result of each device. */
+    OTMContext_t* contexts;                   /**< Context of each device. */
+    size_t deviceCount;                       /**< No of devices. */
+    size_t nextDevice;                        /**< Index of the first device not started. */
+    size_t activeCount;                       /**< No of devices in progress. */
+    size_t doneCount;                         /**< No of devices done. */
+    size_t reportCount;                       /**< No of progress callbacks being invoked. */
+    size_t maxSessions;                       /**< Max no of devices in progress. */
+    OTMContext_t* setupOwner;                 /**< Device setting up its secure session. */
+    bool hasError;                            /**< Does any device have an error. */
+    oc_mutex mutex;                           /**< Responses and handshakes use other threads. */
+} OTMBatch_t;
+
 OCStackResult OTMSetOTCallback(OicSecOxm_t oxm, OTMCallbackData_t* callbacks)
 {
     OCStackResult res = OC_STACK_INVALID_PARAM;
@@ -464,17 +489,94 @@ static OCStackResult PostRownerUuid(OTMContext_t* otmCtx);
  */
 static OCStackResult PostNormalOperationStatus(OTMContext_t* otmCtx);
 
-static bool IsComplete(OTMContext_t* otmCtx)
+static void FreeOTMBatch(OTMBatch_t* batch)
 {
-    for(size_t i = 0; i < otmCtx->ctxResultArraySize; i++)
+    if (batch)
     {
-        if(OC_STACK_CONTINUE == otmCtx->ctxResultArray[i].res)
-        {
-            return false;
-        }
+        oc_mutex_free(batch->mutex);
+        OICFree(batch->contexts);
+        OICFree(batch->resultArray);
+        OICFree(batch);
+    }
+}
+
+/**
+ * Only Just Works leaves the CA handlers as they were once the owner credential is in place,
+ * the other OxMs keep their handlers installed until the device is done.
+ */
+static bool IsSharedSessionOxm(const OCProvisionDev_t* device)
+{
+    OicSecOxm_t oxm = OIC_OXM_COUNT;
+    if (OC_STACK_OK != OTMSelectOwnershipTransferMethod(device->doxm->oxm, device->doxm->oxmLen,
+                                                        &oxm, SUPER_OWNER))
+    {
+        //StartOwnershipTransfer will report the error.
+        return true;
+    }
+    return (OIC_JUST_WORKS == oxm);
+}
+
+/**
+ * Function to take the next device of the batch, if the session setup is free
+ * and fewer than maxSessions devices are in progress. The batch mutex must be held.
+ *
+ * @param[in] batch   Devices of the ownership transfer.
+ * @return  Context of the device to start, NULL if none can start now.
+ */
+static OTMContext_t* TakeNextDevice(OTMBatch_t* batch)
+{
+    if (batch->nextDevice >= batch->deviceCount || NULL != batch->setupOwner ||
+        batch->activeCount >= batch->maxSessions)
+    {
+        return NULL;
+    }
+
+    OTMContext_t* otmCtx = &batch->contexts[batch->nextDevice];
+    if (0 != batch->activeCount && !IsSharedSessionOxm(otmCtx->selectedDeviceInfo))
+    {
+        return NULL;
+    }
+
+    batch->nextDevice++;
+    batch->activeCount++;
+    batch->setupOwner = otmCtx;
+    OIC_LOG_V(DEBUG, TAG, "Start OTM of %s:%d (%" PRIuPTR " in progress)",
+              otmCtx->selectedDeviceInfo->endpoint.addr,
+              getSecurePort(otmCtx->selectedDeviceInfo), batch->activeCount);
+    return otmCtx;
+}
+
+/**
+ * Function to let the next device set up its secure session, once the CA handlers are no
+ * longer needed by the current device, i.e. once a response came over its session using
+ * the owner credential. It starts the next device, so it must not run on the thread of the
+ * DTLS handshake callback.
+ *
+ * @param[in] otmCtx   Context value of ownership transfer.
+ */
+static void ReleaseSessionSetup(OTMContext_t* otmCtx)
+{
+    OTMBatch_t* batch = otmCtx->batch;
+    OTMContext_t* nextCtx = NULL;
+
+    if (!IsSharedSessionOxm(otmCtx->selectedDeviceInfo))
+    {
+        return;
+    }
+
+    oc_mutex_lock(batch->mutex);
+    if (otmCtx == batch->setupOwner)
+    {
+        batch->setupOwner = NULL;
+        nextCtx = TakeNextDevice(batch);
     }
+    oc_mutex_unlock(batch->mutex);
 
-    return true;
+    if (nextCtx)
+    {
+        //Errors are reported to the batch through SetResult.
+        StartOwnershipTransfer(nextCtx, nextCtx->selectedDeviceInfo);
+    }
 }
 
 /**
@@ -523,22 +625,21 @@ static void SetResult(OTMContext_t* otmCtx, const OCStackResult res)
         }
     }
 
-    for(size_t i = 0; i < otmCtx->ctxResultArraySize; i++)
+    OTMBatch_t* batch = otmCtx->batch;
+    OCProvisionResult_t* result = &batch->resultArray[otmCtx - batch->contexts];
+    if(OC_STACK_CONTINUE != result->res)
     {
-        if(memcmp(otmCtx->selectedDeviceInfo->doxm->deviceID.id,
-                  otmCtx->ctxResultArray[i].deviceId.id, UUID_LENGTH) == 0)
+        OIC_LOG_V(WARNING, TAG, "Result of the device is already set : %d", result->res);
+        goto exit;
+    }
+
+    if(OC_STACK_OK != res && OC_STACK_CONTINUE != res && OC_STACK_DUPLICATE_REQUEST != res)
+    {
+        if (OC_STACK_OK != PDMDeleteDevice(&result->deviceId))
         {
-            otmCtx->ctxResultArray[i].res = res;
-            if(OC_STACK_OK != res && OC_STACK_CONTINUE != res && OC_STACK_DUPLICATE_REQUEST != res)
-            {
-                otmCtx->ctxHasError = true;
-                if (OC_STACK_OK != PDMDeleteDevice(&otmCtx->ctxResultArray[i].deviceId))
-                {
-                    OIC_LOG(WARNING, TAG, "Internal error in PDMDeleteDevice");
-                }
-                CloseSslConnection(otmCtx->selectedDeviceInfo);
-            }
+            OIC_LOG(WARNING, TAG, "Internal error in PDMDeleteDevice");
         }
+        CloseSslConnection(otmCtx->selectedDeviceInfo);
     }
 
     //In case of duplicated OTM process, OTMContext and OCDoHandle should not be removed.
@@ -565,22 +666,55 @@ static void SetResult(OTMContext_t* otmCtx, const OCStackResult res)
         }
     }
 
+    //The next device is taken under the lock, so the batch outlives the unlock.
+    OTMContext_t* nextCtx = NULL;
+    oc_mutex_lock(batch->mutex);
+    result->res = res;
+    if(OC_STACK_OK != res && OC_STACK_DUPLICATE_REQUEST != res)
+    {
+        batch->hasError = true;
+    }
+    if(otmCtx == batch->setupOwner)
+    {
+        batch->setupOwner = NULL;
+    }
+    size_t inProgressCount = batch->activeCount;
+    batch->activeCount--;
+    batch->doneCount++;
+    if(batch->doneCount != batch->deviceCount)
+    {
+        nextCtx = TakeNextDevice(batch);
+    }
+    //The progress callback is invoked without the lock, from a copy of the progress.
+    OCProvisionResult_t progressResult = *result;
+    size_t doneCount = batch->doneCount;
+    size_t deviceCount = batch->deviceCount;
+    batch->reportCount++;
+    oc_mutex_unlock(batch->mutex);
+
+    if(batch->progressCallback)
+    {
+        batch->progressCallback(batch->userCtx, &progressResult, doneCount, deviceCount,
+                                inProgressCount);
+    }
+
+    //The last device reported completes the batch, after every progress callback returned.
+    oc_mutex_lock(batch->mutex);
+    batch->reportCount--;
+    bool isComplete = (batch->doneCount == batch->deviceCount) && (0 == batch->reportCount);
+    oc_mutex_unlock(batch->mutex);
+
     //If all OTM process is complete, invoke the user callback.
-    if(IsComplete(otmCtx))
+    if(isComplete)
     {
         SetDosState(DOS_RFNOP);
-        otmCtx->ctxResultCallback(otmCtx->userCtx, otmCtx->ctxResultArraySize,
-                                   otmCtx->ctxResultArray, otmCtx->ctxHasError);
-        OICFree(otmCtx->ctxResultArray);
-        OICFree(otmCtx);
+        batch->resultCallback(batch->userCtx, batch->deviceCount,
+                              batch->resultArray, batch->hasError);
+        FreeOTMBatch(batch);
     }
-    else
+    else if(nextCtx)
     {
-        if(OC_STACK_OK != StartOwnershipTransfer(otmCtx,
-                                                 otmCtx->selectedDeviceInfo->next))
-        {
-            OIC_LOG(ERROR, TAG, "Failed to StartOwnershipTransfer");
-        }
+        StartOwnershipTransfer(nextCtx, nextCtx->selectedDeviceInfo);
     }
 exit:
     OIC_LOG(DEBUG, TAG, "OUT SetResult");
@@ -749,18 +883,21 @@ CAResult_t DTLSHandshakeCB(const CAEndpoint_t *endpoint, const CAErrorInfo_t *in
     OIC_LOG_V(INFO, TAG, "Received status from remote device(%s:%d) : %d",
               endpoint->addr, endpoint->port, info->result);
 
+    //This runs on a thread of the CA layer. Holding the list lock keeps the context from
+    //being removed and freed by the response handlers until the callback is done with it.
+    LockOTMContextList();
     OTMContext_t* otmCtx = GetOTMContext(endpoint->addr, endpoint->port);
     if (NULL == otmCtx)
     {
         OIC_LOG(ERROR, TAG, "OTM context not found!");
-        goto exit;
+        goto unlock;
     }
 
     OicSecDoxm_t* newDevDoxm = otmCtx->selectedDeviceInfo->doxm;
     if (NULL == newDevDoxm)
     {
         OIC_LOG(ERROR, TAG, "New device doxm not found!");
-        goto exit;
+        goto unlock;
     }
 
     //Make sure the address matches.
@@ -772,7 +909,7 @@ CAResult_t DTLSHandshakeCB(const CAEndpoint_t *endpoint, const CAErrorInfo_t *in
     {
         OIC_LOG_V(ERROR, TAG, "Mismatched: expected address %s:%u",
                   otmCtx->selectedDeviceInfo->endpoint.addr, getSecurePort(otmCtx->selectedDeviceInfo));
-        goto exit;
+        goto unlock;
     }
 
     OicUuid_t emptyUuid = {.id={0}};
@@ -783,11 +920,18 @@ CAResult_t DTLSHandshakeCB(const CAEndpoint_t *endpoint, const CAErrorInfo_t *in
     {
         result = OwnershipTransferSessionEstablished(endpoint, newDevDoxm, otmCtx);
     }
+    //If secure session using the owner credential established successfully
+    else if (CA_STATUS_OK == info->result)
+    {
+        OIC_LOG(INFO, TAG, "Secure session using the owner credential established.");
+    }
     else
     {
         result = OwnershipTransferSessionFailed(endpoint, info, newDevDoxm, otmCtx, emptyOwnerUuid);
     }
 
+unlock:
+    UnlockOTMContextList();
 exit:
     OIC_LOG_V(DEBUG, TAG, "Out %s", __func__);
     return result;
@@ -1238,6 +1382,9 @@ static OCStackApplicationResult OwnerCredentialHandler(void *ctx, OCDoHandle UNU
             //OC_STACK_UNAUTHORIZED_REQ. After such a failure, OwnerAclHandler
             //will close the current session and re-establish a new session,
             //using the Owner Credential.
+            //
+            //Devices sharing the session setup of the batch re-establish the session
+            //right away, see below.
             CAEndpoint_t endpoint = {.adapter = CA_DEFAULT_ADAPTER};
             CopyDevAddrToEndpoint(&otmCtx->selectedDeviceInfo->endpoint, &endpoint);
 
@@ -1275,6 +1422,18 @@ static OCStackApplicationResult OwnerCredentialHandler(void *ctx, OCDoHandle UNU
 #ifdef __WITH_TLS__
             otmCtx->selectedDeviceInfo->connType |= CT_FLAG_SECURE;
 #endif
+            //The cipher suite selected above is global, so the next device may only set up
+            //its session once this one no longer needs it. With more than one session, close
+            //the anonymous session, so that PostOwnerAcl establishes the session using the
+            //owner credential right away; OwnerAclHandler then lets the next device start.
+            if(1 < otmCtx->batch->maxSessions &&
+               IsSharedSessionOxm(otmCtx->selectedDeviceInfo) &&
+               !CloseSslConnection(otmCtx->selectedDeviceInfo))
+            {
+                SetResult(otmCtx, OC_STACK_ERROR);
+                return OC_STACK_DELETE_TRANSACTION;
+            }
+
             res = PostOwnerAcl(otmCtx, GET_ACL_VER(otmCtx->selectedDeviceInfo->specVer));
             if(OC_STACK_OK != res)
             {
@@ -1324,6 +1483,12 @@ static OCStackApplicationResult OwnerAclHandler(void *ctx, OCDoHandle handle,
     otmCtx->ocDoHandle = NULL;
 
     OCStackResult res = clientResponse->result;
+    if(OC_STACK_RESOURCE_CHANGED == res || OC_STACK_NO_RESOURCE == res)
+    {
+        //The response came over the session using the owner credential.
+        ReleaseSessionSetup(otmCtx);
+    }
+
     if(OC_STACK_RESOURCE_CHANGED == res)
     {
         if(NULL != selectedDeviceInfo)
@@ -2332,6 +2497,7 @@ static OCStackResult StartOwnershipTransfer(void* ctx, OCProvisionDev_t* selecte
     if(OC_STACK_OK != res)
     {
         OIC_LOG_V(ERROR, TAG, "Error in OTMSetOTCallback : %d", res);
+        SetResult(otmCtx, res);
         return res;
     }
 
@@ -2387,9 +2553,18 @@ OCStackResult OTMDoOwnershipTransfer(void* ctx,
                                      OCProvisionDev_t *selectedDevicelist,
                                      OCProvisionResultCB resultCallback)
 {
-    OIC_LOG(DEBUG, TAG, "IN OTMDoOwnershipTransfer");
+    return OTMDoConcurrentOwnershipTransfer(ctx, selectedDevicelist, 1, NULL, resultCallback);
+}
+
+OCStackResult OTMDoConcurrentOwnershipTransfer(void* ctx,
+                                               OCProvisionDev_t *selectedDevicelist,
+                                               size_t maxSessions,
+                                               OCProvisionProgressCB progressCallback,
+                                               OCProvisionResultCB resultCallback)
+{
+    OIC_LOG(DEBUG, TAG, "IN OTMDoConcurrentOwnershipTransfer");
 
-    if (NULL == selectedDevicelist)
+    if (NULL == selectedDevicelist || 0 == maxSessions)
     {
         return OC_STACK_INVALID_PARAM;
     }
@@ -2398,50 +2573,61 @@ OCStackResult OTMDoOwnershipTransfer(void* ctx,
         return OC_STACK_INVALID_CALLBACK;
     }
 
-    OTMContext_t* otmCtx = (OTMContext_t*)OICCalloc(1,sizeof(OTMContext_t));
-    if(!otmCtx)
+    OTMBatch_t* batch = (OTMBatch_t*)OICCalloc(1, sizeof(OTMBatch_t));
+    if(!batch)
     {
         OIC_LOG(ERROR, TAG, "Failed to create OTM Context");
         return OC_STACK_NO_MEMORY;
     }
 
-    otmCtx->ctxResultCallback = resultCallback;
-    otmCtx->ctxHasError = false;
-    otmCtx->userCtx = ctx;
+    batch->resultCallback = resultCallback;
+    batch->progressCallback = progressCallback;
+    batch->userCtx = ctx;
+    batch->maxSessions = maxSessions;
     OCProvisionDev_t* pCurDev = selectedDevicelist;
 
     //Counting number of selected devices.
-    otmCtx->ctxResultArraySize = 0;
     while(NULL != pCurDev)
     {
-        otmCtx->ctxResultArraySize++;
+        batch->deviceCount++;
         pCurDev = pCurDev->next;
     }
 
-    otmCtx->ctxResultArray =
-        (OCProvisionResult_t*)OICCalloc(otmCtx->ctxResultArraySize, sizeof(OCProvisionResult_t));
-    if(NULL == otmCtx->ctxResultArray)
+    batch->resultArray =
+        (OCProvisionResult_t*)OICCalloc(batch->deviceCount, sizeof(OCProvisionResult_t));
+    batch->contexts = (OTMContext_t*)OICCalloc(batch->deviceCount, sizeof(OTMContext_t));
+    batch->mutex = oc_mutex_new();
+    if(NULL == batch->resultArray || NULL == batch->contexts || NULL == batch->mutex)
     {
-        OIC_LOG(ERROR, TAG, "OTMDoOwnershipTransfer : Failed to memory allocation");
-        OICFree(otmCtx);
+        OIC_LOG(ERROR, TAG, "OTMDoConcurrentOwnershipTransfer : Failed to memory allocation");
+        FreeOTMBatch(batch);
         return OC_STACK_NO_MEMORY;
     }
     pCurDev = selectedDevicelist;
 
-    //Fill the device UUID for result array.
-    for(size_t devIdx = 0; devIdx < otmCtx->ctxResultArraySize; devIdx++)
+    //Fill the device UUID for result array, and the context of each device.
+    for(size_t devIdx = 0; devIdx < batch->deviceCount; devIdx++)
     {
-        memcpy(otmCtx->ctxResultArray[devIdx].deviceId.id,
+        memcpy(batch->resultArray[devIdx].deviceId.id,
                pCurDev->doxm->deviceID.id,
                UUID_LENGTH);
-        otmCtx->ctxResultArray[devIdx].res = OC_STACK_CONTINUE;
+        batch->resultArray[devIdx].res = OC_STACK_CONTINUE;
+
+        OTMContext_t* otmCtx = &batch->contexts[devIdx];
+        otmCtx->userCtx = ctx;
+        otmCtx->selectedDeviceInfo = pCurDev;
+        otmCtx->batch = batch;
         pCurDev = pCurDev->next;
     }
 
     SetDosState(DOS_RFPRO);
-    OCStackResult res = StartOwnershipTransfer(otmCtx, selectedDevicelist);
+    oc_mutex_lock(batch->mutex);
+    OTMContext_t* otmCtx = TakeNextDevice(batch);
+    oc_mutex_unlock(batch->mutex);
+    //The batch may already be freed if the first device failed.
+    OCStackResult res = StartOwnershipTransfer(otmCtx, otmCtx->selectedDeviceInfo);
 
-    OIC_LOG(DEBUG, TAG, "OUT OTMDoOwnershipTransfer");
+    OIC_LOG(DEBUG, TAG, "OUT OTMDoConcurrentOwnershipTransfer");
 
     return res;
 }
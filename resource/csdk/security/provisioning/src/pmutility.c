@@ -38,6 +38,7 @@
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "oic_time.h"
+#include "ocevent.h"
 #include "experimental/logger.h"
 #include "utlist.h"
 #include "ocpayload.h"
@@ -61,8 +62,38 @@ typedef struct _DiscoveryInfo{
     bool                isSingleDiscovery;
     bool                isFound;
     const OicUuid_t     *targetId;
+    size_t              foundCount;     /**< devices moved to ppDevicesList **/
+    size_t              pendingCount;   /**< spec version requests still waiting for a response **/
+    uint64_t            lastFoundTime;  /**< time in ms the last device was found **/
 } DiscoveryInfo;
 
+struct OCPMDiscovery
+{
+    DiscoveryInfo       info;
+    OCProvisionDev_t    *pDevList;
+    OicUuid_t           targetId;
+    OCDoHandle          handle;
+    uint64_t            deadline;
+    size_t              expectedCount;
+    uint32_t            quietPeriodMs;
+};
+
+/**
+ * Longest time to wait for the stack to receive messages before calling OCProcess(), so that
+ * the stack timers keep running.
+ */
+#define PM_MAX_PROCESS_WAIT_MS (100)
+
+/**
+ * Callback used by ProcessUntil to check whether waiting is over.
+ *
+ * @param[in] ctx       Context passed to ProcessUntil.
+ * @param[out] waitMs   Time in milliseconds until the wait is over unless messages arrive.
+ *
+ * @return true when the wait is over.
+ */
+typedef bool (*PMIsWaitOver)(const void *ctx, uint32_t *waitMs);
+
 /*
  * Function to discover secre port information through unicast
  *
@@ -525,34 +556,87 @@ exit:
     return NULL;
 }
 
+/**
+ * Call OCProcess() until isWaitOver returns true. In between, wait for the stack to receive
+ * messages, for at most PM_MAX_PROCESS_WAIT_MS.
+ *
+ * @param[in] isWaitOver    Callback checking whether waiting is over.
+ * @param[in] ctx           Context of isWaitOver.
+ *
+ * @return OC_STACK_OK on success otherwise error.
+ */
+static OCStackResult ProcessUntil(PMIsWaitOver isWaitOver, const void *ctx)
+{
+    oc_event processEvent = oc_event_new();
+    if (NULL == processEvent)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to create process event");
+        return OC_STACK_NO_MEMORY;
+    }
+    if (OC_STACK_OK != OCRegisterProcessEvent(processEvent))
+    {
+        OIC_LOG(WARNING, TAG, "Failed to register process event, polling OCProcess()");
+    }
+
+    OCStackResult res = OC_STACK_OK;
+    uint32_t waitMs = 0;
+    while ((OC_STACK_OK == (res = OCProcess())) && !isWaitOver(ctx, &waitMs))
+    {
+        oc_event_wait_for(processEvent,
+                          (waitMs < PM_MAX_PROCESS_WAIT_MS) ? waitMs : PM_MAX_PROCESS_WAIT_MS);
+    }
+
+    OCUnregisterProcessEvent(processEvent);
+    oc_event_free(processEvent);
+    return res;
+}
+
+static uint32_t GetWaitTime(uint64_t currTime, uint64_t endTime)
+{
+    uint64_t waitMs = (endTime > currTime) ? (endTime - currTime) : 0;
+    return (waitMs < UINT32_MAX) ? (uint32_t)waitMs : UINT32_MAX;
+}
+
+static bool IsTimeoutOver(const void *ctx, uint32_t *waitMs)
+{
+    uint64_t deadline = *(const uint64_t *)ctx;
+    uint64_t currTime = OICGetCurrentTime(TIME_IN_MS);
+
+    *waitMs = GetWaitTime(currTime, deadline);
+    return (currTime >= deadline);
+}
+
 /**
  * Timeout implementation for secure discovery. When performing secure discovery,
  * we should wait a certain period of time for getting response of each devices.
  *
  * @param[in]  waittime  Timeout in seconds.
- * @param[in]  waitForStackResponse if true timeout function will call OCProcess while waiting.
+ * @param[in]  waitForStackResponse if true timeout function will call OCProcess whenever the
+ *                                  stack receives messages while waiting.
  * @return OC_STACK_OK on success otherwise error.
  */
 OCStackResult PMTimeout(unsigned short waittime, bool waitForStackResponse)
 {
-    OCStackResult res = OC_STACK_OK;
+    uint64_t deadline = OICGetCurrentTime(TIME_IN_MS) + (uint64_t)waittime * MS_PER_SEC;
 
-    uint64_t startTime = OICGetCurrentTime(TIME_IN_MS);
-    while (OC_STACK_OK == res)
+    if (waitForStackResponse)
     {
-        uint64_t currTime = OICGetCurrentTime(TIME_IN_MS);
+        return ProcessUntil(IsTimeoutOver, &deadline);
+    }
 
-        long elapsed = (long)((currTime - startTime) / MS_PER_SEC);
-        if (elapsed > waittime)
-        {
-            return OC_STACK_OK;
-        }
-        if (waitForStackResponse)
-        {
-            res = OCProcess();
-        }
+    oc_event timeoutEvent = oc_event_new();
+    if (NULL == timeoutEvent)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to create timeout event");
+        return OC_STACK_NO_MEMORY;
     }
-    return res;
+    uint32_t waitMs = 0;
+    while (!IsTimeoutOver(&deadline, &waitMs))
+    {
+        oc_event_wait_for(timeoutEvent, waitMs);
+    }
+    oc_event_free(timeoutEvent);
+    return OC_STACK_OK;
 }
 
 bool OC_CALL PMGenerateQuery(bool isSecure,
@@ -633,7 +717,7 @@ bool OC_CALL PMGenerateQuery(bool isSecure,
  * Since security version discovery does not used anymore, disable security version discovery.
  * Need to discussion to removing all version discovery related codes.
  */
-static OCStackApplicationResult SpecVersionDiscoveryHandler(void *ctx, OCDoHandle UNUSED,
+static OCStackApplicationResult SpecVersionDiscoveryHandler(void *ctx, OCDoHandle handle,
                                 OCClientResponse *clientResponse)
 {
     if (ctx == NULL)
@@ -641,25 +725,37 @@ static OCStackApplicationResult SpecVersionDiscoveryHandler(void *ctx, OCDoHandl
         OIC_LOG(ERROR, TAG, "Lost List of device information");
         return OC_STACK_KEEP_TRANSACTION;
     }
-    (void)UNUSED;
     if (clientResponse)
     {
+        // The unicast request is answered, so the discovery no longer waits for it.
+        DiscoveryInfo* pDInfo = (DiscoveryInfo*)ctx;
+        OCProvisionDev_t *pDev = NULL;
+        LL_FOREACH(*pDInfo->ppDevicesList, pDev)
+        {
+            if (handle == pDev->handle)
+            {
+                pDev->handle = NULL;
+                pDInfo->pendingCount--;
+                break;
+            }
+        }
+
         if  (NULL == clientResponse->payload)
         {
             OIC_LOG(INFO, TAG, "Skiping Null payload");
-            return OC_STACK_KEEP_TRANSACTION;
+            return OC_STACK_DELETE_TRANSACTION;
         }
         if (OC_STACK_OK != clientResponse->result)
         {
             OIC_LOG(INFO, TAG, "Error in response");
-            return OC_STACK_KEEP_TRANSACTION;
+            return OC_STACK_DELETE_TRANSACTION;
         }
         else
         {
             if (PAYLOAD_TYPE_REPRESENTATION != clientResponse->payload->type)
             {
                 OIC_LOG(INFO, TAG, "Unknown payload type");
-                return OC_STACK_KEEP_TRANSACTION;
+                return OC_STACK_DELETE_TRANSACTION;
             }
             OCRepPayloadValue* val = ((OCRepPayload*) clientResponse->payload)->values;
 
@@ -679,13 +775,12 @@ static OCStackApplicationResult SpecVersionDiscoveryHandler(void *ctx, OCDoHandl
                 val = val -> next;
             }
             //If this is owend device discovery we have to filter out the responses.
-            DiscoveryInfo* pDInfo = (DiscoveryInfo*)ctx;
             OCStackResult res = UpdateSpecVersionOfDevice(pDInfo->ppDevicesList, clientResponse->devAddr.addr,
                                                      clientResponse->devAddr.port, specVer);
             if (OC_STACK_OK != res)
             {
                 OIC_LOG(ERROR, TAG, "Error while getting security version.");
-                return OC_STACK_KEEP_TRANSACTION;
+                return OC_STACK_DELETE_TRANSACTION;
             }
 
             OIC_LOG(INFO, TAG, "= Discovered security version =");
@@ -851,6 +946,9 @@ static OCStackApplicationResult SecurePortDiscoveryHandler(void *ctx, OCDoHandle
                 OIC_LOG(ERROR, TAG, "Error while move the discovered device to list.");
                 return OC_STACK_DELETE_TRANSACTION;
             }
+            ptr->handle = NULL;
+            pDInfo->foundCount++;
+            pDInfo->lastFoundTime = OICGetCurrentTime(TIME_IN_MS);
 
             if(pDInfo->isSingleDiscovery)
             {
@@ -1015,290 +1113,353 @@ static void DeviceDiscoveryDeleteHandler(void *ctx)
 }
 
 /**
- * Discover owned/unowned device in the specified endpoint/deviceID.
- * It will return the found device even though timeout is not exceeded.
+ * Start a device discovery.
  *
- * @param[in] waittime           Timeout in seconds
- * @param[in] deviceID           deviceID of target device.
- * @param[out] ppFoundDevice     OCProvisionDev_t of found device
+ * @param[in] options       Options of the discovery.
+ * @param[in] query         Query of the discovery request.
+ * @param[in] handler       Callback handling the discovery responses.
+ * @param[out] ppDiscovery  Started discovery.
  *
- * @return OC_STACK_OK on success otherwise error.\n
- *         OC_STACK_INVALID_PARAM when deviceID is NULL or ppFoundDevice is not initailized.
+ * @return OC_STACK_OK on success otherwise error.
  */
-OCStackResult PMSingleDeviceDiscovery(unsigned short waittime, const OicUuid_t* deviceID,
-                                 OCProvisionDev_t **ppFoundDevice)
+static OCStackResult StartDiscovery(const OCPMDiscoveryOptions_t *options, const char *query,
+                                    OCClientResponseHandler handler,
+                                    OCPMDiscovery_t **ppDiscovery)
 {
-    OIC_LOG(DEBUG, TAG, "IN PMSingleDeviceDiscovery");
-
-    if (NULL != *ppFoundDevice)
-    {
-        OIC_LOG(ERROR, TAG, "List is not null can cause memory leak");
-        return OC_STACK_INVALID_PARAM;
-    }
-
-    if (NULL == deviceID)
+    OCPMDiscovery_t *pDiscovery = (OCPMDiscovery_t *)OICCalloc(1, sizeof(OCPMDiscovery_t));
+    if (NULL == pDiscovery)
     {
-        OIC_LOG(ERROR, TAG, "Invalid device ID");
-        return OC_STACK_INVALID_PARAM;
-    }
-
-
-    DiscoveryInfo *pDInfo = OICCalloc(1, sizeof(DiscoveryInfo));
-    if(NULL == pDInfo)
-    {
-        OIC_LOG(ERROR, TAG, "PMSingleDeviceDiscovery : Memory allocation failed.");
+        OIC_LOG(ERROR, TAG, "StartDiscovery : Memory allocation failed.");
         return OC_STACK_NO_MEMORY;
     }
 
-    pDInfo->ppDevicesList = ppFoundDevice;
+    DiscoveryInfo *pDInfo = &pDiscovery->info;
+    pDInfo->ppDevicesList = &pDiscovery->pDevList;
     pDInfo->pCandidateList = NULL;
-    pDInfo->isOwnedDiscovery = false;
-    pDInfo->isSingleDiscovery = true;
+    pDInfo->isOwnedDiscovery = (NULL == options->targetId) && options->isOwned;
+    pDInfo->isSingleDiscovery = (NULL != options->targetId);
     pDInfo->isFound = false;
-    pDInfo->targetId = deviceID;
+    if (NULL != options->targetId)
+    {
+        memcpy(&pDiscovery->targetId, options->targetId, sizeof(pDiscovery->targetId));
+        pDInfo->targetId = &pDiscovery->targetId;
+    }
+    pDiscovery->deadline = OICGetCurrentTime(TIME_IN_MS) + (uint64_t)options->timeout * MS_PER_SEC;
+    pDiscovery->expectedCount = options->expectedCount;
+    pDiscovery->quietPeriodMs = options->quietPeriodMs;
 
     OCCallbackData cbData;
-    cbData.cb = &DeviceDiscoveryHandler;
+    cbData.cb = handler;
     cbData.context = (void *)pDInfo;
     cbData.cd = &DeviceDiscoveryDeleteHandler;
 
-    OCStackResult res = OC_STACK_ERROR;
-
-    char query[MAX_URI_LENGTH + MAX_QUERY_LENGTH + 1] = { '\0' };
-    snprintf(query, MAX_URI_LENGTH + MAX_QUERY_LENGTH + 1, "/oic/sec/doxm");
-
-    OCDoHandle handle = NULL;
-    res = OCDoResource(&handle, OC_REST_DISCOVER, query, 0, 0,
-                                     CT_DEFAULT, OC_HIGH_QOS, &cbData, NULL, 0);
-    if (res != OC_STACK_OK)
+    OIC_LOG_V(DEBUG, TAG, "Discovery query=%s", query);
+    OCStackResult res = OCDoResource(&pDiscovery->handle, OC_REST_DISCOVER, query, 0, 0,
+                                     options->connType & CT_MASK_ADAPTER, OC_HIGH_QOS,
+                                     &cbData, NULL, 0);
+    if (OC_STACK_OK != res)
     {
         OIC_LOG(ERROR, TAG, "OCStack resource error");
-        OICFree(pDInfo);
+        OICFree(pDiscovery);
         return res;
     }
 
-    //Waiting for each response.
-    res = OC_STACK_OK;
-    uint64_t startTime = OICGetCurrentTime(TIME_IN_MS);
-    while (OC_STACK_OK == res && !pDInfo->isFound)
-    {
-        uint64_t currTime = OICGetCurrentTime(TIME_IN_MS);
+    *ppDiscovery = pDiscovery;
+    return OC_STACK_OK;
+}
 
-        long elapsed = (long)((currTime - startTime) / MS_PER_SEC);
-        if (elapsed > waittime)
-        {
-            break;
-        }
-        res = OCProcess();
-    }
+static bool IsDiscoveryOver(const void *ctx, uint32_t *waitMs)
+{
+    return PMIsDeviceDiscoveryDone((const OCPMDiscovery_t *)ctx, waitMs);
+}
 
-    if(OC_STACK_OK != res)
+/**
+ * Discover devices and return when the discovery is done.
+ *
+ * @param[in] options       Options of the discovery.
+ * @param[in] query         Query of the discovery request.
+ * @param[in] handler       Callback handling the discovery responses.
+ * @param[out] ppList       List the found devices are appended to.
+ *
+ * @return OC_STACK_OK on success otherwise error.
+ */
+static OCStackResult DiscoverDevices(const OCPMDiscoveryOptions_t *options, const char *query,
+                                     OCClientResponseHandler handler, OCProvisionDev_t **ppList)
+{
+    OCPMDiscovery_t *pDiscovery = NULL;
+    OCStackResult res = StartDiscovery(options, query, handler, &pDiscovery);
+    if (OC_STACK_OK != res)
     {
-        OIC_LOG(ERROR, TAG, "Failed to wait response for secure discovery.");
-        OICFree(pDInfo);
-        OCStackResult resCancel = OCCancel(handle, OC_HIGH_QOS, NULL, 0);
-        if(OC_STACK_OK !=  resCancel)
-        {
-            OIC_LOG(ERROR, TAG, "Failed to remove registered callback");
-        }
         return res;
     }
 
-    res = OCCancel(handle,OC_HIGH_QOS,NULL,0);
+    //Waiting for each response.
+    res = PMWaitForDeviceDiscovery(pDiscovery);
     if (OC_STACK_OK != res)
     {
-        OIC_LOG(ERROR, TAG, "Failed to remove registered callback");
-        OICFree(pDInfo);
+        OIC_LOG(ERROR, TAG, "Failed to wait response for secure discovery.");
+        PMFinishDeviceDiscovery(pDiscovery, NULL);
         return res;
     }
-    OIC_LOG(DEBUG, TAG, "OUT PMSingleDeviceDiscovery");
-    OICFree(pDInfo);
-    return res;
-}
 
+    PMFinishDeviceDiscovery(pDiscovery, ppList);
+    return OC_STACK_OK;
+}
 
 /**
- * Discover owned/unowned devices in the same IP subnet. .
+ * Build the query of an owned/unowned device discovery.
  *
- * @param[in] waittime      Timeout in seconds.
- * @param[in] isOwned       bool flag for owned / unowned discovery
- * @param[in] ppDevicesList        List of OCProvisionDev_t.
+ * @param[in] options       Options of the discovery.
+ * @param[out] buffer       Buffer to save the query.
+ * @param[in] bufferSize    Size of buffer.
  *
- * @return OC_STACK_OK on success otherwise error.
+ * @return true on success
  */
-OCStackResult PMDeviceDiscovery(unsigned short waittime, bool isOwned, OCProvisionDev_t **ppDevicesList)
+static bool GetDiscoveryQuery(const OCPMDiscoveryOptions_t *options,
+                              char *buffer, size_t bufferSize)
 {
-    OIC_LOG(DEBUG, TAG, "IN PMDeviceDiscovery");
+    const char DOXM_OWNED_FALSE_MULTICAST_QUERY[] = "/oic/sec/doxm?Owned=FALSE";
+    const char DOXM_OWNED_TRUE_MULTICAST_QUERY[] = "/oic/sec/doxm?Owned=TRUE";
+    const char DOXM_QUERY[] = "/oic/sec/doxm";
 
-    if (NULL != *ppDevicesList)
+    const char *hostAddress = options->hostAddress ? options->hostAddress : "";
+    const char *uri = DOXM_QUERY;
+    if (NULL == options->targetId)
     {
-        OIC_LOG(ERROR, TAG, "List is not null can cause memory leak");
-        return OC_STACK_INVALID_PARAM;
+        uri = options->isOwned ? DOXM_OWNED_TRUE_MULTICAST_QUERY :
+                                 DOXM_OWNED_FALSE_MULTICAST_QUERY;
     }
 
-    const char DOXM_OWNED_FALSE_MULTICAST_QUERY[] = "/oic/sec/doxm?Owned=FALSE";
-    const char DOXM_OWNED_TRUE_MULTICAST_QUERY[] = "/oic/sec/doxm?Owned=TRUE";
-
-    DiscoveryInfo *pDInfo = OICCalloc(1, sizeof(DiscoveryInfo));
-    if(NULL == pDInfo)
+    int snRet = snprintf(buffer, bufferSize, "%s%s", hostAddress, uri);
+    if ((snRet < 0) || ((size_t)snRet >= bufferSize))
     {
-        OIC_LOG(ERROR, TAG, "PMDeviceDiscovery : Memory allocation failed.");
-        return OC_STACK_NO_MEMORY;
+        OIC_LOG_V(ERROR, TAG, "GetDiscoveryQuery : Error (snprintf) %d", snRet);
+        return false;
     }
+    return true;
+}
 
-    pDInfo->ppDevicesList = ppDevicesList;
-    pDInfo->pCandidateList = NULL;
-    pDInfo->isOwnedDiscovery = isOwned;
-    pDInfo->isSingleDiscovery = false;
-    pDInfo->targetId = NULL;
+OCStackResult PMStartDeviceDiscovery(const OCPMDiscoveryOptions_t *options,
+                                     OCPMDiscovery_t **ppDiscovery)
+{
+    OIC_LOG(DEBUG, TAG, "IN PMStartDeviceDiscovery");
 
-    OCCallbackData cbData;
-    cbData.cb = &DeviceDiscoveryHandler;
-    cbData.context = (void *)pDInfo;
-    cbData.cd = &DeviceDiscoveryDeleteHandler;
-    OCStackResult res = OC_STACK_ERROR;
+    if ((NULL == options) || (NULL == ppDiscovery))
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
 
-    const char* query = isOwned ? DOXM_OWNED_TRUE_MULTICAST_QUERY :
-                                  DOXM_OWNED_FALSE_MULTICAST_QUERY;
+    char query[MAX_URI_LENGTH + MAX_QUERY_LENGTH + 1] = { '\0' };
+    if (!GetDiscoveryQuery(options, query, sizeof(query)))
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
 
-    OCDoHandle handle = NULL;
-    res = OCDoResource(&handle, OC_REST_DISCOVER, query, 0, 0,
-                                     CT_DEFAULT, OC_HIGH_QOS, &cbData, NULL, 0);
-    if (res != OC_STACK_OK)
+    OCStackResult res = StartDiscovery(options, query, &DeviceDiscoveryHandler, ppDiscovery);
+    OIC_LOG(DEBUG, TAG, "OUT PMStartDeviceDiscovery");
+    return res;
+}
+
+bool PMIsDeviceDiscoveryDone(const OCPMDiscovery_t *pDiscovery, uint32_t *waitMs)
+{
+    if (NULL == pDiscovery)
     {
-        OIC_LOG(ERROR, TAG, "OCStack resource error");
-        OICFree(pDInfo);
-        return res;
+        return true;
     }
 
-    //Waiting for each response.
-    res = PMTimeout(waittime, true);
-    if(OC_STACK_OK != res)
+    const DiscoveryInfo *pDInfo = &pDiscovery->info;
+    uint64_t currTime = OICGetCurrentTime(TIME_IN_MS);
+    uint64_t endTime = pDiscovery->deadline;
+
+    if (currTime >= endTime)
     {
-        OIC_LOG(ERROR, TAG, "Failed to wait response for secure discovery.");
-        OICFree(pDInfo);
-        OCStackResult resCancel = OCCancel(handle, OC_HIGH_QOS, NULL, 0);
-        if(OC_STACK_OK !=  resCancel)
+        return true;
+    }
+    if (pDInfo->isSingleDiscovery)
+    {
+        if (pDInfo->isFound)
         {
-            OIC_LOG(ERROR, TAG, "Failed to remove registered callback");
+            return true;
         }
-        return res;
     }
-    res = OCCancel(handle,OC_HIGH_QOS,NULL,0);
-    if (OC_STACK_OK != res)
+    // Found devices are complete once their spec version request is answered.
+    else if ((0 < pDInfo->foundCount) && (0 == pDInfo->pendingCount))
     {
-        OIC_LOG(ERROR, TAG, "Failed to remove registered callback");
-        OICFree(pDInfo);
-        return res;
+        if ((0 != pDiscovery->expectedCount) &&
+            (pDInfo->foundCount >= pDiscovery->expectedCount))
+        {
+            return true;
+        }
+        if (0 != pDiscovery->quietPeriodMs)
+        {
+            uint64_t quietEndTime = pDInfo->lastFoundTime + pDiscovery->quietPeriodMs;
+            if (currTime >= quietEndTime)
+            {
+                return true;
+            }
+            if (quietEndTime < endTime)
+            {
+                endTime = quietEndTime;
+            }
+        }
     }
-    OIC_LOG(DEBUG, TAG, "OUT PMDeviceDiscovery");
-    OICFree(pDInfo);
-    return res;
+
+    if (waitMs)
+    {
+        *waitMs = GetWaitTime(currTime, endTime);
+    }
+    return false;
 }
 
-OCStackResult PMSingleDeviceDiscoveryInUnicast(unsigned short waittime, const OicUuid_t* deviceID,
-                                 const char* hostAddress, OCConnectivityType connType,
-                                 OCProvisionDev_t **ppFoundDevice)
+OCStackResult PMWaitForDeviceDiscovery(OCPMDiscovery_t *pDiscovery)
 {
-    OIC_LOG(DEBUG, TAG, "IN PMSingleDeviceDiscoveryInUnicast");
-
-    if (NULL != *ppFoundDevice)
+    if (NULL == pDiscovery)
     {
-        OIC_LOG(ERROR, TAG, "List is not null can cause memory leak");
         return OC_STACK_INVALID_PARAM;
     }
 
-    if (NULL == deviceID)
+    return ProcessUntil(IsDiscoveryOver, pDiscovery);
+}
+
+void PMFinishDeviceDiscovery(OCPMDiscovery_t *pDiscovery, OCProvisionDev_t **ppList)
+{
+    if (NULL == pDiscovery)
     {
-        OIC_LOG(ERROR, TAG, "Invalid device ID");
-        return OC_STACK_INVALID_PARAM;
+        return;
     }
 
-    DiscoveryInfo *pDInfo = (DiscoveryInfo*)OICCalloc(1, sizeof(DiscoveryInfo));
-    if (NULL == pDInfo)
+    // This also cancels the secure port requests of the candidate devices.
+    if (OC_STACK_OK != OCCancel(pDiscovery->handle, OC_HIGH_QOS, NULL, 0))
     {
-        OIC_LOG(ERROR, TAG, "PMSingleDeviceDiscoveryInUnicast : Memory allocation failed.");
-        return OC_STACK_NO_MEMORY;
+        OIC_LOG(ERROR, TAG, "Failed to remove registered callback");
     }
 
-    pDInfo->ppDevicesList = ppFoundDevice;
-    pDInfo->pCandidateList = NULL;
-    pDInfo->isOwnedDiscovery = false;
-    pDInfo->isSingleDiscovery = true;
-    pDInfo->isFound = false;
-    pDInfo->targetId = deviceID;
+    OCProvisionDev_t *pDev = NULL;
+    LL_FOREACH(pDiscovery->pDevList, pDev)
+    {
+        if (NULL != pDev->handle)
+        {
+            OIC_LOG_V(DEBUG, TAG, "OCCancel - %s : %d",
+                      pDev->endpoint.addr, pDev->endpoint.port);
+            if (OC_STACK_OK != OCCancel(pDev->handle, OC_HIGH_QOS, NULL, 0))
+            {
+                OIC_LOG(ERROR, TAG, "Failed to remove registered callback");
+            }
+            pDev->handle = NULL;
+        }
+    }
 
-    OCCallbackData cbData;
-    cbData.cb = &DeviceDiscoveryHandler;
-    cbData.context = (void *)pDInfo;
-    cbData.cd = &DeviceDiscoveryDeleteHandler;
+    if (NULL != ppList)
+    {
+        LL_CONCAT(*ppList, pDiscovery->pDevList);
+    }
+    else
+    {
+        PMDeleteDeviceList(pDiscovery->pDevList);
+    }
+    OICFree(pDiscovery);
+}
 
-    OCStackResult res = OC_STACK_ERROR;
+OCStackResult PMDiscoverDevices(const OCPMDiscoveryOptions_t *options, OCProvisionDev_t **ppList)
+{
+    OIC_LOG(DEBUG, TAG, "IN PMDiscoverDevices");
+
+    if ((NULL == options) || (NULL == ppList))
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
 
     char query[MAX_URI_LENGTH + MAX_QUERY_LENGTH + 1] = { '\0' };
-    if (hostAddress == NULL)
+    if (!GetDiscoveryQuery(options, query, sizeof(query)))
     {
-        hostAddress = "";
+        return OC_STACK_INVALID_PARAM;
     }
-    snprintf(query, MAX_URI_LENGTH + MAX_QUERY_LENGTH + 1, "%s/oic/sec/doxm", hostAddress);
-    connType = connType & CT_MASK_ADAPTER;
 
-    OCDoHandle handle = NULL;
-    res = OCDoResource(&handle, OC_REST_DISCOVER, query, 0, 0,
-            connType, OC_HIGH_QOS, &cbData, NULL, 0);
+    OCStackResult res = DiscoverDevices(options, query, &DeviceDiscoveryHandler, ppList);
+    OIC_LOG(DEBUG, TAG, "OUT PMDiscoverDevices");
+    return res;
+}
 
-    if (res != OC_STACK_OK)
+/**
+ * Discover owned/unowned device in the specified endpoint/deviceID.
+ * It will return the found device even though timeout is not exceeded.
+ *
+ * @param[in] waittime           Timeout in seconds
+ * @param[in] deviceID           deviceID of target device.
+ * @param[out] ppFoundDevice     OCProvisionDev_t of found device
+ *
+ * @return OC_STACK_OK on success otherwise error.\n
+ *         OC_STACK_INVALID_PARAM when deviceID is NULL or ppFoundDevice is not initailized.
+ */
+OCStackResult PMSingleDeviceDiscovery(unsigned short waittime, const OicUuid_t* deviceID,
+                                 OCProvisionDev_t **ppFoundDevice)
+{
+    return PMSingleDeviceDiscoveryInUnicast(waittime, deviceID, NULL, CT_DEFAULT, ppFoundDevice);
+}
+
+
+/**
+ * Discover owned/unowned devices in the same IP subnet. .
+ *
+ * @param[in] waittime      Timeout in seconds.
+ * @param[in] isOwned       bool flag for owned / unowned discovery
+ * @param[in] ppDevicesList        List of OCProvisionDev_t.
+ *
+ * @return OC_STACK_OK on success otherwise error.
+ */
+OCStackResult PMDeviceDiscovery(unsigned short waittime, bool isOwned, OCProvisionDev_t **ppDevicesList)
+{
+    OIC_LOG(DEBUG, TAG, "IN PMDeviceDiscovery");
+
+    if (NULL != *ppDevicesList)
     {
-        OIC_LOG(ERROR, TAG, "OCStack resource error");
-        OICFree(pDInfo);
-        pDInfo = NULL;
-        return res;
+        OIC_LOG(ERROR, TAG, "List is not null can cause memory leak");
+        return OC_STACK_INVALID_PARAM;
     }
 
-    res = OC_STACK_OK;
-    uint64_t startTime = OICGetCurrentTime(TIME_IN_MS);
-    while (OC_STACK_OK == res && !pDInfo->isFound)
-    {
-        uint64_t currTime = OICGetCurrentTime(TIME_IN_MS);
+    OCPMDiscoveryOptions_t options;
+    memset(&options, 0, sizeof(options));
+    options.timeout = waittime;
+    options.isOwned = isOwned;
+    options.connType = CT_DEFAULT;
 
-        long elapsed = (long)((currTime - startTime) / MS_PER_SEC);
-        if (elapsed > waittime)
-        {
-            break;
-        }
-        res = OCProcess();
-    }
+    OCStackResult res = PMDiscoverDevices(&options, ppDevicesList);
+    OIC_LOG(DEBUG, TAG, "OUT PMDeviceDiscovery");
+    return res;
+}
 
-    if (OC_STACK_OK != res)
+OCStackResult PMSingleDeviceDiscoveryInUnicast(unsigned short waittime, const OicUuid_t* deviceID,
+                                 const char* hostAddress, OCConnectivityType connType,
+                                 OCProvisionDev_t **ppFoundDevice)
+{
+    OIC_LOG(DEBUG, TAG, "IN PMSingleDeviceDiscoveryInUnicast");
+
+    if (NULL != *ppFoundDevice)
     {
-        OIC_LOG (ERROR, TAG, "Failed to wait response for secure discovery.");
-        OICFree(pDInfo);
-        pDInfo = NULL;
-        OCStackResult resCancel = OCCancel(handle, OC_HIGH_QOS, NULL, 0);
-        if (OC_STACK_OK !=  resCancel)
-        {
-            OIC_LOG(ERROR, TAG, "Failed to remove registered callback");
-        }
-        return res;
+        OIC_LOG(ERROR, TAG, "List is not null can cause memory leak");
+        return OC_STACK_INVALID_PARAM;
     }
 
-    res = OCCancel(handle, OC_HIGH_QOS, NULL, 0);
-    if (OC_STACK_OK != res)
+    if (NULL == deviceID)
     {
-        OIC_LOG(ERROR, TAG, "Failed to remove registered callback");
-        OICFree(pDInfo);
-        pDInfo = NULL;
-        return res;
+        OIC_LOG(ERROR, TAG, "Invalid device ID");
+        return OC_STACK_INVALID_PARAM;
     }
+
+    OCPMDiscoveryOptions_t options;
+    memset(&options, 0, sizeof(options));
+    options.timeout = waittime;
+    options.targetId = deviceID;
+    options.hostAddress = hostAddress;
+    options.connType = connType;
+
+    OCStackResult res = PMDiscoverDevices(&options, ppFoundDevice);
     OIC_LOG(DEBUG, TAG, "OUT PMSingleDeviceDiscoveryInUnicast");
-    OICFree(pDInfo);
-    pDInfo = NULL;
     return res;
 }
 
 #ifdef MULTIPLE_OWNER
 
-static const unsigned int IOTIVITY_USECS_PER_MSEC = 1000;
 extern int MOTIsSupportedOnboardingType(OicSecDoxm_t *ptrDoxm);
 
 static OCStackApplicationResult MOTDeviceDiscoveryHandler(void *ctx, OCDoHandle UNUSED,
@@ -1482,73 +1643,16 @@ OCStackResult PMMultipleOwnerSingleDeviceDiscovery(unsigned short timeoutSeconds
         return OC_STACK_INVALID_PARAM;
     }
 
-    DiscoveryInfo discoveryInfo;
-    discoveryInfo.ppDevicesList = ppFoundDevice;
-    discoveryInfo.pCandidateList = NULL;
-    discoveryInfo.isOwnedDiscovery = false;
-    discoveryInfo.isSingleDiscovery = true;
-    discoveryInfo.isFound = false;
-    discoveryInfo.targetId = deviceID;
+    OCPMDiscoveryOptions_t options;
+    memset(&options, 0, sizeof(options));
+    options.timeout = timeoutSeconds;
+    options.targetId = deviceID;
+    options.connType = CT_DEFAULT;
 
-    OCCallbackData cbData;
-    cbData.cb = &MOTDeviceDiscoveryHandler;
-    cbData.context = (void *)&discoveryInfo;
-    cbData.cd = NULL;
-
-    OCStackResult res = OC_STACK_ERROR;
     const char query[] = "/oic/sec/doxm?mom!=0&owned=TRUE";
 
-    OCDoHandle handle = NULL;
-    res = OCDoResource(&handle, OC_REST_DISCOVER, query, 0, 0, CT_DEFAULT, OC_HIGH_QOS, &cbData, NULL, 0);
-    if (res != OC_STACK_OK)
-    {
-        OIC_LOG(ERROR, TAG, "OCStack resource error");
-        return res;
-    }
-
-    //Waiting for each response.
-    uint64_t startTime = OICGetCurrentTime(TIME_IN_MS);
-    while ((OC_STACK_OK == res) && !discoveryInfo.isFound)
-    {
-        uint64_t currTime = OICGetCurrentTime(TIME_IN_MS);
-        if (currTime >= startTime)
-        {
-            long elapsed = (long)((currTime - startTime) / MS_PER_SEC);
-            if (elapsed > timeoutSeconds)
-            {
-                break;
-            }
-
-            // Sleep for 100 ms to free up the CPU
-            usleep(100 * IOTIVITY_USECS_PER_MSEC);
-
-            res = OCProcess();
-        }
-        else
-        {
-            // System time has changed so we cannot reliably continue processing.
-            // Function returns with no device discovered.
-            break;
-        }
-    }
-
-    if (OC_STACK_OK != res)
-    {
-        OIC_LOG(ERROR, TAG, "Failed while waiting for a secure discovery response.");
-        OCStackResult resCancel = OCCancel(handle, OC_HIGH_QOS, NULL, 0);
-        if (OC_STACK_OK != resCancel)
-        {
-            OIC_LOG(ERROR, TAG, "Failed to remove registered callback");
-        }
-        return res;
-    }
-
-    res = OCCancel(handle, OC_HIGH_QOS, NULL, 0);
-    if (OC_STACK_OK != res)
-    {
-        OIC_LOG(ERROR, TAG, "Failed to remove the registered callback");
-        return res;
-    }
+    OCStackResult res = DiscoverDevices(&options, query, &MOTDeviceDiscoveryHandler,
+                                        ppFoundDevice);
     OIC_LOG(DEBUG, TAG, "OUT PMMultipleOwnerSingleDeviceDiscovery");
     return res;
 }
@@ -1574,58 +1678,18 @@ OCStackResult PMMultipleOwnerDeviceDiscovery(unsigned short waittime, bool isMul
     const char *DOXM_MOM_ENABLE_MULTICAST_QUERY = "/oic/sec/doxm?mom!=0&owned=TRUE";
     const char *DOXM_MULTIPLE_OWNED_MULTICAST_QUERY = "/oic/sec/doxm?owned=TRUE";
 
-    DiscoveryInfo *pDInfo = OICCalloc(1, sizeof(DiscoveryInfo));
-    if(NULL == pDInfo)
-    {
-        OIC_LOG(ERROR, TAG, "PMDeviceDiscovery : Memory allocation failed.");
-        return OC_STACK_NO_MEMORY;
-    }
-
-    pDInfo->ppDevicesList = ppDevicesList;
-    pDInfo->pCandidateList = NULL;
-    pDInfo->isOwnedDiscovery = isMultipleOwned;
-
-    OCCallbackData cbData;
-    cbData.cb = &MOTDeviceDiscoveryHandler;
-    cbData.context = (void *)pDInfo;
-    cbData.cd = NULL;
-    OCStackResult res = OC_STACK_ERROR;
+    OCPMDiscoveryOptions_t options;
+    memset(&options, 0, sizeof(options));
+    options.timeout = waittime;
+    options.isOwned = isMultipleOwned;
+    options.connType = CT_DEFAULT;
 
     const char* query = isMultipleOwned ? DOXM_MULTIPLE_OWNED_MULTICAST_QUERY :
                                           DOXM_MOM_ENABLE_MULTICAST_QUERY;
 
-    OCDoHandle handle = NULL;
-    res = OCDoResource(&handle, OC_REST_DISCOVER, query, 0, 0,
-                                     CT_DEFAULT, OC_HIGH_QOS, &cbData, NULL, 0);
-    if (res != OC_STACK_OK)
-    {
-        OIC_LOG(ERROR, TAG, "OCStack resource error");
-        OICFree(pDInfo);
-        return res;
-    }
-
-    //Waiting for each response.
-    res = PMTimeout(waittime, true);
-    if(OC_STACK_OK != res)
-    {
-        OIC_LOG(ERROR, TAG, "Failed to wait response for secure discovery.");
-        OICFree(pDInfo);
-        OCStackResult resCancel = OCCancel(handle, OC_HIGH_QOS, NULL, 0);
-        if(OC_STACK_OK !=  resCancel)
-        {
-            OIC_LOG(ERROR, TAG, "Failed to remove registered callback");
-        }
-        return res;
-    }
-    res = OCCancel(handle,OC_HIGH_QOS,NULL,0);
-    if (OC_STACK_OK != res)
-    {
-        OIC_LOG(ERROR, TAG, "Failed to remove registered callback");
-        OICFree(pDInfo);
-        return res;
-    }
+    OCStackResult res = DiscoverDevices(&options, query, &MOTDeviceDiscoveryHandler,
+                                        ppDevicesList);
     OIC_LOG(DEBUG, TAG, "OUT PMMultipleOwnerEnabledDeviceDiscovery");
-    OICFree(pDInfo);
     return res;
 }
 
@@ -1741,6 +1805,14 @@ static OCStackResult SpecVersionDiscovery(DiscoveryInfo* discoveryInfo,
         return OC_STACK_INVALID_PARAM;
     }
 
+    OCProvisionDev_t *pDev = GetDevice(discoveryInfo->ppDevicesList,
+                        clientResponse->devAddr.addr, clientResponse->devAddr.port);
+    if(NULL == pDev)
+    {
+        OIC_LOG(ERROR, TAG, "SpecVersionDiscovery : Failed to get device");
+        return OC_STACK_ERROR;
+    }
+
     //Try to the unicast discovery to getting security version
     char query[MAX_URI_LENGTH+MAX_QUERY_LENGTH+1] = {0};
     if(!PMGenerateQuery(false,
@@ -1757,16 +1829,18 @@ static OCStackResult SpecVersionDiscovery(DiscoveryInfo* discoveryInfo,
     cbData.cb = &SpecVersionDiscoveryHandler;
     cbData.context = (void*)discoveryInfo;
     cbData.cd = NULL;
-    OCStackResult ret = OCDoResource(NULL, OC_REST_DISCOVER, query, 0, 0,
+    OCStackResult ret = OCDoResource(&pDev->handle, OC_REST_DISCOVER, query, 0, 0,
             clientResponse->connType, OC_HIGH_QOS, &cbData, NULL, 0);
     if(OC_STACK_OK != ret)
     {
         OIC_LOG(ERROR, TAG, "Failed to Security Version Discovery");
+        pDev->handle = NULL;
         return ret;
     }
     else
     {
         OIC_LOG_V(INFO, TAG, "OCDoResource with [%s] Success", query);
+        discoveryInfo->pendingCount++;
     }
 
     OIC_LOG(DEBUG, TAG, "OUT SpecVersionDiscovery");
@@ -30,6 +30,7 @@
 #include "provisioningdatabasemanager.h"
 #include "pmutility.h"
 #include "oic_string.h"
+#include "octhread.h"
 #include "utlist.h"
 
 
@@ -49,6 +50,12 @@
 
 #define PDM_CREATE_T_DEVICE_LINK  "create table T_DEVICE_LINK_STATE(ID INT NOT NULL, ID2 INT NOT \
                                    NULL,STATE INT NOT NULL, PRIMARY KEY (ID, ID2));"
+
+/* The primary key only covers lookups of links by their first device. */
+#define PDM_CREATE_INDEXES "CREATE INDEX IF NOT EXISTS T_DEVICE_LINK_STATE_ID2 \
+                            ON T_DEVICE_LINK_STATE(ID2);"
+
+#define PDM_BUSY_TIMEOUT_MS 1000
 /**
  * Macro to verify sqlite success.
  * eg: VERIFY_NON_NULL(TAG, ptrData, ERROR,OC_STACK_ERROR);
@@ -57,9 +64,17 @@
             { OIC_LOG_V((logLevel), tag, "Error in " #arg ", Error Message: %s", \
                sqlite3_errmsg(g_db)); return retValue; }}while(0)
 
-#define PDM_SQLITE_TRANSACTION_BEGIN "BEGIN TRANSACTION;"
-#define PDM_SQLITE_TRANSACTION_COMMIT "COMMIT;"
-#define PDM_SQLITE_TRANSACTION_ROLLBACK "ROLLBACK;"
+/*
+ * Savepoints behave like transactions outside of a batch and nest inside of one,
+ * so each operation stays atomic when it is part of a batch.
+ */
+#define PDM_SQLITE_TRANSACTION_BEGIN "SAVEPOINT PDM_OPERATION;"
+#define PDM_SQLITE_TRANSACTION_COMMIT "RELEASE PDM_OPERATION;"
+#define PDM_SQLITE_TRANSACTION_ROLLBACK "ROLLBACK TO PDM_OPERATION; RELEASE PDM_OPERATION;"
+
+#define PDM_SQLITE_BATCH_BEGIN "SAVEPOINT PDM_BATCH;"
+#define PDM_SQLITE_BATCH_COMMIT "RELEASE PDM_BATCH;"
+#define PDM_SQLITE_BATCH_ROLLBACK "ROLLBACK TO PDM_BATCH; RELEASE PDM_BATCH;"
 
 #ifdef __GNUC__
 #if ((__GNUC__ >= 4) && (__GNUC_MINOR__ >= 6))
@@ -79,7 +94,7 @@ PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_GET_STALE_INFO);
 #define PDM_SQLITE_INSERT_T_DEVICE_LIST_SIZE (int)sizeof(PDM_SQLITE_INSERT_T_DEVICE_LIST)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_INSERT_T_DEVICE_LIST);
 
-#define PDM_SQLITE_GET_ID "SELECT ID FROM T_DEVICE_LIST WHERE UUID like ?"
+#define PDM_SQLITE_GET_ID "SELECT ID FROM T_DEVICE_LIST WHERE UUID = ?"
 #define PDM_SQLITE_GET_ID_SIZE (int)sizeof(PDM_SQLITE_GET_ID)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_GET_ID);
 
@@ -94,7 +109,11 @@ PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_DELETE_LINK);
 #define PDM_SQLITE_DELETE_DEVICE "DELETE FROM T_DEVICE_LIST  WHERE ID = ?"
 #define PDM_SQLITE_DELETE_DEVICE_SIZE (int)sizeof(PDM_SQLITE_DELETE_DEVICE)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_DELETE_DEVICE);
+
 #define PDM_SQLITE_DELETE_DEVICE_WITH_STATE "DELETE FROM T_DEVICE_LIST  WHERE STATE= ?"
+#define PDM_SQLITE_DELETE_DEVICE_WITH_STATE_SIZE (int)sizeof(PDM_SQLITE_DELETE_DEVICE_WITH_STATE)
+PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_DELETE_DEVICE_WITH_STATE);
+
 #define PDM_SQLITE_UPDATE_LINK "UPDATE T_DEVICE_LINK_STATE SET STATE = ?  WHERE ID = ? and ID2 = ?"
 #define PDM_SQLITE_UPDATE_LINK_SIZE (int)sizeof(PDM_SQLITE_UPDATE_LINK)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_UPDATE_LINK);
@@ -117,11 +136,11 @@ PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_GET_LINKED_DEVICES);
 #define PDM_SQLITE_GET_DEVICE_LINKS_SIZE (int)sizeof(PDM_SQLITE_GET_DEVICE_LINKS)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_GET_DEVICE_LINKS);
 
-#define PDM_SQLITE_UPDATE_DEVICE "UPDATE T_DEVICE_LIST SET STATE = ?  WHERE UUID like ?"
+#define PDM_SQLITE_UPDATE_DEVICE "UPDATE T_DEVICE_LIST SET STATE = ?  WHERE UUID = ?"
 #define PDM_SQLITE_UPDATE_DEVICE_SIZE (int)sizeof(PDM_SQLITE_UPDATE_DEVICE)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_UPDATE_DEVICE);
 
-#define PDM_SQLITE_GET_DEVICE_STATUS "SELECT STATE FROM T_DEVICE_LIST WHERE UUID like ?"
+#define PDM_SQLITE_GET_DEVICE_STATUS "SELECT STATE FROM T_DEVICE_LIST WHERE UUID = ?"
 #define PDM_SQLITE_GET_DEVICE_STATUS_SIZE (int)sizeof(PDM_SQLITE_GET_DEVICE_STATUS)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_GET_DEVICE_STATUS);
 
@@ -130,6 +149,56 @@ PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_GET_DEVICE_STATUS);
 #define PDM_SQLITE_UPDATE_LINK_STALE_FOR_STALE_DEVICE_SIZE (int)sizeof(PDM_SQLITE_UPDATE_LINK_STALE_FOR_STALE_DEVICE)
 PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_UPDATE_LINK_STALE_FOR_STALE_DEVICE);
 
+/**
+ * Ids of the statements kept prepared while the database is open.
+ */
+typedef enum
+{
+    PDM_STMT_GET_STALE_INFO = 0,
+    PDM_STMT_INSERT_T_DEVICE_LIST,
+    PDM_STMT_GET_ID,
+    PDM_STMT_INSERT_LINK_DATA,
+    PDM_STMT_DELETE_LINK,
+    PDM_STMT_DELETE_DEVICE,
+    PDM_STMT_DELETE_DEVICE_WITH_STATE,
+    PDM_STMT_UPDATE_LINK,
+    PDM_STMT_LIST_ALL_UUID,
+    PDM_STMT_GET_UUID,
+    PDM_STMT_GET_LINKED_DEVICES,
+    PDM_STMT_GET_DEVICE_LINKS,
+    PDM_STMT_UPDATE_DEVICE,
+    PDM_STMT_GET_DEVICE_STATUS,
+    PDM_STMT_UPDATE_LINK_STALE_FOR_STALE_DEVICE,
+    PDM_STMT_COUNT
+} PdmStatementId_t;
+
+typedef struct
+{
+    const char *sql;
+    int size;
+} PdmStatementSql_t;
+
+#define PDM_STATEMENT(name) { PDM_SQLITE_##name, PDM_SQLITE_##name##_SIZE }
+
+static const PdmStatementSql_t g_stmtSql[PDM_STMT_COUNT] =
+{
+    PDM_STATEMENT(GET_STALE_INFO),
+    PDM_STATEMENT(INSERT_T_DEVICE_LIST),
+    PDM_STATEMENT(GET_ID),
+    PDM_STATEMENT(INSERT_LINK_DATA),
+    PDM_STATEMENT(DELETE_LINK),
+    PDM_STATEMENT(DELETE_DEVICE),
+    PDM_STATEMENT(DELETE_DEVICE_WITH_STATE),
+    PDM_STATEMENT(UPDATE_LINK),
+    PDM_STATEMENT(LIST_ALL_UUID),
+    PDM_STATEMENT(GET_UUID),
+    PDM_STATEMENT(GET_LINKED_DEVICES),
+    PDM_STATEMENT(GET_DEVICE_LINKS),
+    PDM_STATEMENT(UPDATE_DEVICE),
+    PDM_STATEMENT(GET_DEVICE_STATUS),
+    PDM_STATEMENT(UPDATE_LINK_STALE_FOR_STALE_DEVICE)
+};
+
 
 #define ASCENDING_ORDER(id1, id2) do{if( (id1) > (id2) )\
   { int temp; temp = id1; id1 = id2; id2 = temp; }}while(0)
@@ -140,6 +209,88 @@ PDM_VERIFY_STATEMENT_SIZE(PDM_SQLITE_UPDATE_LINK_STALE_FOR_STALE_DEVICE);
 
 static sqlite3 *g_db = NULL;
 static bool gInit = false;  /* Only if we can open sqlite db successfully, gInit is true. */
+static sqlite3_stmt *g_stmts[PDM_STMT_COUNT] = { NULL };
+
+/**
+ * Lock for the database, the cached statements and the transactions. It is held for each
+ * PDM call and from PDMBeginBatch() until PDMEndBatch(), so it is recursive to let the calls
+ * of a batch and the PDM calls made by other PDM calls re-enter it.
+ */
+static oc_mutex g_pdmMutex = NULL;
+static int g_batchDepth = 0;  /* Number of PDMBeginBatch() calls holding g_pdmMutex. */
+
+/**
+ * Function to get a cached statement. It is prepared on first use and reset on later uses,
+ * so the caller only has to bind its parameters again.
+ */
+static int getStatement(PdmStatementId_t id, sqlite3_stmt **stmt)
+{
+    if (NULL == g_stmts[id])
+    {
+        int res = sqlite3_prepare_v2(g_db, g_stmtSql[id].sql, g_stmtSql[id].size,
+                                     &g_stmts[id], NULL);
+        if (SQLITE_OK != res)
+        {
+            g_stmts[id] = NULL;
+            return res;
+        }
+    }
+    else
+    {
+        sqlite3_reset(g_stmts[id]);
+    }
+    *stmt = g_stmts[id];
+    return SQLITE_OK;
+}
+
+/**
+ * Function to give back a statement got with getStatement(). Resetting it ends its read
+ * and clearing the bindings drops the pointers to the caller's UUIDs.
+ */
+static void releaseStatement(sqlite3_stmt *stmt)
+{
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+}
+
+/**
+ * Function to finalize the cached statements before the database is closed.
+ */
+static void finalizeStatements()
+{
+    for (size_t i = 0; i < PDM_STMT_COUNT; i++)
+    {
+        if (g_stmts[i])
+        {
+            sqlite3_finalize(g_stmts[i]);
+            g_stmts[i] = NULL;
+        }
+    }
+}
+
+/**
+ * Function to set up a newly opened database.
+ */
+static OCStackResult configureDB()
+{
+    int res = sqlite3_busy_timeout(g_db, PDM_BUSY_TIMEOUT_MS);
+    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+
+    /*
+     * Write-ahead logging makes a commit append to the log instead of rewriting the database
+     * pages, and lets readers run while a write is in progress. The journal mode is
+     * persistent, so this is a no-op after the first time.
+     */
+    if (SQLITE_OK != sqlite3_exec(g_db, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL))
+    {
+        OIC_LOG_V(WARNING, TAG, "Could not enable write-ahead logging: %s",
+                  sqlite3_errmsg(g_db));
+    }
+
+    res = sqlite3_exec(g_db, PDM_CREATE_INDEXES, NULL, NULL, NULL);
+    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    return OC_STACK_OK;
+}
 
 /**
  * function to create DB in case DB doesn't exists
@@ -160,6 +311,10 @@ static OCStackResult createDB(const char* path)
     PDM_VERIFY_SQLITE_OK(TAG, result, ERROR, OC_STACK_ERROR);
 
     OIC_LOG(INFO, TAG, "Created T_DEVICE_LINK_STATE");
+    if (OC_STACK_OK != configureDB())
+    {
+        return OC_STACK_ERROR;
+    }
     gInit = true;
 
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
@@ -212,7 +367,7 @@ void errLogCallback(void *pArg, int iErrCode, const char *zMsg)
     OIC_LOG_V(DEBUG,TAG, "%s : (%d) %s", __func__, iErrCode, zMsg);
 }
 
-OCStackResult PDMInit(const char *path)
+static OCStackResult openDB(const char *path)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -231,12 +386,24 @@ OCStackResult PDMInit(const char *path)
     {
         dbPath = path;
     }
+    if (g_db)
+    {
+        finalizeStatements();
+        sqlite3_close(g_db);
+        g_db = NULL;
+    }
     rc = sqlite3_open_v2(dbPath, &g_db, SQLITE_OPEN_READWRITE, NULL);
     if (SQLITE_OK != rc)
     {
         OIC_LOG_V(INFO, TAG, "ERROR: Can't open database: %s", sqlite3_errmsg(g_db));
+        sqlite3_close(g_db);
+        g_db = NULL;
         return createDB(dbPath);
     }
+    if (OC_STACK_OK != configureDB())
+    {
+        return OC_STACK_ERROR;
+    }
     gInit = true;
 
     /*
@@ -255,8 +422,25 @@ OCStackResult PDMInit(const char *path)
     return OC_STACK_OK;
 }
 
+OCStackResult PDMInit(const char *path)
+{
+    if (NULL == g_pdmMutex)
+    {
+        g_pdmMutex = oc_mutex_new_recursive();
+        if (NULL == g_pdmMutex)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to create mutex");
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = openDB(path);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
 
-OCStackResult PDMAddDevice(const OicUuid_t *UUID)
+
+static OCStackResult addDevice(const OicUuid_t *UUID)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -268,8 +452,7 @@ OCStackResult PDMAddDevice(const OicUuid_t *UUID)
 
     sqlite3_stmt *stmt = 0;
     int res =0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_INSERT_T_DEVICE_LIST,
-                              PDM_SQLITE_INSERT_T_DEVICE_LIST_SIZE, &stmt, NULL);
+    res = getStatement(PDM_STMT_INSERT_T_DEVICE_LIST, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_blob(stmt, PDM_BIND_INDEX_SECOND, UUID, UUID_LENGTH, SQLITE_STATIC);
@@ -285,19 +468,27 @@ OCStackResult PDMAddDevice(const OicUuid_t *UUID)
         {
             //new OCStack result code
             OIC_LOG_V(ERROR, TAG, "Error Occured: %s",sqlite3_errmsg(g_db));
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return OC_STACK_DUPLICATE_UUID;
         }
         OIC_LOG_V(ERROR, TAG, "Error Occured: %s",sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
 
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
 
+OCStackResult PDMAddDevice(const OicUuid_t *UUID)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = addDevice(UUID);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
 /**
  *function to get Id for given UUID
  */
@@ -307,8 +498,7 @@ static OCStackResult getIdForUUID(const OicUuid_t *UUID , int *id)
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_ID, PDM_SQLITE_GET_ID_SIZE,
-                             &stmt, NULL);
+    res = getStatement(PDM_STMT_GET_ID, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_blob(stmt, PDM_BIND_INDEX_FIRST, UUID, UUID_LENGTH, SQLITE_STATIC);
@@ -320,18 +510,18 @@ static OCStackResult getIdForUUID(const OicUuid_t *UUID , int *id)
         int tempId = sqlite3_column_int(stmt, PDM_FIRST_INDEX);
         OIC_LOG_V(DEBUG, TAG, "ID is %d", tempId);
         *id = tempId;
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
         return OC_STACK_OK;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return OC_STACK_INVALID_PARAM;
 }
 
 /**
  * Function to check duplication of device's Device ID.
  */
-OCStackResult PDMIsDuplicateDevice(const OicUuid_t* UUID, bool *result)
+static OCStackResult isDuplicateDevice(const OicUuid_t* UUID, bool *result)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -343,8 +533,7 @@ OCStackResult PDMIsDuplicateDevice(const OicUuid_t* UUID, bool *result)
     }
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_ID, PDM_SQLITE_GET_ID_SIZE,
-                             &stmt, NULL);
+    res = getStatement(PDM_STMT_GET_ID, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_blob(stmt, PDM_BIND_INDEX_FIRST, UUID, UUID_LENGTH, SQLITE_STATIC);
@@ -358,13 +547,21 @@ OCStackResult PDMIsDuplicateDevice(const OicUuid_t* UUID, bool *result)
         retValue = true;
     }
 
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     *result = retValue;
 
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
 
+OCStackResult PDMIsDuplicateDevice(const OicUuid_t* UUID, bool *result)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = isDuplicateDevice(UUID, result);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
 /**
  * Function to add link in sqlite
  */
@@ -374,8 +571,7 @@ static OCStackResult addlink(int id1, int id2)
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_INSERT_LINK_DATA,
-                              PDM_SQLITE_INSERT_LINK_DATA_SIZE, &stmt, NULL);
+    res = getStatement(PDM_STMT_INSERT_LINK_DATA, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id1);
@@ -390,15 +586,15 @@ static OCStackResult addlink(int id1, int id2)
     if (sqlite3_step(stmt) != SQLITE_DONE)
     {
         OIC_LOG_V(ERROR, TAG, "Error Occured: %s",sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
 
-OCStackResult PDMLinkDevices(const OicUuid_t *UUID1, const OicUuid_t *UUID2)
+static OCStackResult linkDevices(const OicUuid_t *UUID1, const OicUuid_t *UUID2)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -451,6 +647,14 @@ OCStackResult PDMLinkDevices(const OicUuid_t *UUID1, const OicUuid_t *UUID2)
     return addlink(id1, id2);
 }
 
+OCStackResult PDMLinkDevices(const OicUuid_t *UUID1, const OicUuid_t *UUID2)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = linkDevices(UUID1, UUID2);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
 /**
  * Function to remove created link
  */
@@ -460,8 +664,7 @@ static OCStackResult removeLink(int id1, int id2)
 
     int res = 0;
     sqlite3_stmt *stmt = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_DELETE_LINK,
-                             PDM_SQLITE_DELETE_LINK_SIZE, &stmt, NULL);
+    res = getStatement(PDM_STMT_DELETE_LINK, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id1);
@@ -473,15 +676,15 @@ static OCStackResult removeLink(int id1, int id2)
     if (SQLITE_DONE != sqlite3_step(stmt))
     {
         OIC_LOG_V(ERROR, TAG, "Error message: %s", sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
 
-OCStackResult PDMUnlinkDevices(const OicUuid_t *UUID1, const OicUuid_t *UUID2)
+static OCStackResult unlinkDevices(const OicUuid_t *UUID1, const OicUuid_t *UUID2)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -510,14 +713,21 @@ OCStackResult PDMUnlinkDevices(const OicUuid_t *UUID1, const OicUuid_t *UUID2)
     return removeLink(id1, id2);
 }
 
+OCStackResult PDMUnlinkDevices(const OicUuid_t *UUID1, const OicUuid_t *UUID2)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = unlinkDevices(UUID1, UUID2);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
 static OCStackResult removeFromDeviceList(int id)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_DELETE_DEVICE,
-                              PDM_SQLITE_DELETE_DEVICE_SIZE, &stmt, NULL);
+    res = getStatement(PDM_STMT_DELETE_DEVICE, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id);
@@ -526,15 +736,15 @@ static OCStackResult removeFromDeviceList(int id)
     if (sqlite3_step(stmt) != SQLITE_DONE)
     {
         OIC_LOG_V(ERROR, TAG, "Error message: %s", sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
 
-OCStackResult PDMDeleteDevice(const OicUuid_t *UUID)
+static OCStackResult deleteDevice(const OicUuid_t *UUID)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -561,6 +771,14 @@ OCStackResult PDMDeleteDevice(const OicUuid_t *UUID)
     return OC_STACK_OK;
 }
 
+OCStackResult PDMDeleteDevice(const OicUuid_t *UUID)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = deleteDevice(UUID);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
 
 static OCStackResult updateLinkState(int id1, int id2, int state)
 {
@@ -568,8 +786,7 @@ static OCStackResult updateLinkState(int id1, int id2, int state)
 
     sqlite3_stmt *stmt = 0;
     int res = 0 ;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_UPDATE_LINK,
-                              PDM_SQLITE_UPDATE_LINK_SIZE, &stmt, NULL);
+    res = getStatement(PDM_STMT_UPDATE_LINK, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, state);
@@ -584,15 +801,15 @@ static OCStackResult updateLinkState(int id1, int id2, int state)
     if (SQLITE_DONE != sqlite3_step(stmt))
     {
         OIC_LOG_V(ERROR, TAG, "Error message: %s", sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
 
-OCStackResult PDMSetLinkStale(const OicUuid_t* uuidOfDevice1, const OicUuid_t* uuidOfDevice2)
+static OCStackResult setLinkStale(const OicUuid_t* uuidOfDevice1, const OicUuid_t* uuidOfDevice2)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -621,7 +838,15 @@ OCStackResult PDMSetLinkStale(const OicUuid_t* uuidOfDevice1, const OicUuid_t* u
     return updateLinkState(id1, id2, PDM_DEVICE_STALE);
 }
 
-OCStackResult PDMGetOwnedDevices(OCUuidList_t **uuidList, size_t *numOfDevices)
+OCStackResult PDMSetLinkStale(const OicUuid_t* uuidOfDevice1, const OicUuid_t* uuidOfDevice2)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = setLinkStale(uuidOfDevice1, uuidOfDevice2);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
+static OCStackResult getOwnedDevices(OCUuidList_t **uuidList, size_t *numOfDevices)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -633,8 +858,7 @@ OCStackResult PDMGetOwnedDevices(OCUuidList_t **uuidList, size_t *numOfDevices)
     }
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_LIST_ALL_UUID,
-                              PDM_SQLITE_LIST_ALL_UUID_SIZE, &stmt, NULL);
+    res = getStatement(PDM_STMT_LIST_ALL_UUID, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     size_t counter  = 0;
@@ -646,7 +870,7 @@ OCStackResult PDMGetOwnedDevices(OCUuidList_t **uuidList, size_t *numOfDevices)
         if (NULL == temp)
         {
             OIC_LOG_V(ERROR, TAG, "Memory allocation problem");
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return OC_STACK_NO_MEMORY;
         }
         memcpy(&temp->dev.id, uid->id, UUID_LENGTH);
@@ -654,19 +878,26 @@ OCStackResult PDMGetOwnedDevices(OCUuidList_t **uuidList, size_t *numOfDevices)
         ++counter;
     }
     *numOfDevices = counter;
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
 
+OCStackResult PDMGetOwnedDevices(OCUuidList_t **uuidList, size_t *numOfDevices)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = getOwnedDevices(uuidList, numOfDevices);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
 static OCStackResult getUUIDforId(int id, OicUuid_t *uid, bool *result)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_UUID,
-                              PDM_SQLITE_GET_UUID_SIZE, &stmt, NULL);
+    res = getStatement(PDM_STMT_GET_UUID, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id);
@@ -692,15 +923,15 @@ static OCStackResult getUUIDforId(int id, OicUuid_t *uid, bool *result)
                 *result = false;
             }
         }
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_OK;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_INVALID_PARAM;
 }
 
-OCStackResult PDMGetLinkedDevices(const OicUuid_t *UUID, OCUuidList_t **UUIDLIST, size_t *numOfDevices)
+static OCStackResult getLinkedDevices(const OicUuid_t *UUID, OCUuidList_t **UUIDLIST, size_t *numOfDevices)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -736,8 +967,7 @@ OCStackResult PDMGetLinkedDevices(const OicUuid_t *UUID, OCUuidList_t **UUIDLIST
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_LINKED_DEVICES,
-                              PDM_SQLITE_GET_LINKED_DEVICES_SIZE, &stmt, NULL);
+    res = getStatement(PDM_STMT_GET_LINKED_DEVICES, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id);
@@ -766,7 +996,7 @@ OCStackResult PDMGetLinkedDevices(const OicUuid_t *UUID, OCUuidList_t **UUIDLIST
         if (NULL == tempNode)
         {
             OIC_LOG(ERROR, TAG, "No Memory");
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return OC_STACK_NO_MEMORY;
         }
         memcpy(&tempNode->dev.id, &temp.id, UUID_LENGTH);
@@ -774,12 +1004,20 @@ OCStackResult PDMGetLinkedDevices(const OicUuid_t *UUID, OCUuidList_t **UUIDLIST
         ++counter;
     }
     *numOfDevices = counter;
-     sqlite3_finalize(stmt);
+     releaseStatement(stmt);
      OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
      return OC_STACK_OK;
 }
 
-OCStackResult PDMGetToBeUnlinkedDevices(OCPairList_t **staleDevList, size_t *numOfDevices)
+OCStackResult PDMGetLinkedDevices(const OicUuid_t *UUID, OCUuidList_t **UUIDLIST, size_t *numOfDevices)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = getLinkedDevices(UUID, UUIDLIST, numOfDevices);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
+static OCStackResult getToBeUnlinkedDevices(OCPairList_t **staleDevList, size_t *numOfDevices)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -792,8 +1030,7 @@ OCStackResult PDMGetToBeUnlinkedDevices(OCPairList_t **staleDevList, size_t *num
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_STALE_INFO,
-                              PDM_SQLITE_GET_STALE_INFO_SIZE, &stmt, NULL);
+    res = getStatement(PDM_STMT_GET_STALE_INFO, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, PDM_DEVICE_STALE);
@@ -813,7 +1050,7 @@ OCStackResult PDMGetToBeUnlinkedDevices(OCPairList_t **staleDevList, size_t *num
         if (NULL == tempNode)
         {
             OIC_LOG(ERROR, TAG, "No Memory");
-            sqlite3_finalize(stmt);
+            releaseStatement(stmt);
             return OC_STACK_NO_MEMORY;
         }
         memcpy(&tempNode->dev.id, &temp1.id, UUID_LENGTH);
@@ -822,12 +1059,20 @@ OCStackResult PDMGetToBeUnlinkedDevices(OCPairList_t **staleDevList, size_t *num
         ++counter;
     }
     *numOfDevices = counter;
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
 
-OCStackResult PDMClose()
+OCStackResult PDMGetToBeUnlinkedDevices(OCPairList_t **staleDevList, size_t *numOfDevices)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = getToBeUnlinkedDevices(staleDevList, numOfDevices);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
+static OCStackResult closeDB()
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -835,6 +1080,7 @@ OCStackResult PDMClose()
     int res = 0;
     if (g_db)
     {
+        finalizeStatements();
         res = sqlite3_close(g_db);
         g_db = NULL;
     }
@@ -843,6 +1089,85 @@ OCStackResult PDMClose()
     return OC_STACK_OK;
 }
 
+OCStackResult PDMClose()
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = closeDB();
+    oc_mutex_unlock(g_pdmMutex);
+    if (OC_STACK_OK == res)
+    {
+        oc_mutex_free(g_pdmMutex);
+        g_pdmMutex = NULL;
+    }
+    return res;
+}
+
+static OCStackResult beginBatch()
+{
+    OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
+
+    CHECK_PDM_INIT(TAG);
+    int res = sqlite3_exec(g_db, PDM_SQLITE_BATCH_BEGIN, NULL, NULL, NULL);
+    PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+
+    OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
+    return OC_STACK_OK;
+}
+
+static OCStackResult endBatch(bool commitChanges)
+{
+    OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
+
+    CHECK_PDM_INIT(TAG);
+    int res = SQLITE_OK;
+    if (commitChanges)
+    {
+        res = sqlite3_exec(g_db, PDM_SQLITE_BATCH_COMMIT, NULL, NULL, NULL);
+        if (SQLITE_OK != res)
+        {
+            OIC_LOG_V(ERROR, TAG, "Failed to commit batch: %s", sqlite3_errmsg(g_db));
+            sqlite3_exec(g_db, PDM_SQLITE_BATCH_ROLLBACK, NULL, NULL, NULL);
+            return OC_STACK_ERROR;
+        }
+    }
+    else
+    {
+        res = sqlite3_exec(g_db, PDM_SQLITE_BATCH_ROLLBACK, NULL, NULL, NULL);
+        PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
+    return OC_STACK_OK;
+}
+
+OCStackResult PDMBeginBatch()
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = beginBatch();
+    if (OC_STACK_OK == res)
+    {
+        // Keep the lock until PDMEndBatch().
+        g_batchDepth++;
+        return res;
+    }
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
+OCStackResult PDMEndBatch(bool commitChanges)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = endBatch(commitChanges);
+    if (0 < g_batchDepth)
+    {
+        // Give back the lock taken by PDMBeginBatch(), even if the batch failed to end.
+        g_batchDepth--;
+        oc_mutex_unlock(g_pdmMutex);
+    }
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
 void PDMDestoryOicUuidLinkList(OCUuidList_t* ptr)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
@@ -877,7 +1202,7 @@ void PDMDestoryStaleLinkList(OCPairList_t* ptr)
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
 }
 
-OCStackResult PDMIsLinkExists(const OicUuid_t* uuidOfDevice1, const OicUuid_t* uuidOfDevice2,
+static OCStackResult isLinkExists(const OicUuid_t* uuidOfDevice1, const OicUuid_t* uuidOfDevice2,
                                bool* result)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
@@ -929,8 +1254,7 @@ OCStackResult PDMIsLinkExists(const OicUuid_t* uuidOfDevice1, const OicUuid_t* u
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_DEVICE_LINKS,
-                              PDM_SQLITE_GET_DEVICE_LINKS_SIZE, &stmt, NULL);
+    res = getStatement(PDM_STMT_GET_DEVICE_LINKS, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id1);
@@ -945,20 +1269,28 @@ OCStackResult PDMIsLinkExists(const OicUuid_t* uuidOfDevice1, const OicUuid_t* u
         OIC_LOG(INFO, TAG, "Link already exists between devices");
         ret = true;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     *result = ret;
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
 
+OCStackResult PDMIsLinkExists(const OicUuid_t* uuidOfDevice1, const OicUuid_t* uuidOfDevice2,
+                               bool* result)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = isLinkExists(uuidOfDevice1, uuidOfDevice2, result);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
 static OCStackResult updateDeviceState(const OicUuid_t *uuid, PdmDeviceState_t state)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
     sqlite3_stmt *stmt = 0;
     int res = 0 ;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_UPDATE_DEVICE,
-                              PDM_SQLITE_UPDATE_DEVICE_SIZE, &stmt, NULL);
+    res = getStatement(PDM_STMT_UPDATE_DEVICE, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, state);
@@ -970,10 +1302,10 @@ static OCStackResult updateDeviceState(const OicUuid_t *uuid, PdmDeviceState_t s
     if (SQLITE_DONE != sqlite3_step(stmt))
     {
         OIC_LOG_V(ERROR, TAG, "Error message: %s", sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
@@ -992,9 +1324,7 @@ static OCStackResult updateLinkForStaleDevice(const OicUuid_t *devUuid)
         return OC_STACK_INVALID_PARAM;
     }
 
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_UPDATE_LINK_STALE_FOR_STALE_DEVICE,
-                              PDM_SQLITE_UPDATE_LINK_STALE_FOR_STALE_DEVICE_SIZE,
-                               &stmt, NULL);
+    res = getStatement(PDM_STMT_UPDATE_LINK_STALE_FOR_STALE_DEVICE, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, id);
@@ -1006,15 +1336,15 @@ static OCStackResult updateLinkForStaleDevice(const OicUuid_t *devUuid)
     if (SQLITE_DONE != sqlite3_step(stmt))
     {
         OIC_LOG_V(ERROR, TAG, "Error message: %s", sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
 
-OCStackResult PDMSetDeviceState(const OicUuid_t* uuid, PdmDeviceState_t state)
+static OCStackResult setDeviceState(const OicUuid_t* uuid, PdmDeviceState_t state)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -1051,7 +1381,15 @@ OCStackResult PDMSetDeviceState(const OicUuid_t* uuid, PdmDeviceState_t state)
     return OC_STACK_OK;
 }
 
-OCStackResult PDMGetDeviceState(const OicUuid_t *uuid, PdmDeviceState_t* result)
+OCStackResult PDMSetDeviceState(const OicUuid_t* uuid, PdmDeviceState_t state)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = setDeviceState(uuid, state);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
+static OCStackResult getDeviceState(const OicUuid_t *uuid, PdmDeviceState_t* result)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -1063,8 +1401,7 @@ OCStackResult PDMGetDeviceState(const OicUuid_t *uuid, PdmDeviceState_t* result)
 
     sqlite3_stmt *stmt = 0;
     int res = 0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_GET_DEVICE_STATUS, PDM_SQLITE_GET_DEVICE_STATUS_SIZE,
-                              &stmt, NULL);
+    res = getStatement(PDM_STMT_GET_DEVICE_STATUS, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_blob(stmt, PDM_BIND_INDEX_FIRST, uuid, UUID_LENGTH, SQLITE_STATIC);
@@ -1077,12 +1414,20 @@ OCStackResult PDMGetDeviceState(const OicUuid_t *uuid, PdmDeviceState_t* result)
         OIC_LOG_V(DEBUG, TAG, "Device state is %d", tempStaleStateFromDb);
         *result = (PdmDeviceState_t)tempStaleStateFromDb;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
 
-OCStackResult PDMDeleteDeviceWithState(const PdmDeviceState_t state)
+OCStackResult PDMGetDeviceState(const OicUuid_t *uuid, PdmDeviceState_t* result)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = getDeviceState(uuid, result);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
+
+static OCStackResult deleteDeviceWithState(const PdmDeviceState_t state)
 {
     OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
 
@@ -1095,8 +1440,7 @@ OCStackResult PDMDeleteDeviceWithState(const PdmDeviceState_t state)
 
     sqlite3_stmt *stmt = 0;
     int res =0;
-    res = sqlite3_prepare_v2(g_db, PDM_SQLITE_DELETE_DEVICE_WITH_STATE,
-                              (int)strlen(PDM_SQLITE_DELETE_DEVICE_WITH_STATE) + 1, &stmt, NULL);
+    res = getStatement(PDM_STMT_DELETE_DEVICE_WITH_STATE, &stmt);
     PDM_VERIFY_SQLITE_OK(TAG, res, ERROR, OC_STACK_ERROR);
 
     res = sqlite3_bind_int(stmt, PDM_BIND_INDEX_FIRST, state);
@@ -1105,10 +1449,18 @@ OCStackResult PDMDeleteDeviceWithState(const PdmDeviceState_t state)
     if (SQLITE_DONE != sqlite3_step(stmt))
     {
         OIC_LOG_V(ERROR, TAG, "Error message: %s", sqlite3_errmsg(g_db));
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         return OC_STACK_ERROR;
     }
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
     return OC_STACK_OK;
 }
+
+OCStackResult PDMDeleteDeviceWithState(const PdmDeviceState_t state)
+{
+    oc_mutex_lock(g_pdmMutex);
+    OCStackResult res = deleteDeviceWithState(state);
+    oc_mutex_unlock(g_pdmMutex);
+    return res;
+}
@@ -2634,16 +2634,32 @@ static OCStackResult GetListofDevToReqDeleteCred(const OCProvisionDev_t* pRevoke
 
     size_t cnt = 0;
     OCUuidList_t *curUuid = NULL, *tmpUuid = NULL;
-    LL_FOREACH_SAFE(pLinkedUuidList, curUuid, tmpUuid)
+
+    // Mark the status of all the links stale in one transaction.
+    OCStackResult res = PDMBeginBatch();
+    if (OC_STACK_OK == res)
     {
-        // Mark the link status stale.
-        OCStackResult res = PDMSetLinkStale(&curUuid->dev, &pRevokeTargetDev->doxm->deviceID);
-        if (OC_STACK_OK != res)
+        LL_FOREACH_SAFE(pLinkedUuidList, curUuid, tmpUuid)
         {
-            OIC_LOG(FATAL, TAG, "PDMSetLinkStale() FAIL: PDB is an obsolete one.");
-            return OC_STACK_INCONSISTENT_DB;
+            res = PDMSetLinkStale(&curUuid->dev, &pRevokeTargetDev->doxm->deviceID);
+            if (OC_STACK_OK != res)
+            {
+                break;
+            }
         }
+        if (OC_STACK_OK != PDMEndBatch(OC_STACK_OK == res))
+        {
+            res = OC_STACK_INCONSISTENT_DB;
+        }
+    }
+    if (OC_STACK_OK != res)
+    {
+        OIC_LOG(FATAL, TAG, "PDMSetLinkStale() FAIL: PDB is an obsolete one.");
+        return OC_STACK_INCONSISTENT_DB;
+    }
 
+    LL_FOREACH_SAFE(pLinkedUuidList, curUuid, tmpUuid)
+    {
         if (pOwnedDevList)
         {
             // If this linked device is alive (power-on), add the deivce to the list.
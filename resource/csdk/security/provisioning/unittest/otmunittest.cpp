@@ -25,6 +25,8 @@
 #include "experimental/logger.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_time.h"
+#include "ocevent.h"
 #include "ocprovisioningmanager.h"
 #include "oxmjustworks.h"
 #include "oxmrandompin.h"
@@ -53,6 +55,8 @@ static OCProvisionDev_t* g_unownedDevices = NULL;
 static OCProvisionDev_t* g_ownedDevices = NULL;
 static int gNumOfUnownDevice = 0;
 static int gNumOfOwnDevice = 0;
+static size_t g_numOfProgress = 0;
+static size_t g_maxInProgress = 0;
 
 using namespace std;
 
@@ -220,6 +224,21 @@ static void removeDeviceCB(void* ctx, size_t UNUSED1, OCProvisionResult_t* UNUSE
     g_doneCB = true;
 }
 
+static void ownershipTransferProgressCB(void* ctx, const OCProvisionResult_t* res,
+                                        size_t nOfDone, size_t nOfDevices,
+                                        size_t nOfInProgress)
+{
+    OC_UNUSED(ctx);
+
+    OIC_LOG_V(DEBUG, TAG, "Ownership Transfer %" PRIuPTR "/%" PRIuPTR " done (%" PRIuPTR
+              " in progress), result: %d", nOfDone, nOfDevices, nOfInProgress, res->res);
+    g_numOfProgress = nOfDone;
+    if (nOfInProgress > g_maxInProgress)
+    {
+        g_maxInProgress = nOfInProgress;
+    }
+}
+
 static int waitCallbackRet(void)
 {
     for(int i = 0; !g_doneCB && OTM_TIMEOUT > i; ++i)
@@ -361,6 +380,71 @@ TEST(OCDiscoverUnownedDevices, Simple)
     EXPECT_EQ(OC_STACK_OK, OCClosePM());
 }
 
+TEST(OCDoConcurrentOwnershipTransfer, NullParam)
+{
+    OCProvisionDev_t device;
+    memset(&device, 0, sizeof(device));
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDoConcurrentOwnershipTransfer((void*)g_otmCtx, NULL, 2,
+              ownershipTransferProgressCB, ownershipTransferCB));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDoConcurrentOwnershipTransfer((void*)g_otmCtx, &device, 0,
+              ownershipTransferProgressCB, ownershipTransferCB));
+    EXPECT_EQ(OC_STACK_INVALID_CALLBACK, OCDoConcurrentOwnershipTransfer((void*)g_otmCtx, &device,
+              2, ownershipTransferProgressCB, NULL));
+}
+
+TEST(OCDoConcurrentOwnershipTransfer, Simple)
+{
+    //initialize Provisioning DB Manager
+    EXPECT_EQ(OC_STACK_OK, OCInitPM(PM_DB_FILE_NAME));
+    ASSERT_EQ(true, gNumOfUnownDevice > 0);
+
+    //The sample servers from 3 up are owned here, the others by OCDoOwnershipTransfer.
+    OCProvisionDev_t* devList = NULL;
+    OCProvisionDev_t* tempDev1 = NULL;
+    OCProvisionDev_t* tempDev2 = NULL;
+    size_t numOfDevice = 0;
+    LL_FOREACH_SAFE(g_unownedDevices, tempDev1, tempDev2)
+    {
+        if (3 <= (tempDev1->doxm->deviceID.id[UUID_LENGTH - 1] & 0x0F))
+        {
+            LL_DELETE(g_unownedDevices, tempDev1);
+            LL_APPEND(devList, tempDev1);
+            numOfDevice++;
+        }
+    }
+
+    //The test harness starts servers 3-6, two sessions need at least two of them.
+    if (2 > numOfDevice)
+    {
+        OCDeleteDiscoveredDevices(devList);
+        EXPECT_EQ(OC_STACK_OK, OCClosePM());
+        FAIL() << "Found " << numOfDevice << " sample servers for concurrent ownership transfer";
+    }
+
+    g_doneCB = false;
+    g_numOfProgress = 0;
+    g_maxInProgress = 0;
+    EXPECT_EQ(OC_STACK_OK, OCDoConcurrentOwnershipTransfer((void*)g_otmCtx, devList, 2,
+              ownershipTransferProgressCB, ownershipTransferCB));
+
+    if(waitCallbackRet())  // input |g_doneCB| flag implicitly
+    {
+        OIC_LOG(FATAL, TAG, "OCDoConcurrentOwnershipTransfer callback error");
+        OCDeleteDiscoveredDevices(devList);
+        return;
+    }
+
+    EXPECT_EQ(true, g_callbackResult);
+    EXPECT_EQ(true, g_doneCB);
+    EXPECT_EQ(numOfDevice, g_numOfProgress);
+    //The devices after the first one overlap with the device before them.
+    EXPECT_LT(1u, g_maxInProgress);
+    OCDeleteDiscoveredDevices(devList);
+    // close Provisioning DB
+    EXPECT_EQ(OC_STACK_OK, OCClosePM());
+}
+
 TEST(OCDoOwnershipTransfer, Simple)
 {
     //initialize Provisioning DB Manager
@@ -443,6 +527,136 @@ TEST(OCDiscoverOwnedDevices, Simple)
     EXPECT_EQ(OC_STACK_OK, OCClosePM());
 }
 
+TEST(OCDiscoverDevices, NullParam)
+{
+    OCPMDiscoveryOptions_t options;
+    memset(&options, 0, sizeof(options));
+    OCProvisionDev_t* devList = NULL;
+    OCPMDiscovery_t* discovery = NULL;
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDiscoverDevices(NULL, &devList));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDiscoverDevices(&options, &devList));
+    options.timeout = DISCOVERY_TIMEOUT;
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDiscoverDevices(&options, NULL));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCStartDeviceDiscovery(&options, NULL));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCFinishDeviceDiscovery(NULL, &devList));
+    EXPECT_EQ(true, OCIsDeviceDiscoveryDone(discovery, NULL));
+}
+
+TEST(OCDiscoverDevices, QuietPeriod)
+{
+    //initialize Provisioning DB Manager
+    EXPECT_EQ(OC_STACK_OK, OCInitPM(PM_DB_FILE_NAME));
+
+    OCPMDiscoveryOptions_t options;
+    memset(&options, 0, sizeof(options));
+    options.timeout = DISCOVERY_TIMEOUT;
+    options.isOwned = true;
+    options.quietPeriodMs = 1000;
+    OCProvisionDev_t* devList = NULL;
+
+    uint64_t startTime = OICGetCurrentTime(TIME_IN_MS);
+    EXPECT_EQ(OC_STACK_OK, OCDiscoverDevices(&options, &devList));
+    uint64_t elapsed = OICGetCurrentTime(TIME_IN_MS) - startTime;
+
+    // The owned devices answer well within the quiet period, so the timeout is not waited for.
+    EXPECT_TRUE(NULL != devList);
+    EXPECT_GT((uint64_t)DISCOVERY_TIMEOUT * MS_PER_SEC, elapsed);
+
+    OCDeleteDiscoveredDevices(devList);
+    // close Provisioning DB
+    EXPECT_EQ(OC_STACK_OK, OCClosePM());
+}
+
+TEST(OCStartDeviceDiscovery, ExpectedCount)
+{
+    //initialize Provisioning DB Manager
+    EXPECT_EQ(OC_STACK_OK, OCInitPM(PM_DB_FILE_NAME));
+    ASSERT_EQ(true, gNumOfOwnDevice > 0);
+
+    OCPMDiscoveryOptions_t options;
+    memset(&options, 0, sizeof(options));
+    options.timeout = DISCOVERY_TIMEOUT;
+    options.isOwned = true;
+    options.expectedCount = gNumOfOwnDevice;
+    OCPMDiscovery_t* discovery = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCStartDeviceDiscovery(&options, &discovery));
+
+    oc_event processEvent = oc_event_new();
+    ASSERT_TRUE(NULL != processEvent);
+    EXPECT_EQ(OC_STACK_OK, OCRegisterProcessEvent(processEvent));
+
+    uint64_t startTime = OICGetCurrentTime(TIME_IN_MS);
+    uint32_t waitMs = 0;
+    while (!OCIsDeviceDiscoveryDone(discovery, &waitMs))
+    {
+        oc_event_wait_for(processEvent, (waitMs < 100) ? waitMs : 100);
+        EXPECT_EQ(OC_STACK_OK, OCProcess());
+    }
+    uint64_t elapsed = OICGetCurrentTime(TIME_IN_MS) - startTime;
+
+    OCUnregisterProcessEvent(processEvent);
+    oc_event_free(processEvent);
+
+    OCProvisionDev_t* devList = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCFinishDeviceDiscovery(discovery, &devList));
+
+    OCProvisionDev_t* tempDev = NULL;
+    int numOfDevices = 0;
+    LL_COUNT(devList, tempDev, numOfDevices);
+    EXPECT_LE(gNumOfOwnDevice, numOfDevices);
+    EXPECT_GT((uint64_t)DISCOVERY_TIMEOUT * MS_PER_SEC, elapsed);
+
+    OCDeleteDiscoveredDevices(devList);
+    // close Provisioning DB
+    EXPECT_EQ(OC_STACK_OK, OCClosePM());
+}
+
+TEST(OCDiscoverDevices, KeepsApplicationProcessEvent)
+{
+    //initialize Provisioning DB Manager
+    EXPECT_EQ(OC_STACK_OK, OCInitPM(PM_DB_FILE_NAME));
+    ASSERT_EQ(true, gNumOfOwnDevice > 0);
+
+    oc_event appEvent = oc_event_new();
+    ASSERT_TRUE(NULL != appEvent);
+    EXPECT_EQ(OC_STACK_OK, OCRegisterProcessEvent(appEvent));
+
+    OCPMDiscoveryOptions_t options;
+    memset(&options, 0, sizeof(options));
+    options.timeout = DISCOVERY_TIMEOUT;
+    options.isOwned = true;
+    options.expectedCount = gNumOfOwnDevice;
+    OCProvisionDev_t* devList = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCDiscoverDevices(&options, &devList));
+    OCDeleteDiscoveredDevices(devList);
+    devList = NULL;
+
+    // Deliver whatever is still waiting, then forget the signals raised during the discovery.
+    EXPECT_EQ(OC_STACK_OK, OCProcess());
+    oc_event_wait_for(appEvent, 0);
+
+    // The responses to the next discovery must still signal the application event.
+    OCPMDiscovery_t* discovery = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCStartDeviceDiscovery(&options, &discovery));
+    EXPECT_EQ(OC_WAIT_SUCCESS,
+              oc_event_wait_for(appEvent, (uint32_t)DISCOVERY_TIMEOUT * MS_PER_SEC));
+
+    uint32_t waitMs = 0;
+    while (!OCIsDeviceDiscoveryDone(discovery, &waitMs))
+    {
+        oc_event_wait_for(appEvent, (waitMs < 100) ? waitMs : 100);
+        EXPECT_EQ(OC_STACK_OK, OCProcess());
+    }
+    EXPECT_EQ(OC_STACK_OK, OCFinishDeviceDiscovery(discovery, &devList));
+    OCDeleteDiscoveredDevices(devList);
+
+    OCUnregisterProcessEvent(appEvent);
+    oc_event_free(appEvent);
+    // close Provisioning DB
+    EXPECT_EQ(OC_STACK_OK, OCClosePM());
+}
+
 TEST(PerformLinkDevices, NullParam)
 {
     if (gNumOfOwnDevice < 2)
@@ -19,6 +19,9 @@
  * *****************************************************************/
 #include "iotivity_config.h"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include "provisioningdatabasemanager.h"
 
 #ifdef _MSC_VER
@@ -42,6 +45,12 @@ const char ID_10[] = "1222222222222222";
 const char ID_11[] = "2222222222222222";
 const char ID_12[] = "3222222222222222";
 const char ID_13[] = "4222222222222222";
+const char ID_14[] = "5222222222222222";
+const char ID_15[] = "6222222222222222";
+const char ID_16[] = "7222222222222222";
+const char ID_17[] = "8222222222222222";
+const char ID_18[] = "9222222222222222";
+const char ID_19[] = "1333333333333333";
 
 
 TEST(CallPDMAPIbeforeInit, BeforeInit)
@@ -58,6 +67,8 @@ TEST(CallPDMAPIbeforeInit, BeforeInit)
     EXPECT_EQ(OC_STACK_PDM_IS_NOT_INITIALIZED, PDMGetOwnedDevices(NULL, NULL));
     EXPECT_EQ(OC_STACK_PDM_IS_NOT_INITIALIZED, PDMGetLinkedDevices(NULL, NULL, NULL));
     EXPECT_EQ(OC_STACK_PDM_IS_NOT_INITIALIZED, PDMSetLinkStale(NULL, NULL));
+    EXPECT_EQ(OC_STACK_PDM_IS_NOT_INITIALIZED, PDMBeginBatch());
+    EXPECT_EQ(OC_STACK_PDM_IS_NOT_INITIALIZED, PDMEndBatch(true));
     EXPECT_EQ(OC_STACK_PDM_IS_NOT_INITIALIZED, PDMGetToBeUnlinkedDevices(NULL, NULL));
     EXPECT_EQ(OC_STACK_PDM_IS_NOT_INITIALIZED, PDMIsLinkExists(NULL, NULL, NULL));
 }
@@ -437,3 +448,102 @@ TEST(PDMSetDeviceStaleTest, StaleDeviceNotinLinkedDevice)
     }
     EXPECT_EQ(OC_STACK_OK, PDMClose());
 }
+
+TEST(PDMBatchTest, EndWithoutBegin)
+{
+    EXPECT_EQ(OC_STACK_OK, PDMInit(NULL));
+    EXPECT_EQ(OC_STACK_ERROR, PDMEndBatch(true));
+    EXPECT_EQ(OC_STACK_OK, PDMClose());
+}
+
+TEST(PDMBatchTest, CommitBatch)
+{
+    EXPECT_EQ(OC_STACK_OK, PDMInit(NULL));
+    OicUuid_t uid1 = {{0,}};
+    memcpy(&uid1.id, ID_14, sizeof(uid1.id));
+    OicUuid_t uid2 = {{0,}};
+    memcpy(&uid2.id, ID_15, sizeof(uid2.id));
+
+    EXPECT_EQ(OC_STACK_OK, PDMBeginBatch());
+    EXPECT_EQ(OC_STACK_OK, PDMAddDevice(&uid1));
+    EXPECT_EQ(OC_STACK_OK, PDMSetDeviceState(&uid1, PDM_DEVICE_ACTIVE));
+    EXPECT_EQ(OC_STACK_OK, PDMAddDevice(&uid2));
+    EXPECT_EQ(OC_STACK_OK, PDMSetDeviceState(&uid2, PDM_DEVICE_ACTIVE));
+    // A failed update inside a batch does not undo the other updates.
+    EXPECT_EQ(OC_STACK_DUPLICATE_UUID, PDMAddDevice(&uid2));
+    EXPECT_EQ(OC_STACK_OK, PDMLinkDevices(&uid1, &uid2));
+    EXPECT_EQ(OC_STACK_OK, PDMEndBatch(true));
+    EXPECT_EQ(OC_STACK_OK, PDMClose());
+
+    EXPECT_EQ(OC_STACK_OK, PDMInit(NULL));
+    bool result = false;
+    EXPECT_EQ(OC_STACK_OK, PDMIsLinkExists(&uid1, &uid2, &result));
+    EXPECT_TRUE(result);
+    EXPECT_EQ(OC_STACK_OK, PDMClose());
+}
+
+TEST(PDMBatchTest, RollbackBatch)
+{
+    EXPECT_EQ(OC_STACK_OK, PDMInit(NULL));
+    OicUuid_t uid1 = {{0,}};
+    memcpy(&uid1.id, ID_16, sizeof(uid1.id));
+
+    EXPECT_EQ(OC_STACK_OK, PDMBeginBatch());
+    EXPECT_EQ(OC_STACK_OK, PDMAddDevice(&uid1));
+    EXPECT_EQ(OC_STACK_OK, PDMSetDeviceState(&uid1, PDM_DEVICE_ACTIVE));
+    EXPECT_EQ(OC_STACK_OK, PDMEndBatch(false));
+
+    bool result = true;
+    EXPECT_EQ(OC_STACK_OK, PDMIsDuplicateDevice(&uid1, &result));
+    EXPECT_FALSE(result);
+    EXPECT_EQ(OC_STACK_OK, PDMClose());
+}
+
+TEST(PDMBatchTest, NestedBatch)
+{
+    EXPECT_EQ(OC_STACK_OK, PDMInit(NULL));
+    OicUuid_t uid1 = {{0,}};
+    memcpy(&uid1.id, ID_17, sizeof(uid1.id));
+    OicUuid_t uid2 = {{0,}};
+    memcpy(&uid2.id, ID_18, sizeof(uid2.id));
+
+    EXPECT_EQ(OC_STACK_OK, PDMBeginBatch());
+    EXPECT_EQ(OC_STACK_OK, PDMBeginBatch());
+    EXPECT_EQ(OC_STACK_OK, PDMAddDevice(&uid1));
+    EXPECT_EQ(OC_STACK_OK, PDMEndBatch(false));
+    EXPECT_EQ(OC_STACK_OK, PDMAddDevice(&uid2));
+    EXPECT_EQ(OC_STACK_OK, PDMEndBatch(true));
+
+    bool result = true;
+    EXPECT_EQ(OC_STACK_OK, PDMIsDuplicateDevice(&uid1, &result));
+    EXPECT_FALSE(result);
+    EXPECT_EQ(OC_STACK_OK, PDMIsDuplicateDevice(&uid2, &result));
+    EXPECT_TRUE(result);
+    EXPECT_EQ(OC_STACK_OK, PDMClose());
+}
+
+TEST(PDMBatchTest, BatchHoldsOffOtherThreads)
+{
+    EXPECT_EQ(OC_STACK_OK, PDMInit(NULL));
+    OicUuid_t uid1 = {{0,}};
+    memcpy(&uid1.id, ID_19, sizeof(uid1.id));
+
+    EXPECT_EQ(OC_STACK_OK, PDMBeginBatch());
+    std::atomic<bool> added(false);
+    std::thread adder([&]()
+    {
+        EXPECT_EQ(OC_STACK_OK, PDMAddDevice(&uid1));
+        added = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(added);
+    EXPECT_EQ(OC_STACK_OK, PDMEndBatch(false));
+    adder.join();
+    EXPECT_TRUE(added);
+
+    // The update of the other thread is not part of the rolled back batch.
+    bool result = false;
+    EXPECT_EQ(OC_STACK_OK, PDMIsDuplicateDevice(&uid1, &result));
+    EXPECT_TRUE(result);
+    EXPECT_EQ(OC_STACK_OK, PDMClose());
+}
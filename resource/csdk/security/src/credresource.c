@@ -1542,6 +1542,11 @@ static bool UpdatePersistentStorage(const OicSecCred_t *cred)
 
     OIC_LOG(DEBUG, TAG, "OUT Cred UpdatePersistentStorage");
 
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    // gCred has changed, so certificates parsed for earlier handshakes are stale.
+    CAnotifyCredentialsChanged();
+#endif
+
     logCredMetadata();
 
     return ret;
@@ -2149,8 +2154,8 @@ static OCEntityHandlerResult HandleNewCredential(OCEntityHandlerRequest *ehReque
         {
             case SYMMETRIC_PAIR_WISE_KEY:
             {
-                OCServerRequest *request = (OCServerRequest *)ehRequest->requestHandle;
-                if(FillPrivateDataOfOwnerPSK(cred, (CAEndpoint_t *)&request->devAddr, doxm))
+                OCServerRequest *request = GetServerRequestUsingHandle(ehRequest->requestHandle);
+                if(request && FillPrivateDataOfOwnerPSK(cred, (CAEndpoint_t *)&request->devAddr, doxm))
                 {
                     if(OC_STACK_RESOURCE_DELETED == RemoveCredential(&cred->subject))
                     {
@@ -2251,8 +2256,8 @@ static OCEntityHandlerResult HandleNewCredential(OCEntityHandlerRequest *ehReque
         {
             case SYMMETRIC_PAIR_WISE_KEY:
             {
-                OCServerRequest *request = (OCServerRequest *)ehRequest->requestHandle;
-                if(FillPrivateDataOfSubOwnerPSK(cred, (CAEndpoint_t *)&request->devAddr, doxm, &cred->subject))
+                OCServerRequest *request = GetServerRequestUsingHandle(ehRequest->requestHandle);
+                if(request && FillPrivateDataOfSubOwnerPSK(cred, (CAEndpoint_t *)&request->devAddr, doxm, &cred->subject))
                 {
                     if(OC_STACK_RESOURCE_DELETED == RemoveCredential(&cred->subject))
                     {
@@ -2678,6 +2683,9 @@ OCStackResult DeInitCredResource()
     OCStackResult result = OCDeleteResource(gCredHandle);
     DeleteCredList(gCred);
     gCred = NULL;
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    CAnotifyCredentialsChanged();
+#endif
     return result;
 }
 
@@ -31,6 +31,7 @@
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "crlresource.h"
+#include "casecurityinterface.h"
 #include "ocpayloadcbor.h"
 #include "mbedtls/base64.h"
 #include <time.h>
@@ -455,7 +456,10 @@ OCStackResult UpdateCRLResource(OicSecCrl_t *crl)
         return res;
     }
 
-    return UpdateSecureResourceInPS(OIC_CBOR_CRL_NAME, payload, size);
+    res = UpdateSecureResourceInPS(OIC_CBOR_CRL_NAME, payload, size);
+    // The SSL adapter reads the CRL from PS, so reload it after the update.
+    CAnotifyCredentialsChanged();
+    return res;
 }
 
 static bool ValidateQuery(const char * query)
@@ -711,6 +715,7 @@ OCStackResult DeInitCRLResource()
     gCrlHandle = NULL;
     DeleteCrl(gCrl);
     gCrl = NULL;
+    CAnotifyCredentialsChanged();
     return result;
 }
 
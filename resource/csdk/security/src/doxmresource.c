@@ -1369,7 +1369,13 @@ OCEntityHandlerResult StartOTMJustWorks(OCEntityHandlerRequest *ehRequest)
             OicUuid_t deviceID = {.id = {0}};
 
             //Generate mutualVerifNum
-            OCServerRequest * request = (OCServerRequest *)ehRequest->requestHandle;
+            OCServerRequest * request = GetServerRequestUsingHandle(ehRequest->requestHandle);
+            if (NULL == request)
+            {
+                OIC_LOG(ERROR, TAG, "Server request of the request handle not found");
+                ehRet = OC_EH_ERROR;
+                goto exit;
+            }
 
             char label[LABEL_LEN] = {0};
             snprintf(label, LABEL_LEN, "%s%s", MUTUAL_VERIF_NUM, OXM_MV_JUST_WORKS);
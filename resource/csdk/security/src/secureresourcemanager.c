@@ -21,6 +21,7 @@
 #include <string.h>
 #include "ocstack.h"
 #include "experimental/logger.h"
+#include "trace.h"
 #include "cainterface.h"
 #include "resourcemanager.h"
 #include "credresource.h"
@@ -356,7 +357,11 @@ void SRMRequestHandler(const CAEndpoint_t *endPoint, const CARequestInfo_t *requ
     OIC_LOG_V(DEBUG, TAG, "Processing request with uri, %s for method %d",
         ctx->requestInfo->info.resourceUri, ctx->requestInfo->method);
 
+    OIC_TRACE_BEGIN(%s:CheckPermission, TAG);
+    OIC_TRACE_BUFFER("OIC_SRM:CheckPermission:token:",
+                     (const uint8_t *) requestInfo->info.token, requestInfo->info.tokenLength);
     CheckPermission(ctx);
+    OIC_TRACE_END();
 
     OIC_LOG_V(DEBUG, TAG, "Request for permission %d received responseVal %d.",
         ctx->requestedPermission, ctx->responseVal);
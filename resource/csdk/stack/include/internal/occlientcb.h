@@ -76,6 +76,9 @@ typedef struct ClientCB {
     /** callback method to delete context data. */
     OCClientContextDeleter deleteCallback;
 
+    /** callback method for the blocks of a streamed response, if requested. */
+    OCClientResponseChunkHandler chunkHandler;
+
     /** Qos for the request */
     CAMessageType_t type;
 
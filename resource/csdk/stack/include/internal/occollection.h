@@ -47,4 +47,45 @@ OCRepPayload** BuildCollectionLinksPayloadArray(const char* resourceUri,
                     bool isOCFContentFormat, OCDevAddr* devAddr, bool insertSelfLink,
                     size_t* createdArraySize);
 
+/**
+ * Send the batch responses of the collections whose resources all responded, and of those
+ * whose deadline has expired with the responses received so far. Called from OCProcess.
+ */
+void ProcessBatchDeadlines();
+
+/**
+ * Store the response of a resource to a batch request served concurrently. The request handle
+ * is compared with those of the pending batch requests before it is used, so responses with a
+ * handle of a batch request which was already answered and freed are recognized.
+ *
+ * @param ehResponse Response passed to OCDoResponse.
+ * @param result     Set to the result of OCDoResponse if the handle belongs to a batch request.
+ *
+ * @return true if the handle belongs to a pending batch request, false otherwise.
+ */
+bool HandleBatchChildResponse(OCEntityHandlerResponse *ehResponse, OCStackResult *result);
+
+/**
+ * Get the request passed to the entity handler which the calling batch worker thread runs.
+ *
+ * @param handle Request handle passed to the entity handler.
+ *
+ * @return the request if the calling thread runs the entity handler of the handle, else NULL.
+ */
+OCServerRequest *GetRunningBatchChildRequest(OCRequestHandle handle);
+
+/**
+ * Skip the queued entity handler calls of batch requests to a resource and wait until the
+ * running ones returned. Called before the resource is deleted.
+ *
+ * @param resource Resource being deleted.
+ */
+void CancelBatchRequestsForResource(OCResource *resource);
+
+/**
+ * Stop the threads running entity handlers for batch requests and free the pending batch
+ * requests.
+ */
+void TerminateBatchRequests();
+
 #endif //OC_COLLECTION_H
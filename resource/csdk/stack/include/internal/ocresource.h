@@ -250,6 +250,10 @@ typedef struct OCResource {
 
     /** Resource endpoint type(s). */
     OCTpsSchemeFlags endpointType;
+
+    /** Time in milliseconds a batch request of the collection waits for its resources when their
+     *  entity handlers run concurrently, 0 if they are called sequentially.*/
+    uint32_t batchDeadlineMs;
 } OCResource;
 
 /**
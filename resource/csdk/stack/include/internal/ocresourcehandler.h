@@ -266,6 +266,18 @@ OCStackResult DevicePropertiesToCBORPayload(const OCDeviceProperties *deviceProp
  */
 OCStackResult CBORPayloadToDeviceProperties(const uint8_t *payload, size_t size, OCDeviceProperties **deviceProperties);
 
+/**
+ * Internal API used to invalidate the cached /oic/res responses.  Must be called whenever
+ * something included in a discovery response changes: resources, their types, interfaces or
+ * properties, the device name or the network interfaces.
+ */
+void InvalidateDiscoveryCache();
+
+/**
+ * Internal API used to free the cached /oic/res responses.
+ */
+void DeleteDiscoveryCache();
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -85,7 +85,7 @@ typedef struct OCServerRequest
     /** Remote endpoint address **/
     OCDevAddr devAddr;
 
-    /** The ID of server request*/
+    /** The ID of server request, passed to entity handlers as the request handle.*/
     uint32_t requestId;
 
     /** Token for the request.*/
@@ -112,12 +112,24 @@ typedef struct OCServerRequest
     /** Node entry in red-black tree of linked lists.*/
     RBL_ENTRY(OCServerRequest) entry;
 
+    /** Node entry in red-black tree of requests by ID.*/
+    RB_ENTRY(OCServerRequest) idEntry;
+
     /** Flag indicating slow response.*/
     uint8_t slowFlag;
 
     /** Flag indicating notification.*/
     uint8_t notificationFlag;
 
+    /**
+     * Already encoded response payload, sent instead of converting the payload of the
+     * entity handler response.  Owned by the caller of OCDoResponse.
+     */
+    const uint8_t *encodedPayload;
+
+    /** Size of encodedPayload.*/
+    size_t encodedPayloadSize;
+
     /** Payload format retrieved from the received request PDU. */
     OCPayloadFormat payloadFormat;
 
@@ -217,6 +229,34 @@ OCServerRequest * GetServerRequestUsingToken (const CAToken_t token, uint8_t tok
  */
 void DeleteServerRequest(OCServerRequest * serverRequest);
 
+/**
+ * Generate the ID of a new server request. IDs are not reused while a server request with the
+ * same ID is in the server request list.
+ *
+ * @return the ID, never 0.
+ */
+uint32_t GenerateServerRequestId();
+
+/**
+ * Get the handle of a server request which is passed to its entity handler.
+ *
+ * @param[in]  serverRequest    server request.
+ *
+ * @return the request handle.
+ */
+OCRequestHandle GetServerRequestHandle(const OCServerRequest * serverRequest);
+
+/**
+ * Get a server request using the handle passed to its entity handler. The handle is only a key,
+ * so the handle of a deleted request is not found even if a new request was allocated at the
+ * same address.
+ *
+ * @param[in]  handle           request handle.
+ *
+ * @return address of the server request if found, otherwise NULL
+ */
+OCServerRequest * GetServerRequestUsingHandle(OCRequestHandle handle);
+
 /**
  * Handler function for sending a response from a single resource
  *
@@ -324,6 +324,21 @@ OCStackResult OCUpdateResourceInsWithResponse(const char *requestUri,
                                               const OCClientResponse *response);
 #endif
 
+#ifdef RD_SERVER
+/**
+ * Create the lock of the RD database used to answer discovery requests.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCRDDatabaseDiscoveryInitialize();
+
+/**
+ * Close the connection to the RD database used to answer discovery requests, stop the
+ * sweep of expired devices and free the lock.
+ */
+void OCRDDatabaseDiscoveryTerminate();
+#endif
+
 /**
  * Delete all of the dynamically allocated elements that were created for the resource attributes.
  *
@@ -130,6 +130,35 @@ OCStackResult OC_CALL OCStopMulticastServer();
  */
 OCStackResult OC_CALL OCProcess();
 
+struct oc_event_t;
+
+/**
+ * This function registers an event that the stack signals whenever a received request,
+ * response or error is waiting for OCProcess(). The event stays signalled until
+ * OCProcess() has delivered every waiting message, so a main loop can wait on it instead
+ * of polling. OCProcess() must still be called periodically to run presence, keep alive
+ * and other timers, so waits on the event should be bounded. Single threaded builds read
+ * the network from OCProcess() itself and never signal the event.
+ * Several events can be registered at the same time, e.g. by the application and by a
+ * provisioning wait; each of them is signalled.
+ *
+ * @param event       Event created with oc_event_new(). It must stay valid until it is
+ *                    unregistered with OCUnregisterProcessEvent() or the stack is stopped.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCRegisterProcessEvent(struct oc_event_t *event);
+
+/**
+ * This function unregisters an event registered with OCRegisterProcessEvent().
+ * Other registered events are still signalled.
+ *
+ * @param event       Event to unregister.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCUnregisterProcessEvent(struct oc_event_t *event);
+
 /**
  * This function discovers or Perform requests on a specified resource
  * (specified by that Resource's respective URI).
@@ -222,6 +251,46 @@ OCStackResult OC_CALL OCDoRequest(OCDoHandle *handle,
                           OCHeaderOption *options,
                           uint8_t numOptions);
 
+/**
+ * This function behaves like ::OCDoRequest, but if the response is transferred block-wise
+ * its blocks are passed to chunkHandler as they arrive instead of being reassembled first,
+ * so memory use stays in the order of the block size.
+ *
+ * After the last block has been passed to chunkHandler, cbData is called with the final
+ * result and without payload. A response which is not transferred block-wise is delivered
+ * to cbData with its payload as usual. Streaming is not supported for multicast requests.
+ *
+ * @note Only the reception of a Block2 response is streamed. A Block1 request payload is
+ *       still reassembled before it reaches the entity handler, and a server still
+ *       responds with a complete payload which the block-wise layer splits into blocks.
+ *
+ * @param handle            See ::OCDoRequest.
+ * @param method            See ::OCDoRequest.
+ * @param requestUri        See ::OCDoRequest.
+ * @param destination       See ::OCDoRequest.
+ * @param payload           See ::OCDoRequest.
+ * @param connectivityType  See ::OCDoRequest.
+ * @param qos               See ::OCDoRequest.
+ * @param cbData            See ::OCDoRequest.
+ * @param chunkHandler      Callback invoked for every received block, using the context
+ *                          of cbData.
+ * @param options           See ::OCDoRequest.
+ * @param numOptions        See ::OCDoRequest.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCDoStreamingRequest(OCDoHandle *handle,
+                                   OCMethod method,
+                                   const char *requestUri,
+                                   const OCDevAddr *destination,
+                                   OCPayload* payload,
+                                   OCConnectivityType connectivityType,
+                                   OCQualityOfService qos,
+                                   OCCallbackData *cbData,
+                                   OCClientResponseChunkHandler chunkHandler,
+                                   OCHeaderOption *options,
+                                   uint8_t numOptions);
+
 /**
  * This function cancels a request associated with a specific @ref OCDoResource invocation.
  *
@@ -416,6 +485,26 @@ OCStackResult OC_CALL OCBindResource(OCResourceHandle collectionHandle, OCResour
  */
 OCStackResult OC_CALL OCUnBindResource(OCResourceHandle collectionHandle, OCResourceHandle resourceHandle);
 
+/**
+ * This function makes the stack call the entity handlers of the resources of a collection
+ * concurrently, on a pool of worker threads, when the collection is requested with the batch
+ * interface. Each entity handler gets its own copy of the request and its response is added to
+ * the batch response as it arrives. The batch response is sent by ::OCProcess once all resources
+ * responded. When the deadline expires the responses received so far are sent and later ones are
+ * dropped.
+ *
+ * @note The entity handlers of the resources may be called from any worker thread, at the same
+ *       time as each other, and have to respond before ::OCStop is called.
+ *
+ * @param collectionHandle   Handle to the collection resource.
+ * @param deadlineMs         Time in milliseconds to wait for the responses of the resources,
+ *                           or 0 to call their entity handlers sequentially (default).
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCSetCollectionBatchConcurrency(OCResourceHandle collectionHandle,
+                                                      uint32_t deadlineMs);
+
 /**
  * This function binds a resource type to a resource.
  *
@@ -673,7 +762,7 @@ OCStackResult OC_CALL OCGetResourceIns(OCResourceHandle handle, int64_t *ins);
 
 #ifdef RD_SERVER
 /**
- * Sets the filename to be used for database persistent storage.
+ * Sets the filename to be used for database persistent storage. May be called before ::OCInit.
  * @param   filename            [IN] the filename.
  *
  * @return  ::OC_STACK_OK on success, some other value upon failure.
@@ -683,7 +772,7 @@ OCStackResult OC_CALL OCRDDatabaseSetStorageFilename(const char *filename);
 /**
  * Returns the filename to be used for database persistent storage.
  *
- * @return the filename
+ * @return the filename, or NULL if the stack is not initialized
  */
 const char *OC_CALL OCRDDatabaseGetStorageFilename();
 
@@ -915,6 +1004,28 @@ OCStackResult OC_CALL OCGetIpv6AddrScope(const char *addr, OCTransportFlags *sco
 OCStackResult OC_CALL OCGetRequestPayloadVersion(OCEntityHandlerRequest *ehRequest,
                                   OCPayloadFormat* pContentFormat, uint16_t* pAcceptVersion);
 
+/**
+ * Get the statistics collected by the stack since it was started: message counts per
+ * transport, queue depths, live observers and callbacks, and latency percentiles.
+ * This may be called from any thread.
+ *
+ * @param[out] stats        receives the statistics.
+ *
+ * @return ::OC_STACK_OK if successful.
+ */
+OCStackResult OC_CALL OCGetStackStatistics(OCStackStatistics *stats);
+
+/**
+ * Create a resource at ::OC_RSRVD_STATISTICS_URI that returns the result of
+ * OCGetStackStatistics() to GET requests, for remote diagnostics.
+ * The resource is secure and discoverable, and is deleted by OCDeleteResource() or OCStop().
+ *
+ * @param[out] handle       optional, receives the handle of the resource.
+ *
+ * @return ::OC_STACK_OK if successful.
+ */
+OCStackResult OC_CALL OCCreateStatisticsResource(OCResourceHandle *handle);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
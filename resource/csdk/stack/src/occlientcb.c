@@ -24,6 +24,7 @@
 #include "experimental/logger.h"
 #include "trace.h"
 #include "oic_malloc.h"
+#include "ocmetrics.h"
 #include <string.h>
 
 #ifdef HAVE_SYS_TIME_H
@@ -60,6 +61,7 @@ static void DeleteClientCBInternal(ClientCB * cbNode)
                      (const uint8_t *)cbNode->token, cbNode->tokenLength);
 
     LL_DELETE(g_cbList, cbNode);
+    oc_metrics_gauge_add(OC_METRIC_CLIENT_CALLBACKS, -1);
     CADestroyToken(cbNode->token);
     OICFree(cbNode->devAddr);
     OICFree(cbNode->handle);
@@ -204,6 +206,7 @@ OCStackResult AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
         cbNode->callBack = cbData->cb;
         cbNode->context = cbData->context;
         cbNode->deleteCallback = cbData->cd;
+        cbNode->chunkHandler = NULL;
 
         if (!options || !numOptions)
         {
@@ -276,6 +279,7 @@ OCStackResult AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
         OIC_LOG_V(INFO, TAG, "Added Callback for uri : %s", requestUri);
         OIC_TRACE_MARK(%s:AddClientCB:uri:%s, TAG, requestUri);
         LL_APPEND(g_cbList, cbNode);
+        oc_metrics_gauge_add(OC_METRIC_CLIENT_CALLBACKS, 1);
         *clientCB = cbNode;
     }
 #ifdef WITH_PRESENCE
@@ -33,6 +33,9 @@
 #include "ocstackinternal.h"
 #include "oicgroup.h"
 #include "oic_string.h"
+#include "oic_time.h"
+#include "octhread.h"
+#include "platform_features.h"
 #include "experimental/payload_logging.h"
 #include "cainterface.h"
 #define TAG "OIC_RI_COLLECTION"
@@ -251,7 +254,12 @@ static OCStackResult HandleBatchInterface(OCEntityHandlerRequest *ehRequest)
                 if (ehResult == OC_EH_SLOW)
                 {
                     OIC_LOG(INFO, TAG, "This is a slow resource");
-                    ((OCServerRequest *)ehRequest->requestHandle)->slowFlag = 1;
+                    OCServerRequest *request =
+                        GetServerRequestUsingHandle(ehRequest->requestHandle);
+                    if (request)
+                    {
+                        request->slowFlag = 1;
+                    }
                     stackRet = EntityHandlerCodeToOCStackCode(ehResult);
                 }
             }
@@ -266,6 +274,607 @@ static OCStackResult HandleBatchInterface(OCEntityHandlerRequest *ehRequest)
     return stackRet;
 }
 
+/**
+ * Number of threads running the entity handlers of collections served concurrently with the
+ * batch interface.
+ */
+#define BATCH_WORKER_COUNT (4)
+
+typedef struct OCBatchRequest OCBatchRequest;
+
+/**
+ * Request to one resource of a collection served concurrently with the batch interface.
+ */
+typedef struct OCBatchChildRequest
+{
+    /** Handle of the request passed to the entity handler; must be the first member.*/
+    OCServerRequest handle;
+
+    /** Request passed to the entity handler.*/
+    OCEntityHandlerRequest ehRequest;
+
+    /** Resource whose entity handler is called, NULL once the resource was deleted.*/
+    OCResource *resource;
+
+    /** Batch request this request belongs to.*/
+    OCBatchRequest *batch;
+
+    /** Response of the resource, until the batch response is sent.*/
+    OCRepPayload *payload;
+
+    /** True once the resource has responded or will not respond any longer.*/
+    bool finished;
+
+    /** True while a worker thread runs the entity handler of the resource.*/
+    bool running;
+
+    /** Next request in the queue of the worker threads.*/
+    struct OCBatchChildRequest *nextTask;
+} OCBatchChildRequest;
+
+/**
+ * Batch request of a collection whose resources are served concurrently.
+ */
+struct OCBatchRequest
+{
+    /** Request of the collection, answered with the batch response.*/
+    OCServerRequest *request;
+
+    /** Requests to the resources of the collection.*/
+    OCBatchChildRequest *children;
+
+    /** Number of resources of the collection.*/
+    size_t numChildren;
+
+    /** Number of resources which have not finished.*/
+    size_t numPending;
+
+    /** Number of threads using the batch request, including queued entity handler calls.*/
+    size_t numRunning;
+
+    /** True once the batch response is being sent.*/
+    bool done;
+
+    /** Time in milliseconds after which the batch response is sent anyway.*/
+    uint64_t deadline;
+
+    /** Next pending batch request.*/
+    struct OCBatchRequest *next;
+};
+
+/** Protects the batch requests and the queue of the worker threads.*/
+static oc_mutex g_batchMutex = NULL;
+
+/** Signals the worker threads that a request was queued or that they have to stop.*/
+static oc_cond g_batchCond = NULL;
+
+/** Signals that a worker thread returned from an entity handler.*/
+static oc_cond g_batchIdleCond = NULL;
+
+/** Request whose entity handler the current worker thread is running.*/
+static OC_THREAD_LOCAL OCBatchChildRequest *t_batchChild = NULL;
+
+static oc_thread g_batchWorkers[BATCH_WORKER_COUNT];
+static bool g_batchWorkersStop = false;
+static OCBatchRequest *g_batchRequests = NULL;
+static OCBatchChildRequest *g_batchQueueHead = NULL;
+static OCBatchChildRequest *g_batchQueueTail = NULL;
+
+/**
+ * Mark the request to a resource finished. Called with g_batchMutex held. The batch response
+ * is sent by ProcessBatchDeadlines once all requests finished, because the server request
+ * list may only be changed by the thread calling OCProcess.
+ */
+static void FinishBatchChild(OCBatchChildRequest *child)
+{
+    if (child->finished)
+    {
+        return;
+    }
+    child->finished = true;
+    child->batch->numPending--;
+}
+
+/**
+ * Unlink the batch request if it is no longer used. Called with g_batchMutex held.
+ *
+ * @return true if the caller has to free the batch request.
+ */
+static bool UnlinkUnusedBatchRequest(OCBatchRequest *batch)
+{
+    if (!batch->done || batch->numPending || batch->numRunning)
+    {
+        return false;
+    }
+
+    for (OCBatchRequest **prev = &g_batchRequests; *prev; prev = &(*prev)->next)
+    {
+        if (*prev == batch)
+        {
+            *prev = batch->next;
+            break;
+        }
+    }
+    return true;
+}
+
+static void FreeBatchRequest(OCBatchRequest *batch)
+{
+    for (size_t i = 0; i < batch->numChildren; i++)
+    {
+        OCPayloadDestroy(batch->children[i].ehRequest.payload);
+        OCRepPayloadDestroy(batch->children[i].payload);
+        OICFree(batch->children[i].handle.requestToken);
+    }
+    OICFree(batch->children);
+    OICFree(batch);
+}
+
+/**
+ * Send the responses received so far, in the order of the resources in the collection.
+ * The caller has to be the thread calling OCProcess and be counted as running the batch
+ * request.
+ */
+static void SendBatchResponse(OCBatchRequest *batch)
+{
+    OCRepPayload *payload = NULL;
+    size_t numResponses = 0;
+    for (size_t i = 0; i < batch->numChildren; i++)
+    {
+        OCRepPayload *childPayload = batch->children[i].payload;
+        batch->children[i].payload = NULL;
+        if (!childPayload)
+        {
+            continue;
+        }
+        if (!payload)
+        {
+            payload = childPayload;
+        }
+        else
+        {
+            OCRepPayloadAppend(payload, childPayload);
+        }
+        numResponses++;
+    }
+    OIC_LOG_V(INFO, TAG, "Sending batch response with %" PRIuPTR " of %" PRIuPTR " responses",
+              numResponses, batch->numChildren);
+
+    OCEntityHandlerResponse response = {0};
+    response.requestHandle = GetServerRequestHandle(batch->request);
+    response.payload = (OCPayload *) payload;
+    response.ehResult = payload ? OC_EH_OK : OC_EH_ERROR;
+    if (OC_STACK_OK != HandleSingleResponse(&response))
+    {
+        OIC_LOG(ERROR, TAG, "Error sending batch response");
+    }
+    OCRepPayloadDestroy(payload);
+
+    oc_mutex_lock(g_batchMutex);
+    batch->numRunning--;
+    bool unused = UnlinkUnusedBatchRequest(batch);
+    oc_mutex_unlock(g_batchMutex);
+    if (unused)
+    {
+        FreeBatchRequest(batch);
+    }
+}
+
+/**
+ * Find the pending request to a resource whose handle was passed to an entity handler.
+ * Called with g_batchMutex held.
+ */
+static OCBatchChildRequest *FindBatchChild(OCRequestHandle handle)
+{
+    for (OCBatchRequest *batch = g_batchRequests; batch; batch = batch->next)
+    {
+        for (size_t i = 0; i < batch->numChildren; i++)
+        {
+            if (GetServerRequestHandle(&batch->children[i].handle) == handle)
+            {
+                return &batch->children[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+bool HandleBatchChildResponse(OCEntityHandlerResponse *ehResponse, OCStackResult *result)
+{
+    if (!g_batchMutex)
+    {
+        return false;
+    }
+
+    oc_mutex_lock(g_batchMutex);
+    OCBatchChildRequest *child = FindBatchChild(ehResponse->requestHandle);
+    if (!child)
+    {
+        oc_mutex_unlock(g_batchMutex);
+        return false;
+    }
+    OCBatchRequest *batch = child->batch;
+
+    *result = OC_STACK_OK;
+    if (child->finished || batch->done)
+    {
+        OIC_LOG(WARNING, TAG, "Dropping response received after the batch response was sent");
+        *result = OC_STACK_ERROR;
+    }
+    else if (ehResponse->payload && PAYLOAD_TYPE_REPRESENTATION == ehResponse->payload->type)
+    {
+        child->payload = OCRepPayloadBatchClone((OCRepPayload *) ehResponse->payload);
+    }
+    else
+    {
+        OIC_LOG(ERROR, TAG, "Response of resource is not a representation");
+    }
+    FinishBatchChild(child);
+    bool unused = UnlinkUnusedBatchRequest(batch);
+    oc_mutex_unlock(g_batchMutex);
+
+    if (unused)
+    {
+        FreeBatchRequest(batch);
+    }
+    return true;
+}
+
+OCServerRequest *GetRunningBatchChildRequest(OCRequestHandle handle)
+{
+    if (t_batchChild && GetServerRequestHandle(&t_batchChild->handle) == handle)
+    {
+        return &t_batchChild->handle;
+    }
+    return NULL;
+}
+
+static void *BatchWorkerThread(void *arg)
+{
+    OC_UNUSED(arg);
+
+    oc_mutex_lock(g_batchMutex);
+    while (!g_batchWorkersStop)
+    {
+        OCBatchChildRequest *child = g_batchQueueHead;
+        if (!child)
+        {
+            oc_cond_wait(g_batchCond, g_batchMutex);
+            continue;
+        }
+        g_batchQueueHead = child->nextTask;
+        if (!g_batchQueueHead)
+        {
+            g_batchQueueTail = NULL;
+        }
+        OCBatchRequest *batch = child->batch;
+        OCResource *resource = batch->done ? NULL : child->resource;
+        child->running = (NULL != resource);
+        oc_mutex_unlock(g_batchMutex);
+
+        OCEntityHandlerResult ehResult = OC_EH_ERROR;
+        if (resource)
+        {
+            t_batchChild = child;
+            ehResult = resource->entityHandler(OC_REQUEST_FLAG, &child->ehRequest,
+                                               resource->entityHandlerCallbackParam);
+            t_batchChild = NULL;
+        }
+        OCPayloadDestroy(child->ehRequest.payload);
+        child->ehRequest.payload = NULL;
+
+        oc_mutex_lock(g_batchMutex);
+        if (child->running)
+        {
+            child->running = false;
+            oc_cond_broadcast(g_batchIdleCond);
+        }
+        if (OC_EH_SLOW != ehResult)
+        {
+            // The entity handler either responded or never will
+            FinishBatchChild(child);
+        }
+        batch->numRunning--;
+        bool unused = UnlinkUnusedBatchRequest(batch);
+        oc_mutex_unlock(g_batchMutex);
+
+        if (unused)
+        {
+            FreeBatchRequest(batch);
+        }
+        oc_mutex_lock(g_batchMutex);
+    }
+    oc_mutex_unlock(g_batchMutex);
+    return NULL;
+}
+
+static OCStackResult StartBatchWorkers()
+{
+    if (g_batchMutex)
+    {
+        return OC_STACK_OK;
+    }
+
+    g_batchMutex = oc_mutex_new();
+    g_batchCond = oc_cond_new();
+    g_batchIdleCond = oc_cond_new();
+    if (!g_batchMutex || !g_batchCond || !g_batchIdleCond)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to create batch request lock");
+        TerminateBatchRequests();
+        return OC_STACK_NO_MEMORY;
+    }
+
+    g_batchWorkersStop = false;
+    for (size_t i = 0; i < BATCH_WORKER_COUNT; i++)
+    {
+        if (OC_THREAD_SUCCESS != oc_thread_new(&g_batchWorkers[i], BatchWorkerThread, NULL))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to start batch request worker");
+            g_batchWorkers[i] = NULL;
+            TerminateBatchRequests();
+            return OC_STACK_ERROR;
+        }
+    }
+    return OC_STACK_OK;
+}
+
+void TerminateBatchRequests()
+{
+    if (!g_batchMutex)
+    {
+        return;
+    }
+
+    if (g_batchCond)
+    {
+        oc_mutex_lock(g_batchMutex);
+        g_batchWorkersStop = true;
+        oc_cond_broadcast(g_batchCond);
+        oc_mutex_unlock(g_batchMutex);
+    }
+    for (size_t i = 0; i < BATCH_WORKER_COUNT; i++)
+    {
+        if (g_batchWorkers[i])
+        {
+            oc_thread_wait(g_batchWorkers[i]);
+            oc_thread_free(g_batchWorkers[i]);
+            g_batchWorkers[i] = NULL;
+        }
+    }
+
+    while (g_batchRequests)
+    {
+        OCBatchRequest *batch = g_batchRequests;
+        g_batchRequests = batch->next;
+        FreeBatchRequest(batch);
+    }
+    g_batchQueueHead = NULL;
+    g_batchQueueTail = NULL;
+
+    oc_cond_free(g_batchCond);
+    g_batchCond = NULL;
+    oc_cond_free(g_batchIdleCond);
+    g_batchIdleCond = NULL;
+    oc_mutex_free(g_batchMutex);
+    g_batchMutex = NULL;
+}
+
+void ProcessBatchDeadlines()
+{
+    if (!g_batchMutex)
+    {
+        return;
+    }
+
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    for (;;)
+    {
+        OCBatchRequest *ready = NULL;
+        oc_mutex_lock(g_batchMutex);
+        for (OCBatchRequest *batch = g_batchRequests; batch; batch = batch->next)
+        {
+            if (!batch->done && (!batch->numPending || now >= batch->deadline))
+            {
+                batch->done = true;
+                batch->numRunning++;
+                ready = batch;
+                break;
+            }
+        }
+        size_t numExpired = 0;
+        if (ready)
+        {
+            // Resources which did not respond in time are answered as if their entity handler
+            // failed, so the batch request is freed once no worker thread uses it any longer.
+            numExpired = ready->numPending;
+            for (size_t i = 0; i < ready->numChildren; i++)
+            {
+                FinishBatchChild(&ready->children[i]);
+            }
+        }
+        oc_mutex_unlock(g_batchMutex);
+
+        if (!ready)
+        {
+            break;
+        }
+        if (numExpired)
+        {
+            OIC_LOG_V(INFO, TAG, "Batch request deadline expired, %" PRIuPTR " of %" PRIuPTR
+                      " resources failed to respond", numExpired, ready->numChildren);
+        }
+        SendBatchResponse(ready);
+    }
+}
+
+void CancelBatchRequestsForResource(OCResource *resource)
+{
+    if (!g_batchMutex || !resource)
+    {
+        return;
+    }
+
+    oc_mutex_lock(g_batchMutex);
+    for (;;)
+    {
+        bool running = false;
+        for (OCBatchRequest *batch = g_batchRequests; batch; batch = batch->next)
+        {
+            for (size_t i = 0; i < batch->numChildren; i++)
+            {
+                OCBatchChildRequest *child = &batch->children[i];
+                if (child->resource != resource)
+                {
+                    continue;
+                }
+                // Queued calls are skipped by the worker threads. An entity handler deleting
+                // its own resource is not waited for, it does not use the resource afterwards.
+                child->resource = NULL;
+                running |= child->running && (child != t_batchChild);
+            }
+        }
+        if (!running)
+        {
+            break;
+        }
+        oc_cond_wait(g_batchIdleCond, g_batchMutex);
+    }
+    oc_mutex_unlock(g_batchMutex);
+}
+
+/**
+ * Queue the entity handler calls of the resources of a collection to the worker threads.
+ * The batch response is sent once all resources responded or when the deadline expires.
+ */
+static OCStackResult HandleBatchInterfaceConcurrently(OCEntityHandlerRequest *ehRequest,
+                                                      uint32_t deadlineMs)
+{
+    OCResource *collResource = (OCResource *) ehRequest->resource;
+    OCServerRequest *request = GetServerRequestUsingHandle(ehRequest->requestHandle);
+    if (!request)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    size_t numChildren = 0;
+    for (OCChildResource *tempChildResource = collResource->rsrcChildResourcesHead;
+        tempChildResource && tempChildResource->rsrcResource;
+        tempChildResource = tempChildResource->next)
+    {
+        numChildren++;
+    }
+    if (!numChildren)
+    {
+        return OC_STACK_NO_RESOURCE;
+    }
+
+    OCBatchRequest *batch = (OCBatchRequest *) OICCalloc(1, sizeof(OCBatchRequest));
+    if (!batch)
+    {
+        OIC_LOG(ERROR, TAG, "Memory allocation failed!");
+        return OC_STACK_NO_MEMORY;
+    }
+    batch->children = (OCBatchChildRequest *) OICCalloc(numChildren, sizeof(OCBatchChildRequest));
+    batch->numChildren = numChildren;
+    if (!batch->children)
+    {
+        OIC_LOG(ERROR, TAG, "Memory allocation failed!");
+        OICFree(batch);
+        return OC_STACK_NO_MEMORY;
+    }
+
+    OCChildResource *tempChildResource = collResource->rsrcChildResourcesHead;
+    for (size_t i = 0; i < numChildren; i++, tempChildResource = tempChildResource->next)
+    {
+        OCBatchChildRequest *child = &batch->children[i];
+        child->batch = batch;
+        child->resource = tempChildResource->rsrcResource;
+
+        // The handle only has to route the response back to this batch request; it is never
+        // added to the server request list. OCDoResponse finds it by its ID with
+        // HandleBatchChildResponse, so a response after the batch request was freed is rejected.
+        memcpy(&child->handle, request, sizeof(OCServerRequest));
+        memset(&child->handle.entry, 0, sizeof(child->handle.entry));
+        memset(&child->handle.idEntry, 0, sizeof(child->handle.idEntry));
+        child->handle.requestId = GenerateServerRequestId();
+        child->handle.ehResponseHandler = NULL;
+        child->handle.numResponses = 1;
+        child->handle.slowFlag = 0;
+        child->handle.encodedPayload = NULL;
+        child->handle.encodedPayloadSize = 0;
+        child->handle.payloadSize = 0;
+        // The token is owned by the collection request, which may be freed before the child.
+        child->handle.requestToken = NULL;
+        if (request->requestToken && request->tokenLength)
+        {
+            child->handle.requestToken = (CAToken_t) OICMalloc(request->tokenLength);
+            if (!child->handle.requestToken)
+            {
+                OIC_LOG(ERROR, TAG, "Memory allocation failed!");
+                FreeBatchRequest(batch);
+                return OC_STACK_NO_MEMORY;
+            }
+            memcpy(child->handle.requestToken, request->requestToken, request->tokenLength);
+        }
+
+        child->ehRequest = *ehRequest;
+        child->ehRequest.resource = (OCResourceHandle) child->resource;
+        child->ehRequest.requestHandle = GetServerRequestHandle(&child->handle);
+        child->ehRequest.query = NULL;
+        child->ehRequest.rcvdVendorSpecificHeaderOptions =
+            child->handle.rcvdVendorSpecificHeaderOptions;
+        child->ehRequest.payload = NULL;
+        if (ehRequest->payload)
+        {
+            if (PAYLOAD_TYPE_REPRESENTATION != ehRequest->payload->type)
+            {
+                OIC_LOG(ERROR, TAG, "Batch request payload is not a representation");
+                FreeBatchRequest(batch);
+                return OC_STACK_INVALID_PARAM;
+            }
+            child->ehRequest.payload =
+                (OCPayload *) OCRepPayloadClone((OCRepPayload *) ehRequest->payload);
+            if (!child->ehRequest.payload)
+            {
+                OIC_LOG(ERROR, TAG, "Failed cloning batch request payload");
+                FreeBatchRequest(batch);
+                return OC_STACK_NO_MEMORY;
+            }
+        }
+    }
+
+    batch->request = request;
+    batch->numPending = numChildren;
+    batch->numRunning = numChildren;
+    batch->deadline = OICGetCurrentTime(TIME_IN_MS) + deadlineMs;
+
+    // Responses are sent separately from the ACK of confirmable requests
+    request->slowFlag = 1;
+
+    oc_mutex_lock(g_batchMutex);
+    batch->next = g_batchRequests;
+    g_batchRequests = batch;
+    for (size_t i = 0; i < numChildren; i++)
+    {
+        OCBatchChildRequest *child = &batch->children[i];
+        if (g_batchQueueTail)
+        {
+            g_batchQueueTail->nextTask = child;
+        }
+        else
+        {
+            g_batchQueueHead = child;
+        }
+        g_batchQueueTail = child;
+    }
+    oc_cond_broadcast(g_batchCond);
+    oc_mutex_unlock(g_batchMutex);
+
+    OIC_LOG_V(INFO, TAG, "Queued %" PRIuPTR " entity handlers of batch request", numChildren);
+    return OC_STACK_SLOW_RESOURCE;
+}
+
 OCStackResult DefaultCollectionEntityHandler(OCEntityHandlerFlag flag, OCEntityHandlerRequest *ehRequest)
 {
     if (!ehRequest || !ehRequest->query)
@@ -307,10 +916,16 @@ OCStackResult DefaultCollectionEntityHandler(OCEntityHandlerFlag flag, OCEntityH
     }
     else if (0 == strcmp(ifQueryParam, OC_RSRVD_INTERFACE_BATCH))
     {
-        OCServerRequest *request = (OCServerRequest *)ehRequest->requestHandle;
-        if (request)
+        OCServerRequest *request = GetServerRequestUsingHandle(ehRequest->requestHandle);
+        OCResource *collResource = (OCResource *)ehRequest->resource;
+        if (request && collResource->batchDeadlineMs && collResource->rsrcChildResourcesHead &&
+            OC_STACK_OK == StartBatchWorkers())
         {
-            request->numResponses = GetNumOfResourcesInCollection((OCResource *)ehRequest->resource);
+            result = HandleBatchInterfaceConcurrently(ehRequest, collResource->batchDeadlineMs);
+        }
+        else if (request)
+        {
+            request->numResponses = GetNumOfResourcesInCollection(collResource);
             request->ehResponseHandler = HandleAggregateResponse;
             result = HandleBatchInterface(ehRequest);
         }
@@ -322,7 +937,7 @@ OCStackResult DefaultCollectionEntityHandler(OCEntityHandlerFlag flag, OCEntityH
         result = BuildCollectionGroupActionCBORResponse(ehRequest->method, (OCResource *) ehRequest->resource, ehRequest);
     }
 exit:
-    if (result != OC_STACK_OK)
+    if (result != OC_STACK_OK && result != OC_STACK_SLOW_RESOURCE)
     {
         result = SendResponse(NULL, ehRequest, OC_EH_BAD_REQ);
     }
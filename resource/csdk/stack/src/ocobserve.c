@@ -27,6 +27,7 @@
 #include "experimental/ocrandom.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "ocmetrics.h"
 #include "ocpayload.h"
 #include "ocserverrequest.h"
 #include "experimental/logger.h"
@@ -201,7 +202,7 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
                     ehResponse.ehResult = OC_EH_OK;
                     ehResponse.payload = (OCPayload*)presenceResBuf;
                     ehResponse.persistentBufferFlag = 0;
-                    ehResponse.requestHandle = (OCRequestHandle) request;
+                    ehResponse.requestHandle = GetServerRequestHandle(request);
                     OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
                             resourceObserver->resUri);
                     result = OCDoResponse(&ehResponse);
@@ -282,7 +283,7 @@ OCStackResult SendListObserverNotification (OCResource * resource,
                     }
                     memcpy(ehResponse.payload, payload, sizeof(*payload));
                     ehResponse.persistentBufferFlag = 0;
-                    ehResponse.requestHandle = (OCRequestHandle) request;
+                    ehResponse.requestHandle = GetServerRequestHandle(request);
                     result = OCDoResponse(&ehResponse);
                     if (result == OC_STACK_OK)
                     {
@@ -414,6 +415,7 @@ OCStackResult AddObserver (const char         *resUri,
         }
 
         LL_APPEND (resHandle->observersHead, obsNode);
+        oc_metrics_gauge_add(OC_METRIC_OBSERVERS, 1);
 
         return OC_STACK_OK;
     }
@@ -518,6 +520,7 @@ OCStackResult DeleteObserverUsingToken (OCResource *resource,
         OIC_LOG_V(INFO, TAG, "deleting observer id  %u with token", obsNode->observeId);
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)obsNode->token, tokenLength);
         LL_DELETE (resource->observersHead, obsNode);
+        oc_metrics_gauge_add(OC_METRIC_OBSERVERS, -1);
         OICFree(obsNode->resUri);
         OICFree(obsNode->query);
         OICFree(obsNode->token);
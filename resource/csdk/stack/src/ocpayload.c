@@ -2283,7 +2283,10 @@ OCStackResult OC_CALL OCGetRequestPayloadVersion(OCEntityHandlerRequest *ehReque
     if ((ehRequest == NULL)||(pContentFormat == NULL))
         return OC_STACK_ERROR;
 
-    OCServerRequest* serverRequest = (OCServerRequest*) ehRequest->requestHandle;
+    OCServerRequest* serverRequest = GetServerRequestUsingHandle(ehRequest->requestHandle);
+    if (serverRequest == NULL)
+        return OC_STACK_INVALID_PARAM;
+
     switch (serverRequest->acceptFormat)
     {
         case OC_FORMAT_CBOR:
@@ -45,7 +45,11 @@
 #include "occollection.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_time.h"
+#include "ocmetrics.h"
+#include "ocatomic.h"
 #include "experimental/logger.h"
+#include "trace.h"
 #include "ocpayload.h"
 #include "secureresourcemanager.h"
 #include "cacommon.h"
@@ -1628,7 +1632,7 @@ static OCStackResult SendNonPersistantDiscoveryResponse(OCServerRequest *request
     response->ehResult = ehResult;
     response->payload = discoveryPayload;
     response->persistentBufferFlag = 0;
-    response->requestHandle = (OCRequestHandle) request;
+    response->requestHandle = GetServerRequestHandle(request);
 
     result = OCDoResponse(response);
 
@@ -1643,7 +1647,7 @@ static OCStackResult EHRequest(OCEntityHandlerRequest *ehRequest, OCPayloadType
     OCServerRequest *request, OCResource *resource)
 {
     return FormOCEntityHandlerRequest(ehRequest,
-                                     (OCRequestHandle)request,
+                                     GetServerRequestHandle(request),
                                      request->method,
                                      &request->devAddr,
                                      (OCResourceHandle)resource,
@@ -1872,6 +1876,195 @@ exit:
     return result;
 }
 
+/**
+ * Number of encoded /oic/res responses kept by the discovery cache.
+ */
+#define DISCOVERY_CACHE_SIZE (8)
+
+/**
+ * An encoded /oic/res response and the properties of the request it was built for.
+ */
+typedef struct
+{
+    /** Value of g_discoveryCacheGeneration when built, 0 if the entry is unused. */
+    int32_t generation;
+    OCVirtualResources virtualUri;
+    char *interfaceQuery;
+    char *resourceTypeQuery;
+    OCPayloadFormat acceptFormat;
+    uint16_t acceptVersion;
+    /** Interface of the requester, the endpoints in the response are filtered on it. */
+    OCTransportAdapter adapter;
+    OCTransportFlags flags;
+    uint32_t ifindex;
+    char sid[UUID_STRING_SIZE];
+    OCStackResult result;
+    uint8_t *payload;
+    size_t payloadSize;
+} DiscoveryCacheEntry;
+
+static DiscoveryCacheEntry g_discoveryCache[DISCOVERY_CACHE_SIZE];
+static size_t g_discoveryCacheNext = 0;
+/** Incremented from the CA network thread as well, only accessed with the ocatomic helpers. */
+static volatile int32_t g_discoveryCacheGeneration = 1;
+
+void InvalidateDiscoveryCache()
+{
+    // 0 marks the unused entries
+    if (0 == oc_atomic_increment(&g_discoveryCacheGeneration))
+    {
+        oc_atomic_increment(&g_discoveryCacheGeneration);
+    }
+}
+
+static int32_t getDiscoveryCacheGeneration()
+{
+    return oc_atomic_add(&g_discoveryCacheGeneration, 0);
+}
+
+static void freeDiscoveryCacheEntry(DiscoveryCacheEntry *entry)
+{
+    OICFree(entry->interfaceQuery);
+    OICFree(entry->resourceTypeQuery);
+    OICFree(entry->payload);
+    memset(entry, 0, sizeof(*entry));
+}
+
+void DeleteDiscoveryCache()
+{
+    for (size_t i = 0; i < DISCOVERY_CACHE_SIZE; i++)
+    {
+        freeDiscoveryCacheEntry(&g_discoveryCache[i]);
+    }
+    g_discoveryCacheNext = 0;
+}
+
+static bool discoveryCacheStringsEqual(const char *a, const char *b)
+{
+    return (a == b) || (a && b && (0 == strcmp(a, b)));
+}
+
+/**
+ * Check whether the response to a discovery request may be served from the discovery cache.
+ * Only CBOR responses built from the local resources are cached, RD database contents change
+ * without going through the stack.
+ */
+static bool isDiscoveryCacheable(OCServerRequest *request)
+{
+    switch (request->acceptFormat)
+    {
+        case OC_FORMAT_UNDEFINED:
+        case OC_FORMAT_CBOR:
+        case OC_FORMAT_VND_OCF_CBOR:
+            break;
+        default:
+            return false;
+    }
+#ifdef RD_SERVER
+    if (OCGetResourceHandleAtUri(OC_RSRVD_RD_URI))
+    {
+        return false;
+    }
+#endif
+    return true;
+}
+
+static DiscoveryCacheEntry *findDiscoveryCacheEntry(OCVirtualResources virtualUri,
+                                                    OCServerRequest *request,
+                                                    const char *interfaceQuery,
+                                                    const char *resourceTypeQuery)
+{
+    const char *sid = OCGetServerInstanceIDString();
+    int32_t generation = getDiscoveryCacheGeneration();
+    for (size_t i = 0; i < DISCOVERY_CACHE_SIZE; i++)
+    {
+        DiscoveryCacheEntry *entry = &g_discoveryCache[i];
+        if (entry->generation == generation &&
+            entry->virtualUri == virtualUri &&
+            entry->acceptFormat == request->acceptFormat &&
+            entry->acceptVersion == request->acceptVersion &&
+            entry->adapter == request->devAddr.adapter &&
+            entry->flags == request->devAddr.flags &&
+            entry->ifindex == request->devAddr.ifindex &&
+            discoveryCacheStringsEqual(entry->interfaceQuery, interfaceQuery) &&
+            discoveryCacheStringsEqual(entry->resourceTypeQuery, resourceTypeQuery) &&
+            0 == strcmp(entry->sid, sid ? sid : ""))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Encode and store a discovery response.
+ *
+ * @param generation value of g_discoveryCacheGeneration before the response was built.
+ *
+ * @return the new entry, or NULL if the response could not be cached.
+ */
+static DiscoveryCacheEntry *addDiscoveryCacheEntry(int32_t generation,
+                                                   OCVirtualResources virtualUri,
+                                                   OCServerRequest *request,
+                                                   const char *interfaceQuery,
+                                                   const char *resourceTypeQuery,
+                                                   OCStackResult result,
+                                                   OCPayload *payload)
+{
+    if (generation != getDiscoveryCacheGeneration())
+    {
+        // Something changed while the response was being built
+        return NULL;
+    }
+
+    DiscoveryCacheEntry *entry = NULL;
+    for (size_t i = 0; i < DISCOVERY_CACHE_SIZE; i++)
+    {
+        if (g_discoveryCache[i].generation != generation)
+        {
+            entry = &g_discoveryCache[i];
+            break;
+        }
+    }
+    if (!entry)
+    {
+        entry = &g_discoveryCache[g_discoveryCacheNext];
+        g_discoveryCacheNext = (g_discoveryCacheNext + 1) % DISCOVERY_CACHE_SIZE;
+    }
+    freeDiscoveryCacheEntry(entry);
+
+    if (payload && OC_STACK_OK != OCConvertPayload(payload, request->acceptFormat,
+                                                   &entry->payload, &entry->payloadSize))
+    {
+        goto exit;
+    }
+    if (interfaceQuery)
+    {
+        entry->interfaceQuery = OICStrdup(interfaceQuery);
+        VERIFY_PARAM_NON_NULL(TAG, entry->interfaceQuery, "Failed caching discovery response.");
+    }
+    if (resourceTypeQuery)
+    {
+        entry->resourceTypeQuery = OICStrdup(resourceTypeQuery);
+        VERIFY_PARAM_NON_NULL(TAG, entry->resourceTypeQuery, "Failed caching discovery response.");
+    }
+    const char *sid = OCGetServerInstanceIDString();
+    OICStrcpy(entry->sid, sizeof(entry->sid), sid ? sid : "");
+    entry->virtualUri = virtualUri;
+    entry->acceptFormat = request->acceptFormat;
+    entry->acceptVersion = request->acceptVersion;
+    entry->adapter = request->devAddr.adapter;
+    entry->flags = request->devAddr.flags;
+    entry->ifindex = request->devAddr.ifindex;
+    entry->result = result;
+    entry->generation = generation;
+    return entry;
+
+exit:
+    freeDiscoveryCacheEntry(entry);
+    return NULL;
+}
+
 static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource* resource)
 {
     if (!request || !resource)
@@ -1936,16 +2129,6 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
             goto exit;
         }
 
-        CAEndpoint_t *networkInfo = NULL;
-        size_t infoSize = 0;
-
-        CAResult_t caResult = CAGetNetworkInformation(&networkInfo, &infoSize);
-        if (CA_STATUS_FAILED == caResult)
-        {
-            OIC_LOG(ERROR, TAG, "CAGetNetworkInformation has error on parsing network infomation");
-            return OC_STACK_ERROR;
-        }
-
         discoveryResult = getQueryParamsForFiltering (virtualUriInRequest, request->query,
                 &interfaceQuery, &resourceTypeQuery);
         VERIFY_SUCCESS(discoveryResult);
@@ -1956,6 +2139,31 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
             interfaceQuery = OICStrdup(OC_RSRVD_INTERFACE_LL);
         }
 
+        bool cacheable = isDiscoveryCacheable(request);
+        DiscoveryCacheEntry *cacheEntry = cacheable ?
+            findDiscoveryCacheEntry(virtualUriInRequest, request, interfaceQuery,
+                                    resourceTypeQuery) : NULL;
+        if (cacheEntry)
+        {
+            OIC_LOG(INFO, TAG, "Sending cached discovery response");
+            discoveryResult = cacheEntry->result;
+            request->encodedPayload = cacheEntry->payload;
+            request->encodedPayloadSize = cacheEntry->payloadSize;
+            goto send;
+        }
+        int32_t cacheGeneration = getDiscoveryCacheGeneration();
+
+        CAEndpoint_t *networkInfo = NULL;
+        size_t infoSize = 0;
+
+        CAResult_t caResult = CAGetNetworkInformation(&networkInfo, &infoSize);
+        if (CA_STATUS_FAILED == caResult)
+        {
+            OIC_LOG(ERROR, TAG, "CAGetNetworkInformation has error on parsing network infomation");
+            discoveryResult = OC_STACK_ERROR;
+            goto exit;
+        }
+
         discoveryResult = discoveryPayloadCreateAndAddDeviceId(&payload);
         VERIFY_PARAM_NON_NULL(TAG, payload, "Failed creating Discovery Payload.");
         VERIFY_SUCCESS(discoveryResult);
@@ -2015,6 +2223,17 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
         discoveryResult = findResourcesAtRD(interfaceQuery, resourceTypeQuery, &request->devAddr,
                 (OCDiscoveryPayload **)&payload);
 #endif
+        if (cacheable && (OC_STACK_OK == discoveryResult || OC_STACK_NO_RESOURCE == discoveryResult))
+        {
+            cacheEntry = addDiscoveryCacheEntry(cacheGeneration, virtualUriInRequest, request,
+                                                interfaceQuery, resourceTypeQuery,
+                                                discoveryResult, payload);
+            if (cacheEntry)
+            {
+                request->encodedPayload = cacheEntry->payload;
+                request->encodedPayloadSize = cacheEntry->payloadSize;
+            }
+        }
     }
     else if (virtualUriInRequest == OC_DEVICE_URI)
     {
@@ -2074,6 +2293,7 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
      * 4)If Server does not have any 'DISCOVERABLE' resources and discovery
      *   request is unicast, it should send an error(RESOURCE_NOT_FOUND - 404) response.
      */
+send:
 
 #ifdef WITH_PRESENCE
     if ((virtualUriInRequest == OC_PRESENCE) &&
@@ -2303,7 +2523,9 @@ HandleResourceWithEntityHandler(OCServerRequest *request,
         goto exit;
     }
 
+    uint64_t ehStart = OICGetCurrentTime(TIME_IN_US);
     ehResult = resource->entityHandler(ehFlag, &ehRequest, resource->entityHandlerCallbackParam);
+    oc_metrics_record(OC_METRIC_ENTITY_HANDLER_LATENCY, OICGetCurrentTime(TIME_IN_US) - ehStart);
     if(ehResult == OC_EH_SLOW)
     {
         OIC_LOG(INFO, TAG, "This is a slow resource");
@@ -2343,6 +2565,10 @@ ProcessRequest(ResourceHandling resHandling, OCResource *resource, OCServerReque
 {
     OCStackResult ret = OC_STACK_OK;
 
+    OIC_TRACE_BEGIN(%s:ProcessRequest, TAG);
+    OIC_TRACE_BUFFER("OIC_RI_RESOURCE:ProcessRequest:token:",
+                     (const uint8_t *) request->requestToken, request->tokenLength);
+
     switch (resHandling)
     {
         case OC_RESOURCE_VIRTUAL:
@@ -2358,7 +2584,8 @@ ProcessRequest(ResourceHandling resHandling, OCResource *resource, OCServerReque
         case OC_RESOURCE_NOT_COLLECTION_DEFAULT_ENTITYHANDLER:
         {
             OIC_LOG(INFO, TAG, "OC_RESOURCE_NOT_COLLECTION_DEFAULT_ENTITYHANDLER");
-            return OC_STACK_ERROR;
+            ret = OC_STACK_ERROR;
+            break;
         }
         case OC_RESOURCE_NOT_COLLECTION_WITH_ENTITYHANDLER:
         {
@@ -2383,9 +2610,11 @@ ProcessRequest(ResourceHandling resHandling, OCResource *resource, OCServerReque
         default:
         {
             OIC_LOG(INFO, TAG, "Invalid Resource Determination");
-            return OC_STACK_ERROR;
+            ret = OC_STACK_ERROR;
+            break;
         }
     }
+    OIC_TRACE_END();
     return ret;
 }
 
@@ -2605,6 +2834,9 @@ static OCStackResult SetAttributeInternal(OCResource *resource,
         return OC_STACK_INVALID_PARAM;
     }
 
+    // The device name is included in baseline discovery responses
+    InvalidateDiscoveryCache();
+
     // See if the attribute already exists in the list.
     for (resAttrib = resource->rsrcAttributes; resAttrib; resAttrib = resAttrib->next)
     {
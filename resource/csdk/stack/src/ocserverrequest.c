@@ -24,11 +24,13 @@
 #include "ocserverrequest.h"
 #include "ocresourcehandler.h"
 #include "ocobserve.h"
+#include "occollection.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "ocpayload.h"
 #include "ocpayloadcbor.h"
 #include "experimental/logger.h"
+#include "trace.h"
 
 #if defined (ROUTING_GATEWAY) || defined (ROUTING_EP)
 #include "routingutility.h"
@@ -55,11 +57,16 @@ static int RBRequestTokenCmp(OCServerRequest *target, OCServerRequest *treeNode)
     return memcmp(target->requestToken, treeNode->requestToken, target->tokenLength);
 }
 
-static int RBResponseTokenCmp(OCServerResponse *target, OCServerResponse *treeNode)
+static int RBRequestIdCmp(OCServerRequest *target, OCServerRequest *treeNode)
 {
-    return memcmp(((OCServerRequest*)target->requestHandle)->requestToken,
-                  ((OCServerRequest*)treeNode->requestHandle)->requestToken,
-                  ((OCServerRequest*)target->requestHandle)->tokenLength);
+    return (target->requestId > treeNode->requestId) - (target->requestId < treeNode->requestId);
+}
+
+static int RBResponseHandleCmp(OCServerResponse *target, OCServerResponse *treeNode)
+{
+    uintptr_t targetHandle = (uintptr_t) target->requestHandle;
+    uintptr_t nodeHandle = (uintptr_t) treeNode->requestHandle;
+    return (targetHandle > nodeHandle) - (targetHandle < nodeHandle);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -69,9 +76,15 @@ RB_HEAD(ServerRequestTree, OCServerRequest) g_serverRequestTree =
                                                             RB_INITIALIZER(&g_serverRequestTree);
 RBL_GENERATE(ServerRequestTree, OCServerRequest, entry, RBRequestTokenCmp)
 
+RB_HEAD(ServerRequestIdTree, OCServerRequest) g_serverRequestIdTree =
+                                                            RB_INITIALIZER(&g_serverRequestIdTree);
+RB_GENERATE(ServerRequestIdTree, OCServerRequest, idEntry, RBRequestIdCmp)
+
+static uint32_t g_lastServerRequestId = 0;
+
 RB_HEAD(ServerResponseTree, OCServerResponse) g_serverResponseTree =
                                                             RB_INITIALIZER(&g_serverResponseTree);
-RB_GENERATE(ServerResponseTree, OCServerResponse, entry, RBResponseTokenCmp)
+RB_GENERATE(ServerResponseTree, OCServerResponse, entry, RBResponseHandleCmp)
 
 //-------------------------------------------------------------------------------------------------
 // Local functions
@@ -117,7 +130,7 @@ exit:
  * @return
  *     OCServerResponse*
  */
-static OCServerResponse * GetServerResponseUsingHandle (const OCServerRequest * handle)
+static OCServerResponse * GetServerResponseUsingHandle (OCRequestHandle handle)
 {
     if (!handle)
     {
@@ -127,7 +140,7 @@ static OCServerResponse * GetServerResponseUsingHandle (const OCServerRequest *
 
     OCServerResponse tmpFind, *out = NULL;
 
-    tmpFind.requestHandle = (OCRequestHandle)handle;
+    tmpFind.requestHandle = handle;
     out = RB_FIND(ServerResponseTree, &g_serverResponseTree, &tmpFind);
 
     if (!out)
@@ -177,9 +190,14 @@ static OCStackResult OCSendResponse (const CAEndpoint_t *object, CAResponseInfo_
     }
 #endif
 
+    OIC_TRACE_BEGIN(%s:OCSendResponse, TAG);
+    OIC_TRACE_BUFFER("OIC_RI_SERVERREQUEST:OCSendResponse:token:",
+                     (const uint8_t *) responseInfo->info.token, responseInfo->info.tokenLength);
+
     // Do not include the accept header option
     responseInfo->info.acceptFormat = CA_FORMAT_UNDEFINED;
     CAResult_t result = CASendResponse(object, responseInfo);
+    OIC_TRACE_END();
     if(CA_STATUS_OK != result)
     {
         OIC_LOG_V(ERROR, TAG, "CASendResponse failed with CA error %u", result);
@@ -360,10 +378,12 @@ OCStackResult AddServerRequest (OCServerRequest ** request,
     }
 
     serverRequest->devAddr = *devAddr;
+    serverRequest->requestId = GenerateServerRequestId();
 
     *request = serverRequest;
 
     RBL_INSERT(ServerRequestTree, &g_serverRequestTree, serverRequest);
+    RB_INSERT(ServerRequestIdTree, &g_serverRequestIdTree, serverRequest);
     OIC_LOG(INFO, TAG, "Server Request Added");
     return OC_STACK_OK;
 
@@ -409,6 +429,7 @@ void DeleteServerRequest(OCServerRequest * serverRequest)
     if (serverRequest)
     {
         RBL_REMOVE(ServerRequestTree, &g_serverRequestTree, serverRequest);
+        RB_REMOVE(ServerRequestIdTree, &g_serverRequestIdTree, serverRequest);
         OICFree(serverRequest->requestToken);
         OICFree(serverRequest);
         serverRequest = NULL;
@@ -416,6 +437,43 @@ void DeleteServerRequest(OCServerRequest * serverRequest)
     }
 }
 
+uint32_t GenerateServerRequestId()
+{
+    OCServerRequest tmpFind;
+    do
+    {
+        tmpFind.requestId = ++g_lastServerRequestId;
+    }
+    while (0 == tmpFind.requestId ||
+           RB_FIND(ServerRequestIdTree, &g_serverRequestIdTree, &tmpFind));
+
+    return tmpFind.requestId;
+}
+
+OCRequestHandle GetServerRequestHandle(const OCServerRequest * serverRequest)
+{
+    return serverRequest ? (OCRequestHandle) (uintptr_t) serverRequest->requestId : NULL;
+}
+
+OCServerRequest * GetServerRequestUsingHandle(OCRequestHandle handle)
+{
+    if (!handle || (uintptr_t) handle > UINT32_MAX)
+    {
+        return NULL;
+    }
+
+    // Entity handlers of batch requests served concurrently are given a handle of their own.
+    OCServerRequest *out = GetRunningBatchChildRequest(handle);
+    if (out)
+    {
+        return out;
+    }
+
+    OCServerRequest tmpFind;
+    tmpFind.requestId = (uint32_t) (uintptr_t) handle;
+    return RB_FIND(ServerRequestIdTree, &g_serverRequestIdTree, &tmpFind);
+}
+
 OCStackResult FormOCEntityHandlerRequest(OCEntityHandlerRequest * entityHandlerRequest,
                                          OCRequestHandle request,
                                          OCMethod method,
@@ -480,13 +538,23 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     CAResponseInfo_t responseInfo = {.result = CA_EMPTY};
     CAHeaderOption_t* optionsPointer = NULL;
 
+    OIC_TRACE_BEGIN(%s:HandleSingleResponse, TAG);
     if(!ehResponse || !ehResponse->requestHandle)
     {
         OIC_LOG(ERROR, TAG, "ehResponse/requestHandle is NULL");
+        OIC_TRACE_END();
         return OC_STACK_ERROR;
     }
 
-    OCServerRequest *serverRequest = (OCServerRequest *)ehResponse->requestHandle;
+    OCServerRequest *serverRequest = GetServerRequestUsingHandle(ehResponse->requestHandle);
+    if (!serverRequest)
+    {
+        OIC_LOG(ERROR, TAG, "No server request for the request handle");
+        OIC_TRACE_END();
+        return OC_STACK_ERROR;
+    }
+    OIC_TRACE_BUFFER("OIC_RI_SERVERREQUEST:HandleSingleResponse:token:",
+                     (const uint8_t *) serverRequest->requestToken, serverRequest->tokenLength);
 
     CopyDevAddrToEndpoint(&serverRequest->devAddr, &responseEndpoint);
 
@@ -553,7 +621,8 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     uint16_t payloadFormat = COAP_MEDIATYPE_APPLICATION_VND_OCF_CBOR;
     bool IsPayloadVersionSet = false;
     bool IsPayloadFormatSet = false;
-    if (ehResponse->payload)
+    bool hasPayload = (ehResponse->payload || serverRequest->encodedPayload);
+    if (hasPayload)
     {
         for (uint8_t i = 0; i < responseInfo.info.numOptions; i++)
         {
@@ -607,6 +676,7 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
         if(!responseInfo.info.options)
         {
             OIC_LOG(FATAL, TAG, "Memory alloc for options failed");
+            OIC_TRACE_END();
             return OC_STACK_NO_MEMORY;
         }
 
@@ -654,6 +724,7 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
                 OIC_LOG(ERROR, TAG,
                     "New resource path must be less than CA_MAX_HEADER_OPTION_DATA_LENGTH");
                 OICFree(responseInfo.info.options);
+                OIC_TRACE_END();
                 return OC_STACK_INVALID_URI;
             }
 
@@ -667,7 +738,7 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
             optionsPointer += 1;
         }
 
-        if (ehResponse->payload)
+        if (hasPayload)
         {
             if (!IsPayloadVersionSet && !IsPayloadFormatSet)
             {
@@ -714,9 +785,9 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     responseInfo.info.payloadFormat = CA_FORMAT_UNDEFINED;
 
     // Put the JSON prefix and suffix around the payload
-    if(ehResponse->payload)
+    if(hasPayload)
     {
-        if (ehResponse->payload->type == PAYLOAD_TYPE_PRESENCE)
+        if (ehResponse->payload && ehResponse->payload->type == PAYLOAD_TYPE_PRESENCE)
         {
             responseInfo.isMulticast = true;
         }
@@ -731,16 +802,33 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
                 // No preference set by the client, so default to CBOR then
             case OC_FORMAT_CBOR:
             case OC_FORMAT_VND_OCF_CBOR:
-                if((result = OCConvertPayload(ehResponse->payload, serverRequest->acceptFormat,
+                if (serverRequest->encodedPayload)
+                {
+                    // The payload was encoded for this request's accept format by the caller
+                    responseInfo.info.payload =
+                        (CAPayload_t)OICMalloc(serverRequest->encodedPayloadSize);
+                    if (!responseInfo.info.payload)
+                    {
+                        OIC_LOG(ERROR, TAG, "Memory alloc for payload failed");
+                        OICFree(responseInfo.info.options);
+                        OIC_TRACE_END();
+                        return OC_STACK_NO_MEMORY;
+                    }
+                    memcpy(responseInfo.info.payload, serverRequest->encodedPayload,
+                           serverRequest->encodedPayloadSize);
+                    responseInfo.info.payloadSize = serverRequest->encodedPayloadSize;
+                }
+                else if((result = OCConvertPayload(ehResponse->payload, serverRequest->acceptFormat,
                                 &responseInfo.info.payload, &responseInfo.info.payloadSize))
                         != OC_STACK_OK)
                 {
                     OIC_LOG(ERROR, TAG, "Error converting payload");
                     OICFree(responseInfo.info.options);
+                    OIC_TRACE_END();
                     return result;
                 }
                 // Add CONTENT_FORMAT OPT if payload exist
-                if (ehResponse->payload->type != PAYLOAD_TYPE_DIAGNOSTIC &&
+                if ((!ehResponse->payload || ehResponse->payload->type != PAYLOAD_TYPE_DIAGNOSTIC) &&
                         responseInfo.info.payloadSize > 0)
                 {
                     responseInfo.info.payloadFormat = OCToCAPayloadFormat(
@@ -829,6 +917,7 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     OICFree(responseInfo.info.options);
     //Delete the request
     DeleteServerRequest(serverRequest);
+    OIC_TRACE_END();
     return result;
 }
 
@@ -842,9 +931,8 @@ OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse)
 
     OIC_LOG(INFO, TAG, "Inside HandleAggregateResponse");
 
-    OCServerRequest *serverRequest = (OCServerRequest *)ehResponse->requestHandle;
-    OCServerResponse *serverResponse = GetServerResponseUsingHandle((OCServerRequest *)
-                                                                    ehResponse->requestHandle);
+    OCServerRequest *serverRequest = GetServerRequestUsingHandle(ehResponse->requestHandle);
+    OCServerResponse *serverResponse = GetServerResponseUsingHandle(ehResponse->requestHandle);
 
     OCStackResult stackRet = OC_STACK_ERROR;
     if(serverRequest)
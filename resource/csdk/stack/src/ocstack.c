@@ -67,6 +67,7 @@
 #include "cainterface.h"
 #include "caprotocolmessage.h"
 #include "oicgroup.h"
+#include "occollection.h"
 #include "ocendpoint.h"
 #include "ocatomic.h"
 #include "platform_features.h"
@@ -438,6 +439,49 @@ static OCStackResult SetHeaderOption(CAHeaderOption_t *caHdrOpt, size_t numOptio
  */
 static OCStackResult OCSendRequest(const CAEndpoint_t *object, CARequestInfo_t *requestInfo);
 
+/**
+ * Common implementation of ::OCDoRequest and ::OCDoStreamingRequest.
+ * chunkHandler is NULL unless the response should be delivered block by block.
+ */
+static OCStackResult OCDoRequestInternal(OCDoHandle *handle,
+                                         OCMethod method,
+                                         const char *requestUri,
+                                         const OCDevAddr *destination,
+                                         OCPayload* payload,
+                                         OCConnectivityType connectivityType,
+                                         OCQualityOfService qos,
+                                         OCCallbackData *cbData,
+                                         OCClientResponseChunkHandler chunkHandler,
+                                         OCHeaderOption *options,
+                                         uint8_t numOptions);
+
+/**
+ * Get the position of a block of a streamed block-wise response.
+ *
+ * @param responseInfo CA response info.
+ * @param offset Offset of the block in the whole payload.
+ * @param isLast Whether this is the last block.
+ *
+ * @return true if the response carries a single block of a streamed response.
+ */
+static bool GetStreamedBlockInfo(const CAResponseInfo_t *responseInfo,
+                                 size_t *offset, bool *isLast);
+
+/**
+ * Pass a block of a streamed response to the chunk handler of the client callback.
+ *
+ * @param endPoint CA remote endpoint.
+ * @param responseInfo CA response info.
+ * @param cbNode Client callback which requested streaming.
+ * @param offset Offset of the block in the whole payload.
+ * @param isLast Whether this is the last block.
+ *
+ * @return true if the response should be completed through the regular callback.
+ */
+static bool HandleStreamedBlock(const CAEndpoint_t *endPoint,
+                                const CAResponseInfo_t *responseInfo,
+                                ClientCB *cbNode, size_t offset, bool isLast);
+
 /**
  * default adapter state change callback method
  *
@@ -1481,6 +1525,63 @@ OCStackResult OCMapZoneIdToLinkLocalEndpoint(OCDiscoveryPayload *payload, uint32
 }
 #endif
 
+static bool GetStreamedBlockInfo(const CAResponseInfo_t *responseInfo,
+                                 size_t *offset, bool *isLast)
+{
+    const CAHeaderOption_t *options = responseInfo->info.options;
+    for (uint8_t i = 0; options && i < responseInfo->info.numOptions; i++)
+    {
+        if (CA_OPTION_BLOCK2 == options[i].optionID)
+        {
+            uint32_t value = 0;
+            for (uint16_t j = 0; j < options[i].optionLength && j < sizeof(value); j++)
+            {
+                value = (value << 8) | (uint8_t) options[i].optionData[j];
+            }
+
+            // NUM | M | SZX as defined in RFC 7959
+            *offset = (size_t) (value >> 4) << ((value & 0x07) + 4);
+            *isLast = (0 == (value & 0x08));
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool HandleStreamedBlock(const CAEndpoint_t *endPoint,
+                                const CAResponseInfo_t *responseInfo,
+                                ClientCB *cbNode, size_t offset, bool isLast)
+{
+    OIC_LOG_V(DEBUG, TAG, "Streamed block at %" PRIuPTR ", last: %d", offset, isLast);
+
+    OCClientResponse response;
+    memset(&response, 0, sizeof(response));
+    response.devAddr.adapter = OC_DEFAULT_ADAPTER;
+    response.sequenceNumber = MAX_SEQUENCE_NUMBER + 1;
+    CopyEndpointToDevAddr(endPoint, &response.devAddr);
+    FixUpClientResponse(&response);
+    response.resourceUri = responseInfo->info.resourceUri;
+    memcpy(response.identity.id, responseInfo->info.identity.id, sizeof(response.identity.id));
+    response.identity.id_length = responseInfo->info.identity.id_length;
+    response.result = CAResponseToOCStackResult(responseInfo->result);
+
+    OCStackApplicationResult appFeedback = cbNode->chunkHandler(cbNode->context,
+                                                                cbNode->handle,
+                                                                &response,
+                                                                (const uint8_t *) responseInfo->info.payload,
+                                                                responseInfo->info.payloadSize,
+                                                                offset, isLast);
+    if (OC_STACK_DELETE_TRANSACTION == appFeedback)
+    {
+        DeleteClientCB(cbNode);
+        return false;
+    }
+
+    // keep the callback alive while blocks keep coming
+    cbNode->TTL = GetTicks(MAX_CB_TIMEOUT_SECONDS * MILLISECONDS_PER_SECOND);
+    return isLast;
+}
+
 void OC_CALL OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* responseInfo)
 {
     OIC_LOG(DEBUG, TAG, "Enter OCHandleResponse");
@@ -1499,6 +1600,16 @@ void OC_CALL OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo
     {
         OIC_LOG(INFO, TAG, "There is a cbNode associated with the response token");
 
+        size_t blockOffset = 0;
+        bool isLastBlock = false;
+        bool isStreamedBlock = cbNode->chunkHandler &&
+                GetStreamedBlockInfo(responseInfo, &blockOffset, &isLastBlock);
+        if (isStreamedBlock &&
+            !HandleStreamedBlock(endPoint, responseInfo, cbNode, blockOffset, isLastBlock))
+        {
+            return;
+        }
+
         // check obs header option
         bool obsHeaderOpt = false;
         CAHeaderOption_t *options = responseInfo->info.options;
@@ -1727,8 +1838,9 @@ void OC_CALL OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo
 
             response->result = CAResponseToOCStackResult(responseInfo->result);
 
+            // the payload of a streamed response has been passed to the chunk handler
             if(responseInfo->info.payload &&
-               responseInfo->info.payloadSize)
+               responseInfo->info.payloadSize && !isStreamedBlock)
             {
                 // check the security resource
                 if (SRMIsSecurityResourceURI(cbNode->requestUri))
@@ -2568,6 +2680,8 @@ void HandleCARequests(const CAEndpoint_t* endPoint, const CARequestInfo_t* reque
         OIC_TRACE_END();
         return;
     }
+    OIC_TRACE_BUFFER("OIC_RI_STACK:HandleCARequests:token:",
+                     (const uint8_t *) requestInfo->info.token, requestInfo->info.tokenLength);
 
 #if defined (ROUTING_GATEWAY) || defined (ROUTING_EP)
 #ifdef ROUTING_GATEWAY
@@ -2755,6 +2869,11 @@ OCStackResult OCInitializeInternal(OCMode mode, OCTransportFlags serverFlags,
     result = InitializeScheduleResourceList();
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
+#ifdef RD_SERVER
+    result = OCRDDatabaseDiscoveryInitialize();
+    VERIFY_SUCCESS(result, OC_STACK_OK);
+#endif
+
     result = CAResultToOCResult(CAInitialize((CATransportAdapter_t)transportType));
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
@@ -2836,6 +2955,9 @@ exit:
     {
         OIC_LOG(ERROR, TAG, "Stack initialization error");
         TerminateScheduleResourceList();
+#ifdef RD_SERVER
+        OCRDDatabaseDiscoveryTerminate();
+#endif
         deleteAllResources();
         CATerminate();
         stackState = OC_STACK_UNINITIALIZED;
@@ -2904,6 +3026,11 @@ OCStackResult OCDeInitializeInternal()
     }
 
     TerminateScheduleResourceList();
+    TerminateBatchRequests();
+    DeleteDiscoveryCache();
+#ifdef RD_SERVER
+    OCRDDatabaseDiscoveryTerminate();
+#endif
     // Free memory dynamically allocated for resources
     deleteAllResources();
     // Remove all the client callbacks
@@ -3258,6 +3385,43 @@ OCStackResult OC_CALL OCDoRequest(OCDoHandle *handle,
                                   OCCallbackData *cbData,
                                   OCHeaderOption *options,
                                   uint8_t numOptions)
+{
+    return OCDoRequestInternal(handle, method, requestUri, destination, payload,
+                               connectivityType, qos, cbData, NULL, options, numOptions);
+}
+
+/**
+ * Perform a request whose block-wise response is delivered block by block
+ */
+OCStackResult OC_CALL OCDoStreamingRequest(OCDoHandle *handle,
+                                           OCMethod method,
+                                           const char *requestUri,
+                                           const OCDevAddr *destination,
+                                           OCPayload* payload,
+                                           OCConnectivityType connectivityType,
+                                           OCQualityOfService qos,
+                                           OCCallbackData *cbData,
+                                           OCClientResponseChunkHandler chunkHandler,
+                                           OCHeaderOption *options,
+                                           uint8_t numOptions)
+{
+    VERIFY_NON_NULL(chunkHandler, FATAL, OC_STACK_INVALID_CALLBACK);
+
+    return OCDoRequestInternal(handle, method, requestUri, destination, payload,
+                               connectivityType, qos, cbData, chunkHandler, options, numOptions);
+}
+
+static OCStackResult OCDoRequestInternal(OCDoHandle *handle,
+                                         OCMethod method,
+                                         const char *requestUri,
+                                         const OCDevAddr *destination,
+                                         OCPayload* payload,
+                                         OCConnectivityType connectivityType,
+                                         OCQualityOfService qos,
+                                         OCCallbackData *cbData,
+                                         OCClientResponseChunkHandler chunkHandler,
+                                         OCHeaderOption *options,
+                                         uint8_t numOptions)
 {
     OIC_LOG(INFO, TAG, "Entering OCDoResource");
 
@@ -3607,6 +3771,19 @@ OCStackResult OC_CALL OCDoRequest(OCDoHandle *handle,
     resourceUri = NULL;   // Client CB list entry now owns it
     resourceType = NULL;  // Client CB list entry now owns it
 
+    if (chunkHandler && !requestInfo.isMulticast)
+    {
+        // CA has to know before the first block of the response arrives
+        if (CA_STATUS_OK == CAEnableBlockwiseStreaming(&endpoint, &requestInfo))
+        {
+            clientCB->chunkHandler = chunkHandler;
+        }
+        else
+        {
+            OIC_LOG(INFO, TAG, "Block-wise streaming is not available, response is reassembled");
+        }
+    }
+
 #ifdef WITH_PRESENCE
     if (method == OC_REST_PRESENCE)
     {
@@ -3959,6 +4136,7 @@ OCStackResult OC_CALL OCProcess()
     OCProcessPresence();
 #endif
     CAHandleRequestResponse();
+    ProcessBatchDeadlines();
 
 #ifdef ROUTING_GATEWAY
     RMProcess();
@@ -3970,6 +4148,35 @@ OCStackResult OC_CALL OCProcess()
     return OC_STACK_OK;
 }
 
+OCStackResult OC_CALL OCRegisterProcessEvent(struct oc_event_t *event)
+{
+    if (stackState != OC_STACK_INITIALIZED)
+    {
+        OIC_LOG(ERROR, TAG, "OCRegisterProcessEvent has failed. ocstack is not initialized");
+        return OC_STACK_ERROR;
+    }
+
+    if (NULL == event)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    CAResult_t caResult = CARegisterProcessEvent(event);
+    return CAResultToOCResult(caResult);
+}
+
+OCStackResult OC_CALL OCUnregisterProcessEvent(struct oc_event_t *event)
+{
+    if (stackState != OC_STACK_INITIALIZED)
+    {
+        OIC_LOG(ERROR, TAG, "OCUnregisterProcessEvent has failed. ocstack is not initialized");
+        return OC_STACK_ERROR;
+    }
+
+    CAUnregisterProcessEvent(event);
+    return OC_STACK_OK;
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult OC_CALL OCStartPresence(const uint32_t ttl)
 {
@@ -4441,6 +4648,24 @@ OCStackResult OC_CALL OCUnBindResource(
     return OC_STACK_ERROR;
 }
 
+OCStackResult OC_CALL OCSetCollectionBatchConcurrency(OCResourceHandle collectionHandle,
+                                                      uint32_t deadlineMs)
+{
+    OIC_LOG(INFO, TAG, "Entering OCSetCollectionBatchConcurrency");
+
+    VERIFY_NON_NULL(collectionHandle, ERROR, OC_STACK_INVALID_PARAM);
+
+    OCResource *resource = findResource((OCResource *) collectionHandle);
+    if (!resource)
+    {
+        OIC_LOG(ERROR, TAG, "Collection handle not found");
+        return OC_STACK_NO_RESOURCE;
+    }
+
+    resource->batchDeadlineMs = deadlineMs;
+    return OC_STACK_OK;
+}
+
 static bool ValidateResourceTypeInterface(const char *resourceItemName)
 {
     if (!resourceItemName)
@@ -4600,6 +4825,7 @@ OCStackResult BindTpsTypeToResource(OCResource* resource,
 
     OIC_LOG_V(INFO, TAG, "Binding %d TPS flags to %s", supportedTps, resource->uri);
     resource->endpointType = supportedTps;
+    InvalidateDiscoveryCache();
     return result;
 }
 
@@ -4741,6 +4967,7 @@ OCStackResult OC_CALL OCSetResourceProperties(OCResourceHandle handle, uint8_t r
         return OC_STACK_NO_RESOURCE;
     }
     resource->resourceProperties = (OCResourceProperty) (resource->resourceProperties | resourceProperties);
+    InvalidateDiscoveryCache();
     return OC_STACK_OK;
 }
 
@@ -4755,6 +4982,7 @@ OCStackResult OC_CALL OCClearResourceProperties(OCResourceHandle handle, uint8_t
         return OC_STACK_NO_RESOURCE;
     }
     resource->resourceProperties = (OCResourceProperty) (resource->resourceProperties & ~resourceProperties);
+    InvalidateDiscoveryCache();
     return OC_STACK_OK;
 }
 
@@ -5043,14 +5271,24 @@ OCStackResult OC_CALL OCDoResponse(OCEntityHandlerResponse *ehResponse)
     VERIFY_NON_NULL(ehResponse, ERROR, OC_STACK_INVALID_PARAM);
     VERIFY_NON_NULL(ehResponse->requestHandle, ERROR, OC_STACK_INVALID_PARAM);
 
+    // Response of a resource to a batch request served concurrently
+    if (HandleBatchChildResponse(ehResponse, &result))
+    {
+        OIC_TRACE_END();
+        return result;
+    }
+
     // Normal response
     // Get pointer to request info
-    serverRequest = (OCServerRequest *)ehResponse->requestHandle;
-    if(serverRequest)
+    serverRequest = GetServerRequestUsingHandle(ehResponse->requestHandle);
+    if (!serverRequest)
     {
-        // response handler in ocserverrequest.c. Usually HandleSingleResponse.
-        result = serverRequest->ehResponseHandler(ehResponse);
+        OIC_LOG(ERROR, TAG, "Request handle is not pending, the request was already answered");
+        OIC_TRACE_END();
+        return OC_STACK_INVALID_PARAM;
     }
+    // response handler in ocserverrequest.c. Usually HandleSingleResponse.
+    result = serverRequest->ehResponseHandler(ehResponse);
 
     OIC_TRACE_END();
     return result;
@@ -5251,6 +5489,7 @@ OCStackResult initResources()
 
 void insertResource(OCResource *resource)
 {
+    InvalidateDiscoveryCache();
     if (!headResource)
     {
         headResource = resource;
@@ -5325,6 +5564,7 @@ OCStackResult deleteResource(OCResource *resource)
     }
 
     OIC_LOG_V (INFO, TAG, "Deleting resource %s", resource->uri);
+    InvalidateDiscoveryCache();
 
     temp = headResource;
     while (temp)
@@ -5369,6 +5609,7 @@ OCStackResult deleteResource(OCResource *resource)
                 prev->next = temp->next;
             }
 
+            CancelBatchRequestsForResource(temp);
             deleteResourceElements(temp);
             OICFree(temp);
             temp = NULL;
@@ -5474,8 +5715,11 @@ void insertResourceType(OCResource *resource, OCResourceType *resourceType)
     {
         return;
     }
+
+    InvalidateDiscoveryCache();
+
     // resource type list is empty.
-    else if (!resource->rsrcType)
+    if (!resource->rsrcType)
     {
         resource->rsrcType = resourceType;
     }
@@ -5564,6 +5808,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
     OCResourceInterface *pointer = NULL;
     OCResourceInterface *previous = NULL;
 
+    InvalidateDiscoveryCache();
     newInterface->next = NULL;
 
     OCResourceInterface **firstInterface = &(resource->rsrcInterface);
@@ -6151,6 +6396,9 @@ void OCDefaultAdapterStateChangedHandler(CATransportAdapter_t adapter, bool enab
 
     OC_UNUSED(adapter);
     OC_UNUSED(enabled);
+
+    // The endpoints in discovery responses depend on the network interfaces
+    InvalidateDiscoveryCache();
 }
 
 void OCDefaultConnectionStateChangedHandler(const CAEndpoint_t *info, bool isConnected)
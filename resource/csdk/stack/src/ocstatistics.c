@@ -0,0 +1,246 @@
+/* *****************************************************************
+ *
+ * Copyright 2017 Microsoft
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file implements the stack statistics API on top of the metrics registry, and the
+ * optional resource that serves the statistics to remote clients.
+ */
+
+#include "ocstack.h"
+#include "ocpayload.h"
+#include "ocmetrics.h"
+#include "oic_malloc.h"
+#include "platform_features.h"
+#include "experimental/logger.h"
+
+#define TAG "OIC_RI_STATISTICS"
+
+static const char *g_adapterNames[OC_STATISTICS_ADAPTER_COUNT] =
+{
+    "ip", "tcp", "gatt", "rfcomm", "nfc"
+};
+
+static void GetLatencyStatistics(const oc_metrics_histogram_snapshot *histogram,
+                                 OCLatencyStatistics *latency)
+{
+    latency->count = histogram->count;
+    latency->mean = histogram->count ? (histogram->sum / histogram->count) : 0;
+    latency->max = histogram->max;
+    latency->p50 = oc_metrics_histogram_percentile(histogram, 50);
+    latency->p90 = oc_metrics_histogram_percentile(histogram, 90);
+    latency->p99 = oc_metrics_histogram_percentile(histogram, 99);
+}
+
+OCStackResult OC_CALL OCGetStackStatistics(OCStackStatistics *stats)
+{
+    if (!stats)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    oc_metrics_snapshot *snapshot = (oc_metrics_snapshot *)OICMalloc(sizeof(oc_metrics_snapshot));
+    if (!snapshot)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to allocate metrics snapshot");
+        return OC_STACK_NO_MEMORY;
+    }
+    oc_metrics_get_snapshot(snapshot);
+
+    for (size_t i = 0; i < OC_STATISTICS_ADAPTER_COUNT; i++)
+    {
+        stats->messagesSent[i] = snapshot->counters[OC_METRIC_MESSAGES_SENT_IP + i];
+        stats->messagesReceived[i] = snapshot->counters[OC_METRIC_MESSAGES_RECEIVED_IP + i];
+    }
+    stats->retransmissions = snapshot->counters[OC_METRIC_RETRANSMISSIONS];
+    stats->duplicatesDropped = snapshot->counters[OC_METRIC_DUPLICATES_DROPPED];
+    stats->handshakesStarted = snapshot->counters[OC_METRIC_HANDSHAKES_STARTED];
+    stats->handshakesCompleted = snapshot->counters[OC_METRIC_HANDSHAKES_COMPLETED];
+    stats->sendQueueDepth = snapshot->gauges[OC_METRIC_SEND_QUEUE_DEPTH];
+    stats->receiveQueueDepth = snapshot->gauges[OC_METRIC_RECEIVE_QUEUE_DEPTH];
+    stats->observers = snapshot->gauges[OC_METRIC_OBSERVERS];
+    stats->clientCallbacks = snapshot->gauges[OC_METRIC_CLIENT_CALLBACKS];
+    stats->blockwiseSessions = snapshot->gauges[OC_METRIC_BLOCKWISE_SESSIONS];
+    GetLatencyStatistics(&snapshot->histograms[OC_METRIC_ENTITY_HANDLER_LATENCY],
+                         &stats->entityHandlerLatency);
+    GetLatencyStatistics(&snapshot->histograms[OC_METRIC_HANDSHAKE_LATENCY],
+                         &stats->handshakeLatency);
+
+    OICFree(snapshot);
+    return OC_STACK_OK;
+}
+
+static OCRepPayload *CreateAdapterPayload(const uint64_t *counts)
+{
+    OCRepPayload *payload = OCRepPayloadCreate();
+    if (!payload)
+    {
+        return NULL;
+    }
+    for (size_t i = 0; i < OC_STATISTICS_ADAPTER_COUNT; i++)
+    {
+        if (!OCRepPayloadSetPropInt(payload, g_adapterNames[i], (int64_t)counts[i]))
+        {
+            OCRepPayloadDestroy(payload);
+            return NULL;
+        }
+    }
+    return payload;
+}
+
+static OCRepPayload *CreateLatencyPayload(const OCLatencyStatistics *latency)
+{
+    OCRepPayload *payload = OCRepPayloadCreate();
+    if (!payload)
+    {
+        return NULL;
+    }
+    if (!OCRepPayloadSetPropInt(payload, "count", (int64_t)latency->count) ||
+        !OCRepPayloadSetPropInt(payload, "mean", (int64_t)latency->mean) ||
+        !OCRepPayloadSetPropInt(payload, "max", (int64_t)latency->max) ||
+        !OCRepPayloadSetPropInt(payload, "p50", (int64_t)latency->p50) ||
+        !OCRepPayloadSetPropInt(payload, "p90", (int64_t)latency->p90) ||
+        !OCRepPayloadSetPropInt(payload, "p99", (int64_t)latency->p99))
+    {
+        OCRepPayloadDestroy(payload);
+        return NULL;
+    }
+    return payload;
+}
+
+static bool SetObjectAsOwner(OCRepPayload *payload, const char *name, OCRepPayload *value)
+{
+    if (!value)
+    {
+        return false;
+    }
+    if (!OCRepPayloadSetPropObjectAsOwner(payload, name, value))
+    {
+        OCRepPayloadDestroy(value);
+        return false;
+    }
+    return true;
+}
+
+static OCRepPayload *CreateStatisticsPayload(const OCStackStatistics *stats)
+{
+    OCRepPayload *payload = OCRepPayloadCreate();
+    if (!payload)
+    {
+        return NULL;
+    }
+
+    if (!OCRepPayloadAddResourceType(payload, OC_RSRVD_RESOURCE_TYPE_STATISTICS) ||
+        !SetObjectAsOwner(payload, "sent", CreateAdapterPayload(stats->messagesSent)) ||
+        !SetObjectAsOwner(payload, "received", CreateAdapterPayload(stats->messagesReceived)) ||
+        !OCRepPayloadSetPropInt(payload, "retransmissions", (int64_t)stats->retransmissions) ||
+        !OCRepPayloadSetPropInt(payload, "duplicatesDropped", (int64_t)stats->duplicatesDropped) ||
+        !OCRepPayloadSetPropInt(payload, "handshakesStarted", (int64_t)stats->handshakesStarted) ||
+        !OCRepPayloadSetPropInt(payload, "handshakesCompleted",
+                                (int64_t)stats->handshakesCompleted) ||
+        !OCRepPayloadSetPropInt(payload, "sendQueueDepth", stats->sendQueueDepth) ||
+        !OCRepPayloadSetPropInt(payload, "receiveQueueDepth", stats->receiveQueueDepth) ||
+        !OCRepPayloadSetPropInt(payload, "observers", stats->observers) ||
+        !OCRepPayloadSetPropInt(payload, "clientCallbacks", stats->clientCallbacks) ||
+        !OCRepPayloadSetPropInt(payload, "blockwiseSessions", stats->blockwiseSessions) ||
+        !SetObjectAsOwner(payload, "entityHandlerLatency",
+                          CreateLatencyPayload(&stats->entityHandlerLatency)) ||
+        !SetObjectAsOwner(payload, "handshakeLatency",
+                          CreateLatencyPayload(&stats->handshakeLatency)))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to build statistics payload");
+        OCRepPayloadDestroy(payload);
+        return NULL;
+    }
+    return payload;
+}
+
+static OCEntityHandlerResult StatisticsEntityHandler(OCEntityHandlerFlag flag,
+                                                     OCEntityHandlerRequest *ehRequest,
+                                                     void *callbackParam)
+{
+    OC_UNUSED(callbackParam);
+
+    if (!(flag & OC_REQUEST_FLAG) || !ehRequest)
+    {
+        return OC_EH_ERROR;
+    }
+
+    OCEntityHandlerResponse response = { 0 };
+    OCRepPayload *payload = NULL;
+    OCStackStatistics stats;
+
+    response.requestHandle = ehRequest->requestHandle;
+    response.resourceHandle = ehRequest->resource;
+    if (OC_REST_GET != ehRequest->method)
+    {
+        response.ehResult = OC_EH_METHOD_NOT_ALLOWED;
+    }
+    else if ((OC_STACK_OK != OCGetStackStatistics(&stats)) ||
+             (NULL == (payload = CreateStatisticsPayload(&stats))))
+    {
+        response.ehResult = OC_EH_ERROR;
+    }
+    else
+    {
+        response.ehResult = OC_EH_OK;
+        response.payload = (OCPayload *)payload;
+    }
+
+    OCStackResult result = OCDoResponse(&response);
+    OCRepPayloadDestroy(payload);
+    if (OC_STACK_OK != result)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to send statistics response: %d", result);
+        return OC_EH_ERROR;
+    }
+    return OC_EH_OK;
+}
+
+OCStackResult OC_CALL OCCreateStatisticsResource(OCResourceHandle *handle)
+{
+    OCResourceHandle resource = NULL;
+    OCStackResult result = OCCreateResource(&resource,
+                                            OC_RSRVD_RESOURCE_TYPE_STATISTICS,
+                                            OC_RSRVD_INTERFACE_DEFAULT,
+                                            OC_RSRVD_STATISTICS_URI,
+                                            StatisticsEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE | OC_SECURE);
+    if (OC_STACK_OK != result)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to create statistics resource: %d", result);
+        return result;
+    }
+
+    result = OCBindResourceInterfaceToResource(resource, OC_RSRVD_INTERFACE_READ);
+    if (OC_STACK_OK != result)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to bind read interface: %d", result);
+        OCDeleteResource(resource);
+        return result;
+    }
+
+    if (handle)
+    {
+        *handle = resource;
+    }
+    return OC_STACK_OK;
+}
@@ -888,7 +888,7 @@ OCStackApplicationResult ActionSetCB(void* context, OCDoHandle handle,
         }
 
         // Format the response.  Note this requires some info about the request
-        response.requestHandle = info->ehRequest;
+        response.requestHandle = GetServerRequestHandle(info->ehRequest);
         response.payload = clientResponse->payload;
         response.numSendVendorSpecificHeaderOptions = 0;
         memset(response.sendVendorSpecificHeaderOptions, 0,
@@ -1249,17 +1249,17 @@ OCStackResult BuildCollectionGroupActionCBORResponse(
                         OIC_LOG_V(INFO, TAG, "Execute ActionSet : %s",
                                 actionset->actionsetName);
                         uint8_t num = GetNumOfTargetResource(actionset->head);
+                        OCServerRequest *request =
+                                GetServerRequestUsingHandle(ehRequest->requestHandle);
+                        VARIFY_PARAM_NULL(request, stackRet, exit);
 
-                        ((OCServerRequest *) ehRequest->requestHandle)->ehResponseHandler =
-                                HandleAggregateResponse;
+                        request->ehResponseHandler = HandleAggregateResponse;
 
                         assert(num < UINT8_MAX);
 
-                        ((OCServerRequest *) ehRequest->requestHandle)->numResponses =
-                                num + 1;
+                        request->numResponses = num + 1;
 
-                        DoAction(resource, actionset,
-                                (OCServerRequest*) ehRequest->requestHandle);
+                        DoAction(resource, actionset, request);
                         stackRet = OC_STACK_OK;
                     }
                     else
@@ -1283,7 +1283,7 @@ OCStackResult BuildCollectionGroupActionCBORResponse(
                             schedule->resource = resource;
                             schedule->actionset = actionset;
                             schedule->ehRequest =
-                                    (OCServerRequest*) ehRequest->requestHandle;
+                                    GetServerRequestUsingHandle(ehRequest->requestHandle);
                             oc_mutex_unlock(g_scheduledResourceLock);
                             if (delay > 0)
                             {
@@ -421,7 +421,7 @@ OCStackResult SendKeepAliveResponse(OCServerRequest *request,
 
     OCEntityHandlerResponse ehResponse = { .ehResult = result, 
                                            .payload = (OCPayload*) payload, 
-                                           .requestHandle = request };
+                                           .requestHandle = GetServerRequestHandle(request) };
     OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri), KEEPALIVE_RESOURCE_URI);
 
     // Send response message.
@@ -36,6 +36,8 @@
 #include "oic_string.h"
 #include "oic_time.h"
 #include "cainterface.h"
+#include "octhread.h"
+#include "ocstackinternal.h"
 
 #define TAG "OIC_RI_RESOURCEDIRECTORY"
 
@@ -51,8 +53,15 @@ if (!(arg)) \
 
 static const char *gRDPath = "RD.db";
 
+/* Long-lived connection used to answer discovery queries, opened on first use. */
 static sqlite3 *gRDDB = NULL;
 
+/* How long a connection waits for the publishing connection to release its lock. */
+#define RD_BUSY_TIMEOUT_MS (1000)
+
+/* Interval between two sweeps of the expired devices. */
+#define RD_EXPIRY_SWEEP_INTERVAL_US (30 * US_PER_SEC)
+
 /* Column indices of RD_DEVICE_LINK_LIST table */
 static const uint8_t ins_index = 0;
 static const uint8_t href_index = 1;
@@ -61,6 +70,10 @@ static const uint8_t anchor_index = 3;
 static const uint8_t bm_index = 4;
 static const uint8_t d_index = 5;
 
+/* Column indices of RD_DEVICE_LIST table appended to the links query */
+static const uint8_t di_index = 6;
+static const uint8_t external_host_index = 7;
+
 /* Column indices of RD_LINK_RT table */
 static const uint8_t rt_value_index = 0;
 
@@ -71,14 +84,86 @@ static const uint8_t if_value_index = 0;
 static const uint8_t ep_value_index = 0;
 static const uint8_t pri_value_index = 1;
 
-#define VERIFY_SQLITE(arg) \
+/* Statements prepared once per connection and reset after every use. */
+typedef enum
+{
+    RD_STMT_LINKS = 0,
+    RD_STMT_RT,
+    RD_STMT_IF,
+    RD_STMT_EP,
+    RD_STMT_COUNT
+} RDStatement;
+
+/*
+ * The links of all unexpired devices, optionally filtered by resource and interface type, in a
+ * single statement.  Binding NULL to a filter disables it.
+ */
+static const char *gRDStatementSql[RD_STMT_COUNT] =
+{
+    "SELECT RD_DEVICE_LINK_LIST.*, RD_DEVICE_LIST.di, RD_DEVICE_LIST.external_host "
+        "FROM RD_DEVICE_LINK_LIST "
+        "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
+        "WHERE RD_DEVICE_LIST.ttl >= @ttl "
+        "AND (@resourceType IS NULL OR EXISTS (SELECT 1 FROM RD_LINK_RT "
+            "WHERE RD_LINK_RT.LINK_ID=RD_DEVICE_LINK_LIST.ins "
+            "AND RD_LINK_RT.rt LIKE @resourceType)) "
+        "AND (@interfaceType IS NULL OR EXISTS (SELECT 1 FROM RD_LINK_IF "
+            "WHERE RD_LINK_IF.LINK_ID=RD_DEVICE_LINK_LIST.ins "
+            "AND RD_LINK_IF.if LIKE @interfaceType)) "
+        "ORDER BY RD_DEVICE_LINK_LIST.DEVICE_ID, RD_DEVICE_LINK_LIST.ins",
+    "SELECT rt FROM RD_LINK_RT WHERE LINK_ID=@id",
+    "SELECT if FROM RD_LINK_IF WHERE LINK_ID=@id",
+    "SELECT ep,pri FROM RD_LINK_EP WHERE LINK_ID=@id"
+};
+
+static sqlite3_stmt *gRDStatements[RD_STMT_COUNT];
+
+/* Background sweep of the expired devices, running on its own connection. */
+typedef struct
+{
+    oc_thread thread;
+    sqlite3 *db;
+    bool stop;
+} RDExpirySweep;
+
+static RDExpirySweep *gRDSweep = NULL;
+
+/*
+ * Guards gRDPath, gRDDB, gRDStatements and gRDSweep, which are used from the public API on any
+ * thread and from the sweep thread.  Created by OCInit() and freed by OCStop().
+ */
+static oc_mutex gRDMutex = NULL;
+static oc_cond gRDSweepCond = NULL;
+
+#define VERIFY_SQLITE_DB(db, arg) \
 if (SQLITE_OK != (arg)) \
 { \
-    OIC_LOG_V(ERROR, TAG, "Error in " #arg ", Error Message: %s",  sqlite3_errmsg(gRDDB)); \
+    OIC_LOG_V(ERROR, TAG, "Error in " #arg ", Error Message: %s",  sqlite3_errmsg(db)); \
     result = OC_STACK_ERROR; \
     goto exit; \
 }
 
+#define VERIFY_SQLITE(arg) VERIFY_SQLITE_DB(gRDDB, arg)
+
+static RDExpirySweep *CloseDiscoveryDatabase();
+static void JoinExpirySweep(RDExpirySweep *sweep);
+
+static bool LockDiscoveryDatabase()
+{
+    if (!gRDMutex)
+    {
+        OIC_LOG(ERROR, TAG, "The discovery database is not initialized");
+        return false;
+    }
+    oc_mutex_lock(gRDMutex);
+    return true;
+}
+
+static void UnlockDiscoveryDatabase()
+{
+    oc_mutex_unlock(gRDMutex);
+}
+
 OCStackResult OC_CALL OCRDDatabaseSetStorageFilename(const char *filename)
 {
     if (!filename)
@@ -86,13 +171,37 @@ OCStackResult OC_CALL OCRDDatabaseSetStorageFilename(const char *filename)
         OIC_LOG(ERROR, TAG, "The persistent storage filename is invalid");
         return OC_STACK_INVALID_PARAM;
     }
+    if (!gRDMutex)
+    {
+        /* Before OCInit() there is neither a connection nor a sweep which could use the path */
+        gRDPath = filename;
+        return OC_STACK_OK;
+    }
+    if (!LockDiscoveryDatabase())
+    {
+        return OC_STACK_ERROR;
+    }
+    RDExpirySweep *sweep = NULL;
+    if (gRDPath != filename)
+    {
+        /* The cached connection refers to the previous file */
+        sweep = CloseDiscoveryDatabase();
+    }
     gRDPath = filename;
+    UnlockDiscoveryDatabase();
+    JoinExpirySweep(sweep);
     return OC_STACK_OK;
 }
 
 const char *OC_CALL OCRDDatabaseGetStorageFilename()
 {
-    return gRDPath;
+    if (!LockDiscoveryDatabase())
+    {
+        return NULL;
+    }
+    const char *path = gRDPath;
+    UnlockDiscoveryDatabase();
+    return path;
 }
 
 static void errorCallback(void *arg, int errCode, const char *errMsg)
@@ -134,374 +243,360 @@ exit:
     return result;
 }
 
-/* stmt is of form "SELECT * FROM RD_DEVICE_LINK_LIST ..." */
-static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDevAddr *devAddr,
-        OCDiscoveryPayload *discPayload)
+static OCStackResult OpenDatabase(sqlite3 **db)
 {
-    int res = sqlite3_step(stmt);
-    if (SQLITE_ROW != res)
+    OCStackResult result;
+    sqlite3_stmt *stmt = NULL;
+
+    /* Called with gRDMutex held */
+    if (SQLITE_OK != sqlite3_open_v2(gRDPath, db, SQLITE_OPEN_READWRITE, NULL))
     {
-        return OC_STACK_NO_RESOURCE;
+        OIC_LOG_V(ERROR, TAG, "Could not open %s", gRDPath);
+        result = OC_STACK_ERROR;
+        goto exit;
     }
+    VERIFY_SQLITE_DB(*db, sqlite3_busy_timeout(*db, RD_BUSY_TIMEOUT_MS));
+    VERIFY_SQLITE_DB(*db, sqlite3_prepare_v2(*db, "PRAGMA foreign_keys = ON;", -1, &stmt, NULL));
+    if (SQLITE_DONE != sqlite3_step(stmt))
+    {
+        result = OC_STACK_ERROR;
+        goto exit;
+    }
+    result = OC_STACK_OK;
+
+exit:
+    sqlite3_finalize(stmt);
+    if (OC_STACK_OK != result)
+    {
+        sqlite3_close(*db);
+        *db = NULL;
+    }
+    return result;
+}
 
+static OCStackResult DeleteExpiredResources(sqlite3 *db)
+{
+    sqlite3_stmt *stmt = NULL;
     OCStackResult result;
-    OCResourcePayload *resourcePayload = NULL;
-    OCEndpointPayload *epPayload = NULL;
-    sqlite3_stmt *stmtRT = NULL;
-    sqlite3_stmt *stmtIF = NULL;
-    sqlite3_stmt *stmtEP = NULL;
-    sqlite3_stmt *stmtDI = NULL;
-    while (SQLITE_ROW == res)
-    {
-        resourcePayload = (OCResourcePayload *)OICCalloc(1, sizeof(OCResourcePayload));
-        VERIFY_NON_NULL(resourcePayload);
-
-        sqlite3_int64 id = sqlite3_column_int64(stmt, ins_index);
-        const unsigned char *uri = sqlite3_column_text(stmt, href_index);
-        const unsigned char *rel = sqlite3_column_text(stmt, rel_index);
-        const unsigned char *anchor = sqlite3_column_text(stmt, anchor_index);
-        sqlite3_int64 bitmap = sqlite3_column_int64(stmt, bm_index);
-        sqlite3_int64 deviceId = sqlite3_column_int64(stmt, d_index);
-        OIC_LOG_V(DEBUG, TAG, " %s %" PRId64, uri, (int64_t) deviceId);
 
-        resourcePayload->uri = OICStrdup((char *)uri);
-        VERIFY_NON_NULL(resourcePayload->uri)
-        if (rel)
-        {
-            resourcePayload->rel = OICStrdup((char *)rel);
-            VERIFY_NON_NULL(resourcePayload->rel);
-        }
-        if (anchor)
-        {
-            resourcePayload->anchor = OICStrdup((char *)anchor);
-            VERIFY_NON_NULL(resourcePayload->anchor);
-        }
+    /* Links, types, interfaces and endpoints are removed by the ON DELETE CASCADE clauses */
+    uint64_t ttl = OICGetCurrentTime(TIME_IN_US);
+    static const char lapsed[] = "DELETE FROM RD_DEVICE_LIST WHERE ttl < @ttl";
+    int lapsedSize = (int)sizeof(lapsed);
+    VERIFY_SQLITE_DB(db, sqlite3_prepare_v2(db, lapsed, lapsedSize, &stmt, NULL));
+    VERIFY_SQLITE_DB(db, sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@ttl"),
+                                            (int64_t)ttl));
+    if (SQLITE_DONE != sqlite3_step(stmt))
+    {
+        OIC_LOG_V(WARNING, TAG, "Error deleting expired devices, Error Message: %s",
+                  sqlite3_errmsg(db));
+        result = OC_STACK_ERROR;
+        goto exit;
+    }
+    if (sqlite3_changes(db))
+    {
+        OIC_LOG_V(INFO, TAG, "Deleted %d expired devices", sqlite3_changes(db));
+    }
+    result = OC_STACK_OK;
 
-        const char rt[] = "SELECT rt FROM RD_LINK_RT WHERE LINK_ID=@id";
-        int rtSize = (int)sizeof(rt);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, rt, rtSize, &stmtRT, NULL));
-        VERIFY_SQLITE(sqlite3_bind_int64(stmtRT, sqlite3_bind_parameter_index(stmtRT, "@id"), id));
-        while (SQLITE_ROW == sqlite3_step(stmtRT))
-        {
-            const unsigned char *tempRt = sqlite3_column_text(stmtRT, rt_value_index);
-            result = appendStringLL(&resourcePayload->types, tempRt);
-            if (OC_STACK_OK != result)
-            {
-                goto exit;
-            }
-        }
-        VERIFY_SQLITE(sqlite3_finalize(stmtRT));
-        stmtRT = NULL;
-
-        const char itf[] = "SELECT if FROM RD_LINK_IF WHERE LINK_ID=@id";
-        int itfSize = (int)sizeof(itf);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, itf, itfSize, &stmtIF, NULL));
-        VERIFY_SQLITE(sqlite3_bind_int64(stmtIF, sqlite3_bind_parameter_index(stmtIF, "@id"), id));
-        while (SQLITE_ROW == sqlite3_step(stmtIF))
-        {
-            const unsigned char *tempItf = sqlite3_column_text(stmtIF, if_value_index);
-            result = appendStringLL(&resourcePayload->interfaces, tempItf);
-            if (OC_STACK_OK != result)
-            {
-                goto exit;
-            }
-        }
-        VERIFY_SQLITE(sqlite3_finalize(stmtIF));
-        stmtIF = NULL;
+ exit:
+    sqlite3_finalize(stmt);
+    return result;
+}
 
-        resourcePayload->bitmap = (uint8_t)(bitmap & (OC_OBSERVABLE | OC_DISCOVERABLE));
+static void *ExpirySweepThread(void *arg)
+{
+    RDExpirySweep *sweep = (RDExpirySweep *)arg;
 
-        CAEndpoint_t *networkInfo = NULL;
-        size_t infoSize = 0;
-        if (devAddr)
-        {
-            CAResult_t caResult = CAGetNetworkInformation(&networkInfo, &infoSize);
-            if (CA_STATUS_FAILED == caResult)
-            {
-                OIC_LOG(WARNING, TAG, "CAGetNetworkInformation has error on parsing network infomation");
-            }
-        }
-        const char ep[] = "SELECT ep,pri FROM RD_LINK_EP WHERE LINK_ID=@id";
-        int epSize = (int)sizeof(ep);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, ep, epSize, &stmtEP, NULL));
-        VERIFY_SQLITE(sqlite3_bind_int64(stmtEP, sqlite3_bind_parameter_index(stmtEP, "@id"), id));
-        while (SQLITE_ROW == sqlite3_step(stmtEP))
-        {
-            epPayload = (OCEndpointPayload *)OICCalloc(1, sizeof(OCEndpointPayload));
-            VERIFY_NON_NULL(epPayload);
-            const unsigned char *tempEp = sqlite3_column_text(stmtEP, ep_value_index);
-            result = OCParseEndpointString((const char *)tempEp, epPayload);
-            if (OC_STACK_OK != result)
-            {
-                goto exit;
-            }
-            sqlite3_int64 pri = sqlite3_column_int64(stmtEP, pri_value_index);
-            epPayload->pri = (uint16_t)pri;
-            bool includeEp = true;
-            if (devAddr)
-            {
-                CAEndpoint_t *info = NULL;
-                for (size_t i = 0; i < infoSize; ++i)
-                {
-                    if (!strcmp(epPayload->addr, networkInfo[i].addr))
-                    {
-                        info = &networkInfo[i];
-                        break;
-                    }
-                }
-                includeEp = info &&
-                        (((OC_ADAPTER_IP | OC_ADAPTER_TCP) & (devAddr->adapter)) &&
-                        ((((CA_ADAPTER_IP | CA_ADAPTER_TCP) & info->adapter) &&
-                                (info->ifindex == devAddr->ifindex)) ||
-                                info->adapter == CA_ADAPTER_RFCOMM_BTEDR));
-            }
-            if (includeEp)
-            {
-                OCEndpointPayload **tmp = &resourcePayload->eps;
-                while (*tmp)
-                {
-                    tmp = &(*tmp)->next;
-                }
-                *tmp = epPayload;
-            }
-            else
-            {
-                OICFree(epPayload);
-            }
-            epPayload = NULL;
-        }
-        VERIFY_SQLITE(sqlite3_finalize(stmtEP));
-        stmtEP = NULL;
-        if (networkInfo)
+    oc_mutex_lock(gRDMutex);
+    while (!sweep->stop)
+    {
+        DeleteExpiredResources(sweep->db);
+        if (!sweep->stop)
         {
-            OICFree(networkInfo);
+            oc_cond_wait_for(gRDSweepCond, gRDMutex, RD_EXPIRY_SWEEP_INTERVAL_US);
         }
+    }
+    oc_mutex_unlock(gRDMutex);
+    return NULL;
+}
 
-        const char di[] = "SELECT di FROM RD_DEVICE_LIST "
-            "INNER JOIN RD_DEVICE_LINK_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID = RD_DEVICE_LIST.ID "
-            "WHERE RD_DEVICE_LINK_LIST.DEVICE_ID=@deviceId";
-        int diSize = (int)sizeof(di);
-        const uint8_t di_index = 0;
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, di, diSize, &stmtDI, NULL));
-        VERIFY_SQLITE(sqlite3_bind_int64(stmtDI, sqlite3_bind_parameter_index(stmtDI, "@deviceId"), deviceId));
-        res = sqlite3_step(stmtDI);
-        if (SQLITE_ROW == res || SQLITE_DONE == res)
-        {
-            const unsigned char *tempDi = sqlite3_column_text(stmtDI, di_index);
-            OIC_LOG_V(DEBUG, TAG, " %s", tempDi);
-            discPayload->sid = OICStrdup((char *)tempDi);
-            VERIFY_NON_NULL(discPayload->sid);
-        }
-        VERIFY_SQLITE(sqlite3_finalize(stmtDI));
-        stmtDI = NULL;
+/* Called with gRDMutex held */
+static void StartExpirySweep()
+{
+    RDExpirySweep *sweep = (RDExpirySweep *)OICCalloc(1, sizeof(RDExpirySweep));
+    if (!sweep || (OC_STACK_OK != OpenDatabase(&sweep->db)))
+    {
+        OIC_LOG(WARNING, TAG, "Expired devices will not be swept");
+        OICFree(sweep);
+        return;
+    }
+    if (OC_THREAD_SUCCESS != oc_thread_new(&sweep->thread, ExpirySweepThread, sweep))
+    {
+        OIC_LOG(WARNING, TAG, "Failed to start expiry sweep, expired devices will not be swept");
+        sqlite3_close(sweep->db);
+        OICFree(sweep);
+        return;
+    }
+    gRDSweep = sweep;
+}
+
+/*
+ * Called with gRDMutex held.  Tells the sweep thread to stop and returns it; the caller joins it
+ * with JoinExpirySweep() after releasing gRDMutex, which the sweep thread needs to exit.
+ */
+static RDExpirySweep *StopExpirySweep()
+{
+    RDExpirySweep *sweep = gRDSweep;
+    gRDSweep = NULL;
+    if (sweep)
+    {
+        sweep->stop = true;
+        oc_cond_broadcast(gRDSweepCond);
+    }
+    return sweep;
+}
+
+/* Called without gRDMutex held */
+static void JoinExpirySweep(RDExpirySweep *sweep)
+{
+    if (!sweep)
+    {
+        return;
+    }
+    oc_thread_wait(sweep->thread);
+    oc_thread_free(sweep->thread);
+    sqlite3_close(sweep->db);
+    OICFree(sweep);
+}
+
+/* Called with gRDMutex held */
+static void CloseDiscoveryConnection()
+{
+    for (size_t i = 0; i < RD_STMT_COUNT; ++i)
+    {
+        sqlite3_finalize(gRDStatements[i]);
+        gRDStatements[i] = NULL;
+    }
+    sqlite3_close(gRDDB);
+    gRDDB = NULL;
+}
 
-        OCDiscoveryPayloadAddNewResource(discPayload, resourcePayload);
-        resourcePayload = NULL;
-        res = sqlite3_step(stmt);
+/* Called with gRDMutex held, see StopExpirySweep() for the returned sweep */
+static RDExpirySweep *CloseDiscoveryDatabase()
+{
+    CloseDiscoveryConnection();
+    return StopExpirySweep();
+}
+
+/* Called with gRDMutex held */
+static OCStackResult OpenDiscoveryDatabase()
+{
+    OCStackResult result;
+
+    if (gRDDB)
+    {
+        return OC_STACK_OK;
     }
+
+    if (SQLITE_OK == sqlite3_config(SQLITE_CONFIG_LOG, errorCallback))
+    {
+        OIC_LOG_V(INFO, TAG, "SQLite debugging log initialized.");
+    }
+    result = OpenDatabase(&gRDDB);
+    if (OC_STACK_OK != result)
+    {
+        goto exit;
+    }
+    for (size_t i = 0; i < RD_STMT_COUNT; ++i)
+    {
+        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, gRDStatementSql[i], -1, &gRDStatements[i], NULL));
+    }
+    StartExpirySweep();
     result = OC_STACK_OK;
 
 exit:
-    sqlite3_finalize(stmtDI);
-    sqlite3_finalize(stmtEP);
-    sqlite3_finalize(stmtIF);
-    sqlite3_finalize(stmtRT);
-    OICFree(epPayload);
-    OCDiscoveryResourceDestroy(resourcePayload);
+    if (OC_STACK_OK != result)
+    {
+        CloseDiscoveryConnection();
+    }
     return result;
 }
 
-static OCStackResult CheckResources(const char *interfaceType, const char *resourceType,
-        OCDevAddr *devAddr, OCDiscoveryPayload *discPayload)
+OCStackResult OCRDDatabaseDiscoveryInitialize()
 {
-    if (!interfaceType && !resourceType)
+    if (gRDMutex)
     {
-        return OC_STACK_INVALID_QUERY;
+        return OC_STACK_OK;
     }
-    if (!discPayload || !discPayload->sid)
+    gRDMutex = oc_mutex_new();
+    gRDSweepCond = oc_cond_new();
+    if (!gRDMutex || !gRDSweepCond)
     {
-        return OC_STACK_INTERNAL_SERVER_ERROR;
+        OIC_LOG(ERROR, TAG, "Failed to create the discovery database lock");
+        oc_cond_free(gRDSweepCond);
+        gRDSweepCond = NULL;
+        oc_mutex_free(gRDMutex);
+        gRDMutex = NULL;
+        return OC_STACK_NO_MEMORY;
     }
+    return OC_STACK_OK;
+}
 
-    size_t sidLength = strlen(discPayload->sid);
-    size_t resourceTypeLength = resourceType ? strlen(resourceType) : 0;
-    size_t interfaceTypeLength = interfaceType ? strlen(interfaceType) : 0;
+void OCRDDatabaseDiscoveryTerminate()
+{
+    if (!LockDiscoveryDatabase())
+    {
+        return;
+    }
+    RDExpirySweep *sweep = CloseDiscoveryDatabase();
+    UnlockDiscoveryDatabase();
+    JoinExpirySweep(sweep);
+
+    oc_cond_free(gRDSweepCond);
+    gRDSweepCond = NULL;
+    oc_mutex_free(gRDMutex);
+    gRDMutex = NULL;
+}
 
-    if ((sidLength > INT_MAX) ||
-        (resourceTypeLength > INT_MAX) ||
-        (interfaceTypeLength > INT_MAX))
+/* Adds the rows of a prepared RD_LINK_RT or RD_LINK_IF statement to list. */
+static OCStackResult AppendLinkValues(RDStatement index, sqlite3_int64 id, uint8_t column,
+        OCStringLL **list)
+{
+    OCStackResult result = OC_STACK_OK;
+    sqlite3_stmt *stmt = gRDStatements[index];
+    VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), id));
+    while (SQLITE_ROW == sqlite3_step(stmt))
     {
-        return OC_STACK_INVALID_QUERY;
+        result = appendStringLL(list, sqlite3_column_text(stmt, column));
+        if (OC_STACK_OK != result)
+        {
+            goto exit;
+        }
     }
 
+exit:
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    return result;
+}
+
+static OCStackResult AppendLinkEndpoints(sqlite3_int64 id, const OCDevAddr *devAddr,
+        const CAEndpoint_t *networkInfo, size_t infoSize, OCResourcePayload *resourcePayload)
+{
     OCStackResult result = OC_STACK_OK;
-    sqlite3_stmt *stmt = NULL;
-    if (resourceType)
+    OCEndpointPayload *epPayload = NULL;
+    sqlite3_stmt *stmt = gRDStatements[RD_STMT_EP];
+    VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), id));
+    while (SQLITE_ROW == sqlite3_step(stmt))
     {
-        if (!interfaceType || 0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_LL) ||
-                0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_DEFAULT))
+        epPayload = (OCEndpointPayload *)OICCalloc(1, sizeof(OCEndpointPayload));
+        VERIFY_NON_NULL(epPayload);
+        const unsigned char *tempEp = sqlite3_column_text(stmt, ep_value_index);
+        result = OCParseEndpointString((const char *)tempEp, epPayload);
+        if (OC_STACK_OK != result)
         {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "INNER JOIN RD_LINK_RT ON RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di AND RD_LINK_RT.rt LIKE @resourceType";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
-                            discPayload->sid, (int)sidLength, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
-                            resourceType, (int)resourceTypeLength, SQLITE_STATIC));
+            goto exit;
         }
-        else
+        sqlite3_int64 pri = sqlite3_column_int64(stmt, pri_value_index);
+        epPayload->pri = (uint16_t)pri;
+        bool includeEp = true;
+        if (devAddr)
         {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "INNER JOIN RD_LINK_RT ON RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID "
-                                "INNER JOIN RD_LINK_IF ON RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di "
-                                "AND RD_LINK_RT.rt LIKE @resourceType "
-                                "AND RD_LINK_IF.if LIKE @interfaceType";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
-                            discPayload->sid, (int)sidLength, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
-                            resourceType, (int)resourceTypeLength, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
-                            interfaceType, (int)interfaceTypeLength, SQLITE_STATIC));
+            const CAEndpoint_t *info = NULL;
+            for (size_t i = 0; i < infoSize; ++i)
+            {
+                if (!strcmp(epPayload->addr, networkInfo[i].addr))
+                {
+                    info = &networkInfo[i];
+                    break;
+                }
+            }
+            includeEp = info &&
+                    (((OC_ADAPTER_IP | OC_ADAPTER_TCP) & (devAddr->adapter)) &&
+                    ((((CA_ADAPTER_IP | CA_ADAPTER_TCP) & info->adapter) &&
+                            (info->ifindex == devAddr->ifindex)) ||
+                            info->adapter == CA_ADAPTER_RFCOMM_BTEDR));
         }
-        result = ResourcePayloadCreate(stmt, devAddr, discPayload);
-    }
-    else if (interfaceType)
-    {
-        if (0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_LL) ||
-                0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_DEFAULT))
+        if (includeEp)
         {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
-                            discPayload->sid, (int)sidLength, SQLITE_STATIC));
+            OCEndpointPayload **tmp = &resourcePayload->eps;
+            while (*tmp)
+            {
+                tmp = &(*tmp)->next;
+            }
+            *tmp = epPayload;
         }
         else
         {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "INNER JOIN RD_LINK_IF ON RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di AND RD_LINK_IF.if LIKE @interfaceType";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
-                            discPayload->sid, (int)sidLength, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
-                            interfaceType, (int)interfaceTypeLength, SQLITE_STATIC));
+            OICFree(epPayload);
         }
-        result = ResourcePayloadCreate(stmt, devAddr, discPayload);
+        epPayload = NULL;
     }
 
 exit:
-    sqlite3_finalize(stmt);
+    OICFree(epPayload);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
     return result;
 }
 
-static OCStackResult deleteResources(const char *deviceId, const int64_t *instanceIds, uint16_t nInstanceIds)
+/* stmt is the RD_STMT_LINKS statement positioned on a row */
+static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, const OCDevAddr *devAddr,
+        const CAEndpoint_t *networkInfo, size_t infoSize, OCDiscoveryPayload *discPayload)
 {
-    char *delResource = NULL;
-    sqlite3_stmt *stmt = NULL;
-
     OCStackResult result;
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
+    OCResourcePayload *resourcePayload = NULL;
 
-    if (!instanceIds || !nInstanceIds)
-    {
-        static const char delDevice[] = "DELETE FROM RD_DEVICE_LIST WHERE di=@deviceId";
-        int delDeviceSize = (int)sizeof(delDevice);
+    resourcePayload = (OCResourcePayload *)OICCalloc(1, sizeof(OCResourcePayload));
+    VERIFY_NON_NULL(resourcePayload);
+
+    sqlite3_int64 id = sqlite3_column_int64(stmt, ins_index);
+    const unsigned char *uri = sqlite3_column_text(stmt, href_index);
+    const unsigned char *rel = sqlite3_column_text(stmt, rel_index);
+    const unsigned char *anchor = sqlite3_column_text(stmt, anchor_index);
+    sqlite3_int64 bitmap = sqlite3_column_int64(stmt, bm_index);
+    sqlite3_int64 deviceId = sqlite3_column_int64(stmt, d_index);
+    OIC_LOG_V(DEBUG, TAG, " %s %" PRId64, uri, (int64_t) deviceId);
 
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, delDevice, delDeviceSize, &stmt, NULL));
-        VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
-                                        deviceId, (int)strlen(deviceId), SQLITE_STATIC));
+    resourcePayload->uri = OICStrdup((char *)uri);
+    VERIFY_NON_NULL(resourcePayload->uri)
+    if (rel)
+    {
+        resourcePayload->rel = OICStrdup((char *)rel);
+        VERIFY_NON_NULL(resourcePayload->rel);
     }
-    else
+    if (anchor)
     {
-        static const char pre[] = "DELETE FROM RD_DEVICE_LINK_LIST "
-            "WHERE ins IN ("
-            "SELECT RD_DEVICE_LINK_LIST.ins FROM RD_DEVICE_LINK_LIST "
-            "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-            "WHERE RD_DEVICE_LINK_LIST.ins IN (";
-        size_t inLen = nInstanceIds + (nInstanceIds - 1);
-        static const char post[] = "))";
-        size_t delResourceSize = sizeof(pre) + inLen + (sizeof(post) - 1);
-        delResource = OICCalloc(delResourceSize, 1);
-        VERIFY_NON_NULL(delResource);
-        OICStrcat(delResource, delResourceSize, pre);
-        OICStrcat(delResource, delResourceSize, "?");
-        for (uint16_t i = 1; i < nInstanceIds; ++i)
-        {
-            OICStrcat(delResource, delResourceSize, ",?");
-        }
-        OICStrcat(delResource, delResourceSize, post);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, delResource, (int)delResourceSize,
-                        &stmt, NULL));
-        for (uint16_t i = 0; i < nInstanceIds; ++i)
-        {
-            VERIFY_SQLITE(sqlite3_bind_int64(stmt, 1 + i, instanceIds[i]));
-        }
+        resourcePayload->anchor = OICStrdup((char *)anchor);
+        VERIFY_NON_NULL(resourcePayload->anchor);
     }
 
-    int res = sqlite3_step(stmt);
-    if (SQLITE_DONE != res)
+    result = AppendLinkValues(RD_STMT_RT, id, rt_value_index, &resourcePayload->types);
+    if (OC_STACK_OK != result)
     {
-        result = OC_STACK_ERROR;
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
-
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
-    result = OC_STACK_OK;
-
-exit:
-    OICFree(delResource);
-    sqlite3_finalize(stmt);
+    result = AppendLinkValues(RD_STMT_IF, id, if_value_index, &resourcePayload->interfaces);
     if (OC_STACK_OK != result)
     {
-        sqlite3_exec(gRDDB, "ROLLBACK", NULL, NULL, NULL);
+        goto exit;
     }
-    return result;
-}
-
-static OCStackResult DeleteExpiredResources()
-{
-    sqlite3_stmt *stmt = NULL;
-    OCStackResult result;
 
-    uint64_t ttl = OICGetCurrentTime(TIME_IN_US);
-    static const char lapsed[] = "SELECT di FROM RD_DEVICE_LIST WHERE ttl < @ttl";
-    int lapsedSize = (int)sizeof(lapsed);
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, lapsed, lapsedSize, &stmt, NULL));
-    VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@ttl"),
-                                     (int64_t)ttl));
+    resourcePayload->bitmap = (uint8_t)(bitmap & (OC_OBSERVABLE | OC_DISCOVERABLE));
 
-    while (SQLITE_ROW == sqlite3_step(stmt))
+    result = AppendLinkEndpoints(id, devAddr, networkInfo, infoSize, resourcePayload);
+    if (OC_STACK_OK != result)
     {
-        const unsigned char *di = sqlite3_column_text(stmt, 0);
-        if (SQLITE_OK != deleteResources((const char *)di, NULL, 0))
-        {
-            OIC_LOG_V(WARNING, TAG, "Error in deleteResources, Error Message: %s", sqlite3_errmsg(gRDDB));
-        }
-        else
-        {
-            OIC_LOG_V(INFO, TAG, "Deleted resources with di=%s", di);
-        }
+        goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
+
+    OCDiscoveryPayloadAddNewResource(discPayload, resourcePayload);
+    resourcePayload = NULL;
     result = OC_STACK_OK;
 
- exit:
-    sqlite3_finalize(stmt);
+exit:
+    OCDiscoveryResourceDestroy(resourcePayload);
     return result;
 }
 
@@ -518,6 +613,9 @@ OCStackResult OC_CALL OCRDDatabaseDiscoveryPayloadCreateWithEp(const char *inter
     OCDiscoveryPayload *head = NULL;
     OCDiscoveryPayload **tail = &head;
     sqlite3_stmt *stmt = NULL;
+    CAEndpoint_t *networkInfo = NULL;
+    size_t infoSize = 0;
+    bool locked = false;
 
     if (*payload)
     {
@@ -530,48 +628,90 @@ OCStackResult OC_CALL OCRDDatabaseDiscoveryPayloadCreateWithEp(const char *inter
         goto exit;
     }
 
-    if (SQLITE_OK == sqlite3_config(SQLITE_CONFIG_LOG, errorCallback))
+    if (!interfaceType && !resourceType)
     {
-        OIC_LOG_V(INFO, TAG, "SQLite debugging log initialized.");
+        result = OC_STACK_NO_RESOURCE;
+        goto exit;
+    }
+    size_t resourceTypeLength = resourceType ? strlen(resourceType) : 0;
+    size_t interfaceTypeLength = interfaceType ? strlen(interfaceType) : 0;
+    if ((resourceTypeLength > INT_MAX) || (interfaceTypeLength > INT_MAX))
+    {
+        result = OC_STACK_NO_RESOURCE;
+        goto exit;
+    }
+    if (interfaceType && (0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_LL) ||
+                          0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_DEFAULT)))
+    {
+        /* Every link implements these */
+        interfaceType = NULL;
+    }
+
+    if (endpoint)
+    {
+        CAResult_t caResult = CAGetNetworkInformation(&networkInfo, &infoSize);
+        if (CA_STATUS_FAILED == caResult)
+        {
+            OIC_LOG(WARNING, TAG, "CAGetNetworkInformation has error on parsing network infomation");
+        }
     }
-    sqlite3_open_v2(OCRDDatabaseGetStorageFilename(), &gRDDB, SQLITE_OPEN_READWRITE, NULL);
-    if (!gRDDB)
+
+    if (!LockDiscoveryDatabase())
     {
         result = OC_STACK_ERROR;
         goto exit;
     }
+    locked = true;
+    result = OpenDiscoveryDatabase();
+    if (OC_STACK_OK != result)
+    {
+        goto exit;
+    }
 
-    DeleteExpiredResources();
+    stmt = gRDStatements[RD_STMT_LINKS];
+    VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@ttl"),
+                                     (int64_t)OICGetCurrentTime(TIME_IN_US)));
+    if (resourceType)
+    {
+        VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
+                        resourceType, (int)resourceTypeLength, SQLITE_STATIC));
+    }
+    if (interfaceType)
+    {
+        VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
+                        interfaceType, (int)interfaceTypeLength, SQLITE_STATIC));
+    }
 
     const char *serverID = OCGetServerInstanceIDString();
-    const char input[] = "SELECT di, external_host FROM RD_DEVICE_LIST";
-    int inputSize = (int)sizeof(input);
-    const uint8_t di_index = 0;
-    const uint8_t external_host_index = 1;
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
+    OCDiscoveryPayload *current = NULL;
+    sqlite3_int64 currentDeviceId = 0;
     while (SQLITE_ROW == sqlite3_step(stmt))
     {
         const unsigned char *di = sqlite3_column_text(stmt, di_index);
-        if (0 == strcmp((const char *)di, serverID))
+        if (!di || (serverID && 0 == strcmp((const char *)di, serverID)))
         {
             continue;
         }
-        sqlite3_int64 externalHost = sqlite3_column_int64(stmt, external_host_index);
-        *tail = OCDiscoveryPayloadCreate();
-        result = OC_STACK_INTERNAL_SERVER_ERROR;
-        VERIFY_NON_NULL(*tail);
-        (*tail)->sid = (char *)OICCalloc(1, UUID_STRING_SIZE);
-        VERIFY_NON_NULL((*tail)->sid);
-        memcpy((*tail)->sid, di, UUID_STRING_SIZE);
-        result = CheckResources(interfaceType, resourceType, externalHost ? NULL : endpoint, *tail);
-        if (OC_STACK_OK == result)
+        sqlite3_int64 deviceId = sqlite3_column_int64(stmt, d_index);
+        if (!current || deviceId != currentDeviceId)
         {
-            tail = &(*tail)->next;
+            /* Rows are ordered by device, so this is the first link of a new device */
+            *tail = OCDiscoveryPayloadCreate();
+            result = OC_STACK_INTERNAL_SERVER_ERROR;
+            VERIFY_NON_NULL(*tail);
+            current = *tail;
+            tail = &current->next;
+            currentDeviceId = deviceId;
+            current->sid = (char *)OICCalloc(1, UUID_STRING_SIZE);
+            VERIFY_NON_NULL(current->sid);
+            OICStrcpy(current->sid, UUID_STRING_SIZE, (const char *)di);
         }
-        else
+        sqlite3_int64 externalHost = sqlite3_column_int64(stmt, external_host_index);
+        result = ResourcePayloadCreate(stmt, externalHost ? NULL : endpoint,
+                                       networkInfo, infoSize, current);
+        if (OC_STACK_OK != result)
         {
-            OCPayloadDestroy((OCPayload *) *tail);
-            *tail = NULL;
+            goto exit;
         }
     }
     result = head ? OC_STACK_OK : OC_STACK_NO_RESOURCE;
@@ -583,8 +723,16 @@ exit:
         head = NULL;
     }
     *payload = head;
-    sqlite3_finalize(stmt);
-    sqlite3_close(gRDDB);
+    if (stmt)
+    {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+    if (locked)
+    {
+        UnlockDiscoveryDatabase();
+    }
+    OICFree(networkInfo);
     return result;
 }
 #endif
@@ -30,6 +30,7 @@ extern "C"
     #include "oic_time.h"
     #include "ocresourcehandler.h"
     #include "occollection.h"
+    #include "ocpayloadcbor.h"
     #include "mbedtls/ssl_ciphersuites.h"
     #include "octypes.h"
 #if defined (WITH_POSIX) && (defined (__WITH_DTLS__) || defined(__WITH_TLS__))
@@ -55,6 +56,10 @@ extern "C"
 
 #include <iostream>
 #include <stdint.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "gtest_helper.h"
 
@@ -1996,6 +2001,425 @@ TEST(StackBind, BindContainedResourceGood)
 }
 
 
+TEST(StackBind, SetCollectionBatchConcurrency)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting SetCollectionBatchConcurrency test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle containerHandle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&containerHandle,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/kitchen",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetCollectionBatchConcurrency(NULL, 100));
+    EXPECT_EQ(OC_STACK_NO_RESOURCE,
+              OCSetCollectionBatchConcurrency((OCResourceHandle) &killSwitch, 100));
+    EXPECT_EQ(OC_STACK_OK, OCSetCollectionBatchConcurrency(containerHandle, 100));
+    EXPECT_EQ(OC_STACK_OK, OCSetCollectionBatchConcurrency(containerHandle, 0));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static OCEntityHandlerResult BatchChildRespondingHandler(OCEntityHandlerFlag flag,
+        OCEntityHandlerRequest *request, void *ctx)
+{
+    OC_UNUSED(flag);
+    OC_UNUSED(ctx);
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetUri(payload, "/a/led");
+    OCRepPayloadSetPropBool(payload, "state", true);
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = request->requestHandle;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *) payload;
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+    OCRepPayloadDestroy(payload);
+    return OC_EH_OK;
+}
+
+static OCEntityHandlerResult BatchChildSlowHandler(OCEntityHandlerFlag flag,
+        OCEntityHandlerRequest *request, void *ctx)
+{
+    OC_UNUSED(flag);
+    if (ctx)
+    {
+        *(OCRequestHandle *) ctx = request->requestHandle;
+    }
+    return OC_EH_SLOW;
+}
+
+static OCStackApplicationResult BatchPartialResponse(void *ctx, OCDoHandle handle,
+        OCClientResponse *response)
+{
+    OC_UNUSED(ctx);
+    OC_UNUSED(handle);
+    EXPECT_EQ(OC_STACK_OK, response->result);
+    EXPECT_TRUE(NULL != response->payload);
+    if (NULL != response->payload)
+    {
+        EXPECT_EQ(PAYLOAD_TYPE_REPRESENTATION, response->payload->type);
+        // Only the resource which responded before the deadline is included
+        EXPECT_TRUE(NULL == ((OCRepPayload *) response->payload)->next);
+    }
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+TEST(StackBind, CollectionBatchConcurrentDeadline)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting CollectionBatchConcurrentDeadline test");
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_CLIENT_SERVER));
+
+    OCResourceHandle containerHandle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&containerHandle, "core.room", "oic.if.baseline",
+            "/a/room", NULL, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceInterfaceToResource(containerHandle,
+            OC_RSRVD_INTERFACE_BATCH));
+
+    OCResourceHandle handle0;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle0, "core.led", "oic.if.baseline", "/a/led",
+            BatchChildRespondingHandler, NULL, OC_DISCOVERABLE));
+    OCResourceHandle handle1;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1, "core.fan", "oic.if.baseline", "/a/fan",
+            BatchChildSlowHandler, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCBindResource(containerHandle, handle0));
+    EXPECT_EQ(OC_STACK_OK, OCBindResource(containerHandle, handle1));
+    EXPECT_EQ(OC_STACK_OK, OCSetCollectionBatchConcurrency(containerHandle, 100));
+
+    itst::Callback batchCB(&BatchPartialResponse);
+    EXPECT_EQ(OC_STACK_OK, OCDoResource(NULL, OC_REST_GET, "127.0.0.1:5683/a/room?if=oic.if.b",
+            NULL, 0, CT_DEFAULT, OC_HIGH_QOS, batchCB, NULL, 0));
+    EXPECT_EQ(OC_STACK_OK, batchCB.Wait(10));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackBind, CollectionBatchConcurrentLateResponse)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting CollectionBatchConcurrentLateResponse test");
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_CLIENT_SERVER));
+
+    OCResourceHandle containerHandle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&containerHandle, "core.room", "oic.if.baseline",
+            "/a/room", NULL, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceInterfaceToResource(containerHandle,
+            OC_RSRVD_INTERFACE_BATCH));
+
+    OCRequestHandle slowRequest = NULL;
+    OCResourceHandle handle0;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle0, "core.led", "oic.if.baseline", "/a/led",
+            BatchChildRespondingHandler, NULL, OC_DISCOVERABLE));
+    OCResourceHandle handle1;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1, "core.fan", "oic.if.baseline", "/a/fan",
+            BatchChildSlowHandler, &slowRequest, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCBindResource(containerHandle, handle0));
+    EXPECT_EQ(OC_STACK_OK, OCBindResource(containerHandle, handle1));
+    EXPECT_EQ(OC_STACK_OK, OCSetCollectionBatchConcurrency(containerHandle, 100));
+
+    itst::Callback batchCB(&BatchPartialResponse);
+    EXPECT_EQ(OC_STACK_OK, OCDoResource(NULL, OC_REST_GET, "127.0.0.1:5683/a/room?if=oic.if.b",
+            NULL, 0, CT_DEFAULT, OC_HIGH_QOS, batchCB, NULL, 0));
+    EXPECT_EQ(OC_STACK_OK, batchCB.Wait(10));
+    ASSERT_TRUE(NULL != slowRequest);
+
+    // The slow resource was answered as failed at the deadline and the batch request freed
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetUri(payload, "/a/fan");
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = slowRequest;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *) payload;
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDoResponse(&response));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+
+    // Neither is the handle used after the stack stopped
+    EXPECT_NE(OC_STACK_OK, OCDoResponse(&response));
+    OCRepPayloadDestroy(payload);
+}
+
+typedef struct
+{
+    const char *uri;
+    int delayMs;
+    OCRequestHandle requestHandle;
+} BatchChildContext;
+
+static OCEntityHandlerResult BatchChildDelayedHandler(OCEntityHandlerFlag flag,
+        OCEntityHandlerRequest *request, void *ctx)
+{
+    OC_UNUSED(flag);
+    BatchChildContext *child = (BatchChildContext *) ctx;
+    child->requestHandle = request->requestHandle;
+    std::this_thread::sleep_for(std::chrono::milliseconds(child->delayMs));
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetUri(payload, child->uri);
+    OCRepPayloadSetPropString(payload, "name", child->uri);
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = request->requestHandle;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *) payload;
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+    OCRepPayloadDestroy(payload);
+    return OC_EH_OK;
+}
+
+static OCStackApplicationResult BatchFullResponse(void *ctx, OCDoHandle handle,
+        OCClientResponse *response)
+{
+    OC_UNUSED(ctx);
+    OC_UNUSED(handle);
+    EXPECT_EQ(OC_STACK_OK, response->result);
+    EXPECT_TRUE(NULL != response->payload);
+    if (NULL != response->payload)
+    {
+        EXPECT_EQ(PAYLOAD_TYPE_REPRESENTATION, response->payload->type);
+
+        // Every child is included, in the order they are bound to the collection
+        const char *expected[] = { "/a/led", "/a/fan", "/a/light" };
+        OCRepPayload *rep = (OCRepPayload *) response->payload;
+        size_t count = 0;
+        for (; rep; rep = rep->next, ++count)
+        {
+            if (count >= sizeof(expected) / sizeof(expected[0]) || NULL == rep->uri)
+            {
+                ADD_FAILURE() << "unexpected batch entry " << count;
+                break;
+            }
+            EXPECT_STREQ(expected[count], rep->uri);
+
+            OCRepPayload *representation = NULL;
+            EXPECT_TRUE(OCRepPayloadGetPropObject(rep, OC_RSRVD_REPRESENTATION,
+                    &representation));
+            char *name = NULL;
+            EXPECT_TRUE(OCRepPayloadGetPropString(representation, "name", &name));
+            if (name)
+            {
+                EXPECT_STREQ(expected[count], name);
+            }
+            OICFree(name);
+            OCRepPayloadDestroy(representation);
+        }
+        EXPECT_EQ(sizeof(expected) / sizeof(expected[0]), count);
+    }
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+TEST(StackBind, CollectionBatchConcurrentAllRespond)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting CollectionBatchConcurrentAllRespond test");
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_CLIENT_SERVER));
+
+    OCResourceHandle containerHandle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&containerHandle, "core.room", "oic.if.baseline",
+            "/a/room", NULL, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceInterfaceToResource(containerHandle,
+            OC_RSRVD_INTERFACE_BATCH));
+
+    // The children complete in the reverse of the order they are bound in
+    BatchChildContext children[] = {
+        { "/a/led", 300, NULL },
+        { "/a/fan", 150, NULL },
+        { "/a/light", 0, NULL }
+    };
+    const char *types[] = { "core.led", "core.fan", "core.light" };
+    for (size_t i = 0; i < sizeof(children) / sizeof(children[0]); ++i)
+    {
+        OCResourceHandle handle;
+        EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, types[i], "oic.if.baseline",
+                children[i].uri, BatchChildDelayedHandler, &children[i], OC_DISCOVERABLE));
+        EXPECT_EQ(OC_STACK_OK, OCBindResource(containerHandle, handle));
+    }
+    EXPECT_EQ(OC_STACK_OK, OCSetCollectionBatchConcurrency(containerHandle, 5000));
+
+    itst::Callback batchCB(&BatchFullResponse);
+    EXPECT_EQ(OC_STACK_OK, OCDoResource(NULL, OC_REST_GET, "127.0.0.1:5683/a/room?if=oic.if.b",
+            NULL, 0, CT_DEFAULT, OC_HIGH_QOS, batchCB, NULL, 0));
+    EXPECT_EQ(OC_STACK_OK, batchCB.Wait(10));
+
+    // A handle which was already answered is not accepted a second time
+    ASSERT_TRUE(NULL != children[0].requestHandle);
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetUri(payload, children[0].uri);
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = children[0].requestHandle;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *) payload;
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCDoResponse(&response));
+    OCRepPayloadDestroy(payload);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+#define STREAMED_DATA_LENGTH 4000
+
+static OCEntityHandlerResult LargeResponseHandler(OCEntityHandlerFlag flag,
+        OCEntityHandlerRequest *request, void *ctx)
+{
+    OC_UNUSED(flag);
+    OC_UNUSED(ctx);
+    std::string data(STREAMED_DATA_LENGTH, 'x');
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetPropString(payload, "data", data.c_str());
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = request->requestHandle;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *) payload;
+    EXPECT_EQ(OC_STACK_OK, OCDoResponse(&response));
+    OCRepPayloadDestroy(payload);
+    return OC_EH_OK;
+}
+
+typedef struct
+{
+    std::vector<uint8_t> data;
+    std::vector<size_t> offsets;
+    size_t lastFlags;
+    bool lastFlagOnFinalChunk;
+    bool cancelOnFirstChunk;
+    bool completed;
+    OCStackResult result;
+} StreamedResponse;
+
+static OCStackApplicationResult StreamedChunkHandler(void *ctx, OCDoHandle handle,
+        OCClientResponse *response, const uint8_t *chunk, size_t chunkSize, size_t offset,
+        bool isLast)
+{
+    OC_UNUSED(handle);
+    StreamedResponse *streamed = (StreamedResponse *) ctx;
+    EXPECT_EQ(OC_STACK_OK, response->result);
+
+    // Blocks come in order and without gaps
+    EXPECT_EQ(streamed->data.size(), offset);
+    streamed->offsets.push_back(offset);
+    streamed->data.insert(streamed->data.end(), chunk, chunk + chunkSize);
+    if (isLast)
+    {
+        streamed->lastFlags++;
+    }
+    streamed->lastFlagOnFinalChunk = isLast;
+    return streamed->cancelOnFirstChunk ? OC_STACK_DELETE_TRANSACTION : OC_STACK_KEEP_TRANSACTION;
+}
+
+static OCStackApplicationResult StreamedFinalHandler(void *ctx, OCDoHandle handle,
+        OCClientResponse *response)
+{
+    OC_UNUSED(handle);
+    StreamedResponse *streamed = (StreamedResponse *) ctx;
+    // The blocks have already been passed to the chunk handler
+    EXPECT_TRUE(NULL == response->payload);
+    streamed->result = response->result;
+    streamed->completed = true;
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+static void ProcessStreamedResponse(StreamedResponse *streamed, long waitTime)
+{
+    uint64_t startTime = OICGetCurrentTime(TIME_IN_MS);
+    while (!streamed->completed && (OICGetCurrentTime(TIME_IN_MS) - startTime) < (uint64_t) waitTime)
+    {
+        OCProcess();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+TEST(StackStreaming, StreamedResponseIsDeliveredInOrder)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting StreamedResponseIsDeliveredInOrder test");
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_CLIENT_SERVER));
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.blob", "oic.if.baseline", "/a/blob",
+            LargeResponseHandler, NULL, OC_DISCOVERABLE));
+
+    StreamedResponse streamed;
+    streamed.lastFlags = 0;
+    streamed.lastFlagOnFinalChunk = false;
+    streamed.cancelOnFirstChunk = false;
+    streamed.completed = false;
+    streamed.result = OC_STACK_ERROR;
+    OCCallbackData cbData;
+    cbData.cb = StreamedFinalHandler;
+    cbData.context = &streamed;
+    cbData.cd = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCDoStreamingRequest(NULL, OC_REST_GET, "127.0.0.1:5683/a/blob",
+            NULL, NULL, CT_DEFAULT, OC_HIGH_QOS, &cbData, StreamedChunkHandler, NULL, 0));
+    ProcessStreamedResponse(&streamed, 10000);
+
+    EXPECT_TRUE(streamed.completed);
+    EXPECT_EQ(OC_STACK_OK, streamed.result);
+    EXPECT_LT(2u, streamed.offsets.size());
+    for (size_t i = 1; i < streamed.offsets.size(); i++)
+    {
+        EXPECT_LT(streamed.offsets[i - 1], streamed.offsets[i]);
+    }
+    EXPECT_EQ(1u, streamed.lastFlags);
+    EXPECT_TRUE(streamed.lastFlagOnFinalChunk);
+
+    // Put together, the blocks are the complete payload
+    OCPayload *payload = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParsePayload(&payload, OC_FORMAT_CBOR, PAYLOAD_TYPE_REPRESENTATION,
+            streamed.data.data(), streamed.data.size()));
+    char *data = NULL;
+    EXPECT_TRUE(OCRepPayloadGetPropString((OCRepPayload *) payload, "data", &data));
+    EXPECT_EQ(std::string(STREAMED_DATA_LENGTH, 'x'), std::string(data ? data : ""));
+    OICFree(data);
+    OCPayloadDestroy(payload);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackStreaming, StreamedResponseCanBeCancelled)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting StreamedResponseCanBeCancelled test");
+    EXPECT_EQ(OC_STACK_OK, OCInit("127.0.0.1", 5683, OC_CLIENT_SERVER));
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.blob", "oic.if.baseline", "/a/blob",
+            LargeResponseHandler, NULL, OC_DISCOVERABLE));
+
+    StreamedResponse streamed;
+    streamed.lastFlags = 0;
+    streamed.lastFlagOnFinalChunk = false;
+    streamed.cancelOnFirstChunk = true;
+    streamed.completed = false;
+    streamed.result = OC_STACK_ERROR;
+    OCCallbackData cbData;
+    cbData.cb = StreamedFinalHandler;
+    cbData.context = &streamed;
+    cbData.cd = NULL;
+    OCDoHandle requestHandle = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCDoStreamingRequest(&requestHandle, OC_REST_GET,
+            "127.0.0.1:5683/a/blob", NULL, NULL, CT_DEFAULT, OC_HIGH_QOS, &cbData,
+            StreamedChunkHandler, NULL, 0));
+
+    // Neither further blocks nor the final response are delivered once cancelled
+    ProcessStreamedResponse(&streamed, 3000);
+    EXPECT_FALSE(streamed.completed);
+    EXPECT_EQ(1u, streamed.offsets.size());
+    EXPECT_EQ(0u, streamed.lastFlags);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(StackBind, BindEntityHandlerBad)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -2736,6 +3160,114 @@ static OCStackApplicationResult DiscoverUnicastErrorResponse(void *ctx, OCDoHand
     return OC_STACK_DELETE_TRANSACTION;
 }
 
+static OCResourcePayload *FindDiscoveredResource(OCClientResponse *response, const char *uri)
+{
+    EXPECT_EQ(OC_STACK_OK, response->result);
+    EXPECT_TRUE(NULL != response->payload);
+    if (NULL == response->payload)
+    {
+        return NULL;
+    }
+    EXPECT_EQ(PAYLOAD_TYPE_DISCOVERY, response->payload->type);
+
+    OCResourcePayload *resource = ((OCDiscoveryPayload *)response->payload)->resources;
+    for (; resource; resource = resource->next)
+    {
+        if (0 == strcmp(uri, resource->uri))
+        {
+            break;
+        }
+    }
+    return resource;
+}
+
+static bool HasResourceType(OCResourcePayload *resource, const char *type)
+{
+    for (OCStringLL *rt = resource ? resource->types : NULL; rt; rt = rt->next)
+    {
+        if (0 == strcmp(type, rt->value))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static OCStackApplicationResult DiscoverAllBeforeCreateResponse(void *ctx, OCDoHandle handle,
+    OCClientResponse *response)
+{
+    OC_UNUSED(ctx);
+    OC_UNUSED(handle);
+    EXPECT_TRUE(NULL != FindDiscoveredResource(response, "/a/light"));
+    EXPECT_TRUE(NULL == FindDiscoveredResource(response, "/a/fan"));
+
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+static OCStackApplicationResult DiscoverAllAfterCreateResponse(void *ctx, OCDoHandle handle,
+    OCClientResponse *response)
+{
+    OC_UNUSED(ctx);
+    OC_UNUSED(handle);
+    EXPECT_TRUE(NULL != FindDiscoveredResource(response, "/a/light"));
+    OCResourcePayload *fan = FindDiscoveredResource(response, "/a/fan");
+    EXPECT_TRUE(NULL != fan);
+    EXPECT_TRUE(HasResourceType(fan, "core.fan"));
+
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+static OCStackApplicationResult DiscoverLightTypeBoundResponse(void *ctx, OCDoHandle handle,
+    OCClientResponse *response)
+{
+    OC_UNUSED(ctx);
+    OC_UNUSED(handle);
+    OCResourcePayload *light = FindDiscoveredResource(response, "/a/light");
+    EXPECT_TRUE(NULL != light);
+    EXPECT_TRUE(HasResourceType(light, "core.light"));
+    EXPECT_TRUE(HasResourceType(light, "core.brightlight"));
+
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+TEST_F(OCDiscoverTests, DiscoverResourceCreatedAfterDiscovery)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+
+    OCResourceHandle handles[2];
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handles[0], "core.light", "oic.if.baseline",
+        "/a/light", entityHandler, NULL, OC_DISCOVERABLE));
+
+    // The second responses are served from the discovery cache
+    for (int i = 0; i < 2; ++i)
+    {
+        itst::Callback discoverAllCB(&DiscoverAllBeforeCreateResponse);
+        EXPECT_EQ(OC_STACK_OK, OCDoResource(NULL, OC_REST_DISCOVER, "/oic/res", NULL, 0,
+            CT_DEFAULT, OC_HIGH_QOS, discoverAllCB, NULL, 0));
+        EXPECT_EQ(OC_STACK_OK, discoverAllCB.Wait(100));
+
+        itst::Callback discoverRTCB(&DiscoverResourceTypeResponse);
+        EXPECT_EQ(OC_STACK_OK, OCDoResource(NULL, OC_REST_DISCOVER, "/oic/res?rt=core.light",
+            NULL, 0, CT_DEFAULT, OC_HIGH_QOS, discoverRTCB, NULL, 0));
+        EXPECT_EQ(OC_STACK_OK, discoverRTCB.Wait(100));
+    }
+
+    // Creating a resource invalidates the cached unfiltered response
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handles[1], "core.fan", "oic.if.baseline",
+        "/a/fan", entityHandler, NULL, OC_DISCOVERABLE));
+    itst::Callback discoverCreatedCB(&DiscoverAllAfterCreateResponse);
+    EXPECT_EQ(OC_STACK_OK, OCDoResource(NULL, OC_REST_DISCOVER, "/oic/res", NULL, 0,
+        CT_DEFAULT, OC_HIGH_QOS, discoverCreatedCB, NULL, 0));
+    EXPECT_EQ(OC_STACK_OK, discoverCreatedCB.Wait(100));
+
+    // Binding a type invalidates the cached filtered response
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(handles[0], "core.brightlight"));
+    itst::Callback discoverBoundCB(&DiscoverLightTypeBoundResponse);
+    EXPECT_EQ(OC_STACK_OK, OCDoResource(NULL, OC_REST_DISCOVER, "/oic/res?rt=core.light",
+        NULL, 0, CT_DEFAULT, OC_HIGH_QOS, discoverBoundCB, NULL, 0));
+    EXPECT_EQ(OC_STACK_OK, discoverBoundCB.Wait(100));
+}
+
 // Disabled to unblock other developers untill IOT-1807 is done.
 TEST_F(OCDiscoverTests, DISABLED_DiscoverResourceWithValidQueries)
 {
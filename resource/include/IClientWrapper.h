@@ -79,6 +79,15 @@ namespace OC
                         OCConnectivityType connectivityType,
                         GetCallback& callback, QualityOfService QoS)=0;
 
+        virtual OCStackResult GetResourceRepresentationStreamed(
+                        const OCDevAddr& devAddr,
+                        const std::string& uri,
+                        const QueryParamsMap& queryParams,
+                        const HeaderOptions& headerOptions,
+                        OCConnectivityType connectivityType,
+                        GetChunkCallback& chunkCallback,
+                        GetCallback& callback, QualityOfService QoS)=0;
+
         virtual OCStackResult PutResourceRepresentation(
                         const OCDevAddr& devAddr,
                         const std::string& uri,
@@ -38,7 +38,10 @@ namespace OC
         struct GetContext
         {
             GetCallback callback;
+            GetChunkCallback chunkCallback;
             GetContext(GetCallback cb) : callback(cb){}
+            GetContext(GetCallback cb, GetChunkCallback chunkCb)
+                : callback(cb), chunkCallback(chunkCb){}
         };
 
         struct SetContext
@@ -161,6 +164,14 @@ namespace OC
             OCConnectivityType connectivityType,
             GetCallback& callback, QualityOfService QoS);
 
+        virtual OCStackResult GetResourceRepresentationStreamed(
+            const OCDevAddr& devAddr,
+            const std::string& uri,
+            const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
+            OCConnectivityType connectivityType,
+            GetChunkCallback& chunkCallback,
+            GetCallback& callback, QualityOfService QoS);
+
         virtual OCStackResult PutResourceRepresentation(
             const OCDevAddr& devAddr,
             const std::string& uri,
@@ -376,6 +376,8 @@ namespace OC
     typedef std::function<void(const HeaderOptions&,
                                 const OCRepresentation&, const int)> GetCallback;
 
+    typedef std::function<void(const std::vector<uint8_t>&, size_t, bool)> GetChunkCallback;
+
     typedef std::function<void(const HeaderOptions&,
                                 const OCRepresentation&, const int)> PostCallback;
 
@@ -170,6 +170,26 @@ namespace OC
         OCStackResult get(const QueryParamsMap& queryParametersMap, GetCallback attributeHandler,
                           QualityOfService QoS);
 
+        /**
+        * Function to get the representation of a resource block by block.
+        * If the server transfers the response block-wise, the blocks are not reassembled;
+        * chunkHandler is called for every block in order with the raw encoded bytes, their
+        * offset in the whole payload and whether it is the last block. The blocks are passed
+        * on the stack's processing thread, so the handler should return quickly.
+        * @param queryParametersMap map which can have the query parameter name and value
+        * @param chunkHandler handles each received block
+        * @param attributeHandler handles callback
+        *        The callback function will be invoked once the whole response has been
+        *        received, with the result of this Get operation. The representation is empty
+        *        if the response was streamed, otherwise it holds the whole response.
+        * @param QoS the quality of communication
+        * @return Returns  ::OC_STACK_OK on success, some other value upon failure.
+        * @note OCStackResult is defined in ocstack.h.
+        */
+        OCStackResult getStreamed(const QueryParamsMap& queryParametersMap,
+                                  GetChunkCallback chunkHandler, GetCallback attributeHandler,
+                                  QualityOfService QoS);
+
         /**
         * Function to get the attributes of a resource.
         *
@@ -94,6 +94,16 @@ namespace OC
             GetCallback& /*callback*/, QualityOfService /*QoS*/)
             {return OC_STACK_NOTIMPL;}
 
+        virtual OCStackResult GetResourceRepresentationStreamed(
+            const OCDevAddr& /*devAddr*/,
+            const std::string& /*uri*/,
+            const QueryParamsMap& /*queryParams*/,
+            const HeaderOptions& /*headerOptions*/,
+            OCConnectivityType /*connectivityType*/,
+            GetChunkCallback& /*chunkCallback*/,
+            GetCallback& /*callback*/, QualityOfService /*QoS*/)
+            {return OC_STACK_NOTIMPL;}
+
         virtual OCStackResult PutResourceRepresentation(
             const OCDevAddr& /*devAddr*/,
             const std::string& /*uri*/,
@@ -947,6 +947,83 @@ namespace OC
         return result;
     }
 
+    OCStackApplicationResult getResourceChunkCallback(void* ctx,
+                                                      OCDoHandle /*handle*/,
+        OCClientResponse* /*clientResponse*/, const uint8_t* chunk, size_t chunkSize,
+        size_t offset, bool isLast)
+    {
+        ClientCallbackContext::GetContext* context =
+            static_cast<ClientCallbackContext::GetContext*>(ctx);
+
+        // blocks are passed synchronously so that the application sees them in order
+        std::vector<uint8_t> data;
+        if (chunk && chunkSize)
+        {
+            data.assign(chunk, chunk + chunkSize);
+        }
+
+        try
+        {
+            context->chunkCallback(data, offset, isLast);
+        }
+        catch (std::exception& e)
+        {
+            OIC_LOG_V(ERROR, TAG, "%s: chunk callback failed: %s", __func__, e.what());
+            return OC_STACK_DELETE_TRANSACTION;
+        }
+        return OC_STACK_KEEP_TRANSACTION;
+    }
+
+    OCStackResult InProcClientWrapper::GetResourceRepresentationStreamed(
+        const OCDevAddr& devAddr,
+        const std::string& resourceUri,
+        const QueryParamsMap& queryParams, const HeaderOptions& headerOptions,
+        OCConnectivityType connectivityType,
+        GetChunkCallback& chunkCallback,
+        GetCallback& callback, QualityOfService QoS)
+    {
+        if (!callback || !chunkCallback || (headerOptions.size() > MAX_HEADER_OPTIONS))
+        {
+            return OC_STACK_INVALID_PARAM;
+        }
+
+        OCStackResult result;
+        ClientCallbackContext::GetContext* ctx =
+            new ClientCallbackContext::GetContext(callback, chunkCallback);
+
+        OCCallbackData cbdata;
+        cbdata.context = static_cast<void*>(ctx);
+        cbdata.cb      = getResourceCallback;
+        cbdata.cd      = [](void* c){delete (ClientCallbackContext::GetContext*)c;};
+
+        std::string uri = assembleSetResourceUri(resourceUri, queryParams);
+
+        auto cLock = m_csdkLock.lock();
+
+        if (cLock)
+        {
+            std::lock_guard<std::recursive_mutex> lock(*cLock);
+            OCHeaderOption options[MAX_HEADER_OPTIONS];
+
+            result = OCDoStreamingRequest(
+                                  nullptr, OC_REST_GET,
+                                  uri.c_str(),
+                                  &devAddr, nullptr,
+                                  connectivityType,
+                                  static_cast<OCQualityOfService>(QoS),
+                                  &cbdata,
+                                  getResourceChunkCallback,
+                                  assembleHeaderOptions(options, headerOptions),
+                                  (uint8_t)headerOptions.size());
+        }
+        else
+        {
+            delete ctx;
+            result = OC_STACK_ERROR;
+        }
+        return result;
+    }
+
 
     OCStackApplicationResult setResourceCallback(void* ctx,
                                                  OCDoHandle /*handle*/,
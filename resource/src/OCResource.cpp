@@ -469,6 +469,17 @@ OCStackResult OCResource::get(const QueryParamsMap& queryParametersMap,
                             attributeHandler, QoS);
 }
 
+OCStackResult OCResource::getStreamed(const QueryParamsMap& queryParametersMap,
+                                      GetChunkCallback chunkHandler,
+                                      GetCallback attributeHandler, QualityOfService QoS)
+{
+    return checked_guard(m_clientWrapper.lock(),
+                            &IClientWrapper::GetResourceRepresentationStreamed,
+                            m_devAddr, m_uri,
+                            queryParametersMap, m_headerOptions, CT_DEFAULT,
+                            chunkHandler, attributeHandler, QoS);
+}
+
 OCStackResult OCResource::get(const QueryParamsMap& queryParametersMap,
                               GetCallback attributeHandler)
 {
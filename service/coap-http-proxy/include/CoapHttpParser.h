@@ -50,6 +50,9 @@ extern "C"
 #define HTTP_OPTION_CONTENT_TYPE    "content-type"
 #define HTTP_OPTION_CONTENT_LENGTH  "content-length"
 #define HTTP_OPTION_EXPIRES         "expires"
+#define HTTP_OPTION_AGE             "age"
+#define HTTP_OPTION_VARY            "vary"
+#define HTTP_OPTION_AUTHORIZATION   "authorization"
 
 /**
  * @enum HttpResponseResult_t
@@ -141,7 +144,20 @@ OCStackResult CHPParserInitialize();
 OCStackResult CHPParserTerminate();
 
 /**
- * Function to initiate TCP session and post HTTP request. If the method returns
+ * Function to answer a GET request from the response cache. On a hit the callback is
+ * called before the function returns, on the caller's thread.
+ * @param[in]   req         Object containing HTTP request information.
+ * @param[in]   httpcb      Callback for http response.
+ * @param[in]   context     Any app specific context for request
+ * @return true if the response was served from cache, false if the request has to be
+ *         posted with CHPPostHttpRequest.
+ */
+bool CHPServeCachedResponse(const HttpRequest_t *req, CHPResponseCallback httpcb,
+                            void *context);
+
+/**
+ * Function to initiate TCP session and post HTTP request to the origin. Cacheable
+ * responses are stored for CHPServeCachedResponse. If the method returns
  * success, payload might be cached by the parser (req->payloadCached) and caller shall not free the
  * payload if the flag is set.
  * @param[in]   req         Object containing HTTP request information.
@@ -0,0 +1,76 @@
+/* ****************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ * This file contains the streaming CBOR to JSON and JSON to CBOR transcoder used by the
+ * proxy. Both directions write the output while walking the input, without building an
+ * intermediate OCRepPayload or cJSON tree.
+ */
+
+#ifndef COAP_HTTP_TRANSCODER_H_
+#define COAP_HTTP_TRANSCODER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "octypes.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Maximum nesting of maps and arrays accepted by the transcoder.
+ */
+#define CHP_TRANSCODER_MAX_DEPTH (32)
+
+/**
+ * Function to transcode a CBOR item to JSON text.
+ * Byte strings are written as base64 strings, tags are dropped, integer map keys are
+ * quoted and NaN, infinity, undefined and simple values are written as null.
+ *
+ * @param[in]   cbor              CBOR encoded data.
+ * @param[in]   cborSize          Size of the CBOR data.
+ * @param[out]  json              NUL terminated JSON text. Must be freed with OICFree.
+ * @param[out]  jsonLength        Length of the JSON text, excluding the terminator.
+ * @return ::OC_STACK_OK or appropriate error code.
+ */
+OCStackResult CHPCborToJson(const uint8_t *cbor, size_t cborSize,
+                            char **json, size_t *jsonLength);
+
+/**
+ * Function to transcode JSON text to a CBOR item.
+ * Integral numbers are encoded as CBOR integers and all other numbers as doubles, the same
+ * split CHPJsonToRepPayload makes. Maps and arrays are encoded with indefinite length.
+ *
+ * @param[in]   json              JSON text. Need not be NUL terminated.
+ * @param[in]   jsonLength        Length of the JSON text.
+ * @param[out]  cbor              CBOR encoded data. Must be freed with OICFree.
+ * @param[out]  cborSize          Size of the CBOR data.
+ * @return ::OC_STACK_OK or appropriate error code.
+ */
+OCStackResult CHPJsonToCbor(const char *json, size_t jsonLength,
+                            uint8_t **cbor, size_t *cborSize);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
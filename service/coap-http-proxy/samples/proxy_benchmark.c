@@ -0,0 +1,286 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/*
+ * Benchmark of the CoAP-HTTP proxy HTTP side. Repeated GETs are proxied through the
+ * parser to a local HTTP/1.1 stub server, once for a response the proxy must not cache
+ * and once for a response with a max-age. The stub counts the TCP connections it
+ * accepts and the requests it serves, which shows origin connection reuse and the
+ * requests answered from the response cache.
+ */
+
+#include "CoapHttpParser.h"
+#include "oic_string.h"
+
+#include "iotivity_config.h"
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#define DEFAULT_NUM_OF_REQUESTS (1000)
+#define RESPONSE_BODY "{\"rep\":{\"power\":true,\"level\":7}}"
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+static int g_numOfResponses;
+static int g_numOfConnections;
+static int g_numOfOriginRequests;
+
+static void PrintUsage()
+{
+    printf("Usage : proxy_benchmark -n <number of requests>\n");
+}
+
+static void *HandleStubConnection(void *data)
+{
+    int sock = (int)(intptr_t)data;
+    char buf[4096];
+    size_t used = 0;
+
+    for (;;)
+    {
+        ssize_t len = recv(sock, buf + used, sizeof(buf) - used - 1, 0);
+        if (len <= 0)
+        {
+            break;
+        }
+        used += len;
+        buf[used] = '\0';
+
+        // Requests carry no body, so each one ends with an empty line.
+        char *end = NULL;
+        while (NULL != (end = strstr(buf, "\r\n\r\n")))
+        {
+            const char *cacheControl = strstr(buf, "GET /cacheable") == buf ?
+                                       "max-age=60" : "no-store";
+            char response[512];
+            int responseLength = snprintf(response, sizeof(response),
+                    "HTTP/1.1 200 OK\r\n"
+                    "Content-Type: application/json\r\n"
+                    "Cache-Control: %s\r\n"
+                    "Content-Length: %zu\r\n"
+                    "\r\n%s", cacheControl, strlen(RESPONSE_BODY), RESPONSE_BODY);
+
+            pthread_mutex_lock(&g_lock);
+            g_numOfOriginRequests++;
+            pthread_mutex_unlock(&g_lock);
+
+            if (send(sock, response, responseLength, 0) != responseLength)
+            {
+                goto exit;
+            }
+
+            size_t consumed = (end + 4) - buf;
+            memmove(buf, end + 4, used - consumed + 1);
+            used -= consumed;
+        }
+
+        if (used == sizeof(buf) - 1)
+        {
+            break;
+        }
+    }
+
+exit:
+    close(sock);
+    return NULL;
+}
+
+static void *RunStubServer(void *data)
+{
+    int listenSock = (int)(intptr_t)data;
+
+    for (;;)
+    {
+        int sock = accept(listenSock, NULL, NULL);
+        if (sock < 0)
+        {
+            break;
+        }
+
+        pthread_mutex_lock(&g_lock);
+        g_numOfConnections++;
+        pthread_mutex_unlock(&g_lock);
+
+        pthread_t thread;
+        if (0 == pthread_create(&thread, NULL, HandleStubConnection, (void *)(intptr_t)sock))
+        {
+            pthread_detach(thread);
+        }
+        else
+        {
+            close(sock);
+        }
+    }
+    return NULL;
+}
+
+static int StartStubServer(uint16_t *port)
+{
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0)
+    {
+        return -1;
+    }
+
+    struct sockaddr_in addr = { .sin_family = AF_INET };
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(sock, 64) != 0 ||
+        getsockname(sock, (struct sockaddr *)&addr, &addrLen) != 0)
+    {
+        close(sock);
+        return -1;
+    }
+
+    pthread_t thread;
+    if (0 != pthread_create(&thread, NULL, RunStubServer, (void *)(intptr_t)sock))
+    {
+        close(sock);
+        return -1;
+    }
+    pthread_detach(thread);
+
+    *port = ntohs(addr.sin_port);
+    return 0;
+}
+
+static void HandleResponse(const HttpResponse_t *response, void *context)
+{
+    (void)context;
+    if (CHP_SUCCESS != response->status)
+    {
+        printf("Unexpected HTTP status %d\n", response->status);
+    }
+
+    pthread_mutex_lock(&g_lock);
+    g_numOfResponses++;
+    pthread_cond_signal(&g_cond);
+    pthread_mutex_unlock(&g_lock);
+}
+
+static double GetElapsedMs(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static int RunPhase(const char *name, const char *uri, int numOfRequests)
+{
+    pthread_mutex_lock(&g_lock);
+    int connectionsBefore = g_numOfConnections;
+    int originRequestsBefore = g_numOfOriginRequests;
+    g_numOfResponses = 0;
+    pthread_mutex_unlock(&g_lock);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < numOfRequests; i++)
+    {
+        HttpRequest_t request = { .httpMajor = 1, .httpMinor = 1, .method = CHP_GET };
+        OICStrcpy(request.resourceUri, sizeof(request.resourceUri), uri);
+        OICStrcpy(request.acceptFormat, sizeof(request.acceptFormat), JSON_CONTENT_TYPE);
+
+        if (!CHPServeCachedResponse(&request, HandleResponse, NULL) &&
+            OC_STACK_OK != CHPPostHttpRequest(&request, HandleResponse, NULL))
+        {
+            printf("CHPPostHttpRequest failed\n");
+            return -1;
+        }
+
+        // One request in flight at a time, as a single CoAP client would send them.
+        pthread_mutex_lock(&g_lock);
+        while (g_numOfResponses <= i)
+        {
+            pthread_cond_wait(&g_cond, &g_lock);
+        }
+        pthread_mutex_unlock(&g_lock);
+    }
+
+    double elapsed = GetElapsedMs(&start);
+
+    pthread_mutex_lock(&g_lock);
+    printf("%-10s %6d requests %9.1f ms %9.1f req/s %6d connections %6d origin requests\n",
+           name, numOfRequests, elapsed, numOfRequests * 1000.0 / elapsed,
+           g_numOfConnections - connectionsBefore, g_numOfOriginRequests - originRequestsBefore);
+    pthread_mutex_unlock(&g_lock);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    int numOfRequests = DEFAULT_NUM_OF_REQUESTS;
+    int opt = 0;
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                numOfRequests = atoi(optarg);
+                break;
+            default:
+                PrintUsage();
+                return -1;
+        }
+    }
+
+    if (numOfRequests <= 0)
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    uint16_t port = 0;
+    if (0 != StartStubServer(&port))
+    {
+        printf("Failed to start HTTP stub server\n");
+        return -1;
+    }
+
+    if (OC_STACK_OK != CHPParserInitialize())
+    {
+        printf("Failed to initialize HTTP parser\n");
+        return -1;
+    }
+
+    char uri[CHP_MAX_HF_DATA_LENGTH];
+    int ret = 0;
+
+    snprintf(uri, sizeof(uri), "http://127.0.0.1:%u/nocache", port);
+    ret |= RunPhase("no-store", uri, numOfRequests);
+
+    snprintf(uri, sizeof(uri), "http://127.0.0.1:%u/cacheable", port);
+    ret |= RunPhase("max-age", uri, numOfRequests);
+
+    CHPParserTerminate();
+    return ret ? -1 : 0;
+}
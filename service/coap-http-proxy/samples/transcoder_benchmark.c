@@ -0,0 +1,232 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/*
+ * Throughput benchmark of the CoAP-HTTP proxy payload conversion. Each direction is run
+ * through the cJSON based mapping the proxy used before and through the streaming
+ * transcoder, ending where the handler needs the result: JSON text for the HTTP request
+ * and an OCRepPayload for the CoAP response.
+ */
+
+#include "CoapHttpMap.h"
+#include "CoapHttpTranscoder.h"
+#include "ocpayload.h"
+#include "internal/ocpayloadcbor.h"
+#include "oic_malloc.h"
+#include "cJSON.h"
+
+#include "iotivity_config.h"
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_NUM_OF_ITERATIONS (100000)
+
+static const char g_sampleJson[] =
+    "{\"n\":\"Living room light\",\"power\":true,\"brightness\":75,\"colour\":0.3127,"
+    "\"modes\":[\"normal\",\"night\",\"reading\"],\"schedule\":[420,1320,1380],"
+    "\"state\":{\"lastChanged\":1483228800,\"changedBy\":\"scene-7\",\"temperature\":21.5},"
+    "\"groups\":[{\"id\":1,\"name\":\"downstairs\"},{\"id\":4,\"name\":\"lights\"}]}";
+
+static void PrintUsage()
+{
+    printf("Usage : transcoder_benchmark -n <number of iterations>\n");
+}
+
+static double GetElapsedMs(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static void PrintResult(const char *name, int numOfIterations, size_t bytes,
+                        const struct timespec *start)
+{
+    double elapsed = GetElapsedMs(start);
+    printf("%-22s %9.1f ms %11.1f conv/s %8.1f MB/s\n", name, elapsed,
+           numOfIterations * 1000.0 / elapsed,
+           (double)bytes * numOfIterations / (elapsed * 1000.0));
+}
+
+static int RunJsonToRep(int numOfIterations)
+{
+    struct timespec start;
+    size_t jsonLength = strlen(g_sampleJson);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < numOfIterations; i++)
+    {
+        cJSON *json = cJSON_Parse(g_sampleJson);
+        OCRepPayload *payload = OCRepPayloadCreate();
+        if (!json || !payload)
+        {
+            printf("cJSON conversion failed\n");
+            return -1;
+        }
+        CHPJsonToRepPayload(json, payload);
+        cJSON_Delete(json);
+        OCRepPayloadDestroy(payload);
+    }
+    PrintResult("JSON->rep (cJSON)", numOfIterations, jsonLength, &start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < numOfIterations; i++)
+    {
+        uint8_t *cbor = NULL;
+        size_t cborSize = 0;
+        OCPayload *payload = NULL;
+        if (OC_STACK_OK != CHPJsonToCbor(g_sampleJson, jsonLength, &cbor, &cborSize) ||
+            OC_STACK_OK != OCParsePayload(&payload, OC_FORMAT_CBOR,
+                                          PAYLOAD_TYPE_REPRESENTATION, cbor, cborSize))
+        {
+            printf("Transcoder conversion failed\n");
+            OICFree(cbor);
+            return -1;
+        }
+        OICFree(cbor);
+        OCPayloadDestroy(payload);
+    }
+    PrintResult("JSON->rep (transcoder)", numOfIterations, jsonLength, &start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < numOfIterations; i++)
+    {
+        uint8_t *cbor = NULL;
+        size_t cborSize = 0;
+        if (OC_STACK_OK != CHPJsonToCbor(g_sampleJson, jsonLength, &cbor, &cborSize))
+        {
+            printf("Transcoder conversion failed\n");
+            return -1;
+        }
+        OICFree(cbor);
+    }
+    PrintResult("JSON->CBOR only", numOfIterations, jsonLength, &start);
+    return 0;
+}
+
+static int RunRepToJson(int numOfIterations)
+{
+    uint8_t *sampleCbor = NULL;
+    size_t sampleCborSize = 0;
+    OCPayload *sample = NULL;
+    struct timespec start;
+
+    if (OC_STACK_OK != CHPJsonToCbor(g_sampleJson, strlen(g_sampleJson),
+                                     &sampleCbor, &sampleCborSize) ||
+        OC_STACK_OK != OCParsePayload(&sample, OC_FORMAT_CBOR, PAYLOAD_TYPE_REPRESENTATION,
+                                      sampleCbor, sampleCborSize))
+    {
+        printf("Failed to build sample payload\n");
+        OICFree(sampleCbor);
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < numOfIterations; i++)
+    {
+        cJSON *json = CHPRepPayloadToJson((OCRepPayload *)sample);
+        char *text = json ? cJSON_Print(json) : NULL;
+        if (!text)
+        {
+            printf("cJSON conversion failed\n");
+            cJSON_Delete(json);
+            goto exit;
+        }
+        cJSON_Delete(json);
+        OICFree(text);
+    }
+    PrintResult("rep->JSON (cJSON)", numOfIterations, sampleCborSize, &start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < numOfIterations; i++)
+    {
+        uint8_t *cbor = NULL;
+        size_t cborSize = 0;
+        char *text = NULL;
+        size_t textLength = 0;
+        if (OC_STACK_OK != OCConvertPayload(sample, OC_FORMAT_CBOR, &cbor, &cborSize) ||
+            OC_STACK_OK != CHPCborToJson(cbor, cborSize, &text, &textLength))
+        {
+            printf("Transcoder conversion failed\n");
+            OICFree(cbor);
+            goto exit;
+        }
+        OICFree(cbor);
+        OICFree(text);
+    }
+    PrintResult("rep->JSON (transcoder)", numOfIterations, sampleCborSize, &start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < numOfIterations; i++)
+    {
+        char *text = NULL;
+        size_t textLength = 0;
+        if (OC_STACK_OK != CHPCborToJson(sampleCbor, sampleCborSize, &text, &textLength))
+        {
+            printf("Transcoder conversion failed\n");
+            goto exit;
+        }
+        OICFree(text);
+    }
+    PrintResult("CBOR->JSON only", numOfIterations, sampleCborSize, &start);
+
+    OCPayloadDestroy(sample);
+    OICFree(sampleCbor);
+    return 0;
+
+exit:
+    OCPayloadDestroy(sample);
+    OICFree(sampleCbor);
+    return -1;
+}
+
+int main(int argc, char* argv[])
+{
+    int numOfIterations = DEFAULT_NUM_OF_ITERATIONS;
+    int opt = 0;
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                numOfIterations = atoi(optarg);
+                break;
+            default:
+                PrintUsage();
+                return -1;
+        }
+    }
+
+    if (numOfIterations <= 0)
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    int ret = 0;
+    ret |= RunJsonToRep(numOfIterations);
+    ret |= RunRepToJson(numOfIterations);
+    return ret ? -1 : 0;
+}
@@ -29,7 +29,7 @@
 #include "uarraylist.h"
 #include "CoapHttpParser.h"
 #include "CoapHttpMap.h"
-#include "cJSON.h"
+#include "CoapHttpTranscoder.h"
 
 #define TAG "CHPHandler"
 
@@ -54,9 +54,11 @@ static int g_isCHProxyInitialized = false;
 
 /**
  * Function to hand over CoAP request handling to Proxy.
+ * On success ehResult is OC_EH_OK if the response was already sent from the response
+ * cache, or OC_EH_SLOW if it will be sent from the HTTP response callback.
  */
 OCStackResult CHPHandleOCFRequest(const OCEntityHandlerRequest* requestInfo,
-                                   const char* proxyUri);
+                                   const char* proxyUri, OCEntityHandlerResult* ehResult);
 
 /**
  * Entity handler to receive requests from csdk.
@@ -236,11 +238,13 @@ OCEntityHandlerResult CHPEntityHandler(OCEntityHandlerFlag flag,
 
         if (proxyUri[0] != '\0')
         {
-            // A request for HTTP resource. Response will be sent asynchronously
+            // A request for HTTP resource. Unless it is served from the response
+            // cache, the response will be sent asynchronously.
+            OCEntityHandlerResult ehResult = OC_EH_ERROR;
             if (OC_STACK_OK == CHPHandleOCFRequest(entityHandlerRequest,
-                                                   proxyUri) )
+                                                   proxyUri, &ehResult) )
             {
-                return OC_EH_SLOW;
+                return ehResult;
             }
         }
         else
@@ -336,34 +340,32 @@ void CHPHandleHttpResponse(const HttpResponse_t *httpResponse, void *context)
                 }
                 break;
             case OC_FORMAT_JSON:
+            {
                 OIC_LOG(DEBUG, TAG, "Payload format is JSON");
-                cJSON *payloadJson = cJSON_Parse((char *)httpResponse->payload);
-                if (!payloadJson)
+                // Transcode straight to CBOR and let the stack parse that, rather than
+                // building a cJSON tree first.
+                uint8_t *cborPayload = NULL;
+                size_t cborSize = 0;
+                result = CHPJsonToCbor((const char *)httpResponse->payload,
+                                       httpResponse->payloadLength, &cborPayload, &cborSize);
+                if (OC_STACK_OK == result)
                 {
-                    OIC_LOG(ERROR, TAG, "Unable to parse json response");
-                    response.ehResult = OC_EH_INTERNAL_SERVER_ERROR;
-                    if (OCDoResponse(&response) != OC_STACK_OK)
-                    {
-                        OIC_LOG(ERROR, TAG, "Error sending response");
-                    }
-                    return;
+                    result = OCParsePayload(&response.payload, OC_FORMAT_CBOR,
+                                            PAYLOAD_TYPE_REPRESENTATION, cborPayload, cborSize);
+                    OICFree(cborPayload);
                 }
-                OCRepPayload* payloadCbor = OCRepPayloadCreate();
-                if (!payloadCbor)
+                if (result != OC_STACK_OK)
                 {
+                    OIC_LOG(ERROR, TAG, "Unable to parse json response");
                     response.ehResult = OC_EH_INTERNAL_SERVER_ERROR;
                     if (OCDoResponse(&response) != OC_STACK_OK)
                     {
                         OIC_LOG(ERROR, TAG, "Error sending response");
                     }
-                    cJSON_Delete(payloadJson);
                     return;
                 }
-
-                CHPJsonToRepPayload(payloadJson, payloadCbor);
-                response.payload = (OCPayload *)payloadCbor;
-                cJSON_Delete(payloadJson);
                 break;
+            }
             default:
                 OIC_LOG(ERROR, TAG, "Payload format is not supported");
                 response.ehResult = OC_EH_INTERNAL_SERVER_ERROR;
@@ -406,7 +408,7 @@ void CHPHandleHttpResponse(const HttpResponse_t *httpResponse, void *context)
 }
 
 OCStackResult CHPHandleOCFRequest(const OCEntityHandlerRequest* requestInfo,
-                                   const char* proxyUri)
+                                   const char* proxyUri, OCEntityHandlerResult* ehResult)
 {
     OIC_LOG_V(DEBUG, TAG, "%s IN", __func__);
 
@@ -450,8 +452,17 @@ OCStackResult CHPHandleOCFRequest(const OCEntityHandlerRequest* requestInfo,
     if (requestInfo->payload && requestInfo->payload->type == PAYLOAD_TYPE_REPRESENTATION)
     {
         // Conversion from cbor to json.
-        cJSON *payloadJson = CHPRepPayloadToJson((OCRepPayload *)requestInfo->payload);
-        if (!payloadJson)
+        uint8_t *cborPayload = NULL;
+        size_t cborSize = 0;
+        char *jsonPayload = NULL;
+        size_t jsonLength = 0;
+        result = OCConvertPayload(requestInfo->payload, OC_FORMAT_CBOR, &cborPayload, &cborSize);
+        if (OC_STACK_OK == result)
+        {
+            result = CHPCborToJson(cborPayload, cborSize, &jsonPayload, &jsonLength);
+            OICFree(cborPayload);
+        }
+        if (OC_STACK_OK != result)
         {
             response.ehResult = OC_EH_BAD_REQ;
             if (OCDoResponse(&response) != OC_STACK_OK)
@@ -459,14 +470,13 @@ OCStackResult CHPHandleOCFRequest(const OCEntityHandlerRequest* requestInfo,
                 OIC_LOG(ERROR, TAG, "Error sending response");
             }
 
+            u_arraylist_destroy(httpRequest.headerOptions);
             return OC_STACK_ERROR;
-
         }
-        httpRequest.payload = (void *)cJSON_Print(payloadJson);
-        httpRequest.payloadLength = strlen(httpRequest.payload);
+        httpRequest.payload = (void *)jsonPayload;
+        httpRequest.payloadLength = jsonLength;
         OICStrcpy(httpRequest.payloadFormat, sizeof(httpRequest.payloadFormat),
-                  CBOR_CONTENT_TYPE);
-        cJSON_Delete(payloadJson);
+                  JSON_CONTENT_TYPE);
     }
 
     OICStrcpy(httpRequest.acceptFormat, sizeof(httpRequest.acceptFormat),
@@ -489,6 +499,18 @@ OCStackResult CHPHandleOCFRequest(const OCEntityHandlerRequest* requestInfo,
     chpRequest->requestHandle = requestInfo->requestHandle;
     chpRequest->method = requestInfo->method;
 
+    // A cache hit is answered here, on the stack's thread, before the entity handler
+    // returns. The server request must not be completed from the curl thread while the
+    // stack still marks it as slow.
+    if (CHPServeCachedResponse(&httpRequest, CHPHandleHttpResponse, (void *)chpRequest))
+    {
+        OICFree(httpRequest.payload);
+        u_arraylist_destroy(httpRequest.headerOptions);
+        *ehResult = OC_EH_OK;
+        OIC_LOG_V(DEBUG, TAG, "%s OUT", __func__);
+        return OC_STACK_OK;
+    }
+
     result = CHPPostHttpRequest(&httpRequest, CHPHandleHttpResponse,
                                 (void *)chpRequest);
     if (OC_STACK_OK != result)
@@ -520,6 +542,7 @@ OCStackResult CHPHandleOCFRequest(const OCEntityHandlerRequest* requestInfo,
         OICFree(httpRequest.payload);
     }
     u_arraylist_destroy(httpRequest.headerOptions);
+    *ehResult = OC_EH_SLOW;
     OIC_LOG_V(DEBUG, TAG, "%s OUT", __func__);
     return OC_STACK_OK;
 }
@@ -20,6 +20,8 @@
 
 #include "CoapHttpMap.h"
 #include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "experimental/logger.h"
@@ -140,6 +142,48 @@ OCStackResult CHPGetOCCode(const HttpResponseResult_t httpCode, const OCMethod m
     return OC_STACK_OK;
 }
 
+/*
+ * Seconds of freshness carried by a Cache-Control header: s-maxage or max-age, and 0 for
+ * no-cache or no-store. Returns false for other headers and directives.
+ */
+static bool CHPGetMaxAgeSeconds(const HttpHeaderOption_t *httpOption, uint32_t *maxAge)
+{
+    char optionName[CHP_MAX_HF_NAME_LENGTH];
+    OICStrcpy(optionName, sizeof(optionName), httpOption->optionName);
+    OICStringToLower(optionName);
+    if (0 != strcmp(optionName, HTTP_OPTION_CACHE_CONTROL))
+    {
+        return false;
+    }
+
+    char value[CHP_MAX_HF_DATA_LENGTH];
+    OICStrcpy(value, sizeof(value), httpOption->optionData);
+    OICStringToLower(value);
+
+    if (strstr(value, "no-cache") || strstr(value, "no-store"))
+    {
+        *maxAge = 0;
+        return true;
+    }
+
+    const char *directive = strstr(value, "s-maxage=");
+    size_t directiveLength = sizeof("s-maxage=") - 1;
+    if (!directive)
+    {
+        directive = strstr(value, "max-age=");
+        directiveLength = sizeof("max-age=") - 1;
+    }
+
+    if (!directive)
+    {
+        return false;
+    }
+
+    unsigned long seconds = strtoul(directive + directiveLength, NULL, 10);
+    *maxAge = (seconds > UINT32_MAX) ? UINT32_MAX : (uint32_t)seconds;
+    return true;
+}
+
 OCStackResult CHPGetOCOption(const HttpHeaderOption_t *httpOption, OCHeaderOption *ocfOption)
 {
     OIC_LOG(DEBUG, TAG, "CHPGetCoAPOption IN");
@@ -157,6 +201,25 @@ OCStackResult CHPGetOCOption(const HttpHeaderOption_t *httpOption, OCHeaderOptio
     }
 
     ocfOption->protocolID = OC_COAP_ID;
+
+    uint32_t maxAge = 0;
+    if (COAP_OPTION_MAXAGE == ocfOption->optionID &&
+        CHPGetMaxAgeSeconds(httpOption, &maxAge))
+    {
+        // CoAP Max-Age is a uint in network byte order with leading zero bytes omitted.
+        ocfOption->optionLength = 0;
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            uint8_t byte = (uint8_t)(maxAge >> shift);
+            if (byte || ocfOption->optionLength)
+            {
+                ocfOption->optionData[ocfOption->optionLength++] = byte;
+            }
+        }
+        OIC_LOG_V(DEBUG, TAG, "Max-Age %" PRIu32 " from %s", maxAge, httpOption->optionName);
+        return OC_STACK_OK;
+    }
+
     ocfOption->optionLength = httpOption->optionLength < sizeof(ocfOption->optionData) ?
                                 httpOption->optionLength : sizeof(ocfOption->optionData);
     memcpy(ocfOption->optionData,  httpOption->optionData, ocfOption->optionLength);
@@ -27,6 +27,7 @@
 #include "CoapHttpParser.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "oic_time.h"
 #include "uarraylist.h"
 #include "experimental/logger.h"
 
@@ -37,6 +38,7 @@
 #endif
 #if !defined(_MSC_VER)
 #include <unistd.h>
+#include <strings.h>
 #endif //!defined(_MSC_VER)
 #include <sys/types.h>
 #include <fcntl.h>
@@ -50,7 +52,17 @@
 #define DEFAULT_USER_AGENT "IoTivity"
 #define MAX_PAYLOAD_SIZE (1048576U) // 1 MB
 
-typedef struct
+/* Easy handles kept for reuse once a transfer completes */
+#define CHP_MAX_IDLE_EASY_HANDLES (8)
+/* Origin connections kept open by the multi handle's connection cache */
+#define CHP_MAX_CACHED_CONNECTIONS (16L)
+/* Lifetime of resolved host names in the multi handle's DNS cache */
+#define CHP_DNS_CACHE_TIMEOUT_SEC (300L)
+/* Fresh GET responses kept by the response cache */
+#define CHP_MAX_CACHED_RESPONSES (32)
+#define CHP_MAX_CACHED_PAYLOAD_SIZE (65536U) // 64 KB
+
+typedef struct CHPContext_t
 {
     void* context;
     CHPResponseCallback cb;
@@ -66,8 +78,19 @@ typedef struct
     CURL* easyHandle;
     /* libcurl does not copy header options passed to a request */
     struct curl_slist *list;
+    /* Response cache key of a cacheable GET request, NULL otherwise */
+    char *cacheKey;
 } CHPContext_t;
 
+typedef struct
+{
+    char *key;
+    HttpResponse_t resp;
+    /* Monotonic time in milliseconds after which the response is stale */
+    uint64_t expiry;
+    uint64_t lastUsed;
+} CHPCacheEntry_t;
+
 /* A curl mutihandle is not threadsafe so we require mutexes to add new easy
  * handles to multihandle.
  */
@@ -97,6 +120,20 @@ static int g_refreshFds[2];
  */
 static pthread_t g_multiHandleThread;
 
+/*
+ * Easy handles reset after use. Reusing them along with the connection and DNS
+ * cache of the multi handle avoids new TCP/TLS sessions to an origin per request.
+ * Protected by g_multiHandleMutex.
+ */
+static CURL *g_idleEasyHandles[CHP_MAX_IDLE_EASY_HANDLES];
+static size_t g_numIdleEasyHandles;
+
+/*
+ * Bounded cache of fresh GET responses. Protected by g_multiHandleMutex.
+ */
+static CHPCacheEntry_t g_responseCache[CHP_MAX_CACHED_RESPONSES];
+static uint64_t g_responseCacheTick;
+
 static void CHPParserLockMutex();
 static void CHPParserUnlockMutex();
 
@@ -112,6 +149,35 @@ static void CHPParserResetHeaderOptions(u_arraylist_t** headerOptions)
     u_arraylist_free(headerOptions);
 }
 
+static CURL *CHPAcquireEasyHandle()
+{
+    CURL *easyHandle = NULL;
+
+    CHPParserLockMutex();
+    if (g_numIdleEasyHandles)
+    {
+        easyHandle = g_idleEasyHandles[--g_numIdleEasyHandles];
+    }
+    CHPParserUnlockMutex();
+
+    return easyHandle ? easyHandle : curl_easy_init();
+}
+
+/* Called with g_multiHandleMutex held. */
+static void CHPReleaseEasyHandle(CURL *easyHandle)
+{
+    if (!g_terminateParser && g_numIdleEasyHandles < CHP_MAX_IDLE_EASY_HANDLES)
+    {
+        // Keeps live connections, DNS entries and TLS session ids of the handle.
+        curl_easy_reset(easyHandle);
+        g_idleEasyHandles[g_numIdleEasyHandles++] = easyHandle;
+        return;
+    }
+
+    curl_easy_cleanup(easyHandle);
+}
+
+/* Called with g_multiHandleMutex held. */
 static void CHPFreeContext(CHPContext_t *ctxt)
 {
     VERIFY_NON_NULL_VOID(ctxt, TAG, "ctxt is NULL");
@@ -122,15 +188,327 @@ static void CHPFreeContext(CHPContext_t *ctxt)
 
     if(ctxt->easyHandle)
     {
-        curl_easy_cleanup(ctxt->easyHandle);
+        CHPReleaseEasyHandle(ctxt->easyHandle);
     }
 
     CHPParserResetHeaderOptions(&(ctxt->resp.headerOptions));
     OICFree(ctxt->resp.payload);
     OICFree(ctxt->payload);
+    OICFree(ctxt->cacheKey);
     OICFree(ctxt);
 }
 
+static bool CHPIsFreshnessOption(const char *optionName)
+{
+    return (0 == strcasecmp(optionName, HTTP_OPTION_CACHE_CONTROL) ||
+            0 == strcasecmp(optionName, HTTP_OPTION_EXPIRES) ||
+            0 == strcasecmp(optionName, HTTP_OPTION_AGE));
+}
+
+static bool CHPAddHeaderOption(u_arraylist_t **headerOptions, const char *name, const char *data)
+{
+    if (!*headerOptions)
+    {
+        *headerOptions = u_arraylist_create();
+        if (!*headerOptions)
+        {
+            return false;
+        }
+    }
+
+    HttpHeaderOption_t *option = OICCalloc(1, sizeof(HttpHeaderOption_t));
+    if (!option)
+    {
+        return false;
+    }
+
+    OICStrcpy(option->optionName, sizeof(option->optionName), name);
+    OICStrcpy(option->optionData, sizeof(option->optionData), data);
+
+    if (!u_arraylist_add(*headerOptions, option))
+    {
+        OICFree(option);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Copy a response. Freshness header options (Cache-Control, Expires, Age) are
+ * left out; the cache adds the remaining freshness when it serves the copy.
+ */
+static bool CHPCopyResponse(const HttpResponse_t *src, HttpResponse_t *dst)
+{
+    *dst = *src;
+    dst->headerOptions = NULL;
+    dst->payload = NULL;
+
+    if (src->payloadLength)
+    {
+        // Keep the copy NULL terminated for textual payload formats.
+        dst->payload = OICMalloc(src->payloadLength + 1);
+        if (!dst->payload)
+        {
+            return false;
+        }
+        memcpy(dst->payload, src->payload, src->payloadLength);
+        ((char *)dst->payload)[src->payloadLength] = '\0';
+    }
+
+    size_t count = u_arraylist_length(src->headerOptions);
+    for (size_t i = 0; i < count; i++)
+    {
+        const HttpHeaderOption_t *option = u_arraylist_get(src->headerOptions, i);
+        if (!option || CHPIsFreshnessOption(option->optionName))
+        {
+            continue;
+        }
+
+        if (!CHPAddHeaderOption(&dst->headerOptions, option->optionName, option->optionData))
+        {
+            CHPParserResetHeaderOptions(&dst->headerOptions);
+            OICFree(dst->payload);
+            dst->payload = NULL;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Freshness lifetime of a response in seconds as a shared cache sees it:
+ * s-maxage, then max-age, then Expires. Returns 0 if the response must not be
+ * served from cache. Responses with Vary are not cached, since the cache key
+ * holds only the URI and the accepted format.
+ */
+static uint32_t CHPGetFreshnessLifetime(const HttpResponse_t *resp)
+{
+    long lifetime = 0;
+    long age = 0;
+    bool hasMaxAge = false;
+
+    size_t count = u_arraylist_length(resp->headerOptions);
+    for (size_t i = 0; i < count; i++)
+    {
+        const HttpHeaderOption_t *option = u_arraylist_get(resp->headerOptions, i);
+        if (!option)
+        {
+            continue;
+        }
+
+        if (0 == strcasecmp(option->optionName, HTTP_OPTION_CACHE_CONTROL))
+        {
+            char value[CHP_MAX_HF_DATA_LENGTH];
+            OICStrcpy(value, sizeof(value), option->optionData);
+            OICStringToLower(value);
+
+            if (strstr(value, "no-store") || strstr(value, "no-cache") || strstr(value, "private"))
+            {
+                return 0;
+            }
+
+            const char *directive = strstr(value, "s-maxage=");
+            if (directive)
+            {
+                lifetime = strtol(directive + sizeof("s-maxage=") - 1, NULL, 10);
+                hasMaxAge = true;
+            }
+            else if (!hasMaxAge && NULL != (directive = strstr(value, "max-age=")))
+            {
+                lifetime = strtol(directive + sizeof("max-age=") - 1, NULL, 10);
+                hasMaxAge = true;
+            }
+        }
+        else if (0 == strcasecmp(option->optionName, HTTP_OPTION_EXPIRES) && !hasMaxAge)
+        {
+            time_t expires = curl_getdate(option->optionData, NULL);
+            lifetime = (expires > 0) ? (long)(expires - time(NULL)) : 0;
+        }
+        else if (0 == strcasecmp(option->optionName, HTTP_OPTION_AGE))
+        {
+            age = strtol(option->optionData, NULL, 10);
+        }
+        else if (0 == strcasecmp(option->optionName, HTTP_OPTION_VARY))
+        {
+            return 0;
+        }
+    }
+
+    lifetime -= age;
+    return (lifetime > 0) ? (uint32_t)lifetime : 0;
+}
+
+static void CHPFreeCacheEntry(CHPCacheEntry_t *entry)
+{
+    OICFree(entry->key);
+    CHPParserResetHeaderOptions(&(entry->resp.headerOptions));
+    OICFree(entry->resp.payload);
+    memset(entry, 0, sizeof(*entry));
+}
+
+static char *CHPGetCacheKey(const HttpRequest_t *req)
+{
+    if (req->method != CHP_GET)
+    {
+        return NULL;
+    }
+
+    // Conditional, cache directed or authorized requests always go to the origin.
+    // Responses to authorized requests are not shared with other clients.
+    size_t count = u_arraylist_length(req->headerOptions);
+    for (size_t i = 0; i < count; i++)
+    {
+        const HttpHeaderOption_t *option = u_arraylist_get(req->headerOptions, i);
+        if (option && (0 == strcasecmp(option->optionName, HTTP_OPTION_CACHE_CONTROL) ||
+                       0 == strcasecmp(option->optionName, HTTP_OPTION_IF_MATCH) ||
+                       0 == strcasecmp(option->optionName, HTTP_OPTION_IF_NONE_MATCH) ||
+                       0 == strcasecmp(option->optionName, HTTP_OPTION_AUTHORIZATION)))
+        {
+            return NULL;
+        }
+    }
+
+    size_t keyLength = strlen(req->resourceUri) + strlen(req->acceptFormat) + 2;
+    char *key = OICMalloc(keyLength);
+    if (key)
+    {
+        snprintf(key, keyLength, "%s\n%s", req->resourceUri, req->acceptFormat);
+    }
+    return key;
+}
+
+/* Called with g_multiHandleMutex held. */
+static void CHPInvalidateCachedResponses(const char *uri)
+{
+    size_t uriLength = strlen(uri);
+    for (size_t i = 0; i < CHP_MAX_CACHED_RESPONSES; i++)
+    {
+        CHPCacheEntry_t *entry = &g_responseCache[i];
+        if (entry->key && 0 == strncmp(entry->key, uri, uriLength) &&
+            '\n' == entry->key[uriLength])
+        {
+            CHPFreeCacheEntry(entry);
+        }
+    }
+}
+
+/* Called with g_multiHandleMutex held. */
+static void CHPStoreCachedResponse(const char *key, const HttpResponse_t *resp)
+{
+    if (CHP_SUCCESS != resp->status || resp->payloadLength > CHP_MAX_CACHED_PAYLOAD_SIZE)
+    {
+        return;
+    }
+
+    uint32_t lifetime = CHPGetFreshnessLifetime(resp);
+    if (!lifetime)
+    {
+        return;
+    }
+
+    // Replace an entry for the same key, else a free or stale one, else the least recently used.
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    CHPCacheEntry_t *victim = NULL;
+    bool victimUnused = false;
+    for (size_t i = 0; i < CHP_MAX_CACHED_RESPONSES; i++)
+    {
+        CHPCacheEntry_t *entry = &g_responseCache[i];
+        if (entry->key && 0 == strcmp(entry->key, key))
+        {
+            victim = entry;
+            break;
+        }
+
+        if (!entry->key || entry->expiry <= now)
+        {
+            if (!victimUnused)
+            {
+                victim = entry;
+                victimUnused = true;
+            }
+        }
+        else if (!victimUnused && (!victim || entry->lastUsed < victim->lastUsed))
+        {
+            victim = entry;
+        }
+    }
+
+    CHPFreeCacheEntry(victim);
+    if (!CHPCopyResponse(resp, &victim->resp))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to cache response");
+        return;
+    }
+
+    victim->key = OICStrdup(key);
+    if (!victim->key)
+    {
+        CHPFreeCacheEntry(victim);
+        return;
+    }
+    victim->expiry = now + (uint64_t)lifetime * 1000;
+    victim->lastUsed = ++g_responseCacheTick;
+    OIC_LOG_V(DEBUG, TAG, "Cached response for %" PRIu32 " seconds", lifetime);
+}
+
+/*
+ * Fill ctxt->resp from a fresh cache entry matching ctxt->cacheKey. The copy carries a
+ * Cache-Control max-age with the remaining freshness so that it maps to CoAP Max-Age.
+ * Called with g_multiHandleMutex held.
+ */
+static bool CHPLoadCachedResponse(CHPContext_t *ctxt)
+{
+    uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+    for (size_t i = 0; i < CHP_MAX_CACHED_RESPONSES; i++)
+    {
+        CHPCacheEntry_t *entry = &g_responseCache[i];
+        if (!entry->key || 0 != strcmp(entry->key, ctxt->cacheKey))
+        {
+            continue;
+        }
+
+        if (entry->expiry <= now)
+        {
+            CHPFreeCacheEntry(entry);
+            return false;
+        }
+
+        if (!CHPCopyResponse(&entry->resp, &ctxt->resp))
+        {
+            return false;
+        }
+
+        char maxAge[32];
+        snprintf(maxAge, sizeof(maxAge), "max-age=%" PRIu64, (entry->expiry - now) / 1000);
+        if (!CHPAddHeaderOption(&ctxt->resp.headerOptions, HTTP_OPTION_CACHE_CONTROL, maxAge))
+        {
+            CHPParserResetHeaderOptions(&(ctxt->resp.headerOptions));
+            OICFree(ctxt->resp.payload);
+            memset(&ctxt->resp, 0, sizeof(ctxt->resp));
+            return false;
+        }
+
+        entry->lastUsed = ++g_responseCacheTick;
+        return true;
+    }
+    return false;
+}
+
+static void CHPClearResponseCache()
+{
+    CHPParserLockMutex();
+    for (size_t i = 0; i < CHP_MAX_CACHED_RESPONSES; i++)
+    {
+        CHPFreeCacheEntry(&g_responseCache[i]);
+    }
+
+    while (g_numIdleEasyHandles)
+    {
+        curl_easy_cleanup(g_idleEasyHandles[--g_numIdleEasyHandles]);
+    }
+    CHPParserUnlockMutex();
+}
+
 static void *CHPParserExecuteMultiHandle(void* data)
 {
     OIC_LOG_V(DEBUG, TAG, "%s IN", __func__);
@@ -191,8 +569,12 @@ static void *CHPParserExecuteMultiHandle(void* data)
             }
             else
             {
-                // libcurl recommend doing this.
-                usleep(100000);
+                // libcurl recommend waiting 100ms unless curl_multi_timeout() asks for less.
+                if (curlMultiTimeout > 100)
+                {
+                    curlMultiTimeout = 100;
+                }
+                usleep(curlMultiTimeout * 1000);
                 // dont select() and directly call curl_multi_perform()
                 goForSelect = false;
             }
@@ -219,7 +601,7 @@ static void *CHPParserExecuteMultiHandle(void* data)
             else
             {
                 timeout.tv_sec = curlMultiTimeout / 1000;
-                timeout.tv_usec = 0;
+                timeout.tv_usec = (curlMultiTimeout % 1000) * 1000;
                 tv = &timeout;
             }
 
@@ -282,6 +664,10 @@ static void *CHPParserExecuteMultiHandle(void* data)
                     OICStrcpy(ptr->resp.dataFormat, sizeof(ptr->resp.dataFormat), contentType);
                     OIC_LOG_V(DEBUG, TAG, "Transfer completed %d uri: %s, %s", g_activeConnections,
                                                                            uri, contentType);
+                    if (ptr->cacheKey && CURLE_OK == cmsg->data.result)
+                    {
+                        CHPStoreCachedResponse(ptr->cacheKey, &(ptr->resp));
+                    }
                     ptr->cb(&(ptr->resp), ptr->context);
                     CHPFreeContext(ptr);
                 }
@@ -408,6 +794,8 @@ static OCStackResult CHPParserInitializeMultiHandle()
         CHPParserUnlockMutex();
         return OC_STACK_ERROR;
     }
+    // Connections to origins stay open in the multi handle's cache between requests.
+    curl_multi_setopt(g_multiHandle, CURLMOPT_MAXCONNECTS, CHP_MAX_CACHED_CONNECTIONS);
 
     CHPParserUnlockMutex();
     return OC_STACK_OK;
@@ -491,6 +879,8 @@ OCStackResult CHPParserTerminate()
     }
     pthread_join(g_multiHandleThread, NULL);
 
+    CHPClearResponseCache();
+
     OCStackResult ret = CHPParserTerminateMultiHandle();
     if(ret != OC_STACK_OK)
     {
@@ -719,7 +1109,7 @@ static OCStackResult CHPInitializeEasyHandle(CURL** easyHandle, HttpRequest_t *r
     VERIFY_NON_NULL_RET(easyHandle, TAG, "easyHandle", OC_STACK_INVALID_PARAM);
     VERIFY_NON_NULL_RET(handleContext, TAG, "handleContext", OC_STACK_INVALID_PARAM);
 
-    CURL *e = curl_easy_init();
+    CURL *e = CHPAcquireEasyHandle();
     if(!e)
     {
         OIC_LOG(ERROR, TAG, "easy init failed!");
@@ -749,8 +1139,8 @@ static OCStackResult CHPInitializeEasyHandle(CURL** easyHandle, HttpRequest_t *r
     curl_easy_setopt(e, CURLOPT_LOW_SPEED_LIMIT, 1024L);
     curl_easy_setopt(e, CURLOPT_LOW_SPEED_TIME, 60L);
     curl_easy_setopt(e, CURLOPT_USERAGENT, DEFAULT_USER_AGENT);
-    /* Close connection once done with transaction */
-    curl_easy_setopt(e, CURLOPT_FORBID_REUSE, 1L);
+    /* Keep resolved origins to skip name resolution on following requests */
+    curl_easy_setopt(e, CURLOPT_DNS_CACHE_TIMEOUT, CHP_DNS_CACHE_TIMEOUT_SEC);
     /* Allow redirect */
     curl_easy_setopt(e, CURLOPT_FOLLOWLOCATION, 1L);
     /* Only redirect to http servers */
@@ -790,6 +1180,9 @@ static OCStackResult CHPInitializeEasyHandle(CURL** easyHandle, HttpRequest_t *r
             curl_easy_setopt(e, CURLOPT_CUSTOMREQUEST, "DELETE");
             break;
         default:
+            CHPParserLockMutex();
+            CHPReleaseEasyHandle(e);
+            CHPParserUnlockMutex();
             return OC_STACK_INVALID_METHOD;
     }
 
@@ -818,12 +1211,42 @@ static OCStackResult CHPInitializeEasyHandle(CURL** easyHandle, HttpRequest_t *r
     list = curl_slist_append(list, buffer);
     snprintf(buffer, sizeof(buffer), "Content-Type: %s", req->payloadFormat);
     curl_easy_setopt(e, CURLOPT_HTTPHEADER, list);
+    handleContext->list = list;
 
     *easyHandle = e;
     OIC_LOG_V(DEBUG, TAG, "%s OUT", __func__);
     return OC_STACK_OK;
 }
 
+bool CHPServeCachedResponse(const HttpRequest_t *req, CHPResponseCallback httpcb,
+                            void *context)
+{
+    VERIFY_NON_NULL_RET(req, TAG, "req", false);
+    VERIFY_NON_NULL_RET(httpcb, TAG, "httpcb", false);
+
+    CHPContext_t ctxt = { .cacheKey = CHPGetCacheKey(req) };
+    if (!ctxt.cacheKey)
+    {
+        return false;
+    }
+
+    CHPParserLockMutex();
+    bool isCached = CHPLoadCachedResponse(&ctxt);
+    CHPParserUnlockMutex();
+    OICFree(ctxt.cacheKey);
+
+    if (!isCached)
+    {
+        return false;
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "Response for %s served from cache", req->resourceUri);
+    httpcb(&ctxt.resp, context);
+    CHPParserResetHeaderOptions(&(ctxt.resp.headerOptions));
+    OICFree(ctxt.resp.payload);
+    return true;
+}
+
 OCStackResult CHPPostHttpRequest(HttpRequest_t *req, CHPResponseCallback httpcb,
                                  void *context)
 {
@@ -840,10 +1263,20 @@ OCStackResult CHPPostHttpRequest(HttpRequest_t *req, CHPResponseCallback httpcb,
 
     ctxt->cb = httpcb;
     ctxt->context = context;
+    ctxt->cacheKey = CHPGetCacheKey(req);
+
+    if (req->method != CHP_GET)
+    {
+        CHPParserLockMutex();
+        CHPInvalidateCachedResponses(req->resourceUri);
+        CHPParserUnlockMutex();
+    }
+
     OCStackResult ret = CHPInitializeEasyHandle(&ctxt->easyHandle, req, ctxt);
     if(ret != OC_STACK_OK)
     {
         OIC_LOG_V(ERROR, TAG, "Failed to initialize easy handle [%d]", ret);
+        OICFree(ctxt->cacheKey);
         OICFree(ctxt);
         return ret;
     }
@@ -0,0 +1,1059 @@
+/* ****************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "CoapHttpTranscoder.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <math.h>
+#include "oic_malloc.h"
+#include "experimental/logger.h"
+#include <cbor.h>
+
+#define TAG "CHPTranscoder"
+
+/**
+ * Initial size of the JSON output buffer. It is doubled as needed.
+ */
+#define CHP_JSON_INIT_SIZE (256)
+
+/**
+ * Longest JSON number text accepted for conversion to a double.
+ */
+#define CHP_JSON_MAX_NUMBER_LENGTH (64)
+
+/**
+ * Doubles with a smaller magnitude than this are exact integers.
+ */
+#define CHP_MAX_EXACT_INTEGER (9007199254740992.0)
+
+/**
+ * Returns from the enclosing function if a CBOR encoder call failed for any reason other
+ * than running out of buffer. The encoder keeps counting the bytes it could not write,
+ * so the caller retries once with the exact size.
+ */
+#define CHP_VERIFY_ENCODE(err) \
+    if (CborNoError != (err) && CborErrorOutOfMemory != (err)) \
+    { \
+        return (err); \
+    }
+
+/**
+ * Growable JSON output buffer.
+ * The scratch buffer holds CBOR strings copied out of the input before they are escaped.
+ */
+typedef struct
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+    uint8_t *scratch;
+    size_t scratchSize;
+} CHPJsonWriter_t;
+
+/**
+ * JSON input cursor.
+ * The scratch buffer holds strings that contain escapes while they are unescaped.
+ */
+typedef struct
+{
+    const char *cur;
+    const char *end;
+    char *scratch;
+    size_t scratchSize;
+} CHPJsonReader_t;
+
+static const char g_hexDigits[] = "0123456789abcdef";
+static const char g_base64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static bool CHPJsonReserve(CHPJsonWriter_t *writer, size_t length)
+{
+    // One extra byte is always kept for the terminating NUL.
+    if (writer->length + length < writer->capacity)
+    {
+        return true;
+    }
+
+    size_t capacity = writer->capacity ? writer->capacity : CHP_JSON_INIT_SIZE;
+    while (writer->length + length >= capacity)
+    {
+        capacity *= 2;
+    }
+
+    char *data = (char *)OICRealloc(writer->data, capacity);
+    if (!data)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to grow JSON buffer");
+        return false;
+    }
+
+    writer->data = data;
+    writer->capacity = capacity;
+    return true;
+}
+
+static bool CHPJsonAppend(CHPJsonWriter_t *writer, const char *str, size_t length)
+{
+    if (!CHPJsonReserve(writer, length))
+    {
+        return false;
+    }
+
+    memcpy(writer->data + writer->length, str, length);
+    writer->length += length;
+    return true;
+}
+
+static bool CHPJsonAppendChar(CHPJsonWriter_t *writer, char c)
+{
+    if (!CHPJsonReserve(writer, 1))
+    {
+        return false;
+    }
+
+    writer->data[writer->length++] = c;
+    return true;
+}
+
+static bool CHPJsonAppendEscaped(CHPJsonWriter_t *writer, const char *str, size_t length)
+{
+    if (!CHPJsonAppendChar(writer, '"'))
+    {
+        return false;
+    }
+
+    size_t start = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        unsigned char c = (unsigned char)str[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+
+        // Copy the run of characters that need no escaping in one go.
+        if (!CHPJsonAppend(writer, str + start, i - start))
+        {
+            return false;
+        }
+        start = i + 1;
+
+        char escape[6] = { '\\', 0 };
+        size_t escapeLength = 2;
+        switch (c)
+        {
+            case '"':  escape[1] = '"';  break;
+            case '\\': escape[1] = '\\'; break;
+            case '\b': escape[1] = 'b';  break;
+            case '\f': escape[1] = 'f';  break;
+            case '\n': escape[1] = 'n';  break;
+            case '\r': escape[1] = 'r';  break;
+            case '\t': escape[1] = 't';  break;
+            default:
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = g_hexDigits[c >> 4];
+                escape[5] = g_hexDigits[c & 0x0F];
+                escapeLength = 6;
+                break;
+        }
+
+        if (!CHPJsonAppend(writer, escape, escapeLength))
+        {
+            return false;
+        }
+    }
+
+    return CHPJsonAppend(writer, str + start, length - start) &&
+           CHPJsonAppendChar(writer, '"');
+}
+
+static bool CHPJsonAppendBase64(CHPJsonWriter_t *writer, const uint8_t *data, size_t length)
+{
+    if (!CHPJsonReserve(writer, ((length + 2) / 3) * 4 + 2))
+    {
+        return false;
+    }
+
+    char *out = writer->data + writer->length;
+    *out++ = '"';
+    size_t i = 0;
+    for (; i + 2 < length; i += 3)
+    {
+        uint32_t triple = ((uint32_t)data[i] << 16) | ((uint32_t)data[i + 1] << 8) | data[i + 2];
+        *out++ = g_base64Chars[(triple >> 18) & 0x3F];
+        *out++ = g_base64Chars[(triple >> 12) & 0x3F];
+        *out++ = g_base64Chars[(triple >> 6) & 0x3F];
+        *out++ = g_base64Chars[triple & 0x3F];
+    }
+
+    if (i < length)
+    {
+        uint32_t triple = (uint32_t)data[i] << 16;
+        if (i + 1 < length)
+        {
+            triple |= (uint32_t)data[i + 1] << 8;
+        }
+        *out++ = g_base64Chars[(triple >> 18) & 0x3F];
+        *out++ = g_base64Chars[(triple >> 12) & 0x3F];
+        *out++ = (i + 1 < length) ? g_base64Chars[(triple >> 6) & 0x3F] : '=';
+        *out++ = '=';
+    }
+    *out++ = '"';
+
+    writer->length = out - writer->data;
+    return true;
+}
+
+static bool CHPJsonAppendDouble(CHPJsonWriter_t *writer, double value)
+{
+    if (isnan(value) || isinf(value))
+    {
+        return CHPJsonAppend(writer, "null", 4);
+    }
+
+    // Use the shortest of the two precisions that reads back as the same value.
+    char buf[32];
+    int length = snprintf(buf, sizeof(buf), "%.15g", value);
+    if (strtod(buf, NULL) != value)
+    {
+        length = snprintf(buf, sizeof(buf), "%.17g", value);
+    }
+
+    return CHPJsonAppend(writer, buf, (size_t)length);
+}
+
+static double CHPDecodeHalfFloat(uint16_t half)
+{
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+    double value = 0;
+
+    if (0 == exponent)
+    {
+        value = ldexp(mantissa, -24);
+    }
+    else if (0x1F != exponent)
+    {
+        value = ldexp(mantissa + 1024, exponent - 25);
+    }
+    else
+    {
+        value = mantissa ? NAN : INFINITY;
+    }
+
+    return (half & 0x8000) ? -value : value;
+}
+
+static CborError CHPCopyCborString(CborValue *value, CHPJsonWriter_t *writer, size_t *length)
+{
+    CborError err = cbor_value_calculate_string_length(value, length);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+
+    if (*length + 1 > writer->scratchSize)
+    {
+        uint8_t *scratch = (uint8_t *)OICRealloc(writer->scratch, *length + 1);
+        if (!scratch)
+        {
+            return CborErrorOutOfMemory;
+        }
+        writer->scratch = scratch;
+        writer->scratchSize = *length + 1;
+    }
+
+    size_t copied = writer->scratchSize;
+    if (cbor_value_is_text_string(value))
+    {
+        err = cbor_value_copy_text_string(value, (char *)writer->scratch, &copied, value);
+    }
+    else
+    {
+        err = cbor_value_copy_byte_string(value, writer->scratch, &copied, value);
+    }
+    *length = copied;
+    return err;
+}
+
+static CborError CHPCborValueToJson(CborValue *value, CHPJsonWriter_t *writer, int depth);
+
+static CborError CHPCborContainerToJson(CborValue *value, CHPJsonWriter_t *writer, int depth)
+{
+    if (depth >= CHP_TRANSCODER_MAX_DEPTH)
+    {
+        OIC_LOG(ERROR, TAG, "CBOR nesting too deep");
+        return CborErrorNestingTooDeep;
+    }
+
+    bool isMap = cbor_value_is_map(value);
+    CborValue container;
+    CborError err = cbor_value_enter_container(value, &container);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+
+    if (!CHPJsonAppendChar(writer, isMap ? '{' : '['))
+    {
+        return CborErrorOutOfMemory;
+    }
+
+    bool first = true;
+    while (!cbor_value_at_end(&container))
+    {
+        if (!first && !CHPJsonAppendChar(writer, ','))
+        {
+            return CborErrorOutOfMemory;
+        }
+        first = false;
+
+        if (isMap)
+        {
+            if (cbor_value_is_text_string(&container))
+            {
+                size_t length = 0;
+                err = CHPCopyCborString(&container, writer, &length);
+                if (CborNoError != err)
+                {
+                    return err;
+                }
+                if (!CHPJsonAppendEscaped(writer, (const char *)writer->scratch, length))
+                {
+                    return CborErrorOutOfMemory;
+                }
+            }
+            else if (cbor_value_is_integer(&container))
+            {
+                if (!CHPJsonAppendChar(writer, '"'))
+                {
+                    return CborErrorOutOfMemory;
+                }
+                err = CHPCborValueToJson(&container, writer, depth + 1);
+                if (CborNoError != err)
+                {
+                    return err;
+                }
+                if (!CHPJsonAppendChar(writer, '"'))
+                {
+                    return CborErrorOutOfMemory;
+                }
+            }
+            else
+            {
+                OIC_LOG(ERROR, TAG, "Map key is neither a string nor an integer");
+                return CborErrorJsonObjectKeyNotString;
+            }
+
+            if (!CHPJsonAppendChar(writer, ':'))
+            {
+                return CborErrorOutOfMemory;
+            }
+
+            if (cbor_value_at_end(&container))
+            {
+                return CborErrorUnexpectedEOF;
+            }
+        }
+
+        err = CHPCborValueToJson(&container, writer, depth + 1);
+        if (CborNoError != err)
+        {
+            return err;
+        }
+    }
+
+    if (!CHPJsonAppendChar(writer, isMap ? '}' : ']'))
+    {
+        return CborErrorOutOfMemory;
+    }
+
+    return cbor_value_leave_container(value, &container);
+}
+
+/**
+ * Writes the item at value as JSON and advances value past it.
+ */
+static CborError CHPCborValueToJson(CborValue *value, CHPJsonWriter_t *writer, int depth)
+{
+    CborError err = CborNoError;
+
+    // Tags carry no meaning in JSON, so only the tagged item is written.
+    while (cbor_value_is_tag(value))
+    {
+        err = cbor_value_advance_fixed(value);
+        if (CborNoError != err)
+        {
+            return err;
+        }
+    }
+
+    switch (cbor_value_get_type(value))
+    {
+        case CborMapType:
+        case CborArrayType:
+            return CHPCborContainerToJson(value, writer, depth);
+        case CborTextStringType:
+        case CborByteStringType:
+        {
+            bool isText = cbor_value_is_text_string(value);
+            size_t length = 0;
+            err = CHPCopyCborString(value, writer, &length);
+            if (CborNoError != err)
+            {
+                return err;
+            }
+            bool written = isText ?
+                           CHPJsonAppendEscaped(writer, (const char *)writer->scratch, length) :
+                           CHPJsonAppendBase64(writer, writer->scratch, length);
+            return written ? CborNoError : CborErrorOutOfMemory;
+        }
+        case CborIntegerType:
+        {
+            uint64_t raw = 0;
+            char buf[24];
+            int length = 0;
+            err = cbor_value_get_raw_integer(value, &raw);
+            if (CborNoError != err)
+            {
+                return err;
+            }
+
+            if (cbor_value_is_unsigned_integer(value))
+            {
+                length = snprintf(buf, sizeof(buf), "%" PRIu64, raw);
+            }
+            else if (UINT64_MAX == raw)
+            {
+                length = snprintf(buf, sizeof(buf), "-18446744073709551616");
+            }
+            else
+            {
+                // A negative integer is stored as -1 - raw.
+                length = snprintf(buf, sizeof(buf), "-%" PRIu64, raw + 1);
+            }
+
+            if (!CHPJsonAppend(writer, buf, (size_t)length))
+            {
+                return CborErrorOutOfMemory;
+            }
+            break;
+        }
+        case CborBooleanType:
+        {
+            bool b = false;
+            err = cbor_value_get_boolean(value, &b);
+            if (CborNoError != err)
+            {
+                return err;
+            }
+            if (!(b ? CHPJsonAppend(writer, "true", 4) : CHPJsonAppend(writer, "false", 5)))
+            {
+                return CborErrorOutOfMemory;
+            }
+            break;
+        }
+        case CborDoubleType:
+        {
+            double d = 0;
+            err = cbor_value_get_double(value, &d);
+            if (CborNoError != err)
+            {
+                return err;
+            }
+            if (!CHPJsonAppendDouble(writer, d))
+            {
+                return CborErrorOutOfMemory;
+            }
+            break;
+        }
+        case CborFloatType:
+        {
+            float f = 0;
+            err = cbor_value_get_float(value, &f);
+            if (CborNoError != err)
+            {
+                return err;
+            }
+            if (!CHPJsonAppendDouble(writer, f))
+            {
+                return CborErrorOutOfMemory;
+            }
+            break;
+        }
+        case CborHalfFloatType:
+        {
+            uint16_t half = 0;
+            err = cbor_value_get_half_float(value, &half);
+            if (CborNoError != err)
+            {
+                return err;
+            }
+            if (!CHPJsonAppendDouble(writer, CHPDecodeHalfFloat(half)))
+            {
+                return CborErrorOutOfMemory;
+            }
+            break;
+        }
+        case CborNullType:
+        case CborUndefinedType:
+        case CborSimpleType:
+            if (!CHPJsonAppend(writer, "null", 4))
+            {
+                return CborErrorOutOfMemory;
+            }
+            break;
+        default:
+            OIC_LOG_V(ERROR, TAG, "Unsupported CBOR type %d", cbor_value_get_type(value));
+            return CborErrorUnknownType;
+    }
+
+    return cbor_value_advance_fixed(value);
+}
+
+OCStackResult CHPCborToJson(const uint8_t *cbor, size_t cborSize,
+                            char **json, size_t *jsonLength)
+{
+    if (!cbor || !json || !jsonLength)
+    {
+        OIC_LOG(ERROR, TAG, "Invalid arguments");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    CHPJsonWriter_t writer = { .data = NULL };
+    CborParser parser;
+    CborValue value;
+
+    CborError err = cbor_parser_init(cbor, cborSize, 0, &parser, &value);
+    if (CborNoError == err)
+    {
+        err = CHPCborValueToJson(&value, &writer, 0);
+    }
+
+    if (CborNoError == err && cbor_value_get_next_byte(&value) != cbor + cborSize)
+    {
+        err = CborErrorGarbageAtEnd;
+    }
+
+    // Reserve() always leaves room for the terminator, but the input may have been empty.
+    if (CborNoError == err && !CHPJsonReserve(&writer, 0))
+    {
+        err = CborErrorOutOfMemory;
+    }
+
+    OICFree(writer.scratch);
+    if (CborNoError != err)
+    {
+        OIC_LOG_V(ERROR, TAG, "CBOR to JSON failed: %s", cbor_error_string(err));
+        OICFree(writer.data);
+        return (CborErrorOutOfMemory == err) ? OC_STACK_NO_MEMORY : OC_STACK_INVALID_PARAM;
+    }
+
+    writer.data[writer.length] = '\0';
+    *json = writer.data;
+    *jsonLength = writer.length;
+    return OC_STACK_OK;
+}
+
+static void CHPJsonSkipWhitespace(CHPJsonReader_t *reader)
+{
+    while (reader->cur < reader->end &&
+           (' ' == *reader->cur || '\t' == *reader->cur ||
+            '\n' == *reader->cur || '\r' == *reader->cur))
+    {
+        reader->cur++;
+    }
+}
+
+static bool CHPJsonMatch(CHPJsonReader_t *reader, const char *literal, size_t length)
+{
+    if ((size_t)(reader->end - reader->cur) < length ||
+        0 != memcmp(reader->cur, literal, length))
+    {
+        return false;
+    }
+
+    reader->cur += length;
+    return true;
+}
+
+static bool CHPJsonReadHex4(CHPJsonReader_t *reader, uint32_t *code)
+{
+    if (reader->end - reader->cur < 4)
+    {
+        return false;
+    }
+
+    *code = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        char c = *reader->cur++;
+        *code <<= 4;
+        if (c >= '0' && c <= '9')
+        {
+            *code |= c - '0';
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            *code |= c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            *code |= c - 'A' + 10;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t CHPEncodeUtf8(uint32_t code, char *out)
+{
+    if (code < 0x80)
+    {
+        out[0] = (char)code;
+        return 1;
+    }
+    if (code < 0x800)
+    {
+        out[0] = (char)(0xC0 | (code >> 6));
+        out[1] = (char)(0x80 | (code & 0x3F));
+        return 2;
+    }
+    if (code < 0x10000)
+    {
+        out[0] = (char)(0xE0 | (code >> 12));
+        out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (code >> 18));
+    out[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (code & 0x3F));
+    return 4;
+}
+
+/**
+ * Reads the JSON string starting at the opening quote. A string without escapes is
+ * returned in place; otherwise it is unescaped into the reader's scratch buffer.
+ */
+static CborError CHPJsonReadString(CHPJsonReader_t *reader, const char **str, size_t *length)
+{
+    const char *start = ++reader->cur;
+    while (reader->cur < reader->end && '"' != *reader->cur && '\\' != *reader->cur)
+    {
+        if ((unsigned char)*reader->cur < 0x20)
+        {
+            return CborErrorIllegalType;
+        }
+        reader->cur++;
+    }
+
+    if (reader->cur >= reader->end)
+    {
+        return CborErrorUnexpectedEOF;
+    }
+
+    if ('"' == *reader->cur)
+    {
+        *str = start;
+        *length = reader->cur - start;
+        reader->cur++;
+        return CborNoError;
+    }
+
+    // An escape never unescapes to more bytes than its source text, so the rest of the
+    // input bounds the unescaped string.
+    size_t needed = reader->end - start;
+    if (needed > reader->scratchSize)
+    {
+        char *scratch = (char *)OICRealloc(reader->scratch, needed);
+        if (!scratch)
+        {
+            return CborErrorOutOfMemory;
+        }
+        reader->scratch = scratch;
+        reader->scratchSize = needed;
+    }
+
+    size_t used = reader->cur - start;
+    memcpy(reader->scratch, start, used);
+
+    while (reader->cur < reader->end && '"' != *reader->cur)
+    {
+        char c = *reader->cur++;
+        if ((unsigned char)c < 0x20)
+        {
+            return CborErrorIllegalType;
+        }
+        if ('\\' != c)
+        {
+            reader->scratch[used++] = c;
+            continue;
+        }
+
+        if (reader->cur >= reader->end)
+        {
+            return CborErrorUnexpectedEOF;
+        }
+
+        c = *reader->cur++;
+        switch (c)
+        {
+            case '"':
+            case '\\':
+            case '/':
+                reader->scratch[used++] = c;
+                break;
+            case 'b': reader->scratch[used++] = '\b'; break;
+            case 'f': reader->scratch[used++] = '\f'; break;
+            case 'n': reader->scratch[used++] = '\n'; break;
+            case 'r': reader->scratch[used++] = '\r'; break;
+            case 't': reader->scratch[used++] = '\t'; break;
+            case 'u':
+            {
+                uint32_t code = 0;
+                if (!CHPJsonReadHex4(reader, &code))
+                {
+                    return CborErrorIllegalType;
+                }
+
+                if (code >= 0xD800 && code <= 0xDBFF)
+                {
+                    uint32_t low = 0;
+                    if (!CHPJsonMatch(reader, "\\u", 2) || !CHPJsonReadHex4(reader, &low) ||
+                        low < 0xDC00 || low > 0xDFFF)
+                    {
+                        return CborErrorInvalidUtf8TextString;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else if (code >= 0xDC00 && code <= 0xDFFF)
+                {
+                    return CborErrorInvalidUtf8TextString;
+                }
+
+                used += CHPEncodeUtf8(code, reader->scratch + used);
+                break;
+            }
+            default:
+                return CborErrorIllegalType;
+        }
+    }
+
+    if (reader->cur >= reader->end)
+    {
+        return CborErrorUnexpectedEOF;
+    }
+
+    reader->cur++;
+    *str = reader->scratch;
+    *length = used;
+    return CborNoError;
+}
+
+static CborError CHPJsonNumberToCbor(CHPJsonReader_t *reader, CborEncoder *encoder)
+{
+    const char *start = reader->cur;
+    bool negative = false;
+    bool isInteger = true;
+    bool overflow = false;
+    uint64_t magnitude = 0;
+
+    if ('-' == *reader->cur)
+    {
+        negative = true;
+        reader->cur++;
+    }
+
+    // JSON does not allow leading zeros or a bare sign.
+    if (reader->cur >= reader->end || *reader->cur < '0' || *reader->cur > '9' ||
+        ('0' == *reader->cur && reader->cur + 1 < reader->end &&
+         reader->cur[1] >= '0' && reader->cur[1] <= '9'))
+    {
+        return CborErrorIllegalNumber;
+    }
+
+    while (reader->cur < reader->end && *reader->cur >= '0' && *reader->cur <= '9')
+    {
+        uint64_t digit = *reader->cur++ - '0';
+        if (magnitude > (UINT64_MAX - digit) / 10)
+        {
+            overflow = true;
+        }
+        magnitude = magnitude * 10 + digit;
+    }
+
+    if (reader->cur < reader->end && '.' == *reader->cur)
+    {
+        isInteger = false;
+        reader->cur++;
+        if (reader->cur >= reader->end || *reader->cur < '0' || *reader->cur > '9')
+        {
+            return CborErrorIllegalNumber;
+        }
+        while (reader->cur < reader->end && *reader->cur >= '0' && *reader->cur <= '9')
+        {
+            reader->cur++;
+        }
+    }
+
+    if (reader->cur < reader->end && ('e' == *reader->cur || 'E' == *reader->cur))
+    {
+        isInteger = false;
+        reader->cur++;
+        if (reader->cur < reader->end && ('+' == *reader->cur || '-' == *reader->cur))
+        {
+            reader->cur++;
+        }
+        if (reader->cur >= reader->end || *reader->cur < '0' || *reader->cur > '9')
+        {
+            return CborErrorIllegalNumber;
+        }
+        while (reader->cur < reader->end && *reader->cur >= '0' && *reader->cur <= '9')
+        {
+            reader->cur++;
+        }
+    }
+
+    if (isInteger && !overflow)
+    {
+        if (!negative)
+        {
+            return cbor_encode_uint(encoder, magnitude);
+        }
+        if (magnitude <= (uint64_t)INT64_MAX + 1)
+        {
+            return cbor_encode_int(encoder, (int64_t)(0 - magnitude));
+        }
+    }
+
+    // The input need not be NUL terminated, so strtod() works on a bounded copy.
+    char buf[CHP_JSON_MAX_NUMBER_LENGTH + 1];
+    size_t length = reader->cur - start;
+    if (length > CHP_JSON_MAX_NUMBER_LENGTH)
+    {
+        OIC_LOG(ERROR, TAG, "JSON number too long");
+        return CborErrorIllegalNumber;
+    }
+    memcpy(buf, start, length);
+    buf[length] = '\0';
+    double d = strtod(buf, NULL);
+
+    // Integral values go out as integers, the same as CHPJsonToRepPayload does.
+    if (d == floor(d) && fabs(d) < CHP_MAX_EXACT_INTEGER)
+    {
+        return cbor_encode_int(encoder, (int64_t)d);
+    }
+    return cbor_encode_double(encoder, d);
+}
+
+static CborError CHPJsonValueToCbor(CHPJsonReader_t *reader, CborEncoder *encoder, int depth);
+
+static CborError CHPJsonContainerToCbor(CHPJsonReader_t *reader, CborEncoder *encoder,
+                                        int depth)
+{
+    if (depth >= CHP_TRANSCODER_MAX_DEPTH)
+    {
+        OIC_LOG(ERROR, TAG, "JSON nesting too deep");
+        return CborErrorNestingTooDeep;
+    }
+
+    bool isMap = ('{' == *reader->cur);
+    char close = isMap ? '}' : ']';
+    CborEncoder container;
+    CborError err = isMap ?
+                    cbor_encoder_create_map(encoder, &container, CborIndefiniteLength) :
+                    cbor_encoder_create_array(encoder, &container, CborIndefiniteLength);
+    CHP_VERIFY_ENCODE(err);
+
+    reader->cur++;
+    CHPJsonSkipWhitespace(reader);
+    if (reader->cur < reader->end && close == *reader->cur)
+    {
+        reader->cur++;
+        return cbor_encoder_close_container(encoder, &container);
+    }
+
+    for (;;)
+    {
+        if (isMap)
+        {
+            if (reader->cur >= reader->end || '"' != *reader->cur)
+            {
+                return (reader->cur >= reader->end) ?
+                       CborErrorUnexpectedEOF : CborErrorJsonObjectKeyNotString;
+            }
+
+            const char *key = NULL;
+            size_t keyLength = 0;
+            err = CHPJsonReadString(reader, &key, &keyLength);
+            if (CborNoError != err)
+            {
+                return err;
+            }
+            err = cbor_encode_text_string(&container, key, keyLength);
+            CHP_VERIFY_ENCODE(err);
+
+            CHPJsonSkipWhitespace(reader);
+            if (!CHPJsonMatch(reader, ":", 1))
+            {
+                return CborErrorIllegalType;
+            }
+        }
+
+        err = CHPJsonValueToCbor(reader, &container, depth + 1);
+        CHP_VERIFY_ENCODE(err);
+
+        CHPJsonSkipWhitespace(reader);
+        if (reader->cur >= reader->end)
+        {
+            return CborErrorUnexpectedEOF;
+        }
+
+        char c = *reader->cur++;
+        if (close == c)
+        {
+            break;
+        }
+        if (',' != c)
+        {
+            return CborErrorIllegalType;
+        }
+        CHPJsonSkipWhitespace(reader);
+    }
+
+    return cbor_encoder_close_container(encoder, &container);
+}
+
+static CborError CHPJsonValueToCbor(CHPJsonReader_t *reader, CborEncoder *encoder, int depth)
+{
+    CHPJsonSkipWhitespace(reader);
+    if (reader->cur >= reader->end)
+    {
+        return CborErrorUnexpectedEOF;
+    }
+
+    switch (*reader->cur)
+    {
+        case '{':
+        case '[':
+            return CHPJsonContainerToCbor(reader, encoder, depth);
+        case '"':
+        {
+            const char *str = NULL;
+            size_t length = 0;
+            CborError err = CHPJsonReadString(reader, &str, &length);
+            if (CborNoError != err)
+            {
+                return err;
+            }
+            return cbor_encode_text_string(encoder, str, length);
+        }
+        case 't':
+            return CHPJsonMatch(reader, "true", 4) ?
+                   cbor_encode_boolean(encoder, true) : CborErrorIllegalType;
+        case 'f':
+            return CHPJsonMatch(reader, "false", 5) ?
+                   cbor_encode_boolean(encoder, false) : CborErrorIllegalType;
+        case 'n':
+            return CHPJsonMatch(reader, "null", 4) ?
+                   cbor_encode_null(encoder) : CborErrorIllegalType;
+        default:
+            return CHPJsonNumberToCbor(reader, encoder);
+    }
+}
+
+OCStackResult CHPJsonToCbor(const char *json, size_t jsonLength,
+                            uint8_t **cbor, size_t *cborSize)
+{
+    if (!json || !cbor || !cborSize)
+    {
+        OIC_LOG(ERROR, TAG, "Invalid arguments");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    CHPJsonReader_t reader = { .scratch = NULL };
+    uint8_t *out = NULL;
+    CborError err = CborErrorOutOfMemory;
+
+    // CBOR is rarely larger than the JSON it came from. If it is, the encoder reports the
+    // exact shortfall and the second pass fits.
+    size_t size = jsonLength + 16;
+    for (int pass = 0; pass < 2 && CborErrorOutOfMemory == err; pass++)
+    {
+        OICFree(out);
+        out = (uint8_t *)OICMalloc(size);
+        if (!out)
+        {
+            break;
+        }
+
+        CborEncoder encoder;
+        cbor_encoder_init(&encoder, out, size, 0);
+        reader.cur = json;
+        reader.end = json + jsonLength;
+
+        err = CHPJsonValueToCbor(&reader, &encoder, 0);
+        if (CborNoError != err && CborErrorOutOfMemory != err)
+        {
+            break;
+        }
+
+        CHPJsonSkipWhitespace(&reader);
+        if (reader.cur != reader.end)
+        {
+            err = CborErrorGarbageAtEnd;
+            break;
+        }
+
+        size_t extra = cbor_encoder_get_extra_bytes_needed(&encoder);
+        if (extra)
+        {
+            size += extra;
+            err = CborErrorOutOfMemory;
+            continue;
+        }
+
+        err = CborNoError;
+        size = cbor_encoder_get_buffer_size(&encoder, out);
+    }
+
+    OICFree(reader.scratch);
+    if (CborNoError != err)
+    {
+        OIC_LOG_V(ERROR, TAG, "JSON to CBOR failed at offset %zu: %s",
+                  (size_t)(reader.cur - json), cbor_error_string(err));
+        OICFree(out);
+        return (CborErrorOutOfMemory == err) ? OC_STACK_NO_MEMORY : OC_STACK_INVALID_PARAM;
+    }
+
+    *cbor = out;
+    *cborSize = size;
+    return OC_STACK_OK;
+}
@@ -22,6 +22,7 @@
 
 #include <condition_variable>
 #include <mutex>
+#include <string>
 #include <chrono>
 #include <signal.h>
 #ifdef HAVE_UNISTD_H
@@ -37,7 +38,9 @@
 #include "uarraylist.h"
 #include "CoapHttpParser.h"
 #include "CoapHttpMap.h"
+#include "CoapHttpTranscoder.h"
 #include "ocpayload.h"
+#include "internal/ocpayloadcbor.h"
 
 static std::chrono::milliseconds g_waitForResponse(10000);
 static std::condition_variable responseCon;
@@ -251,6 +254,32 @@ TEST_F(CoApHttpTest, CHPGetOCOption)
     EXPECT_EQ(OC_STACK_INVALID_OPTION, (CHPGetOCOption(&httpOption, &ocOp)));
 }
 
+TEST_F(CoApHttpTest, CHPGetOCOptionMaxAge)
+{
+    OCHeaderOption ocOp;
+    HttpHeaderOption_t httpOption;
+    OICStrcpy(httpOption.optionName, sizeof(httpOption.optionName), "Cache-Control");
+
+    OICStrcpy(httpOption.optionData, sizeof(httpOption.optionData), "public, max-age=300");
+    httpOption.optionLength = strlen(httpOption.optionData);
+    EXPECT_EQ(OC_STACK_OK, (CHPGetOCOption(&httpOption, &ocOp)));
+    EXPECT_EQ(COAP_OPTION_MAXAGE, ocOp.optionID);
+    ASSERT_EQ(2, ocOp.optionLength);
+    EXPECT_EQ(0x01, ocOp.optionData[0]);
+    EXPECT_EQ(0x2C, ocOp.optionData[1]);
+
+    OICStrcpy(httpOption.optionData, sizeof(httpOption.optionData), "max-age=60, s-maxage=30");
+    httpOption.optionLength = strlen(httpOption.optionData);
+    EXPECT_EQ(OC_STACK_OK, (CHPGetOCOption(&httpOption, &ocOp)));
+    ASSERT_EQ(1, ocOp.optionLength);
+    EXPECT_EQ(30, ocOp.optionData[0]);
+
+    OICStrcpy(httpOption.optionData, sizeof(httpOption.optionData), "no-store");
+    httpOption.optionLength = strlen(httpOption.optionData);
+    EXPECT_EQ(OC_STACK_OK, (CHPGetOCOption(&httpOption, &ocOp)));
+    EXPECT_EQ(0, ocOp.optionLength);
+}
+
 TEST_F(CoApHttpTest, CHPGetOCContentType)
 {
     const char *httpContentType = CBOR_CONTENT_TYPE;
@@ -368,6 +397,163 @@ TEST_F(CoApHttpTest, CHPJsonToRepPayload)
     cj = NULL;
 }
 
+static std::string TranscodeJsonRoundTrip(const std::string &json)
+{
+    uint8_t *cbor = NULL;
+    size_t cborSize = 0;
+    char *out = NULL;
+    size_t outLength = 0;
+    std::string ret;
+
+    if (OC_STACK_OK == CHPJsonToCbor(json.data(), json.size(), &cbor, &cborSize) &&
+        OC_STACK_OK == CHPCborToJson(cbor, cborSize, &out, &outLength))
+    {
+        ret.assign(out, outLength);
+    }
+    OICFree(cbor);
+    OICFree(out);
+    return ret;
+}
+
+static std::string TranscodeCbor(const uint8_t *cbor, size_t cborSize)
+{
+    char *out = NULL;
+    size_t outLength = 0;
+    std::string ret;
+
+    if (OC_STACK_OK == CHPCborToJson(cbor, cborSize, &out, &outLength))
+    {
+        EXPECT_EQ(strlen(out), outLength);
+        ret.assign(out, outLength);
+    }
+    OICFree(out);
+    return ret;
+}
+
+TEST_F(CoApHttpTest, CHPTranscoderRoundTrip)
+{
+    const char *documents[] = {
+        "{}",
+        "[]",
+        "\"\"",
+        "null",
+        "{\"a\":1,\"b\":[true,false,null],\"c\":\"x\",\"d\":{\"e\":[[],{}]}}",
+        "{\"s\":\"quote\\\" backslash\\\\ tab\\t nl\\n ctl\\u0001 caf\xc3\xa9\"}",
+        "[0,-42,9223372036854775807,-9223372036854775808,18446744073709551615]",
+        "[0.1,-1.5,3.1415926535897931,1e+300,-2.5e-300]",
+        "[{\"id\":1,\"name\":\"downstairs\"},{\"id\":4,\"name\":\"lights\"}]",
+    };
+
+    for (size_t i = 0; i < sizeof(documents) / sizeof(documents[0]); i++)
+    {
+        EXPECT_EQ(documents[i], TranscodeJsonRoundTrip(documents[i]));
+    }
+
+    // Whitespace is dropped, escapes are resolved and integral numbers become integers.
+    EXPECT_EQ("{\"a\":[1,2],\"b\":\"/\xc3\xa9\xf0\x9f\x98\x80\"}",
+              TranscodeJsonRoundTrip(" {\r\n\t\"a\" : [ 1.0 , 2e0 ] ,"
+                                     " \"b\" : \"\\/\\u00e9\\ud83d\\ude00\" } "));
+
+    // The input does not have to be NUL terminated.
+    uint8_t *cbor = NULL;
+    size_t cborSize = 0;
+    EXPECT_EQ(OC_STACK_OK, CHPJsonToCbor("[1,2]garbage", 5, &cbor, &cborSize));
+    EXPECT_EQ("[1,2]", TranscodeCbor(cbor, cborSize));
+    OICFree(cbor);
+
+    // Large documents need more than the initial guess of the CBOR size.
+    std::string large = "[";
+    for (int i = 0; i < 1000; i++)
+    {
+        large += (i ? ",0.5" : "0.5");
+    }
+    large += "]";
+    EXPECT_EQ(large, TranscodeJsonRoundTrip(large));
+}
+
+TEST_F(CoApHttpTest, CHPCborToJson)
+{
+    // {1: h'010203', "t": 1(1483228800), "h": 1.0 (half), "f": NaN (float), "u": undefined}
+    const uint8_t cbor[] = {
+        0xA5, 0x01, 0x43, 0x01, 0x02, 0x03,
+        0x61, 't', 0xC1, 0x1A, 0x58, 0x68, 0x46, 0x80,
+        0x61, 'h', 0xF9, 0x3C, 0x00,
+        0x61, 'f', 0xFA, 0x7F, 0xC0, 0x00, 0x00,
+        0x61, 'u', 0xF7,
+    };
+    EXPECT_EQ("{\"1\":\"AQID\",\"t\":1483228800,\"h\":1,\"f\":null,\"u\":null}",
+              TranscodeCbor(cbor, sizeof(cbor)));
+
+    // Indefinite length containers and chunked strings, as the stack encodes them.
+    const uint8_t chunked[] = {
+        0xBF, 0x61, 'k', 0x9F, 0x7F, 0x62, 'a', 'b', 0x61, 'c', 0xFF, 0x20, 0xFF, 0xFF,
+    };
+    EXPECT_EQ("{\"k\":[\"abc\",-1]}", TranscodeCbor(chunked, sizeof(chunked)));
+
+    char *json = NULL;
+    size_t jsonLength = 0;
+    // Truncated map, trailing data and an array used as a map key.
+    const uint8_t truncated[] = { 0xA1, 0x61, 'a' };
+    const uint8_t trailing[] = { 0x01, 0x02 };
+    const uint8_t arrayKey[] = { 0xA1, 0x80, 0x01 };
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, CHPCborToJson(truncated, sizeof(truncated),
+                                                    &json, &jsonLength));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, CHPCborToJson(trailing, sizeof(trailing),
+                                                    &json, &jsonLength));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, CHPCborToJson(arrayKey, sizeof(arrayKey),
+                                                    &json, &jsonLength));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, CHPCborToJson(NULL, 0, &json, &jsonLength));
+    EXPECT_TRUE(NULL == json);
+}
+
+TEST_F(CoApHttpTest, CHPJsonToCborInvalid)
+{
+    std::string deep(CHP_TRANSCODER_MAX_DEPTH + 1, '[');
+    deep += std::string(CHP_TRANSCODER_MAX_DEPTH + 1, ']');
+
+    const std::string documents[] = {
+        "", " ", "{", "[1,]", "{\"a\":}", "{\"a\" 1}", "{1:2}", "{\"a\":1,}", "01", "-",
+        "1.", "1e", "+1", "tru", "nul", "\"abc", "\"a\nb\"", "\"\\x\"", "\"\\ud800\"",
+        "\"\\udc00\"", "\"\\u12\"", "[1] x", "[1][2]", deep,
+    };
+
+    for (size_t i = 0; i < sizeof(documents) / sizeof(documents[0]); i++)
+    {
+        uint8_t *cbor = NULL;
+        size_t cborSize = 0;
+        EXPECT_EQ(OC_STACK_INVALID_PARAM,
+                  CHPJsonToCbor(documents[i].data(), documents[i].size(), &cbor, &cborSize))
+            << documents[i];
+        EXPECT_TRUE(NULL == cbor);
+    }
+}
+
+TEST_F(CoApHttpTest, CHPTranscoderRepPayload)
+{
+    // The path the handler takes: HTTP JSON -> CBOR -> OCRepPayload for the CoAP response,
+    // and OCRepPayload -> CBOR -> JSON for the HTTP request.
+    const std::string json = "{\"power\":true,\"level\":7,\"ratio\":0.25,\"name\":\"lamp\","
+                             "\"state\":{\"on\":false},\"modes\":[\"a\",\"b\"],"
+                             "\"schedule\":[420,1320],\"groups\":[{\"id\":1},{\"id\":4}]}";
+    uint8_t *cbor = NULL;
+    size_t cborSize = 0;
+    OCPayload *rep = NULL;
+    ASSERT_EQ(OC_STACK_OK, CHPJsonToCbor(json.data(), json.size(), &cbor, &cborSize));
+    ASSERT_EQ(OC_STACK_OK, OCParsePayload(&rep, OC_FORMAT_CBOR, PAYLOAD_TYPE_REPRESENTATION,
+                                          cbor, cborSize));
+    OICFree(cbor);
+
+    int64_t level = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt((OCRepPayload *)rep, "level", &level));
+    EXPECT_EQ(7, level);
+
+    cbor = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload(rep, OC_FORMAT_CBOR, &cbor, &cborSize));
+    EXPECT_EQ(json, TranscodeCbor(cbor, cborSize));
+    OICFree(cbor);
+    OCPayloadDestroy(rep);
+}
+
 TEST_F(CoApHttpTest, CHPParserInitialize)
 {
     EXPECT_EQ(OC_STACK_OK, (CHPParserInitialize()));
@@ -20,6 +20,7 @@
 
 #include "NSProviderMemoryCache.h"
 #include <string.h>
+#include <inttypes.h>
 
 #define NS_PROVIDER_DELETE_REGISTERED_TOPIC_DATA(it, topicData, newObj) \
     { \
@@ -651,3 +652,185 @@ NSResult NSProviderDeleteConsumerTopic(NSCacheList * conTopicList,
     pthread_mutex_unlock(&NSCacheMutex);
     return NS_FAIL;
 }
+
+typedef struct
+{
+    const char ** slots;
+    size_t mask;
+
+} NSConsumerIdSet;
+
+static size_t NSHashConsumerId(const char * id)
+{
+    size_t hash = 5381;
+
+    while (*id)
+    {
+        hash = (hash * 33) ^ (unsigned char) *id++;
+    }
+
+    return hash;
+}
+
+static bool NSConsumerIdSetInit(NSConsumerIdSet * set, size_t count)
+{
+    size_t size = 16;
+
+    while (size < count * 2)
+    {
+        size <<= 1;
+    }
+
+    set->slots = (const char **) OICCalloc(size, sizeof(const char *));
+    set->mask = size - 1;
+
+    return set->slots != NULL;
+}
+
+static void NSConsumerIdSetInsert(NSConsumerIdSet * set, const char * id)
+{
+    size_t index = NSHashConsumerId(id) & set->mask;
+
+    while (set->slots[index])
+    {
+        if (strcmp(set->slots[index], id) == 0)
+        {
+            return;
+        }
+
+        index = (index + 1) & set->mask;
+    }
+
+    set->slots[index] = id;
+}
+
+static bool NSConsumerIdSetContains(const NSConsumerIdSet * set, const char * id)
+{
+    size_t index = NSHashConsumerId(id) & set->mask;
+
+    while (set->slots[index])
+    {
+        if (strcmp(set->slots[index], id) == 0)
+        {
+            return true;
+        }
+
+        index = (index + 1) & set->mask;
+    }
+
+    return false;
+}
+
+static bool NSAppendObservationId(OCObservationId ** obIds, size_t * obCount,
+        size_t * capacity, OCObservationId id)
+{
+    if (*obCount == *capacity)
+    {
+        size_t newCapacity = *capacity ? *capacity * 2 : 16;
+        OCObservationId * newIds = (OCObservationId *) OICRealloc(*obIds,
+                newCapacity * sizeof(OCObservationId));
+
+        if (!newIds)
+        {
+            return false;
+        }
+
+        *obIds = newIds;
+        *capacity = newCapacity;
+    }
+
+    (*obIds)[(*obCount)++] = id;
+    return true;
+}
+
+NSResult NSProviderGetObservationIds(NSCacheList * subList, NSCacheList * conTopicList,
+        const char * topicName, bool isSync, OCObservationId ** obIds, size_t * obCount)
+{
+    NS_LOG(DEBUG, "NSProviderGetObservationIds - IN");
+
+    if (!subList || !obIds || !obCount || (topicName && !conTopicList))
+    {
+        return NS_ERROR;
+    }
+
+    *obIds = NULL;
+    *obCount = 0;
+
+    pthread_mutex_lock(&NSCacheMutex);
+
+    NSConsumerIdSet topicSubscribers = { NULL, 0 };
+
+    if (topicName)
+    {
+        size_t numOfSubscribers = 0;
+
+        for (NSCacheElement * iter = conTopicList->head; iter; iter = iter->next)
+        {
+            NSCacheTopicSubData * curr = (NSCacheTopicSubData *) iter->data;
+
+            if (strcmp(curr->topicName, topicName) == 0)
+            {
+                ++numOfSubscribers;
+            }
+        }
+
+        if (!numOfSubscribers)
+        {
+            NS_LOG_V(DEBUG, "no consumer subscribes to topic: %s", topicName);
+            pthread_mutex_unlock(&NSCacheMutex);
+            return NS_OK;
+        }
+
+        if (!NSConsumerIdSetInit(&topicSubscribers, numOfSubscribers))
+        {
+            NS_LOG(ERROR, "Failed to allocate topic subscriber index");
+            pthread_mutex_unlock(&NSCacheMutex);
+            return NS_ERROR;
+        }
+
+        for (NSCacheElement * iter = conTopicList->head; iter; iter = iter->next)
+        {
+            NSCacheTopicSubData * curr = (NSCacheTopicSubData *) iter->data;
+
+            if (strcmp(curr->topicName, topicName) == 0)
+            {
+                NSConsumerIdSetInsert(&topicSubscribers, curr->id);
+            }
+        }
+    }
+
+    size_t capacity = 0;
+    NSResult result = NS_OK;
+
+    for (NSCacheElement * iter = subList->head; iter; iter = iter->next)
+    {
+        NSCacheSubData * subData = (NSCacheSubData *) iter->data;
+        OCObservationId id = (OCObservationId) (isSync ? subData->syncObId : subData->messageObId);
+
+        if (!subData->isWhite || id == 0)
+        {
+            continue;
+        }
+
+        if (topicName && !NSConsumerIdSetContains(&topicSubscribers, subData->id))
+        {
+            continue;
+        }
+
+        if (!NSAppendObservationId(obIds, obCount, &capacity, id))
+        {
+            NS_LOG(ERROR, "Failed to allocate observation id list");
+            NSOICFree(*obIds);
+            *obCount = 0;
+            result = NS_ERROR;
+            break;
+        }
+    }
+
+    NSOICFree(topicSubscribers.slots);
+    pthread_mutex_unlock(&NSCacheMutex);
+
+    NS_LOG_V(DEBUG, "number of observation ids = %" PRIuPTR, *obCount);
+    NS_LOG(DEBUG, "NSProviderGetObservationIds - OUT");
+    return result;
+}
@@ -57,6 +57,26 @@ bool NSProviderIsTopicSubScribed(NSCacheElement * conTopicList, char * cId, char
 NSResult NSProviderDeleteConsumerTopic(NSCacheList * conTopicList,
         NSCacheTopicSubData * topicSubData);
 
+/**
+ * Collect the observation ids of every allowed consumer that should receive a message.
+ * When topicName is given only consumers subscribed to that topic are returned. The
+ * consumer-topic list is indexed once per call, so the cost is linear in the number of
+ * consumers plus topic subscriptions.
+ * Observation ids are unique uint8_t values across the stack, so at most UINT8_MAX
+ * ids are returned.
+ *
+ * @param[in]  subList       consumer subscription list.
+ * @param[in]  conTopicList  consumer topic list, used only when topicName is set.
+ * @param[in]  topicName     topic of the message, or NULL to select every consumer.
+ * @param[in]  isSync        true to collect sync observation ids instead of message ids.
+ * @param[out] obIds         allocated array of observation ids, to be freed with OICFree.
+ * @param[out] obCount       number of entries in obIds.
+ *
+ * @return ::NS_OK on success, ::NS_ERROR if memory could not be allocated.
+ */
+NSResult NSProviderGetObservationIds(NSCacheList * subList, NSCacheList * conTopicList,
+        const char * topicName, bool isSync, OCObservationId ** obIds, size_t * obCount);
+
 pthread_mutex_t NSCacheMutex;
 pthread_mutexattr_t NSCacheMutexAttr;
 
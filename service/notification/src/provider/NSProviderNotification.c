@@ -114,7 +114,7 @@ NSResult NSSendNotification(NSMessage *msg)
     NS_LOG(DEBUG, "NSSendMessage - IN");
 
     OCResourceHandle rHandle = NULL;
-    OCObservationId obArray[255] = { 0, };
+    OCObservationId * obArray = NULL;
     size_t obCount = 0;
 
     if (NSPutMessageResource(msg, &rHandle) != NS_OK)
@@ -146,36 +146,21 @@ NSResult NSSendNotification(NSMessage *msg)
         return NS_ERROR;
     }
 
-    NSCacheElement * it = consumerSubList->head;
+    const char * topicName = NULL;
 
-    while (it)
+    if (msg->topic && (msg->topic)[0] != '\0')
     {
-        NSCacheSubData * subData = (NSCacheSubData *) it->data;
-        NS_LOG_V(INFO_PRIVATE, "message subData->id = %s", subData->id);
-        NS_LOG_V(DEBUG, "subData->messageId = %d", subData->messageObId);
-        NS_LOG_V(DEBUG, "subData->syncId = %d", subData->syncObId);
-        NS_LOG_V(DEBUG, "subData->isWhite = %d", subData->isWhite);
-
-        if (subData->isWhite)
-        {
-            if(subData->messageObId != 0)
-            {
-                if (msg->topic && (msg->topic)[0] != '\0')
-                {
-                    NS_LOG_V(DEBUG, "this is topic message: %s", msg->topic);
+        NS_LOG_V(DEBUG, "this is topic message: %s", msg->topic);
+        topicName = msg->topic;
+    }
 
-                    if (NSProviderIsTopicSubScribed(consumerTopicList->head, subData->id, msg->topic))
-                    {
-                        obArray[obCount++] = subData->messageObId;
-                    }
-                }
-                else
-                {
-                    obArray[obCount++] = subData->messageObId;
-                }
-            }
-        }
-        it = it->next;
+    if (NSProviderGetObservationIds(consumerSubList, consumerTopicList, topicName, false,
+            &obArray, &obCount) != NS_OK)
+    {
+        NS_LOG(ERROR, "fail to collect message observers");
+        OCRepPayloadDestroy(payload);
+        msg->extraInfo = NULL;
+        return NS_ERROR;
     }
 
     for (size_t i = 0; i < obCount; ++i)
@@ -193,8 +178,9 @@ NSResult NSSendNotification(NSMessage *msg)
         return NS_ERROR;
     }
 
-    OCStackResult ocstackResult = OCNotifyListOfObservers(rHandle, obArray, obCount, payload,
-            OC_LOW_QOS);
+    OCStackResult ocstackResult = OCNotifyListOfObservers(rHandle, obArray,
+            (uint8_t) obCount, payload, OC_LOW_QOS);
+    NSOICFree(obArray);
 
     NS_LOG_V(DEBUG, "Message ocstackResult = %d", ocstackResult);
 
@@ -217,7 +203,7 @@ NSResult NSSendSync(NSSyncInfo *sync)
 {
     NS_LOG(DEBUG, "NSSendSync - IN");
 
-    OCObservationId obArray[255] = { 0, };
+    OCObservationId * obArray = NULL;
     size_t obCount = 0;
 
     OCResourceHandle rHandle = NULL;
@@ -227,26 +213,6 @@ NSResult NSSendSync(NSSyncInfo *sync)
         return NS_ERROR;
     }
 
-    NSCacheElement * it = consumerSubList->head;
-
-    while (it)
-    {
-        NSCacheSubData * subData = (NSCacheSubData *) it->data;
-        NS_LOG_V(INFO_PRIVATE, "sync subData->id = %s", subData->id);
-        NS_LOG_V(DEBUG, "subData->messageId = %d", subData->messageObId);
-        NS_LOG_V(DEBUG, "subData->syncId = %d", subData->syncObId);
-        NS_LOG_V(DEBUG, "subData->isWhite = %d", subData->isWhite);
-
-        if (subData->isWhite)
-        {
-            if (subData->syncObId != 0)
-            {
-                obArray[obCount++] = subData->syncObId;
-            }
-        }
-        it = it->next;
-    }
-
     OCRepPayload* payload = NULL;
     if (NSSetSyncPayload(sync, &payload) != NS_OK)
     {
@@ -254,6 +220,14 @@ NSResult NSSendSync(NSSyncInfo *sync)
         return NS_ERROR;
     }
 
+    if (NSProviderGetObservationIds(consumerSubList, NULL, NULL, true,
+            &obArray, &obCount) != NS_OK)
+    {
+        NS_LOG(ERROR, "fail to collect sync observers");
+        OCRepPayloadDestroy(payload);
+        return NS_ERROR;
+    }
+
 #ifdef WITH_MQ
     if (NSGetMQServerInfo())
     {
@@ -282,7 +256,8 @@ NSResult NSSendSync(NSSyncInfo *sync)
     }
 
     OCStackResult ocstackResult = OCNotifyListOfObservers(rHandle, obArray,
-            obCount, payload, OC_LOW_QOS);
+            (uint8_t) obCount, payload, OC_LOW_QOS);
+    NSOICFree(obArray);
 
     NS_LOG_V(DEBUG, "Sync ocstackResult = %d", ocstackResult);
     if (ocstackResult != OC_STACK_OK)
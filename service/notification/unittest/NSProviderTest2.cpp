@@ -512,6 +512,87 @@ TEST(NotificationProviderTest, ExpectFailUnsetConsumerTopics)
     EXPECT_EQ(result, NS_FAIL);
 }
 
+TEST(NotificationProviderTest, ExpectObservationIdsOfTopicSubscribers)
+{
+    // Observation ids are unique uint8_t values, which bounds the number of consumers.
+    const size_t numOfConsumers = 200;
+    const char * topicName = "OCF_TOPIC_FANOUT";
+
+    NSCacheList * subList = NSProviderStorageCreate();
+    NSCacheList * topicList = NSProviderStorageCreate();
+    ASSERT_NE((void *)NULL, subList);
+    ASSERT_NE((void *)NULL, topicList);
+    subList->cacheType = NS_PROVIDER_CACHE_SUBSCRIBER;
+    topicList->cacheType = NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME;
+
+    for (size_t i = 0; i < numOfConsumers; ++i)
+    {
+        NSCacheSubData * subData = (NSCacheSubData *) OICCalloc(1, sizeof(NSCacheSubData));
+        snprintf(subData->id, sizeof(subData->id), "consumer-%zu", i);
+        subData->messageObId = (int) i + 1;
+        subData->syncObId = (int) i + 1;
+        subData->isWhite = true;
+
+        NSCacheElement * element = (NSCacheElement *) OICCalloc(1, sizeof(NSCacheElement));
+        element->data = (NSCacheData *) subData;
+        if (subList->head)
+        {
+            subList->tail->next = element;
+        }
+        else
+        {
+            subList->head = element;
+        }
+        subList->tail = element;
+
+        if (i % 2 == 0)
+        {
+            NSCacheTopicSubData * topicData =
+                    (NSCacheTopicSubData *) OICCalloc(1, sizeof(NSCacheTopicSubData));
+            OICStrcpy(topicData->id, sizeof(topicData->id), subData->id);
+            topicData->topicName = OICStrdup(topicName);
+
+            element = (NSCacheElement *) OICCalloc(1, sizeof(NSCacheElement));
+            element->data = (NSCacheData *) topicData;
+            if (topicList->head)
+            {
+                topicList->tail->next = element;
+            }
+            else
+            {
+                topicList->head = element;
+            }
+            topicList->tail = element;
+        }
+    }
+
+    OCObservationId * obIds = NULL;
+    size_t obCount = 0;
+
+    EXPECT_EQ(NS_OK, NSProviderGetObservationIds(subList, topicList, NULL, false,
+            &obIds, &obCount));
+    EXPECT_EQ(numOfConsumers, obCount);
+    OICFree(obIds);
+
+    EXPECT_EQ(NS_OK, NSProviderGetObservationIds(subList, topicList, topicName, false,
+            &obIds, &obCount));
+    ASSERT_EQ(numOfConsumers / 2, obCount);
+    for (size_t i = 0; i < obCount; ++i)
+    {
+        // Only the even consumers subscribed to the topic.
+        EXPECT_EQ((OCObservationId) (2 * i + 1), obIds[i]);
+    }
+    OICFree(obIds);
+
+    EXPECT_EQ(NS_OK, NSProviderGetObservationIds(subList, topicList, "OCF_TOPIC_NONE", false,
+            &obIds, &obCount));
+    EXPECT_EQ((size_t) 0, obCount);
+    OICFree(obIds);
+
+    NSProviderStorageDestroy(subList);
+    NSProviderStorageDestroy(topicList);
+}
+
 TEST(NotificationProviderTest, ExpectSuccessUnsub)
 {
     OCEntityHandlerFlag flag = OC_OBSERVE_FLAG;
@@ -30,6 +30,7 @@
 #include <mutex>
 #include <thread>
 #include <map>
+#include <chrono>
 
 #include "RCSResourceAttributes.h"
 #include "RCSResponse.h"
@@ -47,6 +48,7 @@ namespace OIC
         class RCSRequest;
         class RCSRepresentation;
         class InterfaceHandler;
+        class NotifyCoalescer;
 
         /**
          * @brief Thrown when lock has not been acquired.
@@ -126,7 +128,34 @@ namespace OIC
             {
                 NEVER,  /**< Never*/
                 ALWAYS, /**< Always*/
-                UPDATED /**< Only when attributes are changed*/
+                UPDATED, /**< Only when attributes are changed*/
+                COALESCED /**< When attributes are changed, merging changes in one
+                               notification as set by CoalescedNotifyParams*/
+            };
+
+            /**
+             * Parameters of AutoNotifyPolicy::COALESCED, similar to the pmin and st
+             * conditional observe attributes of CoRE.
+             *
+             * A change is notified after maxBatchDelay, but not sooner than minInterval after
+             * the previous notification. Changes made in the meantime are sent in the same
+             * notification.
+             *
+             * @see RCSResourceObject::setCoalescedNotifyParams
+             */
+            struct CoalescedNotifyParams
+            {
+                /** Minimum time between two notifications.*/
+                std::chrono::milliseconds minInterval{ 0 };
+
+                /** Time a change waits for further changes before it is notified.*/
+                std::chrono::milliseconds maxBatchDelay{ 0 };
+
+                /**
+                 * Minimum change of a numeric attribute, from its last notified value, to be
+                 * notified. A change of any other attribute is always notified.
+                 */
+                std::unordered_map< std::string, double > thresholds;
             };
 
             /**
@@ -486,6 +515,22 @@ namespace OIC
              */
             AutoNotifyPolicy getAutoNotifyPolicy() const;
 
+            /**
+             * Sets the parameters used when auto notify policy is AutoNotifyPolicy::COALESCED.
+             *
+             * @param params parameters to be set
+             *
+             * @throws RCSInvalidParameterException If a time or threshold is negative.
+             *
+             */
+            void setCoalescedNotifyParams(CoalescedNotifyParams params);
+
+            /**
+             * Returns the current parameters of AutoNotifyPolicy::COALESCED.
+             *
+             */
+            CoalescedNotifyParams getCoalescedNotifyParams() const;
+
             /**
              * Sets the policy for handling a set request.
              *
@@ -633,6 +678,8 @@ namespace OIC
 
             std::map< std::string, InterfaceHandler > m_interfaceHandlers;
 
+            std::shared_ptr< NotifyCoalescer > m_notifyCoalescer;
+
             friend class RCSSeparateResponse;
         };
 
@@ -20,6 +20,9 @@
 
 #include "ExpiryTimerImpl.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "RCSException.h"
 
 namespace OIC
@@ -30,17 +33,36 @@ namespace OIC
         namespace
         {
             constexpr ExpiryTimerImpl::Id INVALID_ID{ 0U };
+
+            constexpr std::chrono::milliseconds TICK{ 10 };
+            constexpr size_t WHEEL_SIZE{ 512 };
+            constexpr size_t NUM_OF_EXECUTORS{ 4 };
         }
 
+        const size_t ExpiryTimerImpl::MAX_NUM_OF_EXECUTORS;
+
         ExpiryTimerImpl::ExpiryTimerImpl() :
-                m_tasks{ },
+                m_startTime{ std::chrono::steady_clock::now() },
+                m_wheel(WHEEL_SIZE),
+                m_entries{ },
+                m_currentTick{ 0 },
+                m_lastId{ INVALID_ID },
                 m_thread{ },
                 m_mutex{ },
                 m_cond{ },
                 m_stop{ false },
-                m_mt{ std::random_device{ }() },
-                m_dist{ }
+                m_executors{ },
+                m_expired{ },
+                m_expiredMutex{ },
+                m_expiredCond{ },
+                m_idleExecutors{ 0 },
+                m_stopExecutors{ false }
         {
+            for (size_t i = 0; i < NUM_OF_EXECUTORS; ++i)
+            {
+                ++m_idleExecutors;
+                m_executors.emplace_back(&ExpiryTimerImpl::runExecutor, this);
+            }
             m_thread = std::thread(&ExpiryTimerImpl::run, this);
         }
 
@@ -48,11 +70,26 @@ namespace OIC
         {
             {
                 std::lock_guard< std::mutex > lock{ m_mutex };
-                m_tasks.clear();
+                m_entries.clear();
+                for (auto& slot : m_wheel)
+                {
+                    slot.clear();
+                }
                 m_stop = true;
             }
             m_cond.notify_all();
             m_thread.join();
+
+            {
+                std::lock_guard< std::mutex > lock{ m_expiredMutex };
+                m_expired.clear();
+                m_stopExecutors = true;
+            }
+            m_expiredCond.notify_all();
+            for (auto& executor : m_executors)
+            {
+                executor.join();
+            }
         }
 
         ExpiryTimerImpl* ExpiryTimerImpl::getInstance()
@@ -73,7 +110,7 @@ namespace OIC
                 throw RCSInvalidParameterException{ "callback is empty." };
             }
 
-            return addTask(convertToTime(Milliseconds{ delay }), std::move(cb), generateId());
+            return addTask(Milliseconds{ delay }, std::move(cb));
         }
 
         bool ExpiryTimerImpl::cancel(Id id)
@@ -84,16 +121,7 @@ namespace OIC
             }
 
             std::lock_guard< std::mutex > lock{ m_mutex };
-
-            for(auto it = m_tasks.begin(); it != m_tasks.end(); ++it)
-            {
-                if(it->second->getId() == id)
-                {
-                    m_tasks.erase(it);
-                    return true;
-                }
-            }
-            return false;
+            return removeTask(id);
         }
 
         size_t ExpiryTimerImpl::cancelAll(
@@ -102,111 +130,187 @@ namespace OIC
             std::lock_guard< std::mutex > lock{ m_mutex };
             size_t erased { 0 };
 
-            for(auto it = m_tasks.begin(); it != m_tasks.end();)
+            for (const auto& task : tasks)
             {
-                if(tasks.count(it->second))
+                // Expired tasks have lost their id, so another task can't be cancelled here.
+                if (removeTask(task->getId()))
                 {
-                    it = m_tasks.erase(it);
                     ++erased;
                 }
-                else
-                {
-                    ++it;
-                }
             }
             return erased;
         }
 
-        ExpiryTimerImpl::Milliseconds ExpiryTimerImpl::convertToTime(Milliseconds delay)
+        ExpiryTimerImpl::Tick ExpiryTimerImpl::currentTick() const
         {
-            const auto now = std::chrono::system_clock::now();
-            return std::chrono::duration_cast< Milliseconds >(now.time_since_epoch()) + delay;
+            return std::chrono::duration_cast< Milliseconds >(
+                    std::chrono::steady_clock::now() - m_startTime).count() / TICK.count();
         }
 
-        std::shared_ptr< TimerTask > ExpiryTimerImpl::addTask(
-                Milliseconds delay, Callback cb, Id id)
+        std::shared_ptr< TimerTask > ExpiryTimerImpl::addTask(Milliseconds delay, Callback cb)
         {
             std::lock_guard< std::mutex > lock{ m_mutex };
 
-            auto newTask = std::make_shared< TimerTask >(id, std::move(cb));
-            m_tasks.insert({ delay, newTask });
+            const auto elapsed = std::chrono::steady_clock::now() - m_startTime;
+            if (m_entries.empty())
+            {
+                // The wheel is not advanced while it is empty.
+                m_currentTick = elapsed / TICK;
+            }
+
+            // Round up so that a task never expires early, and never put a task in a slot
+            // that was already visited.
+            Tick expiryTick = (elapsed + delay + TICK - std::chrono::nanoseconds{ 1 }) / TICK;
+            if (expiryTick <= m_currentTick)
+            {
+                expiryTick = m_currentTick + 1;
+            }
+
+            auto newTask = std::make_shared< TimerTask >(generateId(), std::move(cb));
+            auto& slot = m_wheel[expiryTick % WHEEL_SIZE];
+            m_entries[newTask->getId()] = slot.insert(slot.end(), Entry{ expiryTick, newTask });
+
             m_cond.notify_all();
 
             return newTask;
         }
 
-        bool ExpiryTimerImpl::containsId(Id id) const
+        bool ExpiryTimerImpl::removeTask(Id id)
         {
-            for (const auto& info : m_tasks)
+            auto it = m_entries.find(id);
+            if (it == m_entries.end())
             {
-                if (info.second->getId() == id)
-                {
-                    return true;
-                }
+                return false;
             }
-            return false;
+
+            m_wheel[it->second->expiryTick % WHEEL_SIZE].erase(it->second);
+            m_entries.erase(it);
+            return true;
         }
 
         ExpiryTimerImpl::Id ExpiryTimerImpl::generateId()
         {
-            Id newId = m_dist(m_mt);
-
-            std::lock_guard< std::mutex > lock{ m_mutex };
-
-            while (newId == INVALID_ID || containsId(newId))
+            do
             {
-                newId = m_dist(m_mt);
+                ++m_lastId;
             }
-            return newId;
+            while (m_lastId == INVALID_ID || m_entries.count(m_lastId));
+
+            return m_lastId;
         }
 
-        void ExpiryTimerImpl::executeExpired()
+        void ExpiryTimerImpl::executeExpired(Tick tick)
         {
-            if (m_tasks.empty())
+            auto& slot = m_wheel[tick % WHEEL_SIZE];
+
+            for (auto it = slot.begin(); it != slot.end();)
             {
-                return;
+                // Tasks due in a later turn of the wheel share the slot.
+                if (it->expiryTick > tick)
+                {
+                    ++it;
+                    continue;
+                }
+
+                const Id id{ it->task->getId() };
+                auto callback = it->task->expire();
+                m_entries.erase(id);
+                it = slot.erase(it);
+
+                std::lock_guard< std::mutex > lock{ m_expiredMutex };
+                queueExpired(std::move(callback), id);
             }
+        }
 
-            auto now = std::chrono::system_clock::now().time_since_epoch();
+        void ExpiryTimerImpl::queueExpired(Callback callback, Id id)
+        {
+            m_expired.emplace_back(std::move(callback), id);
 
-            auto it = m_tasks.begin();
-            for (; it != m_tasks.end() && it->first <= now; ++it)
+            // Every executor is busy, possibly blocked in a callback.
+            if (m_expired.size() > m_idleExecutors && m_executors.size() < MAX_NUM_OF_EXECUTORS)
             {
-                it->second->execute();
+                ++m_idleExecutors;
+                m_executors.emplace_back(&ExpiryTimerImpl::runExecutor, this);
             }
-
-            m_tasks.erase(m_tasks.begin(), it);
+            m_expiredCond.notify_one();
         }
 
-        ExpiryTimerImpl::Milliseconds ExpiryTimerImpl::remainingTimeForNext() const
+        ExpiryTimerImpl::Tick ExpiryTimerImpl::nextExpiryTick() const
         {
-            const Milliseconds& expiredTime = m_tasks.begin()->first;
+            Tick earliest{ std::numeric_limits< Tick >::max() };
 
-            return std::chrono::duration_cast< Milliseconds >(expiredTime -
-                    std::chrono::system_clock::now().time_since_epoch()) + Milliseconds{ 1 };
+            // Every task is in one of the slots of the next turn of the wheel.
+            for (Tick tick = m_currentTick + 1; tick <= m_currentTick + Tick(WHEEL_SIZE); ++tick)
+            {
+                for (const auto& entry : m_wheel[tick % WHEEL_SIZE])
+                {
+                    if (entry.expiryTick == tick)
+                    {
+                        return tick;
+                    }
+                    earliest = std::min(earliest, entry.expiryTick);
+                }
+            }
+            return earliest;
         }
 
         void ExpiryTimerImpl::run()
         {
-            auto hasTaskOrStop = [this]()
-            {
-                return !m_tasks.empty() || m_stop;
-            };
-
             std::unique_lock< std::mutex > lock{ m_mutex };
 
-            while(!m_stop)
+            while (!m_stop)
             {
-                m_cond.wait(lock, hasTaskOrStop);
+                if (m_entries.empty())
+                {
+                    m_cond.wait(lock);
+                    continue;
+                }
 
-                if (m_stop)
+                const Tick now{ currentTick() };
+                Tick next{ nextExpiryTick() };
+                while (next <= now)
                 {
-                    break;
+                    m_currentTick = next;
+                    executeExpired(next);
+                    if (m_entries.empty())
+                    {
+                        break;
+                    }
+                    next = nextExpiryTick();
                 }
 
-                m_cond.wait_for(lock, remainingTimeForNext());
+                if (m_entries.empty())
+                {
+                    continue;
+                }
 
-                executeExpired();
+                // No task is due before next, so the slots up to now need not be visited.
+                m_currentTick = now;
+                m_cond.wait_until(lock, m_startTime + TICK * next);
+            }
+        }
+
+        void ExpiryTimerImpl::runExecutor()
+        {
+            std::unique_lock< std::mutex > lock{ m_expiredMutex };
+
+            while (!m_stopExecutors)
+            {
+                if (m_expired.empty())
+                {
+                    m_expiredCond.wait(lock);
+                    continue;
+                }
+
+                auto expired = std::move(m_expired.front());
+                m_expired.pop_front();
+                --m_idleExecutors;
+
+                lock.unlock();
+                expired.first(expired.second);
+                lock.lock();
+
+                ++m_idleExecutors;
             }
         }
 
@@ -217,19 +321,13 @@ namespace OIC
         {
         }
 
-        void TimerTask::execute()
+        ExpiryTimerImpl::Callback TimerTask::expire()
         {
-            if (isExecuted())
-            {
-                return;
-            }
-
-            ExpiryTimerImpl::Id id { m_id };
             m_id = INVALID_ID;
 
-            std::thread(std::move(m_callback), id).detach();
-
+            ExpiryTimerImpl::Callback callback{ std::move(m_callback) };
             m_callback = ExpiryTimerImpl::Callback{ };
+            return callback;
         }
 
         bool TimerTask::isExecuted() const
@@ -22,12 +22,14 @@
 #define _EXPIRY_TIMER_IMPL_H_
 
 #include <functional>
-#include <map>
+#include <list>
+#include <vector>
+#include <deque>
+#include <unordered_map>
 #include <mutex>
 #include <thread>
 #include <chrono>
 #include <condition_variable>
-#include <random>
 #include <unordered_set>
 #include <atomic>
 
@@ -37,6 +39,15 @@ namespace OIC
     {
         class TimerTask;
 
+        /**
+         * Timer shared by all ExpiryTimer instances.
+         *
+         * Tasks are kept in a hashed timer wheel advanced by a single thread, so posting and
+         * cancelling a task take constant time. The thread sleeps until the next task expires.
+         * Expired callbacks are run by a pool of executor threads. While all of them are busy,
+         * for instance in callbacks which block, the pool grows up to MAX_NUM_OF_EXECUTORS; past
+         * that, expired callbacks wait for an executor.
+         */
         class ExpiryTimerImpl
         {
         public:
@@ -45,8 +56,19 @@ namespace OIC
 
             typedef long long DelayInMillis;
 
+            static const size_t MAX_NUM_OF_EXECUTORS = 16;
+
         private:
             typedef std::chrono::milliseconds Milliseconds;
+            typedef long long Tick;
+
+            struct Entry
+            {
+                Tick expiryTick;
+                std::shared_ptr< TimerTask > task;
+            };
+
+            typedef std::list< Entry > Slot;
 
         private:
             ExpiryTimerImpl();
@@ -64,39 +86,59 @@ namespace OIC
             size_t cancelAll(const std::unordered_set< std::shared_ptr<TimerTask > >&);
 
         private:
-            static Milliseconds convertToTime(Milliseconds);
+            Tick currentTick() const;
+
+            std::shared_ptr< TimerTask > addTask(Milliseconds, Callback);
 
-            std::shared_ptr< TimerTask > addTask(Milliseconds, Callback, Id);
+            /**
+             * @pre The lock must be acquired with m_mutex.
+             */
+            bool removeTask(Id);
 
             /**
              * @pre The lock must be acquired with m_mutex.
              */
-            bool containsId(Id) const;
             Id generateId();
 
             /**
              * @pre The lock must be acquired with m_mutex.
              */
-            void executeExpired();
+            void executeExpired(Tick);
 
             /**
+             * Returns the tick of the earliest task, which must exist.
+             *
              * @pre The lock must be acquired with m_mutex.
              */
-            Milliseconds remainingTimeForNext() const;
+            Tick nextExpiryTick() const;
 
             void run();
+            void runExecutor();
+
+            /**
+             * @pre The lock must be acquired with m_expiredMutex.
+             */
+            void queueExpired(Callback, Id);
 
         private:
-            std::multimap< Milliseconds, std::shared_ptr< TimerTask > > m_tasks;
+            const std::chrono::steady_clock::time_point m_startTime;
+
+            std::vector< Slot > m_wheel;
+            std::unordered_map< Id, Slot::iterator > m_entries;
+            Tick m_currentTick;
+            Id m_lastId;
 
             std::thread m_thread;
             std::mutex m_mutex;
             std::condition_variable m_cond;
             bool m_stop;
 
-            std::mt19937 m_mt;
-            std::uniform_int_distribution< Id > m_dist;
-
+            std::vector< std::thread > m_executors;
+            std::deque< std::pair< Callback, Id > > m_expired;
+            std::mutex m_expiredMutex;
+            std::condition_variable m_expiredCond;
+            size_t m_idleExecutors;
+            bool m_stopExecutors;
         };
 
         class TimerTask
@@ -114,7 +156,10 @@ namespace OIC
             ExpiryTimerImpl::Id getId() const;
 
         private:
-            void execute();
+            /**
+             * Marks the task executed and hands over its callback.
+             */
+            ExpiryTimerImpl::Callback expire();
 
         private:
             std::atomic< ExpiryTimerImpl::Id > m_id;
@@ -22,6 +22,7 @@
 
 #include <mutex>
 #include <atomic>
+#include <thread>
 
 #include "RCSException.h"
 #include "ExpiryTimer.h"
@@ -186,6 +187,103 @@ TEST_F(ExpiryTimerImplTest, CallbackBeInvokedWithinToleranceWithMultiplePost)
     ASSERT_EQ(NUM_OF_POST, called);
 }
 
+TEST_F(ExpiryTimerImplTest, CallbackIsNotInvokedBeforeDelay)
+{
+    std::atomic_bool called{ false };
+
+    ExpiryTimerImpl::getInstance()->post(100,
+            [&called](ExpiryTimerImpl::Id)
+            {
+                called = true;
+            });
+
+    Wait(TOLERANCE_IN_MILLIS);
+    ASSERT_FALSE(called);
+
+    Wait(100 + TOLERANCE_IN_MILLIS);
+    ASSERT_TRUE(called);
+}
+
+TEST_F(ExpiryTimerImplTest, BlockingCallbackDoesNotDelayOtherTasks)
+{
+    std::atomic_bool called{ false };
+    std::atomic_bool released{ false };
+    std::atomic_bool finished{ false };
+
+    ExpiryTimerImpl::getInstance()->post(1,
+            [&released, &finished](ExpiryTimerImpl::Id)
+            {
+                while (!released)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds{ 5 });
+                }
+                finished = true;
+            });
+
+    ExpiryTimerImpl::getInstance()->post(10,
+            [this, &called](ExpiryTimerImpl::Id)
+            {
+                called = true;
+                Proceed();
+            });
+
+    Wait(TOLERANCE_IN_MILLIS * 2);
+    const bool calledWhileBlocked{ called };
+    released = true;
+
+    while (!finished)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 5 });
+    }
+    ASSERT_TRUE(calledWhileBlocked);
+}
+
+TEST_F(ExpiryTimerImplTest, ExecutorsAreBoundedWhileAllAreBlocked)
+{
+    constexpr int NUM_OF_BLOCKING_TASKS{ ExpiryTimerImpl::MAX_NUM_OF_EXECUTORS + 4 };
+    std::atomic_bool called{ false };
+    std::atomic_bool released{ false };
+    std::atomic_int blocking{ 0 };
+    std::atomic_int finished{ 0 };
+
+    for (int i = 0; i < NUM_OF_BLOCKING_TASKS; ++i)
+    {
+        ExpiryTimerImpl::getInstance()->post(1,
+                [&released, &blocking, &finished](ExpiryTimerImpl::Id)
+                {
+                    ++blocking;
+                    while (!released)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{ 5 });
+                    }
+                    --blocking;
+                    ++finished;
+                });
+    }
+
+    ExpiryTimerImpl::getInstance()->post(20,
+            [this, &called](ExpiryTimerImpl::Id)
+            {
+                called = true;
+                Proceed();
+            });
+
+    Wait(TOLERANCE_IN_MILLIS * 2);
+    const int blockedExecutors{ blocking };
+    const bool calledWhileBlocked{ called };
+    released = true;
+
+    while (finished < NUM_OF_BLOCKING_TASKS || !called)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 5 });
+    }
+
+    // The pool grew past its initial size but no further than its bound, so the remaining
+    // callbacks waited for an executor instead of getting threads of their own.
+    ASSERT_EQ(static_cast< int >(ExpiryTimerImpl::MAX_NUM_OF_EXECUTORS), blockedExecutors);
+    ASSERT_FALSE(calledWhileBlocked);
+}
+
 class ExpiryTimerTest: public TestWithMock
 {
 public:
@@ -0,0 +1,94 @@
+//******************************************************************
+//
+// Copyright 2015 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef RE_NOTIFYCOALESCER_H_
+#define RE_NOTIFYCOALESCER_H_
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "ExpiryTimer.h"
+#include "RCSResourceObject.h"
+
+namespace OIC
+{
+    namespace Service
+    {
+        /**
+         * Decides when observers of a resource are notified under
+         * RCSResourceObject::AutoNotifyPolicy::COALESCED and posts the delayed notifications.
+         */
+        class NotifyCoalescer: public std::enable_shared_from_this< NotifyCoalescer >
+        {
+        public:
+            typedef RCSResourceObject::CoalescedNotifyParams Params;
+            typedef std::function< RCSResourceAttributes() > AttributesGetter;
+            typedef std::function< void() > Notifier;
+
+        public:
+            NotifyCoalescer(AttributesGetter, Notifier);
+
+            NotifyCoalescer(const NotifyCoalescer&) = delete;
+            NotifyCoalescer& operator=(const NotifyCoalescer&) = delete;
+
+            void setParams(Params);
+            Params getParams() const;
+
+            /**
+             * Records a change of the attributes. Must be called with the attributes locked.
+             *
+             * @return true if the caller has to notify observers right away. Otherwise the
+             *         change is notified later or not at all if it is below the thresholds.
+             */
+            bool onChanged(const RCSResourceAttributes& attrs);
+
+            /**
+             * Cancels pending notifications and waits for one in progress. The getter and the
+             * notifier are not called any more.
+             */
+            void stop();
+
+        private:
+            bool isSignificant(const RCSResourceAttributes&) const;
+            void onExpired(ExpiryTimer::Id);
+
+        private:
+            const AttributesGetter m_attributesGetter;
+            const Notifier m_notifier;
+
+            mutable std::mutex m_mutex;
+            Params m_params;
+
+            bool m_hasNotified;
+            std::chrono::steady_clock::time_point m_lastNotified;
+            RCSResourceAttributes m_notifiedAttributes;
+
+            bool m_isPending;
+            ExpiryTimer m_timer;
+
+            std::recursive_mutex m_notifyMutex;
+            bool m_isStopped;
+        };
+    }
+}
+
+#endif /* RE_NOTIFYCOALESCER_H_ */
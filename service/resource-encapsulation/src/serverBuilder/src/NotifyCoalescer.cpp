@@ -0,0 +1,217 @@
+//******************************************************************
+//
+// Copyright 2015 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "NotifyCoalescer.h"
+
+#include <cmath>
+
+#include "RCSException.h"
+#include "experimental/logger.h"
+
+#define LOG_TAG "NotifyCoalescer"
+
+namespace
+{
+    using namespace OIC::Service;
+
+    bool toNumber(const RCSResourceAttributes::Value& value, double& number)
+    {
+        switch (value.getType().getId())
+        {
+            case RCSResourceAttributes::TypeId::INT:
+                number = value.get< int >();
+                return true;
+
+            case RCSResourceAttributes::TypeId::DOUBLE:
+                number = value.get< double >();
+                return true;
+
+            default:
+                return false;
+        }
+    }
+}
+
+namespace OIC
+{
+    namespace Service
+    {
+
+        NotifyCoalescer::NotifyCoalescer(AttributesGetter attributesGetter, Notifier notifier) :
+                m_attributesGetter{ std::move(attributesGetter) },
+                m_notifier{ std::move(notifier) },
+                m_mutex{ },
+                m_params{ },
+                m_hasNotified{ false },
+                m_lastNotified{ },
+                m_notifiedAttributes{ },
+                m_isPending{ false },
+                m_timer{ },
+                m_notifyMutex{ },
+                m_isStopped{ false }
+        {
+        }
+
+        void NotifyCoalescer::setParams(Params params)
+        {
+            if (params.minInterval.count() < 0 || params.maxBatchDelay.count() < 0)
+            {
+                throw RCSInvalidParameterException{ "Notify interval can't be negative." };
+            }
+
+            for (const auto& threshold : params.thresholds)
+            {
+                if (threshold.second < 0)
+                {
+                    throw RCSInvalidParameterException{ "Notify threshold can't be negative." };
+                }
+            }
+
+            std::lock_guard< std::mutex > lock{ m_mutex };
+            m_params = std::move(params);
+        }
+
+        NotifyCoalescer::Params NotifyCoalescer::getParams() const
+        {
+            std::lock_guard< std::mutex > lock{ m_mutex };
+            return m_params;
+        }
+
+        bool NotifyCoalescer::onChanged(const RCSResourceAttributes& attrs)
+        {
+            std::lock_guard< std::mutex > lock{ m_mutex };
+
+            // Already scheduled; the notification will carry this change as well.
+            if (m_isPending || m_isStopped || !isSignificant(attrs))
+            {
+                return false;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            auto due = now + m_params.maxBatchDelay;
+            if (m_hasNotified && due < m_lastNotified + m_params.minInterval)
+            {
+                due = m_lastNotified + m_params.minInterval;
+            }
+
+            if (due <= now)
+            {
+                m_hasNotified = true;
+                m_lastNotified = now;
+                m_notifiedAttributes = attrs;
+                return true;
+            }
+
+            auto delay = std::chrono::duration_cast< std::chrono::milliseconds >(due - now);
+            std::weak_ptr< NotifyCoalescer > weakThis{ shared_from_this() };
+            m_timer.post(delay.count() + 1, [weakThis](ExpiryTimer::Id id)
+            {
+                if (auto coalescer = weakThis.lock())
+                {
+                    coalescer->onExpired(id);
+                }
+            });
+            m_isPending = true;
+
+            return false;
+        }
+
+        void NotifyCoalescer::stop()
+        {
+            std::lock_guard< std::recursive_mutex > notifyLock{ m_notifyMutex };
+            std::lock_guard< std::mutex > lock{ m_mutex };
+
+            m_isStopped = true;
+            m_isPending = false;
+            m_timer.cancelAll();
+        }
+
+        bool NotifyCoalescer::isSignificant(const RCSResourceAttributes& attrs) const
+        {
+            if (!m_hasNotified || attrs.size() != m_notifiedAttributes.size())
+            {
+                return true;
+            }
+
+            for (const auto& kv : attrs)
+            {
+                if (!m_notifiedAttributes.contains(kv.key()))
+                {
+                    return true;
+                }
+
+                const auto& notifiedValue = m_notifiedAttributes.at(kv.key());
+                auto threshold = m_params.thresholds.find(kv.key());
+
+                double number = 0;
+                double notifiedNumber = 0;
+                if (threshold != m_params.thresholds.end() && toNumber(kv.value(), number)
+                        && toNumber(notifiedValue, notifiedNumber))
+                {
+                    if (std::fabs(number - notifiedNumber) >= threshold->second)
+                    {
+                        return true;
+                    }
+                }
+                else if (kv.value() != notifiedValue)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void NotifyCoalescer::onExpired(ExpiryTimer::Id)
+        {
+            std::lock_guard< std::recursive_mutex > notifyLock{ m_notifyMutex };
+
+            {
+                std::lock_guard< std::mutex > lock{ m_mutex };
+                if (m_isStopped || !m_isPending)
+                {
+                    return;
+                }
+            }
+
+            // The attributes are locked by the getter, which must not be done under m_mutex
+            // as onChanged is called with the attributes locked.
+            auto attrs = m_attributesGetter();
+
+            {
+                std::lock_guard< std::mutex > lock{ m_mutex };
+                m_isPending = false;
+                m_hasNotified = true;
+                m_lastNotified = std::chrono::steady_clock::now();
+                m_notifiedAttributes = std::move(attrs);
+            }
+
+            try
+            {
+                m_notifier();
+            }
+            catch (const RCSException& e)
+            {
+                OIC_LOG_V(WARNING, LOG_TAG, "Failed to notify : %s", e.what());
+            }
+        }
+
+    }
+}
@@ -30,6 +30,7 @@
 #include "RCSRequest.h"
 #include "RCSRepresentation.h"
 #include "InterfaceHandler.h"
+#include "NotifyCoalescer.h"
 
 #include "experimental/logger.h"
 #include "OCPlatform.h"
@@ -104,7 +105,8 @@ namespace
             const RCSResourceAttributes& resourceAttributes,
             RCSResourceObject::AutoNotifyPolicy autoNotifyPolicy)
     {
-        if(autoNotifyPolicy == RCSResourceObject::AutoNotifyPolicy::UPDATED)
+        if(autoNotifyPolicy == RCSResourceObject::AutoNotifyPolicy::UPDATED ||
+                autoNotifyPolicy == RCSResourceObject::AutoNotifyPolicy::COALESCED)
         {
             auto&& compareAttributesFunc =
                     std::bind(std::not_equal_to<RCSResourceAttributes>(),
@@ -269,9 +271,18 @@ namespace OIC
                 m_attributeUpdatedListeners{ },
                 m_lockOwner{ },
                 m_mutex{ },
-                m_mutexAttributeUpdatedListeners{ }
+                m_mutexAttributeUpdatedListeners{ },
+                m_notifyCoalescer{ }
         {
             m_lockOwner.reset(new AtomicThreadId);
+
+            m_notifyCoalescer = std::make_shared< NotifyCoalescer >(
+                    [this]()
+                    {
+                        WeakGuard lock(*this);
+                        return m_resourceAttributes;
+                    },
+                    std::bind(&RCSResourceObject::notify, this));
         }
 
         void RCSResourceObject::init(OCResourceHandle handle,
@@ -293,6 +304,8 @@ namespace OIC
 
         RCSResourceObject::~RCSResourceObject()
         {
+            m_notifyCoalescer->stop();
+
             if (m_resourceHandle)
             {
                 try
@@ -489,6 +502,16 @@ namespace OIC
             return m_autoNotifyPolicy;
         }
 
+        void RCSResourceObject::setCoalescedNotifyParams(CoalescedNotifyParams params)
+        {
+            m_notifyCoalescer->setParams(std::move(params));
+        }
+
+        auto RCSResourceObject::getCoalescedNotifyParams() const -> CoalescedNotifyParams
+        {
+            return m_notifyCoalescer->getParams();
+        }
+
         void RCSResourceObject::setSetRequestHandlerPolicy(SetRequestHandlerPolicy policy)
         {
             m_setRequestHandlerPolicy = policy;
@@ -589,12 +612,22 @@ namespace OIC
                 return;
             }
 
-            if(autoNotifyPolicy == AutoNotifyPolicy::UPDATED &&
+            if((autoNotifyPolicy == AutoNotifyPolicy::UPDATED ||
+                    autoNotifyPolicy == AutoNotifyPolicy::COALESCED) &&
                     isAttributesChanged == false)
             {
                 return;
             }
 
+            if(autoNotifyPolicy == AutoNotifyPolicy::COALESCED)
+            {
+                WeakGuard lock(*this);
+                if (!m_notifyCoalescer->onChanged(m_resourceAttributes))
+                {
+                    return;
+                }
+            }
+
             notify();
         }
 
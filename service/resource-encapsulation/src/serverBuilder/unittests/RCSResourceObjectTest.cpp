@@ -18,6 +18,10 @@
 //
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "UnitTestHelperWithFakeOCPlatform.h"
@@ -357,6 +361,88 @@ TEST_F(AutoNotifyTest, WithUpdatePolicy_WillBeNotifiedIfAttributeIsDeleted)
     server->removeAttribute(KEY);
 }
 
+TEST_F(AutoNotifyTest, CoalescedNotifyParamsCanBeSet)
+{
+    RCSResourceObject::CoalescedNotifyParams params;
+    params.minInterval = std::chrono::milliseconds{ 100 };
+    params.thresholds[KEY] = 10;
+
+    server->setCoalescedNotifyParams(params);
+
+    ASSERT_EQ(params.minInterval, server->getCoalescedNotifyParams().minInterval);
+    ASSERT_EQ(params.thresholds, server->getCoalescedNotifyParams().thresholds);
+}
+
+TEST_F(AutoNotifyTest, ThrowIfCoalescedNotifyIntervalIsNegative)
+{
+    RCSResourceObject::CoalescedNotifyParams params;
+    params.minInterval = std::chrono::milliseconds{ -1 };
+
+    ASSERT_THROW(server->setCoalescedNotifyParams(params), RCSInvalidParameterException);
+}
+
+TEST_F(AutoNotifyTest, WithCoalescedPolicy_NeverBeNotifiedIfChangeIsBelowThreshold)
+{
+    RCSResourceObject::CoalescedNotifyParams params;
+    params.thresholds[KEY] = 10;
+    server->setCoalescedNotifyParams(params);
+    server->setAutoNotifyPolicy(RCSResourceObject::AutoNotifyPolicy::COALESCED);
+    server->setAttribute(KEY, VALUE);
+
+    mocks.NeverCall(
+            mockFakePlatform, FakeOCPlatform::notifyAllObservers);
+
+    server->setAttribute(KEY, VALUE + 5);
+}
+
+TEST_F(AutoNotifyTest, WithCoalescedPolicy_WillBeNotifiedIfChangeReachesThreshold)
+{
+    RCSResourceObject::CoalescedNotifyParams params;
+    params.thresholds[KEY] = 10;
+    server->setCoalescedNotifyParams(params);
+    server->setAutoNotifyPolicy(RCSResourceObject::AutoNotifyPolicy::COALESCED);
+    server->setAttribute(KEY, VALUE);
+    server->setAttribute(KEY, VALUE + 5);
+
+    mocks.ExpectCall(
+            mockFakePlatform, FakeOCPlatform::notifyAllObservers)
+                    .Return(OC_STACK_OK);
+
+    server->setAttribute(KEY, VALUE + 10);
+}
+
+TEST_F(AutoNotifyTest, WithCoalescedPolicy_ChangesWithinIntervalAreNotifiedOnce)
+{
+    std::atomic_int numNotified{ 0 };
+    mocks.OnCall(
+            mockFakePlatform, FakeOCPlatform::notifyAllObservers).Do(
+                    [&numNotified](OCResourceHandle)
+                    {
+                        ++numNotified;
+                        return OC_STACK_OK;
+                    });
+
+    RCSResourceObject::CoalescedNotifyParams params;
+    params.minInterval = std::chrono::milliseconds{ 100 };
+    server->setCoalescedNotifyParams(params);
+    server->setAutoNotifyPolicy(RCSResourceObject::AutoNotifyPolicy::COALESCED);
+
+    server->setAttribute(KEY, VALUE);
+    ASSERT_EQ(1, numNotified.load());
+
+    server->setAttribute(KEY, VALUE + 1);
+    server->setAttribute(KEY, VALUE + 2);
+    ASSERT_EQ(1, numNotified.load());
+
+    for (int i = 0; i < 100 && numNotified < 2; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 200 });
+
+    ASSERT_EQ(2, numNotified.load());
+}
+
 class AutoNotifyWithGuardTest: public AutoNotifyTest
 {
 };
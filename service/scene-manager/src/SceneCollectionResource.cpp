@@ -20,10 +20,14 @@
 
 #include "SceneCollectionResource.h"
 
+#include <algorithm>
 #include <atomic>
 #include "OCApi.h"
 #include "RCSRequest.h"
 #include "RCSSeparateResponse.h"
+#include "experimental/logger.h"
+
+#define TAG "SceneCollectionResource"
 
 namespace OIC
 {
@@ -189,18 +193,111 @@ namespace OIC
             m_sceneCollectionResourceObject->setAttribute(
                     SCENE_KEY_LAST_SCENE, sceneName);
 
+            auto members = getExecutionOrder(sceneName);
+            if (members.empty())
             {
-                std::lock_guard<std::mutex> memberlock(m_sceneMemberLock);
-                auto executeHandler
-                    = SceneExecuteResponseHandler::createExecuteHandler(
-                            shared_from_this(), std::move(executeCB));
-                for (auto & it : m_sceneMembers)
+                if (executeCB)
                 {
-                    it->execute(std::move(sceneName), std::bind(
+                    std::thread(std::move(executeCB), SCENE_RESPONSE_SUCCESS).detach();
+                }
+                return;
+            }
+
+            auto executeHandler
+                = SceneExecuteResponseHandler::createExecuteHandler(
+                        shared_from_this(), sceneName, members.size(), std::move(executeCB));
+            for (auto & member : members)
+            {
+                try
+                {
+                    member->execute(sceneName, std::bind(
                             &SceneExecuteResponseHandler::onResponse, executeHandler,
                             std::placeholders::_1, std::placeholders::_2));
                 }
+                catch (const RCSException & e)
+                {
+                    OIC_LOG_V(ERROR, TAG, "Failed to execute %s on %s: %s", sceneName.c_str(),
+                            member->getTargetUri().c_str(), e.what());
+                    executeHandler->onResponse(RCSResourceAttributes(),
+                            SCENE_SERVER_INTERNALSERVERERROR);
+                }
+            }
+        }
+
+        std::vector<SceneMemberResource::Ptr> SceneCollectionResource::getExecutionOrder(
+                const std::string & sceneName) const
+        {
+            // The members of the scene are grouped by the device hosting their target resource.
+            // The first member of every device is sent before the second member of any device,
+            // so the devices switch at about the same time instead of one after the other.
+            std::vector<std::vector<SceneMemberResource::Ptr>> devices;
+            {
+                std::lock_guard<std::mutex> memberlock(m_sceneMemberLock);
+                std::map<std::string, size_t> deviceIndexes;
+                for (const auto & member : m_sceneMembers)
+                {
+                    if (!member->hasSceneValue(sceneName))
+                    {
+                        continue;
+                    }
+
+                    auto address = member->getRemoteResourceObject()->getAddress();
+                    auto found = deviceIndexes.find(address);
+                    if (found == deviceIndexes.end())
+                    {
+                        deviceIndexes[address] = devices.size();
+                        devices.push_back({ member });
+                    }
+                    else
+                    {
+                        devices[found->second].push_back(member);
+                    }
+                }
             }
+
+            std::vector<SceneMemberResource::Ptr> members;
+            for (size_t i = 0; ; ++i)
+            {
+                bool added = false;
+                for (const auto & deviceMembers : devices)
+                {
+                    if (i < deviceMembers.size())
+                    {
+                        members.push_back(deviceMembers[i]);
+                        added = true;
+                    }
+                }
+                if (!added)
+                {
+                    break;
+                }
+            }
+            return members;
+        }
+
+        void SceneCollectionResource::onSceneExecuted(const std::string & sceneName,
+                std::chrono::milliseconds latency, int numOfMembers)
+        {
+            OIC_LOG_V(INFO, TAG, "Scene %s executed on %d members in %lld ms",
+                    sceneName.c_str(), numOfMembers, static_cast<long long>(latency.count()));
+
+            std::lock_guard<std::mutex> statsLock(m_statsLock);
+            auto & stats = m_executionStats[sceneName];
+            stats.numOfExecutions++;
+            stats.lastLatency = latency;
+            stats.maxLatency = std::max(stats.maxLatency, latency);
+        }
+
+        SceneCollectionResource::ExecutionStats SceneCollectionResource::getExecutionStats(
+                const std::string & sceneName) const
+        {
+            std::lock_guard<std::mutex> statsLock(m_statsLock);
+            auto found = m_executionStats.find(sceneName);
+            if (found == m_executionStats.end())
+            {
+                return ExecutionStats();
+            }
+            return found->second;
         }
 
         std::string SceneCollectionResource::getId() const
@@ -446,23 +543,37 @@ namespace OIC
                 * returns. So, its better to release the lock explicitly.
                 */
                 responseLock.unlock();
+
+                auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - m_startTime);
+                auto owner = m_owner.lock();
+                if (owner)
+                {
+                    owner->onSceneExecuted(m_sceneName, latency, m_numOfMembers);
+                }
                 m_cb(m_errorCode);
             }
         }
 
         SceneCollectionResource::SceneExecuteResponseHandler::Ptr
         SceneCollectionResource::SceneExecuteResponseHandler::createExecuteHandler(
-                const SceneCollectionResource::Ptr ptr, SceneExecuteCallback executeCB)
+                const SceneCollectionResource::Ptr ptr, const std::string & sceneName,
+                int numOfMembers, SceneExecuteCallback executeCB)
         {
             auto executeHandler = std::make_shared<SceneExecuteResponseHandler>();
 
-            executeHandler->m_numOfMembers = ptr->m_sceneMembers.size();
+            executeHandler->m_numOfMembers = numOfMembers;
             executeHandler->m_responseMembers = 0;
+            executeHandler->m_sceneName = sceneName;
+            executeHandler->m_startTime = std::chrono::steady_clock::now();
 
             executeHandler->m_cb =
                     [executeCB](int eCode)
                     {
-                        std::thread(std::move(executeCB), eCode).detach();
+                        if (executeCB)
+                        {
+                            std::thread(std::move(executeCB), eCode).detach();
+                        }
                     };
 
             executeHandler->m_owner
@@ -21,7 +21,9 @@
 #ifndef SCENE_COLLECTION_RESOURCE_OBJECT_H
 #define SCENE_COLLECTION_RESOURCE_OBJECT_H
 
+#include <chrono>
 #include <list>
+#include <map>
 
 #include "RCSResourceObject.h"
 #include "SceneCommons.h"
@@ -38,6 +40,17 @@ namespace OIC
             typedef std::shared_ptr< SceneCollectionResource > Ptr;
             typedef std::function< void(int) > SceneExecuteCallback;
 
+            /**
+             * Statistics of the executions of a scene. The latency of an execution is the time
+             * from sending the first request until the last member responded.
+             */
+            struct ExecutionStats
+            {
+                unsigned int numOfExecutions;
+                std::chrono::milliseconds lastLatency;
+                std::chrono::milliseconds maxLatency;
+            };
+
             ~SceneCollectionResource() = default;
 
             static SceneCollectionResource::Ptr create();
@@ -71,6 +84,8 @@ namespace OIC
 
             RCSResourceObject::Ptr getRCSResourceObject() const;
 
+            ExecutionStats getExecutionStats(const std::string & sceneName) const;
+
         private:
             class SceneExecuteResponseHandler
             {
@@ -78,7 +93,7 @@ namespace OIC
                 typedef std::shared_ptr<SceneExecuteResponseHandler> Ptr;
 
                 SceneExecuteResponseHandler()
-                : m_numOfMembers(0), m_responseMembers(0), m_errorCode(0)
+                : m_numOfMembers(0), m_responseMembers(0), m_errorCode(0), m_startTime()
                 {
                 }
                 ~SceneExecuteResponseHandler() = default;
@@ -86,12 +101,15 @@ namespace OIC
                 int m_numOfMembers;
                 int m_responseMembers;
                 int m_errorCode;
+                std::string m_sceneName;
+                std::chrono::steady_clock::time_point m_startTime;
                 std::weak_ptr<SceneCollectionResource> m_owner;
                 SceneExecuteCallback m_cb;
                 std::mutex m_responseMutex;
 
                 static SceneExecuteResponseHandler::Ptr createExecuteHandler(
-                        const SceneCollectionResource::Ptr, SceneExecuteCallback);
+                        const SceneCollectionResource::Ptr, const std::string &, int,
+                        SceneExecuteCallback);
                 void onResponse(const RCSResourceAttributes &, int);
             };
 
@@ -129,6 +147,9 @@ namespace OIC
 
             SceneCollectionRequestHandler m_requestHandler;
 
+            mutable std::mutex m_statsLock;
+            std::map<std::string, ExecutionStats> m_executionStats;
+
             SceneCollectionResource();
 
             SceneCollectionResource(const SceneCollectionResource &) = delete;
@@ -140,6 +161,10 @@ namespace OIC
                     SceneCollectionResource &&) = delete;
 
             RCSResourceObject::Ptr createResourceObject();
+            std::vector<SceneMemberResource::Ptr> getExecutionOrder(
+                    const std::string & sceneName) const;
+            void onSceneExecuted(const std::string & sceneName, std::chrono::milliseconds,
+                    int numOfMembers);
             void setDefaultAttributes();
             void initSetRequestHandler();
         };
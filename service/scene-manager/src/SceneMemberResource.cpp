@@ -111,6 +111,7 @@ namespace OIC
 
         void SceneMemberResource::addMappingInfo(MappingInfo && mInfo)
         {
+            std::lock_guard<std::mutex> mappingLock(m_mappingLock);
             RCSResourceAttributes newAtt;
             {
                 RCSResourceObject::LockGuard guard(m_sceneMemberResourceObj);
@@ -131,13 +132,45 @@ namespace OIC
             {
                 mappingInfo.erase(foundMInfo);
             }
+            std::string sceneName = mInfo.sceneName;
             RCSResourceAttributes newMapInfo;
             newMapInfo[SCENE_KEY_SCENE] = RCSResourceAttributes::Value(std::move(mInfo.sceneName));
             newMapInfo[SCENE_KEY_MEMBERPROPERTY] = RCSResourceAttributes::Value(std::move(mInfo.key));
             newMapInfo[SCENE_KEY_MEMBERVALUE] = std::move(mInfo.value);
             mappingInfo.push_back(newMapInfo);
 
-            m_sceneMemberResourceObj->setAttribute(SCENE_KEY_SCENEMAPPINGS, mappingInfo);
+            compileSceneSnapshot(sceneName, mappingInfo);
+            m_sceneMemberResourceObj->setAttribute(SCENE_KEY_SCENEMAPPINGS, std::move(mappingInfo));
+        }
+
+        void SceneMemberResource::compileSceneSnapshot(const std::string & sceneName,
+                const std::vector<RCSResourceAttributes> & mappingInfo)
+        {
+            auto snapshot = std::make_shared<RCSResourceAttributes>();
+            std::for_each(mappingInfo.begin(), mappingInfo.end(),
+                    [& snapshot, & sceneName](const RCSResourceAttributes & att)
+                    {
+                        if (att.at(SCENE_KEY_SCENE).get<std::string>() == sceneName)
+                        {
+                            (*snapshot)[att.at(SCENE_KEY_MEMBERPROPERTY).get<std::string>()]
+                                    = att.at(SCENE_KEY_MEMBERVALUE);
+                        }
+                    });
+
+            std::lock_guard<std::mutex> snapshotLock(m_snapshotLock);
+            m_sceneSnapshots[sceneName] = std::move(snapshot);
+        }
+
+        SceneMemberResource::SceneSnapshot SceneMemberResource::getSceneSnapshot(
+                const std::string & sceneName) const
+        {
+            std::lock_guard<std::mutex> snapshotLock(m_snapshotLock);
+            auto found = m_sceneSnapshots.find(sceneName);
+            if (found == m_sceneSnapshots.end())
+            {
+                return nullptr;
+            }
+            return found->second;
         }
 
         void SceneMemberResource::addMappingInfo(const MappingInfo & mInfo)
@@ -197,24 +230,18 @@ namespace OIC
 
         void SceneMemberResource::execute(std::string && sceneName, MemberexecuteCallback executeCB)
         {
-            RCSResourceAttributes setAtt;
-
-            auto mInfo = getMappingInfos();
-            std::for_each(mInfo.begin(), mInfo.end(),
-                    [& setAtt, & sceneName](const MappingInfo & info)
-                    {
-                        if(info.sceneName == sceneName)
-                        {
-                            setAtt[info.key] = info.value;
-                        }
-                    });
-
-            if (setAtt.empty() && executeCB != nullptr)
+            // The snapshot is immutable, it is replaced when the scene mappings change.
+            auto setAtt = getSceneSnapshot(sceneName);
+            if (!setAtt || setAtt->empty())
             {
-                executeCB(RCSResourceAttributes(), SCENE_RESPONSE_SUCCESS);
+                if (executeCB != nullptr)
+                {
+                    executeCB(RCSResourceAttributes(), SCENE_RESPONSE_SUCCESS);
+                }
+                return;
             }
 
-            m_remoteMemberObj->setRemoteAttributes(setAtt, executeCB);
+            m_remoteMemberObj->setRemoteAttributes(*setAtt, executeCB);
         }
 
         void SceneMemberResource::execute(
@@ -257,16 +284,8 @@ namespace OIC
 
         bool SceneMemberResource::hasSceneValue(const std::string & sceneValue) const
         {
-            auto mInfo = getMappingInfos();
-            if (std::find_if(mInfo.begin(), mInfo.end(),
-                    [& sceneValue](const MappingInfo & info) -> bool
-                    {
-                        return info.sceneName == sceneValue;
-                    }) != mInfo.end())
-            {
-                return true;
-            }
-            return false;
+            auto snapshot = getSceneSnapshot(sceneValue);
+            return snapshot && !snapshot->empty();
         }
 
         SceneMemberResource::MappingInfo
@@ -27,6 +27,9 @@
 #ifndef SCENE_MEMBER_RESOURCE_OBJECT_H
 #define SCENE_MEMBER_RESOURCE_OBJECT_H
 
+#include <map>
+#include <mutex>
+
 #include "RCSResourceObject.h"
 #include "RCSRemoteResourceObject.h"
 #include "SceneCommons.h"
@@ -192,11 +195,26 @@ namespace OIC
                 RCSSetResponse setSceneMemberName(const RCSRequest & , RCSResourceAttributes &);
             };
 
+            typedef std::shared_ptr<const RCSResourceAttributes> SceneSnapshot;
+
             std::string m_uri;
             RCSResourceObject::Ptr m_sceneMemberResourceObj;
             RCSRemoteResourceObject::Ptr m_remoteMemberObj;
             SceneMemberRequestHandler m_requestHandler;
 
+            /**
+             * Attributes to set on the target resource for each scene, compiled from the scene
+             * mappings whenever they change so executing a scene does not search them.
+             */
+            std::map<std::string, SceneSnapshot> m_sceneSnapshots;
+            mutable std::mutex m_snapshotLock;
+
+            /**
+             * Held while the scene mappings are read, merged and written back along with their
+             * snapshot, so concurrent updates cannot lose each other's mappings.
+             */
+            std::mutex m_mappingLock;
+
             SceneMemberResource() = default;
 
             SceneMemberResource(const SceneMemberResource &) = delete;
@@ -208,6 +226,9 @@ namespace OIC
             void createResourceObject();
             void setDefaultAttributes();
             void initSetRequestHandler();
+            void compileSceneSnapshot(const std::string & sceneName,
+                    const std::vector<RCSResourceAttributes> & mappingInfo);
+            SceneSnapshot getSceneSnapshot(const std::string & sceneName) const;
         };
     }
 }
@@ -21,12 +21,15 @@
 #include "UnitTestHelper.h"
 
 #include "SceneList.h"
+#include "SceneListResource.h"
+#include "SceneCollectionResource.h"
 
 #include "RCSResourceObject.h"
 #include "RCSRemoteResourceObject.h"
 #include "SceneCommons.h"
 #include "OCPlatform.h"
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <iostream>
@@ -74,7 +77,7 @@ protected:
     }
     void createServer(const std::string& resourceUri1, const std::string& resourceUri2)
     {
-        auto pResource1 = RCSResourceObject::Builder(
+        pResource1 = RCSResourceObject::Builder(
                 resourceUri1, RESOURCE_TYPE, DEFAULT_INTERFACE).build();
         pResource1->setAttribute(KEY, VALUE);
 
@@ -84,7 +87,7 @@ protected:
                 pResource1->getTypes(), pResource1->getInterfaces());
         pRemoteResource1 = RCSRemoteResourceObject::fromOCResource(ocResourcePtr);
 
-        auto pResource2 = RCSResourceObject::Builder(
+        pResource2 = RCSResourceObject::Builder(
                 resourceUri2, RESOURCE_TYPE2, DEFAULT_INTERFACE).build();
         pResource2->setAttribute(KEY_2, VALUE_2);
 
@@ -94,12 +97,25 @@ protected:
                         pResource2->getTypes(), pResource2->getInterfaces());
         pRemoteResource2 = RCSRemoteResourceObject::fromOCResource(ocResourcePtr);
     }
+    SceneCollectionResource::Ptr getSceneCollectionResource()
+    {
+        for (const auto &it : SceneListResource::getInstance()->getSceneCollections())
+        {
+            if (it->getId() == pSceneCollection->getId())
+            {
+                return it;
+            }
+        }
+        return nullptr;
+    }
 
 public:
     SceneList* pSceneList;
     shared_ptr<SceneCollection> pSceneCollection;
     shared_ptr<Scene> pScene1;
     shared_ptr<Scene> pScene2;
+    RCSResourceObject::Ptr pResource1;
+    RCSResourceObject::Ptr pResource2;
     RCSRemoteResourceObject::Ptr pRemoteResource1;
     RCSRemoteResourceObject::Ptr pRemoteResource2;
 
@@ -211,3 +227,55 @@ TEST_F(SceneTest, executeSceneUsingEmptyCallback)
 
     ASSERT_THROW(pScene1->execute(nullptr), RCSInvalidParameterException);
 }
+
+TEST_F(SceneTest, executeSceneWithMemberOfOtherScene)
+{
+    mocks.ExpectCallFunc(executeCallback).Do([this](int)
+    {
+        proceed();
+    });
+
+    createServer("/a/testuri4_1", "/a/testuri4_2");
+    createSceneCollection();
+    createScene();
+    pScene1->addNewSceneAction(pRemoteResource1, KEY, "on");
+    pScene2->addNewSceneAction(pRemoteResource2, KEY_2, "50");
+
+    std::atomic_int numOfRequests{ 0 };
+    pResource2->setSetRequestHandler(
+            [&numOfRequests](const RCSRequest&, RCSResourceAttributes&)
+            {
+                ++numOfRequests;
+                return RCSSetResponse::defaultAction();
+            });
+
+    pScene1->execute(executeCallback);
+    waitForCb(3000);
+
+    EXPECT_EQ(0, numOfRequests);
+    EXPECT_EQ(VALUE_2, pResource2->getAttributeValue(KEY_2).get<std::string>());
+    auto sceneCollectionResource = getSceneCollectionResource();
+    ASSERT_NE(nullptr, sceneCollectionResource);
+    EXPECT_EQ(1u, sceneCollectionResource->getExecutionStats("SceneTestName_1").numOfExecutions);
+    EXPECT_EQ(0u, sceneCollectionResource->getExecutionStats("SceneTestName_2").numOfExecutions);
+}
+
+TEST_F(SceneTest, executeSceneAfterResetExecutionParameter)
+{
+    mocks.ExpectCallFunc(executeCallback).Do([this](int)
+    {
+        proceed();
+    });
+
+    createServer("/a/testuri5_1", "/a/testuri5_2");
+    createSceneCollection();
+    createScene();
+    auto pSceneAction = pScene1->addNewSceneAction(pRemoteResource1, KEY, "on");
+    pSceneAction->resetExecutionParameter(KEY, "off");
+    pResource1->setAttribute(KEY, "on");
+
+    pScene1->execute(executeCallback);
+    waitForCb(3000);
+
+    EXPECT_EQ("off", pResource1->getAttributeValue(KEY).get<std::string>());
+}